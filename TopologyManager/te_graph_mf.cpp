@@ -18,6 +18,7 @@
  */
 #include <boost/foreach.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
 #include <stdlib.h>
 #include "te_graph_mf.hpp"
 
@@ -28,17 +29,20 @@ pthread_t _te_thread, *te_thread;
 
 TEgraphMF::TEgraphMF() {
 	igraph_i_set_attribute_table(&igraph_cattribute_table);
-	cacheValid=false;
 	e=0.1;
 	recalculationDelay=60;
+	threads=1;
 	defaultBW=1;
 	te_thread= NULL;
 }
 
-void TEgraphMF::initialise(int Delay,double eval,double dBW){
+void TEgraphMF::initialise(int Delay,double eval,double dBW,unsigned int nthreads){
 	recalculationDelay = Delay;
 	e=eval;
 	defaultBW=dBW;
+	if (nthreads == 0)
+		nthreads = boost::thread::hardware_concurrency();
+	threads = (nthreads > 0) ? nthreads : 1;
 	
 }
 
@@ -54,8 +58,6 @@ TEgraphMF::~TEgraphMF() {
 	edge_LID.clear();
 	igraph_i_attribute_destroy(&graph);
 	igraph_destroy(&graph);
-	if(cacheValid)
-		delete(demandMapApplied);
 }
 
 int& TEgraphMF::get_reverse_node_index(const string &nodeid){
@@ -118,6 +120,7 @@ int TEgraphMF::readTopology(const char *file_name) {
 		string iLID = string(igraph_cattribute_VAS(&graph, "iLID", i));
 		reverse_node_index.insert(pair<string, int>(nID, i));
 		ilid = new Bitvector(iLID);
+		reserveLID(*ilid);
 		nodeID_iLID.insert(pair<string, Bitvector* >(nID, ilid));
 		vertex_iLID.insert(pair<int, Bitvector* >(i, ilid));
 		cout<<"node "<<i<<" has NODEID"<<nID<<endl;
@@ -127,6 +130,7 @@ int TEgraphMF::readTopology(const char *file_name) {
 		string LID = string(igraph_cattribute_EAS(&graph, "LID", i));
 		reverse_edge_index.insert(pair<string, int>(LID, i));
 		lid = new Bitvector(LID);
+		reserveLID(*lid);
 		edge_LID.insert(pair<int, Bitvector* >(i, lid));
 		
 		igraph_integer_t head;
@@ -203,23 +207,12 @@ void* te_loop(void *arg) {
 	return NULL;
 }
 
-void TEgraphMF::assignLIDs(int NoLIDs, set<Bitvector *> &NewLIDs){
-	Bitvector * lid;
-	for (int i = 0 ; i < NoLIDs; i++) {
-		lid = calculateLID();
-		NewLIDs.insert(lid);
-	}
+bool TEgraphMF::assignLIDs(int NoLIDs, set<Bitvector *> &NewLIDs){
+	return allocateLIDs(NoLIDs, NewLIDs);
 }
 
 Bitvector * TEgraphMF::calculateLID() {
-	Bitvector * lid = new Bitvector(FID_LEN * 8);
-	int bit_position = 0;
-	do {
-		/*set a random bit position to 1*/
-		bit_position = rand() % (FID_LEN * 8);
-		(*lid)[bit_position] = true;
-	} while(LIDs.find(lid) != LIDs.end());
-	return lid;
+	return allocateLID();
 }
 void TEgraphMF::updateTMStates(){
 	unsigned int no_edges = igraph_ecount(&graph);
@@ -238,7 +231,7 @@ void TEgraphMF::update_paths() {
 	Bitvector* lid;
 	// make deep copy of demandsMapMeasured
 	vector<mf_demand> tmpdemands;
-	te_mf_demandMap* tmpdemandMap = new te_mf_demandMap;
+	boost::shared_ptr<te_mf_demandMap> tmpdemandMap(new te_mf_demandMap);
 	
 	pthread_mutex_lock (&te_mutex);
 	
@@ -267,7 +260,11 @@ void TEgraphMF::update_paths() {
 	
 	// scale the demands as they represent number of calls
 	// not actual bit rates
-	graphMF.sp_concurrent_flow(tmpdemands);
+	if (threads > 1) {
+		graphMF.sp_concurrent_flow_parallel(tmpdemands, threads);
+	} else {
+		graphMF.sp_concurrent_flow(tmpdemands);
+	}
 	
 	BOOST_FOREACH(mf_demand &demand,
 				  tmpdemands) {
@@ -338,20 +335,13 @@ void TEgraphMF::update_paths() {
 		}
 	}
 	
-	pthread_mutex_lock (&te_mutex);
-	if(cacheValid) {
-		delete demandMapApplied;
-	}
-	demandMapApplied = tmpdemandMap;
-	pthread_mutex_unlock (&te_mutex);
-	
-	cacheValid=true;
+	// lookups still in flight keep their snapshot of the old solution
+	boost::atomic_store(&demandMapApplied, tmpdemandMap);
 	
 	// THIS BLOCK ONLY FOR DEBUGGING DELETE
 	
-	demandMapApplied_type mymap = demandMapApplied->demand_map;
 	BOOST_FOREACH(const demandMapApplied_type::value_type &te_demandm,
-				  mymap) {
+				  tmpdemandMap->demand_map) {
 		te_mf_demand te_demand = te_demandm.second;
 		cout<<"Demand "<<te_demand.source+1<<"->"<<te_demand.sink+1
 		<< " demand="<<te_demand.demand<<endl;
@@ -411,12 +401,11 @@ void te_mf_demandMap::insert_demand(te_mf_demand &demand) {
 void TEgraphMF::calculateFID(string &source, string &destination,
 			     Bitvector &resultFID,
 			     unsigned int &numberOfHops, string &path) {
-	if(cacheValid) {
-		pthread_mutex_lock (&te_mutex);
+	boost::shared_ptr<te_mf_demandMap> applied = boost::atomic_load(&demandMapApplied);
+	if(applied) {
 		resultFID =
-		demandMapApplied->get_fid(reverse_node_index.find(source)->second,
-								  reverse_node_index.find(destination)->second);
-		pthread_mutex_unlock (&te_mutex);
+		applied->get_fid(reverse_node_index.find(source)->second,
+						 reverse_node_index.find(destination)->second);
 		// this is from shortest hop, the path selected may be longer than this
 		numberOfHops = distanceMap.find(pair<string,string>(source,destination))->
 		second;
@@ -427,12 +416,11 @@ void TEgraphMF::calculateFID(string &source, string &destination,
 
 Bitvector* TEgraphMF::calculateFID(string &source, string &destination) {
 	Bitvector* resultFID = new Bitvector(FID_LEN * 8);;
-	if(cacheValid) {
-		pthread_mutex_lock (&te_mutex);
+	boost::shared_ptr<te_mf_demandMap> applied = boost::atomic_load(&demandMapApplied);
+	if(applied) {
 		*resultFID =
-		demandMapApplied->get_fid(reverse_node_index.find(source)->second,
-								  reverse_node_index.find(destination)->second);
-		pthread_mutex_unlock (&te_mutex);
+		applied->get_fid(reverse_node_index.find(source)->second,
+						 reverse_node_index.find(destination)->second);
 		//*resultFID = fidMap.find(pair<string,string>(source,destination))->
 		//	    second;
 	} else {
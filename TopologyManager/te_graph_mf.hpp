@@ -21,6 +21,7 @@
 #define TE_GRAPH_MF_HH
 #include "tm_graph.hpp"
 #define BOOST_NO_HASH
+#include <boost/shared_ptr.hpp>
 
 /** @brief This is a data structure to hold a TE routing demand and
  pick a path from a multiple path set. There is one demand for
@@ -68,8 +69,9 @@ public:
 	 @param recalctime seconds between recalculations, default 60
 	 @param e optimisation parameter, defualt 0.1 (must be 0 < e < 1)
 	 @param defbw default bandwidth in bits per second, default 10^8
+	 @param nthreads worker threads of the shortest path phase, 0 for one per core
 	 */
-	void initialise(int recalctime,double e,double defbw);
+	void initialise(int recalctime,double e,double defbw,unsigned int nthreads=0);
 	
 	void calculateFID(string &source, string &destination,
 					  Bitvector &resultFID,
@@ -91,7 +93,7 @@ public:
 							 bool remove,
                              Moly &moly
 							 ){return false;}
-	virtual void assignLIDs(int NoLIDs, set<Bitvector *> &NewLIDs);
+	virtual bool assignLIDs(int NoLIDs, set<Bitvector *> &NewLIDs);
 	
 	virtual Bitvector * calculateLID();
 	
@@ -132,6 +134,11 @@ public:
 	 */
 	int recalculationDelay;
 	
+	/**@brief number of threads computing the shortest paths of the
+	 demands in update_paths(), 1 runs the serial sp_concurrent_flow
+	 */
+	unsigned int threads;
+	
 	/** @breif an index that maps freed LIDs after edges are removed - possibly due to faiure
 	 */
 	std::set<Bitvector *> freedLIDs;
@@ -158,7 +165,6 @@ private:
 	
 	void preCalculateFids();
 	
-	bool cacheValid;
 	/**@brief the igraph graph
 	 */
 	igraph_t graph;
@@ -206,7 +212,14 @@ private:
 	
 	typedef std::pair<int,int> intpair;
 	map< pair<int,int>, mf_demand> demandMapMeasured;
-	te_mf_demandMap *demandMapApplied;
+	/**@brief the applied TE solution, NULL until the first update_paths()
+	 
+	 It is double-buffered: update_paths() builds a complete new map and
+	 publishes it with boost::atomic_store, lookups take a snapshot with
+	 boost::atomic_load and keep reading it even if a newer map is swapped
+	 in meanwhile. The old map is freed with its last snapshot.
+	 */
+	boost::shared_ptr<te_mf_demandMap> demandMapApplied;
 	
 };
 
@@ -23,6 +23,7 @@
 #include <blackadder.hpp>
 #include "tm_graph.hpp"
 #include "tm_igraph.hpp"
+#include "tm_csrgraph.hpp"
 #include "te_graph_mf.hpp"
 /*QoS Stuff*/
 #include <qos_structs.hpp>
@@ -50,6 +51,9 @@ Moly *moly = NULL;
 TMgraph *tm_igraph = NULL;
 pthread_t _event_listener, *event_listener = NULL;
 pthread_t _moly_event_listener, *moly_event_listener = NULL;
+pthread_t _qos_resolver, *qos_resolver = NULL;
+/*serialises the request handlers of the event listener and the QoS resolver threads*/
+pthread_mutex_t request_mutex = PTHREAD_MUTEX_INITIALIZER;
 sig_atomic_t listening = 1;
 unordered_map<int, int> moly_tm_requests;
 
@@ -107,6 +111,8 @@ string pathMgmt_bin_full_id = pathMgmt_bin_id + pathMgmt_bin_id;
 
 // Global II metadata cache
 IIMetaCache metaCache;
+// Path requests waiting for the metadata of their II
+IIMetaResolver metaResolver;
 
 /*TM - RM Notification IDs, append tm_igraph->getRMNodeID() befor publishing data using the ID*/
 string UpdatePathId = resl_bin_id ;
@@ -116,15 +122,48 @@ string DiscoverUnicastFailureId = resl_req_bin_id + uc_resl_bin_id ;
 string	UnicastDeliveryId = req_bin_id + uc_req_bin_id ;
 string	RecoverUnicastDeliveryId = resl_resp_bin_id + uc_resl_bin_id ;
 
+void handleMulticastPathRequest(char *request, int request_len, bool resolved = false);
+
+void reportParkedRequests() {
+    buffer_sizes_t bufferSizes;
+    bufferSizes.push_back(pair<buffer_name_t, buffer_size_t>(BUFFER_TM_QOS_PARKED_REQUESTS, metaResolver.depth()));
+    moly->Process::bufferSizes(NODE_ROLE_TM, bufferSizes);
+}
+
 void handleIIMetaData(char *request, int request_len){
     cout<<"Got Meta Data!!!"<<endl;
     MetaDataPacket pkt((uint8_t *)request, request_len);
     metaCache.update(pkt.getID_RAW(), pkt.getIIStatus(), ba);
     
-    // TODO: We have to re-route this II
+    // Now calculate the paths of the requests that waited for it
+    vector<string> requests;
+    metaResolver.resolve(pkt.getID_RAW(), requests);
+    if (requests.empty())
+        return;
+    cout<<"TM: QoS: "<<requests.size()<<" parked request(s) resolved"<<endl;
+    for (size_t i = 0; i < requests.size(); i++)
+        handleMulticastPathRequest(&requests[i][0], requests[i].size(), true);
+    reportParkedRequests();
+}
+
+/*the timer thread that recalculates parked requests whose metadata did not arrive in time*/
+void *qos_resolver_loop(void *arg) {
+    while (listening) {
+        vector<string> requests;
+        metaResolver.waitExpired(requests);
+        if (requests.empty())
+            continue;
+        pthread_mutex_lock(&request_mutex);
+        for (size_t i = 0; i < requests.size(); i++)
+            handleMulticastPathRequest(&requests[i][0], requests[i].size(), true);
+        reportParkedRequests();
+        pthread_mutex_unlock(&request_mutex);
+    }
+    return NULL;
 }
 
-void handleMulticastPathRequest(char *request, int request_len) {
+/*resolved is true when the request has been parked before, waiting for the metadata of its II*/
+void handleMulticastPathRequest(char *request, int request_len, bool resolved) {
     cout<<"---------------- REQUEST --------------------"<<endl;
     unsigned char request_type;
     unsigned char strategy;
@@ -192,6 +231,7 @@ void handleMulticastPathRequest(char *request, int request_len) {
         string ids_str = string((const char *)(ids) , (int)IDLen * PURSUIT_ID_LEN);
 
 	// Keep track of the requests per namespace and report the count for current one to Moly
+	if (!resolved) {
 	string tmp_str = chararray_to_hex(ids_str);
 	root_scope_t root_scope = map_root_scope(strtoul(tmp_str.substr(0, 16).c_str(), NULL, 16));
 	moly_tm_requests[root_scope] += 1;
@@ -199,18 +239,26 @@ void handleMulticastPathRequest(char *request, int request_len) {
 	path_calculations_namespace_t pathCalculations;
 	pathCalculations.push_back(pair<root_scope_t, subscribers_t>(root_scope, moly_tm_requests[root_scope]));
 	moly->Process::pathCalculations(pathCalculations);
+	}
 
         if (tm_igraph->getExten(QOS) && tm_igraph->isQoSMapOk()) {
             // before doing anything... check that we do not need to subscribe to the
             // MetaData of that item...
             cout<<"Request is for II="<<chararray_to_hex(ids_str)<<endl;
-            bool added = metaCache.sendQueryIfNeeded(ids_str, ba);
-            // Get the priority
-            int prio = DEFAULT_QOS_PRIO;
-            // Try to avoid messing with the cache while quering
-            // IT IS NOT THREAD-SAFE!
-            if (!added)
-            prio = metaCache.getIIQoSPrio(ids_str, ba);
+            if (!resolved) {
+                metaCache.sendQueryIfNeeded(ids_str, ba);
+                // Park the request until the MetaData arrives (or QOS_PARK_TIME passes)
+                // rather than routing it on the default priority
+                if (metaCache.quering(ids_str)) {
+                    metaResolver.park(ids_str, request, request_len);
+                    reportParkedRequests();
+                    free(ids);
+                    cout<<"---------------- PARKED --------------------\n"<<endl;
+                    return;
+                }
+            }
+            // Get the priority, DEFAULT if the MetaData did not arrive in time
+            int prio = metaCache.getIIQoSPrio(ids_str, ba);
             
             // Get the available network class (ie. map II priority 98
             // to net 95 for a net that supports 0,95 and 99)
@@ -880,7 +928,9 @@ void *event_listener_loop(void *arg) {
             if (!listening)
             cout << "TM: final event" << endl;
             return NULL;
-        } else if (ev.type == PUBLISHED_DATA) {
+        }
+        pthread_mutex_lock(&request_mutex);
+        if (ev.type == PUBLISHED_DATA) {
             publisher = ev.id.substr(ev.id.length() - PURSUIT_ID_LEN, PURSUIT_ID_LEN);
             prefix_id = ev.id.substr(0, ev.id.length() - PURSUIT_ID_LEN);
             if ((prefix_id == lsn_bin_id) && (tm_igraph->getExten(PM))){
@@ -910,6 +960,7 @@ void *event_listener_loop(void *arg) {
         } else {
             cout << "TM: I am not expecting any other notification...FATAL" << endl;
         }
+        pthread_mutex_unlock(&request_mutex);
     }
     return NULL;
 }
@@ -930,6 +981,8 @@ void sigfun(int sig) {
     if (event_listener){
         pthread_cancel(*event_listener);
     }
+    // the QoS timer thread sees listening cleared within QOS_RESOLVER_POLL_TIME.
+    // It is not cancelled, as it could be waiting with the resolver's mutex
     if (moly_event_listener) {
         pthread_cancel(*moly_event_listener);
     }
@@ -939,14 +992,20 @@ void sigfun(int sig) {
 int main(int argc, char* argv[]) {
     opterr = 0;
     bool te = false;
+    bool csr = false;
     long te_delay=60;
     double te_e=0.1;
     double defaultBW=1e9;
+    unsigned int te_threads=0;
     int index = 0;
     char c;
-    while ((c = getopt (argc, argv, "prqtdu:")) != -1){
+    while ((c = getopt (argc, argv, "cprqtd:b:e:w:u:")) != -1){
         switch (c)
         {
+                case 'c':
+                cout << "TM: CSR graph engine." << endl;
+                csr = true;
+                break;
                 case 't':
                 cout << "TM: TE Extension." << endl;
                 te = true;
@@ -960,6 +1019,9 @@ int main(int argc, char* argv[]) {
                 case 'e':
                 sscanf(optarg,"%lg",&te_e);
                 break;
+                case 'w':
+                sscanf(optarg,"%u",&te_threads);
+                break;
                 case 'q':
                 index = 1;
                 cout << "TM: QoS Extension." << endl;
@@ -998,10 +1060,14 @@ int main(int argc, char* argv[]) {
         tm_igraph = new TEgraphMF();
         tm_igraph->setExten(TE);
         cout<<"Setting delay to "<<te_delay<<endl;
-        ((TEgraphMF*)tm_igraph)->initialise(te_delay,te_e,defaultBW);
+        ((TEgraphMF*)tm_igraph)->initialise(te_delay,te_e,defaultBW,te_threads);
         cout << "TM: TE Support is in effect" << endl;
     } else {
-        tm_igraph = new TMIgraph();
+        if (csr) {
+            tm_igraph = new TMCSRgraph();
+        } else {
+            tm_igraph = new TMIgraph();
+        }
         if (index > 0) {
             tm_igraph->setExten(index);
         }
@@ -1033,6 +1099,10 @@ int main(int argc, char* argv[]) {
         pthread_create(&_te_thread, NULL, te_loop,(void*)tm_igraph);
         te_thread = &_te_thread;
     }
+    if(tm_igraph->getExten(QOS)) {
+        pthread_create(&_qos_resolver, NULL, qos_resolver_loop, NULL);
+        qos_resolver = &_qos_resolver;
+    }
     pthread_create(&_event_listener, NULL, event_listener_loop, (void *) ba);
     event_listener = &_event_listener;
     ba->subscribe_scope(req_bin_id, req_bin_prefix_id, IMPLICIT_RENDEZVOUS, NULL, 0);
@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2015-2018  Mays AL-Naday
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+/**
+ * Benchmark of the path calculations of the igraph (TMIgraph) and the CSR
+ * (TMCSRgraph) topology representations. Both graphs are loaded from the same
+ * graphML file and queried with the same (source, destination) pairs.
+ *
+ * Usage: ./tm_bench [-n nodes] [-d degree] [-q queries] [topology.graphml]
+ *
+ * Without -n the given (or the bundled) topology file is used. With -n a
+ * random connected topology of the given size and average out-degree is
+ * generated into /tmp first.
+ */
+
+#include <unistd.h>
+#include <sys/time.h>
+#include <stdio.h>
+#include <vector>
+#include "tm_igraph.hpp"
+#include "tm_csrgraph.hpp"
+
+using namespace std;
+
+double now() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+string nodeLabel(int n) {
+	char label[NODEID_LEN + 1];
+	snprintf(label, sizeof(label), "%08d", n + 1);
+	return string(label);
+}
+
+string randomLID() {
+	string lid(FID_LEN * 8, '0');
+	lid[rand() % (FID_LEN * 8)] = '1';
+	return lid;
+}
+
+/*a bidirectional ring, so that the graph is connected, plus random chords*/
+void writeSyntheticTopology(const char *file_name, int nodes, int degree) {
+	ofstream out(file_name);
+	set<pair<int, int> > edges;
+	out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << endl;
+	out << "<graphml xmlns=\"http://graphml.graphdrawing.org/xmlns\">" << endl;
+	out << "  <key id=\"FID_LEN\" for=\"graph\" attr.name=\"FID_LEN\" attr.type=\"double\"/>" << endl;
+	out << "  <key id=\"TM\" for=\"graph\" attr.name=\"TM\" attr.type=\"string\"/>" << endl;
+	out << "  <key id=\"RV\" for=\"graph\" attr.name=\"RV\" attr.type=\"string\"/>" << endl;
+	out << "  <key id=\"TM_MODE\" for=\"graph\" attr.name=\"TM_MODE\" attr.type=\"string\"/>" << endl;
+	out << "  <key id=\"NODEID\" for=\"node\" attr.name=\"NODEID\" attr.type=\"string\"/>" << endl;
+	out << "  <key id=\"iLID\" for=\"node\" attr.name=\"iLID\" attr.type=\"string\"/>" << endl;
+	out << "  <key id=\"LID\" for=\"edge\" attr.name=\"LID\" attr.type=\"string\"/>" << endl;
+	out << "  <graph id=\"G\" edgedefault=\"directed\">" << endl;
+	out << "    <data key=\"FID_LEN\">" << FID_LEN << "</data>" << endl;
+	out << "    <data key=\"TM\">" << nodeLabel(0) << "</data>" << endl;
+	out << "    <data key=\"RV\">" << nodeLabel(0) << "</data>" << endl;
+	out << "    <data key=\"TM_MODE\">user</data>" << endl;
+	for (int n = 0; n < nodes; n++) {
+		out << "    <node id=\"n" << n << "\">" << endl;
+		out << "      <data key=\"NODEID\">" << nodeLabel(n) << "</data>" << endl;
+		out << "      <data key=\"iLID\">" << randomLID() << "</data>" << endl;
+		out << "    </node>" << endl;
+	}
+	for (int n = 0; n < nodes; n++) {
+		edges.insert(pair<int, int>(n, (n + 1) % nodes));
+		edges.insert(pair<int, int>((n + 1) % nodes, n));
+	}
+	while ((int)edges.size() < nodes * degree) {
+		int a = rand() % nodes;
+		int b = rand() % nodes;
+		if (a == b)
+			continue;
+		edges.insert(pair<int, int>(a, b));
+		edges.insert(pair<int, int>(b, a));
+	}
+	for (set<pair<int, int> >::iterator it = edges.begin(); it != edges.end(); it++) {
+		out << "    <edge source=\"n" << it->first << "\" target=\"n" << it->second << "\">" << endl;
+		out << "      <data key=\"LID\">" << randomLID() << "</data>" << endl;
+		out << "    </edge>" << endl;
+	}
+	out << "  </graph>" << endl;
+	out << "</graphml>" << endl;
+	out.close();
+}
+
+/*time the single pair calculation over all query pairs and return the hop counts*/
+double benchPairs(TMgraph *graph, vector<pair<string, string> > &queries, vector<unsigned int> &hops) {
+	Bitvector fid(FID_LEN * 8);
+	unsigned int numberOfHops;
+	double start = now();
+	hops.clear();
+	for (size_t i = 0; i < queries.size(); i++) {
+		string path;
+		fid.clear();
+		graph->calculateFID(queries[i].first, queries[i].second, fid, numberOfHops, path);
+		hops.push_back(numberOfHops);
+	}
+	return now() - start;
+}
+
+/*time the rendezvous calculation for a number of publishers and subscribers*/
+double benchMatch(TMgraph *graph, vector<string> &labels, int rounds) {
+	double start = now();
+	srand(1);
+	for (int r = 0; r < rounds; r++) {
+		set<string> publishers;
+		set<string> subscribers;
+		map<string, Bitvector *> result;
+		map<string, set<string> > path_vectors;
+		for (int i = 0; i < 4; i++)
+			publishers.insert(labels[rand() % labels.size()]);
+		for (int i = 0; i < 16; i++)
+			subscribers.insert(labels[rand() % labels.size()]);
+		graph->calculateFID(publishers, subscribers, result, path_vectors);
+		for (map<string, Bitvector *>::iterator it = result.begin(); it != result.end(); it++)
+			delete it->second;
+	}
+	return now() - start;
+}
+
+int main(int argc, char* argv[]) {
+	int nodes = 0;
+	int degree = 4;
+	int no_queries = 2000;
+	char c;
+	string file_name = "topology.graphml";
+	while ((c = getopt (argc, argv, "n:d:q:")) != -1){
+		switch (c)
+		{
+			case 'n':
+			nodes = atoi(optarg);
+			break;
+			case 'd':
+			degree = atoi(optarg);
+			break;
+			case 'q':
+			no_queries = atoi(optarg);
+			break;
+			default:
+			cout << "Usage: ./tm_bench [-n nodes] [-d degree] [-q queries] [topology.graphml]" << endl;
+			return 1;
+		}
+	}
+	if (optind < argc)
+		file_name = argv[optind];
+	srand(0);
+	if (nodes > 0) {
+		file_name = "/tmp/tm_bench_" + to_string(nodes) + ".graphml";
+		cout << "TM bench: generating " << nodes << " nodes with out-degree " << degree << " into " << file_name << endl;
+		writeSyntheticTopology(file_name.c_str(), nodes, degree);
+	}
+	TMIgraph igraph_tm;
+	TMCSRgraph csr_tm;
+	double t_load_igraph = now();
+	if (igraph_tm.readTopology(file_name.c_str()) < 0) {
+		cout << "TM bench: could not read " << file_name << endl;
+		return 1;
+	}
+	t_load_igraph = now() - t_load_igraph;
+	double t_load_csr = now();
+	csr_tm.readTopology(file_name.c_str());
+	t_load_csr = now() - t_load_csr;
+	/*the same random queries for both graphs - all pairs for small topologies*/
+	vector<string> labels;
+	for (map<string, int>::iterator it = csr_tm.reverse_node_index.begin(); it != csr_tm.reverse_node_index.end(); it++)
+		labels.push_back(it->first);
+	vector<pair<string, string> > queries;
+	if ((long)(labels.size() * labels.size()) <= no_queries) {
+		for (size_t i = 0; i < labels.size(); i++)
+			for (size_t j = 0; j < labels.size(); j++)
+				queries.push_back(pair<string, string>(labels[i], labels[j]));
+	} else {
+		for (int i = 0; i < no_queries; i++)
+			queries.push_back(pair<string, string>(labels[rand() % labels.size()], labels[rand() % labels.size()]));
+	}
+	vector<unsigned int> igraph_hops;
+	vector<unsigned int> csr_hops;
+	double t_igraph = benchPairs(&igraph_tm, queries, igraph_hops);
+	double t_csr = benchPairs(&csr_tm, queries, csr_hops);
+	int mismatches = 0;
+	for (size_t i = 0; i < queries.size(); i++) {
+		if (igraph_hops[i] != csr_hops[i])
+			mismatches++;
+	}
+	int rounds = no_queries / 20 + 1;
+	double t_match_igraph = benchMatch(&igraph_tm, labels, rounds);
+	double t_match_csr = benchMatch(&csr_tm, labels, rounds);
+	/*TMIgraph requires both the RV and the TM to be part of the topology*/
+	double t_rvtm_igraph = 0;
+	double t_rvtm_csr = 0;
+	bool rvtm = (csr_tm.reverse_node_index.find(csr_tm.getRVNodeID()) != csr_tm.reverse_node_index.end())
+			&& (csr_tm.reverse_node_index.find(csr_tm.getNodeID()) != csr_tm.reverse_node_index.end());
+	if (rvtm) {
+		t_rvtm_igraph = now();
+		igraph_tm.calculateRVTMFIDs();
+		t_rvtm_igraph = now() - t_rvtm_igraph;
+		t_rvtm_csr = now();
+		csr_tm.calculateRVTMFIDs();
+		t_rvtm_csr = now() - t_rvtm_csr;
+	}
+	cout << endl;
+	cout << "TM bench: " << labels.size() << " nodes, " << csr_tm.edgeCount() << " edges, " << queries.size() << " queries" << endl;
+	printf("%-28s %14s %14s %9s\n", "", "igraph", "csr", "speedup");
+	printf("%-28s %12.3fms %12.3fms %8.1fx\n", "readTopology", t_load_igraph * 1e3, t_load_csr * 1e3, t_load_igraph / t_load_csr);
+	printf("%-28s %12.3fus %12.3fus %8.1fx\n", "calculateFID (per pair)", t_igraph * 1e6 / queries.size(), t_csr * 1e6 / queries.size(), t_igraph / t_csr);
+	printf("%-28s %12.3fus %12.3fus %8.1fx\n", "calculateFID (4 pubs/16 subs)", t_match_igraph * 1e6 / rounds, t_match_csr * 1e6 / rounds, t_match_igraph / t_match_csr);
+	if (rvtm)
+		printf("%-28s %12.3fms %12.3fms %8.1fx\n", "calculateRVTMFIDs", t_rvtm_igraph * 1e3, t_rvtm_csr * 1e3, t_rvtm_igraph / t_rvtm_csr);
+	cout << "TM bench: hop count mismatches: " << mismatches << endl;
+	return mismatches == 0 ? 0 : 2;
+}
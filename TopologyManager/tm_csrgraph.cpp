@@ -0,0 +1,852 @@
+/*
+ * Copyright (C) 2010-2011  George Parisis and Dirk Trossen
+ * Copyright (C) 2015-2018  Mays AL-Naday
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+#include "tm_csrgraph.hpp"
+#include <algorithm>
+#include <functional>
+#include <unistd.h>
+
+TMCSRgraph::TMCSRgraph() {
+	igraph_i_set_attribute_table(&igraph_cattribute_table);
+	epoch = 0;
+	number_of_nodes = 0;
+	number_of_connections = 0;
+}
+
+TMCSRgraph::~TMCSRgraph() {
+	map<string, Bitvector *>::iterator nodeID_iLID_iter;
+	map<int, Bitvector *>::iterator edge_LID_iter;
+	for (nodeID_iLID_iter = nodeID_iLID.begin(); nodeID_iLID_iter != nodeID_iLID.end(); nodeID_iLID_iter++) {
+		delete (*nodeID_iLID_iter).second;
+	}
+	for (edge_LID_iter = edge_LID.begin(); edge_LID_iter != edge_LID.end(); edge_LID_iter++) {
+		delete (*edge_LID_iter).second;
+	}
+}
+
+int TMCSRgraph::readTopology(const char *file_name) {
+	int ret;
+	igraph_t graph;
+	ifstream infile;
+	std::string str;
+	size_t found_5, found_6, first, second;
+	FILE *instream;
+	infile.open(file_name, ifstream::in);
+	if (infile.fail()) {
+		return -1;
+	}
+	/*first the Global graph attributes - c igraph does not do it!!*/
+	while (infile.good()) {
+		getline(infile, str);
+		found_5 = str.find("<data key=\"FID_LEN\">");
+		found_6 = str.find("<data key=\"g_FID_LEN\">");
+		if ((found_5 != string::npos) || ((found_6 != string::npos))) {
+			first = str.find(">");
+			second = str.find("<", first);
+			sscanf(str.substr(first + 1, second - first - 1).c_str(), "%d", &fid_len);
+		}
+		found_5 = str.find("<data key=\"TM\">");
+		found_6 = str.find("<data key=\"g_TM\">");
+		if ((found_5 != string::npos) || ((found_6 != string::npos))) {
+			first = str.find(">");
+			second = str.find("<", first);
+			nodeID = str.substr(first + 1, second - first - 1);
+			/*\TODO: the RM need to provide its nodeID to the TM when it comes alive - at the moment, it is assumed to be the same as the TMnodeID*/
+			RMnodeID = nodeID;
+		}
+		found_5 = str.find("<data key=\"RV\">");
+		found_6 = str.find("<data key=\"g_RV\">");
+		if ((found_5 != string::npos) || ((found_6 != string::npos))) {
+			first = str.find(">");
+			second = str.find("<", first);
+			RVnodeID = str.substr(first + 1, second - first - 1);
+		}
+		found_5 = str.find("<data key=\"TM_MODE\">");
+		found_6 = str.find("<data key=\"g_TM_MODE\">");
+		if ((found_5 != string::npos) || ((found_6 != string::npos))) {
+			first = str.find(">");
+			second = str.find("<", first);
+			mode = str.substr(first + 1, second - first - 1);
+		}
+	}
+	infile.close();
+	/*iGraph is only used as graphML parser, the graph is converted into CSR arrays below*/
+	instream = fopen(file_name, "r");
+	ret = igraph_read_graph_graphml(&graph, instream, 0);
+	fclose(instream);
+	if (ret < 0) {
+		return ret;
+	}
+	number_of_nodes = igraph_vcount(&graph);
+	number_of_connections = igraph_ecount(&graph);
+	cout << "TM: " << number_of_nodes << " nodes" << endl;
+	cout << "TM: " << number_of_connections << " edges" << endl;
+	/*nodes*/
+	node_label.resize(number_of_nodes);
+	node_name.resize(number_of_nodes);
+	node_ilid.assign(number_of_nodes * CSR_LID_WORDS, 0);
+	node_handle.reserve(number_of_nodes);
+	/*node and link names are optional in the graphML file*/
+	bool vertex_names = igraph_cattribute_has_attr(&graph, IGRAPH_ATTRIBUTE_VERTEX, "NAME");
+	bool edge_names = igraph_cattribute_has_attr(&graph, IGRAPH_ATTRIBUTE_EDGE, "NAME");
+	for (int i = 0; i < number_of_nodes; i++) {
+		std::string nID = std::string(igraph_cattribute_VAS(&graph, "NODEID", i));
+		std::string iLID = std::string(igraph_cattribute_VAS(&graph, "iLID", i));
+		Bitvector *ilid = new Bitvector(iLID);
+		reserveLID(*ilid);
+		node_label[i] = nID;
+		node_name[i] = vertex_names ? string(igraph_cattribute_VAS(&graph, "NAME", i)) : string(" ");
+		parseLID(iLID, &node_ilid[i * CSR_LID_WORDS]);
+		node_handle.insert(pair<std::string, int>(nID, i));
+		reverse_node_index.insert(pair<std::string, int>(nID, i));
+		nodeID_iLID.insert(pair<std::string, Bitvector *>(nID, ilid));
+		vertex_iLID.insert(pair<int, Bitvector *>(i, ilid));
+		RVFID.insert(pair<std::string, Bitvector *>(nID, NULL));
+		TMFID.insert(pair<std::string, Bitvector *>(nID, NULL));
+	}
+	/*edges: count the out and in degrees first, then place every edge in its CSR slot (ordered by edge id within a row)*/
+	vector<int> edge_from(number_of_connections);
+	vector<int> edge_to(number_of_connections);
+	out_offset.assign(number_of_nodes + 1, 0);
+	in_offset.assign(number_of_nodes + 1, 0);
+	for (int i = 0; i < number_of_connections; i++) {
+		igraph_integer_t head;
+		igraph_integer_t tail;
+		igraph_edge(&graph, i, &head, &tail);
+		edge_from[i] = head;
+		edge_to[i] = tail;
+		out_offset[head + 1]++;
+		in_offset[tail + 1]++;
+	}
+	for (int n = 0; n < number_of_nodes; n++) {
+		out_offset[n + 1] += out_offset[n];
+		in_offset[n + 1] += in_offset[n];
+	}
+	vector<int> out_fill(out_offset.begin(), out_offset.end() - 1);
+	vector<int> in_fill(in_offset.begin(), in_offset.end() - 1);
+	slot_source.resize(number_of_connections);
+	slot_target.resize(number_of_connections);
+	slot_eid.resize(number_of_connections);
+	slot_up.assign(number_of_connections, true);
+	slot_lid.assign(number_of_connections * CSR_LID_WORDS, 0);
+	in_slots.resize(number_of_connections);
+	eid_slot.resize(number_of_connections);
+	eid_lid_position.resize(number_of_connections);
+	eid_name.resize(number_of_connections);
+	eid_qos_prio.assign(number_of_connections, 0);
+	//file to write the LIDs, so that ICN-SDN can access them
+	std::ofstream outfile ("/tmp/lids");
+	for (int i = 0; i < number_of_connections; i++) {
+		std::string LID = std::string(igraph_cattribute_EAS(&graph, "LID", i));
+		int slot = out_fill[edge_from[i]]++;
+		slot_source[slot] = edge_from[i];
+		slot_target[slot] = edge_to[i];
+		slot_eid[slot] = i;
+		parseLID(LID, &slot_lid[slot * CSR_LID_WORDS]);
+		in_slots[in_fill[edge_to[i]]++] = slot;
+		eid_slot[i] = slot;
+		eid_lid_position[i] = lidPosition(LID);
+		eid_name[i] = edge_names ? string(igraph_cattribute_EAS(&graph, "NAME", i)) : string();
+		reverse_edge_index.insert(pair<std::string, int>(LID, i));
+		Bitvector *lid = new Bitvector(LID);
+		reserveLID(*lid);
+		edge_LID.insert(pair<int, Bitvector *>(i, lid));
+		outfile << "Source " << "0000000" << edge_from[i] + 1 << " destination " << "0000000" << edge_to[i] + 1 << " LID " << lid->to_string() << endl;
+		cout << "edge " << i
+		<<" "<<edge_from[i]<<"->"<<edge_to[i]<<" has LID  "
+		<< lid->to_string() << endl;
+	}
+	outfile.close();
+	igraph_i_attribute_destroy(&graph);
+	igraph_destroy(&graph);
+	/*scratch arrays are allocated once and reused by every path calculation*/
+	scratch_stamp.assign(number_of_nodes, 0);
+	scratch_parent.assign(number_of_nodes, -1);
+	scratch_hops.assign(number_of_nodes, 0);
+	scratch_distance.assign(number_of_nodes, 0);
+	scratch_queue.resize(number_of_nodes);
+	scratch_heap.reserve(number_of_connections + 1);
+	epoch = 0;
+	return ret;
+}
+
+int TMCSRgraph::reportTopology(Moly &moly) {
+	node_role_t node_type;
+	uint32_t nodeID_int;
+	uint16_t nighbour_nodeID_int;
+	string node_ID_suffex;
+	string neighbour_ID_suffex;
+	string name;
+	/*Publish nodes list*/
+	ofstream topology_nodes;
+	ofstream topology_links;
+	topology_nodes.open("/home/point/topology_nodes.csv");
+	topology_links.open("/home/point/topology_links.csv");
+	for (int vertex = 0; vertex < number_of_nodes; vertex++) {
+		node_ID_suffex = node_label[vertex];
+		node_ID_suffex.erase(0, node_ID_suffex.find_first_not_of('0'));
+		nodeID_int = atol(node_ID_suffex.c_str());
+		name = (node_name[vertex] == " ") ? "FN" : node_name[vertex];
+		node_type = NODE_ROLE_FN;
+		topology_nodes << nodeID_int << "," << name << "," << node_type << ", 9" << endl;
+		if(! moly.addNode(name, nodeID_int, node_type)){
+			cout << "TM: moly failed to add Node " << nodeID_int << endl;
+			return -1;
+		} else
+			cout << "TM: node: " << nodeID_int << " of type : " << node_type << " reported to MA" << endl;
+		if (node_label[vertex] == RVnodeID) {
+			usleep(40000);
+			name = (node_name[vertex] == " ") ? "RV" : node_name[vertex];
+			node_type = NODE_ROLE_RV;
+			topology_nodes << nodeID_int << "," << name << "," << node_type << ", 9" << endl;
+			if(!moly.addNode(name, nodeID_int, node_type)) {
+				cout << "TM: moly failed to send node type" << node_type << endl;
+				return -1 ;
+			}else
+				cout << "TM: node: " << nodeID_int << " of type : " << node_type << " reported to MA" << endl;
+		}
+		if (node_label[vertex] == nodeID){
+			usleep(40000);
+			name = (node_name[vertex] == " ") ? "TM" : node_name[vertex];
+			node_type = NODE_ROLE_TM;
+			topology_nodes << nodeID_int << "," << name << "," << node_type << ", 9" << endl;
+			if(!moly.addNode(name, nodeID_int, node_type)) {
+				cout << "TM: moly failed to send node type"<< node_type << endl;
+				return -1;
+			}else
+				cout << "TM: node: " << nodeID_int << " of type : " << node_type << " reported to MA" << endl;
+		}
+		/*the outgoing edges of vertex are adjacent in the CSR arrays*/
+		for (int slot = out_offset[vertex]; slot < out_offset[vertex + 1]; slot++) {
+			if (!slot_up[slot])
+				continue;
+			int eid = slot_eid[slot];
+			neighbour_ID_suffex = node_label[slot_target[slot]];
+			neighbour_ID_suffex.erase(0, neighbour_ID_suffex.find_first_not_of('0'));
+			nighbour_nodeID_int = atoi(neighbour_ID_suffex.c_str());
+			uint16_t lid_int = eid_lid_position[eid];
+			topology_links << lid_int << "," << nodeID_int << "," << nighbour_nodeID_int << "," << LINK_TYPE_802_3 << ",9" << endl;
+			//FIXME the Moly::AddLink primitive has changed. extend to provide the correct port number instead of using link type as port number
+			cout << "TM: report link " << lid_int << " to MA " << endl;
+			if(!moly.addLink(lid_int, nighbour_nodeID_int , nodeID_int, 1, LINK_TYPE_802_3, eid_name[eid]))
+			{
+				cout << "TM: moly failed to send link"<< nodeID_int << "->" << nighbour_nodeID_int << endl;
+				return -1;
+			}
+			else {
+				cout << "TM: link id: " << lid_int << " from " << nodeID_int << "-> " << nighbour_nodeID_int << " reported to MA" << endl;
+				usleep(40000);
+			}
+		}
+		usleep(40000);
+	}
+	topology_nodes.close();
+	topology_links.close();
+	return 0;
+}
+
+void TMCSRgraph::updateLinkState(const string &lid, const QoSList &status){
+	map<string, int>::iterator eid_it = reverse_edge_index.find(lid);
+	if (eid_it == reverse_edge_index.end()) {
+		cerr << "TM: LSM update for unknown LID" << endl;
+		return;
+	}
+	int eid = eid_it->second;
+	QoSList::const_iterator prio_it = status.find(QoS_PRIO);
+	if (prio_it == status.end()) {
+		return;
+	}
+	uint8_t lp = prio_it->second;
+	eid_qos_prio[eid] = lp;
+	// Update the QoSLinkWeightMap of the TM
+	// 1. Check that this link level exists
+	QoSLinkWeightMap::iterator mit = qlwm.find(lp);
+	if (mit==qlwm.end()) {
+		createNewQoSLinkPrioMap(lp);
+		//return; Do not return... we have to fix all the other qos weights also
+	}
+	// 2. Update all the eid positions in the QoS map - edge ids are persistent, so the vectors never need to be re-indexed
+	for (mit = qlwm.begin(); mit!=qlwm.end(); ++mit){
+		igraph_vector_t * vec = &mit->second;
+		if (mit->first < lp){
+			// For any priority lower than this edge's... avoid using this edge
+			VECTOR(*vec)[eid] = UCHAR_MAX;
+		}
+		else {
+			// For all the others keep the real weight
+			VECTOR(*vec)[eid] = (MAX_PRIO-lp);
+		}
+	}
+}
+
+void TMCSRgraph::createNewQoSLinkPrioMap(const uint8_t & map_prio){
+	cout<<"Creating new priority plane: "<<(int)map_prio<<endl;
+	// Create the line as a c array!
+	igraph_real_t * data = new igraph_real_t[number_of_connections];
+	for (int eid = 0; eid < number_of_connections; eid++) {
+		uint8_t ep = eid_qos_prio[eid];
+		uint8_t weight = UCHAR_MAX;
+		// If the current edge prio is the same of more that
+		// keep the exact weight
+		if (map_prio >= ep) weight = MAX_PRIO-ep; // P=98 -> weight=2
+		data[eid] = weight;
+	}
+	// Port data to vector
+	igraph_vector_t vec;
+	igraph_vector_view(&vec, data, number_of_connections);
+	// Add plane to the map
+	qlwm[map_prio]=vec;
+}
+
+/* Update the topology graph by disabling/re-enabling edges. Vertices are persistent and so are edges, a removed edge keeps
+ * its CSR slot (and LID) and is simply skipped by the path calculations until it is restored*/
+bool TMCSRgraph::updateGraph(const string &source, const string &destination, bool bidirectional, bool remove, Moly &moly){
+	uint16_t sourceInt;
+	uint16_t destinationInt;
+	string sourceSuffix;
+	string destinationSuffix;
+	bool ret = false;
+	bool exists = false;
+	bool broken = false;
+	int NoEdges;
+	int source_vertex = handle(source);
+	int destination_vertex = handle(destination);
+	if (source_vertex < 0 || destination_vertex < 0) {
+		cout << "TM: link state update for unknown node(s) " << source << " - " << destination << endl;
+		return false;
+	}
+	ICNEdge forward_edge = pair<int, int>(source_vertex, destination_vertex);
+	ICNEdge backward_edge = pair<int, int>(destination_vertex, source_vertex);
+	int forward_slot = findSlot(source_vertex, destination_vertex);
+	int backward_slot = findSlot(destination_vertex, source_vertex);
+	if (bidirectional) {
+		/*both directions are processed*/
+		NoEdges = 2;
+		broken = (freedLIDs.find(forward_edge) != freedLIDs.end()) && (freedLIDs.find(backward_edge) != freedLIDs.end());
+	}
+	else {
+		/*only reported direction is processed*/
+		NoEdges = 1;
+		broken = (freedLIDs.find(forward_edge) != freedLIDs.end());
+	}
+	exists = (forward_slot > -1) && slot_up[forward_slot];
+	sourceSuffix = source;
+	sourceSuffix.erase(0, sourceSuffix.find_first_not_of('0'));
+	sourceInt = atoi(sourceSuffix.c_str());
+	destinationSuffix = destination;
+	destinationSuffix.erase(0, destinationSuffix.find_first_not_of('0'));
+	destinationInt = atoi(destinationSuffix.c_str());
+	/*even if bidrectional = true, if the forward edge exists, it is fair to assume the backward edge also exists*/
+	if (remove && exists) {
+		/*disable an existing edge(s)*/
+		int eid = slot_eid[forward_slot];
+		slot_up[forward_slot] = false;
+		freedLIDs.insert(pair<ICNEdge, Bitvector *>(forward_edge, edge_LID[eid]));
+		//FIXME the Moly::AddLink primitive has changed. fix port number to correct value rather than using linktype as port number
+		if(!moly.linkState(eid_lid_position[eid], destinationInt, sourceInt, LINK_TYPE_802_3, LINK_TYPE_802_3, LINK_STATE_DOWN))
+		{
+			cout << "TM: moly failed to update link state "<< sourceInt << "->" << destinationInt << "to DOWN" << endl;
+			return -1;
+		}
+		else {
+			cout << "TM: link: " << sourceInt << "-> " << destinationInt << " state DOWN reported to MA" << endl;
+		}
+		if ((NoEdges == 2) && (backward_slot > -1) && slot_up[backward_slot]) {
+			eid = slot_eid[backward_slot];
+			slot_up[backward_slot] = false;
+			freedLIDs.insert(pair<ICNEdge, Bitvector *>(backward_edge, edge_LID[eid]));
+			//FIXME the Moly::AddLink primitive has changed. fix port number to correct value rather than using linktype as port number
+			if(!moly.linkState(eid_lid_position[eid], sourceInt, destinationInt, LINK_TYPE_802_3, LINK_TYPE_802_3, LINK_STATE_DOWN))
+			{
+				cout << "TM: moly failed to update link state "<< destinationInt << "->" << sourceInt << "to DOWN" << endl;
+				return -1;
+			}
+			else {
+				cout << "TM: link: " << destinationInt << "-> " << sourceInt << " state DOWN reported to MA" << endl;
+			}
+		}
+		cout << "TM: removed " << NoEdges << " edges" << endl;
+		ret = true;
+	}
+	else if ((!remove) && (!exists) && broken && (forward_slot > -1)){
+		/*re-enable the broken edge(s), their LIDs never left the CSR slots*/
+		int eid = slot_eid[forward_slot];
+		slot_up[forward_slot] = true;
+		freedLIDs.erase(forward_edge);
+		//FIXME the Moly::AddLink primitive has changed. fix port number to correct value rather than using linktype as port number
+		if(!moly.linkState(eid_lid_position[eid], destinationInt, sourceInt, LINK_TYPE_802_3, LINK_TYPE_802_3, LINK_STATE_UP))
+		{
+			cout << "TM: moly failed to update link state "<< sourceInt << "->" << destinationInt << "to UP" << endl;
+			return -1;
+		}
+		else {
+			cout << "TM: link: " << sourceInt << "-> " << destinationInt << " state UP reported to MA" << endl;
+		}
+		if ((NoEdges == 2) && (backward_slot > -1)) {
+			eid = slot_eid[backward_slot];
+			slot_up[backward_slot] = true;
+			freedLIDs.erase(backward_edge);
+			//FIXME the Moly::AddLink primitive has changed. fix port number to correct value rather than using linktype as port number
+			if(!moly.linkState(eid_lid_position[eid], sourceInt, destinationInt, LINK_TYPE_802_3, LINK_TYPE_802_3, LINK_STATE_UP))
+			{
+				cout << "TM: moly failed to update link state "<< destinationInt << "->" << sourceInt << "to UP" << endl;
+				return -1;
+			}
+			else {
+				cout << "TM: link: " << destinationInt << "-> " << sourceInt << " state UP reported to MA" << endl;
+			}
+		}
+		cout << "TM: added " << NoEdges << " edges" << endl;
+		ret = true;
+	}
+	else {
+		cout << "TM: no action taken, either edge exists and therefore cannot be added again or does not exist and therefore cannot be removed again" << endl;
+	}
+	return ret;
+}
+
+bool TMCSRgraph::assignLIDs(int NoLIDs, std::set<Bitvector *> &NewLIDs){
+	return allocateLIDs(NoLIDs, NewLIDs);
+}
+
+Bitvector * TMCSRgraph::calculateLID() {
+	return allocateLID();
+}
+
+void TMCSRgraph::updateTMStates(){
+	/*nothing to do: edge ids, and therefore edge_LID and reverse_edge_index, survive graph updates*/
+}
+
+int TMCSRgraph::vertexCount() {
+	return number_of_nodes;
+}
+
+int TMCSRgraph::edgeCount() {
+	return number_of_connections;
+}
+
+int TMCSRgraph::handle(const string &nodeID) {
+	unordered_map<string, int>::iterator it = node_handle.find(nodeID);
+	if (it == node_handle.end())
+		return -1;
+	return it->second;
+}
+
+int TMCSRgraph::findSlot(int from, int to) {
+	for (int slot = out_offset[from]; slot < out_offset[from + 1]; slot++) {
+		if (slot_target[slot] == to)
+			return slot;
+	}
+	return -1;
+}
+
+void TMCSRgraph::newEpoch() {
+	epoch++;
+	if (epoch == 0) {
+		/*the stamp counter wrapped around, stale stamps could collide with the new epoch*/
+		std::fill(scratch_stamp.begin(), scratch_stamp.end(), 0);
+		epoch = 1;
+	}
+}
+
+bool TMCSRgraph::reached(int node) {
+	return scratch_stamp[node] == epoch;
+}
+
+bool TMCSRgraph::bfs(int source, int destination, bool reverse) {
+	int head = 0;
+	int tail = 0;
+	newEpoch();
+	scratch_stamp[source] = epoch;
+	scratch_parent[source] = -1;
+	scratch_hops[source] = 0;
+	scratch_queue[tail++] = source;
+	while (head < tail) {
+		int node = scratch_queue[head++];
+		if (node == destination)
+			return true;
+		int first = reverse ? in_offset[node] : out_offset[node];
+		int last = reverse ? in_offset[node + 1] : out_offset[node + 1];
+		for (int i = first; i < last; i++) {
+			int slot = reverse ? in_slots[i] : i;
+			if (!slot_up[slot])
+				continue;
+			int next = reverse ? slot_source[slot] : slot_target[slot];
+			if (scratch_stamp[next] == epoch)
+				continue;
+			scratch_stamp[next] = epoch;
+			scratch_parent[next] = slot;
+			scratch_hops[next] = scratch_hops[node] + 1;
+			scratch_queue[tail++] = next;
+		}
+	}
+	return destination < 0;
+}
+
+bool TMCSRgraph::dijkstra(int source, int destination, const igraph_vector_t *weights) {
+	greater<pair<double, int> > cmp;
+	newEpoch();
+	scratch_heap.clear();
+	scratch_stamp[source] = epoch;
+	scratch_parent[source] = -1;
+	scratch_hops[source] = 0;
+	scratch_distance[source] = 0;
+	scratch_heap.push_back(pair<double, int>(0, source));
+	while (!scratch_heap.empty()) {
+		pop_heap(scratch_heap.begin(), scratch_heap.end(), cmp);
+		pair<double, int> top = scratch_heap.back();
+		scratch_heap.pop_back();
+		int node = top.second;
+		/*skip stale heap entries (lazy deletion)*/
+		if (top.first > scratch_distance[node])
+			continue;
+		if (node == destination)
+			return true;
+		for (int slot = out_offset[node]; slot < out_offset[node + 1]; slot++) {
+			if (!slot_up[slot])
+				continue;
+			int next = slot_target[slot];
+			double distance = top.first + VECTOR(*weights)[slot_eid[slot]];
+			if ((scratch_stamp[next] == epoch) && (scratch_distance[next] <= distance))
+				continue;
+			scratch_stamp[next] = epoch;
+			scratch_parent[next] = slot;
+			scratch_hops[next] = scratch_hops[node] + 1;
+			scratch_distance[next] = distance;
+			scratch_heap.push_back(pair<double, int>(distance, next));
+			push_heap(scratch_heap.begin(), scratch_heap.end(), cmp);
+		}
+	}
+	return false;
+}
+
+void TMCSRgraph::orPathLIDs(int node, bool reverse, const int *parent, uint32_t *fid) {
+	int slot = parent[node];
+	while (slot > -1) {
+		const uint32_t *lid = &slot_lid[slot * CSR_LID_WORDS];
+		for (int w = 0; w < CSR_LID_WORDS; w++)
+			fid[w] |= lid[w];
+		node = reverse ? slot_target[slot] : slot_source[slot];
+		slot = parent[node];
+	}
+}
+
+void TMCSRgraph::pathString(int node, const int *parent, string &path) {
+	vector<int> nodes;
+	int slot = parent[node];
+	nodes.push_back(node);
+	while (slot > -1) {
+		node = slot_source[slot];
+		nodes.push_back(node);
+		slot = parent[node];
+	}
+	for (int j = nodes.size() - 1; j >= 0; j--) {
+		path += node_label[nodes[j]];
+		if (j > 0) {
+			path += "->";
+		}
+	}
+}
+
+void TMCSRgraph::orWords(Bitvector &fid, const uint32_t *words) {
+	uint32_t *data = fid.data_words();
+	int no_words = fid.max_word() + 1;
+	if (no_words > CSR_LID_WORDS)
+		no_words = CSR_LID_WORDS;
+	for (int w = 0; w < no_words; w++)
+		data[w] |= words[w];
+}
+
+void TMCSRgraph::parseLID(const string &lid, uint32_t *words) {
+	int length = lid.length();
+	/*same bit order as Bitvector(string &): the first character is the most significant bit*/
+	for (int i = 0; i < length; i++) {
+		if (lid[i] == '1') {
+			int bit = length - i - 1;
+			if (bit < FID_LEN * 8)
+				words[bit >> 5] |= 1U << (bit & 31);
+		}
+	}
+}
+
+uint16_t TMCSRgraph::lidPosition(const string &lid) {
+	uint16_t lid_int = 0;
+	for (uint16_t k = 0; k < lid.length(); k++) {
+		if (lid[k] == '1') {
+			lid_int = k;
+			break;
+		}
+	}
+	return lid_int;
+}
+
+Bitvector *TMCSRgraph::calculateFID(string &source, string &destination) {
+	Bitvector *result = new Bitvector(FID_LEN * 8);
+	int from = handle(source);
+	int to = handle(destination);
+	if (from < 0 || to < 0)
+		return result;
+	if (bfs(from, to, false)) {
+		/*a path is found: "or" the LIDs along the path and the internal linkID of the destination*/
+		memset(scratch_fid, 0, sizeof(scratch_fid));
+		orPathLIDs(to, false, &scratch_parent[0], scratch_fid);
+		orWords(*result, scratch_fid);
+		orWords(*result, &node_ilid[to * CSR_LID_WORDS]);
+	}
+	return result;
+}
+
+void TMCSRgraph::calculateFID(string &source, string &destination, Bitvector &resultFID, unsigned int &numberOfHops, string &path) {
+	int from = handle(source);
+	int to = handle(destination);
+	numberOfHops = UINT_MAX;
+	if (from < 0 || to < 0)
+		return;
+	if (bfs(from, to, false)) {
+		memset(scratch_fid, 0, sizeof(scratch_fid));
+		orPathLIDs(to, false, &scratch_parent[0], scratch_fid);
+		orWords(resultFID, scratch_fid);
+		pathString(to, &scratch_parent[0], path);
+		/*number of nodes on the path, as reported by the igraph based TM*/
+		numberOfHops = scratch_hops[to] + 1;
+	}
+	/*now for the destination "or" the internal linkID*/
+	orWords(resultFID, &node_ilid[to * CSR_LID_WORDS]);
+}
+
+/*main function for rendezvous*/
+void TMCSRgraph::calculateFID(set<string> &publishers, set<string> &subscribers, map<string, Bitvector *> &result, map<string, set<string> > &path_vectors) {
+	set<string>::iterator subscribers_it;
+	set<string>::iterator publishers_it;
+	set<string> paths_per_pub;
+	vector<string> pub_labels;
+	int no_publishers;
+	/*first add all publishers to the hashtable with NULL FID and grow one BFS tree per known publisher*/
+	for (publishers_it = publishers.begin(); publishers_it != publishers.end(); publishers_it++) {
+		string pub = *publishers_it;
+		result.insert(pair<string, Bitvector *>(pub, NULL));
+		path_vectors.insert(pair<string, set<string> >(pub, paths_per_pub));
+		if (handle(pub) > -1)
+			pub_labels.push_back(pub);
+	}
+	no_publishers = pub_labels.size();
+	scratch_multi_hops.resize(no_publishers * number_of_nodes);
+	scratch_multi_parent.resize(no_publishers * number_of_nodes);
+	for (int p = 0; p < no_publishers; p++) {
+		unsigned int *hops = &scratch_multi_hops[p * number_of_nodes];
+		int *parent = &scratch_multi_parent[p * number_of_nodes];
+		bfs(handle(pub_labels[p]), -1, false);
+		for (int n = 0; n < number_of_nodes; n++) {
+			hops[n] = reached(n) ? scratch_hops[n] : UINT_MAX;
+			parent[n] = scratch_parent[n];
+		}
+	}
+	for (subscribers_it = subscribers.begin(); subscribers_it != subscribers.end(); subscribers_it++) {
+		int sub = handle(*subscribers_it);
+		int best = -1;
+		unsigned int minimumNumberOfHops = UINT_MAX;
+		if (sub < 0)
+			continue;
+		/*pick the closest publisher, the first one wins on ties*/
+		for (int p = 0; p < no_publishers; p++) {
+			unsigned int hops = scratch_multi_hops[p * number_of_nodes + sub];
+			if (minimumNumberOfHops > hops) {
+				minimumNumberOfHops = hops;
+				best = p;
+			}
+		}
+		if (best < 0) {
+			cout << "TM: no publisher can reach subscriber " << *subscribers_it << endl;
+			continue;
+		}
+		const int *parent = &scratch_multi_parent[best * number_of_nodes];
+		string &bestPublisher = pub_labels[best];
+		memset(scratch_fid, 0, sizeof(scratch_fid));
+		orPathLIDs(sub, false, parent, scratch_fid);
+		/*When the resiliency support is in effect, return the set of path vectors for each publisher*/
+		if(extension[RS]){
+			string best_path;
+			pathString(sub, parent, best_path);
+			cout<<"Best path is: "<<best_path<<endl;
+			path_vectors[bestPublisher].insert(best_path);
+		}
+		if ((*result.find(bestPublisher)).second == NULL) {
+			/*add the publisher to the result*/
+			result[bestPublisher] = new Bitvector(FID_LEN * 8);
+		}
+		/*or the result FID*/
+		orWords(*result[bestPublisher], scratch_fid);
+		orWords(*result[bestPublisher], &node_ilid[sub * CSR_LID_WORDS]);
+	}
+}
+
+void TMCSRgraph::UcalculateFID(string &publisher,
+							   set<string> &subscribers,
+							   map<string, Bitvector *> &result,
+							   map<string, string > &paths
+							   )
+{
+	set<string>::iterator subscribers_it;
+	string bestSubscriber;
+	unsigned int minimumNumberOfHops = UINT_MAX;
+	int from = handle(publisher);
+	/*first add all subscribers to the result map with NULL FID*/
+	for (subscribers_it = subscribers.begin(); subscribers_it != subscribers.end(); subscribers_it++) {
+		result.insert(pair<string, Bitvector *> (*subscribers_it, NULL));
+		paths.insert(pair<string, string> (*subscribers_it, ""));
+	}
+	if (from < 0)
+		return;
+	/*a single BFS tree from the publisher covers all subscribers*/
+	bfs(from, -1, false);
+	for (subscribers_it = subscribers.begin(); subscribers_it != subscribers.end(); subscribers_it++) {
+		int to = handle(*subscribers_it);
+		if (to < 0 || !reached(to))
+			continue;
+		/*check for the min hop-count path, i.e. nearest subscriber*/
+		if (minimumNumberOfHops > scratch_hops[to] + 1) {
+			minimumNumberOfHops = scratch_hops[to] + 1;
+			bestSubscriber = *subscribers_it;
+		}
+	}
+	/*if a path is found then pass it to the result table*/
+	if (bestSubscriber != "") {
+		int to = handle(bestSubscriber);
+		Bitvector *bestFID = new Bitvector(FID_LEN * 8);
+		memset(scratch_fid, 0, sizeof(scratch_fid));
+		orPathLIDs(to, false, &scratch_parent[0], scratch_fid);
+		orWords(*bestFID, scratch_fid);
+		orWords(*bestFID, &node_ilid[to * CSR_LID_WORDS]);
+		result[bestSubscriber] = bestFID;
+		pathString(to, &scratch_parent[0], paths[bestSubscriber]);
+		cout << "TM: Best Subscriber: " << bestSubscriber << ", Best Path: " << paths[bestSubscriber] << ", FID: " << bestFID->to_string() << endl;
+	}
+}
+
+void TMCSRgraph::calculateRVTMFIDs()
+{
+	int tm = handle(getNodeID());
+	int rv = handle(getRVNodeID());
+	for (int n = 0; n < number_of_nodes; n++) {
+		RVFID[node_label[n]] = new Bitvector(FID_LEN * 8);
+		TMFID[node_label[n]] = new Bitvector(FID_LEN * 8);
+		TM_to_nodeFID[node_label[n]] = new Bitvector(FID_LEN * 8);
+	}
+	/*TM_to_nodeFID: one tree rooted at the TM over the outgoing edges*/
+	if (tm > -1) {
+		bfs(tm, -1, false);
+		for (int n = 0; n < number_of_nodes; n++) {
+			if (!reached(n))
+				continue;
+			memset(scratch_fid, 0, sizeof(scratch_fid));
+			orPathLIDs(n, false, &scratch_parent[0], scratch_fid);
+			orWords(*TM_to_nodeFID[node_label[n]], scratch_fid);
+			orWords(*TM_to_nodeFID[node_label[n]], &node_ilid[n * CSR_LID_WORDS]);
+		}
+		/*TMFID: one tree rooted at the TM over the incoming edges*/
+		bfs(tm, -1, true);
+		for (int n = 0; n < number_of_nodes; n++) {
+			if (!reached(n))
+				continue;
+			memset(scratch_fid, 0, sizeof(scratch_fid));
+			orPathLIDs(n, true, &scratch_parent[0], scratch_fid);
+			orWords(*TMFID[node_label[n]], scratch_fid);
+			orWords(*TMFID[node_label[n]], &node_ilid[tm * CSR_LID_WORDS]);
+		}
+	}
+	/*RVFID: one tree rooted at the RV over the incoming edges*/
+	if (rv > -1) {
+		bfs(rv, -1, true);
+		for (int n = 0; n < number_of_nodes; n++) {
+			if (!reached(n))
+				continue;
+			memset(scratch_fid, 0, sizeof(scratch_fid));
+			orPathLIDs(n, true, &scratch_parent[0], scratch_fid);
+			orWords(*RVFID[node_label[n]], scratch_fid);
+			orWords(*RVFID[node_label[n]], &node_ilid[rv * CSR_LID_WORDS]);
+		}
+	}
+}
+
+void TMCSRgraph::calculateFID_weighted(set<string> &publishers, set<string> &subscribers, map<string, Bitvector *> &result, map<string, set<string> > &path_vectors, const igraph_vector_t *weights) {
+	set<string>::iterator subscribers_it;
+	set<string>::iterator publishers_it;
+	string bestPublisher;
+	Bitvector resultFID(FID_LEN * 8);
+	Bitvector bestFID(FID_LEN * 8);
+	unsigned int numberOfHops = 0;
+	string curr_path;
+	set<string> paths_per_pub;
+	string best_path;
+	/*first add all publishers to the hashtable with NULL FID*/
+	for (publishers_it = publishers.begin(); publishers_it != publishers.end(); publishers_it++) {
+		string publ = *publishers_it;
+		result.insert(pair<string, Bitvector *>(publ, NULL));
+		path_vectors.insert(pair<string, set<string> >(publ, paths_per_pub));
+	}
+	for (subscribers_it = subscribers.begin(); subscribers_it != subscribers.end(); subscribers_it++) {
+		unsigned int minimumNumberOfHops = UINT_MAX;
+		bestPublisher = "";
+		for (publishers_it = publishers.begin(); publishers_it != publishers.end(); publishers_it++) {
+			resultFID.clear();
+			curr_path = "";
+			string str1 = (*publishers_it);
+			string str2 = (*subscribers_it);
+			calculateFID_weighted(str1, str2, resultFID, numberOfHops, curr_path, weights);
+			if (minimumNumberOfHops > numberOfHops) {
+				minimumNumberOfHops = numberOfHops;
+				bestPublisher = *publishers_it;
+				bestFID = resultFID;
+				best_path = curr_path;
+			}
+		}
+		if (bestPublisher == "") {
+			cout << "TM: no publisher can reach subscriber " << *subscribers_it << endl;
+			continue;
+		}
+		cout<<"Best path is: "<<best_path<<endl;
+		path_vectors[bestPublisher].insert(best_path);
+		if ((*result.find(bestPublisher)).second == NULL) {
+			/*add the publisher to the result*/
+			result[bestPublisher] = new Bitvector(bestFID);
+		} else {
+			Bitvector *existingFID = (*result.find(bestPublisher)).second;
+			/*or the result FID*/
+			*existingFID = *existingFID | bestFID;
+		}
+	}
+}
+
+void TMCSRgraph::calculateFID_weighted(string &source, string &destination, Bitvector &resultFID, unsigned int &numberOfHops, string &path, const igraph_vector_t *weights) {
+	int from = handle(source);
+	int to = handle(destination);
+	numberOfHops = UINT_MAX;
+	if (from < 0 || to < 0)
+		return;
+	if (dijkstra(from, to, weights)) {
+		memset(scratch_fid, 0, sizeof(scratch_fid));
+		orPathLIDs(to, false, &scratch_parent[0], scratch_fid);
+		orWords(resultFID, scratch_fid);
+		pathString(to, &scratch_parent[0], path);
+		/*number of edges on the path, as reported by the igraph based TM*/
+		numberOfHops = scratch_hops[to];
+		if (from == to)
+			numberOfHops = 1;
+	}
+	/*now for the destination "or" the internal linkID*/
+	orWords(resultFID, &node_ilid[to * CSR_LID_WORDS]);
+}
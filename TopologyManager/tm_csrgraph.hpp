@@ -0,0 +1,291 @@
+/*
+ * Copyright (C) 2010-2011  George Parisis and Dirk Trossen
+ * Copyright (C) 2015-2018  Mays AL-Naday
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+#ifndef TM_CSRGRAPH_HH
+#define TM_CSRGRAPH_HH
+
+#include <map>
+#include <set>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <igraph/igraph.h>
+#include <climits>
+#include <stdlib.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <bitvector.hpp>
+#include "blackadder_enums.hpp"
+
+
+#include "tm_graph.hpp"
+// igraph_version.hpp should be remade using make clean && make igraph_version.hpp
+// if igraph major or minor version changes
+#include "igraph_version.hpp"
+
+/**@brief number of 32bit words needed to hold a LIPSIN identifier inline
+ */
+#define CSR_LID_WORDS (FID_LEN / 4)
+
+using namespace std;
+
+/**@brief (Topology Manager) This is a representation of the network topology as a compressed-sparse-row (CSR) adjacency structure.
+ *
+ * iGraph is only used to parse the graphML file in readTopology(). Afterwards,
+ * nodes are integer handles (identical to the iGraph vertex ids) and every
+ * edge keeps its LID inline in a flat word array. Link failures and
+ * restorations flip a per-edge state flag instead of rebuilding the graph,
+ * so edge ids (and the QoS weight vectors indexed by them) stay stable.
+ *
+ * All path calculations reuse scratch arrays that are allocated once, which
+ * means that an instance must not be used concurrently by multiple threads.
+ */
+class TMCSRgraph : public TMgraph {
+public:
+	/**@brief Contructor: creates an empty CSR graph.
+	 */
+	TMCSRgraph();
+	/**@brief destroys the graph and frees the LID bitvectors.
+	 *
+	 */
+	virtual ~TMCSRgraph();
+	/**
+	 * @brief reads the graphml file that describes the network topology and builds the CSR adjacency arrays.
+	 *
+	 * Currently iGraph cannot read the Global Graph variables and, therefore, this methid does it manually.
+	 *
+	 * @param name the /graphML file name
+	 * @return <0 if there was a problem reading the file
+	 */
+	virtual int readTopology(const char *name);
+	/** @brief report the Topology to MOLY for monitoring
+	 *
+	 */
+	virtual int reportTopology(Moly &moly);
+	/**@brief it calculates a LIPSIN identifier from source to destination using the shortest path.
+	 *
+	 * @param source the node label of the source node.
+	 * @param destination the node label of the destination node.
+	 * @return a pointer to a bitvector that represents the LIPSIN identifier.
+	 */
+	Bitvector *calculateFID(string &source, string &destination);
+	/**@brief it calculates LIPSIN identifiers from a set of publishers to a set of subscribers using the shortest paths.
+	 *
+	 * A single BFS is run per publisher and reused for all subscribers.
+	 *
+	 * @param publishers a reference to a set of node labels, representing the source nodes.
+	 * @param subscribers a reference to a set of node labels, representing the destination nodes.
+	 * @param result a reference to a map where the method will put node labels representing source nodes mapped to LIPSIN identifiers. Note that some of these identifiers may be NULL.
+	 * @param path_vectors a reference to a map of information items and their corresponding delivery paths
+	 */
+	void calculateFID(set<string> &publishers, set<string> &subscribers, map<string, Bitvector *> &result, map<string, set<string> > &path_vectors);
+	/**@brief it calculates LIPSIN identifiers from a publisher to a set of subscribers using the shortest paths. This involves selecting the closest subscriber to establish a relation with.
+	 *
+	 * @param publisher a reference to a node label, representing the source node.
+	 * @param subscribers a reference to a set of node labels, representing the destination nodes.
+	 * @param result a reference to a map where the method will put node labels representing destination nodes mapped to LIPSIN identifiers.
+	 * @param paths a reference to a map of information items and their corresponding delivery paths.
+	 */
+	void UcalculateFID(string &publisher, set<string> &subscribers, map<string, Bitvector *> &result, map<string, string> &paths);
+	/**@brief it calculates the RVFID, TMFID and TM_to_nodeFID of every node.
+	 *
+	 * Three BFS trees are grown in total: one from the TM over the outgoing
+	 * edges and two towards the RV and TM over the incoming edges.
+	 */
+	void calculateRVTMFIDs();
+	/**@brief calculate the FID, the number of hops and the path vector between two nodes.
+	 *
+	 * @param source
+	 * @param destination
+	 * @param resultFID
+	 * @param numberOfHops
+	 * @param path a reference to the string of the result path vector
+	 */
+	void calculateFID(string &source, string &destination, Bitvector &resultFID, unsigned int &numberOfHops, string &path);
+	/**@brief it assigns a set of newly calculated LIDs.
+	 *
+	 * @param NoLIDs the number of new LIDs (i.e. size of the LIDs set)
+	 * @param NewLIDs the actual set of assigned LIDs
+	 * @return false if the LID space is exhausted
+	 */
+	bool assignLIDs(int NoLIDs, set<Bitvector *> &NewLIDs);
+	/**@brief it calculates a globally unique LID. uniqueness is ensured by checking against the TM state of all currently assigned LIDs
+	 *
+	 * @return the LID or NULL if the LID space is exhausted
+	 */
+	Bitvector * calculateLID();
+	/**@brief edge ids are persistent in the CSR graph, hence there are no TM states to be rebuilt after a graph update
+	 *
+	 */
+	void updateTMStates();
+	void calculateFID_weighted(string &source, string &destination, Bitvector &resultFID, unsigned int &numberOfHops, string &path, const igraph_vector_t *weights);
+	void calculateFID_weighted(set<string> &publishers, set<string> &subscribers, map<string, Bitvector *> &result, map<string, set<string> > &path_vectors, const igraph_vector_t *weights);
+	/** @brief update the graph object when a notification about a link-status change arrives (i.e. disable or re-enable edges)
+	 *
+	 * @param source source of the edge (notification publisher)
+	 * @param destination the node on the other side of the link
+	 * @param bidirectional the type of update, uni- or bi-directional
+	 * @param remove the type of operation (i.e. Link addition or removal)
+	 */
+	bool updateGraph(const string &source, const string &destination, bool bidirectional, bool remove, Moly &moly);
+	/**@brief Update the links status whenever a LSM update arrives
+	 *
+	 * @param lid The link identifier
+	 * @param status The latest known link status
+	 */
+	virtual void updateLinkState(const string &lid, const QoSList &status);
+	/**@brief the number of vertices in the CSR graph
+	 */
+	int vertexCount();
+	/**@brief the number of edges (up or down) in the CSR graph
+	 */
+	int edgeCount();
+protected:
+	/**
+	 * @brief Create a new "line" into the QoSLinkWeightMap...
+	 *
+	 * Each "line"/entry represents the network plane for a specific queueing priority
+	 */
+	virtual void createNewQoSLinkPrioMap(const uint8_t & prio);
+	/**@brief resolve a node label to its integer handle
+	 *
+	 * @return the handle or -1 if the node label is unknown
+	 */
+	int handle(const string &nodeID);
+	/**@brief find the CSR slot of the edge from -> to, regardless of its state
+	 *
+	 * @return the slot or -1 if there is no such edge
+	 */
+	int findSlot(int from, int to);
+	/**@brief start a new traversal by invalidating all scratch entries
+	 */
+	void newEpoch();
+	/**@brief breadth first search over the edges that are up
+	 *
+	 * @param source the root of the search tree
+	 * @param destination stop as soon as this node is reached, -1 to build the full tree
+	 * @param reverse follow the incoming instead of the outgoing edges
+	 * @return true if destination has been reached (or destination is -1)
+	 */
+	bool bfs(int source, int destination, bool reverse);
+	/**@brief Dijkstra over the edges that are up, weighted by the edge id indexed weight vector
+	 *
+	 * @return true if destination has been reached
+	 */
+	bool dijkstra(int source, int destination, const igraph_vector_t *weights);
+	/**@brief whether node has been reached in the current traversal
+	 */
+	bool reached(int node);
+	/**@brief OR the LIDs of the tree path that ends (or starts, if reverse) at node into fid
+	 *
+	 * @param parent the slot through which every node has been reached
+	 */
+	void orPathLIDs(int node, bool reverse, const int *parent, uint32_t *fid);
+	/**@brief write the node labels of the tree path that ends at node into path
+	 *
+	 * @param parent the slot through which every node has been reached
+	 */
+	void pathString(int node, const int *parent, string &path);
+	/**@brief OR the inline LID/iLID words into a bitvector of FID_LEN * 8 bits
+	 */
+	void orWords(Bitvector &fid, const uint32_t *words);
+	/**@brief parse a LID string (as stored in the graphML file) into inline words
+	 */
+	static void parseLID(const string &lid, uint32_t *words);
+	/**@brief the index of the first '1' in a LID string, used as link identifier towards MOLY
+	 */
+	static uint16_t lidPosition(const string &lid);
+	/**@brief CSR row offsets, the outgoing edges of node n are the slots [out_offset[n], out_offset[n + 1])
+	 */
+	vector<int> out_offset;
+	/**@brief the source node of every slot
+	 */
+	vector<int> slot_source;
+	/**@brief the target node of every slot
+	 */
+	vector<int> slot_target;
+	/**@brief the (persistent) edge id of every slot, used to index QoS weight vectors
+	 */
+	vector<int> slot_eid;
+	/**@brief whether the edge in a slot is up
+	 */
+	vector<bool> slot_up;
+	/**@brief the LIDs of every slot, CSR_LID_WORDS consecutive words per slot
+	 */
+	vector<uint32_t> slot_lid;
+	/**@brief the slot of every edge id
+	 */
+	vector<int> eid_slot;
+	/**@brief the link identifier reported to MOLY for every edge id
+	 */
+	vector<uint16_t> eid_lid_position;
+	/**@brief the link name of every edge id
+	 */
+	vector<string> eid_name;
+	/**@brief the QoS priority of every edge id as reported by LSM updates
+	 */
+	vector<uint8_t> eid_qos_prio;
+	/**@brief transposed CSR row offsets, the incoming edges of node n are in_slots[in_offset[n], in_offset[n + 1])
+	 */
+	vector<int> in_offset;
+	/**@brief the slots of the incoming edges, grouped by target node
+	 */
+	vector<int> in_slots;
+	/**@brief the node labels by handle
+	 */
+	vector<string> node_label;
+	/**@brief the node names by handle
+	 */
+	vector<string> node_name;
+	/**@brief the internal link identifiers by handle, CSR_LID_WORDS consecutive words per node
+	 */
+	vector<uint32_t> node_ilid;
+	/**@brief hashed index of node labels to handles
+	 */
+	unordered_map<string, int> node_handle;
+	/**@brief scratch: traversal epoch of every node, a node is reached iff its stamp equals epoch
+	 */
+	vector<unsigned int> scratch_stamp;
+	unsigned int epoch;
+	/**@brief scratch: the slot through which every node has been reached
+	 */
+	vector<int> scratch_parent;
+	/**@brief scratch: the hop count of every reached node
+	 */
+	vector<unsigned int> scratch_hops;
+	/**@brief scratch: the weighted distance of every reached node
+	 */
+	vector<double> scratch_distance;
+	/**@brief scratch: the BFS queue
+	 */
+	vector<int> scratch_queue;
+	/**@brief scratch: the Dijkstra heap of (distance, node) pairs
+	 */
+	vector<pair<double, int> > scratch_heap;
+	/**@brief scratch: per publisher hop counts in calculateFID(publishers, subscribers)
+	 */
+	vector<unsigned int> scratch_multi_hops;
+	/**@brief scratch: per publisher parent slots in calculateFID(publishers, subscribers)
+	 */
+	vector<int> scratch_multi_parent;
+	/**@brief scratch: inline FID words
+	 */
+	uint32_t scratch_fid[CSR_LID_WORDS];
+};
+
+#endif
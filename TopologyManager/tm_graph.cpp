@@ -22,7 +22,7 @@
 #include "tm_graph.hpp"
 
 
-TMgraph::TMgraph(){
+TMgraph::TMgraph() : lidAllocator(FID_LEN * 8) {
 	// Initialize all features to false (0)
 	memset(&extension,0,sizeof(extension));
 }
@@ -54,6 +54,39 @@ void TMgraph::setExten(int idx){
 std::map<ICNEdge, Bitvector *> & TMgraph::getFreedLIDs() {
 	return freedLIDs;
 }
+void TMgraph::reserveLID(const Bitvector &lid) {
+	LidAllocator::lid_bits bits;
+	for (int i = 0; i < lid.size(); i++) {
+		if (lid[i])
+			bits.push_back(i);
+	}
+	lidAllocator.reserve(bits);
+}
+bool TMgraph::allocateLIDs(int NoLIDs, set<Bitvector *> &NewLIDs) {
+	vector<LidAllocator::lid_bits> lids;
+	if (!lidAllocator.allocate(NoLIDs, lids)) {
+		cout << "TM: could not allocate " << NoLIDs << " unique LIDs" << endl;
+		return false;
+	}
+	for (size_t i = 0; i < lids.size(); i++) {
+		Bitvector * lid = new Bitvector(FID_LEN * 8);
+		for (size_t j = 0; j < lids[i].size(); j++)
+			(*lid)[lids[i][j]] = true;
+		NewLIDs.insert(lid);
+	}
+	return true;
+}
+Bitvector * TMgraph::allocateLID() {
+	LidAllocator::lid_bits bits = lidAllocator.allocate();
+	if (bits.empty()) {
+		cout << "TM: could not allocate a unique LID" << endl;
+		return NULL;
+	}
+	Bitvector * lid = new Bitvector(FID_LEN * 8);
+	for (size_t j = 0; j < bits.size(); j++)
+		(*lid)[bits[j]] = true;
+	return lid;
+}
 Bitvector * TMgraph::getTM_to_nodeFID(const string &nodeID){
 	return (*TM_to_nodeFID.find(nodeID)).second;
 }
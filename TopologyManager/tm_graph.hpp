@@ -35,6 +35,7 @@
 #include "tm_max_flow.hpp"
 
 #include <bitvector.hpp>
+#include <lid_allocator.hpp>
 #include "blackadder_enums.hpp"
 /*igraph_version.hpp should be remade using make clean && make igraph_version.hpp
  *if igraph major or minor version changes
@@ -153,9 +154,29 @@ public:
                              bool remove,
                              Moly &moly
                              ) = 0;
-    virtual void assignLIDs(int NoLIDs, set<Bitvector *> &NewLIDs) = 0;
-    
+    /**@brief assign NoLIDs new unique LIDs
+     *
+     * @return false if not all LIDs could be allocated, in which case NewLIDs is left untouched and the link(s) must be rejected
+     */
+    virtual bool assignLIDs(int NoLIDs, set<Bitvector *> &NewLIDs) = 0;
+    /**@brief calculate a new unique LID
+     *
+     * @return the LID or NULL if no free LID is left, in which case the link must be rejected
+     */
     virtual Bitvector* calculateLID() = 0;
+    /**@brief mark an existing LID or iLID of the topology as used, so that it is never assigned again
+     */
+    void reserveLID(const Bitvector &lid);
+    /**@brief allocate NoLIDs unique LIDs in one call, shared by the assignLIDs() implementations
+     *
+     * @return false if the LIDs could not be allocated
+     */
+    bool allocateLIDs(int NoLIDs, set<Bitvector *> &NewLIDs);
+    /**@brief allocate a single unique LID, shared by the calculateLID() implementations
+     *
+     * @return the new LID or NULL if the LID space is exhausted
+     */
+    Bitvector * allocateLID();
     
     virtual void updateTMStates() = 0;
 	
@@ -271,6 +292,10 @@ public:
      *
      */
     std::set<Bitvector *> LIDs;
+    /** @brief hashed index of all the LIDs and iLIDs in use, from which new LIDs are allocated
+     *
+     */
+    LidAllocator lidAllocator;
     /** @breif an index that maps NodeID to the RVFID towards the node
      *
      */
@@ -104,6 +104,7 @@ int TMIgraph::readTopology(const char *file_name) {
 		std::string iLID = std::string(igraph_cattribute_VAS(&graph, "iLID", i));
 		reverse_node_index.insert(pair<std::string, int>(nID, i));
 		ilid = new Bitvector(iLID);
+		reserveLID(*ilid);
 		nodeID_iLID.insert(pair<std::string, Bitvector *>(nID, ilid));
 		vertex_iLID.insert(pair<int, Bitvector *>(i, ilid));
 		RVFID.insert(pair<std::string, Bitvector *>(nID, NULL));
@@ -115,6 +116,7 @@ int TMIgraph::readTopology(const char *file_name) {
 		std::string LID = std::string(igraph_cattribute_EAS(&graph, "LID", i));
 		reverse_edge_index.insert(pair<std::string, int>(LID, i));
 		lid = new Bitvector(LID);
+		reserveLID(*lid);
 		//LIDs.insert(lid);
 		edge_LID.insert(pair<int, Bitvector *>(i, lid));
 		igraph_integer_t head;
@@ -146,6 +148,7 @@ int TMIgraph::readTopology(const char *file_name) {
 		<< lid->to_string() << endl;
 	}
         outfile.close();
+	publishQoSTopology();
 	return ret;
 }
 int TMIgraph::reportTopology(Moly &moly) {
@@ -295,14 +298,18 @@ void TMIgraph::updateLinkState(const string &lid, const QoSList &status){
 	for (; mit!=qlwm.end(); ++mit){
 		// Set the vector pointer
 		vec = &mit->second;
+		igraph_real_t weight;
 		if (mit->first < lp){
 			// For any priority lower than this edge's... avoid using this edge
-			igraph_vector_set(vec, eid, UCHAR_MAX);
+			weight = UCHAR_MAX;
 		}
 		else {
 			// For all the others keep the real weight
-			igraph_vector_set(vec, eid, (MAX_PRIO-lp));
+			weight = MAX_PRIO-lp;
 		}
+		igraph_vector_set(vec, eid, weight);
+		// The path tables only rebuild if this actually changed a weight
+		qosPaths.setWeight(mit->first, eid, weight);
 	}
 	
 }
@@ -341,8 +348,34 @@ void TMIgraph::createNewQoSLinkPrioMap(const uint8_t & map_prio){
 	
 	// Add plane to the map
 	qlwm[map_prio]=vec;
+	qosPaths.setWeights(map_prio, data, numedges);
 	
 }
+
+void TMIgraph::publishQoSTopology(){
+	int numedges=igraph_ecount(&graph);
+	vector<int> sources(numedges);
+	vector<int> targets(numedges);
+	for (int eid = 0; eid < numedges; eid++) {
+		igraph_integer_t from;
+		igraph_integer_t to;
+		igraph_edge(&graph, eid, &from, &to);
+		sources[eid] = from;
+		targets[eid] = to;
+	}
+	qosPaths.setTopology(igraph_vcount(&graph), sources, targets);
+}
+
+bool TMIgraph::getQoSPlane(const igraph_vector_t *weights, uint8_t &prio){
+	QoSLinkWeightMap::iterator it;
+	for (it = qlwm.begin(); it != qlwm.end(); ++it) {
+		if (&it->second == weights) {
+			prio = it->first;
+			return true;
+		}
+	}
+	return false;
+}
 /* Update the topology graph with add/remove edge - carefull, the function assumes persistent vertex Ids,
  * meaning vertices don't get deleted from the graph, different function will be required for considering add/remove vertices*/
 bool TMIgraph::updateGraph(const string &source, const string &destination, bool bidirectional, bool remove, Moly &moly){
@@ -537,22 +570,11 @@ bool TMIgraph::updateGraph(const string &source, const string &destination, bool
 	return ret;
 }
 
-void TMIgraph::assignLIDs(int NoLIDs, std::set<Bitvector *> &NewLIDs){
-	Bitvector * lid;
-	for (int i = 0 ; i < NoLIDs; i++) {
-		lid = calculateLID();
-		NewLIDs.insert(lid);
-	}
+bool TMIgraph::assignLIDs(int NoLIDs, std::set<Bitvector *> &NewLIDs){
+	return allocateLIDs(NoLIDs, NewLIDs);
 }
 Bitvector * TMIgraph::calculateLID() {
-	Bitvector * lid = new Bitvector(FID_LEN * 8);
-	int bit_position = 0;
-	do {
-		/*set a random bit position to 1*/
-		bit_position = rand() % (FID_LEN * 8);
-		(*lid)[bit_position] = true;
-	} while(LIDs.find(lid) != LIDs.end());
-	return lid;
+	return allocateLID();
 }
 void TMIgraph::updateTMStates(){
 	unsigned int no_edges = igraph_ecount(&graph);
@@ -565,6 +587,7 @@ void TMIgraph::updateTMStates(){
 		Bitvector* lid = new Bitvector(LID);
 		edge_LID.insert(pair<int, Bitvector *>(i, lid));
 	}
+	publishQoSTopology();
 }
 
 Bitvector *TMIgraph::calculateFID(string &source, string &destination) {
@@ -874,6 +897,28 @@ void TMIgraph::calculateFID_weighted(set<string> &publishers, set<string> &subsc
 	}
 }
 void TMIgraph::calculateFID_weighted(string &source, string &destination, Bitvector &resultFID, unsigned int &numberOfHops, string &path, const igraph_vector_t *weights) {
+	/*a lookup in the precomputed tables, unless they are being rebuilt*/
+	uint8_t prio;
+	vector<int> path_vertices;
+	vector<int> path_edges;
+	if (getQoSPlane(weights, prio) && qosPaths.lookup(prio, (*reverse_node_index.find(source)).second, (*reverse_node_index.find(destination)).second, path_vertices, path_edges)) {
+		for (size_t j = 0; j < path_vertices.size(); j++) {
+			path += igraph_cattribute_VAS(&graph, "NODEID", path_vertices[j]);
+			if (j < path_vertices.size()-1) {
+				path+="->";
+			}
+		}
+		for (size_t j = 0; j < path_edges.size(); j++) {
+			Bitvector *lid = (*edge_LID.find(path_edges[j])).second;
+			(resultFID) = (resultFID) | (*lid);
+		}
+		numberOfHops = path_edges.size();
+		if(numberOfHops == 0) numberOfHops=UINT_MAX;
+		if (source == destination) numberOfHops=1;
+		Bitvector *ilid = (*nodeID_iLID.find(destination)).second;
+		(resultFID) = (resultFID) | (*ilid);
+		return;
+	}
 	igraph_vs_t vs;
 	igraph_vector_ptr_t res;
 #if IGRAPH_V >= IGRAPH_V_0_6
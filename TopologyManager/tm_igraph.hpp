@@ -33,6 +33,7 @@
 
 
 #include "tm_graph.hpp"
+#include "tm_qos_paths.hpp"
 // igraph_version.hpp should be remade using make clean && make igraph_version.hpp
 // if igraph major or minor version changes
 #include "igraph_version.hpp"
@@ -106,10 +107,12 @@ public:
 	 *
 	 * @param NoLIDs the number of new LIDs (i.e. size of the LIDs set)
 	 * @param NewLIDs the actual set of assigned LIDs
+	 * @return false if the LID space is exhausted
 	 */
-	void assignLIDs(int NoLIDs, set<Bitvector *> &NewLIDs);
+	bool assignLIDs(int NoLIDs, set<Bitvector *> &NewLIDs);
 	/**@brief it calculates a globally unique LID. uniqueness is ensured by checking against the TM state of all currently assigned LIDs
 	 *
+	 * @return the LID or NULL if the LID space is exhausted
 	 */
 	Bitvector * calculateLID();
 	/**@brief it updates the TM maintained states of edge_LIDs and reverse_edge_lid after each graph update
@@ -153,6 +156,17 @@ protected:
 	 * Each "line"/entry represents the network plane for a specific queueing priority
 	 */
 	virtual void createNewQoSLinkPrioMap(const uint8_t & prio);
+	/**@brief mirror the endpoints of every edge into the QoS path tables, after the topology has been read or updated
+	 */
+	void publishQoSTopology();
+	/**@brief the priority plane of the QoSLinkWeightMap a weight vector belongs to
+	 *
+	 * @return false if weights is not one of the qlwm vectors
+	 */
+	bool getQoSPlane(const igraph_vector_t *weights, uint8_t &prio);
+	/**@brief precomputed weighted shortest paths of all the qlwm planes, rebuilt in the background on LSM updates
+	 */
+	QoSPathTables qosPaths;
 	
 	
 };
@@ -20,6 +20,9 @@
 #include "tm_max_flow.hpp" // XXX: Include this first
 #include <float.h>
 #include <boost/graph/copy.hpp>
+#include <boost/thread.hpp>
+#include <boost/bind/bind.hpp>
+#include <limits>
 using namespace boost;
 
 inline double Graph_mf::calcD() {
@@ -74,7 +77,7 @@ inline double Graph_mf::calcLambda(std::vector<mf_demand> &demands) {
   gamma= 1.0 - 1.0/lambda;
   return(lambda);
 }
-void Graph_mf:: sp_concurrent_flow(std::vector<mf_demand> &demands) {
+void Graph_mf::sp_prepare(std::vector<mf_demand> &demands) {
 
   std::vector<mf_demand>::iterator di;
   for(di=demands.begin(); di != demands.end(); di++) {
@@ -82,15 +85,10 @@ void Graph_mf:: sp_concurrent_flow(std::vector<mf_demand> &demands) {
     di->path_flow_map.erase(di->path_flow_map.begin(),di->path_flow_map.end());
   }
 
-  int num_dem = demands.size();
   gflow.clear();
   boost::copy_graph((NetGraph)*this,gflow);
   gdual.clear();
   boost::copy_graph((NetGraph)*this,gdual);
-  for(int i=0 ; i<num_dem; i++) {
-    demands[i].flow = 0;
-  }
-  int N = num_vertices(*this);
   number_flows = 0;
 
   graph_traits < NetGraph >::edge_iterator ei, eend;
@@ -105,6 +103,25 @@ void Graph_mf:: sp_concurrent_flow(std::vector<mf_demand> &demands) {
 	     vertex(t,gflow),gflow);
     put(edge_weight,gflow,e.first,0.0);
   }
+}
+
+void Graph_mf::sp_lambda() {
+  graph_traits < NetGraph >::edge_iterator ei, eend;
+  lambda = DBL_MAX;
+  gamma = 0;
+  for(tie(ei,eend) = edges(gflow); ei != eend; ei++) {
+    double w = get(edge_weight,gflow,*ei);
+    double c = get(edge_capacity,gflow,*ei);
+    lambda = c/w < lambda ? c/w : lambda;
+  }
+  gamma= 1.0 - 1.0/lambda;
+}
+
+void Graph_mf:: sp_concurrent_flow(std::vector<mf_demand> &demands) {
+
+  int num_dem = demands.size();
+  int N = num_vertices(*this);
+  sp_prepare(demands);
   // for each demand
   for(int i=0; i<num_dem;i++) {
     mf_demand demand = demands[i];
@@ -146,14 +163,101 @@ void Graph_mf:: sp_concurrent_flow(std::vector<mf_demand> &demands) {
   }
 
   // calculate lambda
-  lambda = DBL_MAX;
-  gamma = 0;
-  for(tie(ei,eend) = edges(gflow); ei != eend; ei++) {
-    double w = get(edge_weight,gflow,*ei);
-    double c = get(edge_capacity,gflow,*ei);
-    lambda = c/w < lambda ? c/w : lambda;
+  sp_lambda();
+}
+
+void Graph_mf::sp_paths_worker(const std::vector<mf_demand> &demands,
+			       const std::vector<Vertex> &sources,
+			       const std::vector<std::vector<int> > &by_source,
+			       std::vector<std::list<Vertex> > &paths,
+			       unsigned int first, unsigned int stride) {
+  int N = num_vertices(gdual);
+  std::vector<Vertex> penult(N);
+  std::vector<double> dist(N);
+
+  for(unsigned int k=first; k<sources.size(); k+=stride) {
+    Vertex source = sources[k];
+    // gdual is only read here and the colour map is private to the
+    // call, so the searches of different sources do not interfere
+    dijkstra_shortest_paths(gdual, source,
+			    predecessor_map(&penult[0]).distance_map(&dist[0]));
+    // one tree serves all the demands of this source
+    for(unsigned int j=0; j<by_source[k].size(); j++) {
+      int i = by_source[k][j];
+      Vertex f = demands[i].sink;
+      // unreachable sink, no path is recorded
+      if(dist[f] == (std::numeric_limits<double>::max)())
+	continue;
+      std::list<Vertex> &path = paths[i];
+      // same list as sp_concurrent_flow, including [s,s] for source == sink
+      path.push_front(f);
+      do {
+	f = penult[f];
+	path.push_front(f);
+      } while(f != source);
+    }
   }
-  gamma= 1.0 - 1.0/lambda;
+}
+
+void Graph_mf::sp_concurrent_flow_parallel(std::vector<mf_demand> &demands,
+					   unsigned int nthreads) {
+
+  int num_dem = demands.size();
+  sp_prepare(demands);
+
+  // group the demands by source, gdual has unit weights that do not
+  // change in this phase so all the trees are independent
+  std::map<Vertex,int> source_index;
+  std::vector<Vertex> sources;
+  std::vector<std::vector<int> > by_source;
+  for(int i=0; i<num_dem; i++) {
+    std::map<Vertex,int>::iterator si = source_index.find(demands[i].source);
+    if(si == source_index.end()) {
+      si = source_index.insert(std::make_pair(demands[i].source,
+					      (int)sources.size())).first;
+      sources.push_back(demands[i].source);
+      by_source.push_back(std::vector<int>());
+    }
+    by_source[si->second].push_back(i);
+  }
+
+  std::vector<std::list<Vertex> > paths(num_dem);
+  if(nthreads > sources.size())
+    nthreads = sources.size();
+  if(nthreads <= 1) {
+    sp_paths_worker(demands, sources, by_source, paths, 0, 1);
+  } else {
+    boost::thread_group workers;
+    for(unsigned int t=0; t<nthreads; t++) {
+      workers.create_thread(boost::bind(&Graph_mf::sp_paths_worker, this,
+					boost::cref(demands),
+					boost::cref(sources),
+					boost::cref(by_source),
+					boost::ref(paths), t, nthreads));
+    }
+    workers.join_all();
+  }
+
+  // add the flows in demand order, with the same accounting as
+  // sp_concurrent_flow (the edge into the sink is not loaded)
+  for(int i=0; i<num_dem; i++) {
+    std::list<Vertex> &path = paths[i];
+    if(path.empty())
+      continue;
+    std::list<Vertex>::const_iterator lt = path.begin();
+    std::list<Vertex>::const_iterator lh = path.begin();
+    lh++;
+    for(unsigned int n=1; n<path.size()-1; n++, lt++, lh++) {
+      std::pair<Edge, bool> ed = edge(*lt,*lh,gflow);
+      double w =get(edge_weight,gflow,ed.first);
+      put(edge_weight,gflow,ed.first,w+demands[i].demand);
+    }
+    demands[i].path_flow_map[path] = demands[i].demand;
+    demands[i].flow = demands[i].demand;
+  }
+
+  // calculate lambda
+  sp_lambda();
 }
 
 double Graph_mf::calcBeta(std::vector<mf_demand> &demands) {
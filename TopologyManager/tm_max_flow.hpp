@@ -74,6 +74,10 @@ public:
   void max_concurrent_flow(std::vector<mf_demand> &demands,
 		      double e=0.1);
   void sp_concurrent_flow(std::vector<mf_demand> &demands);
+  // same result as sp_concurrent_flow, the shortest path trees of the
+  // distinct demand sources are grown by up to nthreads worker threads
+  void sp_concurrent_flow_parallel(std::vector<mf_demand> &demands,
+				   unsigned int nthreads);
 
   void max_concurrent_flow_prescaled(std::vector<mf_demand> &demands,
 				     double e);
@@ -95,6 +99,13 @@ private:
   double calcBeta(std::vector<mf_demand> &demands);
   double calcLambda(std::vector<mf_demand> &demands);
   double assign_gflow(std::vector<mf_demand> &demands);
+  void sp_prepare(std::vector<mf_demand> &demands);
+  void sp_lambda();
+  void sp_paths_worker(const std::vector<mf_demand> &demands,
+		       const std::vector<vertex_descriptor> &sources,
+		       const std::vector<std::vector<int> > &by_source,
+		       std::vector<std::list<vertex_descriptor> > &paths,
+		       unsigned int first, unsigned int stride);
 };
 
 typedef boost::graph_traits < NetGraph >::edge_descriptor Edge;
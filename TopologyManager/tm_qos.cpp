@@ -12,7 +12,6 @@
 #include "tm_qos.hpp"
 
 IIMetaCache::IIMetaCache(){
-  last_non_lazy_update=time(NULL);
 }
 
 bool IIMetaCache::exists(const string & ii){
@@ -31,37 +30,12 @@ bool IIMetaCache::quering(const string & ii){
 }
   
 void IIMetaCache::cleanAllExpired(Blackadder *ba){
-  IIMetaDataMap::iterator it = ii_meta.begin();
   time_t now = time(NULL);
-  for (; it!=ii_meta.end();/* ++it*/){
-    
-    // Check creation time
-    if (it->second.created>0){
-      if (now-it->second.created > EXPIRATION_TIME){
-	cout<<" - Cleaned (outdated)"<<chararray_to_hex(it->first)<<endl;
-	ii_meta.erase(it++);
-      }
-      else {
-	++it;
-      }
-    }
-    
-    // Check quering ones
-    else if (it->second.querying){
-      if (now-it->second.querytime > QUERY_EXP_TIME){
-	cout<<" - Cleaned  (querying)"<<chararray_to_hex(it->first)<<endl;
-	
-	string item_id = it->first.substr(it->first.length() - PURSUIT_ID_LEN, PURSUIT_ID_LEN);
-	string item_pre = it->first.substr(0,it->first.length() - PURSUIT_ID_LEN);
-	ba->unsubscribe_info(item_id, item_pre, DOMAIN_LOCAL, NULL, 0);
-	ii_meta.erase(it++);
-      }else {
-	++it;
-      }
-    }else{
-      ++it;
-    }
-    
+  while (!expiry.empty() && expiry.top().first <= now){
+    // copy, checkClean may erase the entry of a stale heap item
+    string ii = expiry.top().second;
+    expiry.pop();
+    checkClean(ii, ba);
   } // End of IIs
 }
 
@@ -109,10 +83,8 @@ string IIMetaCache::getQoSID(const string & bin_item_identifier){
 QoSList * IIMetaCache::getIIMeta(const string & ii, Blackadder *ba) {
   
   cout<<" - getIIMeta for: "<<chararray_to_hex(ii)<<endl;
-  // Check the non-lazy
-  time_t now = time(NULL);
-  if (now - last_non_lazy_update > NON_LAZY_INT)
-    cleanAllExpired(ba);
+  // Clean whatever is due on the expiration heap
+  cleanAllExpired(ba);
   
   // First of all try to clean it ... if it is needed
   checkClean(ii,ba);
@@ -129,10 +101,8 @@ QoSList * IIMetaCache::getIIMeta(const string & ii, Blackadder *ba) {
 
 uint16_t IIMetaCache::getIIQoSPrio(const string & ii, Blackadder *ba){
   cout<<" - getIIQoSPrio for: "<<chararray_to_hex(ii)<<endl;
-  // Check the non-lazy
-  time_t now = time(NULL);
-  if (now - last_non_lazy_update > NON_LAZY_INT)
-    cleanAllExpired(ba);
+  // Clean whatever is due on the expiration heap
+  cleanAllExpired(ba);
   
   // First of all try to clean it ... if it is needed
   checkClean(ii,ba);
@@ -140,12 +110,11 @@ uint16_t IIMetaCache::getIIQoSPrio(const string & ii, Blackadder *ba){
   // Now try to find it
   IIMetaDataMap::iterator it = ii_meta.find(ii);
   
+  // II does not exist!
+  if (it==ii_meta.end()) return DEFAULT_QOS_PRIO;
   
   // II is queried now...
   if (it->second.querying) return DEFAULT_QOS_PRIO;
-  
-  // II does not exist!
-  if (it==ii_meta.end()) return DEFAULT_QOS_PRIO;
   // Not set
   QoSList::iterator qit = it->second.qos.find(QoS_PRIO);
   if (qit==it->second.qos.end()) return DEFAULT_QOS_PRIO;
@@ -179,6 +148,8 @@ bool IIMetaCache::sendQueryIfNeeded(const string & ii, Blackadder *ba){
   ba->subscribe_info(qos_id, qos_prefix, DOMAIN_LOCAL, NULL, 0);
   mc.querytime = time(NULL);
   ii_meta[ii] = mc;
+  // checkClean removes it once more than QUERY_EXP_TIME has passed
+  expiry.push(IIExpiry(mc.querytime + QUERY_EXP_TIME + 1, ii));
   
   return true;
 }
@@ -192,6 +163,7 @@ void IIMetaCache::update(const string & ii, QoSList meta, Blackadder * ba){
   ii_meta[ii].qos = meta;
   ii_meta[ii].querying = false;
   ii_meta[ii].created = time(NULL);
+  expiry.push(IIExpiry(ii_meta[ii].created + EXPIRATION_TIME + 1, ii));
   
   
   // Unsubscribe!
@@ -211,6 +183,92 @@ void IIMetaCache::addMetaItem(const string & ii){
   ii_meta[ii].qos[QoS_PRIO] = 99;
   ii_meta[ii].querying = false;
   ii_meta[ii].created = time(NULL);
+  expiry.push(IIExpiry(ii_meta[ii].created + EXPIRATION_TIME + 1, ii));
+}
+
+
+
+
+IIMetaResolver::IIMetaResolver(){
+  next_seq=0;
+  pthread_mutex_init(&mutex, NULL);
+  pthread_cond_init(&cond, NULL);
 }
 
+IIMetaResolver::~IIMetaResolver(){
+  pthread_cond_destroy(&cond);
+  pthread_mutex_destroy(&mutex);
+}
+
+uint64_t IIMetaResolver::nowMs(){
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void IIMetaResolver::park(const string & ii, const char *request, int request_len){
+  pthread_mutex_lock(&mutex);
+  uint64_t seq = next_seq++;
+  uint64_t deadline = nowMs() + QOS_PARK_TIME;
+  ParkedRequest &pr = parked[seq];
+  pr.ii = ii;
+  pr.request = string(request, request_len);
+  parked_by_ii[ii].insert(seq);
+  bool earliest = deadlines.empty() || deadline < deadlines.top().first;
+  deadlines.push(ParkedDeadline(deadline, seq));
+  cout<<" - park request for: "<<chararray_to_hex(ii)<<" ("<<parked.size()<<" parked)"<<endl;
+  // the timer thread may be sleeping on a later deadline
+  if (earliest) pthread_cond_signal(&cond);
+  pthread_mutex_unlock(&mutex);
+}
+
+void IIMetaResolver::resolve(const string & ii, vector<string> & requests){
+  pthread_mutex_lock(&mutex);
+  map<string, set<uint64_t> >::iterator bit = parked_by_ii.find(ii);
+  if (bit != parked_by_ii.end()){
+    // in arrival order, the heap entries become stale
+    for (set<uint64_t>::iterator sit = bit->second.begin(); sit != bit->second.end(); ++sit){
+      map<uint64_t, ParkedRequest>::iterator pit = parked.find(*sit);
+      requests.push_back(pit->second.request);
+      parked.erase(pit);
+    }
+    parked_by_ii.erase(bit);
+  }
+  pthread_mutex_unlock(&mutex);
+}
 
+void IIMetaResolver::waitExpired(vector<string> & requests){
+  pthread_mutex_lock(&mutex);
+  // drop the heap entries of requests that have been resolved
+  while (!deadlines.empty() && parked.find(deadlines.top().second) == parked.end())
+    deadlines.pop();
+  uint64_t wake = nowMs() + QOS_RESOLVER_POLL_TIME;
+  if (!deadlines.empty() && deadlines.top().first < wake)
+    wake = deadlines.top().first;
+  if (wake > nowMs()){
+    struct timespec deadline;
+    deadline.tv_sec = wake / 1000;
+    deadline.tv_nsec = (wake % 1000) * 1000000;
+    pthread_cond_timedwait(&cond, &mutex, &deadline);
+  }
+  uint64_t now = nowMs();
+  while (!deadlines.empty() && deadlines.top().first <= now){
+    map<uint64_t, ParkedRequest>::iterator pit = parked.find(deadlines.top().second);
+    deadlines.pop();
+    if (pit == parked.end()) continue;
+    cout<<" - parked request for: "<<chararray_to_hex(pit->second.ii)<<" timed out"<<endl;
+    requests.push_back(pit->second.request);
+    map<string, set<uint64_t> >::iterator bit = parked_by_ii.find(pit->second.ii);
+    bit->second.erase(pit->first);
+    if (bit->second.empty()) parked_by_ii.erase(bit);
+    parked.erase(pit);
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+size_t IIMetaResolver::depth(){
+  pthread_mutex_lock(&mutex);
+  size_t d = parked.size();
+  pthread_mutex_unlock(&mutex);
+  return d;
+}
@@ -16,8 +16,12 @@
 
 #include <qos_structs.hpp>
 #include <map>
+#include <set>
+#include <queue>
+#include <vector>
 #include <ctime>
 #include <string>
+#include <pthread.h>
 #include <openssl/sha.h>
 
 #include <blackadder.hpp>
@@ -31,8 +35,11 @@ using namespace std; // XXX
 /// QUERY expiration time for an entry (in seconds - default 1)
 #define QUERY_EXP_TIME 1
 
-/// NON-LAZY INTERVAL (seconds)
-#define NON_LAZY_INT 3600
+/// Maximum time a path request waits for the meta data of its II (in ms)
+#define QOS_PARK_TIME (QUERY_EXP_TIME * 1000)
+
+/// Longest time the timer thread sleeps before checking for shutdown (in ms)
+#define QOS_RESOLVER_POLL_TIME 1000
 
 /// Default QoS flow priority (BE)
 #define DEFAULT_QOS_PRIO 0
@@ -53,6 +60,10 @@ typedef struct __meta_data_cont {
 
 typedef map<string, MetaDataContent> IIMetaDataMap;
 
+/// (expiration time, II) - the top of the heap expires first
+typedef pair<time_t, string> IIExpiry;
+typedef priority_queue<IIExpiry, vector<IIExpiry>, greater<IIExpiry> > IIExpiryHeap;
+
 /**
  * Wrapper class to help on managing meta data cache and do
  * lazy clean up...
@@ -60,7 +71,8 @@ typedef map<string, MetaDataContent> IIMetaDataMap;
 class IIMetaCache {
 protected:
   IIMetaDataMap ii_meta;
-  time_t last_non_lazy_update;
+  /// expiration times of the entries, stale ones are skipped by checkClean
+  IIExpiryHeap expiry;
   
 public:
   IIMetaCache();
@@ -83,8 +95,8 @@ public:
   void checkClean(const string & ii, Blackadder *ba);
   
   /**
-   * Clean all expired II. To be called on non-lazy mode
-   * if ever implemented...
+   * Clean all expired II. Only the entries that are due on the
+   * expiration heap are visited, so this is called on every lookup.
    */
   void cleanAllExpired(Blackadder *ba);
   
@@ -132,3 +144,59 @@ public:
 };
 
 
+
+/// A path request waiting for the meta data of its II
+typedef struct __parked_request {
+  string ii;
+  string request;
+} ParkedRequest;
+
+/// (deadline in ms, sequence number) - the top of the heap expires first
+typedef pair<uint64_t, uint64_t> ParkedDeadline;
+typedef priority_queue<ParkedDeadline, vector<ParkedDeadline>, greater<ParkedDeadline> > ParkedDeadlineHeap;
+
+/**
+ * Asynchronous resolver for the meta data of IIs. Path requests for IIs
+ * whose meta data is being queried are parked here instead of being
+ * answered with the default priority. They are handed back either when
+ * the meta data arrives (resolve) or when their deadline passes
+ * (waitExpired, called by a timer thread).
+ */
+class IIMetaResolver {
+protected:
+  map<uint64_t, ParkedRequest> parked;
+  map<string, set<uint64_t> > parked_by_ii;
+  ParkedDeadlineHeap deadlines;
+  uint64_t next_seq;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  
+  static uint64_t nowMs();
+  
+public:
+  IIMetaResolver();
+  ~IIMetaResolver();
+  
+  /**
+   * Park a copy of a path request for II until its meta data arrives
+   * or QOS_PARK_TIME passes.
+   */
+  void park(const string & ii, const char *request, int request_len);
+  
+  /**
+   * Take all the requests parked for II (its meta data arrived)
+   */
+  void resolve(const string & ii, vector<string> & requests);
+  
+  /**
+   * Block until at least one parked request is past its deadline and
+   * take all of those. Returns (possibly with nothing) after at most
+   * QOS_RESOLVER_POLL_TIME so that the caller can check for shutdown.
+   */
+  void waitExpired(vector<string> & requests);
+  
+  /**
+   * Number of parked requests
+   */
+  size_t depth();
+};
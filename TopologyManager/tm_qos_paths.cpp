@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2015-2018  Mays AL-Naday
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+#include "tm_qos_paths.hpp"
+#include <time.h>
+#include <queue>
+#include <limits>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+
+QoSPathTables::QoSPathTables() {
+	nodes = 0;
+	version = 0;
+	rebuild_count = 0;
+	dirty = false;
+	first_change = 0;
+	last_change = 0;
+	running = true;
+	started = false;
+	pthread_mutex_init(&mutex, NULL);
+	pthread_cond_init(&cond, NULL);
+}
+
+QoSPathTables::~QoSPathTables() {
+	pthread_mutex_lock(&mutex);
+	running = false;
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&mutex);
+	if (started)
+		pthread_join(thread, NULL);
+	pthread_cond_destroy(&cond);
+	pthread_mutex_destroy(&mutex);
+}
+
+uint64_t QoSPathTables::nowMs() {
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void QoSPathTables::setTopology(int no_nodes, const vector<int> &sources, const vector<int> &targets) {
+	pthread_mutex_lock(&mutex);
+	nodes = no_nodes;
+	edge_source = sources;
+	edge_target = targets;
+	changed();
+	pthread_mutex_unlock(&mutex);
+}
+
+void QoSPathTables::setWeights(uint8_t prio, const double *plane, int size) {
+	pthread_mutex_lock(&mutex);
+	weights[prio].assign(plane, plane + size);
+	changed();
+	pthread_mutex_unlock(&mutex);
+}
+
+void QoSPathTables::setWeight(uint8_t prio, int eid, double weight) {
+	pthread_mutex_lock(&mutex);
+	map<uint8_t, vector<double> >::iterator it = weights.find(prio);
+	/*periodic LSM updates mostly repeat the known state, which must not trigger a rebuild*/
+	if (it != weights.end() && eid >= 0 && eid < (int)it->second.size() && it->second[eid] != weight) {
+		it->second[eid] = weight;
+		changed();
+	}
+	pthread_mutex_unlock(&mutex);
+}
+
+void QoSPathTables::changed() {
+	uint64_t now = nowMs();
+	version++;
+	last_change = now;
+	if (!dirty) {
+		dirty = true;
+		first_change = now;
+	}
+	/*no thread for a TM that never receives LSM updates*/
+	if (!started && !weights.empty()) {
+		started = (pthread_create(&thread, NULL, rebuildLoop, this) == 0);
+	}
+	pthread_cond_signal(&cond);
+}
+
+bool QoSPathTables::lookup(uint8_t prio, int from, int to, vector<int> &vertices, vector<int> &edges) {
+	pthread_mutex_lock(&mutex);
+	boost::shared_ptr<const QoSPathSnapshot> snapshot = tables;
+	bool current = snapshot && (snapshot->version == version);
+	pthread_mutex_unlock(&mutex);
+	if (!current)
+		return false;
+	map<uint8_t, QoSPathPlane>::const_iterator plane_it = snapshot->planes.find(prio);
+	if (plane_it == snapshot->planes.end())
+		return false;
+	if (from < 0 || to < 0 || from >= snapshot->nodes || to >= snapshot->nodes)
+		return false;
+	const int *parent = &plane_it->second.parent_edge[(size_t)from * snapshot->nodes];
+	vertices.clear();
+	edges.clear();
+	if (to != from && parent[to] < 0)
+		return true;
+	for (int v = to; v != from; v = snapshot->edge_source[parent[v]]) {
+		vertices.push_back(v);
+		edges.push_back(parent[v]);
+	}
+	vertices.push_back(from);
+	reverse(vertices.begin(), vertices.end());
+	reverse(edges.begin(), edges.end());
+	return true;
+}
+
+unsigned long QoSPathTables::rebuilds() {
+	pthread_mutex_lock(&mutex);
+	unsigned long r = rebuild_count;
+	pthread_mutex_unlock(&mutex);
+	return r;
+}
+
+void QoSPathTables::build(QoSPathSnapshot &snapshot, const map<uint8_t, vector<double> > &weights) {
+	int n = snapshot.nodes;
+	int m = snapshot.edge_source.size();
+	/*outgoing edges of every node, CSR style*/
+	vector<int> offset(n + 1, 0);
+	vector<int> out_edges(m);
+	for (int e = 0; e < m; e++)
+		offset[snapshot.edge_source[e] + 1]++;
+	for (int v = 0; v < n; v++)
+		offset[v + 1] += offset[v];
+	vector<int> slot(offset.begin(), offset.end() - 1);
+	for (int e = 0; e < m; e++)
+		out_edges[slot[snapshot.edge_source[e]]++] = e;
+	vector<double> dist(n);
+	typedef pair<double, int> QueueEntry;
+	for (map<uint8_t, vector<double> >::const_iterator it = weights.begin(); it != weights.end(); ++it) {
+		const vector<double> &w = it->second;
+		/*the plane has not been resized after a topology change, as igraph, refuse to use it*/
+		if ((int)w.size() != m)
+			continue;
+		QoSPathPlane &plane = snapshot.planes[it->first];
+		plane.parent_edge.assign((size_t)n * n, -1);
+		for (int s = 0; s < n; s++) {
+			int *parent = &plane.parent_edge[(size_t)s * n];
+			fill(dist.begin(), dist.end(), numeric_limits<double>::infinity());
+			priority_queue<QueueEntry, vector<QueueEntry>, greater<QueueEntry> > queue;
+			dist[s] = 0;
+			queue.push(QueueEntry(0, s));
+			while (!queue.empty()) {
+				QueueEntry top = queue.top();
+				queue.pop();
+				int u = top.second;
+				if (top.first > dist[u])
+					continue;
+				for (int i = offset[u]; i < offset[u + 1]; i++) {
+					int e = out_edges[i];
+					int v = snapshot.edge_target[e];
+					double d = dist[u] + w[e];
+					if (d < dist[v]) {
+						dist[v] = d;
+						parent[v] = e;
+						queue.push(QueueEntry(d, v));
+					}
+				}
+			}
+		}
+	}
+}
+
+void *QoSPathTables::rebuildLoop(void *arg) {
+	QoSPathTables *tables = (QoSPathTables *) arg;
+	pthread_mutex_lock(&tables->mutex);
+	while (tables->running) {
+		if (!tables->dirty) {
+			pthread_cond_wait(&tables->cond, &tables->mutex);
+			continue;
+		}
+		/*hysteresis: wait for the changes to calm down, but not forever*/
+		uint64_t due = min(tables->last_change + QOS_TABLE_HOLD_DOWN, tables->first_change + QOS_TABLE_MAX_DELAY);
+		if (nowMs() < due) {
+			struct timespec deadline;
+			deadline.tv_sec = due / 1000;
+			deadline.tv_nsec = (due % 1000) * 1000000;
+			pthread_cond_timedwait(&tables->cond, &tables->mutex, &deadline);
+			continue;
+		}
+		boost::shared_ptr<QoSPathSnapshot> snapshot(new QoSPathSnapshot());
+		snapshot->version = tables->version;
+		snapshot->nodes = tables->nodes;
+		snapshot->edge_source = tables->edge_source;
+		snapshot->edge_target = tables->edge_target;
+		map<uint8_t, vector<double> > weights = tables->weights;
+		tables->dirty = false;
+		pthread_mutex_unlock(&tables->mutex);
+		uint64_t start = nowMs();
+		build(*snapshot, weights);
+		pthread_mutex_lock(&tables->mutex);
+		tables->tables = snapshot;
+		tables->rebuild_count++;
+		cout << "TM: QoS path tables rebuilt: " << snapshot->planes.size() << " planes, " << snapshot->nodes << " nodes in " << nowMs() - start << "ms" << endl;
+	}
+	pthread_mutex_unlock(&tables->mutex);
+	return NULL;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2015-2018  Mays AL-Naday
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+#ifndef TM_QOS_PATHS_HPP
+#define TM_QOS_PATHS_HPP
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+#include <pthread.h>
+#include <boost/shared_ptr.hpp>
+
+using namespace std;
+
+/*quiet time after the last weight change before the tables are rebuilt (ms)*/
+#define QOS_TABLE_HOLD_DOWN 250
+/*longest a rebuild is postponed by a continuous stream of weight changes (ms)*/
+#define QOS_TABLE_MAX_DELAY 2000
+
+/**@brief (Topology Manager) the shortest path trees of all sources for one QoS priority plane.
+ *
+ * parent_edge[s * nodes + v] is the edge through which v is reached from s, -1 for s itself and for unreachable nodes.
+ */
+struct QoSPathPlane {
+	vector<int> parent_edge;
+};
+
+/**@brief (Topology Manager) an immutable set of per-priority path tables, built from the weights of one version.
+ */
+struct QoSPathSnapshot {
+	unsigned long version;
+	int nodes;
+	vector<int> edge_source;
+	vector<int> edge_target;
+	map<uint8_t, QoSPathPlane> planes;
+};
+
+/**@brief (Topology Manager) precomputed weighted shortest paths for every QoS priority plane of the QoSLinkWeightMap.
+ *
+ * The graph mirrors the topology and every weight change into this object, which keeps its own copy of them.
+ * Changes only mark the tables as stale; a background thread rebuilds all planes (one Dijkstra per source)
+ * once the changes have stopped for QOS_TABLE_HOLD_DOWN ms, but no later than QOS_TABLE_MAX_DELAY ms after the first of them.
+ * A burst of LSM updates therefore costs a single rebuild.
+ *
+ * The tables are built outside the lock and published by swapping a shared pointer, so lookups never wait for a rebuild.
+ * A lookup only succeeds if the published tables were built from the latest weights, so the caller falls back to
+ * an on-demand calculation while a rebuild is pending and never gets a stale path.
+ */
+class QoSPathTables {
+public:
+	QoSPathTables();
+	/**@brief stops the rebuild thread
+	 */
+	~QoSPathTables();
+	/**@brief replace the topology, i.e. the endpoints of every edge id. Invalidates the tables.
+	 */
+	void setTopology(int nodes, const vector<int> &edge_source, const vector<int> &edge_target);
+	/**@brief replace the edge id indexed weights of a priority plane. Invalidates the tables.
+	 */
+	void setWeights(uint8_t prio, const double *weights, int size);
+	/**@brief update the weight of a single edge on a priority plane. Invalidates the tables only if the weight changes.
+	 */
+	void setWeight(uint8_t prio, int eid, double weight);
+	/**@brief the shortest path from -> to on the plane of prio, as looked up in the tables.
+	 *
+	 * @param vertices the vertices of the path, starting with from; empty if to is unreachable
+	 * @param edges the edge ids of the path
+	 * @return false if there are no up to date tables for prio, the caller has to calculate the path itself
+	 */
+	bool lookup(uint8_t prio, int from, int to, vector<int> &vertices, vector<int> &edges);
+	/**@brief the number of rebuilds so far
+	 */
+	unsigned long rebuilds();
+protected:
+	/**@brief mark the tables as stale and wake up the rebuild thread, called with the mutex held
+	 */
+	void changed();
+	/**@brief one Dijkstra per source over the given inputs
+	 */
+	static void build(QoSPathSnapshot &snapshot, const map<uint8_t, vector<double> > &weights);
+	static void *rebuildLoop(void *arg);
+	static uint64_t nowMs();
+	/*the inputs of the next rebuild*/
+	int nodes;
+	vector<int> edge_source;
+	vector<int> edge_target;
+	map<uint8_t, vector<double> > weights;
+	/*incremented on every effective change of the inputs*/
+	unsigned long version;
+	unsigned long rebuild_count;
+	/*there are changes that have not been picked up by a rebuild yet*/
+	bool dirty;
+	uint64_t first_change;
+	uint64_t last_change;
+	/*the published tables*/
+	boost::shared_ptr<const QoSPathSnapshot> tables;
+	bool running;
+	bool started;
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+};
+
+#endif
@@ -1166,6 +1166,31 @@ void MySqlConnector::_send(IcnId &icnId, uint8_t *data, uint32_t dataLength)
 				insertOss
 					<< (int)ATTRIBUTE_MOOSE_BUFFER_SIZE_MESSAGE_STACK << ", ";
 				break;
+			case BUFFER_TM_QOS_PARKED_REQUESTS:
+				insertOss
+				<< (int)ATTRIBUTE_TM_BUFFER_SIZE_QOS_PARKED_REQUESTS
+				<< ", ";
+				break;
+			case BUFFER_NAP_TCP_CLIENT_POOL_HIT_RATE:
+				insertOss
+				<< (int)ATTRIBUTE_NAP_TCP_CLIENT_POOL_HIT_RATE
+				<< ", ";
+				break;
+			case BUFFER_NAP_HTTP_CACHE_HIT_RATE:
+				insertOss
+				<< (int)ATTRIBUTE_NAP_HTTP_CACHE_HIT_RATE
+				<< ", ";
+				break;
+			case BUFFER_NAP_ICN_EVENT_QUEUES:
+				insertOss
+				<< (int)ATTRIBUTE_NAP_BUFFER_SIZE_ICN_EVENT_QUEUES
+				<< ", ";
+				break;
+			case BUFFER_NAP_IP_HANDLER_BYTES:
+				insertOss
+				<< (int)ATTRIBUTE_NAP_BUFFER_SIZE_IP_HANDLER_BYTES
+				<< ", ";
+				break;
 			default:
 				insertOss << (int)ATTRIBUTE_UNKNOWN << ", ";
 			}
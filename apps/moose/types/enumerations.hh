@@ -164,7 +164,12 @@ enum attribute_t
 	ATTRIBUTE_NAP_BUFFER_SIZE_HTTP_HANDLER_RESPONSES,/*!< 130 */
 	ATTRIBUTE_NAP_BUFFER_SIZE_LTP,
 	ATTRIBUTE_MOOSE_BUFFER_SIZE_MESSAGE_STACK,
-	ATTRIBUTE_NAP_FILE_DESCRIPTOR_TCP
+	ATTRIBUTE_NAP_FILE_DESCRIPTOR_TCP,
+	ATTRIBUTE_TM_BUFFER_SIZE_QOS_PARKED_REQUESTS,
+	ATTRIBUTE_NAP_TCP_CLIENT_POOL_HIT_RATE,
+	ATTRIBUTE_NAP_HTTP_CACHE_HIT_RATE,
+	ATTRIBUTE_NAP_BUFFER_SIZE_ICN_EVENT_QUEUES,
+	ATTRIBUTE_NAP_BUFFER_SIZE_IP_HANDLER_BYTES
 };
 
 enum element_type_t
@@ -22,12 +22,9 @@
 #ifndef NAP_API_NAPSA_HH_
 #define NAP_API_NAPSA_HH_
 
-#include <errno.h>
-#include <linux/netlink.h>
 #include <log4cxx/logger.h>
-#include <string.h>
-#include <sys/socket.h>
 
+#include <api/napsatypedef.hh>
 #include <types/enumerations.hh>
 #include <types/ipaddress.hh>
 #include <namespaces/namespaces.hh>
@@ -70,7 +67,17 @@ public:
 private:
 	Namespaces &_namespaces;/*!< Reference to namespaces */
 	Statistics &_statistics;/*!< Reference to statistics class */
-	int _listeningSocket; /*!< The NAP listening socket for SA messages */
+	/*!
+	 * \brief Hand a batch of commands over to the HTTP namespace
+	 *
+	 * A command which repeats the preceding one for the same hashed FQDN,
+	 * IP address and port within the batch is skipped.
+	 *
+	 * \param commands The received commands
+	 * \param numberOfCommands The number of commands in the batch
+	 */
+	void _handleCommands(nap_sa_command_t *commands,
+			uint16_t numberOfCommands);
 };
 
 } /* namespace napsa */
@@ -0,0 +1,152 @@
+/*
+ * napsasocket.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "napsasocket.hh"
+
+using namespace api::napsa;
+
+LoggerPtr NapSaSocket::logger(Logger::getLogger("api.napsa"));
+
+NapSaSocket::NapSaSocket(uint32_t pid)
+	: _bound(false)
+{
+	struct sockaddr_nl sourceAddress;
+	_socket = socket(AF_NETLINK, SOCK_RAW, NETLINK_GENERIC);
+
+	if (_socket == -1)
+	{
+		LOG4CXX_FATAL(logger, "NAP-SA listening socket could not be created");
+		return;
+	}
+
+	LOG4CXX_DEBUG(logger, "NAP-SA listening socket created");
+	memset(&sourceAddress, 0, sizeof(sourceAddress));
+	sourceAddress.nl_family = AF_NETLINK;
+	sourceAddress.nl_pid = pid;
+	sourceAddress.nl_pad = 0;
+	sourceAddress.nl_groups = 0; // unicast
+
+	if (bind(_socket, (struct sockaddr*) &sourceAddress,
+			sizeof(sourceAddress)) == -1)
+	{
+		LOG4CXX_FATAL(logger, "NAP-SA listener could not be bound to PID "
+				<< pid << ": " << strerror(errno));
+		return;
+	}
+
+	LOG4CXX_INFO(logger, "NAP-SA listener socket was bound to socket with PID "
+			<< pid);
+	memset(_messages, 0, sizeof(_messages));
+
+	for (uint16_t i = 0; i < NAP_SA_BATCH_SIZE; i++)
+	{
+		_iovecs[i].iov_base = _arena[i];
+		_iovecs[i].iov_len = NAP_SA_MESSAGE_SIZE;
+		_messages[i].msg_hdr.msg_name = &_addresses[i];
+		_messages[i].msg_hdr.msg_iov = &_iovecs[i];
+		_messages[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	_bound = true;
+}
+
+NapSaSocket::~NapSaSocket()
+{
+	if (_socket != -1)
+	{
+		LOG4CXX_DEBUG(logger, "Closing NAP-SA listening socket");
+		close(_socket);
+	}
+}
+
+bool NapSaSocket::bound()
+{
+	return _bound;
+}
+
+uint16_t NapSaSocket::receive(nap_sa_command_t *commands)
+{
+	struct nlmsghdr *nlh;
+	uint8_t *data;
+	uint16_t numberOfCommands = 0;
+	int messages;
+
+	// the kernel overwrites the name length of every received message
+	for (uint16_t i = 0; i < NAP_SA_BATCH_SIZE; i++)
+	{
+		_messages[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_nl);
+	}
+
+	messages = recvmmsg(_socket, _messages, NAP_SA_BATCH_SIZE, MSG_WAITFORONE,
+			NULL);
+
+	if (messages == -1)
+	{
+		if (errno != EINTR)
+		{
+			LOG4CXX_ERROR(logger, "Messages from SA could not be read: "
+					<< strerror(errno));
+		}
+
+		return 0;
+	}
+
+	for (int i = 0; i < messages; i++)
+	{
+		nlh = (struct nlmsghdr *)_arena[i];
+
+		// [1] Hashed FQDN, [2] IP address, [3] port
+		if (_messages[i].msg_len < NLMSG_HDRLEN + sizeof(uint32_t)
+				+ sizeof(uint32_t) + sizeof(uint16_t))
+		{
+			LOG4CXX_ERROR(logger, "Message from SA of length "
+					<< _messages[i].msg_len << " is too short");
+			continue;
+		}
+
+		if (nlh->nlmsg_type != NAP_SA_ACTIVATE
+				&& nlh->nlmsg_type != NAP_SA_DEACTIVATE)
+		{
+			LOG4CXX_ERROR(logger, "Unknown primitive type received from "
+					"SA: " << nlh->nlmsg_type);
+			continue;
+		}
+
+		data = (uint8_t *)NLMSG_DATA(nlh);
+		commands[numberOfCommands].command =
+				(nap_sa_commands_t)nlh->nlmsg_type;
+		memcpy(&commands[numberOfCommands].hashedFqdn, data,
+				sizeof(uint32_t));
+		memcpy(&commands[numberOfCommands].ipAddress, data + sizeof(uint32_t),
+				sizeof(uint32_t));
+		memcpy(&commands[numberOfCommands].port, data + 2 * sizeof(uint32_t),
+				sizeof(uint16_t));
+		numberOfCommands++;
+	}
+
+	LOG4CXX_TRACE(logger, messages << " message(s) received from SA in one "
+			"batch");
+	return numberOfCommands;
+}
@@ -0,0 +1,99 @@
+/*
+ * napsasocket.hh
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAP_API_NAPSASOCKET_HH_
+#define NAP_API_NAPSASOCKET_HH_
+
+#include <linux/netlink.h>
+#include <log4cxx/logger.h>
+#include <stdint.h>
+#include <sys/socket.h>
+
+#include <api/napsatypedef.hh>
+
+#ifdef DMALLOC
+#include "dmalloc.h"
+#endif
+
+using namespace log4cxx;
+
+namespace api
+{
+
+namespace napsa
+{
+
+/*!
+ * \brief Netlink socket on which NAP-SA messages are received
+ *
+ * Messages are obtained in batches of up to NAP_SA_BATCH_SIZE with a single
+ * recvmmsg() call into an arena which is allocated and pointed to by the
+ * message headers once, when the socket is created. As the headers point into
+ * the object itself, it must not be copied.
+ */
+class NapSaSocket
+{
+	static LoggerPtr logger;
+public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * Creates the NETLINK_GENERIC socket and binds it.
+	 *
+	 * \param pid The netlink PID to bind to
+	 */
+	NapSaSocket(uint32_t pid);
+	/*!
+	 * \brief Destructor
+	 */
+	~NapSaSocket();
+	/*!
+	 * \brief Check whether the socket has been created and bound
+	 */
+	bool bound();
+	/*!
+	 * \brief Receive the next batch of messages
+	 *
+	 * Blocks until at least one message has been received and returns all
+	 * further messages which are already queued, up to NAP_SA_BATCH_SIZE.
+	 * Messages which are too short or of an unknown type are dropped.
+	 *
+	 * \param commands Array of NAP_SA_BATCH_SIZE commands which is filled
+	 * with the received ones in the order they were received
+	 *
+	 * \return The number of commands
+	 */
+	uint16_t receive(nap_sa_command_t *commands);
+private:
+	int _socket;/*!< The netlink socket */
+	bool _bound;/*!< Socket created and bound */
+	uint8_t _arena[NAP_SA_BATCH_SIZE][NAP_SA_MESSAGE_SIZE];/*!< Receive
+	buffers */
+	struct iovec _iovecs[NAP_SA_BATCH_SIZE];/*!< Point to the arena */
+	struct mmsghdr _messages[NAP_SA_BATCH_SIZE];/*!< Point to the iovecs */
+	struct sockaddr_nl _addresses[NAP_SA_BATCH_SIZE];/*!< Senders */
+};
+
+} /* namespace napsa */
+
+} /* namespace api */
+
+#endif /* NAP_API_NAPSASOCKET_HH_ */
@@ -0,0 +1,43 @@
+/*
+ * napsatypedef.hh
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAP_API_NAPSATYPEDEF_HH_
+#define NAP_API_NAPSATYPEDEF_HH_
+
+#include <stdint.h>
+
+#include <types/enumerations.hh>
+
+#define NAP_SA_BATCH_SIZE 64 // messages obtained with one recvmmsg()
+#define NAP_SA_MESSAGE_SIZE 64 // receive arena slot per message (octets)
+
+/*!
+ * \brief A surrogacy command received from the surrogate agent (SA)
+ */
+struct nap_sa_command_t
+{
+	nap_sa_commands_t command;/*!< Activate or deactivate */
+	uint32_t hashedFqdn;/*!< The FQDN the surrogate serves */
+	uint32_t ipAddress;/*!< The IP address of the surrogate */
+	uint16_t port;/*!< The port of the surrogate */
+};
+
+#endif /* NAP_API_NAPSATYPEDEF_HH_ */
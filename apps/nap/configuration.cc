@@ -30,21 +30,34 @@ Configuration::Configuration()
 {
 	_backlog = 128;
 	_bufferCleanerInterval = 10;// seconds
+	_captureBackend = CAPTURE_BACKEND_PCAP;
+	_captureThreads = 1;
 	_cNap = true;
 	_hostBasedNap = false;
+	_httpCacheObjectSize = 1024;// kB
+	_httpCacheSize = 32;// MB
 	_httpHandler = true;
 	_httpProxyPort = 3127; // port
+	_httpProxyPublishers = 32; // threads
+	_httpProxyWorkers = 16; // threads
 	_icnGatewayHttp = false;
 	_icnGatewayIp = false;
+	_icnWorkers = 1; // threads
 	_igmp_genQueryTimer = 0;
 	_igmpHandler = false;
 	_igmp_redundantIGMP = 0;
 	_igmp_genLeaveTimer = 0;
 	_igmp_dropAfterQueriesNum = 0;
 	_igmp_message_processing_lag = 0;
+	_igmp_warmGroups = 0; // disabled
+	_igmp_warmGroupsPolicy = IGMP_WARM_GROUPS_RECENT;
+	_ipBufferCidLimit = 65535;// bytes
+	_ipBufferDropPolicy = IP_BUFFER_DROP_OLDEST;
+	_ipBufferLimit = 16777216;// bytes
 	_ltpInitialCredit = 10; // segments, not bytes
 	_ltpRttListSize = 10; // Default
 	_ltpRttMultiplier = 2;
+	_ltpVersion = LTP_VERSION;
 	_localSurrogacy = false;
 	_localSurrogateMethod = LOCAL_SURROGACY_METHOD_UNDEFINED;
 	_localSurrogatePort = 80; // default HTTP server port
@@ -54,6 +67,8 @@ Configuration::Configuration()
 	_socketType = RAWIP;
 	_surrogacy = false;
 	_tcDropRate = -1; // packets
+	_tcpClientPoolIdleTimeout = 30; // seconds
+	_tcpClientPoolSize = 8;
 	_tcpClientSocketBufferSize = 4096;
 	_tcpInterceptionPort = 80;
 	_tcpServerSocketBufferSize = 4096;
@@ -107,6 +122,16 @@ uint32_t Configuration::bufferCleanerInterval()
 	return _bufferCleanerInterval;
 }
 
+capture_backend_t Configuration::captureBackend()
+{
+	return _captureBackend;
+}
+
+uint16_t Configuration::captureThreads()
+{
+	return _captureThreads;
+}
+
 bool Configuration::cNap()
 {
 	return _cNap;
@@ -150,6 +175,11 @@ uint32_t Configuration::icnHeaderLength()
 	return 20;//FIXME obtain the exact number (through MAPI maybe?)
 }
 
+uint16_t Configuration::icnWorkers()
+{
+	return _icnWorkers;
+}
+
 bool Configuration::igmpHandler()
 {
 	return _igmpHandler;
@@ -210,6 +240,16 @@ uint32_t Configuration::igmp_message_processing_lag()
 	return _igmp_message_processing_lag;
 }
 
+uint16_t Configuration::igmp_warmGroups()
+{
+	return _igmp_warmGroups;
+}
+
+igmp_warm_groups_policy_t Configuration::igmp_warmGroupsPolicy()
+{
+	return _igmp_warmGroupsPolicy;
+}
+
 IpAddress Configuration::endpointIpAddress()
 {
 	return _endpointIpAddress;
@@ -254,11 +294,46 @@ IpAddress Configuration::ipAddress()
 	return _ipAddress;
 }
 
+uint32_t Configuration::ipBufferCidLimit()
+{
+	return _ipBufferCidLimit;
+}
+
+ip_buffer_drop_policy_t Configuration::ipBufferDropPolicy()
+{
+	return _ipBufferDropPolicy;
+}
+
+uint32_t Configuration::ipBufferLimit()
+{
+	return _ipBufferLimit;
+}
+
+uint32_t Configuration::httpCacheObjectSize()
+{
+	return _httpCacheObjectSize * 1024;
+}
+
+uint32_t Configuration::httpCacheSize()
+{
+	return _httpCacheSize * 1024 * 1024;
+}
+
 uint16_t Configuration::httpProxyPort()
 {
 	return _httpProxyPort;
 }
 
+uint16_t Configuration::httpProxyPublishers()
+{
+	return _httpProxyPublishers;
+}
+
+uint16_t Configuration::httpProxyWorkers()
+{
+	return _httpProxyWorkers;
+}
+
 uint32_t Configuration::ltpInitialCredit()
 {
 	return _ltpInitialCredit;
@@ -355,6 +430,7 @@ bool Configuration::parse(string file)
 		string ip, mask;
 		string socketType;
 		string localSurrogateMethod;
+		string captureBackend;
 		const Setting &napConfig = root["napConfig"];
 
 		// Interface
@@ -504,6 +580,70 @@ bool Configuration::parse(string file)
 					<< _httpProxyPort);
 		}
 
+		// HTTP proxy worker threads
+		if (_httpHandler && napConfig.lookupValue("httpProxyWorkers",
+				_httpProxyWorkers))
+		{
+			if (_httpProxyWorkers < 1 || _httpProxyWorkers > 1024)
+			{
+				LOG4CXX_WARN(logger, "'httpProxyWorkers' must be between 1 and "
+						"1024. Using 16 worker threads");
+				_httpProxyWorkers = 16;
+			}
+			else
+			{
+				LOG4CXX_DEBUG(logger, "HTTP proxy sockets served by "
+						<< _httpProxyWorkers << " worker threads");
+			}
+		}
+
+		// HTTP proxy publisher threads
+		if (_httpHandler && napConfig.lookupValue("httpProxyPublishers",
+				_httpProxyPublishers))
+		{
+			if (_httpProxyPublishers < 1 || _httpProxyPublishers > 1024)
+			{
+				LOG4CXX_WARN(logger, "'httpProxyPublishers' must be between 1 "
+						"and 1024. Using 32 publisher threads");
+				_httpProxyPublishers = 32;
+			}
+			else
+			{
+				LOG4CXX_DEBUG(logger, "HTTP responses published by "
+						<< _httpProxyPublishers << " threads");
+			}
+		}
+
+		// HTTP response cache in the cNAP
+		if (_httpHandler && napConfig.lookupValue("httpCacheSize",
+				_httpCacheSize))
+		{
+			if (_httpCacheSize > 4095)
+			{
+				LOG4CXX_WARN(logger, "'httpCacheSize' must not be larger than "
+						"4095MB. Using 4095MB");
+				_httpCacheSize = 4095;
+			}
+
+			LOG4CXX_DEBUG(logger, "HTTP response cache size set to "
+					<< _httpCacheSize << "MB");
+		}
+
+		if (_httpHandler && napConfig.lookupValue("httpCacheObjectSize",
+				_httpCacheObjectSize))
+		{
+			if (_httpCacheObjectSize < 1 ||
+					_httpCacheObjectSize > 64 * 1024)
+			{
+				LOG4CXX_WARN(logger, "'httpCacheObjectSize' must be between 1 "
+						"and 65536kB. Using default of 1024kB");
+				_httpCacheObjectSize = 1024;
+			}
+
+			LOG4CXX_DEBUG(logger, "HTTP responses up to "
+					<< _httpCacheObjectSize << "kB are cached");
+		}
+
 		if (_httpHandler && napConfig.lookupValue("tcpInterceptionPort",
 				_tcpInterceptionPort))
 		{
@@ -517,6 +657,36 @@ bool Configuration::parse(string file)
 					<< _tcpInterceptionPort << " used for HTTP proxy");
 		}
 
+		// Pool of TCP client connections towards servers
+		if (_httpHandler && napConfig.lookupValue("tcpClientPoolSize",
+				_tcpClientPoolSize))
+		{
+			if (_tcpClientPoolSize > 1024)
+			{
+				LOG4CXX_WARN(logger, "'tcpClientPoolSize' must not be larger "
+						"than 1024. Using 1024");
+				_tcpClientPoolSize = 1024;
+			}
+
+			LOG4CXX_DEBUG(logger, "Up to " << _tcpClientPoolSize << " idle "
+					"TCP client connections are kept per server");
+		}
+
+		if (_httpHandler && napConfig.lookupValue("tcpClientPoolIdleTimeout",
+				_tcpClientPoolIdleTimeout))
+		{
+			if (_tcpClientPoolIdleTimeout < 1 ||
+					_tcpClientPoolIdleTimeout > 3600)
+			{
+				LOG4CXX_WARN(logger, "'tcpClientPoolIdleTimeout' must be "
+						"between 1 and 3600. Using default of 30");
+				_tcpClientPoolIdleTimeout = 30;
+			}
+
+			LOG4CXX_DEBUG(logger, "Idle pooled TCP client connections are "
+					"closed after " << _tcpClientPoolIdleTimeout << "s");
+		}
+
 		// TCP socket buffer sizes
 		if (_httpHandler && napConfig.lookupValue("tcpClientSocketBufferSize",
 				_tcpClientSocketBufferSize))
@@ -617,6 +787,61 @@ bool Configuration::parse(string file)
 					"Using default value of " << _bufferCleanerInterval << "s");
 		}
 
+		// IP handler buffer
+		if (napConfig.lookupValue("ipBufferCidLimit", _ipBufferCidLimit))
+		{
+			if (_ipBufferCidLimit < 65535)
+			{
+				LOG4CXX_WARN(logger, "'ipBufferCidLimit' must hold the largest "
+						"IP packet. Using 65535 bytes");
+				_ipBufferCidLimit = 65535;
+			}
+			else
+			{
+				LOG4CXX_DEBUG(logger, "IP handler buffers up to "
+						<< _ipBufferCidLimit << " bytes per CID");
+			}
+		}
+
+		if (napConfig.lookupValue("ipBufferLimit", _ipBufferLimit))
+		{
+			if (_ipBufferLimit < _ipBufferCidLimit)
+			{
+				LOG4CXX_WARN(logger, "'ipBufferLimit' must not be smaller than "
+						"'ipBufferCidLimit'. Using " << _ipBufferCidLimit
+						<< " bytes");
+				_ipBufferLimit = _ipBufferCidLimit;
+			}
+			else
+			{
+				LOG4CXX_DEBUG(logger, "IP handler buffers up to "
+						<< _ipBufferLimit << " bytes over all CIDs");
+			}
+		}
+
+		string ipBufferDropPolicy;
+
+		if (napConfig.lookupValue("ipBufferDropPolicy", ipBufferDropPolicy))
+		{
+			if (ipBufferDropPolicy.compare("dropOldest") == 0)
+			{
+				_ipBufferDropPolicy = IP_BUFFER_DROP_OLDEST;
+				LOG4CXX_DEBUG(logger, "IP handler drops the oldest packets of "
+						"a full CID buffer");
+			}
+			else if (ipBufferDropPolicy.compare("tailDrop") == 0)
+			{
+				_ipBufferDropPolicy = IP_BUFFER_DROP_TAIL;
+				LOG4CXX_DEBUG(logger, "IP handler drops packets which do not "
+						"fit into a full CID buffer");
+			}
+			else
+			{
+				LOG4CXX_WARN(logger, "Unknown 'ipBufferDropPolicy' "
+						<< ipBufferDropPolicy << ". Using 'dropOldest'");
+			}
+		}
+
 		// LTP timeout multiplier
 		if (napConfig.lookupValue("ltpRttMultiplier", _ltpRttMultiplier))
 		{
@@ -624,6 +849,22 @@ bool Configuration::parse(string file)
 					" set to " << _ltpRttMultiplier);
 		}
 
+		// LTP protocol version
+		if (napConfig.lookupValue("ltpVersion", _ltpVersion))
+		{
+			if (_ltpVersion < 1 || _ltpVersion > LTP_VERSION)
+			{
+				LOG4CXX_WARN(logger, "'ltpVersion' must be between 1 and "
+						<< LTP_VERSION << ". Using " << LTP_VERSION);
+				_ltpVersion = LTP_VERSION;
+			}
+			else
+			{
+				LOG4CXX_DEBUG(logger, "Highest LTP version offered to peers "
+						"set to " << _ltpVersion);
+			}
+		}
+
 		// LTP RTT list size
 		if (napConfig.lookupValue("ltpRttListSize", _ltpRttListSize))
 		{
@@ -748,6 +989,64 @@ bool Configuration::parse(string file)
 			LOG4CXX_TRACE(logger, "Socket type is RAWIP");
 		}
 		
+		// Capture backend of the demux
+		if (napConfig.lookupValue("captureBackend", captureBackend))
+		{
+			if (captureBackend.compare("tpacketv3") == 0)
+			{
+				_captureBackend = CAPTURE_BACKEND_TPACKET_V3;
+				LOG4CXX_DEBUG(logger, "IP packets are captured through a "
+						"TPACKET_V3 ring");
+			}
+			else if (captureBackend.compare("pcap") == 0)
+			{
+				_captureBackend = CAPTURE_BACKEND_PCAP;
+				LOG4CXX_DEBUG(logger, "IP packets are captured with libpcap");
+			}
+			else
+			{
+				LOG4CXX_WARN(logger, "Unknown capture backend '"
+						<< captureBackend << "'. Using libpcap");
+			}
+		}
+
+		if (napConfig.lookupValue("icnWorkers", _icnWorkers))
+		{
+			if (_icnWorkers < 1 || _icnWorkers > 64)
+			{
+				LOG4CXX_WARN(logger, "'icnWorkers' must be between 1 and 64. "
+						"Using 1");
+				_icnWorkers = 1;
+			}
+			else
+			{
+				LOG4CXX_DEBUG(logger, "ICN events handled by " << _icnWorkers
+						<< " worker threads");
+			}
+		}
+
+		if (napConfig.lookupValue("captureThreads", _captureThreads))
+		{
+			if (_captureThreads < 1 || _captureThreads > 64)
+			{
+				LOG4CXX_WARN(logger, "'captureThreads' must be between 1 and "
+						"64. Using 1");
+				_captureThreads = 1;
+			}
+			else if (_captureThreads > 1
+					&& _captureBackend != CAPTURE_BACKEND_TPACKET_V3)
+			{
+				LOG4CXX_WARN(logger, "'captureThreads' requires the 'tpacketv3'"
+						" capture backend. Using 1");
+				_captureThreads = 1;
+			}
+			else
+			{
+				LOG4CXX_DEBUG(logger, "IP packets are captured by "
+						<< _captureThreads << " demux threads");
+			}
+		}
+
 		/**
 		 * IGMP handler params
 		 */ 
@@ -829,6 +1128,44 @@ bool Configuration::parse(string file)
 					<< _igmp_message_processing_lag);
 		}
 
+		if (napConfig.lookupValue("igmp_warmGroups", _igmp_warmGroups))
+		{
+			if (_igmp_warmGroups > 1024)
+			{
+				LOG4CXX_WARN(logger, "'igmp_warmGroups' must not be larger "
+						"than 1024. Pre-subscription disabled");
+				_igmp_warmGroups = 0;
+			}
+			else
+			{
+				LOG4CXX_DEBUG(logger, "IGMP handler keeps up to "
+						<< _igmp_warmGroups << " groups warm");
+			}
+		}
+
+		string warmGroupsPolicy;
+
+		if (napConfig.lookupValue("igmp_warmGroupsPolicy", warmGroupsPolicy))
+		{
+			if (warmGroupsPolicy.compare("popular") == 0)
+			{
+				_igmp_warmGroupsPolicy = IGMP_WARM_GROUPS_POPULAR;
+				LOG4CXX_DEBUG(logger, "IGMP handler keeps the most popular "
+						"groups warm");
+			}
+			else if (warmGroupsPolicy.compare("recent") == 0)
+			{
+				_igmp_warmGroupsPolicy = IGMP_WARM_GROUPS_RECENT;
+				LOG4CXX_DEBUG(logger, "IGMP handler keeps the most recently "
+						"left groups warm");
+			}
+			else
+			{
+				LOG4CXX_WARN(logger, "Unknown 'igmp_warmGroupsPolicy' "
+						<< warmGroupsPolicy << ". Using 'recent'");
+			}
+		}
+
 	}
 	catch(const SettingNotFoundException &nfex)
 	{
@@ -929,6 +1266,11 @@ uint16_t Configuration::ltpRttMultiplier()
 	return _ltpRttMultiplier;
 }
 
+uint32_t Configuration::ltpVersion()
+{
+	return _ltpVersion;
+}
+
 SocketType Configuration::socketType()
 {
 	return _socketType;
@@ -944,6 +1286,16 @@ int Configuration::tcDropRate()
 	return _tcDropRate;
 }
 
+uint16_t Configuration::tcpClientPoolIdleTimeout()
+{
+	return _tcpClientPoolIdleTimeout;
+}
+
+uint16_t Configuration::tcpClientPoolSize()
+{
+	return _tcpClientPoolSize;
+}
+
 uint16_t Configuration::tcpClientSocketBufferSize()
 {
 	return _tcpClientSocketBufferSize;
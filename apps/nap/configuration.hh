@@ -37,6 +37,7 @@
 #include <types/icnid.hh>
 #include <types/nodeid.hh>
 #include <types/routingprefix.hh>
+#include <types/typedef.hh>
 
 #ifdef DMALLOC
 #include "dmalloc.h"
@@ -82,6 +83,21 @@ namespace configuration {
 		 * \return The interval in seconds
 		 */
 		uint32_t bufferCleanerInterval();
+		/*!
+		 * \brief The backend the demux captures IP packets with
+		 *
+		 * \return The capture backend
+		 */
+		capture_backend_t captureBackend();
+		/*!
+		 * \brief The number of demux threads capturing IP packets
+		 *
+		 * Only the TPACKET_V3 backend supports more than one thread. Packets
+		 * are spread over the threads by the kernel using a flow hash.
+		 *
+		 * \return The number of demux threads
+		 */
+		uint16_t captureThreads();
 		/*!
 		 * \brief Obtain if this NAP runs as a client-side NAP
 		 *
@@ -110,6 +126,18 @@ namespace configuration {
 		 * endpoints serving them
 		 */
 		list<pair<IcnId, pair<IpAddress, uint16_t>>> fqdns();
+		/*!
+		 * \brief Obtain the largest HTTP response the cNAP caches
+		 *
+		 * \return The size in bytes
+		 */
+		uint32_t httpCacheObjectSize();
+		/*!
+		 * \brief Obtain the size of the cNAP's HTTP response cache
+		 *
+		 * \return The size in bytes. 0 if caching is disabled
+		 */
+		uint32_t httpCacheSize();
 		/*!
 		 * \brief Obtain if HTTP handler is supposed to be turned off
 		 *
@@ -123,6 +151,20 @@ namespace configuration {
 		 * incoming TCP sessions
 		 */
 		uint16_t httpProxyPort();
+		/*!
+		 * \brief The number of threads publishing the HTTP responses read by
+		 * the HTTP proxy
+		 *
+		 * \return The size of the reactor's publisher pool
+		 */
+		uint16_t httpProxyPublishers();
+		/*!
+		 * \brief The number of worker threads serving the sockets of the HTTP
+		 * proxy
+		 *
+		 * \return The size of the reactor's worker pool
+		 */
+		uint16_t httpProxyWorkers();
 		/*!
 		 * \brief Returns in this NAP has been configured for a host-based
 		 * environment
@@ -171,6 +213,12 @@ namespace configuration {
 		 * \return The ICN header length
 		 */
 		uint32_t icnHeaderLength();
+		/*!
+		 * \brief Obtain the number of threads handling ICN events
+		 *
+		 * \return The number of ICN worker threads
+		 */
+		uint16_t icnWorkers();
 		/*!
 		 * \brief TODO
 		 *
@@ -243,6 +291,20 @@ namespace configuration {
 		 * \return TODO
 		 */
 		uint32_t igmp_message_processing_lag();
+		/*!
+		 * \brief Number of groups a cNAP keeps receiving after their last IP
+		 * client has left, so that a later join is served without the
+		 * IGMP/ICN control round trip to the sNAP
+		 *
+		 * \return The number of warm groups. 0 disables pre-subscription
+		 */
+		uint16_t igmp_warmGroups();
+		/*!
+		 * \brief Which groups are kept warm
+		 *
+		 * \return The policy
+		 */
+		igmp_warm_groups_policy_t igmp_warmGroupsPolicy();
 		/*!
 		 * \param ipAddress The IP address in human readable format (dot
 		 * notation, e.g. 172.16.23.1)
@@ -255,6 +317,29 @@ namespace configuration {
 		 * \return The IP address of _device
 		 */
 		IpAddress ipAddress();
+		/*!
+		 * \brief Obtain the number of bytes the IP handler buffers per CID
+		 *
+		 * Packets are buffered until the START_PUBLISH notification for their
+		 * CID has been received.
+		 *
+		 * \return The limit in bytes
+		 */
+		uint32_t ipBufferCidLimit();
+		/*!
+		 * \brief Obtain which packet the IP handler drops when the buffer of a
+		 * CID is full
+		 *
+		 * \return The drop policy
+		 */
+		ip_buffer_drop_policy_t ipBufferDropPolicy();
+		/*!
+		 * \brief Obtain the number of bytes the IP handler buffers over all
+		 * CIDs
+		 *
+		 * \return The limit in bytes
+		 */
+		uint32_t ipBufferLimit();
 		/*!
 		 * \brief Initial LTP credit
 		 *
@@ -353,6 +438,12 @@ namespace configuration {
 		 * \return The multiplier
 		 */
 		uint16_t ltpRttMultiplier();
+		/*!
+		 * \brief Obtain the highest LTP version this NAP offers to its peers
+		 *
+		 * \return The LTP version (1 disables 32-bit sequences and SACKs)
+		 */
+		uint32_t ltpVersion();
 		/*!
 		 * \brief Retrieve the configured socekt type to communicate with IP
 		 * endpoints
@@ -370,6 +461,20 @@ namespace configuration {
 		 * \return The drop rate or -1
 		 */
 		int tcDropRate();
+		/*!
+		 * \brief Obtain the number of idle TCP client connections kept per
+		 * server
+		 *
+		 * \return The pool size. 0 if pooling is disabled
+		 */
+		uint16_t tcpClientPoolSize();
+		/*!
+		 * \brief Obtain the time after which idle pooled TCP client connections
+		 * are closed
+		 *
+		 * \return The idle timeout in seconds
+		 */
+		uint16_t tcpClientPoolIdleTimeout();
 		/*!
 		 * \brief Obtain the TCP client socket buffer size
 		 *
@@ -407,6 +512,8 @@ namespace configuration {
 		int _backlog;/*!< TCP backlog */
 		uint32_t _bufferCleanerInterval;/*!< The interval in seconds all buffer
 		cleaners wake up and clean the handler buffer from timed out packets*/
+		capture_backend_t _captureBackend;/*!< pcap or TPACKET_V3 */
+		uint32_t _captureThreads;/*!< Number of demux threads */
 		bool _cNap;/*!< If the configuration file has FQDNs or surrogacy
 		enabled, this boolean becomes false */
 		uint32_t _ltpInitialCredit;/*!< The initial credit each LTP session
@@ -415,15 +522,23 @@ namespace configuration {
 		acting in */
 		IpAddress _endpointIpAddress; /*!< If host-based deployment configured,
 		this variable holds the IP endpoint's IP address */
+		uint32_t _httpCacheObjectSize;/*!< Largest cached HTTP response [kB]
+		*/
+		uint32_t _httpCacheSize;/*!< Size of the HTTP response cache [MB] */
 		bool _httpHandler;/*!< Boolean to turn off HTTP handler */
 		uint32_t _httpProxyPort; /*!< The HTTP proxy port the NAP is listening
 		for new	incoming TCP connections. Default: 3127 */
+		uint32_t _httpProxyPublishers;/*!< Threads publishing HTTP responses
+		*/
+		uint32_t _httpProxyWorkers;/*!< Worker threads of the HTTP proxy
+		reactor */
 		bool _icnGatewayHttp; /*!< Is this NAP running as an ICN GW and has
 		Internet access. HTTP-over-ICN will have the wildcard */
 		bool _icnGatewayIp; /*!< Is this NAP running as an ICN GW and has
 		Internet access. IP-over-ICN will have the wildcard */
 		RoutingPrefix _icnGatewayRoutingPrefix;/*!< Routing prefix of the ICN GW
 		if set */
+		uint32_t _icnWorkers;/*!< Threads handling ICN events */
 		bool _igmpHandler;/*!< TODO */
 		string _igmp_genQueryIP;/*!< TODO */
 		string _igmp_groupLeaveIP;/*!< TODO */
@@ -436,7 +551,14 @@ namespace configuration {
 		string _igmp_ignoreMCastDataFrom;/*!< TODO */
 		string _igmp_napOperationMode;/*!< TODO */
 		unsigned int _igmp_message_processing_lag;/*!< TODO */
+		unsigned int _igmp_warmGroups;/*!< Groups kept warm at a cNAP */
+		igmp_warm_groups_policy_t _igmp_warmGroupsPolicy;/*!< Which groups
+		are kept warm */
 		IpAddress _ipAddress;/*!< The IP address of _device*/
+		uint32_t _ipBufferCidLimit;/*!< Bytes buffered per CID */
+		ip_buffer_drop_policy_t _ipBufferDropPolicy;/*!< Which packet is dropped
+		when the buffer of a CID is full */
+		uint32_t _ipBufferLimit;/*!< Bytes buffered over all CIDs */
 		bool _hostBasedNap; /*!< Is this NAP configured as in host-based
 		scenario */
 		list<pair<IcnId, pair<IpAddress, uint16_t>>> _fqdns; /*!< Holding all
@@ -448,6 +570,7 @@ namespace configuration {
 		values*/
 		uint32_t _ltpRttMultiplier;/*!< Multiplier for LTP timeout counter using
 		a multipler of the measured RTT */
+		uint32_t _ltpVersion;/*!< Highest LTP version offered to peers */
 		SocketType _socketType;/*!< The socket type to communicate with IP
 		endpoints when IP handler is used*/
 		bool _localSurrogacy; /*!< Supporting surrogates on localhost */
@@ -471,6 +594,10 @@ namespace configuration {
 		all	declared routing prefixes */
 		bool _surrogacy;/*!< Enable eNAP functionality (NAP-SA) */
 		int _tcDropRate;/*!< The traffic control drop rate */
+		uint32_t _tcpClientPoolIdleTimeout;/*!< Seconds after which idle
+		pooled TCP client connections are closed */
+		uint32_t _tcpClientPoolSize;/*!< Idle TCP client connections kept per
+		server */
 		uint32_t _tcpClientSocketBufferSize;/*!< Size of the socket buffer for
 		the TCP client towards servers (HTTP responses)*/
 		int _tcpInterceptionPort;/*!< TCP interception port for HTTP-over-
@@ -33,12 +33,14 @@ using namespace namespaces::mcast;
 LoggerPtr Demux::logger(Logger::getLogger("demux"));
 
 Demux::Demux(Namespaces &namespaces, Configuration &configuration,
-		Statistics &statistics, IpSocket &ipSocket, bool *run)
+		Statistics &statistics, IpSocket &ipSocket, bool *run,
+		uint16_t captureThread)
 	: _namespaces(namespaces),
 	  _configuration(configuration),
 	  _statistics(statistics),
 	  _ipSocket(ipSocket),
-	  _run(run)
+	  _run(run),
+	  _captureThread(captureThread)
 {
 	_linkHdrLen = 0;
 	_pcapSocket = NULL;
@@ -48,8 +50,38 @@ Demux::~Demux() {}
 
 void Demux::operator()() {
 	char errbuf[PCAP_ERRBUF_SIZE];	/*!< Error string */
-	string pcapPacketFilter = string();
-	pcap_if_t *devices;
+	string packetFilter;
+	// Obtaining the IP address of the NAP
+	uint32_t ipAddress, netmask;
+
+	if (pcap_lookupnet(_configuration.networkDevice().c_str(), &ipAddress,
+			&netmask, errbuf) < 0)
+	{
+		LOG4CXX_FATAL(logger, "Network address of interface "
+				<< _configuration.networkDevice() << " could not be obtained");
+		return;
+	}
+
+	_napIpAddress = ipAddress;
+	LOG4CXX_TRACE(logger, "Local IP address of '"
+			<< _configuration.networkDevice() << "' is "
+			<< _napIpAddress.str());
+	packetFilter = _packetFilter();
+	LOG4CXX_DEBUG(logger, "Set PCAP filter to " << packetFilter);
+
+	if (_configuration.captureBackend() == CAPTURE_BACKEND_TPACKET_V3)
+	{
+		_captureTpacketV3(packetFilter);
+	}
+	else
+	{
+		_capturePcap(packetFilter);
+	}
+}
+
+void Demux::_capturePcap(string &packetFilter)
+{
+	char errbuf[PCAP_ERRBUF_SIZE];	/*!< Error string */
 	struct bpf_program bpf;
 	// More info abt the pcap fields here: http://www.tcpdump.org/pcap3_man.html
 	// _device: the interface on which libpcap should sniff
@@ -72,25 +104,311 @@ void Demux::operator()() {
 
 	LOG4CXX_DEBUG(logger, "PCAP socket opened for device "
 			<< _configuration.networkDevice());
-	// Obtaining the IP address of the NAP
-	uint32_t ipAddress, netmask;
 
-	if (pcap_lookupnet(_configuration.networkDevice().c_str(), &ipAddress,
-			&netmask, errbuf) < 0)
+	// compile the PCAP filter
+	if (pcap_compile(_pcapSocket, &bpf, packetFilter.c_str(), 0, 0))
+			//_configuration.hostRoutingPrefix().netmask().uint()))
 	{
-		LOG4CXX_FATAL(logger, "Network address of interface "
-				<< _configuration.networkDevice() << " could not be obtained");
+		LOG4CXX_FATAL(logger, "PCAP filter could not be compiled: "
+				<< pcap_geterr(_pcapSocket) << "\nFilter: '"
+				<< packetFilter << "'");
 		pcap_close(_pcapSocket);
 		return;
 	}
 
-	_napIpAddress = ipAddress;
-	LOG4CXX_TRACE(logger, "Local IP address of '"
-			<< _configuration.networkDevice() << "' is "
-			<< _napIpAddress.str());
+	LOG4CXX_DEBUG(logger, "PCAP filter compiled");
+
+	if (pcap_setfilter(_pcapSocket, &bpf) < 0)
+	{
+		LOG4CXX_FATAL(logger, "PCAP filter could not be set: " <<
+				pcap_geterr(_pcapSocket));
+		pcap_close(_pcapSocket);
+		return;
+	}
+
+	LOG4CXX_DEBUG(logger, "PCAP filter set");
+	// Determine the datalink layer type
+	LOG4CXX_TRACE(logger, "Reading data link layer header size");
+	int linktype;
+
+	if ((linktype = pcap_datalink(_pcapSocket)) < 0)
+	{
+		LOG4CXX_FATAL(logger, "pcap_datalink() " << pcap_geterr(_pcapSocket));
+		pcap_close(_pcapSocket);
+		return;
+	}
+
+	// Set the datalink layer header size.
+	switch (linktype)
+	{
+	case DLT_NULL:
+		_linkHdrLen = 4;
+		break;
+	case DLT_EN10MB:
+		_linkHdrLen = 14;
+		break;
+	case DLT_SLIP:
+	case DLT_PPP:
+		_linkHdrLen = 24;
+		break;
+	default:
+		LOG4CXX_FATAL(logger, "Unsupported datalink " << _linkHdrLen);
+		pcap_close(_pcapSocket);
+		return;
+	}
+
+	// Start sniffing for packets
+	const u_char *packet;
+	struct pcap_pkthdr h;
+	// Now read packets as long as this thread has not been interrupted
+	LOG4CXX_DEBUG(logger, "Start listening for IP packets");
+
+	while (*_run)
+	{
+		packet = pcap_next(_pcapSocket, &h);
+
+		if (packet != NULL)
+		{
+			_processPacket(&h, packet);
+		}
+	}
+
+	pcap_close(_pcapSocket);
+	LOG4CXX_DEBUG(logger, "PCAP listener closed");
+}
+
+void Demux::_captureTpacketV3(string &packetFilter)
+{
+	int packetSocket;
+	int version = TPACKET_V3;
+	int linkType;
+	int socketType;
+	unsigned int ifIndex;
+	struct ifreq ifr;
+	struct bpf_program bpf;
+	struct sock_fprog filter;
+	struct tpacket_req3 req;
+	struct sockaddr_ll address;
+	struct packet_mreq membership;
+	struct tpacket_stats_v3 stats;
+	socklen_t statsLength = sizeof(stats);
+	uint8_t *ring;
+	uint32_t block = 0;
+	pcap_t *pcapDead;
+	ifIndex = if_nametoindex(_configuration.networkDevice().c_str());
+
+	if (ifIndex == 0)
+	{
+		LOG4CXX_FATAL(logger, "Interface index of "
+				<< _configuration.networkDevice() << " could not be obtained: "
+				<< strerror(errno));
+		return;
+	}
+
+	// Ethernet frames are filtered with their link header. Any other device
+	// (tun, PPP, ...) is opened in cooked mode, so that the filter and the
+	// ring only see the network layer packet
+	packetSocket = socket(AF_INET, SOCK_DGRAM, 0);
+	bzero(&ifr, sizeof(ifr));
+	strncpy(ifr.ifr_name, _configuration.networkDevice().c_str(), IFNAMSIZ-1);
+
+	if (ioctl(packetSocket, SIOCGIFHWADDR, &ifr) == -1)
+	{
+		LOG4CXX_FATAL(logger, "Link layer type of "
+				<< _configuration.networkDevice() << " could not be obtained: "
+				<< strerror(errno));
+		close(packetSocket);
+		return;
+	}
+
+	close(packetSocket);
+
+	switch (ifr.ifr_hwaddr.sa_family)
+	{
+	case ARPHRD_ETHER:
+	case ARPHRD_LOOPBACK:
+		linkType = DLT_EN10MB;
+		socketType = SOCK_RAW;
+		break;
+	default:
+		LOG4CXX_DEBUG(logger, "ARPHRD type " << ifr.ifr_hwaddr.sa_family
+				<< " of " << _configuration.networkDevice() << " is not "
+				"Ethernet. Capturing IP packets without link layer header");
+		linkType = DLT_RAW;
+		socketType = SOCK_DGRAM;
+	}
+
+	// libpcap is only used to compile the filter into a classic BPF program
+	// the kernel runs for the socket
+	pcapDead = pcap_open_dead(linkType, 65535);
+
+	if (pcap_compile(pcapDead, &bpf, packetFilter.c_str(), 0, 0))
+	{
+		LOG4CXX_FATAL(logger, "PCAP filter could not be compiled: "
+				<< pcap_geterr(pcapDead) << "\nFilter: '"
+				<< packetFilter << "'");
+		pcap_close(pcapDead);
+		return;
+	}
+
+	pcap_close(pcapDead);
+	// The protocol stays 0 until the filter is attached, so that no unfiltered
+	// packet is queued to the socket
+	packetSocket = socket(AF_PACKET, socketType, 0);
+
+	if (packetSocket == -1)
+	{
+		LOG4CXX_FATAL(logger, "AF_PACKET socket could not be created: "
+				<< strerror(errno));
+		pcap_freecode(&bpf);
+		return;
+	}
+
+	filter.len = bpf.bf_len;
+	filter.filter = (struct sock_filter *)bpf.bf_insns;
+
+	if (setsockopt(packetSocket, SOL_SOCKET, SO_ATTACH_FILTER, &filter,
+			sizeof(filter)) == -1)
+	{
+		LOG4CXX_FATAL(logger, "Packet filter could not be attached to "
+				"AF_PACKET socket: " << strerror(errno));
+		pcap_freecode(&bpf);
+		close(packetSocket);
+		return;
+	}
+
+	pcap_freecode(&bpf);
+
+	if (setsockopt(packetSocket, SOL_PACKET, PACKET_VERSION, &version,
+			sizeof(version)) == -1)
+	{
+		LOG4CXX_FATAL(logger, "TPACKET_V3 is not supported by the kernel: "
+				<< strerror(errno));
+		close(packetSocket);
+		return;
+	}
+
+	bzero(&req, sizeof(req));
+	req.tp_block_size = TPACKET_V3_BLOCK_SIZE;
+	req.tp_block_nr = TPACKET_V3_BLOCKS;
+	req.tp_frame_size = TPACKET_V3_FRAME_SIZE;
+	req.tp_frame_nr = (req.tp_block_size * req.tp_block_nr)
+			/ req.tp_frame_size;
+	req.tp_retire_blk_tov = TPACKET_V3_BLOCK_TIMEOUT;
+
+	if (setsockopt(packetSocket, SOL_PACKET, PACKET_RX_RING, &req,
+			sizeof(req)) == -1)
+	{
+		LOG4CXX_FATAL(logger, "TPACKET_V3 ring could not be requested: "
+				<< strerror(errno));
+		close(packetSocket);
+		return;
+	}
+
+	ring = (uint8_t *)mmap(NULL, req.tp_block_size * req.tp_block_nr,
+			PROT_READ | PROT_WRITE, MAP_SHARED, packetSocket, 0);
+
+	if (ring == MAP_FAILED)
+	{
+		LOG4CXX_FATAL(logger, "TPACKET_V3 ring could not be mapped: "
+				<< strerror(errno));
+		close(packetSocket);
+		return;
+	}
+
+	bzero(&address, sizeof(address));
+	address.sll_family = AF_PACKET;
+	address.sll_protocol = htons(ETH_P_ALL);
+	address.sll_ifindex = ifIndex;
+
+	if (bind(packetSocket, (struct sockaddr *)&address, sizeof(address)) == -1)
+	{
+		LOG4CXX_FATAL(logger, "AF_PACKET socket could not be bound to "
+				<< _configuration.networkDevice() << ": " << strerror(errno));
+		munmap(ring, req.tp_block_size * req.tp_block_nr);
+		close(packetSocket);
+		return;
+	}
+
+	// Promiscous mode must be enabled for capturing multicast packets
+	bzero(&membership, sizeof(membership));
+	membership.mr_ifindex = ifIndex;
+	membership.mr_type = PACKET_MR_PROMISC;
+
+	if (setsockopt(packetSocket, SOL_PACKET, PACKET_ADD_MEMBERSHIP,
+			&membership, sizeof(membership)) == -1)
+	{
+		LOG4CXX_WARN(logger, "Promiscuous mode could not be enabled on "
+				<< _configuration.networkDevice() << ": " << strerror(errno));
+	}
+
+	// All demux threads of this NAP join the same group. The kernel hashes
+	// over addresses and ports (addresses only for IP fragments), so a flow
+	// always ends up in the same thread
+	if (_configuration.captureThreads() > 1)
+	{
+		int fanout = (getpid() & 0xffff) | (PACKET_FANOUT_HASH << 16);
+
+		if (setsockopt(packetSocket, SOL_PACKET, PACKET_FANOUT, &fanout,
+				sizeof(fanout)) == -1)
+		{
+			LOG4CXX_FATAL(logger, "Demux thread " << _captureThread
+					<< " could not join packet fanout group: "
+					<< strerror(errno));
+			munmap(ring, req.tp_block_size * req.tp_block_nr);
+			close(packetSocket);
+			return;
+		}
+	}
+
+	struct pollfd pollFd;
+	pollFd.fd = packetSocket;
+	pollFd.events = POLLIN | POLLERR;
+	pollFd.revents = 0;
+	LOG4CXX_DEBUG(logger, "Demux thread " << _captureThread << " starts "
+			"listening for IP packets on a TPACKET_V3 ring of "
+			<< TPACKET_V3_BLOCKS << " blocks");
+
+	while (*_run)
+	{
+		struct tpacket_block_desc *blockDesc =
+				(struct tpacket_block_desc *)(ring
+						+ block * req.tp_block_size);
+
+		// the block still belongs to the kernel
+		if ((__atomic_load_n(&blockDesc->hdr.bh1.block_status,
+				__ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0)
+		{
+			poll(&pollFd, 1, 1000);
+			continue;
+		}
+
+		_processBlock(blockDesc);
+		// hand the block back to the kernel
+		__atomic_store_n(&blockDesc->hdr.bh1.block_status, TP_STATUS_KERNEL,
+				__ATOMIC_RELEASE);
+		block = (block + 1) % req.tp_block_nr;
+	}
+
+	if (getsockopt(packetSocket, SOL_PACKET, PACKET_STATISTICS, &stats,
+			&statsLength) == 0)
+	{
+		LOG4CXX_DEBUG(logger, "Demux thread " << _captureThread << " dropped "
+				<< stats.tp_drops << " packets and the ring ran full "
+				<< stats.tp_freeze_q_cnt << " times since the last report");
+	}
+
+	munmap(ring, req.tp_block_size * req.tp_block_nr);
+	close(packetSocket);
+	LOG4CXX_DEBUG(logger, "TPACKET_V3 listener of demux thread "
+			<< _captureThread << " closed");
+}
+
+string Demux::_packetFilter()
+{
+	char errbuf[PCAP_ERRBUF_SIZE];	/*!< Error string */
+	pcap_if_t *devices;
 	// set PCAP filters to capture IPv4 packets only
-	// The PCAP filter follows the TCPDUMP syntax:
-	// http://www.tcpdump.org/manpages/pcap-filter.7.html
 	ostringstream oss;
 	oss << "ip and !(dst 255.255.255.255) and !(dst 0.0.0.0) and ";
 
@@ -120,11 +438,17 @@ void Demux::operator()() {
 					// if networking interface, get IP and add it to PCAP filter
 					if(a->addr->sa_family == AF_INET)
 					{
-						_configuration.ipAddress(
-								inet_ntoa(((struct sockaddr_in*)a->addr)->sin_addr));
-						oss << " and !(dst " << _configuration.ipAddress().str()
-								<< ")";
+						char *ipAddress = inet_ntoa(
+								((struct sockaddr_in*)a->addr)->sin_addr);
+
+						// all demux threads build the filter, one reports the
+						// address
+						if (_captureThread == 0)
+						{
+							_configuration.ipAddress(ipAddress);
+						}
 
+						oss << " and !(dst " << ipAddress << ")";
 					}
 				}
 			}
@@ -161,215 +485,186 @@ void Demux::operator()() {
 				<< ")";
 	}
 
-	pcapPacketFilter = oss.str();
-	LOG4CXX_DEBUG(logger, "Set PCAP filter to " << pcapPacketFilter);
+	return oss.str();
+}
 
-	// compile the PCAP filter
-	if (pcap_compile(_pcapSocket, &bpf, pcapPacketFilter.c_str(), 0, 0))
-			//_configuration.hostRoutingPrefix().netmask().uint()))
+void Demux::_processBlock(struct tpacket_block_desc *block)
+{
+	struct tpacket3_hdr *frame;
+	struct sockaddr_ll *link;
+	struct pcap_pkthdr h;
+	uint32_t linkHdrLen;
+	frame = (struct tpacket3_hdr *)((uint8_t *)block
+			+ block->hdr.bh1.offset_to_first_pkt);
+
+	for (uint32_t i = 0; i < block->hdr.bh1.num_pkts; i++)
 	{
-		LOG4CXX_FATAL(logger, "PCAP filter could not be compiled: "
-				<< pcap_geterr(_pcapSocket) << "\nFilter: '"
-				<< pcapPacketFilter << "'");
-		pcap_close(_pcapSocket);
-		return;
-	}
+		// The kernel has already removed any VLAN tag and points tp_net to
+		// the network layer header, whatever link layer the device has
+		link = (struct sockaddr_ll *)((uint8_t *)frame
+				+ TPACKET_ALIGN(sizeof(struct tpacket3_hdr)));
 
-	LOG4CXX_DEBUG(logger, "PCAP filter compiled");
+		if (ntohs(link->sll_protocol) == ETH_P_IP)
+		{
+			linkHdrLen = frame->tp_net - frame->tp_mac;
+			h.ts.tv_sec = frame->tp_sec;
+			h.ts.tv_usec = frame->tp_nsec / 1000;
+			h.caplen = frame->tp_snaplen - linkHdrLen;
+			h.len = frame->tp_len - linkHdrLen;
+			_processIpPacket(&h, (u_char *)frame + frame->tp_net);
+		}
+		else
+		{
+			LOG4CXX_TRACE(logger, "Protocol " << ntohs(link->sll_protocol)
+					<< " does not need to be handled. Dropping packet");
+		}
 
-	if (pcap_setfilter(_pcapSocket, &bpf) < 0)
-	{
-		LOG4CXX_FATAL(logger, "PCAP filter could not be set: " <<
-				pcap_geterr(_pcapSocket));
-		pcap_close(_pcapSocket);
-		return;
+		frame = (struct tpacket3_hdr *)((uint8_t *)frame
+				+ frame->tp_next_offset);
 	}
+}
 
-	LOG4CXX_DEBUG(logger, "PCAP filter set");
-	// Determine the datalink layer type
-	LOG4CXX_TRACE(logger, "Reading data link layer header size");
-	int linktype;
+void Demux::_processIpPacket(const struct pcap_pkthdr *header,
+		const u_char *packet)
+{
+	struct ip *ipHeader;
+	IpAddress sourceIpAddress, destinationIpAddress;
 
-	if ((linktype = pcap_datalink(_pcapSocket)) < 0)
+	if (header->len > header->caplen)
 	{
-		LOG4CXX_FATAL(logger, "pcap_datalink() " << pcap_geterr(_pcapSocket));
-		pcap_close(_pcapSocket);
+		LOG4CXX_DEBUG(logger, "Number of captured bytes is smaller than the"
+				"actual packet. Dropping it ...");
 		return;
 	}
 
-	// Set the datalink layer header size.
-	switch (linktype)
+	ipHeader = (struct ip *)packet;
+	sourceIpAddress = ipHeader->ip_src.s_addr;
+	destinationIpAddress = ipHeader->ip_dst.s_addr;
+	int ttl = ipHeader->ip_ttl;
+	int ipHeaderLength = 4 * ipHeader->ip_hl;
+	uint16_t ipPacketSize = ntohs(ipHeader->ip_len);
+	LOG4CXX_TRACE(logger, "IP packet received with header: "
+			<< "SRC: " << sourceIpAddress.str()
+			<< "\tDST: " << destinationIpAddress.str()
+			<< "\tID: " << ntohs(ipHeader->ip_id)
+			<< "\tTOS: " << ntohs(ipHeader->ip_tos)
+			<< "\tTTL: " << ttl
+			<< "\tFlags: " << htons(ipHeader->ip_off)
+			<< "\tIP HL: " << ipHeaderLength
+			<< "\tIP packet length: " << ntohs(ipHeader->ip_len));
+
+	// Check if IP packet is larger than MTU. If so, send IGMP back to
+	// lower MTU
+	if (htons(ipHeader->ip_off) == IP_DF
+			&& header->len > _configuration.mtu())
 	{
-	case DLT_NULL:
-		_linkHdrLen = 4;
-		break;
-	case DLT_EN10MB:
-		_linkHdrLen = 14;
-		break;
-	case DLT_SLIP:
-	case DLT_PPP:
-		_linkHdrLen = 24;
-		break;
-	default:
-		LOG4CXX_FATAL(logger, "Unsupported datalink " << _linkHdrLen);
-		pcap_close(_pcapSocket);
-		return;
+		_ipSocket.icmp(destinationIpAddress, sourceIpAddress,
+				ipHeaderLength, ICMP_FRAG_NEEDED);
+		LOG4CXX_DEBUG(logger, "DF flag set in IPv4 header but MTU ("
+				<< _configuration.mtu() << ") < IP packet (" << header->len
+				);//<< "). Dropping packet from " << sourceIpAddress.str());
+		//return;
 	}
 
-	// Start sniffing for packets
-	const u_char *packet;
-	struct pcap_pkthdr h;
-	// Now read packets as long as this thread has not been interrupted
-	LOG4CXX_DEBUG(logger, "Start listening for IP packets");
+	if (!_configuration.icnGatewayIp() || !_configuration.surrogacy())
+	{//only report if this NAP is not an ICN GW or an eNAP
+		_statistics.ipEndpointAdd(sourceIpAddress);
+	}
 
-	while (*_run)
+	packet += ipHeaderLength;
+
+	switch (ipHeader->ip_p)
 	{
-		packet = pcap_next(_pcapSocket, &h);
+	case IPPROTO_TCP:
+	{
+		struct tcphdr *tcpHeader;
+		tcpHeader = (struct tcphdr*)packet;
+		LOG4CXX_TRACE(logger, "TCP Header: "
+				<< "Src Port=" << ntohs(tcpHeader->source)
+				<< "\tDst Port=" << ntohs(tcpHeader->dest)
+				<< "\tSeq=" << ntohl(tcpHeader->seq)
+				<< "\tAckSeq=" << ntohl(tcpHeader->ack_seq)
+				<< "\tWindow=" << ntohs(tcpHeader->window)
+				<< "\tTCP Length=" << 4 * tcpHeader->doff);
+		LOG4CXX_TRACE(logger, "Invoking IP handler (TCP)");
+		break;
+	}
+	case IPPROTO_UDP:
+	{
+		struct udphdr *udpHeader;
+		int pref;
+		udpHeader = (struct udphdr *)packet;
+        LOG4CXX_TRACE(logger, "UDP Header: "
+            << "Src port:" << ntohs(udpHeader->source)
+            << " -> Dst port: " << ntohs(udpHeader->dest));
+
+        // check for multicast destination address and handle
+        const char * addrCharArr = destinationIpAddress.str().c_str();
+        sscanf(addrCharArr, "%d.", &pref);
+
+        if (pref > 223 && pref < 240)
+        {
+            packet -= 4 * ipHeader->ip_hl; // reverse skipped IP header
+            _namespaces.MCast::handleMcastDataAtSNap(sourceIpAddress,
+            		destinationIpAddress, (uint8_t *) packet, ipPacketSize);
+            return;
+        }
 
-		if (packet != NULL)
-		{
-			_processPacket(&h, packet);
-		}
+        break;
+    }
+	case IPPROTO_ICMP:
+	{
+		struct icmphdr *icmpHeader;
+		icmpHeader = (struct icmphdr *)packet;
+		LOG4CXX_TRACE(logger, "ICMP Header: "
+				<< "Code: " << ntohs(icmpHeader->code) << " | "
+				<< "Type: " << ntohs(icmpHeader->type) << " | "
+				<< "ID: " << ntohs(icmpHeader->un.echo.id) << " | "
+				<< "Seq: " << ntohs(icmpHeader->un.echo.sequence)
+				);
+		break;
+    }
+    case IPPROTO_IGMP:
+    {
+      struct igmp *igmpHdr;
+      igmpHdr = (struct igmp *) packet;
+
+      LOG4CXX_DEBUG(logger, "IGMP Header: "
+          << "Type: " << ntohs(igmpHdr->igmp_type) << " |"
+          << " Code: " << ntohs(igmpHdr->igmp_code) << " |"
+          << " Checksum: " << ntohs(igmpHdr->igmp_cksum)
+          );
+      _namespaces.MCast::handle(sourceIpAddress, destinationIpAddress,
+    		  (uint8_t *) packet);
+      return;
+    }
+    case IPPROTO_RAW:
+	{
+		LOG4CXX_TRACE(logger, "RAW IP packet received. "
+				<< "No Layer 4 Header available");
+		break;
+	}
 	}
 
-	pcap_close(_pcapSocket);
-	LOG4CXX_DEBUG(logger, "PCAP listener closed");
+	packet -= 4 * ipHeader->ip_hl;
+	_namespaces.Ip::handle(destinationIpAddress, (uint8_t *)packet,
+			ipPacketSize);
 }
 
+
 void Demux::_processPacket(const struct pcap_pkthdr *header,
 		const u_char *packet)
 {
-	struct ip *ipHeader;
 	struct ether_header *eptr;
-	IpAddress sourceIpAddress, destinationIpAddress;
 	eptr = (struct ether_header *) packet;
 	LOG4CXX_TRACE(logger, "Processing Ethernet packet: Type "
 			<< ntohs(eptr->ether_type) << ", Length " << header->len << ", Cap "
 					"Length " << header->caplen);
 
-	if (header->len > header->caplen)
-	{
-		LOG4CXX_DEBUG(logger, "Number of captured bytes is smaller than the"
-				"actual packet. Dropping it ...");
-		return;
-	}
-
 	//IPv4 packet in ethernet playload
 	if (ntohs(eptr->ether_type) == ETHERTYPE_IP)
 	{
-		packet += _linkHdrLen; // Skipping Ethernet header
-		ipHeader = (struct ip *)packet;
-		sourceIpAddress = ipHeader->ip_src.s_addr;
-		destinationIpAddress = ipHeader->ip_dst.s_addr;
-		int ttl = ipHeader->ip_ttl;
-		int ipHeaderLength = 4 * ipHeader->ip_hl;
-		uint16_t ipPacketSize = ntohs(ipHeader->ip_len);
-		LOG4CXX_TRACE(logger, "IP packet received with header: "
-				<< "SRC: " << sourceIpAddress.str()
-				<< "\tDST: " << destinationIpAddress.str()
-				<< "\tID: " << ntohs(ipHeader->ip_id)
-				<< "\tTOS: " << ntohs(ipHeader->ip_tos)
-				<< "\tTTL: " << ttl
-				<< "\tFlags: " << htons(ipHeader->ip_off)
-				<< "\tIP HL: " << ipHeaderLength
-				<< "\tIP packet length: " << ntohs(ipHeader->ip_len));
-
-		// Check if IP packet is larger than MTU. If so, send IGMP back to
-		// lower MTU
-		if (htons(ipHeader->ip_off) == IP_DF
-				&& header->len > _configuration.mtu())
-		{
-			_ipSocket.icmp(destinationIpAddress, sourceIpAddress,
-					ipHeaderLength, ICMP_FRAG_NEEDED);
-			LOG4CXX_DEBUG(logger, "DF flag set in IPv4 header but MTU ("
-					<< _configuration.mtu() << ") < IP packet (" << header->len
-					);//<< "). Dropping packet from " << sourceIpAddress.str());
-			//return;
-		}
-
-		if (!_configuration.icnGatewayIp() || !_configuration.surrogacy())
-		{//only report if this NAP is not an ICN GW or an eNAP
-			_statistics.ipEndpointAdd(sourceIpAddress);
-		}
-
-		packet += ipHeaderLength;
-
-		switch (ipHeader->ip_p)
-		{
-		case IPPROTO_TCP:
-		{
-			struct tcphdr *tcpHeader;
-			tcpHeader = (struct tcphdr*)packet;
-			LOG4CXX_TRACE(logger, "TCP Header: "
-					<< "Src Port=" << ntohs(tcpHeader->source)
-					<< "\tDst Port=" << ntohs(tcpHeader->dest)
-					<< "\tSeq=" << ntohl(tcpHeader->seq)
-					<< "\tAckSeq=" << ntohl(tcpHeader->ack_seq)
-					<< "\tWindow=" << ntohs(tcpHeader->window)
-					<< "\tTCP Length=" << 4 * tcpHeader->doff);
-			LOG4CXX_TRACE(logger, "Invoking IP handler (TCP)");
-			break;
-		}
-		case IPPROTO_UDP:
-		{
-			struct udphdr *udpHeader;
-			int pref;
-			udpHeader = (struct udphdr *)packet;
-            LOG4CXX_TRACE(logger, "UDP Header: "
-                << "Src port:" << ntohs(udpHeader->source)
-                << " -> Dst port: " << ntohs(udpHeader->dest));
-
-            // check for multicast destination address and handle
-            const char * addrCharArr = destinationIpAddress.str().c_str();
-            sscanf(addrCharArr, "%d.", &pref);
-
-            if (pref > 223 && pref < 240)
-            {
-                packet -= 4 * ipHeader->ip_hl; // reverse skipped IP header
-                _namespaces.MCast::handleMcastDataAtSNap(sourceIpAddress,
-                		destinationIpAddress, (uint8_t *) packet, ipPacketSize);
-                return;
-            }
-
-            break;
-        }
-		case IPPROTO_ICMP:
-		{
-			struct icmphdr *icmpHeader;
-			icmpHeader = (struct icmphdr *)packet;
-			LOG4CXX_TRACE(logger, "ICMP Header: "
-					<< "Code: " << ntohs(icmpHeader->code) << " | "
-					<< "Type: " << ntohs(icmpHeader->type) << " | "
-					<< "ID: " << ntohs(icmpHeader->un.echo.id) << " | "
-					<< "Seq: " << ntohs(icmpHeader->un.echo.sequence)
-					);
-			break;
-        }
-        case IPPROTO_IGMP:
-        {
-          struct igmp *igmpHdr;
-          igmpHdr = (struct igmp *) packet;
-
-          LOG4CXX_DEBUG(logger, "IGMP Header: "
-              << "Type: " << ntohs(igmpHdr->igmp_type) << " |"
-              << " Code: " << ntohs(igmpHdr->igmp_code) << " |"
-              << " Checksum: " << ntohs(igmpHdr->igmp_cksum)
-              );
-          _namespaces.MCast::handle(sourceIpAddress, destinationIpAddress,
-        		  (uint8_t *) packet);
-          return;
-        }
-        case IPPROTO_RAW:
-		{
-			LOG4CXX_TRACE(logger, "RAW IP packet received. "
-					<< "No Layer 4 Header available");
-			break;
-		}
-		}
-
-		packet -= 4 * ipHeader->ip_hl;
-		_namespaces.Ip::handle(destinationIpAddress, (uint8_t *)packet,
-				ipPacketSize);
+		_processIpPacket(header, packet + _linkHdrLen);
 	}
 	// IPv6 packet
 	else if (ntohs(eptr->ether_type) == ETHERTYPE_IPV6)
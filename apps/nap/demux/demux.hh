@@ -26,7 +26,11 @@
 #define NAP_DEMUX_HH_
 
 #include <arpa/inet.h>
+#include <errno.h>
+#include <linux/filter.h>
 #include <log4cxx/logger.h>
+#include <net/if.h>
+#include <net/if_arp.h>
 #include <netinet/igmp.h>
 #include <netinet/in.h>
 #include <netinet/ip.h>
@@ -35,10 +39,14 @@
 #include <netinet/ip_icmp.h>
 #include <netinet/if_ether.h> /* includes net/ethernet.h */
 #include <netinet/ether.h>
+#include <linux/if_packet.h>
 #include <pcap.h>
+#include <poll.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
 #include <configuration.hh>
@@ -51,6 +59,11 @@
 #include "dmalloc.h"
 #endif
 
+#define TPACKET_V3_BLOCK_SIZE (1 << 20) // 1 MB per ring block
+#define TPACKET_V3_BLOCKS 32 // ring blocks per demux thread
+#define TPACKET_V3_FRAME_SIZE 2048 // only used by the kernel for sanity checks
+#define TPACKET_V3_BLOCK_TIMEOUT 10 // [ms] a partially filled block is retired
+
 using namespace log4cxx;
 using namespace monitoring::statistics;
 
@@ -67,9 +80,13 @@ class Demux
 public:
 	/*!
 	 * \brief Demux Constructor
+	 *
+	 * \param captureThread The index of this demux thread out of
+	 * Configuration::captureThreads()
 	 */
 	Demux(Namespaces &namespaces, Configuration &configuration,
-			Statistics &statistics, IpSocket &ipSocket, bool *run);
+			Statistics &statistics, IpSocket &ipSocket, bool *run,
+			uint16_t captureThread = 0);
 	/*!
 	 * \brief Destructor
 	 */
@@ -86,9 +103,30 @@ private:
 	Statistics &_statistics;/*!< Reference to statistics class */
 	IpSocket &_ipSocket; /*!< Reference to IpSocket class */
 	bool *_run;/*!< from main thread is any SIG* had been caught */
+	uint16_t _captureThread;/*!< Index of this demux thread */
 	pcap_t *_pcapSocket;/*!< PCAP pointer for listening socket */
 	IpAddress _napIpAddress;/*!< IP address of the NAP */
-	uint32_t _linkHdrLen;/*!< Ethernet header length of the NAP's interface */
+	uint32_t _linkHdrLen;/*!< Link layer header length of the NAP's interface
+	when capturing with libpcap */
+	/*!
+	 * \brief Capture IP packets with libpcap
+	 *
+	 * \param packetFilter The filter in TCPDUMP syntax
+	 */
+	void _capturePcap(string &packetFilter);
+	/*!
+	 * \brief Capture IP packets from an AF_PACKET TPACKET_V3 ring
+	 *
+	 * The kernel fills entire blocks of the memory mapped ring and hands them
+	 * over to the demux, which processes all packets of a block without a
+	 * single system call. If more than one demux thread is configured, all
+	 * threads join the same fanout group and the kernel distributes packets by
+	 * their flow hash, so that packets of one flow are always processed by the
+	 * same thread and in order.
+	 *
+	 * \param packetFilter The filter in TCPDUMP syntax
+	 */
+	void _captureTpacketV3(string &packetFilter);
 	/*!
 	 * \brief Obtain the IP address of the NAP using the interface name provided
 	 * in nap.cfg
@@ -97,6 +135,29 @@ private:
 	 * obtained
 	 */
 	bool _getNapIpAddress();
+	/*!
+	 * \brief Build the packet filter for IP packets from IP endpoints
+	 *
+	 * The PCAP filter follows the TCPDUMP syntax:
+	 * http://www.tcpdump.org/manpages/pcap-filter.7.html
+	 *
+	 * \return The packet filter
+	 */
+	string _packetFilter();
+	/*!
+	 * \brief Process all packets of a ring block
+	 *
+	 * \param block Pointer to the block descriptor
+	 */
+	void _processBlock(struct tpacket_block_desc *block);
+	/*!
+	 * \brief Process an incoming IPv4 packet
+	 *
+	 * \param header Pointer to the pcap header
+	 * \param packet Pointer to the IP header of the packet
+	 */
+	void _processIpPacket(const struct pcap_pkthdr *header,
+			const u_char *packet);
 	/*!
 	 * \brief Process an incoming packet
 	 *
@@ -0,0 +1,543 @@
+/*
+ * main.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include <proxies/http/reactor.hh>
+
+#define BODY_SIZE 1024 // octets per HTTP response body
+#define BUFFER_SIZE 65535 // octets, default tcpClientSocketBufferSize
+#define DRIVERS 8 // threads acting as browsers
+#define PUBLISH_DELAY 200 // ms, one CMC group retry in Http::handleResponse()
+
+using namespace proxies::http::reactor;
+using namespace std;
+
+const string request = "GET /index.html HTTP/1.1\r\nHost: origin.testbed"
+		"\r\n\r\n";
+// response is published with PUBLISH_DELAY
+const string slowRequest = "GET /slow.html HTTP/1.1\r\nHost: origin.testbed"
+		"\r\n\r\n";
+string response;
+bool run = true;
+uint16_t publishers = 32;
+atomic<uint64_t> requests(0);
+atomic<uint64_t> slowRequests(0);
+
+/*!
+ * \brief HTTP request travelling over the ICN stand-in from cNAP to sNAP
+ */
+struct icn_packet_t
+{
+	socket_fd_t sessionKey;/*!< Browser socket FD at the cNAP */
+	uint8_t *packet;
+	uint16_t packetSize;
+};
+
+/*!
+ * \brief In-process stand-in for the ICN core between cNAP and sNAP
+ */
+struct Icn
+{
+	deque<icn_packet_t> queue;
+	std::mutex mutex;
+	condition_variable available;
+};
+
+Icn icn;
+// sNAP: browser socket FD at the cNAP > server socket FD (NAP's _socketFds)
+unordered_map<socket_fd_t, socket_fd_t> socketFds;
+std::mutex socketFdsMutex;
+uint16_t originPort;
+
+/*!
+ * \brief Listen on an ephemeral loopback port
+ */
+socket_fd_t listener(uint16_t &port)
+{
+	struct sockaddr_in address;
+	socklen_t addressLength = sizeof(address);
+	socket_fd_t socketFd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	bzero(&address, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	bind(socketFd, (struct sockaddr *)&address, sizeof(address));
+	listen(socketFd, 4096);
+	getsockname(socketFd, (struct sockaddr *)&address, &addressLength);
+	port = ntohs(address.sin_port);
+	return socketFd;
+}
+
+/*!
+ * \brief Connect to a loopback port
+ */
+socket_fd_t connectTo(uint16_t port)
+{
+	struct sockaddr_in address;
+	int one = 1;
+	socket_fd_t socketFd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	bzero(&address, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	if (connect(socketFd, (struct sockaddr *)&address, sizeof(address)) == -1)
+	{
+		cerr << "connect: " << strerror(errno) << endl;
+		close(socketFd);
+		return -1;
+	}
+
+	setsockopt(socketFd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	return socketFd;
+}
+
+/*!
+ * \brief Origin server session
+ */
+class OriginSession: public SocketHandler
+{
+public:
+	OriginSession(socket_fd_t socketFd)
+		: _socketFd(socketFd)
+	{}
+	bool readable()
+	{
+		char packet[BUFFER_SIZE];
+
+		if (read(_socketFd, packet, sizeof(packet)) <= 0)
+		{
+			return false;
+		}
+
+		return send(_socketFd, response.c_str(), response.length(),
+				MSG_NOSIGNAL) > 0;
+	}
+	void closed()
+	{
+		close(_socketFd);
+	}
+private:
+	socket_fd_t _socketFd;
+};
+
+/*!
+ * \brief cNAP side of a browser session (NAP's TcpServer)
+ */
+class TcpServer: public SocketHandler
+{
+public:
+	TcpServer(socket_fd_t socketFd)
+		: _socketFd(socketFd)
+	{}
+	bool readable()
+	{
+		icn_packet_t icnPacket;
+		uint8_t packet[BUFFER_SIZE];
+		int bytesRead = read(_socketFd, packet, sizeof(packet));
+
+		if (bytesRead <= 0)
+		{
+			return false;
+		}
+
+		// Http::handleRequest() publishes the request over ICN
+		icnPacket.sessionKey = _socketFd;
+		icnPacket.packet = (uint8_t *)malloc(bytesRead);
+		icnPacket.packetSize = bytesRead;
+		memcpy(icnPacket.packet, packet, bytesRead);
+		icn.mutex.lock();
+		icn.queue.push_back(icnPacket);
+		icn.mutex.unlock();
+		icn.available.notify_one();
+		return true;
+	}
+	void closed()
+	{
+		socket_fd_t serverFd = -1;
+		unordered_map<socket_fd_t, socket_fd_t>::iterator socketFdsIt;
+		// Http::deleteSession() lets the sNAP close its server session
+		socketFdsMutex.lock();
+		socketFdsIt = socketFds.find(_socketFd);
+
+		if (socketFdsIt != socketFds.end())
+		{
+			serverFd = socketFdsIt->second;
+			socketFds.erase(socketFdsIt);
+		}
+
+		socketFdsMutex.unlock();
+
+		if (serverFd != -1)
+		{
+			shutdown(serverFd, SHUT_RDWR);
+		}
+
+		close(_socketFd);
+	}
+private:
+	socket_fd_t _socketFd;
+};
+
+/*!
+ * \brief sNAP side of a server session (NAP's TcpClientRead)
+ */
+class TcpClientRead: public SocketHandler
+{
+public:
+	TcpClientRead(socket_fd_t socketFd, socket_fd_t sessionKey, bool slow)
+		: _socketFd(socketFd),
+		  _sessionKey(sessionKey),
+		  _slow(slow),
+		  _packetSize(0),
+		  _pending(false),
+		  _received(0)
+	{}
+	bool readable()
+	{
+		int bytesReceived = read(_socketFd, _packet, sizeof(_packet));
+
+		if (bytesReceived <= 0)
+		{
+			return false;
+		}
+
+		_packetSize = bytesReceived;
+
+		// NAP releases before the publisher threads
+		if (publishers == 0)
+		{
+			return finish();
+		}
+
+		_pending = true;
+		return true;
+	}
+	bool deferred()
+	{
+		return _pending;
+	}
+	bool finish()
+	{
+		_pending = false;
+
+		// Http::handleResponse() waiting for the CMC group
+		if (_slow)
+		{
+			this_thread::sleep_for(chrono::milliseconds(PUBLISH_DELAY));
+		}
+
+		// Http::handleResponse() publishes the response over ICN and the cNAP
+		// writes it to the browser socket in the ICN handler
+		if (send(_sessionKey, _packet, _packetSize, MSG_NOSIGNAL) <= 0)
+		{
+			return false;
+		}
+
+		_received += _packetSize;
+
+		if (_slow)
+		{
+			slowRequests += _received / response.length();
+		}
+		else
+		{
+			requests += _received / response.length();
+		}
+
+		_received %= response.length();
+		return true;
+	}
+	void closed()
+	{
+		close(_socketFd);
+	}
+private:
+	socket_fd_t _socketFd;
+	socket_fd_t _sessionKey;
+	bool _slow;
+	uint8_t _packet[BUFFER_SIZE];
+	uint16_t _packetSize;
+	bool _pending;
+	size_t _received;
+};
+
+/*!
+ * \brief sNAP: send an HTTP request to the origin (NAP's TcpClient functor)
+ */
+void tcpClient(Reactor *reactor, icn_packet_t icnPacket)
+{
+	socket_fd_t socketFd;
+	unordered_map<socket_fd_t, socket_fd_t>::iterator socketFdsIt;
+	socketFdsMutex.lock();
+	socketFdsIt = socketFds.find(icnPacket.sessionKey);
+
+	if (socketFdsIt != socketFds.end())
+	{
+		socketFd = socketFdsIt->second;
+	}
+	else
+	{
+		socketFd = connectTo(originPort);
+
+		if (socketFd != -1)
+		{
+			socketFds.insert(pair<socket_fd_t, socket_fd_t>(
+					icnPacket.sessionKey, socketFd));
+			reactor->add(socketFd, new TcpClientRead(socketFd,
+					icnPacket.sessionKey, string((char *)icnPacket.packet,
+					icnPacket.packetSize).find("/slow.html") != string::npos));
+		}
+	}
+
+	socketFdsMutex.unlock();
+
+	if (socketFd != -1)
+	{
+		send(socketFd, icnPacket.packet, icnPacket.packetSize, MSG_NOSIGNAL);
+	}
+
+	free(icnPacket.packet);
+}
+
+/*!
+ * \brief ICN handler of the sNAP: hand requests to the reactor
+ */
+void icnHandler(Reactor *reactor)
+{
+	icn_packet_t icnPacket;
+
+	while (run)
+	{
+		unique_lock<std::mutex> lock(icn.mutex);
+
+		if (icn.queue.empty())
+		{
+			icn.available.wait_for(lock, chrono::milliseconds(100));
+			continue;
+		}
+
+		icnPacket = icn.queue.front();
+		icn.queue.pop_front();
+		lock.unlock();
+		reactor->post(std::bind(tcpClient, reactor, icnPacket));
+	}
+}
+
+/*!
+ * \brief Accept TCP sessions and hand them to the reactor
+ */
+void acceptor(Reactor *reactor, socket_fd_t listenerFd, bool origin)
+{
+	socket_fd_t socketFd;
+	int one = 1;
+
+	while (run)
+	{
+		socketFd = accept(listenerFd, NULL, NULL);
+
+		if (socketFd == -1)
+		{
+			continue;
+		}
+
+		setsockopt(socketFd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+		if (origin)
+		{
+			reactor->add(socketFd, new OriginSession(socketFd));
+		}
+		else
+		{
+			reactor->add(socketFd, new TcpServer(socketFd));
+		}
+	}
+}
+
+/*!
+ * \brief Browsers keeping their share of the connections busy
+ */
+void driver(vector<socket_fd_t> connections, const string *request,
+		bool *drive)
+{
+	char packet[BUFFER_SIZE];
+	size_t received;
+	int bytesRead;
+
+	while (*drive)
+	{
+		for (size_t i = 0; i < connections.size(); i++)
+		{
+			send(connections[i], request->c_str(), request->length(),
+					MSG_NOSIGNAL);
+		}
+
+		for (size_t i = 0; i < connections.size(); i++)
+		{
+			received = 0;
+
+			while (received < response.length())
+			{
+				bytesRead = read(connections[i], packet,
+						response.length() - received);
+
+				if (bytesRead <= 0)
+				{
+					cerr << "Browser session closed unexpectedly" << endl;
+					return;
+				}
+
+				received += bytesRead;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < connections.size(); i++)
+	{
+		close(connections[i]);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t connections = 1000;
+	uint16_t workers = 16;
+	uint32_t seconds = 10;
+	uint32_t slow = 0;
+	uint16_t proxyPort;
+	bool drive = true;
+	// the last driver runs the slow sessions
+	vector<vector<socket_fd_t>> driverConnections(DRIVERS + 1);
+	vector<std::thread> threads;
+
+	if (argc > 1)
+	{
+		connections = atoi(argv[1]);
+	}
+
+	if (argc > 2)
+	{
+		workers = atoi(argv[2]);
+	}
+
+	if (argc > 3)
+	{
+		seconds = atoi(argv[3]);
+	}
+
+	if (argc > 4)
+	{
+		slow = atoi(argv[4]);
+	}
+
+	if (argc > 5)
+	{
+		publishers = atoi(argv[5]);
+	}
+
+	response = "HTTP/1.1 200 OK\r\nContent-Length: " + to_string(BODY_SIZE)
+			+ "\r\n\r\n" + string(BODY_SIZE, 'x');
+	Reactor reactor(workers, publishers, &run);
+	reactor.start();
+	socket_fd_t originFd = listener(originPort);
+	socket_fd_t proxyFd = listener(proxyPort);
+	std::thread(acceptor, &reactor, originFd, true).detach();
+	std::thread(acceptor, &reactor, proxyFd, false).detach();
+	threads.push_back(std::thread(icnHandler, &reactor));
+
+	for (uint32_t i = 0; i < connections + slow; i++)
+	{
+		socket_fd_t socketFd = connectTo(proxyPort);
+
+		if (socketFd == -1)
+		{
+			cerr << "Only " << i << " browser sessions could be opened" << endl;
+			return EXIT_FAILURE;
+		}
+
+		driverConnections[(i < slow) ? DRIVERS : i % DRIVERS].push_back(
+				socketFd);
+	}
+
+	cout << connections << " browser sessions (+" << slow << " slow), "
+			<< workers << " reactor workers, " << publishers << " publishers, "
+			<< seconds << "s" << endl;
+	auto start = chrono::steady_clock::now();
+
+	for (uint16_t i = 0; i <= DRIVERS; i++)
+	{
+		threads.push_back(std::thread(driver, driverConnections[i],
+				(i < DRIVERS) ? &request : &slowRequest, &drive));
+	}
+
+	this_thread::sleep_for(chrono::seconds(seconds));
+	drive = false;
+
+	for (size_t i = 1; i < threads.size(); i++)
+	{
+		threads[i].join();
+	}
+
+	double elapsed = chrono::duration<double>(chrono::steady_clock::now()
+			- start).count();
+	uint64_t completed = requests;
+	uint64_t slowCompleted = slowRequests;
+
+	// wait for the reactor to close all server and origin sessions
+	for (uint16_t i = 0; i < 100 && reactor.sockets() > 0; i++)
+	{
+		this_thread::sleep_for(chrono::milliseconds(100));
+	}
+
+	cout << "Requests:          " << completed << endl;
+	cout << "Requests/s:        " << (uint64_t)(completed / elapsed) << endl;
+	cout << "Slow requests/s:   " << (uint64_t)(slowCompleted / elapsed)
+			<< endl;
+	// reactor workers and publishers + acceptors + ICN handler
+	cout << "Threads (reactor): " << workers + publishers + 3 << endl;
+	cout << "Threads (1 per TCP session): " << 2 * (connections + slow) + 3
+			<< endl;
+	cout << "Sockets left:      " << reactor.sockets() << endl;
+	run = false;
+	threads[0].join();
+	shutdown(originFd, SHUT_RDWR);
+	shutdown(proxyFd, SHUT_RDWR);
+	close(originFd);
+	close(proxyFd);
+	// reactor workers return within one epoll_wait() timeout
+	this_thread::sleep_for(chrono::milliseconds(1500));
+	return EXIT_SUCCESS;
+}
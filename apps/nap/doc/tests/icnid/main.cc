@@ -0,0 +1,106 @@
+/*
+ * main.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <blackadder.hpp>
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+#include <unordered_map>
+#include <vector>
+
+#include <types/icnid.hh>
+
+using namespace std;
+
+/*!
+ * \brief Run an operation over all CIDs and report the time per operation
+ */
+template<typename operation_t>
+void measure(const char *name, size_t cids, uint32_t rounds,
+		operation_t operation)
+{
+	uint64_t checksum = 0;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	for (uint32_t round = 0; round < rounds; round++)
+	{
+		for (size_t i = 0; i < cids; i++)
+		{
+			checksum += operation(i);
+		}
+	}
+
+	double nanoseconds = chrono::duration<double, nano>(
+			chrono::steady_clock::now() - start).count();
+	cout << name << ":\t" << nanoseconds / (cids * rounds) << " ns\t(checksum "
+			<< checksum << ")" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+	size_t cids = (argc > 1) ? atoi(argv[1]) : 10000;
+	uint32_t rounds = (argc > 2) ? atoi(argv[2]) : 100;
+	RoutingPrefix routingPrefix("172.16.0.0", "255.255.0.0");
+	vector<IpAddress> ipAddresses;
+	vector<IcnId> icnIds;
+	vector<string> eventIds;
+	unordered_map<uint32_t, IcnId> icnIdMap;
+
+	for (size_t i = 0; i < cids; i++)
+	{
+		ipAddresses.push_back(IpAddress(
+				htonl(0xac100000 | (uint32_t)(i & 0xffff))));
+		icnIds.push_back(IcnId(routingPrefix, ipAddresses[i]));
+		eventIds.push_back(icnIds[i].binIcnId());
+		icnIdMap.insert(pair<uint32_t, IcnId>(icnIds[i].uint(), icnIds[i]));
+	}
+
+	cout << "CIDs: " << cids << ", rounds: " << rounds << endl;
+	measure("construct", cids, rounds, [&](size_t i)
+	{
+		IcnId cid(routingPrefix, ipAddresses[i]);
+		return cid.uint();
+	});
+	measure("event", cids, rounds, [&](size_t i)
+	{
+		IcnId cid;
+#ifdef ICN_ID_SCOPE_LEVELS
+		cid.binIcnId(eventIds[i]);
+#else
+		string cidStr = chararray_to_hex(eventIds[i]);
+		cid = cidStr;
+#endif
+		return cid.uint();
+	});
+	measure("publish", cids, rounds, [&](size_t i)
+	{
+		return icnIds[i].binIcnId().length();
+	});
+	measure("lookup", cids, rounds, [&](size_t i)
+	{
+		return icnIdMap.find(icnIds[i].uint())->second.scopeLevels();
+	});
+	measure("print", cids / 10 + 1, rounds, [&](size_t i)
+	{
+		return icnIds[i].print().length();
+	});
+	return 0;
+}
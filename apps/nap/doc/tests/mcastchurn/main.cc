@@ -0,0 +1,357 @@
+/*
+ * main.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include <namespaces/mcastdatapath.hh>
+#include <types/ipaddress.hh>
+
+using namespace namespaces::mcast;
+using namespace std;
+
+/*!
+ * \brief The cNAP data path before McastDataPath
+ *
+ * One socket per group in a map guarded by a mutex, which is looked up for
+ * every datagram, and one sendto() per datagram.
+ */
+class LegacyDataPath
+{
+public:
+	~LegacyDataPath()
+	{
+		for (auto it = _sockets.begin(); it != _sockets.end(); it++)
+		{
+			close(it->second.first);
+		}
+	}
+	uint32_t flush() { return 0; }
+	bool full() { return false; }
+	bool join(uint32_t group, uint16_t port)
+	{
+		struct sockaddr_in destination;
+		bzero(&destination, sizeof(destination));
+		destination.sin_family = AF_INET;
+		destination.sin_addr.s_addr = group;
+		destination.sin_port = htons(port);
+		_mutex.lock();
+		_sockets[group] = pair<int, struct sockaddr_in>(
+				socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP), destination);
+		_joined[group] = _now();
+		_mutex.unlock();
+		return true;
+	}
+	bool leave(uint32_t group)
+	{
+		_mutex.lock();
+		auto it = _sockets.find(group);
+
+		if (it == _sockets.end())
+		{
+			_mutex.unlock();
+			return false;
+		}
+
+		close(it->second.first);
+		_sockets.erase(it);
+		_joined.erase(group);
+		_mutex.unlock();
+		return true;
+	}
+	bool queue(uint32_t group, uint8_t *data, uint16_t dataSize,
+			uint64_t &acquisitionTime)
+	{
+		pair<int, struct sockaddr_in> socketDestination;
+		// the addresses MCast::_extractFromPacket() obtained
+		IpAddress sourceIpAddress(htonl(0x0a000001));
+		IpAddress multicastIpAddress(group);
+		acquisitionTime = 0;
+		_mutex.lock();
+		auto it = _sockets.find(group);
+
+		if (it == _sockets.end())
+		{
+			_mutex.unlock();
+			return false;
+		}
+
+		socketDestination = it->second;
+		_mutex.unlock();
+		sendto(socketDestination.first, data, dataSize, 0,
+				(struct sockaddr *)&socketDestination.second,
+				sizeof(struct sockaddr_in));
+		// the MCast handler read the join time map without the mutex, which
+		// would crash here
+		_mutex.lock();
+		auto joined = _joined.find(group);
+
+		if (joined != _joined.end() && joined->second > 0)
+		{
+			acquisitionTime = _now() - joined->second;
+			joined->second = 0;
+		}
+
+		_mutex.unlock();
+		return true;
+	}
+private:
+	unordered_map<uint32_t, pair<int, struct sockaddr_in>> _sockets;
+	unordered_map<uint32_t, uint64_t> _joined;
+	std::mutex _mutex;
+	uint64_t _now()
+	{
+		return chrono::duration_cast<chrono::microseconds>(
+				chrono::steady_clock::now().time_since_epoch()).count();
+	}
+};
+
+/*!
+ * \brief The parameters and results of one run
+ */
+struct run_t
+{
+	uint16_t channels;/*!< Channels offered by the sNAP */
+	uint16_t viewers;/*!< Channels joined at any time */
+	uint32_t changes;/*!< Channel changes to replay */
+	uint16_t burst;/*!< Datagrams per ICN event burst */
+	uint16_t port;/*!< UDP port the IP clients listen on */
+	atomic<bool> churning;/*!< The churn thread is still running */
+	vector<uint64_t> acquisitionTimes;/*!< Measured per channel change */
+	uint64_t datagrams;/*!< Datagrams delivered to the data path */
+};
+
+/*!
+ * \brief The group address of a channel
+ *
+ * Loopback addresses are used so that the datagrams reach the receiver
+ * without a multicast route.
+ */
+static uint32_t group(uint16_t channel)
+{
+	return htonl(0x7f010000 | channel);
+}
+
+/*!
+ * \brief Replay IGMP joins and leaves: each channel change leaves one of the
+ * joined channels and joins one which is not
+ */
+template<class DataPath>
+void churn(DataPath *dataPath, run_t *run)
+{
+	vector<uint16_t> channels;
+
+	for (uint16_t i = 0; i < run->channels; i++)
+	{
+		channels.push_back(i);
+	}
+
+	random_shuffle(channels.begin(), channels.end());
+
+	for (uint16_t i = 0; i < run->viewers; i++)
+	{
+		dataPath->join(group(channels[i]), run->port);
+	}
+
+	for (uint32_t i = 0; i < run->changes; i++)
+	{
+		uint16_t left = rand() % run->viewers;
+		uint16_t joined = run->viewers
+				+ rand() % (run->channels - run->viewers);
+		dataPath->leave(group(channels[left]));
+		dataPath->join(group(channels[joined]), run->port);
+		swap(channels[left], channels[joined]);
+		this_thread::sleep_for(chrono::microseconds(200));
+	}
+
+	run->churning = false;
+}
+
+/*!
+ * \brief Deliver the data of all channels the sNAP publishes in bursts, the
+ * way an ICN worker thread hands PUBLISHED_DATA events to the MCast handler
+ */
+template<class DataPath>
+void data(DataPath *dataPath, run_t *run)
+{
+	uint8_t payload[1316];// 7 MPEG-TS packets
+	uint64_t acquisitionTime;
+	uint16_t channel = 0;
+	bzero(payload, sizeof(payload));
+
+	while (run->churning)
+	{
+		for (uint16_t i = 0; i < run->burst; i++)
+		{
+			if (dataPath->queue(group(channel), payload, sizeof(payload),
+					acquisitionTime))
+			{
+				run->datagrams++;
+
+				if (acquisitionTime > 0)
+				{
+					run->acquisitionTimes.push_back(acquisitionTime);
+				}
+
+				if (dataPath->full())
+				{
+					dataPath->flush();
+				}
+			}
+
+			channel = (channel + 1) % run->channels;
+		}
+
+		// no further events queued
+		dataPath->flush();
+	}
+}
+
+/*!
+ * \brief Drain the IP clients' socket
+ */
+void receive(int socketFd, atomic<bool> *running, uint64_t *received)
+{
+	uint8_t buffer[2048];
+
+	while (*running)
+	{
+		if (recv(socketFd, buffer, sizeof(buffer), 0) > 0)
+		{
+			(*received)++;
+		}
+	}
+}
+
+template<class DataPath>
+void measure(const char *name, run_t &run)
+{
+	DataPath dataPath;
+	run.churning = true;
+	run.datagrams = 0;
+	run.acquisitionTimes.clear();
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	thread churnThread(churn<DataPath>, &dataPath, &run);
+	thread dataThread(data<DataPath>, &dataPath, &run);
+	churnThread.join();
+	dataThread.join();
+	double seconds = chrono::duration<double>(chrono::steady_clock::now()
+			- start).count();
+	vector<uint64_t> &times = run.acquisitionTimes;
+	sort(times.begin(), times.end());
+	cout << name << ": " << run.datagrams / seconds / 1e3 << "k datagrams/s, "
+			<< times.size() << " channel acquisitions";
+
+	if (!times.empty())
+	{
+		cout << ", acquisition time p50 " << times[times.size() / 2]
+				<< "us p90 " << times[times.size() * 9 / 10] << "us p99 "
+				<< times[times.size() * 99 / 100] << "us max "
+				<< times.back() << "us";
+	}
+
+	cout << endl;
+}
+
+int main(int argc, char *argv[])
+{
+	run_t run;
+	run.channels = 200;
+	run.viewers = 20;
+	run.changes = 5000;
+	run.burst = 64;
+	struct sockaddr_in address;
+	socklen_t addressLength = sizeof(address);
+	struct timeval timeout = {0, 100000};
+	int bufferSize = 4 * 1024 * 1024;
+	atomic<bool> running(true);
+	uint64_t received = 0;
+
+	if (argc > 1)
+	{
+		run.channels = atoi(argv[1]);
+	}
+
+	if (argc > 2)
+	{
+		run.viewers = atoi(argv[2]);
+	}
+
+	if (argc > 3)
+	{
+		run.changes = atoi(argv[3]);
+	}
+
+	if (argc > 4)
+	{
+		run.burst = atoi(argv[4]);
+	}
+
+	if (run.viewers == 0 || run.viewers >= run.channels || run.burst == 0)
+	{
+		cerr << "VIEWERS must be between 1 and CHANNELS - 1 and BURST larger "
+				"than 0" << endl;
+		return 1;
+	}
+
+	// the IP clients of all channels
+	int socketFd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	bzero(&address, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+
+	if (bind(socketFd, (struct sockaddr *)&address, sizeof(address)) == -1)
+	{
+		cerr << "Receiving socket could not be bound: " << strerror(errno)
+				<< endl;
+		return 1;
+	}
+
+	getsockname(socketFd, (struct sockaddr *)&address, &addressLength);
+	setsockopt(socketFd, SOL_SOCKET, SO_RCVBUF, &bufferSize,
+			sizeof(bufferSize));
+	setsockopt(socketFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	run.port = ntohs(address.sin_port);
+	thread receiveThread(receive, socketFd, &running, &received);
+	cout << run.channels << " channels, " << run.viewers << " joined, "
+			<< run.changes << " channel changes, bursts of " << run.burst
+			<< " datagrams" << endl;
+	srand(1);
+	measure<LegacyDataPath>("legacy", run);
+	srand(1);
+	measure<McastDataPath>("mcastdatapath", run);
+	running = false;
+	receiveThread.join();
+	close(socketFd);
+	cout << received << " datagrams received by the IP clients" << endl;
+	return 0;
+}
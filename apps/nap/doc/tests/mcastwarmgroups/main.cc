@@ -0,0 +1,195 @@
+/*
+ * main.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <math.h>
+#include <random>
+#include <stdlib.h>
+#include <vector>
+
+#include <namespaces/mcastwarmgroups.hh>
+
+using namespace namespaces::mcast;
+using namespace std;
+
+/*!
+ * \brief The parameters of the replayed IGMP history
+ */
+struct history_t
+{
+	uint16_t channels;/*!< Channels offered by the sNAP */
+	uint16_t viewers;/*!< IP clients behind the cNAP */
+	uint32_t zaps;/*!< Channel changes */
+	double controlRtt;/*!< IGMP/ICN control round trip to the sNAP (ms) */
+	double datagramInterval;/*!< Time between two datagrams of a channel
+	(ms) */
+};
+
+/*!
+ * \brief Replay the channel changes of all viewers against the warm groups of
+ * a cNAP and print the channel acquisition time distribution
+ *
+ * A viewer changing channel leaves its group and joins the new one. Only the
+ * first join of a group without IP clients is a channel acquisition. It takes
+ * until the next datagram of the channel if the group is warm, or the control
+ * round trip to the sNAP first otherwise. When the last viewer of a group
+ * leaves, the group is kept warm or left at the sNAP.
+ */
+void replay(const char *name, history_t &history, uint16_t warmGroups,
+		igmp_warm_groups_policy_t policy)
+{
+	McastWarmGroups mcastWarmGroups;
+	mt19937 generator(1);
+	vector<double> popularity;
+	double sum = 0;
+	vector<uint16_t> watching(history.viewers);
+	vector<uint16_t> viewers(history.channels, 0);
+	vector<double> acquisitionTimes;
+	uint32_t warmJoins = 0;
+	uint64_t streams = 0;
+	uint32_t evicted;
+	mcastWarmGroups.configure(warmGroups, policy);
+
+	// Zipf distributed channel popularity
+	for (uint16_t i = 1; i <= history.channels; i++)
+	{
+		sum += 1.0 / i;
+		popularity.push_back(sum);
+	}
+
+	uniform_real_distribution<double> channelDistribution(0, sum);
+	uniform_real_distribution<double> datagramDistribution(0,
+			history.datagramInterval);
+
+	for (uint16_t i = 0; i < history.viewers; i++)
+	{
+		watching[i] = lower_bound(popularity.begin(), popularity.end(),
+				channelDistribution(generator)) - popularity.begin();
+		viewers[watching[i]]++;
+	}
+
+	for (uint32_t i = 0; i < history.zaps; i++)
+	{
+		uint16_t viewer = generator() % history.viewers;
+		uint16_t channel = lower_bound(popularity.begin(), popularity.end(),
+				channelDistribution(generator)) - popularity.begin();
+
+		if (channel == watching[viewer])
+		{
+			continue;
+		}
+
+		// join
+		if (viewers[channel]++ == 0)
+		{
+			if (mcastWarmGroups.join(channel + 1))
+			{
+				acquisitionTimes.push_back(datagramDistribution(generator));
+				warmJoins++;
+			}
+			else
+			{
+				acquisitionTimes.push_back(history.controlRtt
+						+ datagramDistribution(generator));
+			}
+		}
+
+		// leave
+		if (--viewers[watching[viewer]] == 0)
+		{
+			mcastWarmGroups.keep(watching[viewer] + 1, evicted);
+		}
+
+		watching[viewer] = channel;
+
+		// streams the sNAP publishes towards the cNAP
+		for (uint16_t j = 0; j < history.channels; j++)
+		{
+			streams += (viewers[j] > 0);
+		}
+
+		streams += mcastWarmGroups.size();
+	}
+
+	sort(acquisitionTimes.begin(), acquisitionTimes.end());
+	size_t n = acquisitionTimes.size();
+	sum = 0;
+
+	for (size_t i = 0; i < n; i++)
+	{
+		sum += acquisitionTimes[i];
+	}
+
+	cout << name << ": " << n << " acquisitions, " << 100.0 * warmJoins / n
+			<< "% warm, mean " << sum / n << "ms p50 " << acquisitionTimes[n / 2] << "ms p90 "
+			<< acquisitionTimes[n * 9 / 10] << "ms p99 "
+			<< acquisitionTimes[n * 99 / 100] << "ms max "
+			<< acquisitionTimes.back() << "ms, "
+			<< (double)streams / history.zaps << " streams received on average"
+			<< endl;
+}
+
+int main(int argc, char *argv[])
+{
+	history_t history;
+	uint16_t warmGroups = 20;
+	history.channels = 200;
+	history.viewers = 50;
+	history.zaps = 100000;
+	history.controlRtt = 20;
+	history.datagramInterval = 1.3;// 8Mbit/s in datagrams of 1316 bytes
+
+	if (argc > 1)
+	{
+		warmGroups = atoi(argv[1]);
+	}
+
+	if (argc > 2)
+	{
+		history.channels = atoi(argv[2]);
+	}
+
+	if (argc > 3)
+	{
+		history.viewers = atoi(argv[3]);
+	}
+
+	if (argc > 4)
+	{
+		history.controlRtt = atof(argv[4]);
+	}
+
+	if (history.channels < 2 || history.viewers == 0)
+	{
+		cerr << "At least 2 CHANNELS and 1 VIEWER are required" << endl;
+		return 1;
+	}
+
+	cout << history.channels << " channels, " << history.viewers
+			<< " viewers, " << history.zaps << " channel changes, control "
+			"RTT " << history.controlRtt << "ms, " << warmGroups
+			<< " warm groups" << endl;
+	replay("disabled", history, 0, IGMP_WARM_GROUPS_RECENT);
+	replay("recent", history, warmGroups, IGMP_WARM_GROUPS_RECENT);
+	replay("popular", history, warmGroups, IGMP_WARM_GROUPS_POPULAR);
+	return 0;
+}
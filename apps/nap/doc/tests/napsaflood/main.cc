@@ -0,0 +1,211 @@
+/*
+ * main.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <errno.h>
+#include <iostream>
+#include <linux/netlink.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+#include <api/napsasocket.hh>
+
+using namespace api::napsa;
+using namespace std;
+
+#define RECEIVER_PID 0x4e415341 // not PID_NAP_SA_LISTENER, a NAP may be running
+#define SENDER_PID 0x4e415342
+#define SEND_BATCH_SIZE 64
+
+/*!
+ * \brief The NAP-SA listener before NapSaSocket
+ *
+ * One recvmsg() per message into a single buffer.
+ */
+class LegacySocket
+{
+public:
+	LegacySocket(uint32_t pid)
+	{
+		struct sockaddr_nl sourceAddress;
+		_socket = socket(AF_NETLINK, SOCK_RAW, NETLINK_GENERIC);
+		memset(&sourceAddress, 0, sizeof(sourceAddress));
+		sourceAddress.nl_family = AF_NETLINK;
+		sourceAddress.nl_pid = pid;
+		_bound = bind(_socket, (struct sockaddr*) &sourceAddress,
+				sizeof(sourceAddress)) == 0;
+		_iov.iov_base = _buffer;
+		_iov.iov_len = NLMSG_SPACE(10);
+		memset(&_msg, 0, sizeof(_msg));
+		_msg.msg_name = &_address;
+		_msg.msg_namelen = sizeof(_address);
+		_msg.msg_iov = &_iov;
+		_msg.msg_iovlen = 1;
+	}
+	~LegacySocket() { close(_socket); }
+	bool bound() { return _bound; }
+	uint16_t receive(nap_sa_command_t *commands)
+	{
+		struct nlmsghdr *nlh = (struct nlmsghdr *)_buffer;
+
+		if (recvmsg(_socket, &_msg, 0) <= 0)
+		{
+			return 0;
+		}
+
+		commands[0].command = (nap_sa_commands_t)nlh->nlmsg_type;
+		memcpy(&commands[0].hashedFqdn, NLMSG_DATA(nlh), 4);
+		memcpy(&commands[0].ipAddress, (uint8_t *)NLMSG_DATA(nlh) + 4, 4);
+		memcpy(&commands[0].port, (uint8_t *)NLMSG_DATA(nlh) + 8, 2);
+		return 1;
+	}
+private:
+	int _socket;
+	bool _bound;
+	uint8_t _buffer[NLMSG_SPACE(10)];
+	struct iovec _iov;
+	struct msghdr _msg;
+	struct sockaddr_nl _address;
+};
+
+/*!
+ * \brief Flood the receiver with surrogacy commands the way the SA sends them
+ *
+ * Sending blocks whenever the receive buffer of the listener is full, so no
+ * message is lost.
+ */
+void flood(uint32_t messages)
+{
+	uint8_t buffers[SEND_BATCH_SIZE][NLMSG_SPACE(10)];
+	struct iovec iovecs[SEND_BATCH_SIZE];
+	struct mmsghdr headers[SEND_BATCH_SIZE];
+	struct sockaddr_nl sourceAddress, destinationAddress;
+	int sock = socket(AF_NETLINK, SOCK_RAW, NETLINK_GENERIC);
+	memset(&sourceAddress, 0, sizeof(sourceAddress));
+	sourceAddress.nl_family = AF_NETLINK;
+	sourceAddress.nl_pid = SENDER_PID;
+	bind(sock, (struct sockaddr*) &sourceAddress, sizeof(sourceAddress));
+	memset(&destinationAddress, 0, sizeof(destinationAddress));
+	destinationAddress.nl_family = AF_NETLINK;
+	destinationAddress.nl_pid = RECEIVER_PID;
+	memset(headers, 0, sizeof(headers));
+
+	for (uint16_t i = 0; i < SEND_BATCH_SIZE; i++)
+	{
+		struct nlmsghdr *nlh = (struct nlmsghdr *)buffers[i];
+		uint32_t ipAddress = htonl(0x0a000001 + i);
+		uint16_t port = 80;
+		memset(nlh, 0, NLMSG_SPACE(10));
+		nlh->nlmsg_len = NLMSG_SPACE(10);
+		nlh->nlmsg_pid = SENDER_PID;
+		nlh->nlmsg_type = (i % 2 == 0) ? NAP_SA_ACTIVATE : NAP_SA_DEACTIVATE;
+		memcpy(NLMSG_DATA(nlh), &i, sizeof(i));
+		memcpy((uint8_t *)NLMSG_DATA(nlh) + 4, &ipAddress, 4);
+		memcpy((uint8_t *)NLMSG_DATA(nlh) + 8, &port, 2);
+		iovecs[i].iov_base = nlh;
+		iovecs[i].iov_len = nlh->nlmsg_len;
+		headers[i].msg_hdr.msg_name = &destinationAddress;
+		headers[i].msg_hdr.msg_namelen = sizeof(destinationAddress);
+		headers[i].msg_hdr.msg_iov = &iovecs[i];
+		headers[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	while (messages > 0)
+	{
+		uint32_t batch = messages < SEND_BATCH_SIZE ? messages
+				: SEND_BATCH_SIZE;
+		int sent = sendmmsg(sock, headers, batch, 0);
+
+		if (sent <= 0)
+		{
+			cerr << "Flooding failed: " << strerror(errno) << endl;
+			break;
+		}
+
+		messages -= sent;
+	}
+
+	close(sock);
+}
+
+/*!
+ * \brief Receive the given number of messages and report the rate
+ */
+template<class Socket>
+void measure(string name, uint32_t messages)
+{
+	nap_sa_command_t commands[NAP_SA_BATCH_SIZE];
+	uint32_t received = 0;
+	uint32_t activations = 0;
+	uint32_t calls = 0;
+	Socket sock(RECEIVER_PID);
+
+	if (!sock.bound())
+	{
+		cerr << name << ": receiver could not be bound" << endl;
+		return;
+	}
+
+	auto start = chrono::steady_clock::now();
+	thread sender(flood, messages);
+
+	while (received < messages)
+	{
+		uint16_t numberOfCommands = sock.receive(commands);
+
+		for (uint16_t i = 0; i < numberOfCommands; i++)
+		{
+			if (commands[i].command == NAP_SA_ACTIVATE)
+			{
+				activations++;
+			}
+		}
+
+		received += numberOfCommands;
+		calls++;
+	}
+
+	auto end = chrono::steady_clock::now();
+	sender.join();
+	double seconds = chrono::duration<double>(end - start).count();
+	cout << name << ":\t" << received << " messages in " << seconds << "s = "
+			<< (uint64_t)(received / seconds) << " messages/s, "
+			<< (double)received / calls << " messages per receive call ("
+			<< activations << " activations)" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t messages = 1000000;
+
+	if (argc > 1)
+	{
+		messages = atoi(argv[1]);
+	}
+
+	measure<LegacySocket>("legacy", messages);
+	measure<NapSaSocket>("napsasocket", messages);
+	return EXIT_SUCCESS;
+}
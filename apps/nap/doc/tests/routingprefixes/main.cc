@@ -0,0 +1,220 @@
+/*
+ * main.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+#include <types/routingprefixtable.hh>
+
+#define VERIFY_LOOKUPS 100000 // compared against a brute force search
+
+using namespace std;
+
+map<uint32_t, RoutingPrefix> routingPrefixes;
+std::mutex mutexRoutingPrefixes;
+atomic<uint64_t> found(0);
+
+/*!
+ * \brief The routing prefix lookup of the IP handler before the LPM table
+ */
+RoutingPrefix *mapLookup(uint32_t ipAddress)
+{
+	map<uint32_t, RoutingPrefix>::reverse_iterator it;
+	mutexRoutingPrefixes.lock();
+
+	for (it = routingPrefixes.rbegin(); it != routingPrefixes.rend(); it++)
+	{
+		if ((ipAddress & it->second.netmask().uint()) == it->second.uint())
+		{
+			mutexRoutingPrefixes.unlock();
+			return &it->second;
+		}
+	}
+
+	mutexRoutingPrefixes.unlock();
+	return NULL;
+}
+
+/*!
+ * \brief The true longest prefix match
+ */
+RoutingPrefix *bruteForceLookup(uint32_t ipAddress)
+{
+	map<uint32_t, RoutingPrefix>::iterator it;
+	RoutingPrefix *longest = NULL;
+
+	for (it = routingPrefixes.begin(); it != routingPrefixes.end(); it++)
+	{
+		if ((ipAddress & it->second.netmask().uint()) == it->second.uint()
+				&& (longest == NULL || it->second.netmask().cidr()
+						> longest->netmask().cidr()))
+		{
+			longest = &it->second;
+		}
+	}
+
+	return longest;
+}
+
+/*!
+ * \brief Whether two lookups found the same routing prefix
+ */
+bool same(RoutingPrefix *a, RoutingPrefix *b)
+{
+	if (a == NULL || b == NULL)
+	{
+		return a == b;
+	}
+
+	return a->uint() == b->uint() && a->netmask().cidr() == b->netmask().cidr();
+}
+
+/*!
+ * \brief Random IP addresses in network byte order, half of them covered by a
+ * configured routing prefix
+ */
+vector<uint32_t> ipAddresses(size_t number, unsigned int seed)
+{
+	mt19937 random(seed);
+	vector<uint32_t> addresses;
+	vector<RoutingPrefix *> prefixes;
+	map<uint32_t, RoutingPrefix>::iterator it;
+
+	for (it = routingPrefixes.begin(); it != routingPrefixes.end(); it++)
+	{
+		prefixes.push_back(&it->second);
+	}
+
+	for (size_t i = 0; i < number; i++)
+	{
+		uint32_t address = random();
+
+		if (i % 2 == 0)
+		{
+			RoutingPrefix *prefix = prefixes[random() % prefixes.size()];
+			address = prefix->uint() | (address & ~prefix->netmask().uint());
+		}
+
+		addresses.push_back(address);
+	}
+
+	return addresses;
+}
+
+/*!
+ * \brief Look up all addresses from several threads and report the rate
+ */
+template<typename lookup_t>
+void run(const char *name, lookup_t lookup, uint32_t threads,
+		uint64_t lookups)
+{
+	vector<thread> workers;
+	vector<uint32_t> verify = ipAddresses(VERIFY_LOOKUPS, threads);
+	uint64_t mismatches = 0;
+	found = 0;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	for (uint32_t i = 0; i < threads; i++)
+	{
+		workers.push_back(thread([i, lookup, lookups]()
+		{
+			vector<uint32_t> addresses = ipAddresses(1 << 16, i);
+			uint64_t hits = 0;
+
+			for (uint64_t j = 0; j < lookups; j++)
+			{
+				if (lookup(addresses[j & 0xffff]) != NULL)
+				{
+					hits++;
+				}
+			}
+
+			found += hits;
+		}));
+	}
+
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+
+	double seconds = chrono::duration<double>(chrono::steady_clock::now()
+			- start).count();
+
+	for (size_t i = 0; i < verify.size(); i++)
+	{
+		if (!same(lookup(verify[i]), bruteForceLookup(verify[i])))
+		{
+			mismatches++;
+		}
+	}
+
+	cout << name << ":\t" << (uint64_t)(threads * lookups / seconds)
+			<< " lookups/s, " << found << " found, " << mismatches << "/"
+			<< verify.size() << " not the longest match" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t prefixes = (argc > 1) ? atoi(argv[1]) : 500;
+	uint32_t threads = (argc > 2) ? atoi(argv[2]) : 4;
+	uint64_t lookups = (argc > 3) ? atoll(argv[3]) : 1000000;
+	mt19937 random(0);
+
+	while (routingPrefixes.size() < prefixes)
+	{
+		uint32_t length = 8 + random() % 23;
+		uint32_t address = random();
+		struct in_addr in;
+
+		// most prefixes nest in 172.16.0.0/12 so that many of them overlap
+		if (length >= 12 && random() % 4 != 0)
+		{
+			address = 0xac100000 | (address & 0x000fffff);
+		}
+
+		in.s_addr = htonl(address & (0xffffffff << (32 - length)));
+		string networkAddress = inet_ntoa(in);
+		in.s_addr = htonl(0xffffffff << (32 - length));
+		string netmask = inet_ntoa(in);
+		RoutingPrefix prefix(networkAddress, netmask);
+		// the NAP keys prefixes by network address, as nap.cfg does
+		routingPrefixes.insert(pair<uint32_t, RoutingPrefix>(prefix.uint(),
+				prefix));
+	}
+
+	RoutingPrefixTable table(routingPrefixes);
+	cout << "Routing prefixes: " << table.size() << ", threads: " << threads
+			<< ", lookups per thread: " << lookups << endl;
+	run("map", mapLookup, threads, lookups);
+	run("table", [&table](uint32_t ipAddress)
+	{
+		return table.lookup(ipAddress);
+	}, threads, lookups);
+	return 0;
+}
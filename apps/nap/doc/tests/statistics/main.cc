@@ -0,0 +1,117 @@
+/*
+ * main.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+#include <monitoring/statistics.hh>
+
+using namespace monitoring::statistics;
+using namespace std;
+
+/*!
+ * \brief Update the statistics the way the NAP does for every IP packet
+ */
+void packets(Statistics *statistics, uint16_t thread, uint32_t packets,
+		uint16_t endpoints)
+{
+	uint16_t packetSize = 1400;
+	int bytesWritten = 1400;
+	vector<IpAddress> ipAddresses;
+
+	// the demux has the IpAddress at hand anyway
+	for (uint16_t i = 0; i < endpoints; i++)
+	{
+		ipAddresses.push_back(IpAddress(htonl(0xac100000 | (thread << 8)
+				| i)));
+	}
+
+	for (uint32_t i = 0; i < packets; i++)
+	{
+		// demux: source of every captured packet
+		statistics->ipEndpointAdd(ipAddresses[i % endpoints]);
+		// IP handler: packet published
+		statistics->rxIpBytes(&packetSize);
+		// IP socket: packet delivered to the endpoint
+		statistics->txIpBytes(&bytesWritten);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	uint16_t threads = (argc > 1) ? atoi(argv[1]) : 4;
+	uint32_t packetsPerThread = (argc > 2) ? atoi(argv[2]) : 10000000;
+	uint16_t endpoints = (argc > 3) ? atoi(argv[3]) : 16;
+	Statistics statistics;
+	vector<thread> packetThreads;
+	atomic<bool> running(true);
+	uint64_t rxIpBytes = 0;
+	uint64_t txIpBytes = 0;
+	cout << "Threads: " << threads << ", packets per thread: "
+			<< packetsPerThread << ", IP endpoints per thread: " << endpoints
+			<< endl;
+	// the collector obtains (and resets) the counters every 10ms
+	thread collector([&]()
+	{
+		while (running)
+		{
+			this_thread::sleep_for(chrono::milliseconds(10));
+			rxIpBytes += statistics.rxIpBytes();
+			txIpBytes += statistics.txIpBytes();
+		}
+	});
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	for (uint16_t i = 0; i < threads; i++)
+	{
+		packetThreads.push_back(thread(packets, &statistics, i,
+				packetsPerThread, endpoints));
+	}
+
+	for (uint16_t i = 0; i < threads; i++)
+	{
+		packetThreads[i].join();
+	}
+
+	double nanoseconds = chrono::duration<double, nano>(
+			chrono::steady_clock::now() - start).count();
+	running = false;
+	collector.join();
+	rxIpBytes += statistics.rxIpBytes();
+	txIpBytes += statistics.txIpBytes();
+	uint64_t expected = (uint64_t)threads * packetsPerThread * 1400;
+	cout << "Updates:\t" << nanoseconds / packetsPerThread << " ns per packet "
+			"and thread" << endl;
+	cout << "Packets/s:\t" << (uint64_t)threads * packetsPerThread /
+			(nanoseconds / 1e9) << endl;
+	// the counters are 32-bit per reporting interval
+	cout << "RX IP bytes:\t" << rxIpBytes << " (expected " << expected << ")"
+			<< endl;
+	cout << "TX IP bytes:\t" << txIpBytes << " (expected " << expected << ")"
+			<< endl;
+	cout << "IP endpoints:\t" << statistics.ipEndpoints().size()
+			<< " (expected " << threads * endpoints << ")" << endl;
+	return (rxIpBytes == expected && txIpBytes == expected) ? 0 : 1;
+}
@@ -22,14 +22,14 @@
  * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <functional>
+
 #include <icncore/icn.hh>
-#include <proxies/http/tcpclient.hh>
 
 using namespace icn;
 using namespace log4cxx;
 using namespace namespaces::ip;
 using namespace namespaces::http;
-using namespace proxies::http::tcpclient;
 using namespace std;
 using namespace transport::lightweight;
 using namespace transport::unreliable;
@@ -38,12 +38,13 @@ LoggerPtr Icn::logger(Logger::getLogger("icn"));
 
 Icn::Icn(Blackadder *icnCore, Configuration &configuration,
 		Namespaces &namespaces, Transport &transport, Statistics &statistics,
-		bool *run)
+		Reactor &reactor, bool *run)
 	: _icnCore(icnCore),
 	  _configuration(configuration),
 	  _namespaces(namespaces),
 	  _transport(transport),
 	  _statistics(statistics),
+	  _reactor(reactor),
 	  _run(run)
 {}
 
@@ -51,240 +52,365 @@ Icn::~Icn(){}
 
 void Icn::operator ()()
 {
-	IcnId icnId;
-	IcnId rCId;
-	string icnIdStr;
-	string rCIdStr;
-	tp_states_t tpState;
-	enigma_t enigma = 23;
-	uint16_t dataLength = 0;
-	uint8_t *retrievedPacket = (uint8_t *)malloc(65535);
-	uint16_t retrievedPacketSize = 0;
 	std::mutex tcpClientMutex;
-	std::thread *tcpClientThread;
 	reverse_lookup_t tcpClientReverseLookup;
 	socket_fds_t tcpClientSocketFds;
 	socket_state_t tcpClientSocketState;
-	TcpClient tcpClient(_configuration, _namespaces, _statistics,
-			&tcpClientReverseLookup, &tcpClientSocketFds, &tcpClientSocketState,
-			tcpClientMutex, _run);
-	LOG4CXX_DEBUG(logger, "ICN listener thread started");
+	TcpClientPool tcpClientPool(_configuration, _namespaces, _statistics,
+			_reactor);
+	TcpClient tcpClient(_configuration, _namespaces, _statistics, _reactor,
+			tcpClientPool, &tcpClientReverseLookup, &tcpClientSocketFds,
+			&tcpClientSocketState, tcpClientMutex, _run);
+	list<std::thread> workerThreads;
+	uint32_t dispatchedEvents = 0;
+
+	for (uint16_t i = 0; i < _configuration.icnWorkers(); i++)
+	{
+		_queues.push_back(new IcnEventQueue());
+	}
+
+	for (uint16_t i = 0; i < _configuration.icnWorkers(); i++)
+	{
+		workerThreads.push_back(std::thread(std::ref(*this), i, &tcpClient));
+	}
+
+	LOG4CXX_DEBUG(logger, "ICN listener thread started with "
+			<< _queues.size() << " worker threads");
 
 	while (*_run)
 	{
-		Event event;
-		_icnCore->getEvent(event);
-		icnIdStr = chararray_to_hex(event.id);
-		icnId = icnIdStr;
+		Event *event = new Event;
+		_icnCore->getEvent(*event);
+		_dispatch(event);
+		dispatchedEvents++;
 
-		switch (event.type)
+		if (dispatchedEvents % ICN_EVENT_QUEUE_SAMPLE_INTERVAL == 0)
 		{
-		/*
-		 * Scope published
-		 */
-		case SCOPE_PUBLISHED:
-			LOG4CXX_DEBUG(logger, "SCOPE_PUBLISHED received for ICN ID "<< icnId.print());
-			_namespaces.subscribeScope(icnId);
-			break;
-		/*
-		 * Scope unpublished
-		 */
-		case SCOPE_UNPUBLISHED:
-			LOG4CXX_DEBUG(logger, "SCOPE_UNPUBLISHED received for ICN ID "<< icnId.print());
-			break;
-		/*
-		 * Start publish
-		 */
-		case START_PUBLISH:
+			for (size_t i = 0; i < _queues.size(); i++)
+			{
+				_statistics.icnEventQueue(i, _queues[i]->size());
+			}
+		}
+	}
+
+	for (list<std::thread>::iterator it = workerThreads.begin();
+			it != workerThreads.end(); it++)
+	{
+		it->join();
+	}
+
+	for (size_t i = 0; i < _queues.size(); i++)
+	{
+		delete _queues[i];
+	}
+
+	_queues.clear();
+	LOG4CXX_INFO(logger, "ICN handler thread stopped");
+}
+
+void Icn::operator ()(uint16_t worker, TcpClient *tcpClient)
+{
+	uint8_t *retrievedPacket = (uint8_t *)malloc(65535);
+	Event *event;
+	LOG4CXX_DEBUG(logger, "ICN worker thread " << worker << " started");
+
+	while (*_run)
+	{
+		event = _queues[worker]->pop(1000);
+
+		if (event == NULL)
 		{
-			LOG4CXX_DEBUG(logger, "START_PUBLISH received for CID " << icnId.print());
-			_namespaces.forwarding(icnId, true);
-			//YT: this should be part of mcast::forwarding
-		    if (icnId.rootNamespace() == NAMESPACE_IGMP_CTRL || icnId.rootNamespace() == NAMESPACE_IGMP_DATA) {
-		        _namespaces.handleSTART_PUBLISH(icnId);
-		        break;
-		    }
-
-			_namespaces.publishFromBuffer(icnId);
-			break;
+			continue;
 		}
-		/*
-		 * Start publish iSub
-		 */
-		case START_PUBLISH_iSUB:
+
+		_handle(*event, retrievedPacket, *tcpClient);
+		delete event;
+
+		// a burst of IPTV datagrams and IP packets leaves in one go once it
+		// has been handled
+		if (_queues[worker]->size() == 0)
 		{
-			NodeId nodeId = event.id;
-			LOG4CXX_DEBUG(logger, "START_PUBLISH_iSUB received for NID "
-					<< nodeId.uint());
-
-		        if (rCId.rootNamespace() == NAMESPACE_IGMP_CTRL || rCId.rootNamespace() == NAMESPACE_IGMP_DATA) {
-		            _namespaces.handleSTART_PUBLISH_iSUB(rCId);
-		            break;
-		        }
-
-			_namespaces.forwarding(nodeId, true);
-			//_namespaces.publishFromBuffer(nodeId);//should be always empty
-			break;
+			_namespaces.flushMCastData();
+			_transport.flush();
 		}
-		/*
-		 * Stop publish
-		 */
-		case STOP_PUBLISH:
+	}
+
+	LOG4CXX_DEBUG(logger, "ICN worker thread " << worker << " stopped");
+	free(retrievedPacket);//clean up memory
+}
+
+void Icn::_dispatch(Event *event)
+{
+	size_t worker;
+	bool logged = false;
+
+	switch (event->type)
+	{
+	case PUBLISHED_DATA_iSUB:
+		_isubId = event->isubID;
+		worker = std::hash<string>()(event->isubID) % _queues.size();
+		break;
+	case START_PUBLISH_iSUB:
+		// The ID is a NID. Blackadder does not say which rCID it belongs to;
+		// the handler has always assumed the one of the last iSub publication
+		event->isubID = _isubId;
+		worker = std::hash<string>()(event->isubID) % _queues.size();
+		break;
+	default:
+		worker = std::hash<string>()(event->id) % _queues.size();
+	}
+
+	while (!_queues[worker]->push(event))
+	{
+		if (!*_run)
 		{
-			LOG4CXX_DEBUG(logger, "STOP_PUBLISH received for CID "
-					<< icnId.print());
-			_namespaces.forwarding(icnId, false);
-			break;
+			delete event;
+			return;
 		}
-		//FIXME No STOP_PUBLISH_iSUB???
-		/*
-		 * Pause publish
-		 */
-		case PAUSE_PUBLISH:
-			_namespaces.forwarding(icnId, false);
-			break;
-		/*
-		 * Published data
-		 */
-		case PUBLISHED_DATA:
+
+		if (!logged)
 		{
-			dataLength = event.data_len;
-			uint32_t enigma = 0;
-			uint16_t sessionKey = 0;
-			LOG4CXX_TRACE(logger, "PUBLISHED_DATA of length " << event.data_len
-					<< " received under (r)CID " << icnId.print());
-
-			if (icnId.rootNamespace() == NAMESPACE_IGMP_DATA ||
-					icnId.rootNamespace() == NAMESPACE_IGMP_CTRL)
-			{
-		        _namespaces.handlePUBLISHED_DATA(icnId, &event);
-		        break;
-		    }
+			LOG4CXX_WARN(logger, "Queue of ICN worker thread " << worker
+					<< " is full. Holding back ICN events");
+			logged = true;
+		}
 
-			tp_states_t tpState = _transport.handle(icnId, event.data,
-					dataLength, enigma, sessionKey);
+		std::this_thread::yield();
+	}
+}
 
-			if (tpState == TP_STATE_ALL_FRAGMENTS_RECEIVED)
-			{
-				bzero(retrievedPacket, 65535);
-				string nodeId = _configuration.nodeId().str();
+void Icn::_handle(Event &event, uint8_t *retrievedPacket,
+		TcpClient &tcpClient)
+{
+	IcnId icnId;
+	IcnId rCId;
+	tp_states_t tpState;
+	enigma_t enigma = 23;
+	uint16_t dataLength = 0;
+	uint16_t retrievedPacketSize = 0;
+	uint8_t *tcpClientPacket;
+	icnId.binIcnId(event.id);
 
-				// If packet could be retrieve, send it
-				if (_transport.retrieveIcnPacket(icnId, enigma, nodeId,
-						sessionKey, retrievedPacket, retrievedPacketSize))
-				{
-					_namespaces.sendToEndpoint(icnId, enigma,
-							retrievedPacket, retrievedPacketSize);
-				}
-				else
-				{
-					LOG4CXX_WARN(logger, "Packet could not be retrieved from "
-							"ICN buffer");
-				}
-			}
-			else if (tpState == TP_STATE_SESSION_ENDED)
+	if (event.type == START_PUBLISH_iSUB && !event.isubID.empty())
+	{
+		rCId.binIcnId(event.isubID);
+	}
+
+	switch (event.type)
+	{
+	/*
+	 * Scope published
+	 */
+	case SCOPE_PUBLISHED:
+		LOG4CXX_DEBUG(logger, "SCOPE_PUBLISHED received for ICN ID "<< icnId.print());
+		_namespaces.subscribeScope(icnId);
+		break;
+	/*
+	 * Scope unpublished
+	 */
+	case SCOPE_UNPUBLISHED:
+		LOG4CXX_DEBUG(logger, "SCOPE_UNPUBLISHED received for ICN ID "<< icnId.print());
+		break;
+	/*
+	 * Start publish
+	 */
+	case START_PUBLISH:
+	{
+		LOG4CXX_DEBUG(logger, "START_PUBLISH received for CID " << icnId.print());
+		_namespaces.forwarding(icnId, true);
+		//YT: this should be part of mcast::forwarding
+	    if (icnId.rootNamespace() == NAMESPACE_IGMP_CTRL || icnId.rootNamespace() == NAMESPACE_IGMP_DATA) {
+	        _namespaces.handleSTART_PUBLISH(icnId);
+	        break;
+	    }
+
+		_namespaces.publishFromBuffer(icnId);
+		break;
+	}
+	/*
+	 * Start publish iSub
+	 */
+	case START_PUBLISH_iSUB:
+	{
+		NodeId nodeId = event.id;
+		LOG4CXX_DEBUG(logger, "START_PUBLISH_iSUB received for NID "
+				<< nodeId.uint());
+
+	        if (rCId.rootNamespace() == NAMESPACE_IGMP_CTRL || rCId.rootNamespace() == NAMESPACE_IGMP_DATA) {
+	            _namespaces.handleSTART_PUBLISH_iSUB(rCId);
+	            break;
+	        }
+
+		_namespaces.forwarding(nodeId, true);
+		//_namespaces.publishFromBuffer(nodeId);//should be always empty
+		break;
+	}
+	/*
+	 * Stop publish
+	 */
+	case STOP_PUBLISH:
+	{
+		LOG4CXX_DEBUG(logger, "STOP_PUBLISH received for CID "
+				<< icnId.print());
+		_namespaces.forwarding(icnId, false);
+		break;
+	}
+	//FIXME No STOP_PUBLISH_iSUB???
+	/*
+	 * Pause publish
+	 */
+	case PAUSE_PUBLISH:
+		_namespaces.forwarding(icnId, false);
+		break;
+	/*
+	 * Published data
+	 */
+	case PUBLISHED_DATA:
+	{
+		dataLength = event.data_len;
+		uint32_t enigma = 0;
+		uint16_t sessionKey = 0;
+		LOG4CXX_TRACE(logger, "PUBLISHED_DATA of length " << event.data_len
+				<< " received under (r)CID " << icnId.print());
+
+		if (icnId.rootNamespace() == NAMESPACE_IGMP_DATA ||
+				icnId.rootNamespace() == NAMESPACE_IGMP_CTRL)
+		{
+	        _namespaces.handlePUBLISHED_DATA(icnId, &event);
+	        break;
+	    }
+
+		tp_states_t tpState = _transport.handle(icnId, event.data,
+				dataLength, enigma, sessionKey);
+
+		if (tpState == TP_STATE_ALL_FRAGMENTS_RECEIVED)
+		{
+			bzero(retrievedPacket, 65535);
+			string nodeId = _configuration.nodeId().str();
+
+			// If packet could be retrieve, send it
+			if (_transport.retrieveIcnPacket(icnId, enigma, nodeId,
+					sessionKey, retrievedPacket, retrievedPacketSize))
 			{
-				_namespaces.endOfSession(icnId, enigma, sessionKey);
+				_namespaces.sendToEndpoint(icnId, enigma,
+						retrievedPacket, retrievedPacketSize);
 			}
-			else if (tpState == TP_STATE_NO_TRANSPORT_PROTOCOL_USED)
+			else
 			{
-				_namespaces.handlePublishedData(icnId, event.data,
-						event.data_len);
+				LOG4CXX_WARN(logger, "Packet could not be retrieved from "
+						"ICN buffer");
 			}
-			break;
 		}
-		/*
-		 * Published data iSub for HTTP-over-ICN namespace (requests)
-		 */
-		case PUBLISHED_DATA_iSUB:
+		else if (tpState == TP_STATE_SESSION_ENDED)
 		{
-			rCIdStr = chararray_to_hex(event.isubID);
-			rCId = rCIdStr;
-			dataLength = event.data_len;
-			uint16_t sessionKey;
-			LOG4CXX_TRACE(logger, "PUBLISHED_DATA_iSUB received for CID "
-						<< icnId.print() << " and rCID " << rCId.print()
-						<< " of length " << event.data_len);
-
-	                if (rCId.rootNamespace() == NAMESPACE_IGMP_DATA || rCId.rootNamespace() == NAMESPACE_IGMP_CTRL) {
-	                    _namespaces.handlePUBLISHED_DATA_iSUB(rCId, &event);
-	                    break;
-	                }
-
-			// add NID > rCID look up to HTTP handler so when START_PUBLISH_iSUB
-			// arrives the corresponding rCID can be looked up
-			_namespaces.Http::addReversNidTorCIdLookUp(event.nodeId, rCId);
-			// handle received publication
-			tpState = _transport.handle(icnId, rCId, event.nodeId,
-					event.data,	dataLength, enigma, sessionKey);
-
-			if (tpState	== TP_STATE_ALL_FRAGMENTS_RECEIVED)
+			_namespaces.endOfSession(icnId, enigma, sessionKey);
+		}
+		else if (tpState == TP_STATE_NO_TRANSPORT_PROTOCOL_USED)
+		{
+			_namespaces.handlePublishedData(icnId, event.data,
+					event.data_len);
+		}
+		break;
+	}
+	/*
+	 * Published data iSub for HTTP-over-ICN namespace (requests)
+	 */
+	case PUBLISHED_DATA_iSUB:
+	{
+		rCId.binIcnId(event.isubID);
+		dataLength = event.data_len;
+		uint16_t sessionKey;
+		LOG4CXX_TRACE(logger, "PUBLISHED_DATA_iSUB received for CID "
+					<< icnId.print() << " and rCID " << rCId.print()
+					<< " of length " << event.data_len);
+
+                if (rCId.rootNamespace() == NAMESPACE_IGMP_DATA || rCId.rootNamespace() == NAMESPACE_IGMP_CTRL) {
+                    _namespaces.handlePUBLISHED_DATA_iSUB(rCId, &event);
+                    break;
+                }
+
+		// add NID > rCID look up to HTTP handler so when START_PUBLISH_iSUB
+		// arrives the corresponding rCID can be looked up
+		_namespaces.Http::addReversNidTorCIdLookUp(event.nodeId, rCId);
+		// handle received publication
+		tpState = _transport.handle(icnId, rCId, event.nodeId,
+				event.data,	dataLength, enigma, sessionKey);
+
+		if (tpState	== TP_STATE_ALL_FRAGMENTS_RECEIVED)
+		{
+			bzero(retrievedPacket, 65535);
+
+			if (!_transport.retrieveIcnPacket(rCId, enigma, event.nodeId,
+					sessionKey, retrievedPacket, retrievedPacketSize))
+			{//packet retrieval failed. Break here
+				LOG4CXX_TRACE(logger, "HTTP request packet retrieval failed"
+						"for CID " << icnId.print() << ", rCID "
+						<< rCId.print() << ", Enigma " << enigma
+						<< " and NID " << event.nodeId);
+				break;
+			}
+
+			// switch over root scope to know which proxy should be called
+			switch (icnId.rootNamespace())
 			{
-				bzero(retrievedPacket, 65535);
-
-				if (!_transport.retrieveIcnPacket(rCId, enigma, event.nodeId,
-						sessionKey, retrievedPacket, retrievedPacketSize))
-				{//packet retrieval failed. Break here
-					LOG4CXX_TRACE(logger, "HTTP request packet retrieval failed"
-							"for CID " << icnId.print() << ", rCID "
-							<< rCId.print() << ", Enigma " << enigma
-							<< " and NID " << event.nodeId);
-					break;
-				}
+			case NAMESPACE_HTTP:
+			{
+				// the retrieval buffer is re-used for the next packet
+				tcpClientPacket = (uint8_t *)malloc(retrievedPacketSize);
 
-				// switch over root scope to know which proxy should be called
-				switch (icnId.rootNamespace())
-				{
-				case NAMESPACE_HTTP:
+				if (tcpClientPacket == NULL)
 				{
-					tcpClientThread = new std::thread(tcpClient, icnId,
-							rCId, enigma, sessionKey, event.nodeId,
-							retrievedPacket, retrievedPacketSize);
-					tcpClientThread->detach();
-					delete tcpClientThread;
-					break;
-				}
-				case NAMESPACE_COAP://example entry point for other proxies
+					LOG4CXX_ERROR(logger, "malloc failed for HTTP request "
+							"with CID " << icnId.print() << " rCID "
+							<< rCId.print());
 					break;
-				default:
-					LOG4CXX_INFO(logger, "Unknown root namespace for CID "
-							<< icnId.print() << ". Cannot send off retrieved "
-							"packet from ICN buffer")
 				}
-			}
 
-			break;
+				memcpy(tcpClientPacket, retrievedPacket,
+						retrievedPacketSize);
+				_reactor.post(std::bind(std::ref(tcpClient), icnId, rCId,
+						enigma,
+						sessionKey, event.nodeId, tcpClientPacket,
+						retrievedPacketSize));
+				break;
+			}
+			case NAMESPACE_COAP://example entry point for other proxies
+				break;
+			default:
+				LOG4CXX_INFO(logger, "Unknown root namespace for CID "
+						<< icnId.print() << ". Cannot send off retrieved "
+						"packet from ICN buffer")
+			}
 		}
-		/*
-		 * Re-publish
-		 */
-		case RE_PUBLISH:
-			LOG4CXX_TRACE(logger, "RE_PUBLISH received for CID "
-						<< icnId.print());
-			LOG4CXX_DEBUG(logger, "Unpublishing info item for CID "
+
+		break;
+	}
+	/*
+	 * Re-publish
+	 */
+	case RE_PUBLISH:
+		LOG4CXX_TRACE(logger, "RE_PUBLISH received for CID "
 					<< icnId.print());
-			_icnCore->unpublish_info(icnId.binId(), icnId.binPrefixId(),
-					DOMAIN_LOCAL, 0, 0);
-			_namespaces.forwarding(icnId, false);
-			break;
-		/*
-		 * Resume publish
-		 */
-		case RESUME_PUBLISH:
-			LOG4CXX_DEBUG(logger, "RESUME_PUBLISH received for CID "
-						<< icnId.print());
-			break;
-		case CONTROL_REQ_FAILURE:
-			LOG4CXX_ERROR(logger, "CONTROL_REQ_FAILURE received for CID "
-					<< icnId.print() << " (local BA cannot reach domain-local "
-							"RV)");
-			break;
-		default:
-			LOG4CXX_WARN(logger, "Unknown BA API event type received: "
-					<< (uint16_t)event.type);
-		}
+		LOG4CXX_DEBUG(logger, "Unpublishing info item for CID "
+				<< icnId.print());
+		_icnCore->unpublish_info(icnId.binId(), icnId.binPrefixId(),
+				DOMAIN_LOCAL, 0, 0);
+		_namespaces.forwarding(icnId, false);
+		break;
+	/*
+	 * Resume publish
+	 */
+	case RESUME_PUBLISH:
+		LOG4CXX_DEBUG(logger, "RESUME_PUBLISH received for CID "
+					<< icnId.print());
+		break;
+	case CONTROL_REQ_FAILURE:
+		LOG4CXX_ERROR(logger, "CONTROL_REQ_FAILURE received for CID "
+				<< icnId.print() << " (local BA cannot reach domain-local "
+						"RV)");
+		break;
+	default:
+		LOG4CXX_WARN(logger, "Unknown BA API event type received: "
+				<< (uint16_t)event.type);
 	}
-
-	LOG4CXX_INFO(logger, "ICN handler thread stopped");
-	free(retrievedPacket);//clean up memory
 }
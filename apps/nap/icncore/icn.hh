@@ -31,9 +31,12 @@
 #include <thread>
 
 #include <configuration.hh>
+#include <icncore/icneventqueue.hh>
 #include <types/enumerations.hh>
 #include <monitoring/statistics.hh>
 #include <namespaces/namespaces.hh>
+#include <proxies/http/reactor.hh>
+#include <proxies/http/tcpclient.hh>
 #include <transport/transport.hh>
 #include <types/icnid.hh>
 #include <vector>
@@ -42,12 +45,24 @@
 #include "dmalloc.h"
 #endif
 
+#define ICN_EVENT_QUEUE_SAMPLE_INTERVAL 256 // events between two samples of
+// the worker queue depths
+
+using namespace proxies::http::reactor;
+using namespace proxies::http::tcpclient;
 using namespace transport;
 
 namespace icn
 {
 /*!
  * \brief Implementation of the ICN handler
+ *
+ * The thread running operator()() only obtains events from Blackadder and
+ * hands them to a fixed pool of worker threads (icnWorkers in nap.cfg) which
+ * call the namespaces. Events are assigned to a worker by their CID, or rCID
+ * for iSub events, so that all events for one ID are handled in the order
+ * Blackadder delivered them while a slow handler only holds up the IDs which
+ * share its worker.
  */
 class Icn
 {
@@ -55,10 +70,12 @@ class Icn
 public:
 	/*!
 	 * \brief Constructor
+	 *
+	 * \param reactor The reactor HTTP requests received over ICN are handed to
 	 */
 	Icn(Blackadder *icnCore, Configuration &configuration,
 			Namespaces &namespaces, Transport &transport,
-			Statistics &statistics, bool *run);
+			Statistics &statistics, Reactor &reactor, bool *run);
 	/*!
 	 * \brief Destructor
 	 */
@@ -67,13 +84,40 @@ public:
 	 * \brief Functor to run this method in a boost thread
 	 */
 	void operator()();
+	/*!
+	 * \brief Functor for the worker threads
+	 *
+	 * \param worker The worker number, which is also the index of its queue
+	 * \param tcpClient The TCP client HTTP requests are handed to
+	 */
+	void operator()(uint16_t worker, TcpClient *tcpClient);
 private:
 	Blackadder *_icnCore; /*!< Pointer to Blackadder instance */
 	Configuration &_configuration; /*!< Reference to Configuration class */
 	Namespaces &_namespaces; /*!< Reference to ICN Namespaces */
 	Transport &_transport; /*!< Reference to Transport class */
 	Statistics &_statistics;/*!< Reference to Statistics class */
+	Reactor &_reactor;/*!< Reference to Reactor class */
 	bool *_run;
+	vector<IcnEventQueue *> _queues;/*!< One event queue per worker */
+	string _isubId;/*!< rCID of the last PUBLISHED_DATA_iSUB event */
+	/*!
+	 * \brief Hand an event to the worker responsible for its ID
+	 *
+	 * Blocks while the worker's queue is full.
+	 *
+	 * \param event The event. Ownership passes to the worker
+	 */
+	void _dispatch(Event *event);
+	/*!
+	 * \brief Handle a single event
+	 *
+	 * \param event The event obtained from Blackadder
+	 * \param retrievedPacket Buffer of 65535 bytes owned by the worker
+	 * \param tcpClient The TCP client HTTP requests are handed to
+	 */
+	void _handle(Event &event, uint8_t *retrievedPacket,
+			TcpClient &tcpClient);
 };
 
 } /* namespace icn */
@@ -0,0 +1,106 @@
+/*
+ * icneventqueue.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+
+#include "icneventqueue.hh"
+
+using namespace icn;
+
+IcnEventQueue::IcnEventQueue()
+	: _head(0),
+	  _tail(0),
+	  _waiting(false)
+{}
+
+IcnEventQueue::~IcnEventQueue()
+{
+	Event *event;
+
+	while ((event = pop(0)) != NULL)
+	{
+		delete event;
+	}
+}
+
+Event *IcnEventQueue::pop(uint32_t timeout)
+{
+	Event *event;
+	uint32_t head = _head.load(std::memory_order_relaxed);
+
+	if (_tail.load(std::memory_order_acquire) == head)
+	{
+		if (timeout == 0)
+		{
+			return NULL;
+		}
+
+		std::unique_lock<std::mutex> lock(_mutex);
+		// Announce the sleep before looking at the tail a second time. The
+		// producer stores the tail before looking at _waiting, so one of the
+		// two sees the other's store
+		_waiting.store(true);
+
+		// A wake-up meant for an event which has already been popped is
+		// possible, hence the predicate
+		_condition.wait_for(lock, std::chrono::milliseconds(timeout),
+				[this, head] { return _tail.load() != head; });
+
+		_waiting.store(false, std::memory_order_relaxed);
+
+		if (_tail.load(std::memory_order_acquire) == head)
+		{
+			return NULL;
+		}
+	}
+
+	event = _events[head & (ICN_EVENT_QUEUE_SIZE - 1)];
+	_head.store(head + 1, std::memory_order_release);
+	return event;
+}
+
+bool IcnEventQueue::push(Event *event)
+{
+	uint32_t tail = _tail.load(std::memory_order_relaxed);
+
+	if (tail - _head.load(std::memory_order_acquire) == ICN_EVENT_QUEUE_SIZE)
+	{
+		return false;
+	}
+
+	_events[tail & (ICN_EVENT_QUEUE_SIZE - 1)] = event;
+	_tail.store(tail + 1);
+
+	if (_waiting.load())
+	{
+		_mutex.lock();
+		_condition.notify_one();
+		_mutex.unlock();
+	}
+
+	return true;
+}
+
+uint32_t IcnEventQueue::size()
+{
+	return _tail.load(std::memory_order_acquire) -
+			_head.load(std::memory_order_acquire);
+}
@@ -0,0 +1,105 @@
+/*
+ * icneventqueue.hh
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAP_ICNCORE_ICNEVENTQUEUE_HH_
+#define NAP_ICNCORE_ICNEVENTQUEUE_HH_
+
+#include <atomic>
+#include <blackadder.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+
+#ifdef DMALLOC
+#include "dmalloc.h"
+#endif
+
+#define ICN_EVENT_QUEUE_SIZE 4096 // events, must be a power of two
+
+using namespace std;
+
+namespace icn
+{
+
+/*!
+ * \brief Bounded queue handing ICN events from the ICN listener to a worker
+ *
+ * The queue has exactly one producer (the thread calling getEvent()) and one
+ * consumer (the worker). Both sides only touch their own index and read the
+ * other one, so neither push() nor pop() takes a lock as long as the worker has
+ * something to do. An idle worker sleeps on a condition variable; the producer
+ * only takes the mutex to wake it up.
+ */
+class IcnEventQueue
+{
+public:
+	/*!
+	 * \brief Constructor
+	 */
+	IcnEventQueue();
+	/*!
+	 * \brief Destructor
+	 *
+	 * Deletes all events which have not been popped
+	 */
+	~IcnEventQueue();
+	/*!
+	 * \brief Wait for the next event
+	 *
+	 * May only be called by the consumer.
+	 *
+	 * \param timeout Maximal time in milliseconds to wait for an event
+	 *
+	 * \return The event (ownership passes to the caller) or NULL if none
+	 * arrived within the timeout
+	 */
+	Event *pop(uint32_t timeout);
+	/*!
+	 * \brief Append an event
+	 *
+	 * May only be called by the producer.
+	 *
+	 * \param event The event. The queue takes ownership if it could be added
+	 *
+	 * \return False if the queue is full
+	 */
+	bool push(Event *event);
+	/*!
+	 * \brief The number of events waiting in the queue
+	 */
+	uint32_t size();
+private:
+	Event *_events[ICN_EVENT_QUEUE_SIZE];/*!< Ring of queued events */
+	std::atomic<uint32_t> _head;/*!< Next event to be popped. Written by the
+	consumer only */
+	uint8_t _headPadding[60];/*!< Keep _head and _tail in different cache
+	lines */
+	std::atomic<uint32_t> _tail;/*!< Next free slot. Written by the producer
+	only */
+	std::atomic<bool> _waiting;/*!< The consumer is about to sleep or
+	sleeping */
+	std::mutex _mutex;/*!< Mutex for _condition */
+	std::condition_variable _condition;/*!< Wakes up the consumer */
+};
+
+} /* namespace icn */
+
+#endif /* NAP_ICNCORE_ICNEVENTQUEUE_HH_ */
@@ -46,6 +46,7 @@
 #include <sockets/ipsocket.hh>
 #include <namespaces/namespaces.hh>
 #include <proxies/http/httpproxy.hh>
+#include <proxies/http/reactor.hh>
 #include <types/ipaddress.hh>
 
 #ifdef DMALLOC
@@ -63,6 +64,7 @@ using namespace namespaces;
 using namespace namespaces::ip;
 using namespace namespaces::http;
 using namespace proxies::http;
+using namespace proxies::http::reactor;
 using namespace std;
 
 namespace po = boost::program_options;
@@ -207,14 +209,21 @@ int main(int ac, char* av[])
 	namespacesPointer = &namespaces;
 	// Initialise the ICN namespaces (subscribing to respective scopes, etc)
 	namespaces.initialise();
+	// Event loop of the HTTP proxy serving all TCP sessions on either side
+	Reactor reactor(configuration.httpProxyWorkers(),
+			configuration.httpProxyPublishers(), &run);
 	// Start ICN handler
-	Icn icn(icnCore, configuration, namespaces, transport, statistics, &run);
+	Icn icn(icnCore, configuration, namespaces, transport, statistics, reactor,
+			&run);
 	LOG4CXX_DEBUG(logger, "Starting ICN handler thread");
 	mainThreads.push_back(std::thread(icn));
-	// Start demux
-	Demux demux(namespaces, configuration, statistics, ipSocket, &run);
-	LOG4CXX_DEBUG(logger, "Starting Demux thread");
-	mainThreads.push_back(std::thread(demux));
+	// Start demux threads (more than one requires the TPACKET_V3 backend)
+	for (uint16_t i = 0; i < configuration.captureThreads(); i++)
+	{
+		Demux demux(namespaces, configuration, statistics, ipSocket, &run, i);
+		LOG4CXX_DEBUG(logger, "Starting Demux thread " << i);
+		mainThreads.push_back(std::thread(demux));
+	}
 
 	// NAP SA Listener
 	if (configuration.httpHandler() && configuration.surrogacy())
@@ -227,8 +236,12 @@ int main(int ac, char* av[])
 	// HTTP proxy
 	if (configuration.httpHandler())
 	{
+		LOG4CXX_DEBUG(logger, "Starting HTTP proxy reactor with "
+				<< configuration.httpProxyWorkers() << " worker and "
+				<< configuration.httpProxyPublishers() << " publisher threads");
+		reactor.start();
 		httpProxyPointer = new HttpProxy(configuration, namespaces, statistics,
-				&run);
+				reactor, &run);
 		LOG4CXX_DEBUG(logger, "Starting HTTP proxy thread");
 		mainThreads.push_back(std::thread(*httpProxyPointer));
 	}
@@ -100,6 +100,18 @@ void Collector::operator ()()
 		LOG4CXX_TRACE(logger, "*** *** *** Average (x10000) Channel Acquisition Time in seconds at a"
                         << " cNAP over the configured reporting interval: " << channelAcquisitionTime);
 		moly.channelAquisitionTime(channelAcquisitionTime);//TODO TBD by sebastian 
+		histogram_percentiles_t channelAcquisitionTimes =
+				_statistics.channelAcquisitionTimes();
+
+		if (channelAcquisitionTimes.samples > 0)
+		{
+			LOG4CXX_DEBUG(logger, "Channel acquisition time: median "
+					<< channelAcquisitionTimes.p50 / 10.0 << "ms, 90th "
+					"percentile " << channelAcquisitionTimes.p90 / 10.0
+					<< "ms, 99th percentile " << channelAcquisitionTimes.p99 / 10.0
+					<< "ms, max " << channelAcquisitionTimes.max / 10.0 << "ms ("
+					<< channelAcquisitionTimes.samples << " joins)");
+		}
 
                 // MCast/IGMP handler stats..
 		mcastIpBytesIn = _statistics.counterRxIGMPBytes();
@@ -142,7 +154,7 @@ void Collector::operator ()()
 		averageLatencyCounter = 0;
 		unordered_map <uint32_t, uint16_t> latencyPerFqdn;
 		unordered_map <uint32_t, uint16_t>::iterator latencyPerFqdnIt;
-		latencyPerFqdn = _statistics.averageNetworkDelayPerFqdn();
+		latencyPerFqdn = _statistics.networkDelayPerFqdn();
 
 		for (latencyPerFqdnIt = latencyPerFqdn.begin();
 				latencyPerFqdnIt != latencyPerFqdn.end(); latencyPerFqdnIt++)
@@ -172,6 +184,18 @@ void Collector::operator ()()
 			averageLatency = averageLatencySum / averageLatencyCounter;
 		}
 
+		// the per FQDN latencies above are what MONA gets
+		histogram_percentiles_t roundTripTimes = _statistics.roundTripTimes();
+
+		if (roundTripTimes.samples > 0)
+		{
+			LOG4CXX_DEBUG(logger, "LTP RTT over all FQDNs: median "
+					<< roundTripTimes.p50 << "ms, 90th percentile "
+					<< roundTripTimes.p90 << "ms, 99th percentile "
+					<< roundTripTimes.p99 << "ms, max " << roundTripTimes.max
+					<< "ms (" << roundTripTimes.samples << " samples)");
+		}
+
 		// report newly added IP endpoints
 		ip_endpoints_t ipEndpoints = _statistics.ipEndpoints();
 		if (!ipEndpoints.empty() && !_configuration.icnGatewayIp())
@@ -269,6 +293,18 @@ void Collector::operator ()()
 		buffer_sizes_t bufferSizes;
 		bufferSizes.push_back(pair<buffer_name_t, buffer_size_t>(
 				BUFFER_NAP_IP_HANDLER,_statistics.bufferSizeIpHandler()));
+		ip_buffer_statistics_t ipBuffer = _statistics.ipBuffer();
+		bufferSizes.push_back(pair<buffer_name_t, buffer_size_t>(
+				BUFFER_NAP_IP_HANDLER_BYTES, ipBuffer.bytes));
+
+		if (ipBuffer.maxBytes > 0 || ipBuffer.droppedPackets > 0)
+		{
+			LOG4CXX_DEBUG(logger, "IP buffer holds " << ipBuffer.bytes
+					<< " bytes (max " << ipBuffer.maxBytes << "). "
+					<< ipBuffer.droppedPackets << " packets ("
+					<< ipBuffer.droppedBytes << " bytes) dropped");
+		}
+
 		bufferSizes.push_back(pair<buffer_name_t, buffer_size_t>(
 				BUFFER_NAP_HTTP_HANDLER_REQUESTS,
 				_statistics.bufferSizeHttpHandlerRequests()));
@@ -277,6 +313,56 @@ void Collector::operator ()()
 				_statistics.bufferSizeHttpHandlerResponses()));
 		bufferSizes.push_back(pair<buffer_name_t, buffer_size_t>(
 				BUFFER_NAP_LTP, _statistics.bufferSizeLtp()));
+		pair<uint32_t, uint32_t> tcpClientPool = _statistics.tcpClientPool();
+
+		if (tcpClientPool.first > 0)
+		{
+			bufferSizes.push_back(pair<buffer_name_t, buffer_size_t>(
+					BUFFER_NAP_TCP_CLIENT_POOL_HIT_RATE,
+					tcpClientPool.second * 100 / tcpClientPool.first));
+			LOG4CXX_DEBUG(logger, "TCP client pool hit rate "
+					<< tcpClientPool.second * 100 / tcpClientPool.first << "% ("
+					<< tcpClientPool.second << " of " << tcpClientPool.first
+					<< " HTTP requests sent over a pooled connection)");
+		}
+
+		http_cache_statistics_t httpCache = _statistics.httpCache();
+
+		if (httpCache.requests > 0)
+		{
+			bufferSizes.push_back(pair<buffer_name_t, buffer_size_t>(
+					BUFFER_NAP_HTTP_CACHE_HIT_RATE,
+					(httpCache.hits + httpCache.coalesced) * 100 /
+					httpCache.requests));
+			LOG4CXX_DEBUG(logger, "HTTP cache hit ratio "
+					<< (httpCache.hits + httpCache.coalesced) * 100 /
+					httpCache.requests << "% (" << httpCache.hits << " hits and "
+					<< httpCache.coalesced << " coalesced of "
+					<< httpCache.requests << " cacheable HTTP requests). "
+					<< httpCache.bytesSaved << " bytes not requested over ICN");
+		}
+
+		icn_event_queues_t icnEventQueues = _statistics.icnEventQueues();
+		buffer_size_t icnEventQueueDepth = 0;
+
+		for (size_t i = 0; i < icnEventQueues.size(); i++)
+		{
+			if (icnEventQueues[i].samples == 0)
+			{
+				continue;
+			}
+
+			icnEventQueueDepth += icnEventQueues[i].depthSum /
+					icnEventQueues[i].samples;
+			LOG4CXX_DEBUG(logger, "ICN worker thread " << i << " queue depth: "
+					<< icnEventQueues[i].depthSum / icnEventQueues[i].samples
+					<< " events on average, " << icnEventQueues[i].maxDepth
+					<< " at most (" << icnEventQueues[i].samples
+					<< " samples)");
+		}
+
+		bufferSizes.push_back(pair<buffer_name_t, buffer_size_t>(
+				BUFFER_NAP_ICN_EVENT_QUEUES, icnEventQueueDepth));
 
 		if (!moly.bufferSizes(NODE_ROLE_NAP, bufferSizes))
 		{
@@ -293,7 +379,6 @@ void Collector::operator ()()
 			LOG4CXX_WARN(logger, "Number of file descritpors could not be "
 					"sent to MONA");
 		}
-
 	}
 
 	LOG4CXX_INFO(logger, "Statistics collector thread stopped");
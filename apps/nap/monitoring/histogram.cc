@@ -0,0 +1,133 @@
+/*
+ * histogram.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "histogram.hh"
+
+using namespace monitoring::histogram;
+
+Histogram::Histogram()
+	: _max(0)
+{
+	for (uint16_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+	{
+		_counts[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+histogram_percentiles_t Histogram::percentiles()
+{
+	histogram_percentiles_t percentiles = histogram_percentiles_t();
+	uint32_t counts[HISTOGRAM_BUCKETS];
+	uint32_t count = 0;
+	uint32_t samples = 0;
+
+	for (uint16_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+	{
+		counts[i] = _counts[i].exchange(0, std::memory_order_relaxed);
+		percentiles.samples += counts[i];
+	}
+
+	percentiles.max = _max.exchange(0, std::memory_order_relaxed);
+
+	if (percentiles.samples == 0)
+	{
+		return percentiles;
+	}
+
+	// ceil(samples * p) values must lie at or below the percentile
+	uint32_t p50 = percentiles.samples - percentiles.samples / 2;
+	uint32_t p90 = percentiles.samples - percentiles.samples / 10;
+	uint32_t p99 = percentiles.samples - percentiles.samples / 100;
+	percentiles.p50 = percentiles.p90 = percentiles.p99 = UINT32_MAX;
+
+	for (uint16_t i = 0; i < HISTOGRAM_BUCKETS && samples < p99; i++)
+	{
+		count = counts[i];
+
+		if (count == 0)
+		{
+			continue;
+		}
+
+		samples += count;
+
+		if (samples >= p50 && percentiles.p50 == UINT32_MAX)
+		{
+			percentiles.p50 = _value(i);
+		}
+
+		if (samples >= p90 && percentiles.p90 == UINT32_MAX)
+		{
+			percentiles.p90 = _value(i);
+		}
+
+		if (samples >= p99)
+		{
+			percentiles.p99 = _value(i);
+		}
+	}
+
+	return percentiles;
+}
+
+void Histogram::record(uint32_t value)
+{
+	uint32_t max = _max.load(std::memory_order_relaxed);
+	_counts[_bucket(value)].fetch_add(1, std::memory_order_relaxed);
+
+	while (value > max && !_max.compare_exchange_weak(max, value,
+			std::memory_order_relaxed));
+}
+
+uint16_t Histogram::_bucket(uint32_t value)
+{
+	uint8_t msb;
+
+	if (value < (1 << HISTOGRAM_SUB_BUCKET_BITS))
+	{
+		return value;
+	}
+
+	msb = 31 - __builtin_clz(value);
+	// the HISTOGRAM_SUB_BUCKET_BITS most significant bits select the bucket
+	// within the octave
+	return (1 << HISTOGRAM_SUB_BUCKET_BITS) + (msb - HISTOGRAM_SUB_BUCKET_BITS)
+			* (1 << (HISTOGRAM_SUB_BUCKET_BITS - 1))
+			+ (value >> (msb - HISTOGRAM_SUB_BUCKET_BITS + 1))
+			- (1 << (HISTOGRAM_SUB_BUCKET_BITS - 1));
+}
+
+uint32_t Histogram::_value(uint16_t bucket)
+{
+	uint8_t octave;
+	uint32_t subBucket;
+
+	if (bucket < (1 << HISTOGRAM_SUB_BUCKET_BITS))
+	{
+		return bucket;
+	}
+
+	bucket -= (1 << HISTOGRAM_SUB_BUCKET_BITS);
+	octave = bucket / (1 << (HISTOGRAM_SUB_BUCKET_BITS - 1));
+	subBucket = bucket % (1 << (HISTOGRAM_SUB_BUCKET_BITS - 1))
+			+ (1 << (HISTOGRAM_SUB_BUCKET_BITS - 1));
+	return subBucket << (octave + 1);
+}
@@ -0,0 +1,93 @@
+/*
+ * histogram.hh
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAP_MONITORING_HISTOGRAM_HH_
+#define NAP_MONITORING_HISTOGRAM_HH_
+
+#include <atomic>
+#include <stdint.h>
+
+#include <monitoring/monitoringtypedefs.hh>
+
+#ifdef DMALLOC
+#include "dmalloc.h"
+#endif
+
+#define HISTOGRAM_SUB_BUCKET_BITS 5 // 2^5 buckets below 32, 16 per octave above
+#define HISTOGRAM_BUCKETS ((1 << HISTOGRAM_SUB_BUCKET_BITS) + (32 -\
+		HISTOGRAM_SUB_BUCKET_BITS) * (1 << (HISTOGRAM_SUB_BUCKET_BITS - 1)))
+
+namespace monitoring {
+
+namespace histogram {
+
+/*!
+ * \brief Histogram of latency values in the style of an HDR histogram
+ *
+ * Values below 2^HISTOGRAM_SUB_BUCKET_BITS have a bucket each. Every power of
+ * two above is split into 2^(HISTOGRAM_SUB_BUCKET_BITS - 1) buckets of equal
+ * width, so that the relative error of a reported percentile never exceeds
+ * 1/16 regardless of the magnitude of the value. All 32-bit values fit into
+ * the 464 buckets.
+ *
+ * Recording a value is a single relaxed atomic increment and may happen from
+ * any number of threads while another thread obtains the percentiles.
+ */
+class Histogram
+{
+public:
+	/*!
+	 * \brief Constructor
+	 */
+	Histogram();
+	/*!
+	 * \brief Obtain the percentiles of all values recorded since the last call
+	 * and reset the histogram
+	 *
+	 * Percentiles are the lowest value of the bucket the percentile falls into
+	 *
+	 * \return The percentiles (all 0 if no value was recorded)
+	 */
+	histogram_percentiles_t percentiles();
+	/*!
+	 * \brief Record a value
+	 *
+	 * \param value The value
+	 */
+	void record(uint32_t value);
+private:
+	std::atomic<uint32_t> _counts[HISTOGRAM_BUCKETS];/*!< Values per bucket */
+	std::atomic<uint32_t> _max;/*!< Largest value recorded */
+	/*!
+	 * \brief The bucket a value falls into
+	 */
+	uint16_t _bucket(uint32_t value);
+	/*!
+	 * \brief The lowest value of a bucket
+	 */
+	uint32_t _value(uint16_t bucket);
+};
+
+} /* namespace histogram */
+
+} /* namespace monitoring */
+
+#endif /* NAP_MONITORING_HISTOGRAM_HH_ */
@@ -22,9 +22,11 @@
 #ifndef NAP_MONITORING_MONITORINGTYPEDEFS_HH_
 #define NAP_MONITORING_MONITORINGTYPEDEFS_HH_
 
+#include <map>
 #include <moly/enum.hh>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <types/ipaddress.hh>
 
@@ -48,4 +50,54 @@ address, struct> */
 
 typedef map<string, uint32_t> http_requests_per_fqdn_t ;
 
+/*!
+ * \brief Usage of the cNAP's HTTP response cache
+ */
+struct http_cache_statistics_t
+{
+	uint32_t requests;/*!< Cacheable HTTP requests */
+	uint32_t hits;/*!< Requests served from the cache */
+	uint32_t coalesced;/*!< Requests served with the response of an identical
+	request still in flight */
+	uint64_t bytesSaved;/*!< Response bytes sent to IP endpoints without
+	having been requested over ICN */
+};
+
+/*!
+ * \brief Occupancy of and drops in the IP handler's packet buffer
+ */
+struct ip_buffer_statistics_t
+{
+	uint32_t bytes;/*!< Bytes buffered when last sampled */
+	uint32_t maxBytes;/*!< Largest sampled number of bytes */
+	uint32_t droppedPackets;/*!< Packets dropped as a buffer was full or they
+	timed out */
+	uint64_t droppedBytes;/*!< Their bytes */
+};
+
+/*!
+ * \brief Percentiles obtained from a latency histogram
+ */
+struct histogram_percentiles_t
+{
+	uint32_t samples;/*!< Number of recorded values */
+	uint32_t p50;/*!< Median */
+	uint32_t p90;/*!< 90th percentile */
+	uint32_t p99;/*!< 99th percentile */
+	uint32_t max;/*!< Largest recorded value */
+};
+
+/*!
+ * \brief Depth of the queue in front of an ICN worker thread
+ */
+struct icn_event_queue_statistics_t
+{
+	uint32_t depthSum;/*!< Sum of all sampled depths */
+	uint32_t samples;/*!< Number of samples */
+	uint32_t maxDepth;/*!< Deepest sample */
+};
+
+typedef vector<icn_event_queue_statistics_t> icn_event_queues_t;/*!<
+vector<statistics of ICN worker thread> */
+
 #endif /* NAP_MONITORING_MONITORINGTYPEDEFS_HH_ */
@@ -25,6 +25,26 @@ using namespace monitoring::statistics;
 
 LoggerPtr Statistics::logger(Logger::getLogger("monitoring.statistics"));
 
+/*!
+ * \brief The statistics shard owned by the calling thread
+ *
+ * Hands the shard on to the next thread once the owner has ended.
+ */
+struct statistics_thread_t
+{
+	Statistics *statistics;/*!< The instance the shard belongs to */
+	statistics_shard_t *shard;/*!< The shard */
+	~statistics_thread_t()
+	{
+		if (shard != NULL)
+		{
+			shard->owned.store(false, std::memory_order_release);
+		}
+	}
+};
+
+static thread_local statistics_thread_t statisticsThread = {NULL, NULL};
+
 Statistics::Statistics()
 {
 	_bufferSizeHttpHandlerRequests.first = 0;
@@ -33,78 +53,35 @@ Statistics::Statistics()
 	_bufferSizeHttpHandlerResponses.second = 0;
 	_bufferSizeIpHandler.first = 0;
 	_bufferSizeIpHandler.second = 0;
-	_cmcGroupSizes.first = 0;
-	_cmcGroupSizes.second = 0;
-	_rxHttpBytes = 0 ;
-	_rxIpBytes = 0;
+	_bufferSizeLtp.first = 0;
+	_bufferSizeLtp.second = 0;
+	_ipBufferBytes = 0;
+	_ipBufferMaxBytes = 0;
 	_tcpSockets = 0;
-	_txHttpBytes = 0;
-	_txIpBytes = 0;
-    _rxIGMPBytes = 0;
-    _txIGMPBytes = 0;
 }
 
 uint32_t Statistics::averageCmcGroupSize()
 {
     uint32_t averageCmcGroupSize;
+    uint64_t cmcGroups;
+    uint64_t cmcGroupSizes;
     _mutex.lock();
+    cmcGroups = _collect(STATISTICS_COUNTER_CMC_GROUPS);
+    cmcGroupSizes = _collect(STATISTICS_COUNTER_CMC_GROUP_SIZES);
+    _mutex.unlock();
 
-    if (_cmcGroupSizes.first != 0)
+    if (cmcGroups != 0)
     {
-        averageCmcGroupSize = _cmcGroupSizes.second * 10 / _cmcGroupSizes.first;
+        averageCmcGroupSize = cmcGroupSizes * 10 / cmcGroups;
     }
     else
     {
         averageCmcGroupSize = 0;
     }
 
-    _cmcGroupSizes.first = 0;
-    _cmcGroupSizes.second = 0;
-    _mutex.unlock();
     return averageCmcGroupSize;
 }
 
-unordered_map<uint32_t, uint16_t> Statistics::averageNetworkDelayPerFqdn()
-{
-    unordered_map<uint32_t, uint16_t> latencyPerFqdn;
-    forward_list<uint16_t>::iterator fListIt;
-    uint32_t rttSum;
-    uint16_t listSize;
-    uint16_t latency;
-    _mutex.lock();
-    for (_rttPerFqdnIt = _rttPerFqdn.begin();
-            _rttPerFqdnIt != _rttPerFqdn.end(); _rttPerFqdnIt++)
-    {
-        listSize = 0;
-        rttSum = 0;
-        // Get RTT sum
-        for (fListIt = _rttPerFqdnIt->second.begin();
-                fListIt != _rttPerFqdnIt->second.end(); fListIt++)
-        {
-            rttSum += *fListIt;
-            listSize++;
-        }
-        // Calculate & insert sum of not 0
-        if (rttSum != 0)
-        {
-            latency = ((rttSum / listSize) / 2.0) * 10.0;
-
-            //if RTT was 1, latency is 0. Set it to 1
-            if (latency == 0)
-            {
-                latency = 1;
-            }
-
-            latencyPerFqdn.insert(pair<uint32_t, uint16_t>(_rttPerFqdnIt->first,
-                    latency));
-            // Now reset all values for this FQDN
-            _rttPerFqdnIt->second.clear();
-        }
-    }
-    _mutex.unlock();
-    return latencyPerFqdn;
-}
-
 void Statistics::bufferSizeHttpHandlerRequests(uint32_t bufferSize)
 {
 	_mutex.lock();
@@ -210,15 +187,89 @@ void Statistics::bufferSizeLtp(uint32_t bufferSize)
 
 void Statistics::cmcGroupSize(uint32_t cmcGroupSize)
 {
-    _mutex.lock();
-    _cmcGroupSizes.first++;
-    _cmcGroupSizes.second += cmcGroupSize;
-    _mutex.unlock();
+    _add(STATISTICS_COUNTER_CMC_GROUPS, 1);
+    _add(STATISTICS_COUNTER_CMC_GROUP_SIZES, cmcGroupSize);
+}
+
+icn_event_queues_t Statistics::icnEventQueues()
+{
+	icn_event_queues_t icnEventQueues;
+	_mutex.lock();
+	icnEventQueues = _icnEventQueues;
+
+	for (size_t i = 0; i < _icnEventQueues.size(); i++)
+	{
+		_icnEventQueues[i] = icn_event_queue_statistics_t();
+	}
+
+	_mutex.unlock();
+	return icnEventQueues;
+}
+
+void Statistics::icnEventQueue(uint16_t queue, uint32_t depth)
+{
+	_mutex.lock();
+
+	if (_icnEventQueues.size() <= queue)
+	{
+		_icnEventQueues.resize(queue + 1, icn_event_queue_statistics_t());
+	}
+
+	_icnEventQueues[queue].depthSum += depth;
+	_icnEventQueues[queue].samples++;
+
+	if (depth > _icnEventQueues[queue].maxDepth)
+	{
+		_icnEventQueues[queue].maxDepth = depth;
+	}
+
+	_mutex.unlock();
+}
+
+ip_buffer_statistics_t Statistics::ipBuffer()
+{
+	ip_buffer_statistics_t ipBuffer;
+	_mutex.lock();
+	ipBuffer.bytes = _ipBufferBytes;
+	ipBuffer.maxBytes = _ipBufferMaxBytes;
+	ipBuffer.droppedPackets =
+			_collect(STATISTICS_COUNTER_IP_BUFFER_DROPPED_PACKETS);
+	ipBuffer.droppedBytes = _collect(STATISTICS_COUNTER_IP_BUFFER_DROPPED_BYTES);
+	_ipBufferMaxBytes = _ipBufferBytes;
+	_mutex.unlock();
+	return ipBuffer;
+}
+
+void Statistics::ipBuffer(uint32_t bytes)
+{
+	_mutex.lock();
+	_ipBufferBytes = bytes;
+
+	if (bytes > _ipBufferMaxBytes)
+	{
+		_ipBufferMaxBytes = bytes;
+	}
+
+	_mutex.unlock();
+}
+
+void Statistics::ipBufferDrop(uint16_t packetSize)
+{
+	_add(STATISTICS_COUNTER_IP_BUFFER_DROPPED_PACKETS, 1);
+	_add(STATISTICS_COUNTER_IP_BUFFER_DROPPED_BYTES, packetSize);
 }
 
 void Statistics::ipEndpointAdd(IpAddress ipAddress)
 {
     ip_endpoints_t::iterator ipEndpointsIt;
+    statistics_shard_t *shard = _shard();
+
+    // once added, an IP endpoint is never changed. Only take the lock the
+    // first time this thread sees it
+    if (!shard->ipEndpoints.insert(ipAddress.uint()).second)
+    {
+        return;
+    }
 
     if (ipAddress.str().length() == 0)
     {
@@ -249,6 +300,14 @@ void Statistics::ipEndpointAdd(IpAddress ipAddress)
 void Statistics::ipEndpointAdd(IpAddress ipAddress, uint16_t port)
 {
     ip_endpoints_t::iterator ipEndpointsIt;
+    statistics_shard_t *shard = _shard();
+
+    // once added, an IP endpoint is never changed. Only take the lock the
+    // first time this thread sees it
+    if (!shard->ipEndpoints.insert(ipAddress.uint()).second)
+    {
+        return;
+    }
 
     if (ipAddress.str().length() == 0)
     {
@@ -281,6 +340,14 @@ void Statistics::ipEndpointAdd(IpAddress ipAddress, uint16_t port)
 void Statistics::ipEndpointAdd(IpAddress ipAddress, string fqdn, uint16_t port)
 {
     ip_endpoints_t::iterator ipEndpointsIt;
+    statistics_shard_t *shard = _shard();
+
+    // once added, an IP endpoint is never changed. Only take the lock the
+    // first time this thread sees it
+    if (!shard->ipEndpoints.insert(ipAddress.uint()).second)
+    {
+        return;
+    }
 
     if (ipAddress.str().length() == 0)
     {
@@ -339,6 +406,79 @@ ip_endpoints_t Statistics::ipEndpoints()
     return currentIpEndpoints;
 }
 
+unordered_map<uint32_t, uint16_t> Statistics::networkDelayPerFqdn()
+{
+	unordered_map<uint32_t, uint16_t> latencyPerFqdn;
+	unordered_map<uint32_t, Histogram *>::iterator roundTripTimesIt;
+	histogram_percentiles_t percentiles;
+	uint16_t latency;
+	_mutex.lock();
+
+	for (roundTripTimesIt = _roundTripTimesPerFqdn.begin();
+			roundTripTimesIt != _roundTripTimesPerFqdn.end();
+			roundTripTimesIt++)
+	{
+		percentiles = roundTripTimesIt->second->percentiles();
+
+		if (percentiles.samples == 0)
+		{
+			continue;
+		}
+
+		latency = (percentiles.p50 / 2.0) * 10.0;
+
+		//if RTT was 1, latency is 0. Set it to 1
+		if (latency == 0)
+		{
+			latency = 1;
+		}
+
+		latencyPerFqdn.insert(pair<uint32_t, uint16_t>(roundTripTimesIt->first,
+				latency));
+		LOG4CXX_TRACE(logger, "RTT for hashed FQDN " << roundTripTimesIt->first
+				<< ": median " << percentiles.p50 << "ms, 99th percentile "
+				<< percentiles.p99 << "ms (" << percentiles.samples
+				<< " samples)");
+	}
+
+	_mutex.unlock();
+	return latencyPerFqdn;
+}
+
+http_cache_statistics_t Statistics::httpCache()
+{
+	http_cache_statistics_t httpCache;
+	_mutex.lock();
+	httpCache.requests = _collect(STATISTICS_COUNTER_HTTP_CACHE_REQUESTS);
+	httpCache.hits = _collect(STATISTICS_COUNTER_HTTP_CACHE_HITS);
+	httpCache.coalesced = _collect(STATISTICS_COUNTER_HTTP_CACHE_COALESCED);
+	httpCache.bytesSaved = _collect(STATISTICS_COUNTER_HTTP_CACHE_BYTES_SAVED);
+	_mutex.unlock();
+	return httpCache;
+}
+
+void Statistics::httpCache(http_cache_lookup_t lookup)
+{
+	_add(STATISTICS_COUNTER_HTTP_CACHE_REQUESTS, 1);
+
+	switch (lookup)
+	{
+	case HTTP_CACHE_LOOKUP_HIT:
+		_add(STATISTICS_COUNTER_HTTP_CACHE_HITS, 1);
+		break;
+	case HTTP_CACHE_LOOKUP_COALESCED:
+		_add(STATISTICS_COUNTER_HTTP_CACHE_COALESCED, 1);
+		break;
+	case HTTP_CACHE_LOOKUP_MISS:
+		break;
+	}
+}
+
+void Statistics::httpCacheBytesSaved(uint32_t bytes)
+{
+	_add(STATISTICS_COUNTER_HTTP_CACHE_BYTES_SAVED, bytes);
+}
+
 http_requests_per_fqdn_t Statistics::httpRequestsPerFqdn()
 {
     http_requests_per_fqdn_t httpRequestsPerFqdn;
@@ -370,36 +510,58 @@ void Statistics::httpRequestsPerFqdn(string fqdn, uint32_t numberOfRequests)
 
 void Statistics::roundTripTime(IcnId cid, uint16_t rtt)
 {
+    unordered_map<uint32_t, Histogram *>::iterator roundTripTimesIt;
+    statistics_shard_t *shard = _shard();
+    Histogram *histogram;
+
     if (rtt == 0)
     {
         rtt = 1;
     }
+
+    _roundTripTimes.record(rtt);
+    //only get the information item which is the hashed FQDN
+    roundTripTimesIt = shard->roundTripTimes.find(cid.uintId());
+
+    if (roundTripTimesIt != shard->roundTripTimes.end())
+    {
+        roundTripTimesIt->second->record(rtt);
+        return;
+    }
+
     _mutex.lock();
-    _rttPerFqdnIt = _rttPerFqdn.find(cid.uintId());//only get the information
-    // item which is the hashed FQDN
+    roundTripTimesIt = _roundTripTimesPerFqdn.find(cid.uintId());
+
     // FQDN not found
-    if (_rttPerFqdnIt == _rttPerFqdn.end())
+    if (roundTripTimesIt == _roundTripTimesPerFqdn.end())
     {
-        forward_list<uint16_t> rtts;
-        rtts.push_front(rtt);
-        _rttPerFqdn.insert(pair<uint32_t, forward_list < uint16_t >> (cid.uintId(),
-                rtts));
+        histogram = new Histogram();
+        _roundTripTimesPerFqdn.insert(pair<uint32_t, Histogram *>(
+                cid.uintId(), histogram));
         LOG4CXX_TRACE(logger, "New hashed FQDN " << cid.uintId() << " added to"
                 " RTT statistics table");
-        _mutex.unlock();
-        return;
     }
-    // simply add the new rtt value
-    _rttPerFqdnIt->second.push_front(rtt);
+    else
+    {
+        histogram = roundTripTimesIt->second;
+    }
+
     _mutex.unlock();
+    shard->roundTripTimes.insert(pair<uint32_t, Histogram *>(cid.uintId(),
+            histogram));
+    histogram->record(rtt);
+}
+
+histogram_percentiles_t Statistics::roundTripTimes()
+{
+	return _roundTripTimes.percentiles();
 }
 
 uint32_t Statistics::rxHttpBytes()
 {
 	uint32_t rxHttpBytes = 0;
 	_mutex.lock();
-	rxHttpBytes = _rxHttpBytes;
-	_rxHttpBytes = 0;
+	rxHttpBytes = _collect(STATISTICS_COUNTER_RX_HTTP_BYTES);
 	_mutex.unlock();
 	LOG4CXX_TRACE(logger, "RX HTTP bytes counter of " << rxHttpBytes
 			<< " obtained and counter reset");
@@ -408,19 +570,16 @@ uint32_t Statistics::rxHttpBytes()
 
 void Statistics::rxHttpBytes(int *rxBytes)
 {
-	_mutex.lock();
-	_rxHttpBytes += *rxBytes;
-	LOG4CXX_TRACE(logger, "RX IP bytes counter increased by " << *rxBytes
-			<< " to " << _rxHttpBytes << " bytes");
-	_mutex.unlock();
+	_add(STATISTICS_COUNTER_RX_HTTP_BYTES, *rxBytes);
+	LOG4CXX_TRACE(logger, "RX HTTP bytes counter increased by " << *rxBytes
+			<< " bytes");
 }
 
 uint32_t Statistics::rxIpBytes()
 {
 	uint32_t rxIpBytes = 0;
 	_mutex.lock();
-	rxIpBytes = _rxIpBytes;
-	_rxIpBytes = 0;
+	rxIpBytes = _collect(STATISTICS_COUNTER_RX_IP_BYTES);
 	_mutex.unlock();
 	LOG4CXX_TRACE(logger, "RX IP bytes counter of " << rxIpBytes
 			<< " obtained and counter reset");
@@ -429,37 +588,53 @@ uint32_t Statistics::rxIpBytes()
 
 void Statistics::rxIpBytes(uint16_t *rxBytes)
 {
-	_mutex.lock();
-	_rxIpBytes += *rxBytes;
+	_add(STATISTICS_COUNTER_RX_IP_BYTES, *rxBytes);
 	LOG4CXX_TRACE(logger, "RX IP bytes counter increased by " << *rxBytes
-			<< " to " << _rxIpBytes << " bytes");
+			<< " bytes");
+}
+
+pair<uint32_t, uint32_t> Statistics::tcpClientPool()
+{
+	pair<uint32_t, uint32_t> tcpClientPool;
+	_mutex.lock();
+	tcpClientPool.first = _collect(STATISTICS_COUNTER_TCP_CLIENT_POOL_REQUESTS);
+	tcpClientPool.second = _collect(STATISTICS_COUNTER_TCP_CLIENT_POOL_HITS);
 	_mutex.unlock();
+	return tcpClientPool;
 }
 
-void Statistics::tcpSocket(int sockets)
+void Statistics::tcpClientPool(bool hit)
 {
-    _mutex.lock();
+	_add(STATISTICS_COUNTER_TCP_CLIENT_POOL_REQUESTS, 1);
 
-    // just in case
-    if (_tcpSockets == 0 && sockets < 0)
-    {
-        _tcpSockets = 0;
-    } else
-    {
-        _tcpSockets += sockets;
-    }
+	if (hit)
+	{
+		_add(STATISTICS_COUNTER_TCP_CLIENT_POOL_HITS, 1);
+	}
+}
 
-    _mutex.unlock();
+void Statistics::tcpSocket(int sockets)
+{
+	// negative changes wrap around and are taken back by _collect()
+	_add(STATISTICS_COUNTER_TCP_SOCKETS, (uint64_t)(int64_t)sockets);
 }
 
 uint16_t Statistics::tcpSockets()
 {
 	uint16_t tcpSockets;
 	_mutex.lock();
+	_tcpSockets += (int64_t)_collect(STATISTICS_COUNTER_TCP_SOCKETS);
+
+	// just in case
+	if (_tcpSockets < 0)
+	{
+		_tcpSockets = 0;
+	}
+
 	tcpSockets = _tcpSockets;
 	_mutex.unlock();
 	LOG4CXX_TRACE(logger, "TCP file descriptor counter of " << tcpSockets
-			<< " obtained and reset");
+			<< " obtained");
 	return tcpSockets;
 }
 
@@ -467,8 +642,7 @@ uint32_t Statistics::txHttpBytes()
 {
 	uint32_t txHttpBytes = 0;
 	_mutex.lock();
-	txHttpBytes = _txHttpBytes;
-	_txHttpBytes = 0;
+	txHttpBytes = _collect(STATISTICS_COUNTER_TX_HTTP_BYTES);
 	_mutex.unlock();
 	LOG4CXX_TRACE(logger, "TX HTTP bytes counter of " << txHttpBytes
 			<< " obtained and counter reset");
@@ -477,19 +651,16 @@ uint32_t Statistics::txHttpBytes()
 
 void Statistics::txHttpBytes(int *txBytes)
 {
-	_mutex.lock();
-	_txHttpBytes += *txBytes;
+	_add(STATISTICS_COUNTER_TX_HTTP_BYTES, *txBytes);
 	LOG4CXX_TRACE(logger, "TX HTTP bytes counter increased by " << *txBytes
-			<< " to " << _txHttpBytes << " bytes");
-	_mutex.unlock();
+			<< " bytes");
 }
 
 uint32_t Statistics::txIpBytes()
 {
 	uint32_t txIpBytes = 0;
 	_mutex.lock();
-	txIpBytes = _txIpBytes;
-	_txIpBytes = 0;
+	txIpBytes = _collect(STATISTICS_COUNTER_TX_IP_BYTES);
 	_mutex.unlock();
 	LOG4CXX_TRACE(logger, "TX IP bytes counter of " << txIpBytes
 			<< " obtained and counter reset");
@@ -498,11 +669,9 @@ uint32_t Statistics::txIpBytes()
 
 void Statistics::txIpBytes(int *txBytes)
 {
-	_mutex.lock();
-	_txIpBytes += *txBytes;
+	_add(STATISTICS_COUNTER_TX_IP_BYTES, *txBytes);
 	LOG4CXX_TRACE(logger, "TX IP bytes counter increased by " << *txBytes
-			<< " to " << _txIpBytes << " bytes");
-	_mutex.unlock();
+			<< " bytes");
 }
 
 uint32_t Statistics::averageChannelAcquisitionTime()
@@ -530,12 +699,16 @@ uint32_t Statistics::averageChannelAcquisitionTime()
     return 0;
 }
 
+histogram_percentiles_t Statistics::channelAcquisitionTimes()
+{
+    return _channelAcquisitionTimes.percentiles();
+}
+
 uint32_t Statistics::counterRxIGMPBytes()
 {
     uint32_t rxBytes;
     _mutex.lock();
-    rxBytes = _rxIGMPBytes;
-    _rxIGMPBytes = 0;
+    rxBytes = _collect(STATISTICS_COUNTER_RX_IGMP_BYTES);
     _mutex.unlock();
     return rxBytes;
 }
@@ -544,14 +717,14 @@ uint32_t Statistics::counterTxIGMPBytes()
 {
     uint32_t txBytes;
     _mutex.lock();
-    txBytes = _txIGMPBytes;
-    _txIGMPBytes = 0;
+    txBytes = _collect(STATISTICS_COUNTER_TX_IGMP_BYTES);
     _mutex.unlock();
     return txBytes;
 }
  
 void Statistics::channelAcquisitionTime(uint32_t mcastGrpAddr, uint32_t channelAcquisitionTime)
 {
+    _channelAcquisitionTimes.record(channelAcquisitionTime);
     _mutex.lock();
 
     auto _channelAcquisitionTimeIt = _channelAcquisitionTime.find(mcastGrpAddr);
@@ -573,15 +746,88 @@ void Statistics::channelAcquisitionTime(uint32_t mcastGrpAddr, uint32_t channelA
 
 void Statistics::rxIGMPBytes(uint32_t rxBytes)
 {
-    _mutex.lock();
-    _rxIGMPBytes += rxBytes;
-    _mutex.unlock();
+    _add(STATISTICS_COUNTER_RX_IGMP_BYTES, rxBytes);
 }
 
 void Statistics::txIGMPBytes(uint32_t txBytes)
 {
-    _mutex.lock();
-    _txIGMPBytes += txBytes;
-    _mutex.unlock();
+    _add(STATISTICS_COUNTER_TX_IGMP_BYTES, txBytes);
+}
+
+void Statistics::_add(statistics_counters_t counter, uint64_t value)
+{
+	std::atomic<uint64_t> &shardCounter = _shard()->counters[counter];
+	// single writer: no read-modify-write needed
+	shardCounter.store(shardCounter.load(std::memory_order_relaxed) + value,
+			std::memory_order_relaxed);
+}
+
+uint64_t Statistics::_collect(statistics_counters_t counter)
+{
+	uint64_t value = 0;
+	uint64_t current;
+	list<statistics_shard_t *>::iterator shardsIt;
+
+	for (shardsIt = _shards.begin(); shardsIt != _shards.end(); shardsIt++)
+	{
+		current = (*shardsIt)->counters[counter].load(
+				std::memory_order_relaxed);
+		value += current - (*shardsIt)->reported[counter];
+		(*shardsIt)->reported[counter] = current;
+	}
+
+	return value;
+}
+
+statistics_shard_t *Statistics::_shard()
+{
+	list<statistics_shard_t *>::iterator shardsIt;
+	statistics_shard_t *shard = NULL;
+
+	if (statisticsThread.statistics == this)
+	{
+		return statisticsThread.shard;
+	}
+
+	// first update of this thread (or of another Statistics instance)
+	if (statisticsThread.shard != NULL)
+	{
+		statisticsThread.shard->owned.store(false, std::memory_order_release);
+	}
+
+	_mutex.lock();
+
+	for (shardsIt = _shards.begin(); shardsIt != _shards.end(); shardsIt++)
+	{
+		bool owned = false;
+
+		if ((*shardsIt)->owned.compare_exchange_strong(owned, true,
+				std::memory_order_acquire))
+		{
+			shard = *shardsIt;
+			break;
+		}
+	}
+
+	if (shard == NULL)
+	{
+		shard = new statistics_shard_t;
+
+		for (uint8_t i = 0; i < STATISTICS_COUNTERS; i++)
+		{
+			shard->counters[i].store(0, std::memory_order_relaxed);
+			shard->reported[i] = 0;
+		}
+
+		shard->owned.store(true, std::memory_order_relaxed);
+		_shards.push_back(shard);
+		LOG4CXX_TRACE(logger, "Statistics shard number " << _shards.size()
+				<< " created");
+	}
+
+	_mutex.unlock();
+	statisticsThread.statistics = this;
+	statisticsThread.shard = shard;
+	return shard;
 }
 
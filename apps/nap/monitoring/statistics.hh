@@ -22,12 +22,16 @@
 #ifndef NAP_MONITORING_STATISTICS_HH_
 #define NAP_MONITORING_STATISTICS_HH_
 
-#include <forward_list>
+#include <atomic>
+#include <list>
 #include <log4cxx/logger.h>
 #include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 
+#include <monitoring/histogram.hh>
 #include <monitoring/monitoringtypedefs.hh>
+#include <types/enumerations.hh>
 #include <types/icnid.hh>
 
 #ifdef DMALLOC
@@ -35,11 +39,40 @@
 #endif
 
 using namespace log4cxx;
+using namespace monitoring::histogram;
 
 namespace monitoring {
 
 namespace statistics {
 
+/*!
+ * \brief Statistics counters updated by a single thread
+ *
+ * Only the owning thread writes the counters, so that updating them requires
+ * neither a lock nor an atomic read-modify-write. The counters only ever grow;
+ * the collector remembers what it has read before and takes the difference.
+ */
+struct statistics_shard_t
+{
+	std::atomic<uint64_t> counters[STATISTICS_COUNTERS];/*!< Written by the
+	owning thread only */
+	uint64_t reported[STATISTICS_COUNTERS];/*!< Counter values already
+	obtained by the collector. Guarded by the statistics mutex */
+	unordered_set<uint32_t> ipEndpoints;/*!< IP endpoints this thread has
+	already added. Accessed by the owning thread only */
+	unordered_map<uint32_t, Histogram *> roundTripTimes;/*!< RTT histograms
+	this thread has already looked up. Accessed by the owning thread only */
+	std::atomic<bool> owned;/*!< A running thread owns this shard */
+};
+
+/*!
+ * \brief Counters and samples reported by the collector
+ *
+ * Counters updated on the packet path live in one shard per thread and are
+ * only summed up when the collector asks for them (every molyInterval). A
+ * shard is handed on to the next thread once its owner has ended. Values
+ * which are reported as a distribution (RTTs) are recorded in histograms.
+ */
 class Statistics {
 	static LoggerPtr logger;
 public:
@@ -55,20 +88,6 @@ public:
 	 * \return The average CMC group size of this NAP as a fitted value
 	 */
 	uint32_t averageCmcGroupSize();
-	/*!
-	 * \brief Calculate the average network delay based on the RTT values
-	 * measured as reported by LTP
-	 *
-	 * This method also resets the pair in which the RTT is stored
-	 * (_roundTripTimes)
-	 *
-	 * Note, the average network delay is using a base of 0.1 by which it fits
-	 * into an unsigned integer and results in a rounded average to one decimal
-	 * point (flooring the value though).
-	 *
-	 * \return The network delay in milliseconds per FQDN as a fitted value
-	 */
-	unordered_map<uint32_t, uint16_t> averageNetworkDelayPerFqdn();
 	/*!
 	 * \brief Obtain the buffer size of the HTTP handler (requests)
 	 *
@@ -127,6 +146,24 @@ public:
 	 * \param cmcGroupSize The CMC group size which should be recorded
 	 */
 	void cmcGroupSize(uint32_t cmcGroupSize);
+	/*!
+	 * \brief Obtain the usage of the HTTP response cache and reset it
+	 *
+	 * \return The counters since the last call
+	 */
+	http_cache_statistics_t httpCache();
+	/*!
+	 * \brief Record the outcome of a lookup in the HTTP response cache
+	 *
+	 * \param lookup Whether the request was a hit, coalesced or a miss
+	 */
+	void httpCache(http_cache_lookup_t lookup);
+	/*!
+	 * \brief Add response bytes served without requesting them over ICN
+	 *
+	 * \param bytes The number of bytes
+	 */
+	void httpCacheBytesSaved(uint32_t bytes);
 	/*!
 	 * \brief Obtain the number of HTTP request and their FQDN which have
 	 * traversed the NAP
@@ -142,6 +179,38 @@ public:
 	 * \param numberOfRequests The number of HTTP requests
 	 */
 	void httpRequestsPerFqdn(string fqdn, uint32_t numberOfRequests);
+	/*!
+	 * \brief Obtain the depths of the ICN worker queues and reset them
+	 *
+	 * \return The samples since the last call, one entry per worker
+	 */
+	icn_event_queues_t icnEventQueues();
+	/*!
+	 * \brief Record the depth of an ICN worker queue
+	 *
+	 * \param queue The worker the queue belongs to
+	 * \param depth The number of events waiting in the queue
+	 */
+	void icnEventQueue(uint16_t queue, uint32_t depth);
+	/*!
+	 * \brief Obtain the occupancy of and drops in the IP handler buffer and
+	 * reset them
+	 *
+	 * \return The statistics since the last call
+	 */
+	ip_buffer_statistics_t ipBuffer();
+	/*!
+	 * \brief Record the occupancy of the IP handler buffer
+	 *
+	 * \param bytes The number of bytes currently buffered
+	 */
+	void ipBuffer(uint32_t bytes);
+	/*!
+	 * \brief Record a packet dropped from the IP handler buffer
+	 *
+	 * \param packetSize The size of the packet
+	 */
+	void ipBufferDrop(uint16_t packetSize);
 	/*!
 	 * \brief Add an IP endpoint to the list of known endpoints
 	 *
@@ -176,6 +245,17 @@ public:
 	 * \return The list of IP endpoints
 	 */
 	ip_endpoints_t ipEndpoints();
+	/*!
+	 * \brief Obtain the network delay per FQDN based on the RTT values
+	 * reported by LTP and reset the RTT histograms of all FQDNs
+	 *
+	 * The network delay is half the median RTT. Note, the delay is using a
+	 * base of 0.1 by which it fits into an unsigned integer.
+	 *
+	 * \return The network delay in milliseconds per hashed FQDN as a fitted
+	 * value. FQDNs without an RTT since the last call are omitted
+	 */
+	unordered_map<uint32_t, uint16_t> networkDelayPerFqdn();
 	/*!
 	 * \brief Update the RTT counter for a particular FQDN
 	 *
@@ -183,6 +263,12 @@ public:
 	 * \param rtt The RTT which should be recorded
 	 */
 	void roundTripTime(IcnId cid, uint16_t rtt);
+	/*!
+	 * \brief Obtain the distribution of the RTTs of all FQDNs and reset it
+	 *
+	 * \return The RTT percentiles in milliseconds
+	 */
+	histogram_percentiles_t roundTripTimes();
 	/*!
 	 * \brief Obtain the number of received HTTP bytes and reset the bytes
 	 * counter
@@ -209,6 +295,20 @@ public:
 	 * \param rxBytes The number of transmitted bytes
 	 */
 	void rxIpBytes(uint16_t *rxBytes);
+	/*!
+	 * \brief Obtain the usage of the TCP client connection pool and reset it
+	 *
+	 * \return pair<HTTP requests which required a connection, requests served
+	 * by a pooled connection>
+	 */
+	pair<uint32_t, uint32_t> tcpClientPool();
+	/*!
+	 * \brief Record whether a TCP client connection was taken from the pool
+	 *
+	 * \param hit True if a pooled connection was used, false if a new one had
+	 * to be established
+	 */
+	void tcpClientPool(bool hit);
 	/*!
 	 * \brief Update the TCP socket count
 	 *
@@ -257,6 +357,13 @@ public:
      * interval
      */
     uint32_t averageChannelAcquisitionTime();
+    /*!
+     * \brief Obtain the distribution of the channel acquisition times of all
+     * multicast groups and reset it
+     *
+     * \return The channel acquisition time percentiles (x10000 in seconds)
+     */
+    histogram_percentiles_t channelAcquisitionTimes();
     /*!
      * \brief the counted number of bytes over the configured reporting
      * interval
@@ -302,7 +409,11 @@ public:
      */
     void txIGMPBytes(uint32_t _txBytes);
 private:
-	std::mutex _mutex;
+	std::mutex _mutex;/*!< Mutex for all members below except the
+	histograms */
+	list<statistics_shard_t *> _shards;/*!< Counter shards of all threads.
+	Shards are never freed, as a thread may still use its shard while the NAP
+	shuts down */
 	pair<uint32_t, uint32_t> _bufferSizeHttpHandlerRequests;/*!< pair<sum of
 	buffer sizes, number of measurements> */
 	pair<uint32_t, uint32_t> _bufferSizeHttpHandlerResponses;/*!< pair<sum of
@@ -311,30 +422,46 @@ private:
 	number of measurements> */
 	pair<uint32_t, uint32_t> _bufferSizeLtp;/*!< pair<sum of buffer sizes,
 	number of measurements> */
-	pair<uint32_t, uint32_t> _cmcGroupSizes;/*!< pair<number of CMC reports, sum
-	of all CMC group sizes */
-	unordered_map<uint32_t, forward_list<uint16_t>> _rttPerFqdn;
-	/*!< u_map<hashed FQDN, forward_list<RTT>> The list size is configurable via
-	ltpRttListSize in nap.cfg */
-	unordered_map<uint32_t, forward_list<uint16_t>>::iterator _rttPerFqdnIt;/*!<
-	iterator for _rttPerFqdn*/
+	icn_event_queues_t _icnEventQueues;/*!< Sampled depths of the ICN worker
+	queues */
+	uint32_t _ipBufferBytes;/*!< Last sampled IP handler buffer occupancy */
+	uint32_t _ipBufferMaxBytes;/*!< Largest sample since the last report */
 	http_requests_per_fqdn_t _httpRequestsPerFqdn; /*!< pair<fqdn, number of HTTP
 	requests> */
 	ip_endpoints_t _ipEndpoints;/*!< List if IP	endpoints with their IP
 	addresses as the key */
-	uint32_t _rxHttpBytes;/*!< Counting the number of bytes received at the HTTP
-	handler from IP endpoints */
-	uint32_t _rxIpBytes;/*!< Counting the number of bytes received at the IP
-	handler from IP endpoints */
-	uint16_t _tcpSockets;/*!< Counting the number of active TCP sockets*/
-	uint32_t _txHttpBytes;/*!< Counting the number of bytes transmitted in the
-	HTTP handler from IP endpoints */
-	uint32_t _txIpBytes;/*!< Counting the number of bytes transmitted in the IP
-	handler from IP endpoints */
+	Histogram _channelAcquisitionTimes;/*!< Channel acquisition times of all
+	multicast groups */
+	Histogram _roundTripTimes;/*!< RTTs of all FQDNs */
+	unordered_map<uint32_t, Histogram *> _roundTripTimesPerFqdn;/*!<
+	u_map<hashed FQDN, RTT histogram>. Histograms are never removed */
+	int32_t _tcpSockets;/*!< Number of active TCP sockets*/
 	unordered_map<uint32_t, uint32_t>::iterator _channelAcquisitionTimeIt; /*!< Channel Acquisition Time (expected as x10000 in seconds) in a cNAP*/
 	unordered_map<uint32_t, uint32_t> _channelAcquisitionTime; /*!< Channel Acquisition Time (expected as x10000 in seconds) in a cNAP*/
-	uint32_t _rxIGMPBytes; /*!< number of incoming bytes in a sNAP*/
-	uint32_t _txIGMPBytes; /*!< number of incoming bytes in a sNAP*/
+	/*!
+	 * \brief Add to a counter in the calling thread's shard
+	 *
+	 * \param counter The counter
+	 * \param value The value to be added
+	 */
+	void _add(statistics_counters_t counter, uint64_t value);
+	/*!
+	 * \brief Sum up a counter over all shards since the last call
+	 *
+	 * The caller must hold _mutex.
+	 *
+	 * \param counter The counter
+	 *
+	 * \return The value the counter has grown by
+	 */
+	uint64_t _collect(statistics_counters_t counter);
+	/*!
+	 * \brief Obtain the calling thread's shard
+	 *
+	 * The first call of a thread takes over a shard whose owner has ended or
+	 * creates a new one.
+	 */
+	statistics_shard_t *_shard();
 };
 
 } /* namespace statistics */
@@ -27,11 +27,14 @@ LoggerPtr HttpBufferCleaner::logger(Logger::getLogger("cleaners.httpbuffer"));
 
 HttpBufferCleaner::HttpBufferCleaner(Configuration &configuration,
 		Statistics &statistics, packet_buffer_requests_t &bufferRequests,
-		std::mutex &mutexRequests,
+		packet_buffer_requests_expiry_t &expiryRequests,
+		uint32_t &packetsRequests, std::mutex &mutexRequests,
 		bool *run)
 	: _configuration(configuration),
 	  _statistics(statistics),
 	  _bufferRequests(bufferRequests),
+	  _expiryRequests(expiryRequests),
+	  _packetsRequests(packetsRequests),
 	  _mutexRequests(mutexRequests),
 	  _run(run)
 {}
@@ -55,59 +58,45 @@ void HttpBufferCleaner::operator()()
 
 void HttpBufferCleaner::_cleanUpRequests()
 {
-	map<uint32_t, request_packet_t>::iterator packetBufferiSubIdIt;
-	boost::posix_time::ptime currentTime;
-	boost::posix_time::time_duration packetAge;
-	IcnId iSubCId;
+	vector<packet_buffer_requests_expiry_t::expired_t> expired;
+	map<cid_t, request_packet_t>::iterator packetBufferiSubIdIt;
 	uint32_t bufferSize = 0;//number of packets
 	_mutexRequests.lock();
-	currentTime = boost::posix_time::microsec_clock::local_time();
+	_expiryRequests.expire(expired);
 
-	// Iterate over the CIDs
-	for (_bufferRequestsIt = _bufferRequests.begin();
-			_bufferRequestsIt != _bufferRequests.end(); _bufferRequestsIt++)
+	for (vector<packet_buffer_requests_expiry_t::expired_t>::iterator it =
+			expired.begin(); it != expired.end(); it++)
 	{
-		//now iterate over the iSub CIDs to find buffered packets
-		packetBufferiSubIdIt = _bufferRequestsIt->second.begin();
+		_bufferRequestsIt = _bufferRequests.find(it->first >> 32);
 
-		while (packetBufferiSubIdIt != _bufferRequestsIt->second.end())
+		if (_bufferRequestsIt == _bufferRequests.end())
 		{
-			packetAge = currentTime -
-					(*packetBufferiSubIdIt).second.timestamp;
-			bufferSize++;
-
-			// packet timed out
-			if ((uint32_t)packetAge.seconds() > (ENIGMA * ENIGMA))
-			{
-				LOG4CXX_DEBUG(logger, "Packet of length "
-						<< packetBufferiSubIdIt->second.packetSize
-						<< " to be published under "
-						<< packetBufferiSubIdIt->second.cId.print()
-						<< " with iSub CID "
-						<< packetBufferiSubIdIt->second.rCId.print()
-						<< " deleted from HTTP buffer");
-				iSubCId = packetBufferiSubIdIt->second.rCId;
-				free(packetBufferiSubIdIt->second.packet);
-				_bufferRequestsIt->second.erase(packetBufferiSubIdIt);
-				// Reset iSub map iterator
-				packetBufferiSubIdIt = _bufferRequestsIt->second.begin();
-			}
-			else
-			{
-				LOG4CXX_TRACE(logger, "Packet of length "
-						<< packetBufferiSubIdIt->second.packetSize
-						<< " to be published under "
-						<< packetBufferiSubIdIt->second.cId.print()
-						<< " with rCID "
-						<< packetBufferiSubIdIt->second.rCId.print()
-						<< " is only " << packetAge.seconds() << "s old. "
-						"Thus, it doesn't have to be deleted");
-				packetBufferiSubIdIt++;
-			}
+			continue;
 		}
 
+		packetBufferiSubIdIt = _bufferRequestsIt->second.find(
+				(cid_t)it->first);
+
+		// packet has been deleted or replaced in the meantime
+		if (packetBufferiSubIdIt == _bufferRequestsIt->second.end() ||
+				packetBufferiSubIdIt->second.expiry != it->second)
+		{
+			continue;
+		}
+
+		LOG4CXX_DEBUG(logger, "Packet of length "
+				<< packetBufferiSubIdIt->second.packetSize
+				<< " to be published under "
+				<< packetBufferiSubIdIt->second.cId.print()
+				<< " with iSub CID "
+				<< packetBufferiSubIdIt->second.rCId.print()
+				<< " deleted from HTTP buffer");
+		free(packetBufferiSubIdIt->second.packet);
+		_bufferRequestsIt->second.erase(packetBufferiSubIdIt);
+		_packetsRequests--;
+
 		// iSub CID map is empty -> delete
-		if (_bufferRequestsIt->second.size() == 0)
+		if (_bufferRequestsIt->second.empty())
 		{
 			LOG4CXX_DEBUG(logger, "Deleted entire map for rCID "
 					<< _bufferRequestsIt->first << " too (sorry, only rCID hash"
@@ -116,6 +105,7 @@ void HttpBufferCleaner::_cleanUpRequests()
 		}
 	}
 
+	bufferSize = _packetsRequests;
 	_mutexRequests.unlock();
 	_statistics.bufferSizeHttpHandlerRequests(bufferSize);
 }
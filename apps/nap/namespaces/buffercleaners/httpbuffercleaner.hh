@@ -44,6 +44,9 @@ namespace cleaners {
 namespace httpbuffer {
 /*!
  * \brief HTTP buffer cleaner
+ *
+ * Requests are scheduled on an expiry wheel when they are buffered, so a run
+ * of the cleaner only visits requests which have timed out.
  */
 class HttpBufferCleaner {
 	static LoggerPtr logger;
@@ -54,6 +57,10 @@ public:
 	 * \param configuration Reference to class Configuration
 	 * \param statistics Reference to class Statistics
 	 * \param bufferRequests Reference to HTTP request buffer
+	 * \param expiryRequests Reference to the expiry index of the HTTP request
+	 * buffer
+	 * \param packetsRequests Reference to the number of packets in the HTTP
+	 * request buffer
 	 * \param mutexRequests Reference to HTTP request buffer mutex
 	 * \param bufferResponses Reference to HTTP response buffer
 	 * \param mutexResposnes Reference to HTTP response buffer mutex
@@ -61,7 +68,8 @@ public:
 	 */
 	HttpBufferCleaner(Configuration &configuration, Statistics &statistics,
 			packet_buffer_requests_t &bufferRequests,
-			std::mutex &mutexRequests,
+			packet_buffer_requests_expiry_t &expiryRequests,
+			uint32_t &packetsRequests, std::mutex &mutexRequests,
 			//packet_buffer_responses_t &bufferResponses,
 			//std::mutex &mutexResposnes,
 			bool *run);
@@ -80,6 +88,9 @@ private:
 	HTTP requests messages to be published  */
 	packet_buffer_requests_t::iterator _bufferRequestsIt;/*!<
 	Iterator for _packetBuffer map */
+	packet_buffer_requests_expiry_t &_expiryRequests;/*!< Expiry index of
+	_bufferRequests */
+	uint32_t &_packetsRequests;/*!< Number of packets in _bufferRequests */
 	std::mutex &_mutexRequests;/*!< Reference to HTTP requests packet buffer
 	mutex */
 	//packet_buffer_responses_t &_bufferResponses; /*!< Buffer for
@@ -22,15 +22,11 @@
 #ifndef NAP_NAMESPACES_BUFFERCLEANERS_IPBUFFERCLEANER_HH_
 #define NAP_NAMESPACES_BUFFERCLEANERS_IPBUFFERCLEANER_HH_
 
-#include <boost/date_time.hpp>
 #include <log4cxx/logger.h>
-#include <mutex>
-#include <unordered_map>
 
 #include <configuration.hh>
 #include <monitoring/statistics.hh>
-#include <namespaces/iptypedef.hh>
-#include <types/icnid.hh>
+#include <namespaces/ippacketbuffer.hh>
 
 #ifdef DMALLOC
 #include "dmalloc.h"
@@ -41,6 +37,7 @@
 
 using namespace configuration;
 using namespace monitoring::statistics;
+using namespace namespaces::ip;
 using namespace std;
 
 namespace cleaners {
@@ -48,6 +45,10 @@ namespace cleaners {
 namespace ipbuffer {
 /*!
  * \brief Implementation of the IP handler buffer cleaner
+ *
+ * The buffer schedules every CID on an expiry wheel when a packet is buffered
+ * for it, so a run of the cleaner only visits CIDs which have timed out. After
+ * each run the occupancy of the buffer is reported to Statistics.
  */
 class IpBufferCleaner
 {
@@ -55,9 +56,14 @@ static log4cxx::LoggerPtr logger;
 public:
 	/*!
 	 * \brief Constructor
+	 *
+	 * \param buffer Reference to the IP packet buffer
+	 * \param configuration Reference to class Configuration
+	 * \param statistics Reference to class Statistics
+	 * \param run Stop thread (SIG* received)
 	 */
-	IpBufferCleaner(void *buffer, void *bufferMutex,
-			Configuration &configuration, Statistics &statistics, bool *run);
+	IpBufferCleaner(IpPacketBuffer &buffer, Configuration &configuration,
+			Statistics &statistics, bool *run);
 	/*!
 	 * \brief Destructor
 	 */
@@ -67,13 +73,10 @@ public:
 	 */
 	void operator()();
 private:
-	packet_buffer_t *_buffer;
-	packet_buffer_t::iterator _bufferIt;/*!<
-	Iterator for buffer map */
+	IpPacketBuffer &_buffer;/*!< Reference to IP packet buffer */
 	Configuration &_configuration;/*!< Reference to configuration class */
 	Statistics &_statistics;/*!< Reference to statistics class */
 	bool *_run;/*!< from main thread is any SIG* had been caught */
-	std::mutex *_mutex;/*!< Reference to IP packet buffer mutex */
 };
 
 } /* namespace ipbuffer */
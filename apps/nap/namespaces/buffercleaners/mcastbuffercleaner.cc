@@ -0,0 +1,79 @@
+/*
+ * mcastbuffercleaner.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcastbuffercleaner.hh"
+
+using namespace cleaners::mcastbuffer;
+using namespace log4cxx;
+
+LoggerPtr McastBufferCleaner::logger(Logger::getLogger("cleaners.mcastbuffer"));
+
+McastBufferCleaner::McastBufferCleaner(packet_buffer_t &buffer,
+		packet_buffer_expiry_t &expiryWheel, std::mutex &bufferMutex,
+		Configuration &configuration, bool *run)
+	: _buffer(buffer),
+	  _expiryWheel(expiryWheel),
+	  _mutex(bufferMutex),
+	  _configuration(configuration),
+	  _run(run)
+{}
+
+McastBufferCleaner::~McastBufferCleaner() {}
+
+void McastBufferCleaner::operator()()
+{
+	LOG4CXX_DEBUG(logger, "Starting multicast buffer cleaner with interval of "
+			<< _configuration.bufferCleanerInterval() << "s");
+	vector<packet_buffer_expiry_t::expired_t> expired;
+	packet_buffer_t::iterator bufferIt;
+
+	while (*_run)
+	{
+		expired.clear();
+		_mutex.lock();
+		_expiryWheel.expire(expired);
+
+		for (vector<packet_buffer_expiry_t::expired_t>::iterator it =
+				expired.begin(); it != expired.end(); it++)
+		{
+			bufferIt = _buffer.find(it->first);
+
+			// packet has been published or replaced in the meantime
+			if (bufferIt == _buffer.end() ||
+					bufferIt->second.second.expiry != it->second)
+			{
+				continue;
+			}
+
+			LOG4CXX_DEBUG(logger, "Packet of length "
+					<< bufferIt->second.second.packetSize << " to be "
+					"published under " << bufferIt->second.first.print()
+					<< " deleted from multicast buffer");
+			free(bufferIt->second.second.packet);
+			_buffer.erase(bufferIt);
+		}
+
+		_mutex.unlock();
+		sleep(_configuration.bufferCleanerInterval());
+	}
+
+	LOG4CXX_DEBUG(logger, "Multicast buffer cleaner thread stopped");
+}
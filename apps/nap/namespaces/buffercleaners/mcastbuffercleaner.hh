@@ -0,0 +1,88 @@
+/*
+ * mcastbuffercleaner.hh
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAP_NAMESPACES_BUFFERCLEANERS_MCASTBUFFERCLEANER_HH_
+#define NAP_NAMESPACES_BUFFERCLEANERS_MCASTBUFFERCLEANER_HH_
+
+#include <boost/date_time.hpp>
+#include <log4cxx/logger.h>
+#include <mutex>
+#include <unordered_map>
+
+#include <configuration.hh>
+#include <namespaces/mcasttypedef.hh>
+#include <types/icnid.hh>
+
+#ifdef DMALLOC
+#include "dmalloc.h"
+#endif
+
+using namespace configuration;
+using namespace std;
+
+namespace cleaners {
+
+namespace mcastbuffer {
+/*!
+ * \brief Implementation of the multicast handler buffer cleaner
+ *
+ * The buffer owner schedules every packet on an expiry wheel when it is
+ * buffered, so a run of the cleaner only visits packets which have timed out.
+ */
+class McastBufferCleaner
+{
+static log4cxx::LoggerPtr logger;
+public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param buffer Reference to the multicast packet buffer
+	 * \param expiryWheel Reference to the expiry index of the buffer
+	 * \param bufferMutex Reference to the mutex guarding buffer and expiry
+	 * index
+	 * \param configuration Reference to class Configuration
+	 * \param run Stop thread (SIG* received)
+	 */
+	McastBufferCleaner(packet_buffer_t &buffer,
+			packet_buffer_expiry_t &expiryWheel, std::mutex &bufferMutex,
+			Configuration &configuration, bool *run);
+	/*!
+	 * \brief Destructor
+	 */
+	~McastBufferCleaner();
+	/*!
+	 * \brief Functor to place this into a thread
+	 */
+	void operator()();
+private:
+	packet_buffer_t &_buffer;/*!< Reference to multicast packet buffer */
+	packet_buffer_expiry_t &_expiryWheel;/*!< Reference to the expiry index
+	of the multicast packet buffer */
+	std::mutex &_mutex;/*!< Reference to multicast packet buffer mutex */
+	Configuration &_configuration;/*!< Reference to configuration class */
+	bool *_run;/*!< from main thread is any SIG* had been caught */
+};
+
+} /* namespace mcastbuffer */
+
+} /* namespace cleaners */
+
+#endif /* NAP_NAMESPACES_BUFFERCLEANERS_MCASTBUFFERCLEANER_HH_ */
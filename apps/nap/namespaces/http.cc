@@ -36,11 +36,15 @@ Http::Http(Blackadder *icnCore, Configuration &configuration,
 	  _configuration(configuration),
 	  _transport(transport),
 	  _statistics(statistics),
-	  _run(run)
+	  _run(run),
+	  _httpCache(configuration, statistics),
+	  _packetBufferRequestsExpiry(ENIGMA * ENIGMA),
+	  _packetBufferRequestsPackets(0)
 {
 	// Initialising HTTP buffer cleaner
 	HttpBufferCleaner httpBufferCleaner(_configuration, _statistics,
-			_packetBufferRequests, _packetBufferRequestsMutex,
+			_packetBufferRequests, _packetBufferRequestsExpiry,
+			_packetBufferRequestsPackets, _packetBufferRequestsMutex,
 			//_packetBufferResponses, _packetBufferResponsesMutex,
 			_run);
 	std::thread *httpBufferThread = new std::thread(httpBufferCleaner);
@@ -92,6 +96,12 @@ void Http::deleteSessionKey(sk_t &sessionKey)
 {
 	map<enigma_t, list<socket_fd_t>>::iterator enigmaIt;
 	list<socket_fd_t>::iterator socketFdIt;
+
+	if (_configuration.httpCacheSize() > 0)
+	{
+		_httpCache.deleteSocket(sessionKey);
+	}
+
 	_ipEndpointSessionsMutex.lock();
 	_ipEndpointSessionsIt = _ipEndpointSessions.begin();
 
@@ -273,7 +283,7 @@ void Http::closeCmcGroup(IcnId rCid, enigma_t enigma, sk_t sessionKey)
 
 void Http::handleRequest(string &fqdn, string &resource,
 		http_methods_t httpMethod, uint8_t *packet, uint16_t &packetSize,
-		socket_fd_t socketFd)
+		socket_fd_t socketFd, bool cacheable)
 {
 	enigma_t enigma;
 	_statistics.httpRequestsPerFqdn(fqdn, 1);
@@ -282,6 +292,14 @@ void Http::handleRequest(string &fqdn, string &resource,
 	IcnId cId(fqdn);
 	IcnId rCId(fqdn, resource);
 	enigma = 23;
+
+	// Served from the cache or by an identical request already published
+	if (cacheable && _configuration.httpCacheSize() > 0 &&
+			_httpCache.lookup(rCId, socketFd) != HTTP_CACHE_LOOKUP_MISS)
+	{
+		return;
+	}
+
 	// Add rCID and session to known list of IP endpoint sessions
 	_addIpEndpointSession(rCId, enigma, socketFd);
 	// Buffer packet in any case (incl. DNSlocal)
@@ -456,6 +474,12 @@ void Http::endSession(IcnId &rCid, enigma_t &enigma, sk_t &sessionKey)
 	map<enigma_t, list<socket_fd_t>>::iterator enigmaIt;
 	IcnId cid;
 
+	// store the response before its socket gets shut down
+	if (_configuration.httpCacheSize() > 0)
+	{
+		_httpCache.complete(rCid);
+	}
+
 	// delete HTTP request packets from HTTP packet buffer if CID is still known
 	if (_transport.Lightweight::cidLookup(rCid, cid))
 	{
@@ -846,6 +870,13 @@ void Http::sendToEndpoint(IcnId &rCid, uint32_t &enigma, uint8_t *packet,
 	list<socket_fd_t>::reverse_iterator socketFdIt;
 	map<enigma_t, list<socket_fd_t>>::iterator enigmaIt;
 	ostringstream socketFds;
+
+	// attached IP endpoints get their copy
+	if (_configuration.httpCacheSize() > 0)
+	{
+		_httpCache.response(rCid, packet, packetSize);
+	}
+
 	uint8_t *p = (uint8_t *)malloc(packetSize);
 	memcpy(p, packet, packetSize);
 	// First get the socket FD for this IP endpoints (multiple possible!)
@@ -1075,11 +1106,14 @@ void Http::_bufferRequest(IcnId &cId, IcnId &rCId, enigma_t &enigma,
 		packetDescription.packetSize = packetSize;
 		packetDescription.timestamp =
 				boost::posix_time::second_clock::local_time();
+		packetDescription.expiry = _packetBufferRequestsExpiry.schedule(
+				((uint64_t)cId.uint() << 32) | rCId.uint(), ENIGMA * ENIGMA);
 		map<uint32_t, request_packet_t> rCIdMap;
 		rCIdMap.insert(pair<uint32_t, request_packet_t>(rCId.uint(),
 				packetDescription));
 		_packetBufferRequests.insert(pair<uint32_t,map<uint32_t,
 				request_packet_t>>(cId.uint(), rCIdMap));
+		_packetBufferRequestsPackets++;
 		LOG4CXX_TRACE(logger, "Packet for new CID " << cId.print() << " (FQDN: "
 				<< cId.printFqdn() << "), rCID " << rCId.print() << " and "
 				"SK " << sessionKey <<" of length " << packetSize << " has been"
@@ -1103,8 +1137,12 @@ void Http::_bufferRequest(IcnId &cId, IcnId &rCId, enigma_t &enigma,
 			packetDescription.packetSize = packetSize;
 			packetDescription.timestamp =
 							boost::posix_time::second_clock::local_time();
+			packetDescription.expiry = _packetBufferRequestsExpiry.schedule(
+					((uint64_t)cId.uint() << 32) | rCId.uint(),
+					ENIGMA * ENIGMA);
 			(*_packetBufferRequestsIt).second.insert(pair<uint32_t,
 					request_packet_t>(rCId.uint(),packetDescription));
+			_packetBufferRequestsPackets++;
 			LOG4CXX_TRACE(logger, "Packet for existing CID " << cId.print()
 					<< " (FQDN: " << cId.printFqdn() << ") but new rCID "
 					"of length " << packetSize << " has been added to HTTP "
@@ -1125,6 +1163,10 @@ void Http::_bufferRequest(IcnId &cId, IcnId &rCId, enigma_t &enigma,
 			packetBufferIt->second.packetSize = packetSize;
 			packetBufferIt->second.timestamp =
 							boost::posix_time::second_clock::local_time();
+			packetBufferIt->second.expiry =
+					_packetBufferRequestsExpiry.schedule(
+							((uint64_t)cId.uint() << 32) | rCId.uint(),
+							ENIGMA * ENIGMA);
 			LOG4CXX_TRACE(logger, "Packet for existing rCID " << rCId.print()
 					<< " (FQDN: " << cId.printFqdn() << ") "
 					"of length " << packetSize << " has been added to HTTP "
@@ -1248,6 +1290,7 @@ void Http::_deleteBufferedRequest(IcnId &cid, IcnId &rCid, enigma_t &enigma,
 	// free memory and erase packet
 	free(rCidIt->second.packet);
 	cidIt->second.erase(rCidIt);
+	_packetBufferRequestsPackets--;
 	LOG4CXX_TRACE(logger, "HTTP request deleted from HTTP packet buffer for "
 			"CID " << cid.print() << " > rCID " << rCid.print() << " > RRID "
 			<< enigma << " > SK " << sessionKey);
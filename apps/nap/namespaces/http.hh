@@ -32,6 +32,7 @@
 
 #include <configuration.hh>
 #include <monitoring/statistics.hh>
+#include <namespaces/httpcache.hh>
 #include <namespaces/httptypedef.hh>
 #include <namespaces/buffercleaners/httpbuffercleaner.hh>
 #include <transport/transport.hh>
@@ -43,6 +44,7 @@
 using namespace configuration;
 using namespace log4cxx;
 using namespace monitoring::statistics;
+using namespace namespaces::http::httpcache;
 using namespace std;
 
 namespace namespaces
@@ -128,10 +130,12 @@ public:
 	 * \param packetSize Length of the packet
 	 * \param socketFd Socket file descriptor which will be converted to a
 	 * session key in LTP
+	 * \param cacheable Whether the response may be served from or stored in
+	 * the HTTP response cache
 	 */
 	void handleRequest(string &fqdn, string &resource,
 			http_methods_t httpMethod, uint8_t *packet, uint16_t &packetSize,
-			socket_fd_t socketFd);
+			socket_fd_t socketFd, bool cacheable = false);
 	/*!
 	 * \brief Handle HTTP responses
 	 *
@@ -275,6 +279,7 @@ private:
 	Transport &_transport;/*!< Reference to transport class */
 	Statistics &_statistics; /*<! Reference to statistics class*/
 	bool *_run;/*!< from main thread is any SIG* had been caught */
+	HttpCache _httpCache;/*!< Responses served locally in the cNAP */
 	map<cid_t, IcnId> _cIds;
 	map<cid_t, IcnId>::iterator _cIdsIt;
 	map<cid_t, IcnId> _rCIds;
@@ -301,6 +306,10 @@ private:
 	messages to be published  */
 	packet_buffer_requests_t::iterator _packetBufferRequestsIt;/*!< Iterator for
 	_packetBufferRequests map */
+	packet_buffer_requests_expiry_t _packetBufferRequestsExpiry;/*!< Expiry
+	index of _packetBufferRequests */
+	uint32_t _packetBufferRequestsPackets;/*!< Number of packets in
+	_packetBufferRequests */
 	std::mutex _packetBufferRequestsMutex;/*!< mutex for _packetBufferRequests
 	map */
 	potential_cmc_groups_t _potentialCmcGroups;/*!< List of NIDs for which an
@@ -0,0 +1,558 @@
+/*
+ * httpcache.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <errno.h>
+#include <sstream>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+
+#include "httpcache.hh"
+
+using namespace namespaces::http::httpcache;
+
+LoggerPtr HttpCache::logger(Logger::getLogger("namespaces.http.httpcache"));
+
+HttpCache::HttpCache(Configuration &configuration, Statistics &statistics)
+	: _configuration(configuration),
+	  _statistics(statistics),
+	  _size(0)
+{}
+
+HttpCache::~HttpCache() {}
+
+void HttpCache::complete(IcnId &rCid)
+{
+	http_cache_fetches_t::iterator fetchesIt;
+	http_cache_responses_t::iterator responsesIt;
+	vector<uint8_t> bytes;
+	http_cache_writes_t writes;
+	uint32_t age;
+	_mutex.lock();
+	fetchesIt = _fetches.find(rCid.uint());
+
+	if (fetchesIt == _fetches.end())
+	{
+		_mutex.unlock();
+		return;
+	}
+
+	http_cache_fetch_t &fetch = fetchesIt->second;
+
+	// endpoints attached after the last segment have not got anything yet
+	if (fetch.storing)
+	{
+		_snapshot(fetch, bytes, writes);
+	}
+
+	if (fetch.storing && fetch.headerParsed &&
+			fetch.response.size() == fetch.expectedSize &&
+			_age(fetch, age))
+	{
+		responsesIt = _responses.find(rCid.uint());
+
+		if (responsesIt != _responses.end())
+		{
+			_evict(responsesIt);
+		}
+
+		http_cache_response_t response;
+		response.response.reset(new vector<uint8_t>);
+		response.response->swap(fetch.response);
+		response.ageOffset = _stripAge(*response.response,
+				fetch.headerLength);
+		response.age = age;
+		response.stored = ExpiryWheel<cid_t>::now();
+		response.expiry = response.stored + fetch.freshness - (age -
+				fetch.age);
+		response.lru = _lru.insert(_lru.begin(), rCid.uint());
+		_size += response.response->size();
+		LOG4CXX_TRACE(logger, "HTTP response of length "
+				<< response.response->size() << " cached for rCID "
+				<< rCid.print() << " for " << fetch.freshness << "s");
+		_responses.insert(pair<cid_t, http_cache_response_t>(rCid.uint(),
+				response));
+
+		// least recently used responses make room
+		while (_size > _configuration.httpCacheSize() && !_lru.empty())
+		{
+			_evict(_responses.find(_lru.back()));
+		}
+	}
+	else
+	{
+		LOG4CXX_TRACE(logger, "HTTP response for rCID " << rCid.print()
+				<< " not cached");
+	}
+
+	_release(fetch);
+	_fetches.erase(fetchesIt);
+	_mutex.unlock();
+	_write(rCid, bytes, writes);
+}
+
+void HttpCache::deleteSocket(socket_fd_t socketFd)
+{
+	http_cache_fetches_t::iterator fetchesIt;
+	_mutex.lock();
+	fetchesIt = _fetches.begin();
+
+	while (fetchesIt != _fetches.end())
+	{
+		// nobody would end the session of the published request anymore
+		if (fetchesIt->second.socketFd == socketFd)
+		{
+			LOG4CXX_TRACE(logger, "Socket FD " << socketFd << " awaiting the "
+					"HTTP response for hashed rCID " << fetchesIt->first
+					<< " closed. " << fetchesIt->second.waiters.size()
+					<< " attached socket(s) will be detached");
+			_release(fetchesIt->second);
+			fetchesIt = _fetches.erase(fetchesIt);
+			continue;
+		}
+
+		_detach(fetchesIt->second, socketFd);
+		fetchesIt++;
+	}
+
+	_mutex.unlock();
+}
+
+http_cache_lookup_t HttpCache::lookup(IcnId &rCid, socket_fd_t socketFd)
+{
+	http_cache_lookup_t lookup = HTTP_CACHE_LOOKUP_MISS;
+	http_cache_fetches_t::iterator fetchesIt;
+	http_cache_responses_t::iterator responsesIt;
+	shared_ptr<vector<uint8_t>> response;
+	ostringstream status;
+	string statusLine;
+	uint16_t ageOffset;
+	uint32_t now = ExpiryWheel<cid_t>::now();
+	uint32_t bytesSaved = 0;
+	_mutex.lock();
+	responsesIt = _responses.find(rCid.uint());
+
+	if (responsesIt != _responses.end())
+	{
+		// signed difference survives the wrap of the clock
+		if ((int32_t)(responsesIt->second.expiry - now) > 0)
+		{
+			_lru.splice(_lru.begin(), _lru, responsesIt->second.lru);
+			// the reference keeps the bytes alive if the response gets evicted
+			// while they are written
+			response = responsesIt->second.response;
+			ageOffset = responsesIt->second.ageOffset;
+			// RFC 7234 4.2.3: the age when stored plus the time since
+			status.write((const char *)response->data(), ageOffset);
+			status << "Age: " << responsesIt->second.age + (now -
+					responsesIt->second.stored) << "\r\n";
+			statusLine = status.str();
+			_mutex.unlock();
+
+			if (_send(socketFd, (const uint8_t *)statusLine.data(),
+					statusLine.size(), MSG_MORE) && _send(socketFd,
+					response->data() + ageOffset, response->size() - ageOffset,
+					0))
+			{
+				bytesSaved = statusLine.size() + response->size() - ageOffset;
+			}
+
+			LOG4CXX_TRACE(logger, "HTTP response for rCID " << rCid.print()
+					<< " served from cache to socket FD " << socketFd);
+			_statistics.httpCache(HTTP_CACHE_LOOKUP_HIT);
+			_statistics.httpCacheBytesSaved(bytesSaved);
+			return HTTP_CACHE_LOOKUP_HIT;
+		}
+
+		LOG4CXX_TRACE(logger, "Cached HTTP response for rCID " << rCid.print()
+				<< " is stale");
+		_evict(responsesIt);
+	}
+
+	fetchesIt = _fetches.find(rCid.uint());
+
+	if (fetchesIt != _fetches.end())
+	{
+		http_cache_fetch_t &fetch = fetchesIt->second;
+
+		if (fetch.socketFd == socketFd || _attached(fetch, socketFd))
+		{
+			// the same endpoint asks again. Let it have its own request
+		}
+		else if (now - fetch.started < HTTP_CACHE_FETCH_TIMEOUT)
+		{
+			// the response received so far is known, so the endpoint can
+			// catch up with the next segment and follow it from there
+			if (fetch.storing)
+			{
+				http_cache_waiter_t waiter;
+				waiter.socketFd = socketFd;
+				waiter.sent = 0;
+				fetch.waiters.push_back(waiter);
+				lookup = HTTP_CACHE_LOOKUP_COALESCED;
+				LOG4CXX_TRACE(logger, "HTTP request from socket FD "
+						<< socketFd << " for rCID " << rCid.print()
+						<< " attached to the one of socket FD "
+						<< fetch.socketFd);
+			}
+		}
+		// the published request was lost. Start over with this one
+		else if (fetch.response.empty())
+		{
+			LOG4CXX_DEBUG(logger, "No HTTP response for rCID " << rCid.print()
+					<< " received within " << HTTP_CACHE_FETCH_TIMEOUT << "s");
+			_release(fetch);
+			_fetches.erase(fetchesIt);
+			fetchesIt = _fetches.end();
+		}
+	}
+
+	if (fetchesIt == _fetches.end())
+	{
+		http_cache_fetch_t fetch;
+		fetch.socketFd = socketFd;
+		fetch.headerParsed = false;
+		fetch.storing = true;
+		fetch.expectedSize = 0;
+		fetch.freshness = 0;
+		fetch.started = now;
+		_fetches.insert(pair<cid_t, http_cache_fetch_t>(rCid.uint(), fetch));
+	}
+
+	_mutex.unlock();
+	_statistics.httpCache(lookup);
+	return lookup;
+}
+
+void HttpCache::response(IcnId &rCid, uint8_t *packet, uint16_t packetSize)
+{
+	http_cache_fetches_t::iterator fetchesIt;
+	list<http_cache_waiter_t>::iterator waitersIt;
+	vector<uint8_t> bytes;
+	http_cache_writes_t writes;
+	_mutex.lock();
+	fetchesIt = _fetches.find(rCid.uint());
+
+	if (fetchesIt == _fetches.end())
+	{
+		_mutex.unlock();
+		return;
+	}
+
+	http_cache_fetch_t &fetch = fetchesIt->second;
+
+	if (fetch.storing)
+	{
+		fetch.response.insert(fetch.response.end(), packet,
+				packet + packetSize);
+
+		if (!fetch.headerParsed)
+		{
+			fetch.headerParsed = true;
+			_cacheable(fetch);
+		}
+
+		// the received bytes are still there, even if they are dropped below
+		_snapshot(fetch, bytes, writes);
+
+		// more than announced. Something went wrong
+		if (fetch.storing && fetch.response.size() > fetch.expectedSize)
+		{
+			fetch.storing = false;
+		}
+
+		if (!fetch.storing)
+		{
+			vector<uint8_t>().swap(fetch.response);
+		}
+	}
+	else
+	{
+		bytes.assign(packet, packet + packetSize);
+
+		for (waitersIt = fetch.waiters.begin();
+				waitersIt != fetch.waiters.end(); waitersIt++)
+		{
+			writes.push_back(pair<socket_fd_t, uint32_t>(waitersIt->socketFd,
+					0));
+		}
+	}
+
+	_mutex.unlock();
+	_write(rCid, bytes, writes);
+}
+
+bool HttpCache::_age(http_cache_fetch_t &fetch, uint32_t &age)
+{
+	int64_t apparentAge = 0;
+	int64_t responseDelay = ExpiryWheel<cid_t>::now() - fetch.started;
+
+	if (fetch.date > 0)
+	{
+		apparentAge = max<int64_t>(time(NULL) - fetch.date, 0);
+	}
+
+	// corrected_initial_age = max(apparent_age, age_value + response_delay)
+	age = min<int64_t>(max<int64_t>(apparentAge, fetch.age + responseDelay),
+			UINT32_MAX);
+
+	// the freshness has been reduced by the Age header already
+	return age - fetch.age < fetch.freshness;
+}
+
+bool HttpCache::_attached(http_cache_fetch_t &fetch, socket_fd_t socketFd)
+{
+	list<http_cache_waiter_t>::iterator waitersIt;
+
+	for (waitersIt = fetch.waiters.begin(); waitersIt != fetch.waiters.end();
+			waitersIt++)
+	{
+		if (waitersIt->socketFd == socketFd)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void HttpCache::_cacheable(http_cache_fetch_t &fetch)
+{
+	http_response_header_t header;
+	int64_t lifetime = 0;
+	fetch.storing = false;
+
+	if (!parseHttpResponse((const char *)fetch.response.data(),
+			fetch.response.size(), header) || header.headerLength == 0 ||
+			header.statusCode != HTTP_METHOD_RESPONSE_OK || header.noStore ||
+			!header.contentLengthPresent)
+	{
+		return;
+	}
+
+	fetch.expectedSize = header.headerLength + header.contentLength;
+	fetch.headerLength = header.headerLength;
+	fetch.age = header.age;
+	fetch.date = header.date;
+
+	if (fetch.expectedSize > _configuration.httpCacheObjectSize())
+	{
+		return;
+	}
+
+	// s-maxage/max-age take precedence over Expires
+	if (header.maxAge >= 0)
+	{
+		lifetime = header.maxAge;
+	}
+	else if (header.expires > 0)
+	{
+		lifetime = header.expires - (header.date > 0 ? header.date :
+				time(NULL));
+	}
+
+	lifetime -= header.age;
+
+	// no heuristic freshness
+	if (lifetime <= 0)
+	{
+		return;
+	}
+
+	// the expiry must stay comparable on the monotonic clock
+	fetch.freshness = min<int64_t>(lifetime, INT32_MAX);
+	fetch.storing = true;
+}
+
+void HttpCache::_detach(http_cache_fetch_t &fetch, socket_fd_t socketFd)
+{
+	list<http_cache_waiter_t>::iterator waitersIt = fetch.waiters.begin();
+
+	while (waitersIt != fetch.waiters.end())
+	{
+		if (waitersIt->socketFd == socketFd)
+		{
+			waitersIt = fetch.waiters.erase(waitersIt);
+			continue;
+		}
+
+		waitersIt++;
+	}
+}
+
+void HttpCache::_evict(http_cache_responses_t::iterator responsesIt)
+{
+	_size -= responsesIt->second.response->size();
+	_lru.erase(responsesIt->second.lru);
+	_responses.erase(responsesIt);
+}
+
+void HttpCache::_release(http_cache_fetch_t &fetch)
+{
+	list<http_cache_waiter_t>::iterator waitersIt;
+
+	for (waitersIt = fetch.waiters.begin(); waitersIt != fetch.waiters.end();
+			waitersIt++)
+	{
+		LOG4CXX_TRACE(logger, "Detaching socket FD " << waitersIt->socketFd
+				<< " from the HTTP request of socket FD " << fetch.socketFd);
+	}
+
+	fetch.waiters.clear();
+}
+
+bool HttpCache::_send(socket_fd_t socketFd, const uint8_t *data,
+		size_t dataSize, int flags)
+{
+	ssize_t bytesWritten;
+
+	while (dataSize > 0)
+	{
+		bytesWritten = send(socketFd, data, dataSize, flags | MSG_NOSIGNAL);
+
+		if (bytesWritten < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (bytesWritten <= 0)
+		{
+			LOG4CXX_DEBUG(logger, "HTTP response could not be sent to socket "
+					"FD " << socketFd << ": " << strerror(errno));
+			return false;
+		}
+
+		data += bytesWritten;
+		dataSize -= bytesWritten;
+	}
+
+	return true;
+}
+
+void HttpCache::_snapshot(http_cache_fetch_t &fetch, vector<uint8_t> &bytes,
+		http_cache_writes_t &writes)
+{
+	list<http_cache_waiter_t>::iterator waitersIt;
+	uint32_t from = fetch.response.size();
+
+	for (waitersIt = fetch.waiters.begin(); waitersIt != fetch.waiters.end();
+			waitersIt++)
+	{
+		from = min(from, waitersIt->sent);
+	}
+
+	// usually all endpoints miss the last segment only
+	bytes.assign(fetch.response.begin() + from, fetch.response.end());
+
+	for (waitersIt = fetch.waiters.begin(); waitersIt != fetch.waiters.end();
+			waitersIt++)
+	{
+		writes.push_back(pair<socket_fd_t, uint32_t>(waitersIt->socketFd,
+				waitersIt->sent - from));
+		waitersIt->sent = fetch.response.size();
+	}
+}
+
+void HttpCache::_write(IcnId &rCid, vector<uint8_t> &bytes,
+		http_cache_writes_t &writes)
+{
+	http_cache_fetches_t::iterator fetchesIt;
+	http_cache_writes_t::iterator writesIt;
+	list<socket_fd_t> failed;
+	list<socket_fd_t>::iterator failedIt;
+	uint32_t bytesSaved = 0;
+
+	for (writesIt = writes.begin(); writesIt != writes.end(); writesIt++)
+	{
+		if (writesIt->second == bytes.size())
+		{
+			continue;
+		}
+
+		if (!_send(writesIt->first, bytes.data() + writesIt->second,
+				bytes.size() - writesIt->second, 0))
+		{
+			failed.push_back(writesIt->first);
+			continue;
+		}
+
+		bytesSaved += bytes.size() - writesIt->second;
+	}
+
+	if (!failed.empty())
+	{
+		_mutex.lock();
+		fetchesIt = _fetches.find(rCid.uint());
+
+		if (fetchesIt != _fetches.end())
+		{
+			for (failedIt = failed.begin(); failedIt != failed.end();
+					failedIt++)
+			{
+				_detach(fetchesIt->second, *failedIt);
+			}
+		}
+
+		_mutex.unlock();
+	}
+
+	if (bytesSaved > 0)
+	{
+		_statistics.httpCacheBytesSaved(bytesSaved);
+	}
+}
+
+uint16_t HttpCache::_stripAge(vector<uint8_t> &response,
+		uint16_t headerLength)
+{
+	uint8_t *line;
+	uint8_t *lineEnd;
+	uint8_t *statusLineEnd = (uint8_t *)memchr(response.data(), '\n',
+			headerLength);
+	uint16_t ageOffset = statusLineEnd + 1 - response.data();
+	line = statusLineEnd + 1;
+
+	while (line < response.data() + headerLength)
+	{
+		lineEnd = (uint8_t *)memchr(line, '\n',
+				response.data() + headerLength - line);
+
+		if (lineEnd == NULL)
+		{
+			break;
+		}
+
+		if (lineEnd - line >= 4 && strncasecmp((const char *)line, "age:",
+				4) == 0)
+		{
+			headerLength -= lineEnd + 1 - line;
+			response.erase(response.begin() + (line - response.data()),
+					response.begin() + (lineEnd + 1 - response.data()));
+			continue;
+		}
+
+		line = lineEnd + 1;
+	}
+
+	return ageOffset;
+}
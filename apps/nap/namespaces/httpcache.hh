@@ -0,0 +1,235 @@
+/*
+ * httpcache.hh
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAP_NAMESPACES_HTTPCACHE_HH_
+#define NAP_NAMESPACES_HTTPCACHE_HH_
+
+#include <list>
+#include <log4cxx/logger.h>
+#include <mutex>
+
+#include <configuration.hh>
+#include <monitoring/statistics.hh>
+#include <namespaces/httptypedef.hh>
+#include <proxies/http/headerparser.hh>
+#include <types/enumerations.hh>
+#include <types/icnid.hh>
+#include <types/typedef.hh>
+
+#ifdef DMALLOC
+#include "dmalloc.h"
+#endif
+
+using namespace configuration;
+using namespace log4cxx;
+using namespace monitoring::statistics;
+using namespace proxies::http::headerparser;
+using namespace std;
+
+namespace namespaces
+{
+
+namespace http
+{
+
+namespace httpcache
+{
+/*!
+ * \brief Size-bounded cache of HTTP responses in the cNAP
+ *
+ * Responses are keyed by the rCID of the request, i.e. by FQDN and resource.
+ * A GET request which is found fresh in the cache is answered locally without
+ * publishing it over ICN. While the response to a cacheable request is being
+ * received, identical requests from other IP endpoints are not published
+ * either; they are attached to the request in flight and receive a copy of
+ * the response as it arrives.
+ *
+ * Only responses with status 200, a Content-Length and an explicit freshness
+ * lifetime (Cache-Control s-maxage/max-age or Expires) are stored. Responses
+ * which must not be stored by a shared cache, set cookies or vary are not.
+ * When the cache is full the least recently used responses are evicted.
+ */
+class HttpCache: public HeaderParser
+{
+	static LoggerPtr logger;
+public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param configuration Reference to class Configuration
+	 * \param statistics Reference to class Statistics
+	 */
+	HttpCache(Configuration &configuration, Statistics &statistics);
+	/*!
+	 * \brief Destructor
+	 */
+	~HttpCache();
+	/*!
+	 * \brief An ICN session for an rCID has ended
+	 *
+	 * Stores the received response if it is complete and cacheable and
+	 * detaches the IP endpoints attached to the request. Their sockets stay
+	 * with the TCP server which accepted them.
+	 *
+	 * \param rCid The rCID of the request
+	 */
+	void complete(IcnId &rCid);
+	/*!
+	 * \brief An IP endpoint has closed its socket
+	 *
+	 * Detaches the socket from requests in flight. If it was the socket whose
+	 * request has been published, the request is abandoned and the attached
+	 * sockets are detached.
+	 *
+	 * \param socketFd The socket FD of the IP endpoint
+	 */
+	void deleteSocket(socket_fd_t socketFd);
+	/*!
+	 * \brief Look up a cacheable request
+	 *
+	 * \param rCid The rCID of the request
+	 * \param socketFd The socket FD of the IP endpoint which sent it
+	 *
+	 * \return HTTP_CACHE_LOOKUP_MISS if the request must be published over ICN
+	 * as usual. Otherwise the cache takes care of the response
+	 */
+	http_cache_lookup_t lookup(IcnId &rCid, socket_fd_t socketFd);
+	/*!
+	 * \brief A segment of an HTTP response has been received over ICN
+	 *
+	 * \param rCid The rCID of the response
+	 * \param packet The segment
+	 * \param packetSize The length of the segment
+	 */
+	void response(IcnId &rCid, uint8_t *packet, uint16_t packetSize);
+private:
+	Configuration &_configuration;/*!< Reference to class Configuration */
+	Statistics &_statistics;/*!< Reference to class Statistics */
+	http_cache_fetches_t _fetches;/*!< Responses being received */
+	http_cache_responses_t _responses;/*!< Cached responses */
+	list<cid_t> _lru;/*!< rCIDs of cached responses, most recently used
+	first */
+	uint64_t _size;/*!< Sum of the lengths of all cached responses */
+	std::mutex _mutex;/*!< Mutex for all members above. Nothing is written to
+	a socket while it is held */
+	/*!
+	 * \brief Determine the age of a completely received response
+	 *
+	 * Computes the corrected initial age following RFC 7234 section 4.2.3,
+	 * using the time the request was published as request time and now as
+	 * response time.
+	 *
+	 * \param fetch The received response
+	 * \param age Set to the age in seconds
+	 *
+	 * \return False if the response is stale already
+	 */
+	bool _age(http_cache_fetch_t &fetch, uint32_t &age);
+	/*!
+	 * \brief Check whether a socket is attached to a request
+	 *
+	 * \param fetch The request
+	 * \param socketFd The socket FD of the IP endpoint
+	 */
+	bool _attached(http_cache_fetch_t &fetch, socket_fd_t socketFd);
+	/*!
+	 * \brief Determine whether and for how long a response can be cached
+	 *
+	 * \param fetch The response being received. Its first segment must have
+	 * been appended already
+	 */
+	void _cacheable(http_cache_fetch_t &fetch);
+	/*!
+	 * \brief Detach a socket from a request
+	 *
+	 * \param fetch The request
+	 * \param socketFd The socket FD of the IP endpoint
+	 */
+	void _detach(http_cache_fetch_t &fetch, socket_fd_t socketFd);
+	/*!
+	 * \brief Remove a response from the cache
+	 *
+	 * \param responsesIt The cached response
+	 */
+	void _evict(http_cache_responses_t::iterator responsesIt);
+	/*!
+	 * \brief Detach the sockets attached to a request
+	 *
+	 * \param fetch The request
+	 */
+	void _release(http_cache_fetch_t &fetch);
+	/*!
+	 * \brief Write bytes to an IP endpoint
+	 *
+	 * \param socketFd The socket FD of the IP endpoint
+	 * \param data Pointer to the bytes
+	 * \param dataSize The number of bytes
+	 * \param flags Flags passed to send() in addition to MSG_NOSIGNAL
+	 *
+	 * \return True if all bytes have been written
+	 */
+	bool _send(socket_fd_t socketFd, const uint8_t *data, size_t dataSize,
+			int flags);
+	/*!
+	 * \brief Copy the bytes of a response the attached sockets miss
+	 *
+	 * The caller must hold _mutex and the response received so far must be
+	 * kept. The attached sockets are marked as up to date.
+	 *
+	 * \param fetch The request
+	 * \param bytes Set to the bytes at least one attached socket misses
+	 * \param writes Filled with the attached sockets and the offset in bytes
+	 * from which on each of them must be written to
+	 */
+	void _snapshot(http_cache_fetch_t &fetch, vector<uint8_t> &bytes,
+			http_cache_writes_t &writes);
+	/*!
+	 * \brief Remove the Age headers of a response to be cached
+	 *
+	 * Hits send an Age header with the current age instead.
+	 *
+	 * \param response Status line, header and body
+	 * \param headerLength Length of status line and headers
+	 *
+	 * \return The offset of the end of the status line
+	 */
+	uint16_t _stripAge(vector<uint8_t> &response, uint16_t headerLength);
+	/*!
+	 * \brief Write bytes to the sockets attached to a request
+	 *
+	 * Called without _mutex held. Sockets which cannot be written to are
+	 * detached from the request.
+	 *
+	 * \param rCid The rCID of the request
+	 * \param bytes The bytes prepared by _snapshot()
+	 * \param writes The sockets and offsets prepared by _snapshot()
+	 */
+	void _write(IcnId &rCid, vector<uint8_t> &bytes,
+			http_cache_writes_t &writes);
+};
+
+} /* namespace httpcache */
+
+} /* namespace http */
+
+} /* namespace namespaces */
+
+#endif /* NAP_NAMESPACES_HTTPCACHE_HH_ */
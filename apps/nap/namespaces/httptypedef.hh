@@ -22,14 +22,21 @@
 #ifndef NAP_NAMESPACES_HTTPTYPEDEF_HH_
 #define NAP_NAMESPACES_HTTPTYPEDEF_HH_
 
+#include <list>
+#include <memory>
 #include <stack>
+#include <unordered_map>
+#include <vector>
 
 #include <types/enumerations.hh>
+#include <types/expirywheel.hh>
 #include <types/icnid.hh>
 #include <types/nodeid.hh>
 #include <types/typedef.hh>
 
 #define ENIGMA 23 // https://en.wikipedia.org/wiki/23_enigma
+#define HTTP_CACHE_FETCH_TIMEOUT 10 // [s] identical requests stop waiting for
+// a response which has not arrived within this time
 
 /*!
  * \brief Struct to hold an HTTP request packet
@@ -45,6 +52,7 @@ struct request_packet_t
 	uint16_t packetSize;/*!< */
 	boost::posix_time::ptime timestamp;/*!< timestamp when this packet was
 	created */
+	uint32_t expiry;/*!< Expiry wheel deadline of this packet */
 };
 /*!
  * \brief Struct to hold an HTTP response packet
@@ -60,6 +68,60 @@ struct response_packet_t
 	created */
 };
 
+/*!
+ * \brief IP endpoint attached to a cacheable request in flight
+ */
+struct http_cache_waiter_t
+{
+	socket_fd_t socketFd;/*!< Socket FD of the IP endpoint */
+	uint32_t sent;/*!< Bytes of the response written to it so far */
+};
+/*!
+ * \brief HTTP response being received for a cacheable request
+ */
+struct http_cache_fetch_t
+{
+	socket_fd_t socketFd;/*!< IP endpoint whose request has been published */
+	list<http_cache_waiter_t> waiters;/*!< IP endpoints which sent an
+	identical request meanwhile and receive a copy of the response */
+	vector<uint8_t> response;/*!< The response received so far */
+	bool headerParsed;/*!< Whether the response header has been looked at */
+	bool storing;/*!< False once it is known that the response cannot be
+	cached. The received bytes are dropped then */
+	uint32_t expectedSize;/*!< Length of header and body */
+	uint16_t headerLength;/*!< Length of status line and headers */
+	uint32_t age;/*!< Value of the Age header of the response */
+	time_t date;/*!< Value of the Date header of the response, 0 if not
+	present */
+	uint32_t freshness;/*!< Seconds the response stays fresh */
+	uint32_t started;/*!< Monotonic time in seconds the request was published
+	*/
+};
+/*!
+ * \brief Cached HTTP response
+ */
+struct http_cache_response_t
+{
+	shared_ptr<vector<uint8_t>> response;/*!< Status line, header and body.
+	Hits hold a reference while they write it outside the cache lock. It
+	carries no Age header */
+	uint16_t ageOffset;/*!< Offset at which the Age header is inserted, i.e.
+	the end of the status line */
+	uint32_t age;/*!< Age in seconds of the response when it was stored */
+	uint32_t stored;/*!< Monotonic time in seconds the response was stored */
+	uint32_t expiry;/*!< Monotonic time in seconds the response becomes stale */
+	list<cid_t>::iterator lru;/*!< Position in the LRU list */
+};
+
+typedef unordered_map<cid_t, http_cache_fetch_t> http_cache_fetches_t;/*!<
+		u_map<rCID, response being received> */
+
+typedef unordered_map<cid_t, http_cache_response_t> http_cache_responses_t;
+		/*!< u_map<rCID, cached response> */
+
+typedef list<pair<socket_fd_t, uint32_t>> http_cache_writes_t;/*!<
+		list<pair<Socket FD, offset of the first byte it misses>> */
+
 typedef map<cid_t, map<enigma_t, map<sk_t, list<NodeId>>>>
 		cmc_groups_t ; /*!< map<rCID, map<Enigma, map<Session key, list<NIDs>>>>*/
 
@@ -69,6 +131,9 @@ typedef map<cid_t, map<enigma_t, map<nid_t, bool>>> potential_cmc_groups_t
 typedef map<cid_t, map<cid_t, request_packet_t>> packet_buffer_requests_t
 		; /*!< map<cId, map<rCId, Packet Struct>> */
 
+typedef ExpiryWheel<uint64_t> packet_buffer_requests_expiry_t;/*!< Expiry index
+		of packet_buffer_requests_t. The key is cId << 32 | rCId */
+
 typedef map<cid_t, map<enigma_t, stack<response_packet_t>>>
 		packet_buffer_responses_t ; /*!< map<rCID, map<Enigma, stack<Packet Struct
 		>>>*/
@@ -34,18 +34,31 @@ Ip::Ip(Blackadder *icnCore, Configuration &configuration, Transport &transport,
 	  _configuration(configuration),
 	  _transport(transport),
 	  _statistics(statistics),
-	  _run(run)
+	  _run(run),
+	  _routingPrefixTable(NULL),
+	  _packetBuffer(configuration.ipBufferCidLimit(),
+			  configuration.ipBufferLimit(), configuration.ipBufferDropPolicy(),
+			  ENIGMA, statistics)
 {
-	_routingPrefixes = NULL;
-	// Initialising IP buffer cleaner with this ugly void caster
-	IpBufferCleaner ipBufferCleaner((void *)&_packetBuffer,
-			(void *)&_mutexBuffer, _configuration, _statistics, _run);
+	// Initialising IP buffer cleaner
+	IpBufferCleaner ipBufferCleaner(_packetBuffer, _configuration, _statistics,
+			_run);
 	std::thread *ipBufferThread = new std::thread(ipBufferCleaner);
 	ipBufferThread->detach();
 	delete ipBufferThread;
 }
 
-Ip::~Ip(){}
+Ip::~Ip()
+{
+	delete _routingPrefixTable.load();
+
+	for (list<RoutingPrefixTable *>::iterator it =
+			_retiredRoutingPrefixTables.begin();
+			it != _retiredRoutingPrefixTables.end(); it++)
+	{
+		delete *it;
+	}
+}
 
 void Ip::handle(IpAddress &destinationIpAddress, uint8_t *packet,
 		uint16_t &packetSize)
@@ -72,7 +85,7 @@ void Ip::handle(IpAddress &destinationIpAddress, uint8_t *packet,
 	{
 		_icnIds.insert(pair<uint32_t, IcnId> (cid.uint(), cid));
 		_mutexIcnIds.unlock();
-		_bufferPacket(cid, packet, packetSize);
+		_packetBuffer.add(cid, packet, packetSize);
 		// Advertise IP address information item under scope path
 		// / NAMEPSPACE_IP / HASH_ROUTING_PREFIX
 		LOG4CXX_DEBUG(logger, "Advertising information item " << cid.id()
@@ -95,7 +108,7 @@ void Ip::handle(IpAddress &destinationIpAddress, uint8_t *packet,
 		}
 
 		_mutexIcnIds.unlock();
-		_bufferPacket(cid, packet, packetSize);
+		_packetBuffer.add(cid, packet, packetSize);
 		LOG4CXX_DEBUG(logger, "Forwarding state of CID " << cid.print()
 				<< " disabled. Re-advertising information item " << cid.id()
 				<< " under father scope " << cid.printPrefixId());
@@ -156,7 +169,7 @@ void Ip::forwarding(IcnId &cid, bool state)
 void Ip::initialise()
 {
 	IcnId icnId;
-	_routingPrefixes = _configuration.hostRoutingPrefixes();
+	_routingPrefixes(*_configuration.hostRoutingPrefixes());
 	// Host-based
 	if (_configuration.hostBasedNap())
 	{
@@ -202,19 +215,25 @@ void Ip::initialise()
 
 void Ip::publishFromBuffer(IcnId &cId)
 {
-	_mutexBuffer.lock();
-	_bufferIt = _packetBuffer.find(cId.uint());
-	if (_bufferIt == _packetBuffer.end())
+	ip_buffer_batch_t batch;
+	uint32_t offset;
+	bool morePackets = true;
+
+	while (morePackets)
 	{
-		LOG4CXX_TRACE(logger, "IP buffer has no packet for CID "
-				<< cId.print());
-		_mutexBuffer.unlock();
-		return;
+		morePackets = _packetBuffer.take(cId, batch);
+		offset = 0;
+
+		for (uint16_t i = 0; i < batch.numberOfPackets; i++)
+		{
+			_transport.Unreliable::publish(cId, batch.packets + offset,
+					batch.packetSizes[i]);
+			offset += batch.packetSizes[i];
+		}
+
+		LOG4CXX_TRACE(logger, batch.numberOfPackets << " buffered packets "
+				"published under CID " << cId.print());
 	}
-	_transport.Unreliable::publish(cId, (*_bufferIt).second.second.packet,
-			(*_bufferIt).second.second.packetSize);
-	_deleteBufferedPacket(cId);
-	_mutexBuffer.unlock();
 }
 
 void Ip::subscribeScope(IcnId &icnId)
@@ -251,91 +270,57 @@ void Ip::uninitialise()
 	LOG4CXX_INFO(logger, "IP namespace uninitialised");
 }
 
-void Ip::_bufferPacket(IcnId &icnId, uint8_t *packet, uint16_t &packetSize)
+void Ip::_icnId(IcnId &icnId)
 {
-	_mutexBuffer.lock();
-	_bufferIt = _packetBuffer.find(icnId.uint());
+	_icnIdsIt = _icnIds.find(icnId.uint());
 
-	// CID unknown
-	if (_bufferIt == _packetBuffer.end())
-	{
-		pair<IcnId, packet_t> value;
-		value.first = icnId;
-		value.second.packet = (uint8_t *)malloc(packetSize);
-		memcpy(value.second.packet, packet, packetSize);
-		value.second.packetSize = packetSize;
-		value.second.timestamp =
-				boost::posix_time::microsec_clock::local_time();
-		_packetBuffer.insert(pair <uint32_t, pair<IcnId, packet_t>>(
-				icnId.uint(), value));
-		LOG4CXX_TRACE(logger, "Packet of size " << packetSize << " and CID "
-				<< icnId.str() << " added to buffer");
-	}
-	else
+	if (_icnIdsIt != _icnIds.end())
 	{
-		free((*_bufferIt).second.second.packet); // Deleting memory in heap
-		(*_bufferIt).second.second.packet = (uint8_t *)malloc(packetSize);
-		memcpy((*_bufferIt).second.second.packet, packet, packetSize);
-		(*_bufferIt).second.second.packetSize = packetSize;
-		(*_bufferIt).second.second.timestamp =
-				boost::posix_time::microsec_clock::local_time();
-		LOG4CXX_TRACE(logger, "Packet buffer for CID "
-						<< icnId.str() << " updated with a packet of size "
-						<< packetSize);
+		LOG4CXX_DEBUG(logger, "CID " << icnId.print() << " cannot be added. It "
+				"already exists");
+		return;
 	}
 
-	_mutexBuffer.unlock();
+	_icnIds.insert(pair<uint32_t, IcnId>(icnId.uint(), icnId));
+	LOG4CXX_DEBUG(logger, "New CID " << icnId.print() << " has been added");
 }
 
-void Ip::_deleteBufferedPacket(IcnId &cid)
+bool Ip::_routingPrefix(IpAddress &ipAddress, RoutingPrefix &routingPrefix)
 {
-	_bufferIt = _packetBuffer.find(cid.uint());
+	RoutingPrefixTable *routingPrefixTable =
+			_routingPrefixTable.load(memory_order_acquire);
+	RoutingPrefix *prefix;
 
-	if (_bufferIt == _packetBuffer.end())
+	if (routingPrefixTable == NULL)
 	{
-		LOG4CXX_DEBUG(logger, "IP buffer has no packet for CID "
-				<< cid.print());
-		_mutexBuffer.unlock();
-		return;
+		return false;
 	}
 
-	_packetBuffer.erase(_bufferIt);
-	LOG4CXX_TRACE(logger, "IP packet for CID " << cid.print() << " deleted from"
-			" IP packet buffer");
-}
-
-void Ip::_icnId(IcnId &icnId)
-{
-	_icnIdsIt = _icnIds.find(icnId.uint());
+	prefix = routingPrefixTable->lookup(ipAddress.uint());
 
-	if (_icnIdsIt != _icnIds.end())
+	if (prefix == NULL)
 	{
-		LOG4CXX_DEBUG(logger, "CID " << icnId.print() << " cannot be added. It "
-				"already exists");
-		return;
+		return false;
 	}
 
-	_icnIds.insert(pair<uint32_t, IcnId>(icnId.uint(), icnId));
-	LOG4CXX_DEBUG(logger, "New CID " << icnId.print() << " has been added");
+	routingPrefix = *prefix;
+	return true;
 }
 
-bool Ip::_routingPrefix(IpAddress &ipAddress, RoutingPrefix &routingPrefix)
+void Ip::_routingPrefixes(map<uint32_t, RoutingPrefix> &routingPrefixes)
 {
+	RoutingPrefixTable *routingPrefixTable =
+			new RoutingPrefixTable(routingPrefixes);
 	_mutexRoutingPrefixes.lock();
+	routingPrefixTable = _routingPrefixTable.exchange(routingPrefixTable,
+			memory_order_acq_rel);
 
-	for (_routingPrefixesRevIt = _routingPrefixes->rbegin();
-			_routingPrefixesRevIt != _routingPrefixes->rend();
-			_routingPrefixesRevIt++)
+	if (routingPrefixTable != NULL)
 	{
-		if ((ipAddress.uint() & _routingPrefixesRevIt->second.netmask().uint())
-				== _routingPrefixesRevIt->second.uint())
-		{
-			routingPrefix = _routingPrefixesRevIt->second;
-			_mutexRoutingPrefixes.unlock();
-			return true;
-		}
+		_retiredRoutingPrefixTables.push_back(routingPrefixTable);
 	}
 
 	_mutexRoutingPrefixes.unlock();
-	return false;
+	LOG4CXX_DEBUG(logger, "Routing prefix table with " << routingPrefixes.size()
+			<< " prefixes published");
 }
@@ -22,7 +22,9 @@
 #ifndef NAP_NAMESPACES_IP_HH_
 #define NAP_NAMESPACES_IP_HH_
 
+#include <atomic>
 #include <blackadder.hpp>
+#include <list>
 #include <log4cxx/logger.h>
 #include <map>
 #include <mutex>
@@ -32,10 +34,11 @@
 #include <configuration.hh>
 #include <monitoring/statistics.hh>
 #include <namespaces/buffercleaners/ipbuffercleaner.hh>
-#include <namespaces/iptypedef.hh>
+#include <namespaces/ippacketbuffer.hh>
 #include <transport/transport.hh>
 #include <types/icnid.hh>
 #include <types/routingprefix.hh>
+#include <types/routingprefixtable.hh>
 #include <types/typedef.hh>
 
 #ifdef DMALLOC
@@ -106,10 +109,12 @@ protected:
 	 */
 	void initialise();
 	/*!
-	 * \brief Publish a buffered packet
+	 * \brief Publish buffered packets
 	 *
 	 * If the NAP received a START_PUBLISH event from the ICN core this
-	 * method checks if any packet has been buffered for the CID
+	 * method publishes all packets which have been buffered for the CID. They
+	 * are taken out of the buffer in batches which are published without
+	 * holding the buffer's lock
 	 *
 	 * \param icnId The content identifier for which the IP buffer should
 	 * be checked
@@ -142,43 +147,15 @@ private:
 	Transport &_transport;/*!< Reference to Transport class */
 	Statistics &_statistics;/*!< Reference to statistics class */
 	bool *_run;/*!< from main thread is any SIG* had been caught */
-	map<uint32_t, RoutingPrefix> *_routingPrefixes;
-	map<uint32_t, RoutingPrefix>::reverse_iterator _routingPrefixesRevIt;
-	std::mutex _mutexRoutingPrefixes;
+	std::atomic<RoutingPrefixTable *> _routingPrefixTable;/*!< LPM table
+	over all known routing prefixes, read without locking */
+	list<RoutingPrefixTable *> _retiredRoutingPrefixTables;/*!< Replaced
+	tables which might still be read by another thread */
+	std::mutex _mutexRoutingPrefixes;/*!< Serialises publishing tables */
 	unordered_map<uint32_t, IcnId> _icnIds;
 	unordered_map<uint32_t, IcnId>::iterator _icnIdsIt;
 	std::mutex _mutexIcnIds;
-	packet_buffer_t _packetBuffer; /*!< Buffer for IP packets */
-	packet_buffer_t::iterator _bufferIt; /*!< Iterator for _buffer map */
-	std::mutex _mutexBuffer;/*!< Mutex for transaction safe operations on
-	_buffer */
-	/*!
-	 * \brief Add IP packet to buffer
-	 *
-	 * In case the START_PUBLISH notification for a particular CID has
-	 * not been received the IP packet is added to a buffer. This packet
-	 * buffer allows to store a single packet per CID only. If an
-	 * application issues multiple IP packets to the same destination IP
-	 * address and destination port, the previous buffered packet is
-	 * deleted.
-	 *
-	 * \param icnId Reference to the CID for this particular packet
-	 * \param packet Pointer to the actual packet
-	 * \param packetSize Pointer to the length of the packet in bytes
-	 *
-	 * \return void
-	 */
-	void _bufferPacket(IcnId &icnId, uint8_t *packet, uint16_t &packetSize);
-	/*!
-	 * \brief Delete the packet buffered for a particular CID
-	 *
-	 * Note, this method does NOT lock the buffer mutex, as it is supposed to
-	 * be called right after the packet has been published and the buffer mutex
-	 * is going to be unlocked again.
-	 *
-	 * \param cid The CID for which the buffered packet should be deleted
-	 */
-	void _deleteBufferedPacket(IcnId &cid);
+	IpPacketBuffer _packetBuffer;/*!< Buffer for IP packets */
 	/*!
 	 * \brief Add new CID to IP namespace
 	 *
@@ -193,12 +170,9 @@ private:
 	/*!
 	 * \brief Obtain known routing prefix for given IP address
 	 *
-	 * All routing prefixes have been ordered using their uint representation
-	 * (networkAddress & netmask) which places the largest routing prefix (in
-	 * terms of hwo many hosts the prefix comprises) before a smaller prefix.
-	 * When obtaining a routing prefix using the given IP address an inverse
-	 * iterator is used which starts checking for possible prefixes starting
-	 * with the smallest stored routing prefix.
+	 * The longest routing prefix covering the IP address is looked up in the
+	 * current RoutingPrefixTable without taking a lock, as this is called for
+	 * every IP packet the demux captures.
 	 *
 	 * \param ipAddress The IP address for which the routing prefix is
 	 * required
@@ -210,6 +184,18 @@ private:
 	 */
 	bool _routingPrefix(IpAddress &ipAddress,
 			RoutingPrefix &routingPrefix);
+	/*!
+	 * \brief Publish a new set of routing prefixes
+	 *
+	 * A new RoutingPrefixTable is built and swapped in atomically. Lookups
+	 * which are still using the previous table are not waited for; it is
+	 * retired and only freed when the IP handler is destroyed, as the set of
+	 * routing prefixes rarely changes.
+	 *
+	 * \param routingPrefixes The routing prefixes keyed by their network
+	 * address
+	 */
+	void _routingPrefixes(map<uint32_t, RoutingPrefix> &routingPrefixes);
 };
 
 } /* namespace ip */
@@ -0,0 +1,213 @@
+/*
+ * ippacketbuffer.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ippacketbuffer.hh"
+
+using namespace namespaces::ip;
+using namespace log4cxx;
+
+LoggerPtr IpPacketBuffer::logger(Logger::getLogger("namespaces.ip.buffer"));
+
+IpPacketBuffer::IpPacketBuffer(uint32_t cidLimit, uint32_t limit,
+		ip_buffer_drop_policy_t dropPolicy, uint32_t timeout,
+		Statistics &statistics)
+	: _cidLimit(cidLimit),
+	  _limit(limit),
+	  _dropPolicy(dropPolicy),
+	  _timeout(timeout),
+	  _statistics(statistics),
+	  _expiryWheel(timeout),
+	  _bytes(0),
+	  _packets(0)
+{}
+
+IpPacketBuffer::~IpPacketBuffer()
+{
+	for (ip_packet_buffer_t::iterator it = _buffer.begin();
+			it != _buffer.end(); it++)
+	{
+		delete it->second.queue;
+	}
+}
+
+void IpPacketBuffer::add(IcnId &cid, uint8_t *packet, uint16_t packetSize)
+{
+	ip_packet_buffer_t::iterator bufferIt;
+	IpPacketQueue *queue;
+	_mutex.lock();
+	bufferIt = _buffer.find(cid.uint());
+
+	// CID unknown
+	if (bufferIt == _buffer.end())
+	{
+		ip_buffered_cid_t bufferedCid;
+		bufferedCid.cid = cid;
+		bufferedCid.queue = new IpPacketQueue(_cidLimit);
+		bufferedCid.expiry = 0;
+		bufferIt = _buffer.insert(pair<cid_t, ip_buffered_cid_t>(cid.uint(),
+				bufferedCid)).first;
+	}
+
+	queue = bufferIt->second.queue;
+
+	if (_dropPolicy == IP_BUFFER_DROP_OLDEST)
+	{
+		// make room within the CID, and within the entire buffer as far as
+		// the CID's own packets allow
+		while (!queue->empty() && (!queue->fits(packetSize)
+				|| _bytes + packetSize > _limit))
+		{
+			_dropOldest(queue);
+		}
+	}
+
+	if (_bytes + packetSize > _limit || !queue->push(packet, packetSize))
+	{
+		_statistics.ipBufferDrop(packetSize);
+		LOG4CXX_TRACE(logger, "IP buffer for CID " << cid.print() << " full. "
+				"Packet of size " << packetSize << " dropped");
+
+		if (queue->empty())
+		{
+			delete queue;
+			_buffer.erase(bufferIt);
+		}
+
+		_mutex.unlock();
+		return;
+	}
+
+	_bytes += packetSize;
+	_packets++;
+	bufferIt->second.expiry = _expiryWheel.schedule(cid.uint(), _timeout);
+	LOG4CXX_TRACE(logger, "Packet of size " << packetSize << " and CID "
+			<< cid.str() << " added to buffer (" << queue->packets()
+			<< " packets queued)");
+	_mutex.unlock();
+}
+
+uint32_t IpPacketBuffer::bytes()
+{
+	uint32_t bytes;
+	_mutex.lock();
+	bytes = _bytes;
+	_mutex.unlock();
+	return bytes;
+}
+
+void IpPacketBuffer::expire()
+{
+	vector<ip_packet_buffer_expiry_t::expired_t> expired;
+	ip_packet_buffer_t::iterator bufferIt;
+	_mutex.lock();
+	_expiryWheel.expire(expired);
+
+	for (vector<ip_packet_buffer_expiry_t::expired_t>::iterator it =
+			expired.begin(); it != expired.end(); it++)
+	{
+		bufferIt = _buffer.find(it->first);
+
+		// packets have been published or further ones buffered meanwhile
+		if (bufferIt == _buffer.end() ||
+				bufferIt->second.expiry != it->second)
+		{
+			continue;
+		}
+
+		LOG4CXX_DEBUG(logger, bufferIt->second.queue->packets()
+				<< " packets to be published under "
+				<< bufferIt->second.cid.print() << " deleted from IP buffer");
+		_drop(bufferIt);
+	}
+
+	_mutex.unlock();
+}
+
+uint32_t IpPacketBuffer::packets()
+{
+	uint32_t packets;
+	_mutex.lock();
+	packets = _packets;
+	_mutex.unlock();
+	return packets;
+}
+
+bool IpPacketBuffer::take(IcnId &cid, ip_buffer_batch_t &batch)
+{
+	ip_packet_buffer_t::iterator bufferIt;
+	IpPacketQueue *queue;
+	uint32_t offset = 0;
+	batch.numberOfPackets = 0;
+	_mutex.lock();
+	bufferIt = _buffer.find(cid.uint());
+
+	if (bufferIt == _buffer.end())
+	{
+		_mutex.unlock();
+		return false;
+	}
+
+	queue = bufferIt->second.queue;
+
+	while (!queue->empty() && batch.numberOfPackets < IP_BUFFER_BATCH_PACKETS
+			&& offset + queue->front() <= IP_BUFFER_BATCH_SIZE)
+	{
+		batch.packetSizes[batch.numberOfPackets] =
+				queue->pop(batch.packets + offset);
+		offset += batch.packetSizes[batch.numberOfPackets];
+		batch.numberOfPackets++;
+	}
+
+	_bytes -= offset;
+	_packets -= batch.numberOfPackets;
+
+	if (queue->empty())
+	{
+		delete queue;
+		_buffer.erase(bufferIt);
+		_mutex.unlock();
+		return false;
+	}
+
+	_mutex.unlock();
+	return true;
+}
+
+void IpPacketBuffer::_drop(ip_packet_buffer_t::iterator bufferIt)
+{
+	IpPacketQueue *queue = bufferIt->second.queue;
+
+	while (!queue->empty())
+	{
+		_dropOldest(queue);
+	}
+
+	delete queue;
+	_buffer.erase(bufferIt);
+}
+
+void IpPacketBuffer::_dropOldest(IpPacketQueue *queue)
+{
+	uint16_t packetSize = queue->pop(NULL);
+	_bytes -= packetSize;
+	_packets--;
+	_statistics.ipBufferDrop(packetSize);
+}
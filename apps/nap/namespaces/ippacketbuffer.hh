@@ -0,0 +1,141 @@
+/*
+ * ippacketbuffer.hh
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAP_NAMESPACES_IPPACKETBUFFER_HH_
+#define NAP_NAMESPACES_IPPACKETBUFFER_HH_
+
+#include <log4cxx/logger.h>
+#include <mutex>
+#include <stdint.h>
+
+#include <monitoring/statistics.hh>
+#include <namespaces/iptypedef.hh>
+#include <types/enumerations.hh>
+#include <types/icnid.hh>
+
+#ifdef DMALLOC
+#include "dmalloc.h"
+#endif
+
+using namespace monitoring::statistics;
+
+namespace namespaces {
+
+namespace ip {
+/*!
+ * \brief Buffer of the IP handler for packets whose CID has no FID yet
+ *
+ * Every CID gets a bounded IpPacketQueue. A packet which does not fit into its
+ * queue anymore is handled according to the drop policy: either the oldest
+ * packets of the CID are dropped until it fits or the packet itself is. If the
+ * limit over all CIDs is reached the packet is dropped regardless of the
+ * policy, as the oldest packet over all CIDs is not known. Every drop is
+ * reported to Statistics.
+ */
+class IpPacketBuffer
+{
+	static log4cxx::LoggerPtr logger;
+public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param cidLimit The number of bytes buffered per CID
+	 * \param limit The number of bytes buffered over all CIDs
+	 * \param dropPolicy Which packet is dropped if the queue of a CID is full
+	 * \param timeout Seconds after which the packets of a CID are dropped if
+	 * no further packet has been buffered for it
+	 * \param statistics Reference to class Statistics
+	 */
+	IpPacketBuffer(uint32_t cidLimit, uint32_t limit,
+			ip_buffer_drop_policy_t dropPolicy, uint32_t timeout,
+			Statistics &statistics);
+	/*!
+	 * \brief Destructor
+	 */
+	~IpPacketBuffer();
+	/*!
+	 * \brief Buffer a packet
+	 *
+	 * \param cid The CID the packet is going to be published under
+	 * \param packet Pointer to the packet
+	 * \param packetSize The size of the packet
+	 */
+	void add(IcnId &cid, uint8_t *packet, uint16_t packetSize);
+	/*!
+	 * \brief Obtain the number of bytes buffered over all CIDs
+	 */
+	uint32_t bytes();
+	/*!
+	 * \brief Drop the packets of all CIDs which have timed out
+	 */
+	void expire();
+	/*!
+	 * \brief Obtain the number of packets buffered over all CIDs
+	 */
+	uint32_t packets();
+	/*!
+	 * \brief Take the oldest packets of a CID out of the buffer
+	 *
+	 * As many packets are copied into the batch as fit, at least one if the
+	 * CID has any. The buffer lock is only held while copying, so that the
+	 * caller can publish the batch without blocking packets which are being
+	 * buffered meanwhile.
+	 *
+	 * \param cid The CID
+	 * \param batch The batch the packets are copied into
+	 *
+	 * \return True if further packets are buffered for the CID
+	 */
+	bool take(IcnId &cid, ip_buffer_batch_t &batch);
+private:
+	uint32_t _cidLimit;/*!< Bytes buffered per CID */
+	uint32_t _limit;/*!< Bytes buffered over all CIDs */
+	ip_buffer_drop_policy_t _dropPolicy;/*!< Which packet is dropped */
+	uint32_t _timeout;/*!< Seconds after which packets are dropped */
+	Statistics &_statistics;/*!< Reference to statistics class */
+	ip_packet_buffer_t _buffer;/*!< The queues of all CIDs */
+	ip_packet_buffer_expiry_t _expiryWheel;/*!< Expiry index of _buffer */
+	uint32_t _bytes;/*!< Packet bytes over all queues */
+	uint32_t _packets;/*!< Packets over all queues */
+	std::mutex _mutex;/*!< Mutex for all members above */
+	/*!
+	 * \brief Drop all packets of a CID and remove its queue
+	 *
+	 * Note, this method does not lock the buffer mutex.
+	 *
+	 * \param bufferIt The iterator pointing to the CID
+	 */
+	void _drop(ip_packet_buffer_t::iterator bufferIt);
+	/*!
+	 * \brief Drop the oldest packet of a queue
+	 *
+	 * Note, this method does not lock the buffer mutex.
+	 *
+	 * \param queue The queue
+	 */
+	void _dropOldest(IpPacketQueue *queue);
+};
+
+} /* namespace ip */
+
+} /* namespace namespaces */
+
+#endif /* NAP_NAMESPACES_IPPACKETBUFFER_HH_ */
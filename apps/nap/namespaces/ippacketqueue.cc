@@ -0,0 +1,179 @@
+/*
+ * ippacketqueue.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ippacketqueue.hh"
+
+using namespace namespaces::ip;
+
+#define IP_PACKET_QUEUE_INITIAL_CAPACITY 2048 // bytes, a full Ethernet frame
+
+IpPacketQueue::IpPacketQueue(uint32_t limit)
+	: _ring(NULL),
+	  _capacity(0),
+	  _limit(limit),
+	  _head(0),
+	  _used(0),
+	  _bytes(0),
+	  _packets(0)
+{}
+
+IpPacketQueue::~IpPacketQueue()
+{
+	free(_ring);
+}
+
+uint32_t IpPacketQueue::bytes()
+{
+	return _bytes;
+}
+
+bool IpPacketQueue::empty()
+{
+	return _packets == 0;
+}
+
+bool IpPacketQueue::fits(uint16_t packetSize)
+{
+	return _bytes + packetSize <= _limit;
+}
+
+uint16_t IpPacketQueue::front()
+{
+	uint16_t packetSize;
+
+	if (_packets == 0)
+	{
+		return 0;
+	}
+
+	_read(_head, (uint8_t *)&packetSize, sizeof(packetSize));
+	return packetSize;
+}
+
+uint32_t IpPacketQueue::packets()
+{
+	return _packets;
+}
+
+uint16_t IpPacketQueue::pop(uint8_t *packet)
+{
+	uint16_t packetSize = front();
+
+	if (packetSize == 0)
+	{
+		return 0;
+	}
+
+	if (packet != NULL)
+	{
+		_read(_head + sizeof(packetSize), packet, packetSize);
+	}
+
+	_head = (_head + sizeof(packetSize) + packetSize) & (_capacity - 1);
+	_used -= sizeof(packetSize) + packetSize;
+	_bytes -= packetSize;
+	_packets--;
+	return packetSize;
+}
+
+bool IpPacketQueue::push(uint8_t *packet, uint16_t packetSize)
+{
+	uint32_t tail;
+
+	if (packetSize == 0 || !fits(packetSize))
+	{
+		return false;
+	}
+
+	if (_used + sizeof(packetSize) + packetSize > _capacity)
+	{
+		_grow(_used + sizeof(packetSize) + packetSize);
+	}
+
+	tail = (_head + _used) & (_capacity - 1);
+	_write(tail, (uint8_t *)&packetSize, sizeof(packetSize));
+	_write(tail + sizeof(packetSize), packet, packetSize);
+	_used += sizeof(packetSize) + packetSize;
+	_bytes += packetSize;
+	_packets++;
+	return true;
+}
+
+void IpPacketQueue::_grow(uint32_t used)
+{
+	uint32_t capacity = (_capacity == 0) ? IP_PACKET_QUEUE_INITIAL_CAPACITY
+			: _capacity;
+	uint8_t *ring;
+
+	while (capacity < used)
+	{
+		capacity <<= 1;
+	}
+
+	// unwrap the queued bytes to the start of the new ring
+	ring = (uint8_t *)malloc(capacity);
+	_read(_head, ring, _used);
+	free(_ring);
+	_ring = ring;
+	_capacity = capacity;
+	_head = 0;
+}
+
+void IpPacketQueue::_read(uint32_t offset, uint8_t *data, uint32_t length)
+{
+	uint32_t first;
+
+	if (length == 0)
+	{
+		return;
+	}
+
+	offset &= _capacity - 1;
+	first = _capacity - offset;
+
+	if (length <= first)
+	{
+		memcpy(data, _ring + offset, length);
+		return;
+	}
+
+	memcpy(data, _ring + offset, first);
+	memcpy(data + first, _ring, length - first);
+}
+
+void IpPacketQueue::_write(uint32_t offset, uint8_t *data, uint32_t length)
+{
+	uint32_t first;
+	offset &= _capacity - 1;
+	first = _capacity - offset;
+
+	if (length <= first)
+	{
+		memcpy(_ring + offset, data, length);
+		return;
+	}
+
+	memcpy(_ring + offset, data, first);
+	memcpy(_ring, data + first, length - first);
+}
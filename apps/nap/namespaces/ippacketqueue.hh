@@ -0,0 +1,128 @@
+/*
+ * ippacketqueue.hh
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAP_NAMESPACES_IPPACKETQUEUE_HH_
+#define NAP_NAMESPACES_IPPACKETQUEUE_HH_
+
+#include <stdint.h>
+
+#ifdef DMALLOC
+#include "dmalloc.h"
+#endif
+
+namespace namespaces {
+
+namespace ip {
+/*!
+ * \brief Bounded ring of the IP packets buffered for a single CID
+ *
+ * The packets are stored back to back, each preceded by its length, in a
+ * single ring which grows in powers of two until it holds limit bytes of
+ * packets. Buffering a packet therefore costs a memcpy() instead of an
+ * allocation.
+ *
+ * The queue is not thread-safe.
+ */
+class IpPacketQueue
+{
+public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param limit The number of packet bytes the queue holds at most
+	 */
+	IpPacketQueue(uint32_t limit);
+	/*!
+	 * \brief Destructor
+	 */
+	~IpPacketQueue();
+	/*!
+	 * \brief Obtain the number of packet bytes in the queue
+	 */
+	uint32_t bytes();
+	/*!
+	 * \brief Check whether the queue holds no packet
+	 */
+	bool empty();
+	/*!
+	 * \brief Check whether a packet fits into the queue without dropping any
+	 * of the queued ones
+	 *
+	 * \param packetSize The size of the packet
+	 */
+	bool fits(uint16_t packetSize);
+	/*!
+	 * \brief Obtain the size of the oldest packet
+	 *
+	 * \return The size or 0 if the queue is empty
+	 */
+	uint16_t front();
+	/*!
+	 * \brief Obtain the number of packets in the queue
+	 */
+	uint32_t packets();
+	/*!
+	 * \brief Remove the oldest packet from the queue
+	 *
+	 * \param packet Where the packet is copied to. If NULL the packet is
+	 * dropped
+	 *
+	 * \return The size of the packet or 0 if the queue is empty
+	 */
+	uint16_t pop(uint8_t *packet);
+	/*!
+	 * \brief Append a packet to the queue
+	 *
+	 * \param packet Pointer to the packet
+	 * \param packetSize The size of the packet
+	 *
+	 * \return False if the packet does not fit (see fits())
+	 */
+	bool push(uint8_t *packet, uint16_t packetSize);
+private:
+	uint8_t *_ring;/*!< The ring */
+	uint32_t _capacity;/*!< Size of _ring, a power of two */
+	uint32_t _limit;/*!< Packet bytes held at most */
+	uint32_t _head;/*!< Offset of the oldest packet's length */
+	uint32_t _used;/*!< Occupied bytes of the ring including lengths */
+	uint32_t _bytes;/*!< Occupied bytes excluding lengths */
+	uint32_t _packets;/*!< Number of packets */
+	/*!
+	 * \brief Grow the ring so that it can hold the given number of bytes
+	 *
+	 * \param used The bytes the ring must hold including lengths
+	 */
+	void _grow(uint32_t used);
+	/*!
+	 * \brief Copy bytes out of the ring, wrapping around its end
+	 */
+	void _read(uint32_t offset, uint8_t *data, uint32_t length);
+	/*!
+	 * \brief Copy bytes into the ring, wrapping around its end
+	 */
+	void _write(uint32_t offset, uint8_t *data, uint32_t length);
+};
+
+} /* namespace ip */
+
+} /* namespace namespaces */
+
+#endif /* NAP_NAMESPACES_IPPACKETQUEUE_HH_ */
@@ -24,10 +24,38 @@
 
 #include <unordered_map>
 
+#include <namespaces/ippacketqueue.hh>
+#include <types/expirywheel.hh>
 #include <types/icnid.hh>
 #include <types/typedef.hh>
 
-typedef unordered_map<cid_t, pair<IcnId, packet_t>> packet_buffer_t ; /*!<
- 	 	 unordered_map<hashedCID, pair<CID, Packet>>*/
+#define IP_BUFFER_BATCH_PACKETS 64 // packets taken out of the buffer at once
+#define IP_BUFFER_BATCH_SIZE 131072 // their bytes, at least one IP packet
+
+/*!
+ * \brief The packets buffered for a CID
+ */
+struct ip_buffered_cid_t
+{
+	IcnId cid;/*!< The CID */
+	namespaces::ip::IpPacketQueue *queue;/*!< Its packets, oldest first */
+	uint32_t expiry;/*!< Expiry wheel deadline, renewed with every packet */
+};
+
+typedef unordered_map<cid_t, ip_buffered_cid_t> ip_packet_buffer_t;/*!<
+		u_map<hashed CID, buffered packets> */
+
+typedef ExpiryWheel<cid_t> ip_packet_buffer_expiry_t;/*!< Expiry index of
+		ip_packet_buffer_t */
+
+/*!
+ * \brief Packets taken out of the buffer in one go
+ */
+struct ip_buffer_batch_t
+{
+	uint8_t packets[IP_BUFFER_BATCH_SIZE];/*!< The packets back to back */
+	uint16_t packetSizes[IP_BUFFER_BATCH_PACKETS];/*!< Their sizes */
+	uint16_t numberOfPackets;/*!< Number of packets in the batch */
+};
 
 #endif /* NAP_NAMESPACES_IPTYPEDEF_HH_ */
@@ -19,6 +19,7 @@
  * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <netinet/udp.h>
 #include <thread>
 
 #include "mcast.hh"
@@ -28,8 +29,6 @@ using namespace std;
 using namespace namespaces::mcast;
 using namespace log4cxx;
 
-struct timespec spec;
-
 LoggerPtr MCast::logger(Logger::getLogger("namespaces.mcast"));
 
 MCast::MCast(Blackadder *icnCore, Configuration &configuration,
@@ -38,13 +37,14 @@ MCast::MCast(Blackadder *icnCore, Configuration &configuration,
   _configuration(configuration),
   _transport(transport),
   _statistics(statistics),
-  _run(run)
+  _run(run),
+  _packetBufferExpiry(ENIGMA)
 {
 
-	// Initialising IP buffer cleaner with this ugly void caster
-	IpBufferCleaner ipBufferCleaner((void *) &_packetBuffer,
-			(void *) &_mutexBuffer, _configuration, _statistics, _run);
-	std::thread *mcastBufferThread = new std::thread(ipBufferCleaner);
+	// Initialising multicast buffer cleaner
+	McastBufferCleaner mcastBufferCleaner(_packetBuffer, _packetBufferExpiry,
+			_mutexBuffer, _configuration, _run);
+	std::thread *mcastBufferThread = new std::thread(mcastBufferCleaner);
 	mcastBufferThread->detach();
 	delete mcastBufferThread;
 
@@ -101,6 +101,15 @@ MCast::~MCast() {
 	_dataFwdState.clear();
 }
 
+void MCast::flushMCastData()
+{
+	uint32_t bytesSent = _mcastDataPath.flush();
+
+	if (bytesSent > 0) {
+		_statistics.txIGMPBytes(bytesSent);
+	}
+}
+
 void MCast::handle(IpAddress &sourceIpAddress, IpAddress &destinationIpAddress,
 		uint8_t * packet)
 {
@@ -359,6 +368,8 @@ void MCast::_loadSNapProps()
 		LOG4CXX_WARN(logger, "MESSAGE_PROCESSING_LAG out of bounds (10000-5000,"
 				"000ns), set to " << MESSAGE_PROCESSING_LAG);
 	}
+	_warmGroups.configure(_configuration.igmp_warmGroups(),
+			_configuration.igmp_warmGroupsPolicy());
 	if (_configuration.igmp_sNapMCastIPs().length() > 0) {
 		istringstream iss(_configuration.igmp_sNapMCastIPs());
 		vector<string> tmp_sNapMCastIPs;
@@ -418,6 +429,8 @@ void MCast::_bufferPacket(IcnId &cId, uint8_t *packet, uint16_t & packetSize) {
 		value.second.packetSize = packetSize;
 		value.second.timestamp =
 				boost::posix_time::microsec_clock::local_time();
+		value.second.expiry = _packetBufferExpiry.schedule(cId.uint(),
+				ENIGMA);
 		_packetBuffer.insert(
 				pair<uint32_t, pair<IcnId, packet_t>>(cId.uint(), value));
 		LOG4CXX_DEBUG(logger, "ID " << cId.print());
@@ -428,6 +441,8 @@ void MCast::_bufferPacket(IcnId &cId, uint8_t *packet, uint16_t & packetSize) {
 		(*_bufferIt).second.second.packetSize = packetSize;
 		(*_bufferIt).second.second.timestamp =
 				boost::posix_time::microsec_clock::local_time();
+		(*_bufferIt).second.second.expiry = _packetBufferExpiry.schedule(
+				cId.uint(), ENIGMA);
 		LOG4CXX_DEBUG(logger, "Packet update, ID " << cId.print());
 	}
 	_mutexBuffer.unlock();
@@ -485,35 +500,10 @@ void MCast::_removeGroupAfterLeave(IpAddress groupAddr) {
 			LOG4CXX_DEBUG(logger, "Deleting group, counter not refreshed, "
 					"group: "<<groupAddr.str());
 			_mcastDB_cNapErase(&groupAddr);
-			uint16_t packetSize = sizeof(IGMP_LEAVE_GROUP)
-					+ sizeof(groupAddr.uint());
-			uint8_t * packet = (uint8_t *) malloc(packetSize);
-			_prepareIgmpPacket(groupAddr, IGMP_LEAVE_GROUP, packet);
-			IcnId ctrlCID = _ctrlScopeIds[groupAddr.uint()];
-			_mutexCtrlFwdState.lock();
-			_ctrlFwdStateIt = _ctrlFwdState.find(ctrlCID.uint());
-			if (_ctrlFwdStateIt != _ctrlFwdState.end()
-					&& !_ctrlFwdStateIt->second) // If ctrl packet has to be hold back (pause)
-			{
-				_mutexCtrlFwdState.unlock();
-				_bufferPacket(ctrlCID, packet, packetSize);
-				LOG4CXX_DEBUG(logger, "<CTRL> packet buffered because the FWD "
-						"state of ctrlCID " << ctrlCID.print()
-						<< " is disabled. Re-advertising <CTRL> CID "
-						<< ctrlCID.id() << " under father scope "
-						<< ctrlCID.printPrefixId());
-				_icnCore->publish_info(ctrlCID.binId(), ctrlCID.binPrefixId(),
-						DOMAIN_LOCAL, NULL, 0);
+			if (_warmGroupKeep(groupAddr)) {
 				return;
 			}
-			_mutexCtrlFwdState.unlock();
-			IcnId* dataCID_ptr = IcnId::createIGMPDataFromCtrlScopeId(ctrlCID);
-			LOG4CXX_DEBUG(logger, "dataCID_ptr: "<<dataCID_ptr->print());
-			_publishIGMPCtrl_data_isub(ctrlCID, *dataCID_ptr, packet,
-					packetSize);
-			_tryClearCNapStateFor(packet, &ctrlCID, &groupAddr);
-			free(packet);
-			delete dataCID_ptr;
+			_leaveSNap(groupAddr);
 		} else {
 			//YT: group is alive, other clients exist despite received group leave 
 			LOG4CXX_DEBUG(logger, "Keeping group, counter was refreshed, "
@@ -927,59 +917,36 @@ void MCast::_tryPublishData(IcnId &dataCID, uint8_t * packet,
 
 void MCast::_handleMCastDataAtCNap(Event * event) {
 	uint8_t *packet = (uint8_t*) event->data;
-	unsigned int packetSize = event->data_len;
-
-	char* data;
-	u_int16_t dataSz;
-
-	IpAddress sourceIpAddress;
-	IpAddress multicastIpAddress;
-
-	_extractFromPacket(packet, packetSize, sourceIpAddress, multicastIpAddress,
-			&data, &dataSz);
+	// read the headers in place; an IpAddress would format the address as a
+	// string for every datagram
+	struct ip *ipHeader = (struct ip *) packet;
+	uint16_t headersSize = ipHeader->ip_hl * 4 + sizeof(struct udphdr);
+	uint32_t group = ipHeader->ip_dst.s_addr;
+	uint64_t acquisitionTime;
+
+	if (event->data_len < headersSize) {
+		LOG4CXX_DEBUG(logger, "Dropping truncated multicast packet of length "
+				<< event->data_len);
+		return;
+	}
 
-	pair<int, struct sockaddr_in *> fd_sockAddr;
-	_mutexMcastDB_cNap.lock(); // <- ΥΤ changed this to "lock()" from "unlock()"
-	_mcastDB_cNapIPSocketsIt = _mcastDB_cNapIPSockets.find(
-			multicastIpAddress.uint());
-	if (_mcastDB_cNapIPSocketsIt == _mcastDB_cNapIPSockets.end()) {
-		_mutexMcastDB_cNap.unlock();
-		LOG4CXX_DEBUG(logger, "Multicast address "<< multicastIpAddress.str()
-				<< " is unknown  multicast to clients has failed");
+	if (!_mcastDataPath.queue(group, packet + headersSize,
+			event->data_len - headersSize, acquisitionTime)) {
+		LOG4CXX_DEBUG(logger, "Multicast address "
+				<< inet_ntoa(ipHeader->ip_dst) << " is unknown, multicast "
+				"to clients has failed");
 		return;
 	}
-	fd_sockAddr = _mcastDB_cNapIPSocketsIt->second;
-	_mutexMcastDB_cNap.unlock();
 
-	int fd = fd_sockAddr.first;
-	const struct sockaddr * addrPtr = (struct sockaddr *) fd_sockAddr.second;
-	//addrPtr->sin_port=htons(15555);
-	int res_ = sendto(fd, data, dataSz, 0, addrPtr, sizeof(struct sockaddr));
-	if (res_ < 0) {
-		LOG4CXX_ERROR(logger, "sendto socket operation to multicast clients has"
-				" failed, res_: " << res_ << " fd: " << fd << " addrPtr: "
-				<< inet_ntoa(((struct sockaddr_in *)addrPtr)->sin_addr)
-				<< " address.str(): " << multicastIpAddress.str()
-				<< " dataSz: " << dataSz << " errno: " << strerror(errno));
-	} else {
-		LOG4CXX_DEBUG(logger, "successfully send content to local app via "
-				"socket " << fd);
-		string msg = string(data);
-		_statistics.txIGMPBytes(dataSz);
-		//iff this is the first packet received after joining.
-		if (_statJoin2FirstDatumMap[multicastIpAddress.uint()] > 0) {
-			clock_gettime(CLOCK_MONOTONIC_RAW, &spec);
-			long now = spec.tv_sec * 1.0e3 + spec.tv_nsec / 1.0e6; // get time in milliseconds
-			if (now > _statJoin2FirstDatumMap[multicastIpAddress.uint()]) { // prevent clock rollover
-				_statistics.channelAcquisitionTime(multicastIpAddress.uint(),
-						now	- _statJoin2FirstDatumMap[multicastIpAddress.uint()]);
-				LOG4CXX_ERROR(logger, "Channel join time "
-						<< now - _statJoin2FirstDatumMap[multicastIpAddress.uint()]
-						 << " now " << now);
-				_statJoin2FirstDatumMap[multicastIpAddress.uint()] = 0; // mark it as being counted
+	if (acquisitionTime > 0) {
+		// reported in units of 100 microseconds (seconds x 10000)
+		_statistics.channelAcquisitionTime(group, acquisitionTime / 100);
+		LOG4CXX_DEBUG(logger, "Channel " << inet_ntoa(ipHeader->ip_dst)
+				<< " acquired after " << acquisitionTime / 1000 << "ms");
+	}
 
-			}
-		}
+	if (_mcastDataPath.full()) {
+		flushMCastData();
 	}
 }
 
@@ -1043,9 +1010,8 @@ void MCast::_handleCtrlPub_dataISub(Event * event) {
 			_sNapToIPTVServer(multicastIpAddress, IGMP_LEAVE_GROUP);
 			// try to delete possibly buffered mcast data
 			// no need to keep them bufferred anymore ..
-			string rCIdStr = chararray_to_hex(event->isubID);
 			IcnId dataCID;
-			dataCID = rCIdStr;
+			dataCID.binIcnId(event->isubID);
 			_mutexBuffer.lock();
 			_bufferIt = _packetBuffer.find(dataCID.uint());
 			if (_bufferIt != _packetBuffer.end()) {
@@ -1248,33 +1214,22 @@ void MCast::_handleIGMPMemReport(IpAddress & sourceIpAddress,
 		LOG4CXX_DEBUG(logger, "handleIGMPMemReport: creating new group: "
 				<< multicastIpAddress.str());
 		//ΥΤ: registers the group to the cNAP
-		clock_gettime(CLOCK_MONOTONIC_RAW, &spec);
-		long now = spec.tv_sec * 1.0e3 + spec.tv_nsec / 1.0e6;
-		_statJoin2FirstDatumMap[multicastIpAddress.uint()] = now;
-		struct sockaddr_in * addr = (struct sockaddr_in *) malloc(
-				sizeof(struct sockaddr_in));
-		int fd;
-		/* create what looks like an ordinary UDP socket */
-		if ((fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP)) < 0) {
-			LOG4CXX_ERROR(logger, "Dropping request, socket for multicast "
-					"clients was not created.");
+		_mcastDataPath.join(multicastIpAddress.uint(),
+				_sNapMCastIPs[multicastIpAddress.str()]);
+		// the sNAP still publishes the group to this cNAP; the <CTRL> state
+		// has been kept, too
+		if (_warmGroups.join(multicastIpAddress.uint())) {
 			_mutexMcastDB_cNap.unlock();
+			LOG4CXX_DEBUG(logger, "Group " << multicastIpAddress.str()
+					<< " joined from warm subscription");
+			delete ctrlCID_ptr;
+			delete dataCID_ptr;
 			return;
 		}
-		/* set up destination address */
-		memset(addr, 0, sizeof(struct sockaddr_in));
-		addr->sin_family = AF_INET;
-		addr->sin_addr.s_addr = inet_addr(multicastIpAddress.str().c_str());
-		uint16_t destPortNum = _sNapMCastIPs[multicastIpAddress.str()];
-		addr->sin_port = htons(destPortNum);
-		_mcastDB_cNapIPSockets[multicastIpAddress.uint()] = pair<int,
-				struct sockaddr_in *>(fd, addr);
-
 		_mutexMcastDB_cNap.unlock();
 		_mutexCtrlScopeIds.lock();
 
-		LOG4CXX_DEBUG(logger, "New DB entry for " << multicastIpAddress.str()
-				<< " fd: "<<fd);
+		LOG4CXX_DEBUG(logger, "New DB entry for " << multicastIpAddress.str());
 
 		_ctrlScopeIds.insert(
 				pair<uint32_t, IcnId>(multicastIpAddress.uint(), *ctrlCID_ptr));
@@ -1373,38 +1328,60 @@ void MCast::_forceLeave(IpAddress &multicastIpAddress) {
 				<< multicastIpAddress.str());
 		return;
 	}
+	if (_warmGroupKeep(multicastIpAddress)) {
+		return;
+	}
 	// update the sNAP >>>>>>>>>>>>>
-	uint8_t *packet;
-	uint8_t leave = IGMP_LEAVE_GROUP;
-	uint16_t packetSize = sizeof(uint8_t) + sizeof(multicastIpAddress.uint());
-	packet = (uint8_t *) malloc(packetSize);
-	uint8_t offset = 0;
-	// [1] include node LEAVE type
-	memcpy(packet, &leave, sizeof(uint8_t));
-	offset += sizeof(uint8_t);
-	// [2] include multicast IP Address
-	memcpy(packet + offset, multicastIpAddress.uintPointer(), sizeof(uint32_t));
-	IcnId ctrlCID = _ctrlScopeIds[multicastIpAddress.uint()];
+	_leaveSNap(multicastIpAddress);
+}
+
+void MCast::_leaveSNap(IpAddress &groupAddr) {
+	// IGMP type and group
+	uint16_t packetSize = sizeof(uint8_t) + sizeof(uint32_t);
+	uint8_t * packet = (uint8_t *) malloc(packetSize);
+	_prepareIgmpPacket(groupAddr, IGMP_LEAVE_GROUP, packet);
+	IcnId ctrlCID = _ctrlScopeIds[groupAddr.uint()];
 	_mutexCtrlFwdState.lock();
 	_ctrlFwdStateIt = _ctrlFwdState.find(ctrlCID.uint());
-	if (!_ctrlFwdStateIt->second)  // If ctrl packet has to be hold back (pause)
+	if (_ctrlFwdStateIt != _ctrlFwdState.end()
+			&& !_ctrlFwdStateIt->second) // If ctrl packet has to be hold back (pause)
 	{
 		_mutexCtrlFwdState.unlock();
 		_bufferPacket(ctrlCID, packet, packetSize);
-
+		LOG4CXX_DEBUG(logger, "<CTRL> packet buffered because the FWD "
+				"state of ctrlCID " << ctrlCID.print()
+				<< " is disabled. Re-advertising <CTRL> CID "
+				<< ctrlCID.id() << " under father scope "
+				<< ctrlCID.printPrefixId());
 		_icnCore->publish_info(ctrlCID.binId(), ctrlCID.binPrefixId(),
 				DOMAIN_LOCAL, NULL, 0);
-
+		free(packet);
 		return;
 	}
 	_mutexCtrlFwdState.unlock();
 	IcnId* dataCID_ptr = IcnId::createIGMPDataFromCtrlScopeId(ctrlCID);
+	LOG4CXX_DEBUG(logger, "dataCID_ptr: "<<dataCID_ptr->print());
 	_publishIGMPCtrl_data_isub(ctrlCID, *dataCID_ptr, packet, packetSize);
-	_tryClearCNapStateFor(packet, &ctrlCID, &multicastIpAddress);
+	_tryClearCNapStateFor(packet, &ctrlCID, &groupAddr);
 	free(packet);
 	delete dataCID_ptr;
 }
 
+bool MCast::_warmGroupKeep(IpAddress &groupAddr) {
+	uint32_t evicted;
+
+	if (!_warmGroups.keep(groupAddr.uint(), evicted)) {
+		return false;
+	}
+	LOG4CXX_DEBUG(logger, "Keeping group warm: " << groupAddr.str());
+	if (evicted != 0) {
+		IpAddress evictedAddr(evicted);
+		LOG4CXX_DEBUG(logger, "Leaving warm group " << evictedAddr.str());
+		_leaveSNap(evictedAddr);
+	}
+	return true;
+}
+
 bool MCast::_mcastDB_cNapErase(IpAddress * multicastIpAddress_ptr) {
 	_mutexMcastDB_cNap.lock();
 	// update iterator due to erasing element
@@ -1418,19 +1395,7 @@ bool MCast::_mcastDB_cNapErase(IpAddress * multicastIpAddress_ptr) {
 		return false;
 	}
 	_mcastDB_cNap.erase(multicastIpAddress_ptr->uint());
-	_statJoin2FirstDatumMap.erase(multicastIpAddress_ptr->uint());
-	_mcastDB_cNapIPSocketsIt = _mcastDB_cNapIPSockets.find(
-			multicastIpAddress_ptr->uint());
-	// FIXME this is bug. needs fixing to free sockaddr_in memory
-	if (_mcastDB_cNapIPSocketsIt == _mcastDB_cNapIPSockets.end()) {
-		LOG4CXX_ERROR(logger, "Dropping request, Cannot free socket memory for "
-				"multicast group: " << multicastIpAddress_ptr->str());
-		return false;
-	}
-	close(_mcastDB_cNapIPSocketsIt->first); // close socket for this file descriptor
-	struct sockaddr_in * addr = _mcastDB_cNapIPSocketsIt->second.second;
-	free(addr);
-	_mcastDB_cNapIPSockets.erase(_mcastDB_cNapIPSocketsIt);
+	_mcastDataPath.leave(multicastIpAddress_ptr->uint());
 	_mutexMcastDB_cNap.unlock();
 
 	LOG4CXX_WARN(logger, "Removed state, group: "
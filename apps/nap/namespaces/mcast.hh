@@ -27,13 +27,16 @@
 #include <log4cxx/logger.h>
 #include <unordered_map>
 #include <map>
+#include <mutex>
 #include <algorithm>
 
 #include <transport/transport.hh>
 #include <types/icnid.hh>
 #include <types/routingprefix.hh>
-#include <namespaces/buffercleaners/ipbuffercleaner.hh>
-#include <namespaces/iptypedef.hh>
+#include <namespaces/buffercleaners/mcastbuffercleaner.hh>
+#include <namespaces/mcastdatapath.hh>
+#include <namespaces/mcasttypedef.hh>
+#include <namespaces/mcastwarmgroups.hh>
 
 #include "/usr/include/netinet/igmp.h"
 
@@ -50,7 +53,7 @@
 #include <configuration.hh>
 #include <monitoring/statistics.hh>
 
-using namespace cleaners::ipbuffer;
+using namespace cleaners::mcastbuffer;
 using namespace configuration;
 using namespace std;
 using namespace transport;
@@ -85,6 +88,14 @@ public:
 	/*!
 	 * \brief Destructor  */
 	~MCast();
+	/*!
+	 * \brief Send the multicast data the calling thread has queued for the
+	 * IP clients of this cNAP
+	 *
+	 * Called by an ICN worker thread once it has no further events queued, so
+	 * that a burst of PUBLISHED_DATA events leaves with a single sendmmsg().
+	 */
+	void flushMCastData();
 	/*!
 	 * \brief TODO
 	 */
@@ -142,9 +153,6 @@ private:
 	IcnId* _rootScope_ptr;
 	IcnId* _dataScope_ptr;
 	IcnId* _controlScope_ptr;
-	// statistics section:
-	unordered_map<uint32_t, clock_t> _statJoin2FirstDatumMap; /*!<  cNAP: mcast
-	IP -> time in clock ticks since join. If 0, then the time until first packet has been measured*/
 	// [sNAP] Multicast address DB at the sNAP with advertised
 	// Data scope IDs (notated as <DATA>)
 	unordered_map<uint32_t, IcnId> _dataScopeIds;
@@ -173,12 +181,10 @@ private:
 	// make the counter equal to zero.
 	unordered_map<uint32_t, uint32_t> _mcastDB_cNap;
 	unordered_map<uint32_t, uint32_t>::iterator _mcastDB_cNapIt;
-	//2. pointers to
-	// to sockets maintined for mcasting publications to locally
-	// joined IP clients
-	unordered_map<uint32_t, pair<int, struct sockaddr_in *>> _mcastDB_cNapIPSockets;
-	unordered_map<uint32_t, pair<int, struct sockaddr_in *>> ::iterator _mcastDB_cNapIPSocketsIt;
 	boost::mutex _mutexMcastDB_cNap;
+	//2. the groups whose data is delivered to locally joined IP clients,
+	// read without locking for every datagram
+	McastDataPath _mcastDataPath;
 	// Essentially, set this to false only to end the detached threads
 	// for maintaining this DB, stats, etc...
 	bool _runDetachedThds;
@@ -194,11 +200,16 @@ private:
 	// and Leave requests by IP clients unregistered to an MCast
 	unordered_map<uint32_t, int> _clientCounter; // mcast address -> how many client UEs
 	boost::mutex _mutexClientCounter;
+	// [cNAP] Groups without local IP clients which are still received from
+	// the sNAP, so that joining them again skips the control round trip
+	McastWarmGroups _warmGroups;
 	// [sNAP/cNAP] Used for bufferring both control and data packets until
 	// a proper BA event (e.g. a START_PUBLISH) takes place
 	packet_buffer_t _packetBuffer; /*!< Buffer for mcasted packets */
 	packet_buffer_t::iterator _bufferIt; /*!< Iterator for _buffer map */
-	boost::mutex _mutexBuffer; /*!< Mutex for transaction safe operations on _buffer */
+	packet_buffer_expiry_t _packetBufferExpiry;/*!< Expiry index of
+	_packetBuffer */
+	std::mutex _mutexBuffer; /*!< Mutex for transaction safe operations on _buffer */
 	boost::thread *_mcastBufferThread;
 	// What follows is subject to the properties file loaded with _loadSNapProps()
 	// supported multicast group IDs by this sNAP
@@ -386,6 +397,20 @@ private:
 	 * \brief TODO
 	 */
 	bool _mcastDB_cNapErase(IpAddress * multicastIpAddress_ptr);
+	/*!
+	 * \brief Tell the sNAP that this cNAP has left a group and remove the
+	 * group's <CTRL> state
+	 * \param groupAddr the multicast group */
+	void _leaveSNap(IpAddress &groupAddr);
+	/*!
+	 * \brief Keep receiving a group whose last IP client has left
+	 *
+	 * If the warm groups are exhausted the policy decides whether the group
+	 * replaces another warm group, which is left at the sNAP then.
+	 * \param groupAddr the multicast group
+	 * \return true if the group is kept warm and must not be left at the
+	 * sNAP */
+	bool _warmGroupKeep(IpAddress &groupAddr);
 };
 
 } /* namespace mcast */
@@ -0,0 +1,227 @@
+/*
+ * mcastdatapath.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "mcastdatapath.hh"
+
+using namespace namespaces::mcast;
+
+LoggerPtr McastDataPath::logger(Logger::getLogger("namespaces.mcast"));
+
+/*!
+ * \brief Datagrams queued by the calling thread
+ */
+static thread_local IpSocketBatch batch;
+
+/*!
+ * \brief Monotonic time in microseconds
+ */
+static uint64_t monotonicMicroseconds()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*!
+ * \brief Order groups by their address
+ */
+static bool groupLess(mcast_group_t *group, uint32_t address)
+{
+	return group->group < address;
+}
+
+McastDataPath::McastDataPath()
+	: _table(new mcast_group_table_t),
+	  _readers(0)
+{
+	_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+	if (_socket == -1)
+	{
+		LOG4CXX_FATAL(logger, "UDP socket for multicast clients could not be "
+				"created: " << strerror(errno));
+	}
+}
+
+McastDataPath::~McastDataPath()
+{
+	delete _table.load();
+
+	for (list<mcast_group_table_t *>::iterator it = _retiredTables.begin();
+			it != _retiredTables.end(); it++)
+	{
+		delete *it;
+	}
+
+	for (list<mcast_group_t *>::iterator it = _retiredGroups.begin();
+			it != _retiredGroups.end(); it++)
+	{
+		delete *it;
+	}
+
+	for (map<uint32_t, mcast_group_t *>::iterator it = _groups.begin();
+			it != _groups.end(); it++)
+	{
+		delete it->second;
+	}
+
+	if (_socket != -1)
+	{
+		close(_socket);
+	}
+}
+
+uint32_t McastDataPath::flush()
+{
+	uint32_t bytesSent;
+	batch.flush(_socket, bytesSent);
+	return bytesSent;
+}
+
+bool McastDataPath::full()
+{
+	return batch.full();
+}
+
+size_t McastDataPath::groups()
+{
+	size_t groups;
+	_mutex.lock();
+	groups = _groups.size();
+	_mutex.unlock();
+	return groups;
+}
+
+bool McastDataPath::join(uint32_t group, uint16_t port)
+{
+	_mutex.lock();
+
+	if (_groups.find(group) != _groups.end())
+	{
+		_mutex.unlock();
+		return false;
+	}
+
+	mcast_group_t *mcastGroup = new mcast_group_t;
+	mcastGroup->group = group;
+	bzero(&mcastGroup->destination, sizeof(struct sockaddr_in));
+	mcastGroup->destination.sin_family = AF_INET;
+	mcastGroup->destination.sin_addr.s_addr = group;
+	mcastGroup->destination.sin_port = htons(port);
+	mcastGroup->joined = monotonicMicroseconds();
+	mcastGroup->acquired = false;
+	_groups.insert(pair<uint32_t, mcast_group_t *>(group, mcastGroup));
+	_publish();
+	_mutex.unlock();
+	return true;
+}
+
+bool McastDataPath::leave(uint32_t group)
+{
+	map<uint32_t, mcast_group_t *>::iterator it;
+	_mutex.lock();
+	it = _groups.find(group);
+
+	if (it == _groups.end())
+	{
+		_mutex.unlock();
+		return false;
+	}
+
+	_retiredGroups.push_back(it->second);
+	_groups.erase(it);
+	_publish();
+	_mutex.unlock();
+	return true;
+}
+
+bool McastDataPath::queue(uint32_t group, uint8_t *data, uint16_t dataSize,
+		uint64_t &acquisitionTime)
+{
+	mcast_group_table_t *table;
+	mcast_group_table_t::iterator it;
+	acquisitionTime = 0;
+	// announce the read before loading the table, see _publish()
+	_readers.fetch_add(1);
+	table = _table.load();
+	it = lower_bound(table->begin(), table->end(), group, groupLess);
+
+	if (it == table->end() || (*it)->group != group)
+	{
+		_readers.fetch_sub(1);
+		return false;
+	}
+
+	batch.queue((*it)->destination, data, dataSize);
+
+	if (!(*it)->acquired.load(memory_order_relaxed) &&
+			!(*it)->acquired.exchange(true))
+	{
+		acquisitionTime = monotonicMicroseconds() - (*it)->joined;
+	}
+
+	_readers.fetch_sub(1);
+	return true;
+}
+
+void McastDataPath::_publish()
+{
+	mcast_group_table_t *table = new mcast_group_table_t;
+	table->reserve(_groups.size());
+
+	for (map<uint32_t, mcast_group_t *>::iterator it = _groups.begin();
+			it != _groups.end(); it++)
+	{
+		table->push_back(it->second);
+	}
+
+	_retiredTables.push_back(_table.exchange(table));
+
+	// A reader which still holds a replaced table registered itself before
+	// loading it. If there is none now, nothing retired can be in use anymore
+	if (_readers.load() == 0)
+	{
+		for (list<mcast_group_table_t *>::iterator it = _retiredTables.begin();
+				it != _retiredTables.end(); it++)
+		{
+			delete *it;
+		}
+
+		for (list<mcast_group_t *>::iterator it = _retiredGroups.begin();
+				it != _retiredGroups.end(); it++)
+		{
+			delete *it;
+		}
+
+		_retiredTables.clear();
+		_retiredGroups.clear();
+	}
+
+	LOG4CXX_DEBUG(logger, "Multicast group table with " << table->size()
+			<< " group(s) published");
+}
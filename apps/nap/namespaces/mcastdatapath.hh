@@ -0,0 +1,144 @@
+/*
+ * mcastdatapath.hh
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAP_NAMESPACES_MCASTDATAPATH_HH_
+#define NAP_NAMESPACES_MCASTDATAPATH_HH_
+
+#include <atomic>
+#include <list>
+#include <log4cxx/logger.h>
+#include <map>
+#include <mutex>
+#include <stdint.h>
+
+#include <namespaces/mcasttypedef.hh>
+#include <sockets/ipsocketbatch.hh>
+
+#ifdef DMALLOC
+#include "dmalloc.h"
+#endif
+
+using namespace ipsocket;
+using namespace log4cxx;
+using namespace std;
+
+namespace namespaces {
+
+namespace mcast {
+
+/*!
+ * \brief Delivery of IPTV data received via ICN to the local IP clients of a
+ * cNAP
+ *
+ * The groups joined by IP clients are kept in an immutable table sorted by
+ * group address. IGMP joins and leaves build a new table and swap the pointer
+ * the data path reads it from, so delivering a datagram takes no lock.
+ *
+ * All groups share one UDP socket. Datagrams are queued per thread and handed
+ * to the kernel with a single sendmmsg() call once the batch is full or
+ * flush() is called, i.e. when the ICN worker has no further events queued.
+ */
+class McastDataPath
+{
+	static LoggerPtr logger;
+public:
+	/*!
+	 * \brief Constructor
+	 */
+	McastDataPath();
+	/*!
+	 * \brief Destructor
+	 */
+	~McastDataPath();
+	/*!
+	 * \brief Send the datagrams queued by the calling thread
+	 *
+	 * \return The number of bytes sent
+	 */
+	uint32_t flush();
+	/*!
+	 * \brief Check whether the calling thread must flush its batch
+	 */
+	bool full();
+	/*!
+	 * \brief The number of joined groups
+	 */
+	size_t groups();
+	/*!
+	 * \brief Start delivering data of a multicast group to the IP clients
+	 *
+	 * The time of the join is taken as the start of the channel acquisition.
+	 *
+	 * \param group The group address in network byte order
+	 * \param port The UDP port the IP clients listen on
+	 *
+	 * \return False if the group has been joined already
+	 */
+	bool join(uint32_t group, uint16_t port);
+	/*!
+	 * \brief Stop delivering data of a multicast group
+	 *
+	 * \param group The group address in network byte order
+	 *
+	 * \return False if the group has not been joined
+	 */
+	bool leave(uint32_t group);
+	/*!
+	 * \brief Queue a datagram for the IP clients of a multicast group
+	 *
+	 * The data is copied, so the caller may release it right away. The
+	 * caller must call flush() once full() returns true.
+	 *
+	 * \param group The group address in network byte order
+	 * \param data Pointer to the UDP payload
+	 * \param dataSize The size of the UDP payload
+	 * \param acquisitionTime Set to the time in microseconds between joining
+	 * the group and this datagram if it is the first one delivered since.
+	 * Set to 0 otherwise
+	 *
+	 * \return False if the group is unknown and the datagram was dropped
+	 */
+	bool queue(uint32_t group, uint8_t *data, uint16_t dataSize,
+			uint64_t &acquisitionTime);
+private:
+	int _socket;/*!< UDP socket shared by all groups */
+	std::atomic<mcast_group_table_t *> _table;/*!< The current group table */
+	std::atomic<uint32_t> _readers;/*!< Threads currently reading a table */
+	map<uint32_t, mcast_group_t *> _groups;/*!< All joined groups */
+	list<mcast_group_table_t *> _retiredTables;/*!< Replaced tables which
+	might still be read */
+	list<mcast_group_t *> _retiredGroups;/*!< Left groups which might still
+	be read */
+	std::mutex _mutex;/*!< Serialises joins and leaves */
+	/*!
+	 * \brief Build a table from _groups and publish it
+	 *
+	 * Replaced tables and left groups are freed as soon as no thread is
+	 * reading a table. The caller must hold _mutex.
+	 */
+	void _publish();
+};
+
+} /* namespace mcast */
+
+} /* namespace namespaces */
+
+#endif /* NAP_NAMESPACES_MCASTDATAPATH_HH_ */
@@ -0,0 +1,58 @@
+/*
+ * mcasttypedef.hh
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAP_NAMESPACES_MCASTTYPEDEF_HH_
+#define NAP_NAMESPACES_MCASTTYPEDEF_HH_
+
+#include <atomic>
+#include <netinet/in.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include <types/expirywheel.hh>
+#include <types/icnid.hh>
+#include <types/typedef.hh>
+
+using namespace std;
+
+/*!
+ * \brief A multicast group joined by IP clients attached to this cNAP
+ */
+struct mcast_group_t
+{
+	uint32_t group;/*!< The group address in network byte order */
+	struct sockaddr_in destination;/*!< Where its data is sent to */
+	uint64_t joined;/*!< When the first client joined (monotonic clock in
+	microseconds) */
+	std::atomic<bool> acquired;/*!< The first datum has been sent */
+};
+
+typedef vector<mcast_group_t *> mcast_group_table_t;/*!< Joined groups
+		sorted by their address. Never modified once published */
+
+typedef unordered_map<cid_t, pair<IcnId, packet_t>> packet_buffer_t ; /*!<
+ 	 	 unordered_map<hashedCID, pair<CID, Packet>>*/
+
+typedef ExpiryWheel<cid_t> packet_buffer_expiry_t;/*!< Expiry index of
+		packet_buffer_t */
+
+#endif /* NAP_NAMESPACES_MCASTTYPEDEF_HH_ */
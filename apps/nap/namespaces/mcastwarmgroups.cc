@@ -0,0 +1,122 @@
+/*
+ * mcastwarmgroups.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "mcastwarmgroups.hh"
+
+using namespace namespaces::mcast;
+
+McastWarmGroups::McastWarmGroups()
+	: _groups(0),
+	  _policy(IGMP_WARM_GROUPS_RECENT)
+{}
+
+void McastWarmGroups::configure(uint16_t groups,
+		igmp_warm_groups_policy_t policy)
+{
+	_mutex.lock();
+	_groups = groups;
+	_policy = policy;
+	_mutex.unlock();
+}
+
+bool McastWarmGroups::join(uint32_t group)
+{
+	list<uint32_t>::iterator it;
+	_mutex.lock();
+
+	if (_groups == 0)
+	{
+		_mutex.unlock();
+		return false;
+	}
+
+	_joins[group]++;
+	it = find(_warmGroups.begin(), _warmGroups.end(), group);
+
+	if (it == _warmGroups.end())
+	{
+		_mutex.unlock();
+		return false;
+	}
+
+	_warmGroups.erase(it);
+	_mutex.unlock();
+	return true;
+}
+
+bool McastWarmGroups::keep(uint32_t group, uint32_t &evicted)
+{
+	list<uint32_t>::iterator it;
+	list<uint32_t>::iterator evictIt;
+	evicted = 0;
+	_mutex.lock();
+
+	if (_groups == 0)
+	{
+		_mutex.unlock();
+		return false;
+	}
+
+	if (_warmGroups.size() < _groups)
+	{
+		_warmGroups.push_front(group);
+		_mutex.unlock();
+		return true;
+	}
+
+	// least recently left group
+	evictIt = --_warmGroups.end();
+
+	if (_policy == IGMP_WARM_GROUPS_POPULAR)
+	{
+		// least often joined group, the least recently left one among equals
+		for (it = _warmGroups.begin(); it != _warmGroups.end(); it++)
+		{
+			if (_joins[*it] <= _joins[*evictIt])
+			{
+				evictIt = it;
+			}
+		}
+
+		if (_joins[group] < _joins[*evictIt])
+		{
+			_mutex.unlock();
+			return false;
+		}
+	}
+
+	evicted = *evictIt;
+	_warmGroups.erase(evictIt);
+	_warmGroups.push_front(group);
+	_mutex.unlock();
+	return true;
+}
+
+size_t McastWarmGroups::size()
+{
+	size_t size;
+	_mutex.lock();
+	size = _warmGroups.size();
+	_mutex.unlock();
+	return size;
+}
@@ -0,0 +1,103 @@
+/*
+ * mcastwarmgroups.hh
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAP_NAMESPACES_MCASTWARMGROUPS_HH_
+#define NAP_NAMESPACES_MCASTWARMGROUPS_HH_
+
+#include <list>
+#include <mutex>
+#include <stdint.h>
+#include <unordered_map>
+
+#include <types/enumerations.hh>
+
+#ifdef DMALLOC
+#include "dmalloc.h"
+#endif
+
+using namespace std;
+
+namespace namespaces {
+
+namespace mcast {
+
+/*!
+ * \brief Multicast groups a cNAP keeps receiving from the sNAP after their
+ * last IP client has left
+ *
+ * Joining a warm group again only has to re-enable the delivery to the IP
+ * clients, while any other join waits for the IGMP/ICN control round trip to
+ * the sNAP. Which groups stay warm is decided from the IGMP history of the
+ * cNAP: either the most recently left or the most often joined groups.
+ */
+class McastWarmGroups
+{
+public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * No group is kept warm before configure() has been called.
+	 */
+	McastWarmGroups();
+	/*!
+	 * \brief Set the number of warm groups and the policy
+	 *
+	 * \param groups The maximum number of warm groups. 0 disables keeping
+	 * groups warm
+	 * \param policy Which groups are kept warm
+	 */
+	void configure(uint16_t groups, igmp_warm_groups_policy_t policy);
+	/*!
+	 * \brief Record an IGMP join of a group without local IP clients
+	 *
+	 * \param group The group address
+	 *
+	 * \return True if the group was warm. It is not warm anymore afterwards
+	 */
+	bool join(uint32_t group);
+	/*!
+	 * \brief Keep receiving a group whose last IP client has left
+	 *
+	 * \param group The group address
+	 * \param evicted Set to the group which the policy gave up in favour of
+	 * this one and which must be left at the sNAP now. 0 if none
+	 *
+	 * \return True if the group is kept warm and must not be left at the sNAP
+	 */
+	bool keep(uint32_t group, uint32_t &evicted);
+	/*!
+	 * \brief The number of warm groups
+	 */
+	size_t size();
+private:
+	uint16_t _groups;/*!< Maximum number of warm groups */
+	igmp_warm_groups_policy_t _policy;/*!< Which groups are kept warm */
+	list<uint32_t> _warmGroups;/*!< Warm groups, most recently left first */
+	unordered_map<uint32_t, uint32_t> _joins;/*!< IGMP history: how often
+	each group has been joined */
+	std::mutex _mutex;/*!< Mutex for all members above */
+};
+
+} /* namespace mcast */
+
+} /* namespace namespaces */
+
+#endif /* NAP_NAMESPACES_MCASTWARMGROUPS_HH_ */
@@ -95,77 +95,16 @@ bool HeaderParser::mpdResponse(uint8_t *packet, uint16_t &packetSize)
 
 string HeaderParser::readFqdn(char *packet, uint16_t &packetSize)
 {
-	string httpPacket;
-	size_t pos = 0;
-	ostringstream fqdn;
-
-	// limit the num of bytes to be parsed in case POST/PUT arrived w/o header
-	if (packetSize > 1000)
-	{//limit the packet size to not parse a large message for nothing
-		httpPacket.assign(packet, 1000);
-	}
-	else
-	{
-		httpPacket.assign(packet, packetSize);
-	}
-
-	// make the string lower case
-	std::transform(httpPacket.begin(), httpPacket.end(), httpPacket.begin(),
-			::tolower);
-	pos = httpPacket.find("host: ", ++pos);
+	http_request_header_t header;
 
-	if (pos != std::string::npos)
-	{
-		size_t fqdnLength = 0;
-		size_t positionStart = pos + 6;
-		string character;
-		character = httpPacket[positionStart];
-
-		// First get length of FQDN
-		while (strcmp(character.c_str(), "\n") != 0 &&
-				(pos + 6) <= packetSize)
-		{
-			fqdnLength++;
-			pos++;
-			character = httpPacket[pos + 6];
-		}
-
-
-		size_t it = 0;
-		string colon(":");
-		/* Now read the FQDN until end (and ignore last blank character) or
-		 * until ':' character occurs. Some clients add the non-standard HTTP
-		 * port to the host field as the FQDN, e.g. an HTTP request to
-		 * sync.point on Port 3127 becomes 'host: sync.flips:3127'
-		 */
-		while (it < (fqdnLength - 1))
-		{
-			character = httpPacket[positionStart + it];
-
-			if (character.compare(colon) == 0)
-			{
-				LOG4CXX_DEBUG(logger, "FQDN was given including the server port"
-						" ... truncated this information from FQDN")
-				it = fqdnLength;
-			}
-			else
-			{
-				fqdn << httpPacket[positionStart + it];
-				it++;
-			}
-		}
-
-		LOG4CXX_DEBUG(logger, "FQDN '" << fqdn.str() << "' found in HTTP"
-				"request");
-	}
-	else
+	if (!parseHttpRequest(packet, packetSize, header) ||
+			header.fqdnLength == 0)
 	{
 		LOG4CXX_TRACE(logger, "FQDN could not be found in HTTP request");
+		return string();
 	}
 
-	LOG4CXX_ASSERT(logger, fqdn.str().length() == 0, "FQDN not present in HTTP "
-			"request");
-	return fqdn.str();
+	return string(header.fqdn, header.fqdnLength);
 }
 
 http_methods_t HeaderParser::readHttpRequestMethod(uint8_t *packet,
@@ -176,19 +115,25 @@ http_methods_t HeaderParser::readHttpRequestMethod(uint8_t *packet,
 
 http_methods_t HeaderParser::readHttpRequestMethod(char *packet,
 		uint16_t &packetSize)
+{
+	http_request_header_t header;
+	parseHttpRequest(packet, packetSize, header);
+	return header.method;
+}
+
+http_methods_t HeaderParser::readHttpResponseMethod(uint8_t *packet,
+		uint16_t &packetSize)
+{
+	return readHttpResponseMethod((char *)packet, packetSize);
+}
+
+http_methods_t HeaderParser::readHttpResponseMethod(char *packet,
+		uint16_t &packetSize)
 {
 	string httpPacket;
 	http_methods_t httpMethod = HTTP_METHOD_UNKNOWN;
 	size_t pos = 0;
-	size_t posConnect = 0;
-	size_t posDelete = 0;
-	size_t posExtension = 0;
-	size_t posGet = 0;
-	size_t posHead = 0;
-	size_t posOptions = 0;
-	size_t posPost = 0;
-	size_t posPut = 0;
-	size_t posTrace = 0;
+	size_t posOk = 0;
 
 	if (packetSize < 50)
 	{
@@ -205,188 +150,599 @@ http_methods_t HeaderParser::readHttpRequestMethod(char *packet,
 	while (httpMethod == HTTP_METHOD_UNKNOWN)
 	{
 		pos++;
-		posConnect = httpPacket.find("connect", ++posConnect);
+		posOk = httpPacket.find("ok", ++posOk);
 
-		if (posConnect != std::string::npos)
+		if (posOk != std::string::npos)
 		{
-			httpMethod = HTTP_METHOD_REQUEST_CONNECT;
+			httpMethod = HTTP_METHOD_RESPONSE_OK;
 			break;
 		}
 
-		posDelete = httpPacket.find("delete", ++posDelete);
-
-		if (posDelete != std::string::npos)
+		// End of packet reached
+		if (pos == packetSize)
 		{
-			httpMethod = HTTP_METHOD_REQUEST_DELETE;
 			break;
 		}
+	}
 
-		posExtension = httpPacket.find("extension", ++posExtension);
+	if (httpMethod != HTTP_METHOD_UNKNOWN)
+	{
+		LOG4CXX_TRACE(logger, "Method '" << httpMethod << "' found in HTTP "
+				"response");
+	}
+
+	return httpMethod;
+}
+
+string HeaderParser::readResource(uint8_t *packet, uint16_t &packetSize)
+{
+	return readResource((char *)packet, packetSize);
+}
+
+string HeaderParser::readResource(char *packet, uint16_t &packetSize)
+{
+	http_request_header_t header;
+
+	if (!parseHttpRequest(packet, packetSize, header))
+	{
+		LOG4CXX_ERROR(logger, "Could not find resource in HTTP packet");
+		return string("/");
+	}
+
+	return string(header.resource, header.resourceLength);
+}
 
-		if (posExtension != std::string::npos)
+bool HeaderParser::parseHttpRequest(const char *packet, uint16_t packetSize,
+		http_request_header_t &header)
+{
+	const char *end = packet + packetSize;
+	const char *line = packet;
+	const char *lineEnd;
+	const char *target;
+	const char *targetEnd;
+	size_t lineLength;
+	header.method = HTTP_METHOD_UNKNOWN;
+	header.fqdn[0] = '\0';
+	header.fqdnLength = 0;
+	header.resource = NULL;
+	header.resourceLength = 0;
+	header.contentLength = 0;
+	header.headerLength = 0;
+	header.cacheable = false;
+	bool bypassCache = false;
+	// memchr() is vectorised by libc and does the bulk of the work below
+	lineEnd = (const char *)memchr(line, '\n', packetSize);
+
+	if (lineEnd == NULL)
+	{
+		return false;
+	}
+
+	// Request line: method SP request-target SP HTTP-version
+	target = (const char *)memchr(line, ' ', lineEnd - line);
+
+	if (target == NULL)
+	{
+		return false;
+	}
+
+	target++;
+	targetEnd = (const char *)memchr(target, ' ', lineEnd - target);
+
+	if (targetEnd == NULL || lineEnd - targetEnd < 9 ||
+			memcmp(targetEnd + 1, "HTTP/", 5) != 0)
+	{
+		return false;
+	}
+
+	header.method = _requestMethod(line, target - line - 1);
+
+	if (header.method == HTTP_METHOD_UNKNOWN)
+	{
+		header.method = HTTP_METHOD_REQUEST_EXTENSION;
+	}
+
+	// absolute-form as sent to explicitly configured proxies
+	if (targetEnd - target > 7 && strncasecmp(target, "http://", 7) == 0)
+	{
+		header.resource = (const char *)memchr(target + 7, '/',
+				targetEnd - target - 7);
+
+		if (header.resource == NULL)
 		{
-			httpMethod = HTTP_METHOD_REQUEST_EXTENSION;
-			break;
+			header.resource = targetEnd;
 		}
 
-		posGet = httpPacket.find("get", ++posGet);
+		_copyFqdn(target + 7, header.resource, header);
 
-		if (posGet != std::string::npos)
+		if (header.resource == targetEnd)
 		{
-			httpMethod = HTTP_METHOD_REQUEST_GET;
-			break;
+			header.resource = "/";
+			header.resourceLength = 1;
 		}
+		else
+		{
+			header.resourceLength = targetEnd - header.resource;
+		}
+	}
+	else
+	{
+		header.resource = target;
+		header.resourceLength = targetEnd - target;
+	}
 
-		posHead = httpPacket.find("head", ++posHead);
+	// Header fields until the empty line
+	line = lineEnd + 1;
 
-		if (posHead != std::string::npos)
+	while (line < end)
+	{
+		lineEnd = (const char *)memchr(line, '\n', end - line);
+
+		// header continues in the next TCP segment
+		if (lineEnd == NULL)
 		{
-			httpMethod = HTTP_METHOD_REQUEST_HEAD;
 			break;
 		}
 
-		posOptions = httpPacket.find("options", ++posOptions);
+		lineLength = lineEnd - line;
 
-		if (posOptions != std::string::npos)
+		if (lineLength > 0 && line[lineLength - 1] == '\r')
 		{
-			httpMethod = HTTP_METHOD_REQUEST_OPTIONS;
-			break;
+			lineLength--;
 		}
 
-		posPost = httpPacket.find("post", ++posPost);
+		if (lineLength == 0)
+		{
+			header.headerLength = lineEnd + 1 - packet;
+			break;
+		}
 
-		if (posPost != std::string::npos)
+		switch (line[0])
 		{
-			httpMethod = HTTP_METHOD_REQUEST_POST;
+		case 'a':
+		case 'A':
+			if (lineLength > 14 && strncasecmp(line, "authorization:", 14) == 0)
+			{
+				bypassCache = true;
+			}
+
+			break;
+		case 'h':
+		case 'H':
+			if (header.fqdnLength == 0 && lineLength > 5 &&
+					strncasecmp(line, "host:", 5) == 0)
+			{
+				_copyFqdn(line + 5, line + lineLength, header);
+			}
+
+			break;
+		case 'p':
+		case 'P':
+			if (lineLength > 7 && strncasecmp(line, "pragma:", 7) == 0 &&
+					_contains(line + 7, line + lineLength, "no-cache"))
+			{
+				bypassCache = true;
+			}
+
+			break;
+		case 'r':
+		case 'R':
+			if (lineLength > 6 && strncasecmp(line, "range:", 6) == 0)
+			{
+				bypassCache = true;
+			}
+
+			break;
+		case 'c':
+		case 'C':
+			if (lineLength > 14 &&
+					strncasecmp(line, "cache-control:", 14) == 0)
+			{
+				if (_contains(line + 14, line + lineLength, "no-cache") ||
+						_contains(line + 14, line + lineLength, "no-store") ||
+						_contains(line + 14, line + lineLength, "max-age=0"))
+				{
+					bypassCache = true;
+				}
+			}
+			else if (lineLength > 15 &&
+					strncasecmp(line, "content-length:", 15) == 0)
+			{
+				for (size_t i = 15; i < lineLength; i++)
+				{
+					if (line[i] >= '0' && line[i] <= '9')
+					{
+						header.contentLength = header.contentLength * 10 +
+								(line[i] - '0');
+					}
+					else if (line[i] != ' ' && line[i] != '\t')
+					{
+						break;
+					}
+				}
+			}
+
 			break;
 		}
 
-		posPut = httpPacket.find("put", ++posPut);
+		line = lineEnd + 1;
+	}
 
-		if (posPut != std::string::npos)
+	header.cacheable = (header.method == HTTP_METHOD_REQUEST_GET &&
+			header.headerLength > 0 && header.contentLength == 0 &&
+			!bypassCache);
+	LOG4CXX_TRACE(logger, "HTTP request parsed: method " << header.method
+			<< ", FQDN '" << header.fqdn << "', resource '"
+			<< string(header.resource, header.resourceLength)
+			<< "', content length " << header.contentLength
+			<< ", header length " << header.headerLength);
+	return true;
+}
+
+bool HeaderParser::parseHttpResponse(const char *packet, uint16_t packetSize,
+		http_response_header_t &header)
+{
+	const char *end = packet + packetSize;
+	const char *line = packet;
+	const char *lineEnd;
+	const char *value;
+	size_t lineLength;
+	header.statusCode = 0;
+	header.contentLengthPresent = false;
+	header.contentLength = 0;
+	header.chunked = false;
+	header.keepAlive = false;
+	header.headerLength = 0;
+	header.noStore = false;
+	header.maxAge = -1;
+	header.age = 0;
+	header.date = 0;
+	header.expires = 0;
+	lineEnd = (const char *)memchr(line, '\n', packetSize);
+
+	// Status line: HTTP/1.x SP 3DIGIT SP reason-phrase
+	if (lineEnd == NULL || lineEnd - line < 12 ||
+			memcmp(line, "HTTP/1.", 7) != 0 || line[8] != ' ')
+	{
+		return false;
+	}
+
+	for (uint8_t i = 9; i < 12; i++)
+	{
+		if (line[i] < '0' || line[i] > '9')
 		{
-			httpMethod = HTTP_METHOD_REQUEST_PUT;
-			break;
+			return false;
 		}
 
-		posPut = httpPacket.find("delete", ++posPut);
+		header.statusCode = header.statusCode * 10 + (line[i] - '0');
+	}
+
+	// persistent by default as of HTTP/1.1
+	header.keepAlive = (line[7] != '0');
+	line = lineEnd + 1;
+
+	while (line < end)
+	{
+		lineEnd = (const char *)memchr(line, '\n', end - line);
 
-		if (posPut != std::string::npos)
+		if (lineEnd == NULL)
 		{
-			httpMethod = HTTP_METHOD_REQUEST_DELETE;
 			break;
 		}
 
-		posTrace = httpPacket.find("trace", ++posTrace);
+		lineLength = lineEnd - line;
+
+		if (lineLength > 0 && line[lineLength - 1] == '\r')
+		{
+			lineLength--;
+		}
 
-		if (posTrace != std::string::npos)
+		if (lineLength == 0)
 		{
-			httpMethod = HTTP_METHOD_REQUEST_TRACE;
+			header.headerLength = lineEnd + 1 - packet;
 			break;
 		}
 
-		// End of packet reached
-		if (pos == packetSize)
+		switch (line[0])
 		{
+		case 'a':
+		case 'A':
+			if (lineLength > 4 && strncasecmp(line, "age:", 4) == 0)
+			{
+				header.age = strtoul(string(line + 4, lineLength - 4).c_str(),
+						NULL, 10);
+			}
+
+			break;
+		case 'd':
+		case 'D':
+			if (lineLength > 5 && strncasecmp(line, "date:", 5) == 0)
+			{
+				header.date = _httpDate(line + 5, line + lineLength);
+			}
+
+			break;
+		case 'e':
+		case 'E':
+			if (lineLength > 8 && strncasecmp(line, "expires:", 8) == 0)
+			{
+				header.expires = _httpDate(line + 8, line + lineLength);
+
+				if (header.expires == 0)
+				{
+					header.expires = 1;
+				}
+			}
+
+			break;
+		case 'p':
+		case 'P':
+			if (lineLength > 7 && strncasecmp(line, "pragma:", 7) == 0 &&
+					_contains(line + 7, line + lineLength, "no-cache"))
+			{
+				header.noStore = true;
+			}
+
+			break;
+		case 's':
+		case 'S':
+			if (lineLength > 11 && strncasecmp(line, "set-cookie:", 11) == 0)
+			{
+				header.noStore = true;
+			}
+
+			break;
+		case 'v':
+		case 'V':
+			// the cache does not keep variants
+			if (lineLength > 5 && strncasecmp(line, "vary:", 5) == 0)
+			{
+				header.noStore = true;
+			}
+
+			break;
+		case 'c':
+		case 'C':
+			if (lineLength > 14 &&
+					strncasecmp(line, "cache-control:", 14) == 0)
+			{
+				_cacheControl(line + 14, line + lineLength, header);
+			}
+			else if (lineLength > 15 &&
+					strncasecmp(line, "content-length:", 15) == 0)
+			{
+				header.contentLengthPresent = true;
+
+				for (size_t i = 15; i < lineLength; i++)
+				{
+					if (line[i] >= '0' && line[i] <= '9')
+					{
+						header.contentLength = header.contentLength * 10 +
+								(line[i] - '0');
+					}
+					else if (line[i] != ' ' && line[i] != '\t')
+					{
+						break;
+					}
+				}
+			}
+			else if (lineLength > 11 &&
+					strncasecmp(line, "connection:", 11) == 0)
+			{
+				value = line + 11;
+
+				while (value < line + lineLength && *value == ' ')
+				{
+					value++;
+				}
+
+				if (line + lineLength - value >= 5 &&
+						strncasecmp(value, "close", 5) == 0)
+				{
+					header.keepAlive = false;
+				}
+				else if (line + lineLength - value >= 10 &&
+						strncasecmp(value, "keep-alive", 10) == 0)
+				{
+					header.keepAlive = true;
+				}
+			}
+
+			break;
+		case 't':
+		case 'T':
+			// chunked must be the last transfer coding
+			if (lineLength > 25 &&
+					strncasecmp(line, "transfer-encoding:", 18) == 0 &&
+					strncasecmp(line + lineLength - 7, "chunked", 7) == 0)
+			{
+				header.chunked = true;
+			}
+
 			break;
 		}
+
+		line = lineEnd + 1;
 	}
 
-	if (httpMethod != HTTP_METHOD_UNKNOWN)
+	LOG4CXX_TRACE(logger, "HTTP response parsed: status " << header.statusCode
+			<< ", content length " << header.contentLength << ", chunked "
+			<< header.chunked << ", keep-alive " << header.keepAlive
+			<< ", header length " << header.headerLength);
+	return true;
+}
+
+void HeaderParser::_cacheControl(const char *begin, const char *end,
+		http_response_header_t &header)
+{
+	const char *directive = begin;
+	const char *directiveEnd;
+	int32_t maxAge = -1;
+	bool sMaxAge = false;
+
+	while (directive < end)
 	{
-		LOG4CXX_TRACE(logger, "Method '" << httpMethod << "' found in HTTP "
-				"request");
+		while (directive < end && (*directive == ' ' || *directive == '\t' ||
+				*directive == ','))
+		{
+			directive++;
+		}
+
+		directiveEnd = (const char *)memchr(directive, ',', end - directive);
+
+		if (directiveEnd == NULL)
+		{
+			directiveEnd = end;
+		}
+
+		if ((directiveEnd - directive >= 8 &&
+				(strncasecmp(directive, "no-store", 8) == 0 ||
+						strncasecmp(directive, "no-cache", 8) == 0)) ||
+				(directiveEnd - directive >= 7 &&
+						strncasecmp(directive, "private", 7) == 0))
+		{
+			header.noStore = true;
+		}
+		else if (directiveEnd - directive > 9 &&
+				strncasecmp(directive, "s-maxage=", 9) == 0)
+		{
+			maxAge = atoi(string(directive + 9, directiveEnd - directive - 9)
+					.c_str());
+			sMaxAge = true;
+		}
+		else if (!sMaxAge && directiveEnd - directive > 8 &&
+				strncasecmp(directive, "max-age=", 8) == 0)
+		{
+			maxAge = atoi(string(directive + 8, directiveEnd - directive - 8)
+					.c_str());
+		}
+
+		directive = directiveEnd;
 	}
 
-	return httpMethod;
+	if (maxAge >= 0)
+	{
+		header.maxAge = maxAge;
+	}
 }
 
-http_methods_t HeaderParser::readHttpResponseMethod(uint8_t *packet,
-		uint16_t &packetSize)
+bool HeaderParser::_contains(const char *begin, const char *end,
+		const char *token)
 {
-	return readHttpResponseMethod((char *)packet, packetSize);
+	size_t tokenLength = strlen(token);
+
+	for (const char *c = begin; c + tokenLength <= end; c++)
+	{
+		if (strncasecmp(c, token, tokenLength) == 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
 }
 
-http_methods_t HeaderParser::readHttpResponseMethod(char *packet,
-		uint16_t &packetSize)
+time_t HeaderParser::_httpDate(const char *begin, const char *end)
 {
-	string httpPacket;
-	http_methods_t httpMethod = HTTP_METHOD_UNKNOWN;
-	size_t pos = 0;
-	size_t posOk = 0;
+	struct tm tm;
+	string date;
 
-	if (packetSize < 50)
+	while (begin < end && (*begin == ' ' || *begin == '\t'))
 	{
-		httpPacket.assign(packet, packetSize);
+		begin++;
 	}
-	else
+
+	date.assign(begin, end - begin);
+	bzero(&tm, sizeof(tm));
+
+	// e.g. Sun, 06 Nov 1994 08:49:37 GMT
+	if (strptime(date.c_str(), "%a, %d %b %Y %H:%M:%S", &tm) == NULL)
 	{
-		httpPacket.assign(packet, 50);
+		return 0;
 	}
 
-	std::transform(httpPacket.begin(), httpPacket.end(), httpPacket.begin(),
-				::tolower);
+	return timegm(&tm);
+}
 
-	while (httpMethod == HTTP_METHOD_UNKNOWN)
+void HeaderParser::_copyFqdn(const char *begin, const char *end,
+		http_request_header_t &header)
+{
+	while (begin < end && (*begin == ' ' || *begin == '\t'))
 	{
-		pos++;
-		posOk = httpPacket.find("ok", ++posOk);
+		begin++;
+	}
 
-		if (posOk != std::string::npos)
+	header.fqdnLength = 0;
+
+	/* Some clients add the non-standard HTTP port to the host field, e.g. an
+	 * HTTP request to sync.point on Port 3127 becomes 'host: sync.flips:3127'.
+	 * The port is truncated from the FQDN
+	 */
+	while (begin < end && header.fqdnLength < sizeof(header.fqdn) - 1 &&
+			*begin != ':' && *begin != ' ' && *begin != '\t')
+	{
+		header.fqdn[header.fqdnLength++] = tolower(*begin);
+		begin++;
+	}
+
+	header.fqdn[header.fqdnLength] = '\0';
+}
+
+http_methods_t HeaderParser::_requestMethod(const char *token, size_t length)
+{
+	switch (length)
+	{
+	case 3:
+		if (strncasecmp(token, "GET", 3) == 0)
 		{
-			httpMethod = HTTP_METHOD_RESPONSE_OK;
-			break;
+			return HTTP_METHOD_REQUEST_GET;
 		}
 
-		// End of packet reached
-		if (pos == packetSize)
+		if (strncasecmp(token, "PUT", 3) == 0)
 		{
-			break;
+			return HTTP_METHOD_REQUEST_PUT;
 		}
-	}
 
-	if (httpMethod != HTTP_METHOD_UNKNOWN)
-	{
-		LOG4CXX_TRACE(logger, "Method '" << httpMethod << "' found in HTTP "
-				"response");
-	}
+		break;
+	case 4:
+		if (strncasecmp(token, "HEAD", 4) == 0)
+		{
+			return HTTP_METHOD_REQUEST_HEAD;
+		}
 
-	return httpMethod;
-}
+		if (strncasecmp(token, "POST", 4) == 0)
+		{
+			return HTTP_METHOD_REQUEST_POST;
+		}
 
-string HeaderParser::readResource(uint8_t *packet, uint16_t &packetSize)
-{
-	return readResource(packet, packetSize);
-}
+		break;
+	case 5:
+		if (strncasecmp(token, "TRACE", 5) == 0)
+		{
+			return HTTP_METHOD_REQUEST_TRACE;
+		}
 
-string HeaderParser::readResource(char *packet, uint16_t &packetSize)
-{
-	string httpPacket;
-	size_t pos = 0;
-	ostringstream resource;
-	httpPacket.assign(packet, packetSize);
-	resource << "/";
-	pos = httpPacket.find(" /", ++pos);
+		break;
+	case 6:
+		if (strncasecmp(token, "DELETE", 6) == 0)
+		{
+			return HTTP_METHOD_REQUEST_DELETE;
+		}
 
-	if (pos != std::string::npos)
-	{
-		string character;
-		character = httpPacket[pos + 2];
+		break;
+	case 7:
+		if (strncasecmp(token, "OPTIONS", 7) == 0)
+		{
+			return HTTP_METHOD_REQUEST_OPTIONS;
+		}
 
-		while (strcmp(character.c_str(), " ") != 0)
+		if (strncasecmp(token, "CONNECT", 7) == 0)
 		{
-			resource << httpPacket[pos + 2];
-			pos++;
-			character = httpPacket[pos + 2];
+			return HTTP_METHOD_REQUEST_CONNECT;
 		}
-	}
-	else
-	{
-		LOG4CXX_ERROR(logger, "Could not find resource in HTTP packet");
-	}
 
-	LOG4CXX_TRACE(logger, "Resource '" << resource.str() << "' found in HTTP"
-			" request");
+		break;
+	}
 
-	return resource.str();
+	return HTTP_METHOD_UNKNOWN;
 }
@@ -24,7 +24,12 @@
 
 #include <algorithm>
 #include <log4cxx/logger.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <time.h>
 
 #include <types/enumerations.hh>
 
@@ -37,6 +42,53 @@ namespace http
 {
 namespace headerparser
 {
+/*!
+ * \brief Request line and headers of an HTTP request relevant to the proxy
+ *
+ * Filled by HeaderParser::parseHttpRequest() without any heap allocation. The
+ * resource points into the parsed packet and is only valid as long as the
+ * packet is.
+ */
+struct http_request_header_t
+{
+	http_methods_t method;/*!< HTTP_METHOD_UNKNOWN if the packet does not start
+	with a request line, e.g. the 2nd++ TCP segment of a POST */
+	char fqdn[256];/*!< Lower case FQDN from the Host header (or the absolute
+	request URI) without port. Null-terminated, empty if not present */
+	uint16_t fqdnLength;/*!< Length of fqdn */
+	const char *resource;/*!< Resource of the request line starting with '/' */
+	uint16_t resourceLength;/*!< Length of resource */
+	uint32_t contentLength;/*!< Value of Content-Length, 0 if not present */
+	uint16_t headerLength;/*!< Length of request line and headers including the
+	empty line. 0 if the header does not end within the packet */
+	bool cacheable;/*!< Entire GET request without body, Authorization, Range
+	or a Cache-Control/Pragma directive asking to bypass caches */
+};
+/*!
+ * \brief Status line and framing headers of an HTTP response
+ *
+ * Filled by HeaderParser::parseHttpResponse() without any heap allocation
+ */
+struct http_response_header_t
+{
+	uint16_t statusCode;/*!< The status code, e.g. 200 */
+	bool contentLengthPresent;/*!< Whether a Content-Length header exists */
+	uint32_t contentLength;/*!< Value of Content-Length, 0 if not present */
+	bool chunked;/*!< Transfer-Encoding is chunked */
+	bool keepAlive;/*!< The server keeps the connection open after the
+	response (HTTP/1.1 without 'Connection: close' or HTTP/1.0 with
+	'Connection: keep-alive') */
+	uint16_t headerLength;/*!< Length of status line and headers including the
+	empty line. 0 if the header does not end within the packet */
+	bool noStore;/*!< A shared cache must not store the response: no-store,
+	no-cache or private directive, Pragma: no-cache, Set-Cookie or Vary */
+	int32_t maxAge;/*!< s-maxage, or max-age if not present, in seconds. -1 if
+	neither is present */
+	uint32_t age;/*!< Value of the Age header, 0 if not present */
+	time_t date;/*!< Value of the Date header, 0 if not present */
+	time_t expires;/*!< Value of the Expires header, 0 if not present and 1 if
+	it is not a valid date (i.e. already expired) */
+};
 /*!
  * \brief Implementation of all methods to parse HTTP headers
  */
@@ -52,6 +104,36 @@ protected:
 	 * \brief Destructor
 	 */
 	~HeaderParser();
+	/*!
+	 * \brief Parse the request line and headers of an HTTP request
+	 *
+	 * The packet is walked once, line by line, and none of it is copied apart
+	 * from the FQDN. Method, FQDN, resource and content length are all obtained
+	 * by this call, so callers requiring more than one of them should use it
+	 * instead of the individual read*() methods.
+	 *
+	 * \param packet Pointer to the HTTP packet
+	 * \param packetSize Length of the HTTP packet
+	 * \param header The parsed request
+	 *
+	 * \return False if the packet does not start with an HTTP request line
+	 */
+	bool parseHttpRequest(const char *packet, uint16_t packetSize,
+			http_request_header_t &header);
+	/*!
+	 * \brief Parse the status line and headers of an HTTP response
+	 *
+	 * Like parseHttpRequest() the packet is walked once. Only the fields
+	 * required to determine where the response ends are obtained.
+	 *
+	 * \param packet Pointer to the first segment of the HTTP response
+	 * \param packetSize Length of the segment
+	 * \param header The parsed response
+	 *
+	 * \return False if the packet does not start with an HTTP status line
+	 */
+	bool parseHttpResponse(const char *packet, uint16_t packetSize,
+			http_response_header_t &header);
 	/*!
 	 * \brief Parse the packet if this is an HTTP request for an MPEG DASH MPD
 	 *
@@ -84,8 +166,7 @@ protected:
 	/*!
 	 * \brief Obtain the FQDN from an HTTP header
 	 *
-	 * This method parses the HTTP message until \r\r appears and extracts the
-	 * FQDN provided after 'Host: '
+	 * Wrapper for parseHttpRequest() returning the FQDN only
 	 *
 	 * \param packet Pointer to the HTTP packet
 	 * \param packetSize Length of the HTTP packet
@@ -106,6 +187,8 @@ protected:
 	/*!
 	 * \brief Obtain HTTP method from an HTTP request message
 	 *
+	 * Wrapper for parseHttpRequest() returning the method only
+	 *
 	 * \param packet Pointer to the HTTP request packet
 	 * \param packetSize Reference to the size of the packet
 	 *
@@ -145,8 +228,7 @@ protected:
 	/*!
 	 * \brief Obtain the resource from an HTTP header
 	 *
-	 * This method parses the HTTP message until \r\r appears and extracts the
-	 * resource provided in the header
+	 * Wrapper for parseHttpRequest() returning the resource only
 	 *
 	 * \param packet Pointer to the HTTP packet
 	 * \param packetSize Length of the HTTP packet
@@ -154,6 +236,51 @@ protected:
 	 * \return Resource of the HTTP packet provided
 	 */
 	string readResource(char *packet, uint16_t &packetSize);
+private:
+	/*!
+	 * \brief Copy the host part of a Host header or request URI as FQDN
+	 *
+	 * \param begin First character after 'Host:' or 'http://'
+	 * \param end End of the header line or request URI
+	 * \param header The request the FQDN is written to
+	 */
+	void _copyFqdn(const char *begin, const char *end,
+			http_request_header_t &header);
+	/*!
+	 * \brief Obtain the caching relevant directives of a Cache-Control header
+	 *
+	 * \param begin First character after 'Cache-Control:'
+	 * \param end End of the header line
+	 * \param header The response the directives are written to
+	 */
+	void _cacheControl(const char *begin, const char *end,
+			http_response_header_t &header);
+	/*!
+	 * \brief Check if a header value contains a token (case-insensitive)
+	 *
+	 * \param begin First character of the header value
+	 * \param end End of the header line
+	 * \param token The null-terminated token
+	 */
+	bool _contains(const char *begin, const char *end, const char *token);
+	/*!
+	 * \brief Convert an HTTP-date (RFC 7231, IMF-fixdate) into Unix time
+	 *
+	 * \param begin First character of the header value
+	 * \param end End of the header line
+	 *
+	 * \return The date or 0 if it cannot be parsed
+	 */
+	time_t _httpDate(const char *begin, const char *end);
+	/*!
+	 * \brief Map the method token of a request line to the enumeration
+	 *
+	 * \param token Pointer to the first character of the request line
+	 * \param length The length of the method token
+	 *
+	 * \return The method or HTTP_METHOD_UNKNOWN if it is not a standard one
+	 */
+	http_methods_t _requestMethod(const char *token, size_t length);
 };
 
 } /* namespace headerparser */
@@ -27,10 +27,11 @@ using namespace proxies::http::tcpserver;
 LoggerPtr HttpProxy::logger(Logger::getLogger("proxies.http"));
 
 HttpProxy::HttpProxy(Configuration &configuration, Namespaces &namespaces,
-		Statistics &statistics, bool *run)
+		Statistics &statistics, Reactor &reactor, bool *run)
 	: _configuration(configuration),
 	  _namespaces(namespaces),
 	  _statistics(statistics),
+	  _reactor(reactor),
 	  _run(run)
 {
 	_tcpListener = -1;
@@ -144,8 +145,7 @@ void HttpProxy::operator()()
 
 	clilen = sizeof(clientAddress);
 	LOG4CXX_INFO(logger, "Listening for TCP connections");
-	thread *tcpServerThread;
-	TcpServer tcpServer(_configuration, _namespaces, _statistics, _run);
+	TcpServer *tcpServer;
 
 	while(*_run)
 	{
@@ -161,9 +161,14 @@ void HttpProxy::operator()()
 		{
 			IpAddress ipAddress = clientAddress.sin_addr.s_addr;
 			_statistics.ipEndpointAdd(ipAddress);
-			tcpServerThread = new thread(tcpServer, newSocketFd, ipAddress);
-			tcpServerThread->detach();
-			delete tcpServerThread;
+			tcpServer = new TcpServer(_configuration, _namespaces,
+					_statistics, _reactor, newSocketFd, ipAddress, _run);
+
+			if (!_reactor.add(newSocketFd, tcpServer))
+			{
+				tcpServer->closed();
+				delete tcpServer;
+			}
 		}
 	}
 }
@@ -25,12 +25,12 @@
 //#include <boost/thread.hpp>
 #include <log4cxx/logger.h>
 #include <sstream>
-#include <thread>
 #include <vector>
 
 #include <configuration.hh>
 #include <monitoring/statistics.hh>
 #include <namespaces/namespaces.hh>
+#include <proxies/http/reactor.hh>
 #include <proxies/http/tcpserver.hh>
 
 #ifdef DMALLOC
@@ -41,6 +41,7 @@ using namespace configuration;
 using namespace log4cxx;
 using namespace monitoring::statistics;
 using namespace namespaces;
+using namespace proxies::http::reactor;
 using namespace std;
 
 namespace proxies {
@@ -53,9 +54,11 @@ class HttpProxy
 public:
 	/*!
 	 * \brief Constructor
+	 *
+	 * \param reactor The reactor accepted TCP sessions are handed to
 	 */
 	HttpProxy(Configuration &configuration, Namespaces &namespaces,
-			Statistics &statistics, bool *run);
+			Statistics &statistics, Reactor &reactor, bool *run);
 	/*!
 	 * \brief Destructor
 	 */
@@ -80,6 +83,7 @@ private:
 	*/
 	Namespaces &_namespaces;/*!< Reference to namespaces */
 	Statistics &_statistics;/*!< Reference to statistics class */
+	Reactor &_reactor;/*!< Reference to the reactor */
 	bool *_run;/*!< SIG* received and termination requested */
 	int _tcpListener;/*!< Socket FD listening for new TCP clients*/
 };
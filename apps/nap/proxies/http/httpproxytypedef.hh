@@ -22,9 +22,15 @@
 #ifndef NAP_PROXIES_HTTP_HTTPPROXYTYPEDEFS_HH_
 #define NAP_PROXIES_HTTP_HTTPPROXYTYPEDEFS_HH_
 
+#include <deque>
+#include <list>
+#include <string>
 #include <unordered_map>
 
+#include <types/enumerations.hh>
 #include <types/icnid.hh>
+#include <types/ipaddress.hh>
+#include <types/nodeid.hh>
 #include <types/typedef.hh>
 
 #ifdef DMALLOC
@@ -50,4 +56,47 @@ typedef std::unordered_map<nid_t, std::unordered_map<sk_t, socket_fd_t>>
 typedef std::unordered_map<socket_fd_t, bool> socket_state_t;/*!< the state of
 		a socket (active, deactive)*/
 
+/*!
+ * \brief Idle TCP client connection in the pool
+ */
+struct tcp_client_pool_connection_t
+{
+	socket_fd_t socketFd;/*!< The connected socket */
+	uint32_t idleSince;/*!< Monotonic time in seconds the connection was
+	returned to the pool */
+	rcid_enigma_t session;/*!< The ICN session of the last response, kept open
+	while the connection is idle. Its SK is the socket FD */
+};
+
+typedef std::unordered_map<uint64_t,
+		std::deque<tcp_client_pool_connection_t>> tcp_client_pool_t;/*!<
+		u_map<server IP address << 16 | port, idle connections (oldest first)> */
+
+/*!
+ * \brief HTTP request waiting for its TCP client socket
+ *
+ * Kept while the IP endpoint is resolved and the socket connects. Fragments
+ * continuing the request are queued behind it until then.
+ */
+struct tcp_client_request_t
+{
+	IcnId cId;/*!< The CID used to look up the IP endpoint */
+	IcnId rCId;/*!< The rCID of the HTTP request */
+	enigma_t enigma;/*!< https://en.wikipedia.org/wiki/23_enigma */
+	NodeId nodeId;/*!< The NID which has sent the HTTP request */
+	sk_t remoteSocketFd;/*!< The session key of the HTTP request */
+	http_methods_t httpMethod;/*!< The method of the HTTP request */
+	std::string fqdn;/*!< The FQDN from the HTTP request header */
+	IpAddress ipAddress;/*!< The IP endpoint */
+	uint16_t port;/*!< The port of the IP endpoint */
+	socket_fd_t socketFd;/*!< The TCP client socket. -1 if not created yet */
+	bool pooled;/*!< The socket has been taken from the TCP client pool */
+	std::list<std::pair<uint8_t *, uint16_t>> packets;/*!< The request and
+	its continuations allocated with malloc(), in the order received */
+};
+
+typedef std::unordered_map<nid_t, std::unordered_map<sk_t,
+		tcp_client_request_t *>> tcp_client_requests_t;/*!< u_map<NID,
+		u_map<remote socket FD (SK), request waiting for its socket>> */
+
 #endif /* NAP_PROXIES_HTTP_HTTPPROXYTYPEDEFS_HH_ */
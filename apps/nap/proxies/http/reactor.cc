@@ -0,0 +1,354 @@
+/*
+ * reactor.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+#include "reactor.hh"
+
+using namespace proxies::http::reactor;
+
+LoggerPtr Reactor::logger(Logger::getLogger("proxies.http.reactor"));
+
+Reactor::Reactor(uint16_t workers, uint16_t publishers, bool *run)
+	: _workers(workers),
+	  _publishers(publishers),
+	  _run(run),
+	  _sockets(0)
+{
+	struct epoll_event event;
+	_epollFd = epoll_create1(EPOLL_CLOEXEC);
+
+	if (_epollFd == -1)
+	{
+		LOG4CXX_FATAL(logger, "epoll instance could not be created: "
+				<< strerror(errno));
+	}
+
+	_taskFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK | EFD_SEMAPHORE);
+
+	if (_taskFd == -1)
+	{
+		LOG4CXX_FATAL(logger, "eventfd for reactor tasks could not be created: "
+				<< strerror(errno));
+		return;
+	}
+
+	// Level-triggered: the eventfd stays readable while tasks are pending
+	bzero(&event, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.ptr = NULL;
+
+	if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _taskFd, &event) == -1)
+	{
+		LOG4CXX_FATAL(logger, "eventfd for reactor tasks could not be watched: "
+				<< strerror(errno));
+	}
+}
+
+Reactor::~Reactor()
+{
+	close(_taskFd);
+	close(_epollFd);
+}
+
+bool Reactor::add(socket_fd_t socketFd, SocketHandler *handler)
+{
+	struct epoll_event event;
+	reactor_socket_t *reactorSocket = new reactor_socket_t;
+	reactorSocket->socketFd = socketFd;
+	reactorSocket->handler = handler;
+	bzero(&event, sizeof(event));
+	event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+	event.data.ptr = reactorSocket;
+
+	if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, socketFd, &event) == -1)
+	{
+		LOG4CXX_ERROR(logger, "Socket FD " << socketFd << " could not be "
+				"added to reactor: " << strerror(errno));
+		delete reactorSocket;
+		return false;
+	}
+
+	_socketsMutex.lock();
+	_sockets++;
+	_socketsMutex.unlock();
+	LOG4CXX_TRACE(logger, "Socket FD " << socketFd << " added to reactor");
+	return true;
+}
+
+bool Reactor::connect(socket_fd_t socketFd, reactor_connect_t connected)
+{
+	struct epoll_event event;
+	reactor_socket_t *reactorSocket = new reactor_socket_t;
+	reactorSocket->socketFd = socketFd;
+	reactorSocket->handler = NULL;
+	reactorSocket->connected = connected;
+	bzero(&event, sizeof(event));
+	event.events = EPOLLOUT | EPOLLONESHOT;
+	event.data.ptr = reactorSocket;
+
+	if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, socketFd, &event) == -1)
+	{
+		LOG4CXX_ERROR(logger, "Connecting socket FD " << socketFd << " could "
+				"not be added to reactor: " << strerror(errno));
+		delete reactorSocket;
+		return false;
+	}
+
+	LOG4CXX_TRACE(logger, "Socket FD " << socketFd << " connecting");
+	return true;
+}
+
+void Reactor::defer(reactor_task_t task)
+{
+	_deferredMutex.lock();
+	_deferred.push_back(task);
+	_deferredMutex.unlock();
+	_deferredCondition.notify_one();
+}
+
+void Reactor::post(reactor_task_t task)
+{
+	uint64_t one = 1;
+	_tasksMutex.lock();
+	_tasks.push_back(task);
+	_tasksMutex.unlock();
+
+	if (write(_taskFd, &one, sizeof(one)) != sizeof(one))
+	{
+		LOG4CXX_ERROR(logger, "Reactor workers could not be notified about new "
+				"task: " << strerror(errno));
+	}
+}
+
+uint32_t Reactor::sockets()
+{
+	uint32_t sockets;
+	_socketsMutex.lock();
+	sockets = _sockets;
+	_socketsMutex.unlock();
+	return sockets;
+}
+
+void Reactor::start()
+{
+	for (uint16_t i = 0; i < _workers; i++)
+	{
+		std::thread *workerThread = new std::thread(std::ref(*this));
+		workerThread->detach();
+		delete workerThread;
+	}
+
+	for (uint16_t i = 0; i < _publishers; i++)
+	{
+		std::thread *publisherThread = new std::thread(&Reactor::_publisher,
+				this);
+		publisherThread->detach();
+		delete publisherThread;
+	}
+
+	LOG4CXX_DEBUG(logger, "Reactor started with " << _workers << " worker "
+			"and " << _publishers << " publisher threads");
+}
+
+void Reactor::operator()()
+{
+	struct epoll_event event;
+	reactor_socket_t *reactorSocket;
+	int events;
+
+	while (*_run)
+	{
+		// one event per call so that a slow handler does not hold back events
+		// which another worker could process
+		events = epoll_wait(_epollFd, &event, 1, 1000);
+
+		if (events <= 0)
+		{
+			if (events == -1 && errno != EINTR)
+			{
+				LOG4CXX_ERROR(logger, "Waiting for socket events failed: "
+						<< strerror(errno));
+			}
+
+			continue;
+		}
+
+		if (event.data.ptr == NULL)
+		{
+			_runTask();
+			continue;
+		}
+
+		reactorSocket = (reactor_socket_t *)event.data.ptr;
+
+		if (reactorSocket->handler == NULL)
+		{
+			_connected(reactorSocket);
+			continue;
+		}
+
+		if (!reactorSocket->handler->readable())
+		{
+			_remove(reactorSocket);
+			continue;
+		}
+
+		// The socket stays disarmed until a publisher has finished with it
+		if (reactorSocket->handler->deferred())
+		{
+			defer(std::bind(&Reactor::_finish, this, reactorSocket));
+			continue;
+		}
+
+		if (!_rearm(reactorSocket))
+		{
+			_remove(reactorSocket);
+		}
+	}
+
+	LOG4CXX_DEBUG(logger, "Reactor worker thread stopped");
+}
+
+void Reactor::_connected(reactor_socket_t *reactorSocket)
+{
+	int error = 0;
+	socklen_t errorLength = sizeof(error);
+	int flags;
+
+	if (getsockopt(reactorSocket->socketFd, SOL_SOCKET, SO_ERROR, &error,
+			&errorLength) == -1)
+	{
+		error = errno;
+	}
+
+	epoll_ctl(_epollFd, EPOLL_CTL_DEL, reactorSocket->socketFd, NULL);
+	flags = fcntl(reactorSocket->socketFd, F_GETFL);
+
+	if (flags == -1 || fcntl(reactorSocket->socketFd, F_SETFL,
+			flags & ~O_NONBLOCK) == -1)
+	{
+		error = errno;
+		LOG4CXX_ERROR(logger, "Socket FD " << reactorSocket->socketFd
+				<< " could not be made blocking again: " << strerror(error));
+	}
+	else if (error != 0)
+	{
+		LOG4CXX_INFO(logger, "Socket FD " << reactorSocket->socketFd
+				<< " could not connect: " << strerror(error));
+	}
+
+	reactorSocket->connected(error == 0);
+	delete reactorSocket;
+}
+
+void Reactor::_finish(reactor_socket_t *reactorSocket)
+{
+	if (!reactorSocket->handler->finish() || !_rearm(reactorSocket))
+	{
+		_remove(reactorSocket);
+	}
+}
+
+void Reactor::_publisher()
+{
+	while (*_run)
+	{
+		std::unique_lock<std::mutex> lock(_deferredMutex);
+
+		if (_deferred.empty())
+		{
+			_deferredCondition.wait_for(lock, std::chrono::seconds(1));
+			continue;
+		}
+
+		reactor_task_t task = _deferred.front();
+		_deferred.pop_front();
+		lock.unlock();
+		task();
+	}
+
+	LOG4CXX_DEBUG(logger, "Reactor publisher thread stopped");
+}
+
+bool Reactor::_rearm(reactor_socket_t *reactorSocket)
+{
+	struct epoll_event event;
+	bzero(&event, sizeof(event));
+	event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+	event.data.ptr = reactorSocket;
+
+	if (epoll_ctl(_epollFd, EPOLL_CTL_MOD, reactorSocket->socketFd, &event)
+			== -1)
+	{
+		LOG4CXX_ERROR(logger, "Socket FD " << reactorSocket->socketFd
+				<< " could not be re-armed: " << strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+void Reactor::_remove(reactor_socket_t *reactorSocket)
+{
+	// Stop watching before the handler closes the FD
+	epoll_ctl(_epollFd, EPOLL_CTL_DEL, reactorSocket->socketFd, NULL);
+	LOG4CXX_TRACE(logger, "Socket FD " << reactorSocket->socketFd
+			<< " removed from reactor");
+	reactorSocket->handler->closed();
+	delete reactorSocket->handler;
+	delete reactorSocket;
+	_socketsMutex.lock();
+	_sockets--;
+	_socketsMutex.unlock();
+}
+
+void Reactor::_runTask()
+{
+	uint64_t count;
+
+	// another worker took the task already
+	if (read(_taskFd, &count, sizeof(count)) != sizeof(count))
+	{
+		return;
+	}
+
+	_tasksMutex.lock();
+
+	if (_tasks.empty())
+	{
+		_tasksMutex.unlock();
+		return;
+	}
+
+	reactor_task_t task = _tasks.front();
+	_tasks.pop_front();
+	_tasksMutex.unlock();
+	task();
+}
@@ -0,0 +1,241 @@
+/*
+ * reactor.hh
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAP_PROXIES_HTTP_REACTOR_HH_
+#define NAP_PROXIES_HTTP_REACTOR_HH_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <log4cxx/logger.h>
+#include <mutex>
+#include <stdint.h>
+
+#include <types/typedef.hh>
+
+#ifdef DMALLOC
+#include "dmalloc.h"
+#endif
+
+using namespace log4cxx;
+using namespace std;
+
+namespace proxies {
+
+namespace http {
+
+namespace reactor {
+
+/*!
+ * \brief A socket registered with the reactor
+ *
+ * Whenever the socket becomes readable exactly one worker thread calls
+ * readable(). The socket is not watched again before readable() has returned,
+ * so a handler never runs concurrently with itself and needs no locking for
+ * its own state.
+ *
+ * Work which may block for long, e.g. publishing an HTTP response which waits
+ * for its CMC group, must not run in readable(). The handler leaves it to
+ * finish() instead, which a publisher thread of the reactor calls. The socket
+ * is only watched again once finish() has returned.
+ */
+class SocketHandler
+{
+public:
+	/*!
+	 * \brief Destructor
+	 */
+	virtual ~SocketHandler() {}
+	/*!
+	 * \brief Read from the socket
+	 *
+	 * \return False if the socket has been closed by the peer or must not be
+	 * read from anymore
+	 */
+	virtual bool readable() = 0;
+	/*!
+	 * \brief Whether readable() has left work to finish()
+	 *
+	 * Asked after readable() returned true
+	 */
+	virtual bool deferred() { return false; }
+	/*!
+	 * \brief Do the work readable() has left, outside the reactor's workers
+	 *
+	 * \return False if the socket must not be read from anymore
+	 */
+	virtual bool finish() { return true; }
+	/*!
+	 * \brief Clean up after the socket has been removed from the reactor
+	 *
+	 * Called once after readable() or finish() returned false. The handler
+	 * must close the socket here and not before, as the FD could otherwise be
+	 * re-used by another socket before the reactor has stopped watching it.
+	 * The handler is deleted afterwards.
+	 */
+	virtual void closed() = 0;
+};
+
+typedef std::function<void()> reactor_task_t;/*!< Work handed to the
+		reactor's worker threads */
+
+typedef std::function<void(bool)> reactor_connect_t;/*!< Called once a
+		non-blocking connect has completed. The argument tells whether the
+		connection has been established */
+
+/*!
+ * \brief A watched socket and its handler
+ */
+struct reactor_socket_t
+{
+	socket_fd_t socketFd;/*!< The socket FD */
+	SocketHandler *handler;/*!< Its handler. NULL while the socket is
+	connecting */
+	reactor_connect_t connected;/*!< Called once the socket has connected */
+};
+
+/*!
+ * \brief Event loop of the HTTP proxy
+ *
+ * A fixed pool of worker threads waits on a single epoll instance for sockets
+ * which have become readable and for tasks posted from other threads. This
+ * replaces the thread per TCP session the HTTP proxy used to create on either
+ * side of the HTTP-over-ICN path.
+ *
+ * Sockets stay blocking. Workers only read from a socket after epoll reported
+ * it readable and writes to sockets (from workers or from the ICN handler)
+ * behave as they did before. The only exception are TCP client sockets while
+ * they are connecting, see connect().
+ */
+class Reactor
+{
+	static LoggerPtr logger;
+public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param workers The number of worker threads
+	 * \param publishers The number of threads calling SocketHandler::finish()
+	 * \param run Pointer to the boolean indicating that SIG* has been received
+	 */
+	Reactor(uint16_t workers, uint16_t publishers, bool *run);
+	/*!
+	 * \brief Destructor
+	 */
+	~Reactor();
+	/*!
+	 * \brief Watch a socket
+	 *
+	 * \param socketFd The socket FD
+	 * \param handler The handler of the socket. The reactor takes ownership
+	 *
+	 * \return False if the socket could not be added. In that case the handler
+	 * is not owned by the reactor
+	 */
+	bool add(socket_fd_t socketFd, SocketHandler *handler);
+	/*!
+	 * \brief Wait for a non-blocking connect to complete
+	 *
+	 * Once the socket has connected or failed to, one worker thread puts it
+	 * back into blocking mode and calls the given function. The socket is not
+	 * watched afterwards, so the caller can add() it right away.
+	 *
+	 * \param socketFd The socket FD for which connect() returned EINPROGRESS
+	 * \param connected Called once the connect has completed
+	 *
+	 * \return False if the socket could not be watched. In that case
+	 * connected is never called
+	 */
+	bool connect(socket_fd_t socketFd, reactor_connect_t connected);
+	/*!
+	 * \brief Run a task which may block in one of the publisher threads
+	 *
+	 * Used for work that waits on the ICN side, e.g. ending an LTP session,
+	 * which must not hold up the worker threads.
+	 */
+	void defer(reactor_task_t task);
+	/*!
+	 * \brief Run a task in one of the worker threads
+	 *
+	 * Tasks are started in the order they have been posted but run
+	 * concurrently if more than one worker is idle.
+	 */
+	void post(reactor_task_t task);
+	/*!
+	 * \brief Start the worker and publisher threads
+	 */
+	void start();
+	/*!
+	 * \brief The number of sockets currently watched
+	 */
+	uint32_t sockets();
+	/*!
+	 * \brief Functor for the worker threads
+	 */
+	void operator()();
+private:
+	uint16_t _workers;/*!< Number of worker threads */
+	uint16_t _publishers;/*!< Number of publisher threads */
+	bool *_run;/*!< SIG* received and termination requested */
+	int _epollFd;/*!< The epoll instance */
+	int _taskFd;/*!< eventfd counting the posted tasks */
+	deque<reactor_task_t> _tasks;/*!< Posted tasks */
+	std::mutex _tasksMutex;/*!< Mutex for _tasks */
+	uint32_t _sockets;/*!< Number of watched sockets */
+	std::mutex _socketsMutex;/*!< Mutex for _sockets */
+	deque<reactor_task_t> _deferred;/*!< Tasks for the publisher threads */
+	std::mutex _deferredMutex;/*!< Mutex for _deferred */
+	std::condition_variable _deferredCondition;/*!< Wakes up a publisher */
+	/*!
+	 * \brief Hand a completed connect to its caller
+	 */
+	void _connected(reactor_socket_t *reactorSocket);
+	/*!
+	 * \brief Let a handler finish() and watch its socket again afterwards
+	 */
+	void _finish(reactor_socket_t *reactorSocket);
+	/*!
+	 * \brief Functor for the publisher threads
+	 */
+	void _publisher();
+	/*!
+	 * \brief Watch a socket again after its handler has returned
+	 *
+	 * \return False if the socket could not be re-armed
+	 */
+	bool _rearm(reactor_socket_t *reactorSocket);
+	/*!
+	 * \brief Stop watching a socket and let its handler close it
+	 */
+	void _remove(reactor_socket_t *reactorSocket);
+	/*!
+	 * \brief Run the next posted task
+	 */
+	void _runTask();
+};
+
+} /* namespace reactor */
+
+} /* namespace http */
+
+} /* namespace proxies */
+
+#endif /* NAP_PROXIES_HTTP_REACTOR_HH_ */
@@ -27,55 +27,74 @@ LoggerPtr SurrogateTcpClient::logger(
 		Logger::getLogger("proxies.http.surrogatetcpclient"));
 
 SurrogateTcpClient::SurrogateTcpClient(Configuration &configuration,
-		int clientSocketFd, int surrogateSocketFd)
+		int clientSocketFd, surrogate_socket_t *surrogateSocket)
 	: _configuration(configuration),
 	  _clientSocketFd(clientSocketFd),
-	  _surrogateSocketFd(surrogateSocketFd)
-{}
+	  _surrogateSocket(surrogateSocket)
+{
+	_packet = (uint8_t *)malloc(_configuration.tcpClientSocketBufferSize());
+}
 
-SurrogateTcpClient::~SurrogateTcpClient() {}
+SurrogateTcpClient::~SurrogateTcpClient()
+{
+	free(_packet);
+}
 
-void SurrogateTcpClient::operator()()
+bool SurrogateTcpClient::readable()
 {
-	fd_set rset;
-	uint8_t *packet = (uint8_t *)malloc(
-			_configuration.tcpClientSocketBufferSize());
 	int bytesWritten;
-	FD_SET(_surrogateSocketFd, &rset);
-	while (FD_ISSET(_surrogateSocketFd, &rset))
+	bytesWritten = read(_surrogateSocket->socketFd, _packet,
+			_configuration.tcpClientSocketBufferSize());
+
+	if (bytesWritten == -1)
+	{
+		LOG4CXX_DEBUG(logger, "Surrogate socket error (FD "
+				<< _surrogateSocket->socketFd << "): " << strerror(errno));
+		return false;
+	}
+
+	if (bytesWritten == 0)
+	{
+		LOG4CXX_DEBUG(logger, "Socket closed by surrogate (FD "
+				<< _surrogateSocket->socketFd << ")");
+		return false;
+	}
+
+	LOG4CXX_TRACE(logger, "HTTP response of length " << bytesWritten
+			<< " received via surrogate socket FD "
+			<< _surrogateSocket->socketFd);
+	// send HTTP response to IP endpoint
+	bytesWritten = write(_clientSocketFd, _packet, bytesWritten);
+
+	if (bytesWritten == -1)
 	{
-		bytesWritten = read(_surrogateSocketFd, packet,
-				_configuration.tcpClientSocketBufferSize());
-		if (bytesWritten == -1)
-		{
-			LOG4CXX_DEBUG(logger, "Surrogate socket error (FD "
-					<< _surrogateSocketFd << "): " << strerror(errno));
-			break;
-		}
-		if (bytesWritten == 0)
-		{
-			LOG4CXX_DEBUG(logger, "Socket closed by surrogate (FD "
-					<< _surrogateSocketFd << ")");
-			break;
-		}
-		LOG4CXX_TRACE(logger, "HTTP response of length " << bytesWritten
-				<< " received via surrogate socket FD " << _surrogateSocketFd);
-		// send HTTP response to IP endpoint
-		bytesWritten = write(_clientSocketFd, packet, bytesWritten);
-		if (bytesWritten == -1)
-		{
-			LOG4CXX_DEBUG(logger, "HTTP response of length "
-					<< bytesWritten << " could not be sent to IP endpoint using "
-					"FD " << _clientSocketFd << ": " << strerror(errno));
-			break;
-		}
-		else
-		{
-			LOG4CXX_TRACE(logger, "HTTP response of length " << bytesWritten
-					<< " sent off to IP endpoint using client socket FD "
-					<< _clientSocketFd);
-		}
+		LOG4CXX_DEBUG(logger, "HTTP response of length "
+				<< bytesWritten << " could not be sent to IP endpoint using "
+				"FD " << _clientSocketFd << ": " << strerror(errno));
+		return false;
 	}
-	free(packet);
+
+	LOG4CXX_TRACE(logger, "HTTP response of length " << bytesWritten
+			<< " sent off to IP endpoint using client socket FD "
+			<< _clientSocketFd);
+	return true;
+}
+
+void SurrogateTcpClient::closed()
+{
 	shutdown(_clientSocketFd, SHUT_RDWR);
+	release(_surrogateSocket);
+}
+
+void SurrogateTcpClient::release(surrogate_socket_t *surrogateSocket)
+{
+	if (--surrogateSocket->references > 0)
+	{
+		return;
+	}
+
+	LOG4CXX_TRACE(logger, "Closing surrogate socket FD "
+			<< surrogateSocket->socketFd);
+	close(surrogateSocket->socketFd);
+	delete surrogateSocket;
 }
@@ -23,6 +23,7 @@
 #define PROXIES_HTTP_SURROGATETCPCLIENT_HH_
 
 #include <arpa/inet.h>
+#include <atomic>
 #include <errno.h>
 #include <log4cxx/logger.h>
 #include <stdio.h>
@@ -30,6 +31,7 @@
 #include <unistd.h>
 
 #include <configuration.hh>
+#include <proxies/http/reactor.hh>
 
 #ifdef DMALLOC
 #include "dmalloc.h"
@@ -37,16 +39,29 @@
 
 using namespace configuration;
 using namespace log4cxx;
+using namespace proxies::http::reactor;
 
 namespace proxies {
 
 namespace http {
 
 namespace surrogatetcpclient {
+/*!
+ * \brief Socket towards the local surrogate
+ *
+ * The socket is shared by the TCP server writing HTTP requests to it and the
+ * surrogate TCP client reading HTTP responses from it. It is closed once both
+ * have released it.
+ */
+struct surrogate_socket_t
+{
+	socket_fd_t socketFd;/*!< The socket FD towards the surrogate */
+	std::atomic<uint8_t> references;/*!< Number of holders */
+};
 /*!
  * \brief Surrogate TCP client implementation
  */
-class SurrogateTcpClient {
+class SurrogateTcpClient: public SocketHandler {
 	static LoggerPtr logger;
 public:
 	/*!
@@ -56,23 +71,35 @@ public:
 	 * TCP client socket buffer size
 	 * \param clientSocketFd The socket file descriptor for the client awaiting
 	 * the HTTP response
-	 * \param surrogateSocketFd The socket file descriptor for the connection to
-	 * the surrogate server
+	 * \param surrogateSocket The socket towards the surrogate server. A
+	 * reference must have been acquired for this handler
 	 */
 	SurrogateTcpClient(Configuration &configuration, int clientSocketFd,
-			int surrogateSocketFd);
+			surrogate_socket_t *surrogateSocket);
 	/*!
 	 * \brief Destructor
 	 */
 	~SurrogateTcpClient();
 	/*!
-	 * \brief Functor to call this class in a Boost thread
+	 * \brief Relay the HTTP response read from the surrogate to the client
+	 */
+	bool readable();
+	/*!
+	 * \brief Shut down the client socket and release the surrogate socket
+	 */
+	void closed();
+	/*!
+	 * \brief Release a reference to a surrogate socket
+	 *
+	 * The last holder closes the socket.
 	 */
-	void operator()();
+	static void release(surrogate_socket_t *surrogateSocket);
 private:
 	Configuration &_configuration;/*!< Reference to Configuration class*/
 	int _clientSocketFd;/*!< The socket FD for the client */
-	int _surrogateSocketFd; /*!< The socket FD for the surrogate server */
+	surrogate_socket_t *_surrogateSocket; /*!< The socket towards the surrogate
+	server */
+	uint8_t *_packet;/*!< Read buffer */
 };
 
 } /* namespace surrogatetcpclient */
@@ -26,7 +26,8 @@ using namespace proxies::http::tcpclient;
 LoggerPtr TcpClient::logger(Logger::getLogger("proxies.http.tcpclient"));
 
 TcpClient::TcpClient(Configuration &configuration, Namespaces &namespaces,
-		Statistics &statistics, reverse_lookup_t *reverseLookup,
+		Statistics &statistics, Reactor &reactor,
+		TcpClientPool &tcpClientPool, reverse_lookup_t *reverseLookup,
 		socket_fds_t *socketFds, socket_state_t *socketState,
 		mutex &tcpClientMutex, bool *run)
 	: DnsResolutions(run),
@@ -34,6 +35,8 @@ TcpClient::TcpClient(Configuration &configuration, Namespaces &namespaces,
 	  _configuration(configuration),
 	  _namespaces(namespaces),
 	  _statistics(statistics),
+	  _reactor(reactor),
+	  _tcpClientPool(tcpClientPool),
 	  _reverseLookup(reverseLookup),
 	  _socketFds(socketFds),
 	  _socketState(socketState),
@@ -49,77 +52,56 @@ void TcpClient::operator ()(IcnId cid, IcnId rCid, enigma_t enigma,
 		sk_t remoteSocketFd, string nodeIdStr, uint8_t *packet,
 		uint16_t packetSize)
 {
-	uint8_t *p = (uint8_t *)malloc(packetSize);
-
-	if (p == NULL)
-	{
-		LOG4CXX_ERROR(logger, "malloc failed for establishing TCP client thread"
-				" with CID " << cid.print() << " rCID " << rCid.print());
-		free(p);
-		return;
-	}
-
-	memcpy(p, packet, packetSize);
-
-	// first copy the packet and several variables to thread safe memory
-	// locations
-	socket_fd_t socketFd;
 	NodeId nodeId(nodeIdStr);
-	bool callRead;
-
-	socketFd = _tcpSocket(cid, nodeId, remoteSocketFd, callRead, p, packetSize);
+	http_request_header_t httpRequestHeader;
+	tcp_client_request_t *request;
+	parseHttpRequest((const char *)packet, packetSize, httpRequestHeader);
 
-	if (socketFd == -1)
+	//No request line (continuation of existing HTTP REQ session)
+	if (httpRequestHeader.method == HTTP_METHOD_UNKNOWN)
 	{
-		LOG4CXX_WARN(logger, "Socket could not be created to server for CID "
-				<< cid.print());
-		free(p);
+		_continue(nodeId, remoteSocketFd, rCid, enigma, packet, packetSize);
 		return;
 	}
 
-	// creating read thread if this is a new socket determined in _tcpSocket
-	if (callRead)
-	{
-		TcpClientRead tcpClientRead(_configuration, _namespaces, _statistics,
-				_reverseLookup, _socketFds, _socketState, _mutex, _run);
-
-		std::thread *readThread = new std::thread(tcpClientRead, socketFd,
-				remoteSocketFd, nodeId, callRead);
-		readThread->detach();
-		delete readThread;
-	}
-
-	// Send off the data using the new FD _nextTcpClientFd
-	int bytesWritten = -1;
+	request = new tcp_client_request_t;
+	request->cId = cid;
+	request->rCId = rCid;
+	request->enigma = enigma;
+	request->nodeId = nodeId;
+	request->remoteSocketFd = remoteSocketFd;
+	request->httpMethod = httpRequestHeader.method;
+	request->fqdn.assign(httpRequestHeader.fqdn,
+			httpRequestHeader.fqdnLength);
+	request->port = 0;
+	request->socketFd = -1;
+	request->pooled = false;
+	request->packets.push_back(pair<uint8_t *, uint16_t>(packet, packetSize));
+	/* Register the request before its socket is obtained, so that the second
+	 * HTTP fragment (over ICN) is queued behind it rather than dropped for the
+	 * lack of a socket. Obtaining the socket takes slightly longer than
+	 * receiving the next fragment and retrieving it from the ICN buffer
+	 */
+	_mutex.lock();
+	_requests[nodeId.uint()][remoteSocketFd] = request;
+	_mutex.unlock();
 
-	if (!_socketWriteable(socketFd))
+	if (_endpoint(request))
 	{
-		LOG4CXX_TRACE(logger, "Socket FD " << socketFd << " not writeable "
-				"anymore. Packet of length " << packetSize << " will be "
-						"dropped");
-		free(p);
+		_connect(request);
 		return;
 	}
 
-	_addReverseLookup(socketFd, rCid, enigma);
-
-	bytesWritten = send(socketFd, p, packetSize, MSG_NOSIGNAL);
-	//write(socketFd, p, packetSize);
-
-	if (bytesWritten <= 0)
+	// if no IP, check if the CID is a wildcard match and this NAP is ICN GW
+	if (!_configuration.icnGatewayHttp())
 	{
-		LOG4CXX_INFO(logger, "HTTP request of length " << packetSize
-				<< " could not be sent to IP endpoint using FD "
-				<< socketFd	<< ": " << strerror(errno));
-		free(p);
+		LOG4CXX_INFO(logger, "IP endpoint for " << cid.print() << " was "
+				"not configured");
+		_drop(request);
 		return;
 	}
 
-	_statistics.txHttpBytes(&bytesWritten);
-	LOG4CXX_TRACE(logger, "HTTP request of length " << bytesWritten
-			<< " sent off to IP endpoint using socket FD "
-			<< socketFd);
-	free(p);
+	_reactor.defer(std::bind(&TcpClient::_resolve, this, request));
 }
 
 void TcpClient::_addReverseLookup(int &socketFd, IcnId &rCId,
@@ -151,116 +133,246 @@ void TcpClient::_addReverseLookup(int &socketFd, IcnId &rCId,
 	_mutex.unlock();
 }
 
-void TcpClient::_setSocketState(socket_fd_t &socketFd, bool state)
+void TcpClient::_connect(tcp_client_request_t *request)
 {
-	_mutex.lock();
-	_socketStateIt = _socketState->find(socketFd);
+	struct sockaddr_in serverAddress;
+	int flags;
 
-	if (_socketStateIt == _socketState->end())
+	// take an idle connection towards the server if there is one
+	if (_configuration.tcpClientPoolSize() > 0)
 	{
-		_socketState->insert(pair<socket_fd_t, bool>(socketFd, state));
-		LOG4CXX_TRACE(logger, "New socket FD " << socketFd << " added to list "
-				"of known sockets with state " << state);
-		_mutex.unlock();
+		rcid_enigma_t session;
+		session.rCId = request->rCId;
+		session.enigma = request->enigma;
+		request->socketFd = _tcpClientPool.acquire(request->ipAddress,
+				request->port, session);
+
+		if (request->socketFd != -1)
+		{
+			request->pooled = true;
+			_connected(request, true);
+			return;
+		}
+	}
+
+	// create socket
+	request->socketFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK,
+			IPPROTO_TCP);
+
+	if (request->socketFd == -1)
+	{
+		LOG4CXX_WARN(logger, "Socket could not be created: "
+				<< strerror(errno));
+		_drop(request);
 		return;
 	}
 
-	_socketStateIt->second = state;
-	LOG4CXX_TRACE(logger, "Socket FD " << socketFd << " updated with state "
-			<< state);
-	_mutex.unlock();
+	bzero(&serverAddress, sizeof(serverAddress));
+	serverAddress.sin_family = AF_INET;
+	serverAddress.sin_port = htons(request->port);
+	inet_pton(AF_INET, request->ipAddress.str().c_str(),
+			&serverAddress.sin_addr);
+
+	// Connect to server
+	if (connect(request->socketFd, (struct sockaddr *) &serverAddress,
+			sizeof(serverAddress)) == 0)
+	{
+		// connected right away. The socket must be blocking again
+		flags = fcntl(request->socketFd, F_GETFL);
+		_connected(request, flags != -1 && fcntl(request->socketFd,
+				F_SETFL, flags & ~O_NONBLOCK) != -1);
+		return;
+	}
+
+	if (errno != EINPROGRESS)
+	{
+		LOG4CXX_INFO(logger, "TCP client socket towards "
+				<< request->ipAddress.str() << ":" << request->port
+				<< " could not be established: " << strerror(errno));
+		close(request->socketFd);
+		_drop(request);
+		return;
+	}
+
+	// a worker calls _connected() once the connect has completed
+	if (!_reactor.connect(request->socketFd, std::bind(&TcpClient::_connected,
+			this, request, std::placeholders::_1)))
+	{
+		_connected(request, false);
+	}
 }
 
-bool TcpClient::_socketWriteable(int &socketFd)
+void TcpClient::_connected(tcp_client_request_t *request, bool connected)
 {
-	fd_set writeSet;
-	bool state = false;
-	FD_ZERO(&writeSet);
-	FD_SET(socketFd, &writeSet);
+	TcpClientRead *tcpClientRead;
+	list<pair<uint8_t *, uint16_t>> packets;
+	list<pair<uint8_t *, uint16_t>>::iterator packetsIt;
 
-	if(!FD_ISSET(socketFd, &writeSet))
+	if (!connected)
 	{
-		LOG4CXX_TRACE(logger, "TCP socket FD " << socketFd << " not writeable "
-				"anymore");
-		return false;
+		LOG4CXX_INFO(logger, "TCP client socket towards "
+				<< request->ipAddress.str() << ":" << request->port
+				<< " could not be established");
+		close(request->socketFd);
+		_drop(request);
+		return;
 	}
 
-	//_socketStateMutex->lock();
+	if (!request->pooled)
+	{
+		_statistics.tcpSocket(1);
+		LOG4CXX_TRACE(logger, "TCP socket opened with FD "
+				<< request->socketFd << " towards "
+				<< request->ipAddress.str() << ":" << request->port);
+	}
+
+	// add new socket to socket FD map unless a newer request has taken over
+	// the session meanwhile
 	_mutex.lock();
-	_socketStateIt = _socketState->find(socketFd);
 
-	if (_socketStateIt != _socketState->end())
+	if (_waiting(request))
 	{
-		state = _socketStateIt->second;
+		(*_socketFds)[request->nodeId.uint()][request->remoteSocketFd] =
+				request->socketFd;
+		LOG4CXX_TRACE(logger, "Local socket " << request->socketFd
+				<< " towards " << request->ipAddress.str() << ":"
+				<< request->port << " added to socketFds map for NID "
+				<< request->nodeId.uint() << " > rSFD "
+				<< request->remoteSocketFd);
 	}
-	else
+
+	_mutex.unlock();
+	_setSocketState(request->socketFd, true);
+	// watching the socket for HTTP responses
+	tcpClientRead = new TcpClientRead(_configuration, _namespaces,
+			_statistics, _reverseLookup, _socketFds, _socketState, _mutex,
+			_run, request->socketFd, request->remoteSocketFd,
+			request->nodeId, _tcpClientPool, request->httpMethod);
+
+	if (!_reactor.add(request->socketFd, tcpClientRead))
 	{
-		LOG4CXX_TRACE(logger, "Socket FD " << socketFd << " not found in socket"
-				" state map");
+		// nobody would ever read the HTTP response
+		tcpClientRead->closed();
+		delete tcpClientRead;
+		_drop(request);
+		return;
 	}
 
-	//_socketStateMutex->unlock();
-	_mutex.unlock();
-	return state;
+	// send off the request and the fragments queued behind it meanwhile
+	while (true)
+	{
+		_mutex.lock();
+
+		// continuations go straight to the socket from now on
+		if (request->packets.empty())
+		{
+			_forget(request);
+			_mutex.unlock();
+			break;
+		}
+
+		packets.swap(request->packets);
+		_mutex.unlock();
+
+		for (packetsIt = packets.begin(); packetsIt != packets.end();
+				packetsIt++)
+		{
+			_send(request->socketFd, request->rCId, request->enigma,
+					packetsIt->first, packetsIt->second);
+		}
+
+		packets.clear();
+	}
+
+	delete request;
 }
 
-int TcpClient::_tcpSocket(IcnId &cId, NodeId &nodeId,
-		sk_t &remoteSocketFd, bool &callRead, uint8_t *packet,
-		uint16_t &packetSize)
+void TcpClient::_continue(NodeId &nodeId, sk_t &remoteSocketFd, IcnId &rCId,
+		enigma_t &enigma, uint8_t *packet, uint16_t packetSize)
 {
-	callRead = false;
-	socket_fd_t socketFd = -1;
-	string fqdn;
+	socket_fd_t socketFd;
+	tcp_client_requests_t::iterator requestsIt;
+	socket_fds_t::iterator socketFdsIt;
+	unordered_map<sk_t, tcp_client_request_t *>::iterator requestIt;
 	unordered_map<sk_t, socket_fd_t>::iterator rSksIt;
-	fqdn = readFqdn(packet, packetSize);
-	// First check if socket already exists for this HTTP session
-	//_socketFdsMutex->lock();
 	_mutex.lock();
-	_socketFdsIt = _socketFds->find(nodeId.uint());
+	requestsIt = _requests.find(nodeId.uint());
 
-	//FQDN not found (continuation of existing HTTP REQ session)
-	if (fqdn.empty())
+	// the socket of the request is still being obtained
+	if (requestsIt != _requests.end())
 	{
-		// NID found
-		if (_socketFdsIt != _socketFds->end() && !fqdn.empty())
+		requestIt = requestsIt->second.find(remoteSocketFd);
+
+		if (requestIt != requestsIt->second.end())
 		{
-			rSksIt = _socketFdsIt->second.find(remoteSocketFd);
-
-			// remote socket FD found
-			if (rSksIt != _socketFdsIt->second.end())
-			{
-				socketFd = rSksIt->second;
-				//_socketFdsMutex->unlock();
-				_mutex.unlock();
-				LOG4CXX_TRACE(logger, "Existing local socket FD " << socketFd
-						<< " used for sending off this HTTP request from NID "
-						<< nodeId.uint() << " for CID " << cId.print());
-				return socketFd;
-			}
-			else
-			{
-				LOG4CXX_TRACE(logger, "NID " << nodeId.uint() << " > SFD "
-						<< remoteSocketFd << " does not exist in socketFds "
-						"map");
-			}
+			requestIt->second->packets.push_back(pair<uint8_t *, uint16_t>(
+					packet, packetSize));
+			_mutex.unlock();
+			LOG4CXX_TRACE(logger, "HTTP request continuation from NID "
+					<< nodeId.uint() << " > SFD " << remoteSocketFd
+					<< " queued until the TCP client socket has connected");
+			return;
 		}
-		else
+	}
+
+	socketFdsIt = _socketFds->find(nodeId.uint());
+
+	// NID found
+	if (socketFdsIt != _socketFds->end())
+	{
+		rSksIt = socketFdsIt->second.find(remoteSocketFd);
+
+		// remote socket FD found
+		if (rSksIt != socketFdsIt->second.end())
 		{
-			LOG4CXX_TRACE(logger, "NID " << nodeId.uint() << " does not exist "
-					"in socket FDs map (NID > SFD)");
+			socketFd = rSksIt->second;
+			_mutex.unlock();
+			LOG4CXX_TRACE(logger, "Existing local socket FD " << socketFd
+					<< " used for sending off this HTTP request from NID "
+					<< nodeId.uint());
+			_send(socketFd, rCId, enigma, packet, packetSize);
+			return;
 		}
+
+		LOG4CXX_TRACE(logger, "NID " << nodeId.uint() << " > SFD "
+				<< remoteSocketFd << " does not exist in socketFds map");
+	}
+	else
+	{
+		LOG4CXX_TRACE(logger, "NID " << nodeId.uint() << " does not exist "
+				"in socket FDs map (NID > SFD)");
 	}
 
-	/* DO NOT unlock socketFdsMutex, as this would allow the second received
-	 * HTTP fragment (over ICN) to think there's no socket available and a new
-	 * one must be created. This is because the socket creation takes slightly
-	 * longer then receiving the next fragment and retrieving it from the ICN
-	 * buffer
-	 */
-	callRead = true;//as new socket is created and the functor must call read(()
-	bool endpointFound = false;
-	IpAddress ipAddressEndpoint;
-	uint16_t port;
+	_mutex.unlock();
+	// the server would not understand a request without its header
+	LOG4CXX_DEBUG(logger, "HTTP request continuation from NID "
+			<< nodeId.uint() << " > SFD " << remoteSocketFd << " dropped. "
+			"No TCP client socket exists anymore");
+	free(packet);
+}
+
+void TcpClient::_drop(tcp_client_request_t *request)
+{
+	list<pair<uint8_t *, uint16_t>>::iterator packetsIt;
+	_mutex.lock();
+	_forget(request);
+	_mutex.unlock();
+
+	// nothing can be queued behind the request anymore
+	for (packetsIt = request->packets.begin();
+			packetsIt != request->packets.end(); packetsIt++)
+	{
+		free(packetsIt->first);
+	}
+
+	LOG4CXX_DEBUG(logger, "HTTP request from NID " << request->nodeId.uint()
+			<< " > SFD " << request->remoteSocketFd << " dropped together "
+			"with " << request->packets.size() - 1 << " continuation(s)");
+	delete request;
+}
+
+bool TcpClient::_endpoint(tcp_client_request_t *request)
+{
 	list<pair<IcnId, pair<IpAddress, uint16_t>>> ipEndpoints;
 	list<pair<IcnId, pair<IpAddress, uint16_t>>>::iterator ipEndpointsIt;
 	ipEndpoints = _configuration.fqdns();
@@ -269,129 +381,155 @@ int TcpClient::_tcpSocket(IcnId &cId, NodeId &nodeId,
 
 	while(ipEndpointsIt != ipEndpoints.end())
 	{
-		ipEndpointsIt->first;
-
-		if (ipEndpointsIt->first.uint() == cId.uint())
+		if (ipEndpointsIt->first.uint() == request->cId.uint())
 		{
-			ipAddressEndpoint = ipEndpointsIt->second.first;
-			port = ipEndpointsIt->second.second;
-			endpointFound = true;
-			break;
+			request->ipAddress = ipEndpointsIt->second.first;
+			request->port = ipEndpointsIt->second.second;
+			return true;
 		}
 
 		ipEndpointsIt++;
 	}
 
-	// if no IP, check if the CID is a wildcard match and this NAP is ICN GW
-	if (!endpointFound && _configuration.icnGatewayHttp())
+	if (!_configuration.icnGatewayHttp())
 	{
-		// check if an IP is known from previous DNS requests
-		if (checkDns(fqdn, ipAddressEndpoint))
-		{
-			endpointFound = true;
-		}
-		else
-		{
-			port = 80;
-			endpointFound = resolve(fqdn, ipAddressEndpoint);
-		}
+		return false;
 	}
 
-	// if IP address still not known, exit here
-	if (!endpointFound)
+	// check if an IP is known from previous DNS requests
+	request->port = 80;
+	return checkDns(request->fqdn, request->ipAddress);
+}
+
+void TcpClient::_forget(tcp_client_request_t *request)
+{
+	tcp_client_requests_t::iterator requestsIt;
+
+	if (!_waiting(request))
 	{
-		LOG4CXX_INFO(logger, "IP endpoint for " << cId.print() << " was "
-				"not configured");
-		_mutex.unlock();
-		return socketFd;
+		return;
 	}
 
-	// create socket
-	socketFd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	requestsIt = _requests.find(request->nodeId.uint());
+	requestsIt->second.erase(request->remoteSocketFd);
 
-	if (socketFd == -1)
+	if (requestsIt->second.empty())
 	{
-		LOG4CXX_WARN(logger, "Socket could not be created: "<< strerror(errno));
-		_mutex.unlock();
-		return socketFd;
+		_requests.erase(requestsIt);
 	}
+}
 
-	struct sockaddr_in serverAddress;
-	bzero(&serverAddress, sizeof(serverAddress));
-	serverAddress.sin_family = AF_INET;
-	serverAddress.sin_port = htons(port);
-	inet_pton(AF_INET, ipAddressEndpoint.str().c_str(),
-			&serverAddress.sin_addr);
+void TcpClient::_resolve(tcp_client_request_t *request)
+{
+	if (!resolve(request->fqdn, request->ipAddress))
+	{
+		LOG4CXX_INFO(logger, "IP endpoint for " << request->cId.print()
+				<< " could not be resolved from FQDN " << request->fqdn);
+		_drop(request);
+		return;
+	}
 
-	// Connect to server
-	if (connect(socketFd, (struct sockaddr *) &serverAddress,
-			sizeof(serverAddress)) == -1)
+	_connect(request);
+}
+
+void TcpClient::_send(socket_fd_t socketFd, IcnId &rCId, enigma_t &enigma,
+		uint8_t *packet, uint16_t packetSize)
+{
+	int bytesWritten = -1;
+
+	if (!_socketWriteable(socketFd))
 	{
-		LOG4CXX_INFO(logger, "TCP client socket towards "
-				<< ipAddressEndpoint.str() << ":" << port << " could not be "
-						"established: "	<< strerror(errno));
-		close(socketFd);
-		//_socketFdsMutex->unlock();
-		_mutex.unlock();
-		return socketFd;
+		LOG4CXX_TRACE(logger, "Socket FD " << socketFd << " not writeable "
+				"anymore. Packet of length " << packetSize << " will be "
+						"dropped");
+		free(packet);
+		return;
 	}
 
-	LOG4CXX_TRACE(logger, "TCP socket opened with FD " << socketFd
-			<< " towards " << ipAddressEndpoint.str() << ":" << port);
-	// add new socket to socket FD map
-	_socketFdsIt = _socketFds->find(nodeId.uint());
+	_addReverseLookup(socketFd, rCId, enigma);
+	bytesWritten = send(socketFd, packet, packetSize, MSG_NOSIGNAL);
 
-	// NID does not exists
-	if (_socketFdsIt == _socketFds->end())
+	if (bytesWritten <= 0)
 	{
-		unordered_map<sk_t, socket_fd_t> rSks;
-		rSks.insert(pair<sk_t, socket_fd_t> (remoteSocketFd, socketFd));
-		_socketFds->insert(pair<nid_t, unordered_map<sk_t, socket_fd_t>>
-				(nodeId.uint(), rSks));
-		LOG4CXX_TRACE(logger, "New local socket " << socketFd << " towards "
-				<< ipAddressEndpoint.str() << ":" << port << " added to "
-				"socketFds map for new NID " << nodeId.uint() << " > rSFD "
-				<< remoteSocketFd);
-		//_socketFdsMutex->unlock();
+		LOG4CXX_INFO(logger, "HTTP request of length " << packetSize
+				<< " could not be sent to IP endpoint using FD "
+				<< socketFd	<< ": " << strerror(errno));
+		free(packet);
+		return;
+	}
+
+	_statistics.txHttpBytes(&bytesWritten);
+	LOG4CXX_TRACE(logger, "HTTP request of length " << bytesWritten
+			<< " sent off to IP endpoint using socket FD "
+			<< socketFd);
+	free(packet);
+}
+
+void TcpClient::_setSocketState(socket_fd_t &socketFd, bool state)
+{
+	_mutex.lock();
+	_socketStateIt = _socketState->find(socketFd);
+
+	if (_socketStateIt == _socketState->end())
+	{
+		_socketState->insert(pair<socket_fd_t, bool>(socketFd, state));
+		LOG4CXX_TRACE(logger, "New socket FD " << socketFd << " added to list "
+				"of known sockets with state " << state);
 		_mutex.unlock();
-		_setSocketState(socketFd, true);
-		return socketFd;
+		return;
 	}
 
-	// NID exists
-	rSksIt = _socketFdsIt->second.find(remoteSocketFd);
+	_socketStateIt->second = state;
+	LOG4CXX_TRACE(logger, "Socket FD " << socketFd << " updated with state "
+			<< state);
+	_mutex.unlock();
+}
+
+bool TcpClient::_socketWriteable(int &socketFd)
+{
+	fd_set writeSet;
+	bool state = false;
+	FD_ZERO(&writeSet);
+	FD_SET(socketFd, &writeSet);
 
-	// rSFD  does not exist
-	if (rSksIt == _socketFdsIt->second.end())
+	if(!FD_ISSET(socketFd, &writeSet))
 	{
-		_socketFdsIt->second.insert(pair<sk_t, socket_fd_t> (remoteSocketFd,
-				socketFd));
-		LOG4CXX_TRACE(logger, "New local socket " << socketFd << " towards "
-				<< ipAddressEndpoint.str() << ":" << port << " added to "
-				"socketFds map for known NID " << nodeId.uint() << " but new "
-				"rSFD "	<< remoteSocketFd);
+		LOG4CXX_TRACE(logger, "TCP socket FD " << socketFd << " not writeable "
+				"anymore");
+		return false;
+	}
+
+	//_socketStateMutex->lock();
+	_mutex.lock();
+	_socketStateIt = _socketState->find(socketFd);
+
+	if (_socketStateIt != _socketState->end())
+	{
+		state = _socketStateIt->second;
 	}
 	else
 	{
-		if (rSksIt->second == socketFd)
-		{
-			LOG4CXX_TRACE(logger, "Socket FD " << socketFd << " already known "
-					"for NID " << nodeId.uint() << " > rSFD "
-					<< remoteSocketFd);
-		}
-		// Updating socket entry
-		else
-		{
-			rSksIt->second = socketFd;
-			LOG4CXX_TRACE(logger, "Socket FD " << socketFd << " updated in NID "
-					<< nodeId.uint() << " > rSFD " << remoteSocketFd
-					<< " socket map");
-		}
+		LOG4CXX_TRACE(logger, "Socket FD " << socketFd << " not found in socket"
+				" state map");
 	}
 
-	//_socketFdsMutex->unlock();
+	//_socketStateMutex->unlock();
 	_mutex.unlock();
-	_setSocketState(socketFd, true);
-	_statistics.tcpSocket(1);
-	return socketFd;
+	return state;
+}
+
+bool TcpClient::_waiting(tcp_client_request_t *request)
+{
+	tcp_client_requests_t::iterator requestsIt;
+	unordered_map<sk_t, tcp_client_request_t *>::iterator requestIt;
+	requestsIt = _requests.find(request->nodeId.uint());
+
+	if (requestsIt == _requests.end())
+	{
+		return false;
+	}
+
+	requestIt = requestsIt->second.find(request->remoteSocketFd);
+	return requestIt != requestsIt->second.end()
+			&& requestIt->second == request;
 }
@@ -23,11 +23,11 @@
 #define NAP_PROXIES_HTTP_TCPCLIENT_HH_
 
 #include <arpa/inet.h>
+#include <fcntl.h>
 #include <list>
 #include <log4cxx/logger.h>
 #include <map>
 #include <mutex>
-#include <thread>
 #include <unistd.h>
 #include <unordered_map>
 
@@ -36,7 +36,9 @@
 #include <proxies/http/dnsresolutions.hh>
 #include <proxies/http/headerparser.hh>
 #include <proxies/http/httpproxytypedef.hh>
+#include <proxies/http/reactor.hh>
 #include <proxies/http/tcpclienthelper.hh>
+#include <proxies/http/tcpclientpool.hh>
 #include <proxies/http/tcpclientread.hh>
 #include <monitoring/statistics.hh>
 #include <types/ipaddress.hh>
@@ -51,6 +53,7 @@ using namespace log4cxx;
 using namespace std;
 using namespace proxies::http::dnsresolutions;
 using namespace proxies::http::headerparser;
+using namespace proxies::http::reactor;
 
 namespace proxies {
 
@@ -70,9 +73,14 @@ public:
 	 * \param configuration Reference to the class Configuration
 	 * \param namespaces Reference to the class Namespaces
 	 * \param statistics Reference to statistics class
+	 * \param reactor Reference to the reactor reading HTTP responses from
+	 * the TCP client sockets
+	 * \param tcpClientPool Reference to the pool of idle TCP client
+	 * connections
 	 */
 	TcpClient(Configuration &configuration, Namespaces &namespaces,
-			Statistics &statistics, reverse_lookup_t *reverseLookup,
+			Statistics &statistics, Reactor &reactor,
+			TcpClientPool &tcpClientPool, reverse_lookup_t *reverseLookup,
 			socket_fds_t *socketFds, socket_state_t *socketState,
 			mutex &tcpClientMutex, bool *run);
 	/*
@@ -86,10 +94,17 @@ public:
 	 * method returned true to indicate that a new TCP client session is
 	 * required.
 	 *
-	 * This method will always create a new TCP socket towards the registered
-	 * IP service endpoint.
+	 * A new HTTP request is sent over an idle pooled connection towards the
+	 * registered IP service endpoint or a newly created TCP socket.
+	 *
+	 * The functor never blocks the reactor worker it runs in. FQDNs which
+	 * must be resolved are handed to a publisher thread and new sockets
+	 * connect without blocking. Fragments continuing the request are queued
+	 * until its socket has connected.
 	 *
 	 * \param enigma https://en.wikipedia.org/wiki/23_enigma
+	 * \param packet The HTTP request allocated with malloc(). The functor takes
+	 * ownership and frees it
 	 */
 	void operator()(IcnId cid, IcnId rCid, enigma_t enigma,
 			sk_t remoteSocketFd, string nodeIdStr, uint8_t *packet,
@@ -98,6 +113,8 @@ private:
 	Configuration &_configuration;/*!< Reference to Configuration class */
 	Namespaces &_namespaces;/*!< Reference to Namespaces class */
 	Statistics &_statistics;/*!< Reference to Statistics class */
+	Reactor &_reactor;/*!< Reference to Reactor class */
+	TcpClientPool &_tcpClientPool;/*!< Reference to TcpClientPool class */
 	reverse_lookup_t *_reverseLookup;/*!< get
 	rCID and Enigma for a particular file descriptor to easier delete it
 	eventually from _openedTcpSessions if required. */
@@ -105,12 +122,13 @@ private:
 	_reverseLookup map */
 	socket_fds_t *_socketFds;/*!<
 	map<NID, map<remote SK, local SK*/
-	socket_fds_t::iterator _socketFdsIt;/*!< Iterator for _socketFdMap */
 	socket_state_t *_socketState;/*!< u_map<SFD, writeable> make
 	socket closure states available to all threads*/
 	socket_state_t::iterator _socketStateIt;/*!< Iterator for
 	_socketState map*/
 	std::mutex &_mutex; /*!< Mutex for all shared maps operations*/
+	tcp_client_requests_t _requests;/*!< HTTP requests waiting for their
+	socket. Guarded by _mutex */
 	IcnId _wildcardCid;/*!< The CID for HTTP wildcards*/
 	bool *_run;
 	/*!
@@ -139,26 +157,93 @@ private:
 	 */
 	bool _socketWriteable(socket_fd_t &socketFd);
 	/*!
-	 * \brief Create/obtain TCP socket to send off HTTP request to server
+	 * \brief Obtain a TCP socket towards the IP endpoint of a request
+	 *
+	 * Takes an idle connection from the pool or starts a non-blocking connect
+	 * which the reactor completes. Calls _connected() eventually.
+	 *
+	 * \param request The request with its IP endpoint set
+	 */
+	void _connect(tcp_client_request_t *request);
+	/*!
+	 * \brief Send a request once its socket has connected
+	 *
+	 * Watches the socket for HTTP responses and sends off the request and all
+	 * fragments queued behind it. Takes ownership of the request.
+	 *
+	 * \param request The request
+	 * \param connected Whether the socket has been connected
+	 */
+	void _connected(tcp_client_request_t *request, bool connected);
+	/*!
+	 * \brief Send off a fragment continuing a previous HTTP request
 	 *
-	 * The CID is required here because it is used to look up the IP address
-	 * from the FQDN registration
+	 * The fragment is queued if the socket of the request is still
+	 * connecting and dropped if there is no socket anymore.
 	 *
-	 * \param cId The CID used to store IP endpoint configuration (sNAP/eNAP)
 	 * \param nodeId The NID which has sent the HTTP request
-	 * \param remoteSocketFd The session key under which the HTTP reqeust has
-	 * been received (which corresponds to the socket FD)
-	 * \param callRead Reference to boolean indicating of the functor must call
-	 * read() or if there's another functor which is already reading from the FD
-	 * \param packet Pointer to packet in case this is a wildcard match and the
-	 * HTTP request must be parsed to obtain the FQDN for DNS resolution
-	 * \param packetSize The size of the pointer packet
-	 *
-	 * \return The socket FD to which the main thread can write. -1 if socket
-	 * could not be obtained/created
+	 * \param remoteSocketFd The session key under which the fragment has been
+	 * received
+	 * \param rCId The rCID of the HTTP request
+	 * \param enigma https://en.wikipedia.org/wiki/23_enigma
+	 * \param packet The fragment allocated with malloc()
+	 * \param packetSize The size of the fragment
+	 */
+	void _continue(NodeId &nodeId, sk_t &remoteSocketFd, IcnId &rCId,
+			enigma_t &enigma, uint8_t *packet, uint16_t packetSize);
+	/*!
+	 * \brief Drop a request and all fragments queued behind it
+	 *
+	 * \param request The request which is deleted
+	 */
+	void _drop(tcp_client_request_t *request);
+	/*!
+	 * \brief Look up the IP endpoint of a request without blocking
+	 *
+	 * Uses the configured FQDNs and, if this NAP is an ICN GW, previous DNS
+	 * resolutions.
+	 *
+	 * \param request The request whose IP endpoint is set
+	 *
+	 * \return True if the IP endpoint is known
+	 */
+	bool _endpoint(tcp_client_request_t *request);
+	/*!
+	 * \brief Remove a request from _requests if it is still waiting there
+	 *
+	 * Must be called with _mutex locked
+	 *
+	 * \param request The request
+	 */
+	void _forget(tcp_client_request_t *request);
+	/*!
+	 * \brief Resolve the FQDN of a request and connect to it
+	 *
+	 * Runs in a publisher thread of the reactor as resolving blocks
+	 *
+	 * \param request The request
+	 */
+	void _resolve(tcp_client_request_t *request);
+	/*!
+	 * \brief Write an HTTP request (fragment) to a TCP client socket
+	 *
+	 * \param socketFd The TCP client socket
+	 * \param rCId The rCID of the HTTP request
+	 * \param enigma https://en.wikipedia.org/wiki/23_enigma
+	 * \param packet The packet allocated with malloc() which is freed
+	 * \param packetSize The size of the packet
+	 */
+	void _send(socket_fd_t socketFd, IcnId &rCId, enigma_t &enigma,
+			uint8_t *packet, uint16_t packetSize);
+	/*!
+	 * \brief Whether a request is the one the session waits on in _requests
+	 *
+	 * A newer request of the same session replaces it there. Must be called
+	 * with _mutex locked
+	 *
+	 * \param request The request
 	 */
-	int _tcpSocket(IcnId &cId, NodeId &nodeId, sk_t &remoteSocketFd,
-			bool &callRead, uint8_t *packet, uint16_t &packetSize);
+	bool _waiting(tcp_client_request_t *request);
 };
 
 } /* namsepace tcpclient */
@@ -0,0 +1,250 @@
+/*
+ * tcpclientpool.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "tcpclientpool.hh"
+
+using namespace proxies::http::tcpclient;
+
+LoggerPtr TcpClientPool::logger(Logger::getLogger("proxies.http.tcpclientpool"));
+
+/*!
+ * \brief Monotonic time in seconds
+ */
+static uint32_t monotonicSeconds()
+{
+	return chrono::duration_cast<chrono::seconds>(
+			chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TcpClientPool::TcpClientPool(Configuration &configuration,
+		Namespaces &namespaces, Statistics &statistics, Reactor &reactor)
+	: _configuration(configuration),
+	  _namespaces(namespaces),
+	  _statistics(statistics),
+	  _reactor(reactor)
+{}
+
+TcpClientPool::~TcpClientPool()
+{
+	tcp_client_pool_t::iterator poolIt;
+	_mutex.lock();
+
+	for (poolIt = _pool.begin(); poolIt != _pool.end(); poolIt++)
+	{
+		while (!poolIt->second.empty())
+		{
+			close(poolIt->second.front().socketFd);
+			_statistics.tcpSocket(-1);
+			poolIt->second.pop_front();
+		}
+	}
+
+	_pool.clear();
+	_mutex.unlock();
+}
+
+socket_fd_t TcpClientPool::acquire(IpAddress &ipAddress, uint16_t port,
+		rcid_enigma_t &session)
+{
+	socket_fd_t socketFd = -1;
+	tcp_client_pool_connection_t connection;
+	uint32_t now = monotonicSeconds();
+	tcp_client_pool_t::iterator poolIt;
+	_mutex.lock();
+	poolIt = _pool.find(_key(ipAddress.uint(), port));
+
+	if (poolIt != _pool.end())
+	{
+		_expire(poolIt->second, now);
+
+		while (!poolIt->second.empty())
+		{
+			connection = poolIt->second.back();
+			poolIt->second.pop_back();
+
+			if (_healthy(connection.socketFd))
+			{
+				socketFd = connection.socketFd;
+				break;
+			}
+
+			LOG4CXX_TRACE(logger, "Idle TCP client socket "
+					<< connection.socketFd << " towards " << ipAddress.str()
+					<< ":" << port << " was closed by the server");
+			_close(connection);
+		}
+
+		if (poolIt->second.empty())
+		{
+			_pool.erase(poolIt);
+		}
+	}
+
+	_mutex.unlock();
+	_statistics.tcpClientPool(socketFd != -1);
+
+	if (socketFd == -1)
+	{
+		return socketFd;
+	}
+
+	LOG4CXX_TRACE(logger, "Pooled TCP client socket " << socketFd
+			<< " re-used towards " << ipAddress.str() << ":" << port);
+
+	// the SK now belongs to the new session
+	if (connection.session.rCId.uint() != session.rCId.uint() ||
+			connection.session.enigma != session.enigma)
+	{
+		_reactor.defer(std::bind(&TcpClientPool::_endSession, this,
+				connection.session, socketFd, false));
+	}
+
+	return socketFd;
+}
+
+bool TcpClientPool::release(socket_fd_t socketFd, rcid_enigma_t &session)
+{
+	struct sockaddr_in peerAddress;
+	socklen_t peerAddressLength = sizeof(peerAddress);
+	tcp_client_pool_t::iterator poolIt;
+	tcp_client_pool_connection_t connection;
+	uint32_t now = monotonicSeconds();
+
+	if (_configuration.tcpClientPoolSize() == 0)
+	{
+		return false;
+	}
+
+	if (getpeername(socketFd, (struct sockaddr *)&peerAddress,
+			&peerAddressLength) == -1 || peerAddress.sin_family != AF_INET)
+	{
+		LOG4CXX_TRACE(logger, "Server of TCP client socket " << socketFd
+				<< " unknown. Not pooling it");
+		return false;
+	}
+
+	connection.socketFd = socketFd;
+	connection.idleSince = now;
+	connection.session = session;
+	_mutex.lock();
+	poolIt = _pool.find(_key(peerAddress.sin_addr.s_addr,
+			ntohs(peerAddress.sin_port)));
+
+	if (poolIt == _pool.end())
+	{
+		deque<tcp_client_pool_connection_t> connections;
+		connections.push_back(connection);
+		_pool.insert(pair<uint64_t, deque<tcp_client_pool_connection_t>>(
+				_key(peerAddress.sin_addr.s_addr, ntohs(peerAddress.sin_port)),
+				connections));
+	}
+	else
+	{
+		_expire(poolIt->second, now);
+
+		if (poolIt->second.size() >= _configuration.tcpClientPoolSize())
+		{
+			_mutex.unlock();
+			LOG4CXX_TRACE(logger, "TCP client pool full for server of socket "
+					<< socketFd);
+			return false;
+		}
+
+		poolIt->second.push_back(connection);
+	}
+
+	_mutex.unlock();
+	LOG4CXX_TRACE(logger, "TCP client socket " << socketFd << " returned to "
+			"pool");
+	return true;
+}
+
+void TcpClientPool::_close(tcp_client_pool_connection_t &connection)
+{
+	_reactor.defer(std::bind(&TcpClientPool::_endSession, this,
+			connection.session, connection.socketFd, true));
+}
+
+void TcpClientPool::_endSession(rcid_enigma_t session, socket_fd_t socketFd,
+		bool closeSocket)
+{
+	_namespaces.Http::closeCmcGroup(session.rCId, session.enigma,
+			(sk_t)socketFd);
+	LOG4CXX_TRACE(logger, "ICN session of TCP client socket " << socketFd
+			<< " ended for rCID " << session.rCId.print() << " > enigma "
+			<< session.enigma);
+
+	if (closeSocket)
+	{
+		close(socketFd);
+		_statistics.tcpSocket(-1);
+	}
+}
+
+bool TcpClientPool::_healthy(socket_fd_t socketFd)
+{
+	struct tcp_info tcpInfo;
+	socklen_t tcpInfoLength = sizeof(tcpInfo);
+	uint8_t byte;
+
+	// the write side could have been shut down while the socket was idle
+	if (getsockopt(socketFd, IPPROTO_TCP, TCP_INFO, &tcpInfo,
+			&tcpInfoLength) == -1 || tcpInfo.tcpi_state != TCP_ESTABLISHED)
+	{
+		return false;
+	}
+
+	// nothing must be readable: neither a FIN nor unsolicited data
+	if (recv(socketFd, &byte, sizeof(byte), MSG_PEEK | MSG_DONTWAIT) == -1 &&
+			(errno == EAGAIN || errno == EWOULDBLOCK))
+	{
+		return true;
+	}
+
+	return false;
+}
+
+uint64_t TcpClientPool::_key(uint32_t ipAddress, uint16_t port)
+{
+	return ((uint64_t)ipAddress << 16) | port;
+}
+
+void TcpClientPool::_expire(deque<tcp_client_pool_connection_t> &connections,
+		uint32_t now)
+{
+	while (!connections.empty() && now - connections.front().idleSince >=
+			_configuration.tcpClientPoolIdleTimeout())
+	{
+		LOG4CXX_TRACE(logger, "Idle TCP client socket "
+				<< connections.front().socketFd << " timed out");
+		_close(connections.front());
+		connections.pop_front();
+	}
+}
@@ -0,0 +1,179 @@
+/*
+ * tcpclientpool.hh
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAP_PROXIES_HTTP_TCPCLIENTPOOL_HH_
+#define NAP_PROXIES_HTTP_TCPCLIENTPOOL_HH_
+
+#include <log4cxx/logger.h>
+#include <mutex>
+
+#include <configuration.hh>
+#include <monitoring/statistics.hh>
+#include <namespaces/namespaces.hh>
+#include <proxies/http/httpproxytypedef.hh>
+#include <proxies/http/reactor.hh>
+#include <types/ipaddress.hh>
+#include <types/typedef.hh>
+
+#ifdef DMALLOC
+#include "dmalloc.h"
+#endif
+
+using namespace configuration;
+using namespace log4cxx;
+using namespace monitoring::statistics;
+using namespace namespaces;
+using namespace proxies::http::reactor;
+using namespace std;
+
+namespace proxies {
+
+namespace http {
+
+namespace tcpclient {
+
+/*!
+ * \brief Idle TCP client connections towards servers
+ *
+ * Once a server has entirely sent an HTTP response over a persistent
+ * connection, the sNAP returns the socket to this pool instead of closing it.
+ * The next HTTP request towards the same IP endpoint takes it from here and
+ * saves the TCP handshake with the server.
+ *
+ * Connections are handed out newest first so that the ones left at the front
+ * of a server's queue are those that time out. Idle connections are only
+ * looked at when the pool is used; there is no timer thread.
+ *
+ * The ICN session of the last response stays open while its connection is
+ * idle, as ending it (CTRL-SE) lets the cNAPs shut down the browser sockets
+ * waiting on it. It is ended once the connection leaves the pool, i.e., when
+ * the connection is evicted, found closed by the server or taken for a request
+ * of another session. Ending a session waits for the cNAPs and is hence left
+ * to the reactor's publisher threads.
+ */
+class TcpClientPool
+{
+	static LoggerPtr logger;
+public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param configuration Reference to the class Configuration
+	 * \param namespaces Reference to the class Namespaces
+	 * \param statistics Reference to the class Statistics
+	 * \param reactor Reference to the reactor ending the ICN sessions
+	 */
+	TcpClientPool(Configuration &configuration, Namespaces &namespaces,
+			Statistics &statistics, Reactor &reactor);
+	/*!
+	 * \brief Destructor
+	 *
+	 * Closes all idle connections. Their ICN sessions are not ended anymore,
+	 * as the NAP is shutting down
+	 */
+	~TcpClientPool();
+	/*!
+	 * \brief Take an idle connection towards a server
+	 *
+	 * Connections which have been idle for longer than tcpClientPoolIdleTimeout
+	 * or have been closed by the server meanwhile are closed and skipped.
+	 *
+	 * \param ipAddress The IP address of the server
+	 * \param port The TCP port of the server
+	 * \param session The ICN session of the request. The session still open
+	 * over the connection is ended unless it is the same
+	 *
+	 * \return The connected socket FD or -1 if no idle connection exists
+	 */
+	socket_fd_t acquire(IpAddress &ipAddress, uint16_t port,
+			rcid_enigma_t &session);
+	/*!
+	 * \brief Return a connection to the pool
+	 *
+	 * The socket must not be watched by the reactor anymore and no HTTP
+	 * response must be outstanding on it.
+	 *
+	 * \param socketFd The connected socket FD
+	 * \param session The ICN session of the response received over the
+	 * connection. It stays open while the connection is idle
+	 *
+	 * \return False if the pool did not take the connection. The caller must
+	 * end the session and close it then
+	 */
+	bool release(socket_fd_t socketFd, rcid_enigma_t &session);
+private:
+	Configuration &_configuration;/*!< Reference to class Configuration */
+	Namespaces &_namespaces;/*!< Reference to class Namespaces */
+	Statistics &_statistics;/*!< Reference to class Statistics */
+	Reactor &_reactor;/*!< Reference to the reactor */
+	tcp_client_pool_t _pool;/*!< Idle connections per server */
+	std::mutex _mutex;/*!< Mutex for _pool */
+	/*!
+	 * \brief End the ICN session of a connection leaving the pool and close
+	 * the connection afterwards
+	 *
+	 * The socket FD is the SK of the session, so it is only closed once the
+	 * session has ended
+	 */
+	void _close(tcp_client_pool_connection_t &connection);
+	/*!
+	 * \brief End an ICN session and optionally close its socket
+	 *
+	 * Runs in a publisher thread of the reactor
+	 *
+	 * \param session The rCID and enigma of the session
+	 * \param socketFd The socket FD, i.e., the SK of the session
+	 * \param closeSocket Close the socket once the session has ended
+	 */
+	void _endSession(rcid_enigma_t session, socket_fd_t socketFd,
+			bool closeSocket);
+	/*!
+	 * \brief Check that an idle connection can still be used
+	 *
+	 * \param socketFd The socket FD
+	 *
+	 * \return True if the connection is established and nothing (including a
+	 * FIN) has been received on it while it was idle
+	 */
+	bool _healthy(socket_fd_t socketFd);
+	/*!
+	 * \brief The key under which connections towards a server are pooled
+	 */
+	uint64_t _key(uint32_t ipAddress, uint16_t port);
+	/*!
+	 * \brief Close connections at the front of a queue which idled too long
+	 *
+	 * Must be called while holding _mutex
+	 *
+	 * \param connections The idle connections towards a server
+	 * \param now The current monotonic time in seconds
+	 */
+	void _expire(deque<tcp_client_pool_connection_t> &connections,
+			uint32_t now);
+};
+
+} /* namespace tcpclient */
+
+} /* namespace http */
+
+} /* namespace proxies */
+
+#endif /* NAP_PROXIES_HTTP_TCPCLIENTPOOL_HH_ */
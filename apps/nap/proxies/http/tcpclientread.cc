@@ -14,7 +14,9 @@ LoggerPtr TcpClientRead::logger(Logger::getLogger("proxies.http.tcpclient"));
 TcpClientRead::TcpClientRead(Configuration &configuration,
 		Namespaces &namespaces, Statistics &statistics,
 		reverse_lookup_t *reverseLookup, socket_fds_t *socketFds,
-		socket_state_t *socketState, mutex &tcpClientMutex, bool *run)
+		socket_state_t *socketState, mutex &tcpClientMutex, bool *run,
+		socket_fd_t socketFd, socket_fd_t remoteSocketFd, NodeId nodeId,
+		TcpClientPool &tcpClientPool, http_methods_t httpMethod)
 	: TcpClientHelper(reverseLookup, tcpClientMutex),
 	  _configuration(configuration),
 	  _namespaces(namespaces),
@@ -23,105 +25,151 @@ TcpClientRead::TcpClientRead(Configuration &configuration,
 	  _socketFds(socketFds),
 	  _socketState(socketState),
 	  _mutex(tcpClientMutex),
-	  _run(run)
-{}
+	  _run(run),
+	  _socketFd(socketFd),
+	  _remoteSocketFd(remoteSocketFd),
+	  _nodeId(nodeId),
+	  _tcpClientPool(tcpClientPool),
+	  _httpMethod(httpMethod)
+{
+	_packet = (uint8_t *)malloc(_configuration.tcpClientSocketBufferSize());
+	_packetSize = 0;
+	_pending = false;
+	_firstPacket = true;
+	_framing = HTTP_RESPONSE_FRAMING_HEADER;
+	_remaining = 0;
+	_lineLength = 0;
+	_chunkExtension = false;
+	_keepAlive = false;
+	_reusable = false;
 
-TcpClientRead::~TcpClientRead() {}
+	if (_configuration.tcpClientPoolSize() == 0)
+	{
+		_framing = HTTP_RESPONSE_FRAMING_CLOSE;
+	}
+}
 
-void TcpClientRead::operator()(socket_fd_t socketFd, socket_fd_t remoteSocketFd,
-		NodeId nodeId, bool mpdRequest)
+TcpClientRead::~TcpClientRead()
 {
-	fd_set writeSet;
-	uint16_t packetSize;
-	uint8_t *p = (uint8_t *)malloc(_configuration.tcpClientSocketBufferSize());
-	bool firstPacket = true;
-	sk_t sessionKey = (sk_t)socketFd;
-	FD_SET(socketFd, &writeSet);
-	int bytesReceived;
+	free(_packet);
+}
+
+bool TcpClientRead::deferred()
+{
+	return _pending;
+}
+
+bool TcpClientRead::finish()
+{
+	sk_t sessionKey = (sk_t)_socketFd;
+	_pending = false;
 
-	while (FD_ISSET(socketFd, &writeSet))
+	if (!_namespaces.Http::handleResponse(rCid(_socketFd),
+			enigma(_socketFd), sessionKey, _firstPacket, _packet,
+			_packetSize))
 	{
-		bzero(p, _configuration.tcpClientSocketBufferSize());
-		bytesReceived = read(socketFd, p,
-				_configuration.tcpClientSocketBufferSize());
+		LOG4CXX_TRACE(logger, "Response read from socket FD " << _socketFd
+				<< " was not sent to cNAP(s) for rCID "
+				<< rCid(_socketFd).print() << " > Enigma "
+				<< enigma(_socketFd) << " > SK " << sessionKey);
+		return false;
+	}
 
-		if (bytesReceived <= 0)
-		{
-			_setSocketState(socketFd, false);
+	_firstPacket = false;
 
-			if (errno > 0)
-			{
-				LOG4CXX_DEBUG(logger,  "Socket " << socketFd << " closed "
-						"unexpectedly: " << strerror(errno));
-			}
-			else
-			{
-				LOG4CXX_TRACE(logger,  "Socket " << socketFd << " closed: "
-						<< strerror(errno));
-			}
+	if (_framing == HTTP_RESPONSE_FRAMING_CLOSE)
+	{
+		return true;
+	}
 
-			LOG4CXX_TRACE(logger, "Shutting down socket " << socketFd
-					<< " completely");
-			shutdown(socketFd, SHUT_RDWR);
-			LOG4CXX_TRACE(logger, "Closing socket " << socketFd);
-			close(socketFd);
-			_statistics.tcpSocket(-1);
-			break;
-		}
+	_frame(_packet, _packetSize);
+
+	// stop reading. closed() hands the socket over to the pool
+	if (_framing == HTTP_RESPONSE_FRAMING_COMPLETE && _keepAlive)
+	{
+		LOG4CXX_TRACE(logger, "HTTP response entirely received via socket FD "
+				<< _socketFd);
+		_reusable = true;
+		return false;
+	}
+
+	return true;
+}
 
-		packetSize = bytesReceived;
-		LOG4CXX_TRACE(logger, "Packet of length " << packetSize << " received "
-				"via socket FD " << socketFd);
-		_statistics.rxHttpBytes(&bytesReceived);
+bool TcpClientRead::readable()
+{
+	int bytesReceived;
+	bzero(_packet, _configuration.tcpClientSocketBufferSize());
+	bytesReceived = read(_socketFd, _packet,
+			_configuration.tcpClientSocketBufferSize());
+
+	if (bytesReceived <= 0)
+	{
+		_setSocketState(_socketFd, false);
 
-		if (!_namespaces.Http::handleResponse(rCid(socketFd),
-				enigma(socketFd), sessionKey, firstPacket, p,
-				packetSize))
+		if (errno > 0)
 		{
-			LOG4CXX_TRACE(logger, "Response read from socket FD " << socketFd
-					<< " was not sent to cNAP(s) for rCID "
-					<< rCid(socketFd).print() << " > Enigma "
-					<< enigma(socketFd) << " > SK " << sessionKey);
-			break;
+			LOG4CXX_DEBUG(logger,  "Socket " << _socketFd << " closed "
+					"unexpectedly: " << strerror(errno));
+		}
+		else
+		{
+			LOG4CXX_TRACE(logger,  "Socket " << _socketFd << " closed: "
+					<< strerror(errno));
 		}
 
-		firstPacket = false;
+		LOG4CXX_TRACE(logger, "Shutting down socket " << _socketFd
+				<< " completely");
+		shutdown(_socketFd, SHUT_RDWR);
+		return false;
 	}
 
-	_deleteSocketState(socketFd);
-	// Now clean up states in the HTTP handler
-	_namespaces.Http::closeCmcGroup(rCid(socketFd), enigma(socketFd),
-			sessionKey);
+	_packetSize = bytesReceived;
+	LOG4CXX_TRACE(logger, "Packet of length " << _packetSize << " received "
+			"via socket FD " << _socketFd);
+	_statistics.rxHttpBytes(&bytesReceived);
+	// the reactor does not read again before finish() has published it
+	_pending = true;
+	return true;
+}
+
+void TcpClientRead::closed()
+{
+	sk_t sessionKey = (sk_t)_socketFd;
+	rcid_enigma_t session;
+	session.rCId = rCid(_socketFd);
+	session.enigma = enigma(_socketFd);
+	_deleteSocketState(_socketFd);
 	// Cleaning up _reverseLookup map
 	_mutex.lock();
-	_reverseLookupIt = _reverseLookup->find(socketFd);
+	_reverseLookupIt = _reverseLookup->find(_socketFd);
 
 	if (_reverseLookupIt == _reverseLookup->end())
 	{
-		LOG4CXX_TRACE(logger, "Socket FD " << socketFd << " cannot be found in"
-				" reverse lookup map");
-		//_reverseLookupMutex->unlock();
-		_mutex.unlock();
-		free(p);
-		return;
+		LOG4CXX_TRACE(logger, "Socket FD " << _socketFd << " cannot be found "
+				"in reverse lookup map");
+	}
+	else
+	{
+		_reverseLookup->erase(_reverseLookupIt);
 	}
 
-	_reverseLookup->erase(_reverseLookupIt);
 	// Cleaning up remote socket FD
 	unordered_map<sk_t, int>::iterator rSksIt;
-	_socketFdsIt = _socketFds->find(nodeId.uint());
+	_socketFdsIt = _socketFds->find(_nodeId.uint());
 
 	// NID found
 	if (_socketFdsIt != _socketFds->end())
 	{
-		rSksIt = _socketFdsIt->second.find(remoteSocketFd);
+		rSksIt = _socketFdsIt->second.find(_remoteSocketFd);
 
 		// remote socket FD found
-		if (rSksIt != _socketFdsIt->second.end())
+		if (rSksIt != _socketFdsIt->second.end() &&
+				rSksIt->second == _socketFd)
 		{
 			_socketFdsIt->second.erase(rSksIt);
-			LOG4CXX_TRACE(logger, "Remote socket FD (SK) " << remoteSocketFd
-					<< " deleted for NID " << nodeId.uint() << " > "
+			LOG4CXX_TRACE(logger, "Remote socket FD (SK) " << _remoteSocketFd
+					<< " deleted for NID " << _nodeId.uint() << " > "
 					<< _socketFdsIt->first);
 		}
 
@@ -129,14 +177,179 @@ void TcpClientRead::operator()(socket_fd_t socketFd, socket_fd_t remoteSocketFd,
 		if (_socketFdsIt->second.empty())
 		{
 			LOG4CXX_TRACE(logger, "That was the last remote socket FD (SK) for "
-					"NID " << nodeId.uint() << ". " << "Deleting map key "
+					"NID " << _nodeId.uint() << ". " << "Deleting map key "
 					<< _socketFdsIt->first);
 			_socketFds->erase(_socketFdsIt);
 		}
 	}
 
 	_mutex.unlock();
-	free(p);
+
+	// the session stays open while the connection is idle so that the cNAPs
+	// keep the browser sockets
+	if (_reusable && _tcpClientPool.release(_socketFd, session))
+	{
+		return;
+	}
+
+	// Now clean up states in the HTTP handler
+	_namespaces.Http::closeCmcGroup(session.rCId, session.enigma, sessionKey);
+
+	// Close the FD only now so that it cannot be re-used by a new socket while
+	// the maps above still refer to it
+	LOG4CXX_TRACE(logger, "Closing socket " << _socketFd);
+	close(_socketFd);
+	_statistics.tcpSocket(-1);
+}
+
+void TcpClientRead::_frame(uint8_t *packet, uint16_t packetSize)
+{
+	const char *p = (const char *)packet;
+	const char *end = p + packetSize;
+	http_response_header_t header;
+	uint32_t length;
+
+	while (p < end)
+	{
+		switch (_framing)
+		{
+		case HTTP_RESPONSE_FRAMING_HEADER:
+			if (!parseHttpResponse(p, end - p, header) ||
+					header.headerLength == 0)
+			{
+				LOG4CXX_TRACE(logger, "HTTP response header via socket FD "
+						<< _socketFd << " cannot be followed. Socket will not "
+						"be pooled");
+				_framing = HTTP_RESPONSE_FRAMING_CLOSE;
+				return;
+			}
+
+			p += header.headerLength;
+			_keepAlive = header.keepAlive;
+
+			// interim response. The final one follows
+			if (header.statusCode >= 100 && header.statusCode < 200 &&
+					header.statusCode != 101)
+			{
+				break;
+			}
+
+			if (header.statusCode == 101)
+			{
+				_framing = HTTP_RESPONSE_FRAMING_CLOSE;
+			}
+			else if (_httpMethod == HTTP_METHOD_REQUEST_HEAD ||
+					header.statusCode == HTTP_METHOD_RESPONSE_NOCONTENT ||
+					header.statusCode == HTTP_METHOD_RESPONSE_NOTMODIFIED)
+			{
+				_framing = HTTP_RESPONSE_FRAMING_COMPLETE;
+			}
+			else if (header.chunked)
+			{
+				_framing = HTTP_RESPONSE_FRAMING_CHUNK_SIZE;
+				_remaining = 0;
+				_chunkExtension = false;
+			}
+			else if (header.contentLengthPresent)
+			{
+				_remaining = header.contentLength;
+				_framing = (_remaining == 0) ? HTTP_RESPONSE_FRAMING_COMPLETE :
+						HTTP_RESPONSE_FRAMING_LENGTH;
+			}
+			// body ends when the server closes the connection
+			else
+			{
+				_framing = HTTP_RESPONSE_FRAMING_CLOSE;
+			}
+
+			break;
+		case HTTP_RESPONSE_FRAMING_LENGTH:
+			length = ((uint32_t)(end - p) < _remaining) ? end - p : _remaining;
+			p += length;
+			_remaining -= length;
+
+			if (_remaining == 0)
+			{
+				_framing = HTTP_RESPONSE_FRAMING_COMPLETE;
+			}
+
+			break;
+		case HTTP_RESPONSE_FRAMING_CHUNK_SIZE:
+			if (*p == '\n')
+			{
+				_framing = (_remaining == 0) ?
+						HTTP_RESPONSE_FRAMING_CHUNK_TRAILER :
+						HTTP_RESPONSE_FRAMING_CHUNK_DATA;
+				_lineLength = 0;
+			}
+			else if (!_chunkExtension && isxdigit(*p))
+			{
+				if (_remaining > 0x0fffffff)
+				{
+					_framing = HTTP_RESPONSE_FRAMING_CLOSE;
+					return;
+				}
+
+				_remaining = (_remaining << 4) | (isdigit(*p) ? *p - '0' :
+						(tolower(*p) - 'a' + 10));
+			}
+			// chunk extension or CR
+			else
+			{
+				_chunkExtension = true;
+			}
+
+			p++;
+			break;
+		case HTTP_RESPONSE_FRAMING_CHUNK_DATA:
+			length = ((uint32_t)(end - p) < _remaining) ? end - p : _remaining;
+			p += length;
+			_remaining -= length;
+
+			if (_remaining == 0)
+			{
+				_framing = HTTP_RESPONSE_FRAMING_CHUNK_DATA_END;
+			}
+
+			break;
+		case HTTP_RESPONSE_FRAMING_CHUNK_DATA_END:
+			if (*p == '\n')
+			{
+				_framing = HTTP_RESPONSE_FRAMING_CHUNK_SIZE;
+				_remaining = 0;
+				_chunkExtension = false;
+			}
+
+			p++;
+			break;
+		case HTTP_RESPONSE_FRAMING_CHUNK_TRAILER:
+			if (*p == '\n')
+			{
+				if (_lineLength == 0)
+				{
+					_framing = HTTP_RESPONSE_FRAMING_COMPLETE;
+				}
+
+				_lineLength = 0;
+			}
+			else if (*p != '\r')
+			{
+				_lineLength++;
+			}
+
+			p++;
+			break;
+		case HTTP_RESPONSE_FRAMING_COMPLETE:
+			// the server sent more than the response
+			LOG4CXX_TRACE(logger, (end - p) << " bytes received via socket FD "
+					<< _socketFd << " after the HTTP response. Socket will not "
+					"be pooled");
+			_framing = HTTP_RESPONSE_FRAMING_CLOSE;
+			return;
+		case HTTP_RESPONSE_FRAMING_CLOSE:
+			return;
+		}
+	}
 }
 
 void TcpClientRead::_deleteSocketState(socket_fd_t &socketFd)
@@ -24,18 +24,21 @@
 
 #include <log4cxx/logger.h>
 #include <mutex>
-#include <thread>
 
 #include <configuration.hh>
 #include <proxies/http/headerparser.hh>
+#include <proxies/http/reactor.hh>
 #include <namespaces/namespaces.hh>
 #include <monitoring/statistics.hh>
 #include <proxies/http/tcpclienthelper.hh>
+#include <proxies/http/tcpclientpool.hh>
+#include <types/enumerations.hh>
 #include <types/nodeid.hh>
 #include <types/typedef.hh>
 
 using namespace log4cxx;
 using namespace proxies::http::headerparser;
+using namespace proxies::http::reactor;
 using namespace std;
 
 namespace proxies {
@@ -45,28 +48,58 @@ namespace http {
 namespace tcpclient {
 
 /*!
- * \brief Implementation of the "read() function in a thread" TCP client
+ * \brief Reads HTTP responses from a TCP session towards an IP endpoint
+ *
+ * One instance exists per TCP client socket and is driven by the reactor
+ * whenever the socket becomes readable. Publishing a response segment can
+ * block for long (CMC group retries, waiting for CTRL-WED/WUD) and is hence
+ * left to the reactor's publisher threads.
+ *
+ * If the TCP client pool is enabled the framing of the HTTP response is
+ * followed so that a persistent connection can be returned to the pool once
+ * the response has been entirely received.
  */
-class TcpClientRead: public HeaderParser, TcpClientHelper
+class TcpClientRead: public HeaderParser, TcpClientHelper, public SocketHandler
 {
 	static LoggerPtr logger;
 public:
 	/*!
 	 * \brief Constructor
+	 *
+	 * \param socketFd The TCP client socket FD towards the IP endpoint
+	 * \param remoteSocketFd The session key of the HTTP request at the cNAP
+	 * \param nodeId The NID of the cNAP
+	 * \param tcpClientPool The pool the socket is returned to after the
+	 * response
+	 * \param httpMethod The method of the HTTP request sent over the socket
 	 */
 	TcpClientRead(Configuration &configuration, Namespaces &namespaces,
 			Statistics &statistics, reverse_lookup_t *reverseLookup,
 			socket_fds_t *socketFds, socket_state_t *socketState,
-			mutex &tcpClientMutex, bool *run);
+			mutex &tcpClientMutex, bool *run, socket_fd_t socketFd,
+			socket_fd_t remoteSocketFd, NodeId nodeId,
+			TcpClientPool &tcpClientPool, http_methods_t httpMethod);
 	/*!
 	 * \brief Virtual destructor
 	 */
 	~TcpClientRead();
 	/*!
-	 * \brief Functor to run the read() call in a thread
+	 * \brief Read an HTTP response (segment)
+	 */
+	bool readable();
+	/*!
+	 * \brief Whether a response segment waits to be published
+	 */
+	bool deferred();
+	/*!
+	 * \brief Hand the response segment to the HTTP handler
 	 */
-	void operator()(socket_fd_t socketFd, socket_fd_t remoteSocketFd,
-			NodeId nodeId, bool mpdRequest);
+	bool finish();
+	/*!
+	 * \brief Clean up all states of the socket and close it or return it to
+	 * the TCP client pool
+	 */
+	void closed();
 private:
 	Configuration &_configuration;
 	Namespaces &_namespaces;
@@ -80,6 +113,32 @@ private:
 	socket_state_t::iterator _socketStateIt;/*!< Iterator for _socketState map*/
 	mutex &_mutex;
 	bool *_run;
+	socket_fd_t _socketFd;/*!< The TCP client socket FD */
+	socket_fd_t _remoteSocketFd;/*!< The session key at the cNAP */
+	NodeId _nodeId;/*!< The NID of the cNAP */
+	uint8_t *_packet;/*!< Read buffer */
+	uint16_t _packetSize;/*!< Length of the segment in _packet */
+	bool _pending;/*!< _packet waits for finish() */
+	bool _firstPacket;/*!< Whether the next read is the first response
+	segment */
+	TcpClientPool &_tcpClientPool;/*!< Reference to the TCP client pool */
+	http_methods_t _httpMethod;/*!< Method of the HTTP request */
+	http_response_framing_t _framing;/*!< Position within the response */
+	uint32_t _remaining;/*!< Bytes left of the body or current chunk */
+	uint16_t _lineLength;/*!< Length of the current trailer line */
+	bool _chunkExtension;/*!< Rest of the chunk size line is ignored */
+	bool _keepAlive;/*!< Server keeps the connection open */
+	bool _reusable;/*!< Response complete and socket can be pooled */
+	/*!
+	 * \brief Follow the framing of the HTTP response
+	 *
+	 * Falls back to HTTP_RESPONSE_FRAMING_CLOSE whenever the response cannot
+	 * be followed reliably, e.g. if the header spans more than one segment.
+	 *
+	 * \param packet The received segment
+	 * \param packetSize The length of the segment
+	 */
+	void _frame(uint8_t *packet, uint16_t packetSize);
 	/*!
 	 * \brief Delete a socket FD from the socket state map
 	 *
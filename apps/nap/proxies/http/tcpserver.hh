@@ -30,6 +30,8 @@
 #include <monitoring/statistics.hh>
 #include <namespaces/namespaces.hh>
 #include <proxies/http/headerparser.hh>
+#include <proxies/http/reactor.hh>
+#include <proxies/http/surrogatetcpclient.hh>
 #include <types/ipaddress.hh>
 
 #ifdef DMALLOC
@@ -41,6 +43,8 @@ using namespace log4cxx;
 using namespace monitoring::statistics;
 using namespace namespaces;
 using namespace proxies::http::headerparser;
+using namespace proxies::http::reactor;
+using namespace proxies::http::surrogatetcpclient;
 
 namespace proxies
 {
@@ -51,42 +55,71 @@ namespace tcpserver
 /*!
  * \brief TCP server
  *
- * This class handles all incoming TCP sessions from IP endpoints, i.e., session
- * which have been created by the IP endpoint (HTTP request messages).
+ * This class handles an incoming TCP session from an IP endpoint, i.e., a
+ * session which has been created by the IP endpoint (HTTP request messages).
+ * One instance exists per session and is driven by the reactor whenever the
+ * socket becomes readable.
  */
-class TcpServer: public HeaderParser
+class TcpServer: public HeaderParser, public SocketHandler
 {
 	static LoggerPtr logger;
 public:
 	/*!
 	 * \brief Constructor
+	 *
+	 * \param configuration Reference to class Configuration
+	 * \param namespaces Reference to class Namespaces
+	 * \param statistics Reference to class Statistics
+	 * \param reactor The reactor the socket is watched by
+	 * \param socketFd The socket FD of the accepted TCP session
+	 * \param ipAddress The IP address of the IP endpoint
+	 * \param run Pointer to the boolean indicating that SIG* has been received
 	 */
 	TcpServer(Configuration &configuration, Namespaces &namespaces,
-			Statistics &statistics,	bool *run);
+			Statistics &statistics, Reactor &reactor, socket_fd_t socketFd,
+			IpAddress ipAddress, bool *run);
 	/*!
 	 * \brief Destructor
 	 */
 	~TcpServer();
 	/*!
-	 * \brief Functor
+	 * \brief Read an HTTP request (segment) from the IP endpoint
 	 */
-	void operator()(socket_fd_t socketFd, IpAddress ipAddress);
+	bool readable();
+	/*!
+	 * \brief Delete the HTTP session and close the socket
+	 */
+	void closed();
 private:
 	Configuration &_configuration;/*!< Reference to Configuration class */
 	Namespaces &_namespaces;/*!< Reference to Namespace class */
 	Statistics &_statistics;/*!< Reference to Statistics class */
+	Reactor &_reactor;/*!< Reference to Reactor class */
+	socket_fd_t _socketFd;/*!< The socket FD towards the IP endpoint */
+	IpAddress _ipAddress;/*!< The IP address of the IP endpoint */
+	bool *_run;/*!< Capture if SIG* has been requested*/
+	char *_packet;/*!< Read buffer */
+	surrogate_socket_t *_localSurrogate; /*!< If local surrogacy has been
+	enabled this holds the socket towards the surrogate */
 	string _httpRequestFqdn;/*!< In case of an HTTP request POST || PUT this
 	variable allows to handle a request which is fragmented into multiple TCP
 	segments*/
-	bool *_run;/*!< Capture if SIG* has been requested*/
-	int _localSurrogateFd; /*!< If local surrogacy has been enabled this FD
-	holds the socket */
 	http_methods_t _httpRequestMethod;/*!< In case of an HTTP request POST ||
 	PUT this variable allows to handle a request which is fragmented into
 	multiple TCP segments*/
 	string _httpRequestResource;/*!< In case of an HTTP request POST ||
 	PUT this variable allows to handle a request which is fragmented into
 	multiple TCP segments*/
+	http_request_header_t _httpRequestHeader;/*!< The parsed header of the
+	last HTTP request */
+	/*!
+	 * \brief Relay an HTTP request to the local surrogate
+	 *
+	 * \param packetSize The number of bytes in _packet
+	 *
+	 * \return False if the session must be closed
+	 */
+	bool _relayToSurrogate(uint16_t packetSize);
 };
 
 } /* namespace tcpserver */
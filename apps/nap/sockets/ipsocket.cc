@@ -25,6 +25,11 @@ using namespace ipsocket;
 
 LoggerPtr IpSocket::logger(Logger::getLogger("ipsocket"));
 
+/*!
+ * \brief Packets queued by the calling thread for the raw IPv4 socket
+ */
+static thread_local IpSocketBatch batch;
+
 IpSocket::IpSocket(Configuration &configuration, Statistics &statistics)
 	: _configuration(configuration),
 	  _statistics(statistics)
@@ -156,6 +161,41 @@ void IpSocket::icmp(IpAddress sourceIpAddress, IpAddress destinationIpAddress,
 	}
 }
 
+bool IpSocket::flushPackets()
+{
+	uint32_t bytesSent;
+	bool allSent = batch.flush(_socketRaw4, bytesSent);
+	int bytesWritten = bytesSent;
+
+	if (bytesWritten > 0)
+	{
+		_statistics.txIpBytes(&bytesWritten);
+	}
+
+	return allSent;
+}
+
+void IpSocket::queuePacket(uint8_t *data, uint16_t &dataSize)
+{
+	struct ip *ipHeader = (struct ip *)data;
+	uint16_t ipHeaderLength = 4 * ipHeader->ip_hl;
+
+	if (_configuration.socketType() != RAWIP)
+	{
+		sendPacket(data, dataSize);
+		return;
+	}
+
+	if (_maxIpPacketPayloadSize < (dataSize - ipHeaderLength))
+	{
+		_sendFragmentsRawIp(data, dataSize);
+		return;
+	}
+
+	_queue(ipHeader, ipHeaderLength, data + ipHeaderLength,
+			dataSize - ipHeaderLength);
+}
+
 bool IpSocket::sendPacket(uint8_t *data, uint16_t &dataSize)
 {
 	struct ip *ipHeader;
@@ -215,6 +255,37 @@ uint16_t IpSocket::_checksum(const void *buffer, size_t headerLength)
 	return(~sum);
 }
 
+uint16_t IpSocket::_checksumUpdate(uint16_t checksum, uint16_t oldValue,
+		uint16_t newValue)
+{
+	// HC' = ~(~HC + ~m + m')
+	uint32_t sum = (uint16_t)~checksum + (uint16_t)~oldValue + newValue;
+
+	while (sum >> 16)
+	{
+		sum = (sum & 0xFFFF) + (sum >> 16);
+	}
+
+	return ~sum;
+}
+
+bool IpSocket::_queue(struct ip *ipHeader, uint16_t ipHeaderLength,
+		uint8_t *payload, uint16_t payloadSize)
+{
+	struct sockaddr_in destination;
+	bzero(&destination, sizeof(struct sockaddr_in));
+	destination.sin_family = AF_INET;
+	destination.sin_addr = ipHeader->ip_dst;
+	batch.queue(destination, ipHeader, ipHeaderLength, payload, payloadSize);
+
+	if (batch.full())
+	{
+		return flushPackets();
+	}
+
+	return true;
+}
+
 bool IpSocket::_sendFragments(uint8_t *data, uint16_t &dataSize)
 {
 	/*headerOffset = fragmentation flags + offset (in bytes) divided by 8*/
@@ -334,6 +405,92 @@ bool IpSocket::_sendFragments(uint8_t *data, uint16_t &dataSize)
 	return true;
 }
 
+bool IpSocket::_sendFragmentsRawIp(uint8_t *data, uint16_t &dataSize)
+{
+	struct ip *ipHeader = (struct ip *)data;
+	struct ip fragmentHeader;
+	IpAddress destinationIpAddress = ipHeader->ip_dst.s_addr;
+	uint16_t payloadOffset = 0;
+	uint16_t fragmentPayloadSize;
+	uint16_t ipLength, ipOffset;
+	bool sent;
+
+	// This packet is already a fragmented one... discard
+	if (ntohs(ipHeader->ip_off) & (IP_MF | IP_OFFMASK))
+	{
+		LOG4CXX_WARN(logger, "IP packet towards " << destinationIpAddress.str()
+				<< " is already a fragmented one. Unsupported feature! Dropping"
+						"it");
+		return false;
+	}
+
+	// IP options would have to be filtered per fragment. Leave it to libnet
+	if (ipHeader->ip_hl != 5)
+	{
+		LOG4CXX_DEBUG(logger, "IP packet towards "
+				<< destinationIpAddress.str() << " carries IP options. Using "
+				"libnet to send it as IP fragments");
+		return _sendFragments(data, dataSize);
+	}
+
+	uint8_t *payload = data + LIBNET_IPV4_H;
+	uint16_t payloadSize = dataSize - LIBNET_IPV4_H;
+	// All fragments share this header. Only length and offset change
+	memcpy(&fragmentHeader, ipHeader, LIBNET_IPV4_H);
+
+	if (fragmentHeader.ip_id == 0)
+	{
+		fragmentHeader.ip_id = htons(libnet_get_prand(LIBNET_PR16));
+	}
+
+	fragmentHeader.ip_len = htons(LIBNET_IPV4_H + _maxIpPacketPayloadSize);
+	fragmentHeader.ip_off = htons(IP_MF);
+	fragmentHeader.ip_sum = 0;
+	fragmentHeader.ip_sum = _checksum(&fragmentHeader, LIBNET_IPV4_H);
+
+	while (payloadOffset < payloadSize)
+	{
+		if ((payloadSize - payloadOffset) > _maxIpPacketPayloadSize)
+		{
+			fragmentPayloadSize = _maxIpPacketPayloadSize;
+			ipOffset = htons(IP_MF | (payloadOffset / 8));
+		}
+		else
+		{
+			fragmentPayloadSize = payloadSize - payloadOffset;
+			ipOffset = htons(payloadOffset / 8);
+		}
+
+		ipLength = htons(LIBNET_IPV4_H + fragmentPayloadSize);
+		fragmentHeader.ip_sum = _checksumUpdate(fragmentHeader.ip_sum,
+				fragmentHeader.ip_len, ipLength);
+		fragmentHeader.ip_len = ipLength;
+		fragmentHeader.ip_sum = _checksumUpdate(fragmentHeader.ip_sum,
+				fragmentHeader.ip_off, ipOffset);
+		fragmentHeader.ip_off = ipOffset;
+		sent = _queue(&fragmentHeader, LIBNET_IPV4_H, payload + payloadOffset,
+				fragmentPayloadSize);
+
+		if (!sent)
+		{
+			LOG4CXX_ERROR(logger, "IP fragments with ID "
+					<< ntohs(fragmentHeader.ip_id) << " to IP endpoint "
+					<< destinationIpAddress.str() << " could not be sent");
+			return false;
+		}
+
+		LOG4CXX_TRACE(logger, "IP fragment with ID "
+				<< ntohs(fragmentHeader.ip_id) << ", offset "
+				<< payloadOffset / 8 << " and size " << fragmentPayloadSize
+				<< " queued for IP endpoint " << destinationIpAddress.str()
+				<< " (" << payloadOffset + fragmentPayloadSize << "/"
+				<< payloadSize << ")");
+		payloadOffset += fragmentPayloadSize;
+	}
+
+	return flushPackets();
+}
+
 bool IpSocket::_sendPacketLibnet(uint8_t *data, uint16_t &dataSize)
 {
 	int bytesWritten;
@@ -384,19 +541,8 @@ bool IpSocket::_sendPacketRawIp(uint8_t *data, uint16_t &dataSize)
 	int bytesWritten;
 	ipHeader = (struct ip *)data;
 	IpAddress destinationIpAddress = ipHeader->ip_dst.s_addr;
-	// optional way START
-	struct hostent *hp;
-
-	if ((hp = gethostbyname(destinationIpAddress.str().c_str())) == NULL)
-	{
-		LOG4CXX_ERROR(logger, "Could not resolve DST IP "
-				<< destinationIpAddress.str());
-		return false;
-	}
-
-	bcopy(hp->h_addr_list[0], &ipHeader->ip_dst.s_addr, hp->h_length);
 	struct sockaddr_in dst = destinationIpAddress.socketAddress();
-	_mutexSocketRaw4.lock();
+	// a single sendto() on a raw socket is atomic, no need to lock it
 	bytesWritten = sendto(_socketRaw4, data, dataSize, 0,
 			(struct sockaddr *)&dst, sizeof(dst));
 
@@ -407,21 +553,18 @@ bool IpSocket::_sendPacketRawIp(uint8_t *data, uint16_t &dataSize)
 			LOG4CXX_DEBUG(logger, "IP packet of length " << dataSize << " could"
 					" not be sent to " << destinationIpAddress.str() << " via "
 					"raw socket: "	<< strerror(errno));
-			_mutexSocketRaw4.unlock();
-			LOG4CXX_DEBUG(logger, "Using libnet to send it as IP fragments");
-			return _sendFragments(data, dataSize);
+			LOG4CXX_DEBUG(logger, "Sending it as IP fragments");
+			return _sendFragmentsRawIp(data, dataSize);
 		}
 		else
 		{
 			LOG4CXX_WARN(logger, "IP packet of length " << dataSize << " could "
 					"not be sent to " << destinationIpAddress.str() << ": "
 					<< strerror(errno));
-			_mutexSocketRaw4.unlock();
 		}
 		return false;
 	}
 
-	_mutexSocketRaw4.unlock();
 	LOG4CXX_TRACE(logger, "IP packet of length " << dataSize << " sent to IP "
 			"endpoint " << destinationIpAddress.str());
 	_statistics.txIpBytes(&bytesWritten);
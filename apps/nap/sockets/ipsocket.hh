@@ -32,6 +32,7 @@
 
 #include <configuration.hh>
 #include <monitoring/statistics.hh>
+#include <sockets/ipsocketbatch.hh>
 
 #ifdef DMALLOC
 #include "dmalloc.h"
@@ -71,6 +72,25 @@ public:
 	 * \return Boolean indicating if packet has been successfully sent
 	 */
 	bool sendPacket(uint8_t *data, uint16_t &dataSize);
+	/*!
+	 * \brief Queue an IP packet for an IP endpoint
+	 *
+	 * The packet is copied into a batch of the calling thread which is sent
+	 * off with a single sendmmsg() call once it is full or flushPackets() is
+	 * called. Callers which have several packets at hand should queue all of
+	 * them and flush afterwards. Only the raw IP socket type supports batches;
+	 * with libnet the packet is sent immediately.
+	 *
+	 * \param data Pointer to the IP packet (header+payload) to be queued
+	 * \param dataSize The length of the IP packet
+	 */
+	void queuePacket(uint8_t *data, uint16_t &dataSize);
+	/*!
+	 * \brief Send all IP packets queued by the calling thread
+	 *
+	 * \return Boolean indicating whether all queued packets have been sent
+	 */
+	bool flushPackets();
 	/*!
 	 * \brief Sending ICMP packet from SRC to DST
 	 *
@@ -91,7 +111,8 @@ private:
 	handler to IP endpoints */
 	int _socketIcmp;/*!< ICMP socket */
 	std::mutex _mutexSocketRaw4;/*!< Ensure transaction safe write socket
-	operations*/
+	operations on the ICMP socket. Writes to the raw IPv4 socket are atomic per
+	packet and do not need to be serialised */
 	libnet_t *_libnetRaw4; /*!< Fragment and send IP packets to endpoints */
 	//libnet_t *_libnetLink; /*!< Send ICMP unreachable messages */
 	libnet_ptag_t _libnetPtag;
@@ -108,6 +129,26 @@ private:
 	 * \return The checksum of the header
 	 */
 	uint16_t _checksum(const void *buffer, size_t headerLength);
+	/*!
+	 * \brief Update an IP header checksum after a 16-bit field has changed
+	 *
+	 * Incremental update following RFC 1624
+	 *
+	 * \param checksum The checksum over the header before the change
+	 * \param oldValue The previous value of the field (network byte order)
+	 * \param newValue The new value of the field (network byte order)
+	 *
+	 * \return The checksum over the changed header
+	 */
+	uint16_t _checksumUpdate(uint16_t checksum, uint16_t oldValue,
+			uint16_t newValue);
+	/*!
+	 * \brief Queue a packet given as separate IP header and payload
+	 *
+	 * \return False if the batch had to be flushed and this failed
+	 */
+	bool _queue(struct ip *ipHeader, uint16_t ipHeaderLength,
+			uint8_t *payload, uint16_t payloadSize);
 	/*!
 	 * \brief Fragment IP packet and send fragments
 	 *
@@ -123,6 +164,21 @@ private:
 	 * successfully
 	 */
 	bool _sendFragments(uint8_t *data, uint16_t &dataSize);
+	/*!
+	 * \brief Fragment an IP packet and send all fragments via the raw IPv4
+	 * socket
+	 *
+	 * All fragments share the header of the packet. Only total length and
+	 * fragment offset change from one fragment to the next, so the header
+	 * checksum is updated incrementally. The fragments are queued in the
+	 * thread's batch and sent off with a single sendmmsg() call.
+	 *
+	 * \param data Pointer to the IP packet (header+payload) to be sent
+	 * \param dataSize The length of the IP packet
+	 *
+	 * \return Boolean indicating whether or not all fragments were sent
+	 */
+	bool _sendFragmentsRawIp(uint8_t *data, uint16_t &dataSize);
 	/*!
 	 * \brief Send an IP packet to an IP endpoint using libnet socket
 	 *
@@ -0,0 +1,126 @@
+/*
+ * ipsocketbatch.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <string.h>
+
+#include "ipsocketbatch.hh"
+
+using namespace ipsocket;
+
+LoggerPtr IpSocketBatch::logger(Logger::getLogger("ipsocket.batch"));
+
+IpSocketBatch::IpSocketBatch()
+	: _packets(0)
+{}
+
+bool IpSocketBatch::flush(int socket, uint32_t &bytesSent)
+{
+	struct mmsghdr messages[IP_SOCKET_BATCH_SIZE];
+	struct iovec iovecs[IP_SOCKET_BATCH_SIZE];
+	uint8_t packet = 0;
+	int packetsSent;
+	bool allSent = true;
+	bytesSent = 0;
+
+	if (_packets == 0)
+	{
+		return true;
+	}
+
+	bzero(messages, sizeof(struct mmsghdr) * _packets);
+
+	// the buffer does not move anymore, so the message headers can point to it
+	for (uint8_t i = 0; i < _packets; i++)
+	{
+		iovecs[i].iov_base = _buffer.data() + _offsets[i];
+		iovecs[i].iov_len = _lengths[i];
+		messages[i].msg_hdr.msg_iov = &iovecs[i];
+		messages[i].msg_hdr.msg_iovlen = 1;
+		messages[i].msg_hdr.msg_name = &_destinations[i];
+		messages[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+	}
+
+	while (packet < _packets)
+	{
+		packetsSent = sendmmsg(socket, &messages[packet], _packets - packet, 0);
+
+		// the first packet of the remaining ones failed. Skip it
+		if (packetsSent == -1)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			LOG4CXX_WARN(logger, "Packet of length " << _lengths[packet]
+					<< " could not be sent to "
+					<< inet_ntoa(_destinations[packet].sin_addr) << ": "
+					<< strerror(errno));
+			allSent = false;
+			packet++;
+			continue;
+		}
+
+		for (int i = packet; i < packet + packetsSent; i++)
+		{
+			bytesSent += messages[i].msg_len;
+		}
+
+		LOG4CXX_TRACE(logger, packetsSent << " packet(s) sent in one batch");
+		packet += packetsSent;
+	}
+
+	_buffer.clear();
+	_packets = 0;
+	return allSent;
+}
+
+bool IpSocketBatch::full()
+{
+	return _packets == IP_SOCKET_BATCH_SIZE;
+}
+
+void IpSocketBatch::queue(const struct sockaddr_in &destination,
+		const uint8_t *data, uint16_t dataSize)
+{
+	queue(destination, NULL, 0, data, dataSize);
+}
+
+void IpSocketBatch::queue(const struct sockaddr_in &destination,
+		const void *header, uint16_t headerLength, const uint8_t *payload,
+		uint16_t payloadSize)
+{
+	size_t offset = _buffer.size();
+	_buffer.resize(offset + headerLength + payloadSize);
+
+	if (headerLength > 0)
+	{
+		memcpy(_buffer.data() + offset, header, headerLength);
+	}
+
+	memcpy(_buffer.data() + offset + headerLength, payload, payloadSize);
+	_offsets[_packets] = offset;
+	_lengths[_packets] = headerLength + payloadSize;
+	_destinations[_packets] = destination;
+	_packets++;
+}
@@ -0,0 +1,108 @@
+/*
+ * ipsocketbatch.hh
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAP_SOCKETS_IPSOCKETBATCH_HH_
+#define NAP_SOCKETS_IPSOCKETBATCH_HH_
+
+#include <log4cxx/logger.h>
+#include <netinet/in.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <vector>
+
+#include <sockets/ipsockettypedef.hh>
+
+#ifdef DMALLOC
+#include "dmalloc.h"
+#endif
+
+using namespace log4cxx;
+using namespace std;
+
+namespace ipsocket {
+/*!
+ * \brief Packets queued by one thread and handed to a socket with sendmmsg()
+ *
+ * Packets are copied back to back into a buffer; the message headers are only
+ * pointed at them when the batch is flushed, as the buffer may grow while
+ * packets are queued. Owners keep one batch per thread, so no method takes a
+ * lock.
+ */
+class IpSocketBatch
+{
+	static LoggerPtr logger;
+public:
+	/*!
+	 * \brief Constructor
+	 */
+	IpSocketBatch();
+	/*!
+	 * \brief Send all queued packets
+	 *
+	 * A packet the socket refuses is logged and skipped; the remaining ones
+	 * are still sent. The batch is empty afterwards.
+	 *
+	 * \param socket The socket to send the packets through
+	 * \param bytesSent Set to the number of bytes sent
+	 *
+	 * \return False if at least one packet could not be sent
+	 */
+	bool flush(int socket, uint32_t &bytesSent);
+	/*!
+	 * \brief Check whether the batch must be flushed before the next packet
+	 * can be queued
+	 */
+	bool full();
+	/*!
+	 * \brief Queue a packet
+	 *
+	 * The data is copied, so the caller may release it right away.
+	 *
+	 * \param destination The address the packet is sent to
+	 * \param data Pointer to the packet
+	 * \param dataSize The length of the packet
+	 */
+	void queue(const struct sockaddr_in &destination, const uint8_t *data,
+			uint16_t dataSize);
+	/*!
+	 * \brief Queue a packet given as separate header and payload
+	 *
+	 * \param destination The address the packet is sent to
+	 * \param header Pointer to the header
+	 * \param headerLength The length of the header
+	 * \param payload Pointer to the payload
+	 * \param payloadSize The length of the payload
+	 */
+	void queue(const struct sockaddr_in &destination, const void *header,
+			uint16_t headerLength, const uint8_t *payload,
+			uint16_t payloadSize);
+private:
+	vector<uint8_t> _buffer;/*!< Queued packets */
+	size_t _offsets[IP_SOCKET_BATCH_SIZE];/*!< Offset of each packet */
+	uint16_t _lengths[IP_SOCKET_BATCH_SIZE];/*!< Length of each packet */
+	struct sockaddr_in _destinations[IP_SOCKET_BATCH_SIZE];/*!< Its
+	destination */
+	uint8_t _packets;/*!< Number of queued packets */
+};
+
+} /* namespace ipsocket */
+
+#endif /* NAP_SOCKETS_IPSOCKETBATCH_HH_ */
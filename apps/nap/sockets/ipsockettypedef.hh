@@ -0,0 +1,27 @@
+/*
+ * ipsockettypedef.hh
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAP_SOCKETS_IPSOCKETTYPEDEF_HH_
+#define NAP_SOCKETS_IPSOCKETTYPEDEF_HH_
+
+#define IP_SOCKET_BATCH_SIZE 32 // packets handed to sendmmsg() at once
+
+#endif /* NAP_SOCKETS_IPSOCKETTYPEDEF_HH_ */
@@ -34,7 +34,9 @@ namespace ltpbuffer
 /*!
  * \brief LTP buffer cleaner for cNAP and sNAP buffers
  *
- * Based on timeout configured in nap.cfg
+ * Based on timeout configured in nap.cfg. Sessions are put onto an expiry
+ * wheel by the buffer when their first packet is stored, so a run of the
+ * cleaner only visits sessions which have timed out.
  */
 class LtpBufferCleaner
 {
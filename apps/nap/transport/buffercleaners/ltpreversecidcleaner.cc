@@ -34,7 +34,7 @@ void LtpReverseCidCleaner::operator ()()
 		boost::posix_time::ptime currentTime;
 		boost::posix_time::time_duration duration;
 		LOG4CXX_TRACE(logger, "Check reverse rCID > CID map for unused entries");
-		currentTime = boost::posix_time::microsec_clock::local_time();
+		currentTime = boost::posix_time::microsec_clock::universal_time();
 		_mutex->lock();
 		it = _reverseLookupMap->begin();
 
@@ -43,7 +43,12 @@ Lightweight::Lightweight(Blackadder *icnCore, Configuration &configuration,
 	  _icnCore(icnCore),
 	  _configuration(configuration),
 	  _icnCoreMutex(icnCoreMutex),
-	  _statistics(statistics)
+	  _statistics(statistics),
+	  _proxyPacketBuffer(configuration.ltpInitialCredit() + 1),
+	  _ltpPacketBuffer(configuration.ltpInitialCredit() + 1,
+			  configuration.timeout()),
+	  _ltpSender(configuration.ltpInitialCredit(),
+			  configuration.ltpRttMultiplier(), run)
 {
 	_knownNIds = NULL;// will be set in initialise() method
 	_knownNIdsMutex = NULL;// will be set in initialise() method
@@ -61,7 +66,7 @@ Lightweight::Lightweight(Blackadder *icnCore, Configuration &configuration,
 
 	_rttMultiplier = _configuration.ltpRttMultiplier();
 	LtpBufferCleaner ltpBufferCleaner(_configuration, _statistics,
-			&_ltpPacketBuffer, &_ltpPacketBufferMutex,	run);
+			&_ltpPacketBuffer, &_ltpPacketBufferMutex, run);
 	std::thread *ltpBufferCleanerThread = new std::thread(ltpBufferCleaner);
 	ltpBufferCleanerThread->detach();
 	delete ltpBufferCleanerThread;
@@ -71,9 +76,13 @@ Lightweight::Lightweight(Blackadder *icnCore, Configuration &configuration,
 			new std::thread(ltpReverseCidCleaner);
 	ltpReverseCidCleanerThread->detach();
 	delete ltpReverseCidCleanerThread;
+	std::thread *ltpSenderThread =
+			new std::thread(&Lightweight::_ltpSenderLoop, this);
+	ltpSenderThread->detach();
+	delete ltpSenderThread;
 }
 
-Lightweight::~Lightweight(){}
+Lightweight::~Lightweight() {}
 
 bool Lightweight::cidLookup(IcnId &rCid, IcnId &cid)
 {
@@ -157,6 +166,7 @@ void Lightweight::publish(IcnId &rCid, enigma_t &enigma,
 		sk_t &sessionKey, list<NodeId> &nodeIds, uint8_t *data,
 		uint16_t &dataSize)
 {
+	window_ended_responses_t::iterator windowEndedResponsesIt;
 	ltp_hdr_ctrl_we_t ltpHeaderCtrlWe;
 	list<NodeId>::iterator nodeIdsIt;
 	ltpHeaderCtrlWe.enigma = enigma;
@@ -205,9 +215,10 @@ void Lightweight::publish(IcnId &rCid, enigma_t &enigma,
 			currentTime = boost::posix_time::microsec_clock::local_time();
 			timeWaited = currentTime - startTime;
 			_windowEndedResponsesMutex.lock();
-			_windowEndedResponsesIt = _windowEndedResponses.find(rCid.uint());
+			windowEndedResponsesIt = _windowEndedResponses.find(
+					rCid.uint());
 
-			if (_windowEndedResponsesIt == _windowEndedResponses.end())
+			if (windowEndedResponsesIt == _windowEndedResponses.end())
 			{
 				LOG4CXX_WARN(logger, "rCID " << rCid.print() << " does not "
 						"exist in CTRL-WED map");
@@ -215,7 +226,7 @@ void Lightweight::publish(IcnId &rCid, enigma_t &enigma,
 				return;
 			}
 
-			enigmaIt = _windowEndedResponsesIt->second.find(enigma);
+			enigmaIt = windowEndedResponsesIt->second.find(enigma);
 			uint16_t numberOfConfirmedWeds = 0;
 
 			for (nodeIdsIt = nodeIds.begin(); nodeIdsIt != nodeIds.end();
@@ -278,100 +289,13 @@ void Lightweight::publish(IcnId &cId, IcnId &rCId, enigma_t &enigma,
 		sk_t &sessionKey, uint8_t *data, uint16_t &dataSize)
 {
 	_addReverseLookUp(cId, rCId);
-	seq_t sequenceNumber;
-	// First publish the data
-	sequenceNumber = _publishData(cId, rCId, enigma, sessionKey, data,
-			dataSize);
-	map<sk_t, bool>::iterator sessionKeyMapIt;
-	map<enigma_t, map<sk_t, bool>>::iterator enigmaMapIt;
-	// Now start WE timer
-	uint8_t attempts = ENIGMA;
-	uint16_t rtt = _rtt();
-	boost::posix_time::ptime startStartTime =
-					boost::posix_time::microsec_clock::local_time();
-
-	while (attempts != 0)
-	{
-		// check boolean continuously for 2 * RRT (timeout)
-		boost::posix_time::ptime startTime =
-				boost::posix_time::microsec_clock::local_time();
-		boost::posix_time::ptime currentTime = startTime;
-		boost::posix_time::time_duration timeWaited;
-		timeWaited = currentTime - startTime;
-
-		// check for received WED until _timeout * RTT has been reached
-		while (timeWaited.total_milliseconds() < (_rttMultiplier * rtt))
-		{
-			currentTime = boost::posix_time::microsec_clock::local_time();
-			timeWaited = currentTime - startTime;
-			_windowEndedRequestsMutex.lock();
-			_windowEndedRequestsIt = _windowEndedRequests.find(rCId.uint());
-
-			if (_windowEndedRequestsIt == _windowEndedRequests.end())
-			{
-				LOG4CXX_WARN(logger, "rCID " << rCId.print() << " does not "
-						"exist in CTRL-WED map");
-				_windowEndedRequestsMutex.unlock();
-				return;
-			}
-
-			enigmaMapIt =	_windowEndedRequestsIt->second.find(enigma);
-			sessionKeyMapIt = enigmaMapIt->second.find(sessionKey);
-
-			// window ended received. stop here, update RTT and leave
-			if (sessionKeyMapIt->second)
-			{
-				timeWaited = currentTime - startStartTime;
-				LOG4CXX_TRACE(logger, "LTP CTRL-WED received for CID "
-						<< cId.print() << " after waiting "
-						<< timeWaited.total_milliseconds() << "ms");
-				// Update RTT
-				_rtt(timeWaited.total_milliseconds());
-				_statistics.roundTripTime(cId, timeWaited.total_milliseconds());
-				// Erase entry from WED request map
-				enigmaMapIt->second.erase(sessionKeyMapIt);
-				LOG4CXX_TRACE(logger, "SK (FD) " << sessionKey << " removed "
-						"from CTRL-WED map for rCID " << rCId.print()
-						<< " > enigma " << enigma);
-
-				// Delete entire enigma key if empty
-				if (enigmaMapIt->second.size() == 0)
-				{
-					_windowEndedRequestsIt->second.erase(enigmaMapIt);
-					LOG4CXX_TRACE(logger, "Entire CTRL-WED enigma entry "
-							<< enigma << " in _windowEndedRequests map"
-							" deleted for rCID " << rCId.print());
-				}
-
-				// Delete the entire rCID key if values are empty
-				if (_windowEndedRequestsIt->second.size() == 0)
-				{
-					_windowEndedRequests.erase(_windowEndedRequestsIt);
-					LOG4CXX_TRACE(logger, "Entire rCID " << rCId.print()
-							<< " entry in _windowEndedRequests map "
-									"deleted");
-				}
-
-				_windowEndedRequestsMutex.unlock();
-				return;
-			}
-
-			_windowEndedRequestsMutex.unlock();
-		}
-
-		LOG4CXX_TRACE(logger, "WED CTRL has not been received within given "
-				"timeout of " << _rttMultiplier * rtt << "ms for CID "
-				<< cId.print());
-		_publishWindowEnd(cId, rCId, enigma, sessionKey, sequenceNumber);
-		attempts--;
-
-		if (attempts == 0)
-		{
-			LOG4CXX_DEBUG(logger, "Subscriber to CID " << cId.print() << " has "
-					"not responded to WE CTRL message after " << (int)ENIGMA
-					<< " attempts. Stopping here");
-		}
-	}
+	// calculate the payload the LTP packet can carry
+	uint32_t mtu = _configuration.mtu() - cId.length() - rCId.length() -
+			_configuration.icnHeaderLength() - LTP_DATA_HEADER_LENGTH_V2 - 20;
+	mtu = mtu - (mtu % 8);//make it a multiple of 8
+	// Fragmentation, flow control and the CTRL-WE timer are handled by the
+	// LTP sender thread
+	_ltpSender.enqueue(cId, rCId, enigma, sessionKey, data, dataSize, mtu);
 }
 
 void Lightweight::publishEndOfSession(IcnId &rCid, enigma_t &enigma,
@@ -492,19 +416,8 @@ void Lightweight::publishFromBuffer(IcnId &cId, IcnId &rCId,
 		enigma_t &enigma, sk_t &sessionKey, uint8_t *data,
 		uint16_t &dataSize)
 {
-	_addReverseLookUp(cId, rCId);
-	ltp_hdr_data_t ltpHeader;
-	// First publish the packet (and send WE)
-	ltpHeader.sequenceNumber = _publishData(cId, rCId, enigma, sessionKey,
-			data, dataSize);
-	// Starting timer in a thread and go back to the ICN handler
-	LightweightTimeout ltpTimeout(cId, rCId, enigma, sessionKey,
-			ltpHeader.sequenceNumber, _icnCore, _icnCoreMutex, _rtt(),
-			&_proxyPacketBuffer, &_proxyPacketBufferMutex,
-			&_windowEndedRequests, &_windowEndedRequestsMutex);
-	std::thread *ltpTimeoutThread = new std::thread(ltpTimeout);
-	ltpTimeoutThread->detach();
-	delete ltpTimeoutThread;
+	// The LTP sender never blocks, so this is the same as publishing directly
+	publish(cId, rCId, enigma, sessionKey, data, dataSize);
 }
 
 void Lightweight::publishReset(IcnId &cid, IcnId &rCid)
@@ -562,7 +475,7 @@ void Lightweight::publishReset(IcnId &cid, IcnId &rCid)
 }*/
 
 tp_states_t Lightweight::handle(IcnId &rCid, uint8_t *packet,
-		enigma_t &enigma, sk_t &sessionKey)
+		uint16_t packetSize, enigma_t &enigma, sk_t &sessionKey)
 {
 	tp_states_t ltpState;
 	// First get the LTP message type (data || control)
@@ -573,11 +486,13 @@ tp_states_t Lightweight::handle(IcnId &rCid, uint8_t *packet,
 	switch (header.messageType)
 	{
 	case LTP_DATA:
+	case LTP_DATA_V2:
 		_handleData(rCid, packet);
 		ltpState = TP_STATE_NO_ACTION_REQUIRED;
 		break;
 	case LTP_CONTROL:
-		ltpState = _handleControl(rCid, packet, enigma, sessionKey);
+		ltpState = _handleControl(rCid, packet, packetSize, enigma,
+				sessionKey);
 		break;
 	default:
 		LOG4CXX_WARN(logger, "Unknown LTP message type " << header.messageType
@@ -589,7 +504,8 @@ tp_states_t Lightweight::handle(IcnId &rCid, uint8_t *packet,
 }
 
 tp_states_t Lightweight::handle(IcnId &cId, IcnId &rCId, string &nodeIdStr,
-		uint8_t *packet, enigma_t &enigma, sk_t &sessionKey)
+		uint8_t *packet, uint16_t packetSize, enigma_t &enigma,
+		sk_t &sessionKey)
 {
 	tp_states_t ltpState;
 	NodeId nodeId = nodeIdStr;
@@ -602,12 +518,13 @@ tp_states_t Lightweight::handle(IcnId &cId, IcnId &rCId, string &nodeIdStr,
 	switch (ltpHeader.messageType)
 	{
 	case LTP_DATA:
+	case LTP_DATA_V2:
 		_handleData(cId, rCId, nodeId, packet);
 		ltpState = TP_STATE_NO_ACTION_REQUIRED;
 		break;
 	case LTP_CONTROL:
-		ltpState = _handleControl(cId, rCId, nodeId, packet, enigma,
-				sessionKey);
+		ltpState = _handleControl(cId, rCId, nodeId, packet, packetSize,
+				enigma, sessionKey);
 		break;
 	default:
 		ltpState = TP_STATE_NO_ACTION_REQUIRED;
@@ -620,6 +537,7 @@ bool Lightweight::retrieveIcnPacket(IcnId &rCId, enigma_t &enigma,
 		string &nodeIdStr, sk_t &sessionKey, uint8_t *packet,
 		uint16_t &packetSize)
 {
+	icn_packet_buffer_t::iterator icnPacketBufferIt;
 	NodeId nodeId = nodeIdStr;
 	// map<SeqNum,PACKET>>>
 	map<seq_t, pair<uint8_t*, uint16_t>>::iterator sequenceMapIt;
@@ -635,9 +553,9 @@ bool Lightweight::retrieveIcnPacket(IcnId &rCId, enigma_t &enigma,
 	packetSize = 0;
 	uint16_t offset = 0;
 	_icnPacketBufferMutex.lock();
-	_icnPacketBufferIt = _icnPacketBuffer.find(rCId.uint());
+	icnPacketBufferIt = _icnPacketBuffer.find(rCId.uint());
 
-	if (_icnPacketBufferIt == _icnPacketBuffer.end())
+	if (icnPacketBufferIt == _icnPacketBuffer.end())
 	{
 		LOG4CXX_DEBUG(logger, "rCID " << rCId.print() << " does not exist in "
 				"ICN packet buffer. Nothing to retrieve");
@@ -645,9 +563,9 @@ bool Lightweight::retrieveIcnPacket(IcnId &rCId, enigma_t &enigma,
 		return false;
 	}
 
-	enigmaMapIt = _icnPacketBufferIt->second.find(enigma);
+	enigmaMapIt = icnPacketBufferIt->second.find(enigma);
 
-	if (enigmaMapIt == _icnPacketBufferIt->second.end())
+	if (enigmaMapIt == icnPacketBufferIt->second.end())
 	{
 		LOG4CXX_DEBUG(logger, "enigma " << enigma << " for known rCID "
 				<< rCId.print() << " does not exist in ICN packet buffer. "
@@ -699,12 +617,14 @@ bool Lightweight::retrieveIcnPacket(IcnId &rCId, enigma_t &enigma,
 }
 
 void Lightweight::_addNackNodeId(IcnId &rCid,
-		ltp_hdr_ctrl_nack_t &ltpHeaderNack, NodeId &nodeId)
+		ltp_hdr_ctrl_nack_t &ltpHeaderNack, ltp_sequences_t &sequences,
+		NodeId &nodeId)
 {
+	nack_groups_t::iterator nackGroupsIt;
 
-	_nackGroupsIt = _nackGroups.find(rCid.uint());
+	nackGroupsIt = _nackGroups.find(rCid.uint());
 	// rCID does not exist yet
-	if (_nackGroupsIt == _nackGroups.end())
+	if (nackGroupsIt == _nackGroups.end())
 	{
 		// map<Enigma,map<SK,   struct<nackGroup
 		map<enigma_t, map<sk_t, nack_group_t>> enigmaMap;
@@ -712,43 +632,41 @@ void Lightweight::_addNackNodeId(IcnId &rCid,
 		map<sk_t, nack_group_t> skMap;
 		nack_group_t nackGroup;
 		nackGroup.nodeIds.push_back(nodeId);
-		nackGroup.startSequence = ltpHeaderNack.start;
-		nackGroup.endSequence = ltpHeaderNack.end;
+		nackGroup.sequences = sequences;
 		skMap.insert(pair<sk_t, nack_group_t>(ltpHeaderNack.sessionKey,
 				nackGroup));
 		enigmaMap.insert(pair<enigma_t, map<sk_t, nack_group_t>>(
 				ltpHeaderNack.enigma, skMap));
-		_nackGroups.insert(pair<cid_t, map<enigma_t, map<sk_t, nack_group_t>>>
-				(rCid.uint(), enigmaMap));
+		_nackGroups.insert(pair<cid_t, map<enigma_t, map<sk_t,
+				nack_group_t>>>(rCid.uint(), enigmaMap));
 		LOG4CXX_TRACE(logger, "New NACK group created for rCID " << rCid.print()
 				<< " > enigma " << ltpHeaderNack.enigma << " > SK "
-				<< ltpHeaderNack.sessionKey << " with segment range "
-				<< ltpHeaderNack.start << " - " << ltpHeaderNack.end
-				<< " and NID " << nodeId.uint());
+				<< ltpHeaderNack.sessionKey << " with "
+				<< sequences.size() << " missing segments and NID "
+				<< nodeId.uint());
 		return;
 	}
 
 	// rCID exists
 	map<enigma_t, map<sk_t, nack_group_t>>::iterator enigmaMapIt;
-	enigmaMapIt = _nackGroupsIt->second.find(ltpHeaderNack.enigma);
+	enigmaMapIt = nackGroupsIt->second.find(ltpHeaderNack.enigma);
 
 	// enigma does not exist
-	if (enigmaMapIt == _nackGroupsIt->second.end())
+	if (enigmaMapIt == nackGroupsIt->second.end())
 	{
 		map<sk_t, nack_group_t> skMap;
 		nack_group_t nackGroup;
 		nackGroup.nodeIds.push_back(nodeId);
-		nackGroup.startSequence = ltpHeaderNack.start;
-		nackGroup.endSequence = ltpHeaderNack.end;
+		nackGroup.sequences = sequences;
 		skMap.insert(pair<sk_t, nack_group_t>(ltpHeaderNack.sessionKey,
 				nackGroup));
-		_nackGroupsIt->second.insert(pair<enigma_t, map<sk_t, nack_group_t>>
+		nackGroupsIt->second.insert(pair<enigma_t, map<sk_t, nack_group_t>>
 				(ltpHeaderNack.enigma, skMap));
 		LOG4CXX_TRACE(logger, "New NACK group created for known rCID "
 				<< rCid.print()	<< " but new enigma " << ltpHeaderNack.enigma
-				<< " > SK " << ltpHeaderNack.sessionKey << " with segment "
-				"range " << ltpHeaderNack.start << " - " << ltpHeaderNack.end
-				<< " and NID " << nodeId.uint());
+				<< " > SK " << ltpHeaderNack.sessionKey << " with "
+				<< sequences.size() << " missing segments and NID "
+				<< nodeId.uint());
 		return;
 	}
 
@@ -761,14 +679,14 @@ void Lightweight::_addNackNodeId(IcnId &rCid,
 	{
 		nack_group_t nackGroup;
 		nackGroup.nodeIds.push_back(nodeId);
-		nackGroup.startSequence = ltpHeaderNack.start;
+		nackGroup.sequences = sequences;
 		enigmaMapIt->second.insert(pair<sk_t, nack_group_t>(
 				ltpHeaderNack.sessionKey, nackGroup));
 		LOG4CXX_TRACE(logger, "New NACK group created for known rCID "
 				<< rCid.print()	<< " > enigma " << ltpHeaderNack.enigma
-				<< " but new SK " << ltpHeaderNack.sessionKey << " with segment"
-				" range " << ltpHeaderNack.start << " - " << ltpHeaderNack.end
-				<< " and NID " << nodeId.uint());
+				<< " but new SK " << ltpHeaderNack.sessionKey << " with "
+				<< sequences.size() << " missing segments and NID "
+				<< nodeId.uint());
 		return;
 	}
 
@@ -797,25 +715,12 @@ void Lightweight::_addNackNodeId(IcnId &rCid,
 				<< " > SK " << ltpHeaderNack.sessionKey);
 	}
 
-	// decrease the start segment number if required
-	if (ltpHeaderNack.start < skMapIt->second.startSequence)
-	{
-		skMapIt->second.startSequence = ltpHeaderNack.start;
-		LOG4CXX_TRACE(logger, "Start segment decreased to "
-				<< skMapIt->second.startSequence << " for rCID " << rCid.print()
-				<< " > enigma " << ltpHeaderNack.enigma << " > SK "
-				<< ltpHeaderNack.sessionKey);
-	}
-
-	// increase the end segment number if required
-	if (ltpHeaderNack.end > skMapIt->second.endSequence)
-	{
-		skMapIt->second.endSequence = ltpHeaderNack.end;
-		LOG4CXX_TRACE(logger, "Start segment increased to "
-				<< skMapIt->second.endSequence << " for rCID " << rCid.print()
-				<< " > enigma " << ltpHeaderNack.enigma << " > SK "
-				<< ltpHeaderNack.sessionKey);
-	}
+	// add the segments this NID is missing
+	skMapIt->second.sequences.insert(sequences.begin(), sequences.end());
+	LOG4CXX_TRACE(logger, "NACK group for rCID " << rCid.print() << " > enigma "
+			<< ltpHeaderNack.enigma << " > SK " << ltpHeaderNack.sessionKey
+			<< " now covers " << skMapIt->second.sequences.size()
+			<< " missing segments");
 }
 
 void Lightweight::_addNodeId(NodeId &nodeId)
@@ -834,6 +739,7 @@ void Lightweight::_addNodeId(NodeId &nodeId)
 void Lightweight::_addNodeIdToWindowUpdate(IcnId &rCid, enigma_t &enigma,
 			sk_t &sessionKey, NodeId &nodeId)
 {
+	window_update_t::iterator windowUpdateIt;
 	//map<NID, WUD has not been received
 	map<nid_t, bool> nidMap;
 	map<nid_t, bool>::iterator nidIt;
@@ -842,10 +748,10 @@ void Lightweight::_addNodeIdToWindowUpdate(IcnId &rCid, enigma_t &enigma,
 	map<enigma_t, map<sk_t, map<nid_t, bool>>> enigmaMap;
 	map<enigma_t, map<sk_t, map<nid_t, bool>>>::iterator enigmaIt;
 	_windowUpdateMutex.lock();
-	_windowUpdateIt = _windowUpdate.find(rCid.uint());
+	windowUpdateIt = _windowUpdate.find(rCid.uint());
 
 	// rCID not found
-	if (_windowUpdateIt == _windowUpdate.end())
+	if (windowUpdateIt == _windowUpdate.end())
 	{
 		nidMap.insert(pair<nid_t, bool>(nodeId.uint(), false));
 		skMap.insert(pair<sk_t, map<nid_t, bool>>(sessionKey, nidMap));
@@ -861,14 +767,14 @@ void Lightweight::_addNodeIdToWindowUpdate(IcnId &rCid, enigma_t &enigma,
 	}
 
 	// rCID found
-	enigmaIt = _windowUpdateIt->second.find(enigma);
+	enigmaIt = windowUpdateIt->second.find(enigma);
 
 	// enigma does not exist
-	if (enigmaIt == _windowUpdateIt->second.end())
+	if (enigmaIt == windowUpdateIt->second.end())
 	{
 		nidMap.insert(pair<nid_t, bool>(nodeId.uint(), false));
 		skMap.insert(pair<sk_t, map<nid_t, bool>>(sessionKey, nidMap));
-		_windowUpdateIt->second.insert(pair<enigma_t, map<sk_t,
+		windowUpdateIt->second.insert(pair<enigma_t, map<sk_t,
 				map<nid_t, bool>>>(enigma, skMap));
 		LOG4CXX_TRACE(logger, "NID " << nodeId.uint() << " added to existing "
 				"rCID "	<< rCid.print() << " but new enigma " << enigma
@@ -936,8 +842,8 @@ void Lightweight::_addSessionEnd(IcnId &rCid, sk_t &sessionKey)
 	{
 		unordered_map<sk_t, bool> skMap;
 		skMap.insert(pair<sk_t, bool>(sessionKey, false));
-		_sessionEndedResponsesUnicast.insert(pair<cid_t, unordered_map<sk_t,
-				bool>>(rCid.uint(), skMap));
+		_sessionEndedResponsesUnicast.insert(pair<cid_t,
+				unordered_map<sk_t, bool>>(rCid.uint(), skMap));
 		LOG4CXX_TRACE(logger, "New LTP CTRL-SED boolean added for new rCID "
 				<< rCid.print() << " > SK " << sessionKey);
 		_sessionEndedResponsesUnicastMutex.unlock();
@@ -966,16 +872,17 @@ void Lightweight::_addSessionEnd(IcnId &rCid, sk_t &sessionKey)
 void Lightweight::_addSessionEnd(IcnId &rCid, ltp_hdr_ctrl_se_t &ltpHdrCtrlSe,
 			list<NodeId> nodeIds)
 {
+	session_ended_responses_t::iterator sessionEndedResponsesIt;
 	// 		u_map<SK, SED received
 	unordered_map<sk_t, bool>::iterator skIt;
 	unordered_map<nid_t, unordered_map<sk_t, bool>>::iterator nidIt;
 	unordered_map<enigma_t, unordered_map<nid_t, unordered_map<sk_t,
 			bool>>>::iterator enigmaIt;
 	_sessionEndedResponsesMutex.lock();
-	_sessionEndedResponsesIt = _sessionEndedResponses.find(rCid.uint());
+	sessionEndedResponsesIt = _sessionEndedResponses.find(rCid.uint());
 
 	// rCID does not exist
-	if (_sessionEndedResponsesIt == _sessionEndedResponses.end())
+	if (sessionEndedResponsesIt == _sessionEndedResponses.end())
 	{
 		unordered_map<sk_t, bool> skMap;
 		unordered_map<nid_t, unordered_map<sk_t, bool>> nidMap;
@@ -1004,10 +911,10 @@ void Lightweight::_addSessionEnd(IcnId &rCid, ltp_hdr_ctrl_se_t &ltpHdrCtrlSe,
 		return;
 	}
 
-	enigmaIt = _sessionEndedResponsesIt->second.find(ltpHdrCtrlSe.enigma);
+	enigmaIt = sessionEndedResponsesIt->second.find(ltpHdrCtrlSe.enigma);
 
 	// enigma does not exist
-	if (enigmaIt == _sessionEndedResponsesIt->second.end())
+	if (enigmaIt == sessionEndedResponsesIt->second.end())
 	{
 		unordered_map<sk_t, bool> skMap;
 		unordered_map<nid_t, unordered_map<sk_t, bool>> nidMap;
@@ -1020,7 +927,7 @@ void Lightweight::_addSessionEnd(IcnId &rCid, ltp_hdr_ctrl_se_t &ltpHdrCtrlSe,
 					(it->uint(), skMap));
 		}
 
-		_sessionEndedResponsesIt->second.insert(pair<enigma_t,
+		sessionEndedResponsesIt->second.insert(pair<enigma_t,
 				unordered_map<nid_t, unordered_map<sk_t, bool>>>
 				(ltpHdrCtrlSe.enigma, nidMap));
 		LOG4CXX_TRACE(logger, "New CTRL-SED boolean added for known rCid "
@@ -1080,12 +987,13 @@ void Lightweight::_addSessionEnd(IcnId &rCid, ltp_hdr_ctrl_se_t &ltpHdrCtrlSe,
 
 void Lightweight::_addWindowEnd(IcnId &rCid, ltp_hdr_ctrl_we_t &ltpHeaderCtrlWe)
 {
+	window_ended_requests_t::iterator windowEndedRequestsIt;
 	// Inform endpoint that all data has been sent
 	_windowEndedRequestsMutex.lock();
-	_windowEndedRequestsIt = _windowEndedRequests.find(rCid.uint());
+	windowEndedRequestsIt = _windowEndedRequests.find(rCid.uint());
 
 	// rCID does not exist in WED map
-	if (_windowEndedRequestsIt == _windowEndedRequests.end())
+	if (windowEndedRequestsIt == _windowEndedRequests.end())
 	{
 		map<sk_t, bool> sessionKeyMap;
 		map<enigma_t, map<sk_t, bool>> enigmaMap;
@@ -1103,16 +1011,16 @@ void Lightweight::_addWindowEnd(IcnId &rCid, ltp_hdr_ctrl_we_t &ltpHeaderCtrlWe)
 	else
 	{
 		map<enigma_t, map<sk_t, bool>>::iterator enigmaMapIt;
-		enigmaMapIt = _windowEndedRequestsIt->second.find(
+		enigmaMapIt = windowEndedRequestsIt->second.find(
 				ltpHeaderCtrlWe.enigma);
 
 		// enigma does not exist
-		if (enigmaMapIt == _windowEndedRequestsIt->second.end())
+		if (enigmaMapIt == windowEndedRequestsIt->second.end())
 		{
 			map<sk_t, bool> sessionKeyMap;
 			sessionKeyMap.insert(pair<sk_t, bool>(
 					ltpHeaderCtrlWe.sessionKey, false));
-			_windowEndedRequestsIt->second.insert(pair<enigma_t, map<sk_t,
+			windowEndedRequestsIt->second.insert(pair<enigma_t, map<sk_t,
 					bool>>(ltpHeaderCtrlWe.enigma, sessionKeyMap));
 			LOG4CXX_TRACE(logger, "New CTRL-WED boolean added for existing "
 					"rCID " << rCid.print() << " but new enigma "
@@ -1150,13 +1058,14 @@ void Lightweight::_addWindowEnd(IcnId &rCid, ltp_hdr_ctrl_we_t &ltpHeaderCtrlWe)
 void Lightweight::_addWindowEnd(IcnId &rCid, list<NodeId> &nodeIds,
 		ltp_hdr_ctrl_we_t &ltpHeaderCtrlWe)
 {
+	window_ended_responses_t::iterator windowEndedResponsesIt;
 	ostringstream oss;
 	// Inform endpoint that all data has been sent
 	_windowEndedResponsesMutex.lock();
-	_windowEndedResponsesIt = _windowEndedResponses.find(rCid.uint());
+	windowEndedResponsesIt = _windowEndedResponses.find(rCid.uint());
 
 	// rCID does not exist in WED map
-	if (_windowEndedResponsesIt == _windowEndedResponses.end())
+	if (windowEndedResponsesIt == _windowEndedResponses.end())
 	{
 		map<sk_t, bool> sessionKeyMap;
 		map<nid_t, map<sk_t, bool>> nidMap;
@@ -1184,11 +1093,11 @@ void Lightweight::_addWindowEnd(IcnId &rCid, list<NodeId> &nodeIds,
 
 	// rCID exists
 	map<enigma_t, map<nid_t, map<sk_t, bool>>>::iterator enigmaMapIt;
-	enigmaMapIt = _windowEndedResponsesIt->second.find(
+	enigmaMapIt = windowEndedResponsesIt->second.find(
 			ltpHeaderCtrlWe.enigma);
 
 	// enigma does not exist
-	if (enigmaMapIt == _windowEndedResponsesIt->second.end())
+	if (enigmaMapIt == windowEndedResponsesIt->second.end())
 	{
 		map<sk_t, bool> sessionKeyMap;
 		map<nid_t, map<sk_t, bool>> nidMap;
@@ -1203,7 +1112,7 @@ void Lightweight::_addWindowEnd(IcnId &rCid, list<NodeId> &nodeIds,
 			oss << nidsIt->uint() << " ";
 		}
 
-		_windowEndedResponsesIt->second.insert(pair<enigma_t, map<nid_t,
+		windowEndedResponsesIt->second.insert(pair<enigma_t, map<nid_t,
 				map<uint16_t, bool>>>(ltpHeaderCtrlWe.enigma, nidMap));
 		LOG4CXX_TRACE(logger, "New CTRL-WED boolean added for existing "
 				"rCID " << rCid.print() << " but new enigma "
@@ -1271,6 +1180,7 @@ void Lightweight::_addWindowEnd(IcnId &rCid, list<NodeId> &nodeIds,
 void Lightweight::_bufferIcnPacket(IcnId &rCId, NodeId &nodeId,
 		ltp_hdr_data_t &ltpHeader, uint8_t *packet)
 {
+	icn_packet_buffer_t::iterator icnPacketBufferIt;
 	//         Packet
 	map<seq_t, pair<uint8_t*, uint16_t>> sequenceMap;
 	map<seq_t, pair<uint8_t*, uint16_t>>::iterator sequenceMapIt;
@@ -1299,10 +1209,10 @@ void Lightweight::_bufferIcnPacket(IcnId &rCId, NodeId &nodeId,
 	}
 
 	_icnPacketBufferMutex.lock();
-	_icnPacketBufferIt = _icnPacketBuffer.find(rCId.uint());
+	icnPacketBufferIt = _icnPacketBuffer.find(rCId.uint());
 
 	// First packet received for rCId
-	if (_icnPacketBufferIt == _icnPacketBuffer.end())
+	if (icnPacketBufferIt == _icnPacketBuffer.end())
 	{
 		sequenceMap.insert(pair<seq_t, pair<uint8_t*, uint16_t>>(
 				ltpHeader.sequenceNumber, packetDescriptor));
@@ -1312,8 +1222,9 @@ void Lightweight::_bufferIcnPacket(IcnId &rCId, NodeId &nodeId,
 				uint16_t>>>>(nodeId.uint(), sessionKeyMap));
 		enigmaMap.insert(pair<enigma_t, map<nid_t, map<sk_t, map<seq_t,
 				pair<uint8_t*, uint16_t>>>>>(ltpHeader.enigma, nodeIdMap));
-		_icnPacketBuffer.insert(pair<cid_t, map<enigma_t, map<nid_t, map<sk_t,
-				map<seq_t, pair<uint8_t*, uint16_t>>>>>>(rCId.uint(), enigmaMap));
+		_icnPacketBuffer.insert(pair<cid_t, map<enigma_t, map<nid_t,
+				map<sk_t, map<seq_t, pair<uint8_t*, uint16_t>>>>>>(rCId.uint(),
+						enigmaMap));
 		LOG4CXX_TRACE(logger, "Packet of length " << ltpHeader.payloadLength
 				<< " for new rCID " << rCId.print() << " added to LTP packet "
 				"buffer for received ICN packets (enigma "
@@ -1325,10 +1236,10 @@ void Lightweight::_bufferIcnPacket(IcnId &rCId, NodeId &nodeId,
 	}
 
 	// rCId is known
-	enigmaMapIt = _icnPacketBufferIt->second.find(ltpHeader.enigma);
+	enigmaMapIt = icnPacketBufferIt->second.find(ltpHeader.enigma);
 
 	// enigma entry does not exist. Create it
-	if (enigmaMapIt == _icnPacketBufferIt->second.end())
+	if (enigmaMapIt == icnPacketBufferIt->second.end())
 	{
 		sequenceMap.insert(pair<seq_t, pair<uint8_t*, uint16_t>>(
 				ltpHeader.sequenceNumber, packetDescriptor));
@@ -1336,7 +1247,7 @@ void Lightweight::_bufferIcnPacket(IcnId &rCId, NodeId &nodeId,
 				(ltpHeader.sessionKey, sequenceMap));
 		nodeIdMap.insert(pair<nid_t, map<sk_t, map<seq_t, pair<uint8_t*,
 				uint16_t>>>> (nodeId.uint(), sessionKeyMap));
-		_icnPacketBufferIt->second.insert(pair<enigma_t, map<nid_t, map<sk_t,
+		icnPacketBufferIt->second.insert(pair<enigma_t, map<nid_t, map<sk_t,
 				map<seq_t, pair<uint8_t*, uint16_t>>>>>(ltpHeader.enigma,
 						nodeIdMap));
 		LOG4CXX_TRACE(logger, "Packet of length " << ltpHeader.payloadLength
@@ -1431,255 +1342,59 @@ void Lightweight::_bufferIcnPacket(IcnId &rCId, NodeId &nodeId,
 }
 
 void Lightweight::_bufferLtpPacket(IcnId &rCid, ltp_hdr_data_t &ltpHeaderData,
-		uint8_t *packet, uint16_t packetSize)
+		LtpMessage *message, uint8_t *payload, uint16_t fragmentSize)
 {
-	map<cid_t, map<enigma_t, map<sk_t, map<seq_t, packet_t>>>>::iterator rCidIt;
-	map<enigma_t, map<sk_t, map<seq_t, packet_t>>>::iterator enigmaIt;
-	map<sk_t, map<seq_t, packet_t>>::iterator skIt;
-	map<seq_t, packet_t>::iterator snIt;
-	packet_t packetDescription;
-	// Note, ltpHeaderData.payloadLength only has the HTTP msg. paketSize is
-	// padded to be a multiple of 4!
-	packetDescription.packet = (uint8_t *)malloc(packetSize);
-	memcpy(packetDescription.packet, packet, packetSize);
-	packetDescription.packetSize = packetSize;
-	packetDescription.timestamp =
-			boost::posix_time::microsec_clock::local_time();
+	// Note, ltpHeaderData.payloadLength only has the HTTP msg. fragmentSize is
+	// padded to be a multiple of 8!
 	_ltpPacketBufferMutex.lock();
-	rCidIt = _ltpPacketBuffer.find(rCid.uint());
-
-	// rCID not found
-	if (rCidIt == _ltpPacketBuffer.end())
-	{
-		map<seq_t, packet_t> snMap;
-		snMap.insert(pair<seq_t, packet_t>(ltpHeaderData.sequenceNumber,
-				packetDescription));
-		map<sk_t, map<seq_t, packet_t>> skMap;
-		skMap.insert(pair<sk_t, map<seq_t, packet_t>>(ltpHeaderData.sessionKey,
-				snMap));
-		map<enigma_t, map<sk_t, map<seq_t, packet_t>>> enigmaMap;
-		enigmaMap.insert(pair<enigma_t, map<sk_t, map<seq_t, packet_t>>>
-				(ltpHeaderData.enigma, skMap));
-		_ltpPacketBuffer.insert(pair<cid_t, map<enigma_t, map<sk_t, map<seq_t,
-				packet_t>>>>(rCid.uint(), enigmaMap));
-		_ltpPacketBufferMutex.unlock();
-		LOG4CXX_TRACE(logger, "LTP packet buffered of length "
-				<< ltpHeaderData.payloadLength << " and Sequence "
-				<< ltpHeaderData.sequenceNumber << " under new rCID "
-				<< rCid.print() << " > enigma " << ltpHeaderData.enigma
-				<< " > SK " << ltpHeaderData.sessionKey);
-		return;
-	}
-
-	enigmaIt = rCidIt->second.find(ltpHeaderData.enigma);
-
-	// enigma not found
-	if (enigmaIt == rCidIt->second.end())
-	{
-		map<seq_t, packet_t> snMap;
-		snMap.insert(pair<seq_t, packet_t>(ltpHeaderData.sequenceNumber,
-				packetDescription));
-		map<sk_t, map<seq_t, packet_t>> skMap;
-		skMap.insert(pair<sk_t, map<seq_t, packet_t>>(ltpHeaderData.sessionKey,
-				snMap));
-		rCidIt->second.insert(pair<enigma_t, map<sk_t, map<seq_t, packet_t>>>
-				(ltpHeaderData.enigma, skMap));
-		_ltpPacketBufferMutex.unlock();
-		LOG4CXX_TRACE(logger, "LTP packet buffered of length "
-				<< ltpHeaderData.payloadLength << " and Sequence "
-				<< ltpHeaderData.sequenceNumber << " under known rCID "
-				<< rCid.print() << " but new enigma " << ltpHeaderData.enigma
-				<< " > SK " << ltpHeaderData.sessionKey);
-		return;
-	}
 
-	skIt = enigmaIt->second.find(ltpHeaderData.sessionKey);
-
-	// SK not found
-	if (skIt == enigmaIt->second.end())
-	{
-		// Sequence
-		map<seq_t, packet_t> snMap;
-		snMap.insert(pair<seq_t, packet_t>(ltpHeaderData.sequenceNumber,
-				packetDescription));
-		enigmaIt->second.insert(pair<sk_t, map<seq_t, packet_t>>
-				(ltpHeaderData.sessionKey, snMap));
-		_ltpPacketBufferMutex.unlock();
-		LOG4CXX_TRACE(logger, "LTP packet buffred of length "
-				<< ltpHeaderData.payloadLength << " and Sequence "
-				<< ltpHeaderData.sequenceNumber << " under known rCID "
-				<< rCid.print() << " > enigma " << ltpHeaderData.enigma
-				<< " but new SK " << ltpHeaderData.sessionKey);
-		return;
-	}
-
-	snIt = skIt->second.find(ltpHeaderData.sequenceNumber);
-
-	if (snIt != skIt->second.end())
+	if (!_ltpPacketBuffer.add(rCid.uint(), ltpHeaderData.enigma,
+			ltpHeaderData.sessionKey, ltpHeaderData.sequenceNumber, message,
+			payload, ltpHeaderData.payloadLength, fragmentSize, false))
 	{
 		_ltpPacketBufferMutex.unlock();
 		LOG4CXX_WARN(logger, "Sequence number " << ltpHeaderData.sequenceNumber
-				<< " already exists in LTP buffer for rCID " << rCid.print()
+				<< " could not be added to LTP buffer for rCID " << rCid.print()
 				<< " > enigma " << ltpHeaderData.enigma << " > SK "
-				<< ltpHeaderData.sessionKey);
+				<< ltpHeaderData.sessionKey << " (already exists)");
 		return;
 	}
 
-	skIt->second.insert(pair<seq_t, packet_t>(ltpHeaderData.sequenceNumber,
-			packetDescription));
 	_ltpPacketBufferMutex.unlock();
 	LOG4CXX_TRACE(logger, "LTP packet buffered of length "
 			<< ltpHeaderData.payloadLength << " and Sequence "
-			<< ltpHeaderData.sequenceNumber << " under known rCID "
+			<< ltpHeaderData.sequenceNumber << " under rCID "
 			<< rCid.print() << " > enigma " << ltpHeaderData.enigma
 			<< " > SK " << ltpHeaderData.sessionKey);
-
 }
 
 void Lightweight::_bufferProxyPacket(IcnId &cId, IcnId &rCId,
-		ltp_hdr_data_t &ltpHeaderData, uint8_t *packet,
-		uint16_t &packetSize)
+		ltp_hdr_data_t &ltpHeaderData, LtpMessage *message, uint8_t *payload,
+		uint16_t fragmentSize)
 {
-	pair<uint8_t *, uint16_t> packetDescriptor;
 	_proxyPacketBufferMutex.lock();
-	_proxyPacketBufferIt = _proxyPacketBuffer.find(rCId.uint());
-
-	// rCID does not exist, create new entry
-	if (_proxyPacketBufferIt == _proxyPacketBuffer.end())
-	{
-		/* First create the map with the sequence number as the key and the
-		 * packet (pointer/size) as the map's value
-		 */
-		map<seq_t, pair<uint8_t *, uint16_t>> sequenceMap;
-		map<sk_t, map<seq_t, pair<uint8_t *, uint16_t>>> sessionKeyMap;
-		map<enigma_t, map<sk_t, map<seq_t, pair<uint8_t *, uint16_t>>>> enigmaMap;
-		packetDescriptor.first = (uint8_t *)malloc(packetSize);
-		memcpy(packetDescriptor.first, packet, packetSize);
-		packetDescriptor.second = packetSize;
-		sequenceMap.insert(pair<uint16_t, pair<uint8_t *, uint16_t>>(
-				ltpHeaderData.sequenceNumber, packetDescriptor));
-		// Secondly, create a new session key map
-		sessionKeyMap.insert(pair<sk_t, map<seq_t, pair<uint8_t *, uint16_t>>>
-				(ltpHeaderData.sessionKey, sequenceMap));
-		// Thirdly, create a new enigma map with the session key Map above as its
-		// value
-		enigmaMap.insert(pair<enigma_t, map<sk_t, map<seq_t, pair<uint8_t *,
-				uint16_t>>>>(ltpHeaderData.enigma,	sessionKeyMap));
-		/* Fourthly, create new rCID key entry in _proxyPacketBuffer map with
-		 * the enigmaMap as its value
-		 */
-		_proxyPacketBuffer.insert(pair<cid_t, map<enigma_t, map<sk_t, map<seq_t,
-				pair<uint8_t *, uint16_t>>>>>(rCId.uint(), enigmaMap));
-		LOG4CXX_TRACE(logger, "Proxy packet buffered of length " << packetSize
-				<< " and CID" << cId.print() << " ("	<< cId.printFqdn()
-				<< ") for new rCID " << rCId.print() << " > enigma "
-				<< ltpHeaderData.enigma << " > Session "
-				<< ltpHeaderData.sessionKey << " > Sequence "
-				<< ltpHeaderData.sequenceNumber);
-		_proxyPacketBufferMutex.unlock();
-		return;
-	}
 
-	// rCID exists
-	map<enigma_t, map<sk_t, map<seq_t, pair<uint8_t *, uint16_t>>>>::iterator enigmaIt;
-	enigmaIt = _proxyPacketBufferIt->second.find(ltpHeaderData.enigma);
-
-	// enigma does not exist
-	if (enigmaIt == _proxyPacketBufferIt->second.end())
+	// An existing sequence gets overwritten (DNSlocal scenario)
+	if (!_proxyPacketBuffer.add(rCId.uint(), ltpHeaderData.enigma,
+			ltpHeaderData.sessionKey, ltpHeaderData.sequenceNumber, message,
+			payload, ltpHeaderData.payloadLength, fragmentSize, true))
 	{
-		map<seq_t, pair<uint8_t *, uint16_t>> sequenceMap;
-		map<sk_t, map<seq_t, pair<uint8_t *, uint16_t>>> sessionKeyMap;
-		packetDescriptor.first = (uint8_t *)malloc(packetSize);
-		memcpy(packetDescriptor.first, packet, packetSize);
-		packetDescriptor.second = packetSize;
-		sequenceMap.insert(pair<seq_t, pair<uint8_t*, uint16_t>>(
-				ltpHeaderData.sequenceNumber, packetDescriptor));
-		sessionKeyMap.insert(pair<sk_t, map<seq_t, pair<uint8_t *, uint16_t>>>
-				(ltpHeaderData.sessionKey, sequenceMap));
-		_proxyPacketBufferIt->second.insert(pair<enigma_t, map<sk_t, map<seq_t,
-				pair<uint8_t *, uint16_t>>>>(ltpHeaderData.enigma,
-						sessionKeyMap));
-		LOG4CXX_TRACE(logger, "Proxy packet buffered of length " << packetSize
-				<< " and CID " << cId.print() << " ("	<< cId.printFqdn()
-				<< ") for existing rCID " << rCId.print()
-				<< " but new enigma " << ltpHeaderData.enigma << " > SK "
-				<< ltpHeaderData.sessionKey << " > SN "
-				<< ltpHeaderData.sequenceNumber);
 		_proxyPacketBufferMutex.unlock();
-		return;
-	}
-
-	// enigma exists
-	map<sk_t, map<seq_t, pair<uint8_t *, uint16_t>>>::iterator skIt;
-	skIt = enigmaIt->second.find(ltpHeaderData.sessionKey);
-
-	// SK does not exist
-	if (skIt == enigmaIt->second.end())
-	{
-		map<seq_t, pair<uint8_t *, uint16_t>> sequenceMap;
-		packetDescriptor.first = (uint8_t *)malloc(packetSize);
-		memcpy(packetDescriptor.first, packet, packetSize);
-		packetDescriptor.second = packetSize;
-		sequenceMap.insert(pair<seq_t, pair<uint8_t*, uint16_t>>(
-				ltpHeaderData.sequenceNumber, packetDescriptor));
-		enigmaIt->second.insert(pair<sk_t, map<uint16_t, pair<uint8_t *,
-				uint16_t>>>(ltpHeaderData.sessionKey, sequenceMap));
-		LOG4CXX_TRACE(logger, "Proxy packet buffer of length " << packetSize
-				<< " and CID " << cId.print() << " ("	<< cId.printFqdn()
-				<< ") for existing rCID " << rCId.print()
-				<< " > enigma " << ltpHeaderData.enigma << " but new SK "
+		LOG4CXX_WARN(logger, "Proxy packet of length " << fragmentSize
+				<< " could not be buffered for rCID " << rCId.print()
+				<< " > enigma " << ltpHeaderData.enigma << " > SK "
 				<< ltpHeaderData.sessionKey << " > SN "
 				<< ltpHeaderData.sequenceNumber);
-		_proxyPacketBufferMutex.unlock();
-		return;
-	}
-
-	// SK exists
-	map<seq_t, pair<uint8_t *,	uint16_t>>::iterator snIt;
-	snIt = skIt->second.find(ltpHeaderData.sequenceNumber);
-
-	// Sequence also exists. Update it (DNSlocal scenario)
-	if (snIt != skIt->second.end())
-	{
-		LOG4CXX_TRACE(logger, "Sequence " << ltpHeaderData.sequenceNumber
-				<< " already exists in proxy packet buffer for rCID "
-				<< rCId.print() << " > enigma " << ltpHeaderData.enigma
-				<< " > SK "	<< ltpHeaderData.sessionKey << ". Overwriting it");
-
-		if (snIt->second.second != packetSize)
-		{
-			snIt->second.first = (uint8_t *)realloc(snIt->second.first,
-					packetSize);
-			// reallocation of memory failed
-			if (snIt->second.first == NULL)
-			{
-				LOG4CXX_WARN(logger, "Memory could not be reallocated in LTP "
-						"proxy packet buffer for rCID " << rCId.print() << " > "
-						"enigma " << ltpHeaderData.enigma << " > SK "
-						<< ltpHeaderData.sessionKey);
-				_proxyPacketBufferMutex.unlock();
-				return;
-			}
-		}
-
-		memcpy(snIt->second.first, packet, packetSize);
-		snIt->second.second = packetSize;
-		_proxyPacketBufferMutex.unlock();
 		return;
 	}
 
-	packetDescriptor.first = (uint8_t *)malloc(packetSize);
-	memcpy(packetDescriptor.first, packet, packetSize);
-	packetDescriptor.second = packetSize;
-	skIt->second.insert(pair<uint16_t, pair<uint8_t *, uint16_t>>(
-			ltpHeaderData.sequenceNumber, packetDescriptor));
+	_proxyPacketBufferMutex.unlock();
 	LOG4CXX_TRACE(logger, "proxy packet bufferd with SN "
-			<< ltpHeaderData.sequenceNumber << ", length " << packetSize
+			<< ltpHeaderData.sequenceNumber << ", length " << fragmentSize
 			<< " and CID " << cId.print() << " (" << cId.printFqdn()
-			<< ") added to LTP proxy packet buffer for existing rCID "
+			<< ") added to LTP proxy packet buffer for rCID "
 			<< rCId.print() << " > enigma " << ltpHeaderData.enigma
 			<< " > SK " << ltpHeaderData.sessionKey);
-	_proxyPacketBufferMutex.unlock();
 }
 
 bool Lightweight::_cmcGroupEmpty(IcnId &rCid, enigma_t &enigma,
@@ -1729,86 +1444,31 @@ bool Lightweight::_cmcGroupEmpty(IcnId &rCid, enigma_t &enigma,
 void Lightweight::_deleteLtpBufferEntry(IcnId &rCid, enigma_t &enigma,
 			sk_t &sessionKey)
 {
-	map<enigma_t, map<sk_t, map<seq_t, packet_t>>>::iterator enigmaIt;
-	map<sk_t, map<seq_t, packet_t>>::iterator skIt;
-	ltp_packet_buffer_t::iterator ltpPacketBufferIt;
 	_ltpPacketBufferMutex.lock();
-	ltpPacketBufferIt = _ltpPacketBuffer.find(rCid.uint());
-
-	// rCID not found
-	if (ltpPacketBufferIt == _ltpPacketBuffer.end())
-	{
-		_ltpPacketBufferMutex.unlock();
-		return;
-	}
-
-	enigmaIt = ltpPacketBufferIt->second.find(enigma);
-
-	// enigma not found
-	if (!enigmaIt->second.empty())
-	{
-		_ltpPacketBufferMutex.unlock();
-		return;
-	}
-
-	skIt = enigmaIt->second.find(sessionKey);
-
-	// SK not found
-	if (skIt == enigmaIt->second.end())
-	{
-		_ltpPacketBufferMutex.unlock();
-		return;
-	}
-
-	// SK values list not empty
-	if (!skIt->second.empty())
-	{
-		skIt->second.clear();
-		LOG4CXX_TRACE(logger, "Cleared entire LTP packet buffer for rCID "
-				<< rCid.print() << " > enigma " << enigma << " > SK "
-				<< sessionKey);
-	}
 
-	// deleting SK
-	enigmaIt->second.erase(skIt);
-	LOG4CXX_DEBUG(logger, "SK " << sessionKey << " deleted as key from LTP "
-			"packet buffer");
-
-	// enigma still has more SKs
-	if (!enigmaIt->second.empty())
-	{
-		_ltpPacketBufferMutex.unlock();
-		return;
-	}
-
-	ltpPacketBufferIt->second.erase(enigmaIt);
-	LOG4CXX_TRACE(logger, "enigma " << enigma << " deleted as key from LTP "
-			"packet buffer");
-	// rCID hase more enigmas
-	if (!ltpPacketBufferIt->second.empty())
+	if (_ltpPacketBuffer.erase(rCid.uint(), enigma, sessionKey))
 	{
-		_ltpPacketBufferMutex.unlock();
-		return;
+		LOG4CXX_DEBUG(logger, "rCID " << rCid.print() << " > enigma "
+				<< enigma << " > SK " << sessionKey << " deleted from LTP "
+				"packet buffer");
 	}
 
-	_ltpPacketBuffer.erase(ltpPacketBufferIt);
-	LOG4CXX_DEBUG(logger, "rCID " << rCid.print() << " deleted as map key from "
-			"LTP packet buffer");
 	_ltpPacketBufferMutex.unlock();
 }
 
 void Lightweight::_deleteBufferedIcnPacket(IcnId &rCid, enigma_t &enigma,
 		NodeId &nid, sk_t &sk)
 {
+	icn_packet_buffer_t::iterator icnPacketBufferIt;
 	map<enigma_t, map<nid_t, map<sk_t, map<seq_t, pair<uint8_t*,
 			uint16_t>>>>>::iterator enigmaIt;
 	map<nid_t, map<sk_t, map<seq_t, pair<uint8_t*, uint16_t>>>>::iterator nidIt;
 	map<sk_t, map<seq_t, pair<uint8_t*, uint16_t>>>::iterator skIt;
 	map<seq_t, pair<uint8_t*, uint16_t>>::iterator seqIt;
 	_icnPacketBufferMutex.lock();
-	_icnPacketBufferIt = _icnPacketBuffer.find(rCid.uint());
+	icnPacketBufferIt = _icnPacketBuffer.find(rCid.uint());
 
-	if (_icnPacketBufferIt == _icnPacketBuffer.end())
+	if (icnPacketBufferIt == _icnPacketBuffer.end())
 	{
 		_icnPacketBufferMutex.unlock();
 		LOG4CXX_TRACE(logger, "ICN packet could not be deleted from buffer. "
@@ -1816,9 +1476,9 @@ void Lightweight::_deleteBufferedIcnPacket(IcnId &rCid, enigma_t &enigma,
 		return;
 	}
 
-	enigmaIt = _icnPacketBufferIt->second.find(enigma);
+	enigmaIt = icnPacketBufferIt->second.find(enigma);
 
-	if (enigmaIt == _icnPacketBufferIt->second.end())
+	if (enigmaIt == icnPacketBufferIt->second.end())
 	{
 		_icnPacketBufferMutex.unlock();
 		LOG4CXX_TRACE(logger, "ICN packet could not be deleted from buffer. "
@@ -1880,18 +1540,18 @@ void Lightweight::_deleteBufferedIcnPacket(IcnId &rCid, enigma_t &enigma,
 		return;
 	}
 
-	_icnPacketBufferIt->second.erase(enigmaIt);
+	icnPacketBufferIt->second.erase(enigmaIt);
 	LOG4CXX_TRACE(logger, "No other NID in ICN buffer map for rCID "
 				<< rCid.print() << " > enigma " << enigma << ". Deleted enigma ");
 
 	// more enigmas stored for rCID
-	if (!_icnPacketBufferIt->second.empty())
+	if (!icnPacketBufferIt->second.empty())
 	{
 		_icnPacketBufferMutex.unlock();
 		return;
 	}
 
-	_icnPacketBuffer.erase(_icnPacketBufferIt);
+	_icnPacketBuffer.erase(icnPacketBufferIt);
 	LOG4CXX_TRACE(logger, "No other enigma in ICN buffer map for rCID "
 					<< rCid.print() << ". Deleted rCID ");
 	_icnPacketBufferMutex.unlock();
@@ -1900,33 +1560,9 @@ void Lightweight::_deleteBufferedIcnPacket(IcnId &rCid, enigma_t &enigma,
 void Lightweight::_deleteBufferedLtpPacket(IcnId &rCid, enigma_t &enigma,
 			sk_t &sessionKey)
 {
-	map<cid_t, map<enigma_t, map<sk_t, map<seq_t, packet_t>>>>::iterator rCidIt;
 	_ltpPacketBufferMutex.lock();
-	rCidIt = _ltpPacketBuffer.find(rCid.uint());
-
-	if (rCidIt == _ltpPacketBuffer.end())
-	{
-		LOG4CXX_TRACE(logger, "rCID " << rCid.print() << " not found in LTP "
-				"buffer");
-		_ltpPacketBufferMutex.unlock();
-		return;
-	}
-
-	map<enigma_t, map<sk_t, map<seq_t, packet_t>>>::iterator enigmaIt;
-	enigmaIt = rCidIt->second.find(enigma);
-
-	if (enigmaIt == rCidIt->second.end())
-	{
-		LOG4CXX_TRACE(logger, "rCID " << rCid.print() << " > enigma "
-				<< enigma << " not found in LTP buffer");
-		_ltpPacketBufferMutex.unlock();
-		return;
-	}
-
-	map<sk_t, map<seq_t, packet_t>>::iterator skIt;
-	skIt = enigmaIt->second.find(sessionKey);
 
-	if (skIt == enigmaIt->second.end())
+	if (_ltpPacketBuffer.find(rCid.uint(), enigma, sessionKey) == NULL)
 	{
 		LOG4CXX_TRACE(logger, "rCID " << rCid.print() << " > enigma "
 				<< enigma << " > SK " << sessionKey << " not found in LTP "
@@ -1935,16 +1571,8 @@ void Lightweight::_deleteBufferedLtpPacket(IcnId &rCid, enigma_t &enigma,
 		return;
 	}
 
-	// free up all allocated memory
-	map<seq_t, packet_t>::iterator seqIt;
-
-	for (seqIt = skIt->second.begin(); seqIt != skIt->second.end(); seqIt++)
-	{
-		free(seqIt->second.packet);
-
-	}
-
-	skIt->second.clear();
+	// the session keeps its ring for the next window
+	_ltpPacketBuffer.clear(rCid.uint(), enigma, sessionKey);
 	LOG4CXX_TRACE(logger, "Packet(s) deleted from LTP packet buffer for rCID "
 			<< rCid.print() << " > enigma " << enigma << " > SK "
 			<< sessionKey);
@@ -1954,10 +1582,11 @@ void Lightweight::_deleteBufferedLtpPacket(IcnId &rCid, enigma_t &enigma,
 void Lightweight::_deleteNackGroup(IcnId &rCid,
 		ltp_hdr_ctrl_nack_t &ltpHeaderNack)
 {
-	_nackGroupsIt = _nackGroups.find(rCid.uint());
+	nack_groups_t::iterator nackGroupsIt;
+	nackGroupsIt = _nackGroups.find(rCid.uint());
 
 	// rCID not found
-	if (_nackGroupsIt == _nackGroups.end())
+	if (nackGroupsIt == _nackGroups.end())
 	{
 		LOG4CXX_DEBUG(logger, "No NACK group does exist for rCID "
 				<< rCid.print());
@@ -1965,10 +1594,10 @@ void Lightweight::_deleteNackGroup(IcnId &rCid,
 	}
 
 	map<enigma_t, map<sk_t, nack_group_t>>::iterator enigmaIt;
-	enigmaIt = _nackGroupsIt->second.find(ltpHeaderNack.enigma);
+	enigmaIt = nackGroupsIt->second.find(ltpHeaderNack.enigma);
 
 	// enigma not found
-	if (enigmaIt == _nackGroupsIt->second.end())
+	if (enigmaIt == nackGroupsIt->second.end())
 	{
 		LOG4CXX_DEBUG(logger, "No NACK group does exist for rCID "
 				<< rCid.print() << " > enigma " << ltpHeaderNack.enigma);
@@ -1994,12 +1623,12 @@ void Lightweight::_deleteNackGroup(IcnId &rCid,
 
 	if (enigmaIt->second.empty())
 	{
-		_nackGroupsIt->second.erase(enigmaIt);
+		nackGroupsIt->second.erase(enigmaIt);
 		LOG4CXX_TRACE(logger, "This was the last SK for rCID " << rCid.print()
 				<< " > enigma " << ltpHeaderNack.enigma << ". enigma deleted");
-		if (_nackGroupsIt->second.empty())
+		if (nackGroupsIt->second.empty())
 		{
-			_nackGroups.erase(_nackGroupsIt);
+			_nackGroups.erase(nackGroupsIt);
 			LOG4CXX_TRACE(logger, "This was the last enigma for rCID "
 					<< rCid.print() << ". rCID deleted");
 		}
@@ -2009,54 +1638,18 @@ void Lightweight::_deleteNackGroup(IcnId &rCid,
 void Lightweight::_deleteProxyPacket(IcnId &rCId, enigma_t enigma,
 		sk_t sessionKey)
 {
-	map<seq_t, pair<uint8_t *, uint16_t>>::iterator sequenceMapIt;
-	map<sk_t, map<seq_t, pair<uint8_t *, uint16_t>>>::iterator sessionKeyMapIt;
-	map<enigma_t, map<sk_t, map<seq_t, pair<uint8_t *, uint16_t>>>>::iterator
-			enigmaMapIt;
 	_proxyPacketBufferMutex.lock();
-	_proxyPacketBufferIt = _proxyPacketBuffer.find(rCId.uint());
-
-	// rCID does not exist
-	if (_proxyPacketBufferIt == _proxyPacketBuffer.end())
-	{
-		LOG4CXX_TRACE(logger, "rCID " << rCId.print() << " cannot be found "
-				"in proxy packet buffer map anymore");
-		_proxyPacketBufferMutex.unlock();
-		return;
-	}
-
-	enigmaMapIt = _proxyPacketBufferIt->second.find(enigma);
-
-	// enigma does not exist
-	if (enigmaMapIt == _proxyPacketBufferIt->second.end())
-	{
-		LOG4CXX_TRACE(logger, "enigma " << enigma << " could "
-				"not be found in proxy packet buffer map anymore for rCID "
-				<< rCId.print());
-		_proxyPacketBufferMutex.unlock();
-		return;
-	}
 
-	sessionKeyMapIt = enigmaMapIt->second.find(sessionKey);
-
-	// SK does not exist
-	if (sessionKeyMapIt == enigmaMapIt->second.end())
+	// rCID > enigma > SK does not exist
+	if (!_proxyPacketBuffer.erase(rCId.uint(), enigma, sessionKey))
 	{
-		LOG4CXX_TRACE(logger, "SK " << sessionKey << " could"
-				" not be found in proxy packet buffer map anymore for rCID "
-				<< rCId.print() << " > enigma " << enigma);
+		LOG4CXX_TRACE(logger, "rCID " << rCId.print() << " > enigma "
+				<< enigma << " > SK " << sessionKey << " cannot be found in "
+				"proxy packet buffer anymore");
 		_proxyPacketBufferMutex.unlock();
 		return;
 	}
 
-	// deleting packet
-	for (sequenceMapIt = sessionKeyMapIt->second.begin();
-			sequenceMapIt != sessionKeyMapIt->second.end(); sequenceMapIt++)
-	{
-		free(sequenceMapIt->second.first);
-	}
-
-	enigmaMapIt->second.erase(sessionKeyMapIt);
 	_proxyPacketBufferMutex.unlock();
 	LOG4CXX_TRACE(logger, "Packet deleted from proxy packet buffer for rCID "
 			<< rCId.print() << " > enigma " << enigma << " > SK "
@@ -2108,15 +1701,16 @@ void Lightweight::_deleteSessionEnd(IcnId &rCid, sk_t &sessionKey)
 void Lightweight::_deleteSessionEnd(IcnId &rCid,
 		ltp_hdr_ctrl_se_t &ltpHdrCtrlSe, list<NodeId> &nodeIds)
 {
+	session_ended_responses_t::iterator sessionEndedResponsesIt;
 	unordered_map<sk_t, bool>::iterator skIt;
 	unordered_map<nid_t, unordered_map<sk_t, bool>>::iterator nidIt;
 	unordered_map<enigma_t, unordered_map<nid_t, unordered_map<sk_t,
 			bool>>>::iterator enigmaIt;
 	_sessionEndedResponsesMutex.lock();
-	_sessionEndedResponsesIt = _sessionEndedResponses.find(rCid.uint());
+	sessionEndedResponsesIt = _sessionEndedResponses.find(rCid.uint());
 
 	// rCID does not exist
-	if (_sessionEndedResponsesIt == _sessionEndedResponses.end())
+	if (sessionEndedResponsesIt == _sessionEndedResponses.end())
 	{
 		LOG4CXX_DEBUG(logger, "rCID " << rCid.print() << " does not exist in "
 				"SED responses map");
@@ -2124,10 +1718,10 @@ void Lightweight::_deleteSessionEnd(IcnId &rCid,
 		return;
 	}
 
-	enigmaIt = _sessionEndedResponsesIt->second.find(ltpHdrCtrlSe.enigma);
+	enigmaIt = sessionEndedResponsesIt->second.find(ltpHdrCtrlSe.enigma);
 
 	// enigma does not exist
-	if (enigmaIt == _sessionEndedResponsesIt->second.end())
+	if (enigmaIt == sessionEndedResponsesIt->second.end())
 	{
 		LOG4CXX_DEBUG(logger, "rCID " << rCid.print() << " > enigma "
 				<< ltpHdrCtrlSe.enigma << " does not exist in SED"
@@ -2176,57 +1770,176 @@ void Lightweight::_deleteSessionEnd(IcnId &rCid,
 	{
 		LOG4CXX_TRACE(logger, "enigma " << ltpHdrCtrlSe.enigma << " deleted "
 				"for rCID " << rCid.print() << " from CTRL-SED responses map");
-		_sessionEndedResponsesIt->second.erase(enigmaIt);
+		sessionEndedResponsesIt->second.erase(enigmaIt);
 	}
 
 	// No enigmas left
-	if (_sessionEndedResponsesIt->second.empty())
+	if (sessionEndedResponsesIt->second.empty())
 	{
 		LOG4CXX_TRACE(logger, "rCID " << rCid.print() << " deleted from "
 				"CTRL-SED responses map");
-		_sessionEndedResponses.erase(_sessionEndedResponsesIt);
+		_sessionEndedResponses.erase(sessionEndedResponsesIt);
 	}
 
 	_sessionEndedResponsesMutex.unlock();
 }
 
-void Lightweight::_enableNIdInCmcGroup(IcnId &rCId, enigma_t &enigma,
-			NodeId &nodeId)
+uint8_t Lightweight::_deserialiseDataHeader(uint8_t *packet,
+		ltp_hdr_data_t &ltpHeaderData)
 {
-	_potentialCmcGroupsMutex->lock();
-	_potentialCmcGroupsIt = _potentialCmcGroups->find(rCId.uint());
-	if (_potentialCmcGroupsIt == _potentialCmcGroups->end())
+	uint8_t offset = 0;
+	// [1] Message type
+	memcpy(&ltpHeaderData.messageType, packet,
+			sizeof(ltpHeaderData.messageType));
+	offset += sizeof(ltpHeaderData.messageType);
+	// [2] enigma
+	memcpy(&ltpHeaderData.enigma, packet + offset,
+			sizeof(ltpHeaderData.enigma));
+	offset += sizeof(ltpHeaderData.enigma);
+	// [3] Session key
+	memcpy(&ltpHeaderData.sessionKey, packet + offset,
+			sizeof(ltpHeaderData.sessionKey));
+	offset += sizeof(ltpHeaderData.sessionKey);
+
+	// [4] Sequence num (32 bit in v2)
+	if (ltpHeaderData.messageType == LTP_DATA_V2)
 	{
-		LOG4CXX_TRACE(logger, "rCID " << rCId.print() << " could not be found "
-				"in potential CMC group map");
-		_potentialCmcGroupsMutex->unlock();
-		return;
+		memcpy(&ltpHeaderData.sequenceNumber, packet + offset,
+				sizeof(ltpHeaderData.sequenceNumber));
+		offset += sizeof(ltpHeaderData.sequenceNumber);
 	}
-	map<enigma_t, map<nid_t, bool>>::iterator enigmaMapIt;
-	enigmaMapIt = _potentialCmcGroupsIt->second.find(enigma);
-
-	if (enigmaMapIt == _potentialCmcGroupsIt->second.end())
+	else
 	{
-		LOG4CXX_TRACE(logger, "enigma " << enigma << " could not be found "
-				"for rCID " << rCId.print() << " in potential CMC group map");
-		_potentialCmcGroupsMutex->unlock();
-		return;
+		uint16_t sequenceNumber;
+		memcpy(&sequenceNumber, packet + offset, sizeof(sequenceNumber));
+		offset += sizeof(sequenceNumber);
+		ltpHeaderData.sequenceNumber = sequenceNumber;
 	}
 
-	map<nid_t, bool>::iterator nodeIdMapIt;
-	nodeIdMapIt = enigmaMapIt->second.find(nodeId.uint());
+	// [5] Payload length
+	memcpy(&ltpHeaderData.payloadLength, packet + offset,
+			sizeof(ltpHeaderData.payloadLength));
+	offset += sizeof(ltpHeaderData.payloadLength);
+	return offset;
+}
 
-	if (nodeIdMapIt == enigmaMapIt->second.end())
+bool Lightweight::_deserialiseNegativeAcknowledgement(
+		ltp_ctrl_control_types_t controlType, uint8_t *packet, uint16_t length,
+		ltp_hdr_ctrl_nack_t &ltpHeaderNack, ltp_sequences_t &sequences)
+{
+	uint16_t offset = 0;
+
+	// enigma, SK and the two 16-bit sequence numbers of a CTRL-NACK
+	if (length < (sizeof(ltpHeaderNack.enigma)
+			+ sizeof(ltpHeaderNack.sessionKey) + 2 * sizeof(uint16_t)))
 	{
-		LOG4CXX_TRACE(logger, "NID " << nodeId.uint() << " could not be found "
-				" for enigma " << enigma << " and " << " rCID "
-				<< rCId.print() << " in potential CMC group map");
-		_potentialCmcGroupsMutex->unlock();
-		return;
+		return false;
 	}
 
-	nodeIdMapIt->second = true;
-	LOG4CXX_DEBUG(logger, "NID " << nodeId.uint() << " enabled in potential CMC"
+	// [3] enigma
+	memcpy(&ltpHeaderNack.enigma, packet, sizeof(ltpHeaderNack.enigma));
+	offset += sizeof(ltpHeaderNack.enigma);
+	// [4] SK
+	memcpy(&ltpHeaderNack.sessionKey, packet + offset,
+			sizeof(ltpHeaderNack.sessionKey));
+	offset += sizeof(ltpHeaderNack.sessionKey);
+
+	// CTRL-NACK: [5] start [6] end (16 bit each)
+	if (controlType == LTP_CONTROL_NACK)
+	{
+		uint16_t start;
+		uint16_t end;
+		memcpy(&start, packet + offset, sizeof(start));
+		offset += sizeof(start);
+		memcpy(&end, packet + offset, sizeof(end));
+		ltpHeaderNack.start = start;
+		ltpHeaderNack.end = end;
+
+		for (uint32_t sequence = start; sequence <= end; sequence++)
+		{
+			sequences.insert(sequences.end(), sequence);
+		}
+
+		return !sequences.empty();
+	}
+
+	// CTRL-SACK: [5] start [6] bitmap length [7] bitmap
+	ltp_hdr_ctrl_sack_t ltpHeaderSack;
+
+	if (length < (LTP_CTRL_SACK_LENGTH - sizeof(ltpHeaderSack.messageType)
+			- sizeof(ltpHeaderSack.controlType)))
+	{
+		return false;
+	}
+
+	memcpy(&ltpHeaderSack.start, packet + offset, sizeof(ltpHeaderSack.start));
+	offset += sizeof(ltpHeaderSack.start);
+	memcpy(&ltpHeaderSack.bitmapLength, packet + offset,
+			sizeof(ltpHeaderSack.bitmapLength));
+	offset += sizeof(ltpHeaderSack.bitmapLength);
+
+	if (ltpHeaderSack.bitmapLength > LTP_SACK_MAX_BITMAP
+			|| ltpHeaderSack.bitmapLength > (length - offset))
+	{
+		return false;
+	}
+
+	for (uint16_t i = 0; i < ltpHeaderSack.bitmapLength * 8; i++)
+	{
+		if (packet[offset + i / 8] & (1 << (i % 8)))
+		{
+			sequences.insert(sequences.end(), ltpHeaderSack.start + i);
+		}
+	}
+
+	ltpHeaderNack.start = ltpHeaderSack.start;
+	ltpHeaderNack.end = ltpHeaderSack.start;
+
+	if (!sequences.empty())
+	{
+		ltpHeaderNack.end = *sequences.rbegin();
+	}
+
+	return !sequences.empty();
+}
+
+void Lightweight::_enableNIdInCmcGroup(IcnId &rCId, enigma_t &enigma,
+			NodeId &nodeId)
+{
+	_potentialCmcGroupsMutex->lock();
+	_potentialCmcGroupsIt = _potentialCmcGroups->find(rCId.uint());
+	if (_potentialCmcGroupsIt == _potentialCmcGroups->end())
+	{
+		LOG4CXX_TRACE(logger, "rCID " << rCId.print() << " could not be found "
+				"in potential CMC group map");
+		_potentialCmcGroupsMutex->unlock();
+		return;
+	}
+	map<enigma_t, map<nid_t, bool>>::iterator enigmaMapIt;
+	enigmaMapIt = _potentialCmcGroupsIt->second.find(enigma);
+
+	if (enigmaMapIt == _potentialCmcGroupsIt->second.end())
+	{
+		LOG4CXX_TRACE(logger, "enigma " << enigma << " could not be found "
+				"for rCID " << rCId.print() << " in potential CMC group map");
+		_potentialCmcGroupsMutex->unlock();
+		return;
+	}
+
+	map<nid_t, bool>::iterator nodeIdMapIt;
+	nodeIdMapIt = enigmaMapIt->second.find(nodeId.uint());
+
+	if (nodeIdMapIt == enigmaMapIt->second.end())
+	{
+		LOG4CXX_TRACE(logger, "NID " << nodeId.uint() << " could not be found "
+				" for enigma " << enigma << " and " << " rCID "
+				<< rCId.print() << " in potential CMC group map");
+		_potentialCmcGroupsMutex->unlock();
+		return;
+	}
+
+	nodeIdMapIt->second = true;
+	LOG4CXX_DEBUG(logger, "NID " << nodeId.uint() << " enabled in potential CMC"
 			" group rCID " << rCId.print() << " > enigma " << enigma);
 	_potentialCmcGroupsMutex->unlock();
 }
@@ -2334,7 +2047,7 @@ bool Lightweight::_getCmcGroup(IcnId &rCid, enigma_t &enigma,
 }
 
 tp_states_t Lightweight::_handleControl(IcnId &rCId, uint8_t *packet,
-		enigma_t &enigma, sk_t &sessionKey)
+		uint16_t packetSize, enigma_t &enigma, sk_t &sessionKey)
 {// LTP CTRL from sNAPs
 	ltp_hdr_ctrl_t ltpHeaderCtrl;
 	// [1] message type
@@ -2347,27 +2060,27 @@ tp_states_t Lightweight::_handleControl(IcnId &rCId, uint8_t *packet,
 	switch (ltpHeaderCtrl.controlType)
 	{
 	case LTP_CONTROL_NACK:
+	case LTP_CONTROL_SACK:
 	{// HTTP request wasn't fully received by sNAP
 		ltp_hdr_ctrl_nack_t ltpHeaderNack;
-		// [3] enigma
-		memcpy(&ltpHeaderNack.enigma, packet,
-				sizeof(ltpHeaderNack.enigma));
-		packet += sizeof(ltpHeaderNack.enigma);
-		// [4] SK
-		memcpy(&ltpHeaderNack.sessionKey, packet,
-				sizeof(ltpHeaderNack.sessionKey));
-		packet += sizeof(ltpHeaderNack.sessionKey);
-		// [5] Start
-		memcpy(&ltpHeaderNack.start, packet,
-				sizeof(ltpHeaderNack.start));
-		packet += sizeof(ltpHeaderNack.start);
-		// [6] End
-		memcpy(&ltpHeaderNack.end, packet, sizeof(ltpHeaderNack.end));
-		LOG4CXX_TRACE(logger, "CTRL-NACK for Segments " << ltpHeaderNack.start
-				<< " - " << ltpHeaderNack.end << " received under rCID "
+		ltp_sequences_t sequences;
+
+		if (!_deserialiseNegativeAcknowledgement(ltpHeaderCtrl.controlType,
+				packet, packetSize - sizeof(ltpHeaderCtrl.messageType)
+				- sizeof(ltpHeaderCtrl.controlType), ltpHeaderNack, sequences))
+		{
+			LOG4CXX_DEBUG(logger, "Malformed CTRL-NACK received under rCID "
+					<< rCId.print());
+			break;
+		}
+
+		LOG4CXX_TRACE(logger, "CTRL-NACK for " << sequences.size()
+				<< " segments (" << *sequences.begin() << " - "
+				<< *sequences.rbegin() << ") received under rCID "
 				<< rCId.print() << " > enigma " << ltpHeaderNack.enigma
 				<< " > SK " << ltpHeaderNack.sessionKey);
-		_publishDataRange(rCId, ltpHeaderNack);
+		_publishDataRange(rCId, ltpHeaderNack, sequences,
+				(ltpHeaderCtrl.controlType == LTP_CONTROL_SACK) ? 2 : 1);
 		break;
 	}
 	case LTP_CONTROL_RESETTED:
@@ -2494,7 +2207,6 @@ tp_states_t Lightweight::_handleControl(IcnId &rCId, uint8_t *packet,
 	case LTP_CONTROL_WINDOW_END:
 	{
 		ltp_hdr_ctrl_we_t ltpHeaderCtrlWe;
-		map<seq_t, pair<uint8_t*, uint16_t>>::iterator sequenceMapIt;
 		map<sk_t, map<seq_t, pair<uint8_t*, uint16_t>>>::iterator
 				sessionKeyMapIt;
 		map<nid_t, map<sk_t, map<seq_t, pair<uint8_t*, uint16_t>>>>::iterator
@@ -2510,20 +2222,36 @@ tp_states_t Lightweight::_handleControl(IcnId &rCId, uint8_t *packet,
 				sizeof(ltpHeaderCtrlWe.sessionKey));
 		packet += sizeof(ltpHeaderCtrlWe.sessionKey);
 		// [5] Sequence number
-		memcpy(&ltpHeaderCtrlWe.sequenceNumber, packet,
-				sizeof(ltpHeaderCtrlWe.sequenceNumber));
-		LOG4CXX_TRACE(logger, "LTP CTRL-WE received for rCID " << rCId.print()
+		uint16_t sequenceNumber;
+		memcpy(&sequenceNumber, packet, sizeof(sequenceNumber));
+		packet += sizeof(sequenceNumber);
+		ltpHeaderCtrlWe.sequenceNumber = sequenceNumber;
+
+		// [6] v2: version and 32-bit sequence number
+		if (packetSize >= LTP_CTRL_WE_LENGTH + sizeof(ltpHeaderCtrlWe.version)
+				+ sizeof(ltpHeaderCtrlWe.sequenceNumber))
+		{
+			memcpy(&ltpHeaderCtrlWe.version, packet,
+					sizeof(ltpHeaderCtrlWe.version));
+			packet += sizeof(ltpHeaderCtrlWe.version);
+			memcpy(&ltpHeaderCtrlWe.sequenceNumber, packet,
+					sizeof(ltpHeaderCtrlWe.sequenceNumber));
+		}
+
+		LOG4CXX_TRACE(logger, "LTP CTRL-WE (v" << (int)ltpHeaderCtrlWe.version
+				<< ") received for rCID " << rCId.print()
 				<< " > enigma " << ltpHeaderCtrlWe.enigma << " > Session "
 				"key " << ltpHeaderCtrlWe.sessionKey << " > Seq "
 				<< ltpHeaderCtrlWe.sequenceNumber);
 		/* Check in ICN packet buffer that all sequences starting from one up to
 		 * the one received here have been received
 		 */
+		icn_packet_buffer_t::iterator icnPacketBufferIt;
 		_icnPacketBufferMutex.lock();
 		// Find rCID
-		_icnPacketBufferIt = _icnPacketBuffer.find(rCId.uint());
+		icnPacketBufferIt = _icnPacketBuffer.find(rCId.uint());
 
-		if (_icnPacketBufferIt == _icnPacketBuffer.end())
+		if (icnPacketBufferIt == _icnPacketBuffer.end())
 		{
 			LOG4CXX_DEBUG(logger, "rCID " << rCId.print() << " unknown. "
 					"Cannot check if CTRL-WED should be sent");
@@ -2532,10 +2260,10 @@ tp_states_t Lightweight::_handleControl(IcnId &rCId, uint8_t *packet,
 		}
 
 		// Find enigma
-		enigmaMapIt = _icnPacketBufferIt->second.find(
+		enigmaMapIt = icnPacketBufferIt->second.find(
 				ltpHeaderCtrlWe.enigma);
 
-		if (enigmaMapIt == _icnPacketBufferIt->second.end())
+		if (enigmaMapIt == icnPacketBufferIt->second.end())
 		{
 			LOG4CXX_DEBUG(logger, "enigma " << ltpHeaderCtrlWe.enigma
 					<< " unknown. Cannot check if CTRL-WED should be sent");
@@ -2588,56 +2316,9 @@ tp_states_t Lightweight::_handleControl(IcnId &rCId, uint8_t *packet,
 		}
 
 		// Check that consecutive sequence numbers exist
-		bool allFragmentsReceived = true;
-		seq_t firstMissingSequence = 0;
-		seq_t lastMissingSequence = 0;
-		seq_t previousSequence = 0;
-
-		for (sequenceMapIt = sessionKeyMapIt->second.begin();
-				sequenceMapIt != sessionKeyMapIt->second.end(); sequenceMapIt++)
-		{
-			// First fragment is missing
-			if (previousSequence == 0 && sequenceMapIt->first != 1)
-			{
-				firstMissingSequence = 1;
-				lastMissingSequence = 1;
-				allFragmentsReceived = false;
-			}
-			// Not first, but any other sequence is missing
-			else if ((previousSequence + 1) < sequenceMapIt->first)
-			{
-				if (firstMissingSequence == 0)
-				{
-					firstMissingSequence = previousSequence + 1;
-				}
-
-				lastMissingSequence = sequenceMapIt->first - 1;
-				allFragmentsReceived = false;
-			}
-
-			previousSequence = sequenceMapIt->first;
-
-		}
-
-		// check if sequence indicated in CTRL-WE was actually received
-		map<seq_t, pair<uint8_t*, uint16_t>>::reverse_iterator sequenceMapRIt;
-		sequenceMapRIt = sessionKeyMapIt->second.rbegin();
-
-		if (sequenceMapRIt->first < ltpHeaderCtrlWe.sequenceNumber)
-		{
-			if (firstMissingSequence == 0)
-			{
-				firstMissingSequence = ltpHeaderCtrlWe.sequenceNumber;
-				LOG4CXX_TRACE(logger, "First missing sequence changed to "
-						<< firstMissingSequence);
-			}
-
-			lastMissingSequence = ltpHeaderCtrlWe.sequenceNumber;
-			LOG4CXX_TRACE(logger, "Last missing sequence changed to "
-					<< ltpHeaderCtrlWe.sequenceNumber);
-			allFragmentsReceived = false;
-		}
-
+		ltp_sequences_t missingSequences;
+		bool allFragmentsReceived = _missingSequences(sessionKeyMapIt->second,
+				ltpHeaderCtrlWe.sequenceNumber, missingSequences);
 		_icnPacketBufferMutex.unlock();
 		IcnId cid;
 		_cIdReverseLookUpMutex.lock();
@@ -2653,6 +2334,7 @@ tp_states_t Lightweight::_handleControl(IcnId &rCId, uint8_t *packet,
 
 		cid = _cIdReverseLookUpIt->second;
 		_cIdReverseLookUpMutex.unlock();
+		_ltpVersion(cid, ltpHeaderCtrlWe.version);
 
 		if (allFragmentsReceived)
 		{
@@ -2667,14 +2349,15 @@ tp_states_t Lightweight::_handleControl(IcnId &rCId, uint8_t *packet,
 		// Sequence was missing. Send off NACK message
 		else
 		{
-			LOG4CXX_TRACE(logger, "Missing packets for rCID " << rCId.print()
-					<< " > enigma " << ltpHeaderCtrlWe.enigma << " > SK "
+			LOG4CXX_TRACE(logger, missingSequences.size() << " missing packets "
+					"for rCID " << rCId.print() << " > enigma "
+					<< ltpHeaderCtrlWe.enigma << " > SK "
 					<< ltpHeaderCtrlWe.sessionKey << ". First: "
-					<< firstMissingSequence << ", Last: "
-					<< lastMissingSequence);
+					<< *missingSequences.begin() << ", Last: "
+					<< *missingSequences.rbegin());
 			_publishNegativeAcknowledgement(cid, rCId,
 					ltpHeaderCtrlWe.enigma, ltpHeaderCtrlWe.sessionKey,
-					firstMissingSequence, lastMissingSequence);
+					missingSequences, _ltpVersion(cid));
 		}
 
 		break;
@@ -2689,14 +2372,36 @@ tp_states_t Lightweight::_handleControl(IcnId &rCId, uint8_t *packet,
 		packet += sizeof(ltpHeader.enigma);
 		// [4] Session key
 		memcpy(&ltpHeader.sessionKey, packet, sizeof(ltpHeader.sessionKey));
-		LOG4CXX_TRACE(logger, "LTP CTRL-WED received for rCID " << rCId.print()
-				<< " > enigma " << ltpHeader.enigma << " > SK "
-				<< ltpHeader.sessionKey);
+		packet += sizeof(ltpHeader.sessionKey);
+
+		// [5] v2: version (after two octets of padding)
+		if (packetSize > LTP_CTRL_WED_LENGTH)
+		{
+			memcpy(&ltpHeader.version, packet + 2, sizeof(ltpHeader.version));
+		}
+
+		LOG4CXX_TRACE(logger, "LTP CTRL-WED (v" << (int)ltpHeader.version
+				<< ") received for rCID " << rCId.print() << " > enigma "
+				<< ltpHeader.enigma << " > SK " << ltpHeader.sessionKey);
+		IcnId cid;
+		uint16_t rtt;
+		// let the LTP sender move on to the next message of this session
+		bool senderWaiting = _ltpSender.windowEnded(rCId, ltpHeader.enigma,
+				ltpHeader.sessionKey, cid, rtt);
+
+		if (senderWaiting)
+		{
+			_rtt(rtt);
+			_statistics.roundTripTime(cid, rtt);
+			_ltpVersion(cid, ltpHeader.version);
+		}
+
+		window_ended_requests_t::iterator windowEndedRequestsIt;
 		_windowEndedRequestsMutex.lock();
 		// Check for CID
-		_windowEndedRequestsIt = _windowEndedRequests.find(rCId.uint());
+		windowEndedRequestsIt = _windowEndedRequests.find(rCId.uint());
 
-		if (_windowEndedRequestsIt == _windowEndedRequests.end())
+		if (windowEndedRequestsIt == _windowEndedRequests.end())
 		{
 			LOG4CXX_DEBUG(logger, "rCID " << rCId.print() << " could not be "
 					"found in _windowEndedRequests map");
@@ -2705,9 +2410,9 @@ tp_states_t Lightweight::_handleControl(IcnId &rCId, uint8_t *packet,
 		}
 
 		// Check for enigma
-		enigmaMapIt = _windowEndedRequestsIt->second.find(ltpHeader.enigma);
+		enigmaMapIt = windowEndedRequestsIt->second.find(ltpHeader.enigma);
 
-		if (enigmaMapIt == _windowEndedRequestsIt->second.end())
+		if (enigmaMapIt == windowEndedRequestsIt->second.end())
 		{
 			LOG4CXX_DEBUG(logger, "enigma " << ltpHeader.enigma << " does "
 					"not exist in _windowEndedRequests map for rCID "
@@ -2729,6 +2434,28 @@ tp_states_t Lightweight::_handleControl(IcnId &rCId, uint8_t *packet,
 			break;
 		}
 
+		// The sender does not poll the flag. Erase the entry instead
+		if (senderWaiting)
+		{
+			enigmaMapIt->second.erase(sessionKeyMapIt);
+
+			if (enigmaMapIt->second.empty())
+			{
+				windowEndedRequestsIt->second.erase(enigmaMapIt);
+			}
+
+			if (windowEndedRequestsIt->second.empty())
+			{
+				_windowEndedRequests.erase(windowEndedRequestsIt);
+			}
+
+			LOG4CXX_TRACE(logger, "SK " << ltpHeader.sessionKey << " removed "
+					"from CTRL-WED map for rCID " << rCId.print()
+					<< " > enigma " << ltpHeader.enigma);
+			_windowEndedRequestsMutex.unlock();
+			break;
+		}
+
 		sessionKeyMapIt->second = true;
 		LOG4CXX_TRACE(logger, "CTRL-WED flag set to true in _windowEndedRequest"
 				"s map for rCID " << rCId.print() << " > enigma "
@@ -2771,14 +2498,27 @@ tp_states_t Lightweight::_handleControl(IcnId &rCId, uint8_t *packet,
 		return TP_STATE_NO_ACTION_REQUIRED;
 	}
 	case LTP_CONTROL_WINDOW_UPDATED:
+	{
 		// [3] enigma
 		memcpy(&ltpHeaderCtrl.enigma, packet,
 				sizeof(ltpHeaderCtrl.enigma));
 		packet += sizeof(ltpHeaderCtrl.enigma);
+		// [4] SK
+		memcpy(&ltpHeaderCtrl.sessionKey, packet,
+				sizeof(ltpHeaderCtrl.sessionKey));
 		LOG4CXX_TRACE(logger, "LTP CTRL-WUD for enigma "
 				<< ltpHeaderCtrl.enigma << " received under CID "
-				<< rCId.print());
+				<< rCId.print() << " > SK " << ltpHeaderCtrl.sessionKey);
+		uint16_t rtt;
+
+		if (_ltpSender.windowUpdated(rCId, ltpHeaderCtrl.enigma,
+				ltpHeaderCtrl.sessionKey, rtt))
+		{
+			_rtt(rtt);
+		}
+
 		break;
+	}
 	default:
 		LOG4CXX_TRACE(logger, "Unknown LTP CTRL type received for rCID "
 				<< rCId.print() << ": " << ltpHeaderCtrl.controlType);
@@ -2788,7 +2528,8 @@ tp_states_t Lightweight::_handleControl(IcnId &rCId, uint8_t *packet,
 }
 
 tp_states_t Lightweight::_handleControl(IcnId &cId, IcnId &rCId, NodeId &nodeId,
-		uint8_t *packet, enigma_t &enigma, sk_t &sessionKey)
+		uint8_t *packet, uint16_t packetSize, enigma_t &enigma,
+		sk_t &sessionKey)
 {// Handling LTP CTRL from cNAP
 	ltp_hdr_ctrl_t ltpHeader;
 	uint16_t offset = 0;
@@ -2802,30 +2543,33 @@ tp_states_t Lightweight::_handleControl(IcnId &cId, IcnId &rCId, NodeId &nodeId,
 	switch (ltpHeader.controlType)
 	{
 	case LTP_CONTROL_NACK:
+	case LTP_CONTROL_SACK:
 	{
 		ltp_hdr_ctrl_nack_t ltpHeaderNack;
-		// [3] enigma
-		memcpy(&ltpHeaderNack.enigma, packet + offset,
-				sizeof(ltpHeaderNack.enigma));
-		offset += sizeof(ltpHeaderNack.enigma);
-		// [4] SK
-		memcpy(&ltpHeaderNack.sessionKey, packet + offset,
-				sizeof(ltpHeaderNack.sessionKey));
-		offset += sizeof(ltpHeaderNack.sessionKey);
-		// [5] Start
-		memcpy(&ltpHeaderNack.start, packet + offset,
-				sizeof(ltpHeaderNack.start));
-		offset += sizeof(ltpHeaderNack.start);
-		// [6] End
-		memcpy(&ltpHeaderNack.end, packet + offset, sizeof(ltpHeaderNack.end));
-		LOG4CXX_TRACE(logger, "CTRL-NACK for Segments " << ltpHeaderNack.start
-				<< " - " << ltpHeaderNack.end << " received under CID "
+		ltp_sequences_t sequences;
+
+		if (!_deserialiseNegativeAcknowledgement(ltpHeader.controlType,
+				packet + offset, packetSize - offset, ltpHeaderNack,
+				sequences))
+		{
+			LOG4CXX_DEBUG(logger, "Malformed CTRL-NACK received under CID "
+					<< cId.print() << " from NID " << nodeId.uint());
+			break;
+		}
+
+		LOG4CXX_TRACE(logger, "CTRL-NACK for " << sequences.size()
+				<< " segments (" << *sequences.begin() << " - "
+				<< *sequences.rbegin() << ") received under CID "
 				<< cId.print() << " for rCID " << rCId.print() << " > enigma "
 				<< ltpHeaderNack.enigma << " > SK "
 				<< ltpHeaderNack.sessionKey);
-		// first add the NID and the start/end
+		// a v1 cNAP answers with NACKs only
+		_ltpVersion(nodeId,
+				(ltpHeader.controlType == LTP_CONTROL_SACK) ? 2 : 1);
+		// first add the NID and the missing segments
+		window_ended_responses_t::iterator windowEndedResponsesIt;
 		_nackGroupsMutex.lock();
-		_addNackNodeId(rCId, ltpHeaderNack, nodeId);
+		_addNackNodeId(rCId, ltpHeaderNack, sequences, nodeId);
 		// re-publish the requested range of segments
 		// first check if a response from all nodes has been received. Find all
 		// NID in the CMC group and check if this NID is the last one the sNAP
@@ -2852,10 +2596,10 @@ tp_states_t Lightweight::_handleControl(IcnId &cId, IcnId &rCId, NodeId &nodeId,
 		map<nid_t, map<sk_t, bool>>::iterator wedNidIt;
 		map<enigma_t, map<nid_t, map<sk_t, bool>>>::iterator wedenigmaIt;
 		_windowEndedResponsesMutex.lock();
-		_windowEndedResponsesIt = _windowEndedResponses.find(rCId.uint());
+		windowEndedResponsesIt = _windowEndedResponses.find(rCId.uint());
 
 		// rCID does not exist in WED map
-		if (_windowEndedResponsesIt == _windowEndedResponses.end())
+		if (windowEndedResponsesIt == _windowEndedResponses.end())
 		{
 			LOG4CXX_TRACE(logger, "rCID " << rCId.print() << " does not exist "
 					"in sent CTRL-WEs map");
@@ -2865,11 +2609,11 @@ tp_states_t Lightweight::_handleControl(IcnId &cId, IcnId &rCId, NodeId &nodeId,
 			return TP_STATE_NO_ACTION_REQUIRED;
 		}
 
-		wedenigmaIt = _windowEndedResponsesIt->second.find(
+		wedenigmaIt = windowEndedResponsesIt->second.find(
 				ltpHeaderNack.enigma);
 
 		// enigma does not exist in WED map
-		if (wedenigmaIt == _windowEndedResponsesIt->second.end())
+		if (wedenigmaIt == windowEndedResponsesIt->second.end())
 		{
 			LOG4CXX_TRACE(logger, "enigma " << ltpHeaderNack.enigma
 					<< " could not be found in sent CTRL-WEs map");
@@ -2991,11 +2735,12 @@ tp_states_t Lightweight::_handleControl(IcnId &cId, IcnId &rCId, NodeId &nodeId,
 		LOG4CXX_TRACE(logger, "CTRL-SED received from cNAP for CID "
 				<< cId.print() << " rCID " << rCId.print() << " > enigma "
 				<< enigma << " > SK " << sessionKey);
+		session_ended_responses_t::iterator sessionEndedResponsesIt;
 		_sessionEndedResponsesMutex.lock();
-		_sessionEndedResponsesIt = _sessionEndedResponses.find(rCId.uint());
+		sessionEndedResponsesIt = _sessionEndedResponses.find(rCId.uint());
 
 		// rCID does not exist
-		if (_sessionEndedResponsesIt == _sessionEndedResponses.end())
+		if (sessionEndedResponsesIt == _sessionEndedResponses.end())
 		{
 			LOG4CXX_DEBUG(logger, "rCID " << rCId.print() << " does not exist "
 					"in LTP CTRL SED map (anymore). Dropping packet");
@@ -3003,10 +2748,10 @@ tp_states_t Lightweight::_handleControl(IcnId &cId, IcnId &rCId, NodeId &nodeId,
 			return TP_STATE_NO_ACTION_REQUIRED;
 		}
 
-		enigmaIt = _sessionEndedResponsesIt->second.find(enigma);
+		enigmaIt = sessionEndedResponsesIt->second.find(enigma);
 
 		// enigma does not exist
-		if (enigmaIt == _sessionEndedResponsesIt->second.end())
+		if (enigmaIt == sessionEndedResponsesIt->second.end())
 		{
 			LOG4CXX_DEBUG(logger, "rCID " << rCId.print() << " > enigma "
 					<< enigma << " does not exist in LTP CTRL SED map"
@@ -3049,7 +2794,6 @@ tp_states_t Lightweight::_handleControl(IcnId &cId, IcnId &rCId, NodeId &nodeId,
 	case LTP_CONTROL_WINDOW_END:
 	{
 		ltp_hdr_ctrl_we_t ltpHeaderControlWe;
-		map<seq_t, pair<uint8_t*, uint16_t>>::iterator sequenceMapIt;
 		map<sk_t, map<seq_t, pair<uint8_t*, uint16_t>>>::iterator
 				sessionKeyMapIt;
 		map<nid_t, map<sk_t, map<seq_t, pair<uint8_t*, uint16_t>>>>::iterator
@@ -3065,9 +2809,26 @@ tp_states_t Lightweight::_handleControl(IcnId &cId, IcnId &rCId, NodeId &nodeId,
 				sizeof(ltpHeaderControlWe.sessionKey));
 		offset += sizeof(ltpHeaderControlWe.sessionKey);
 		// [5] Sequence number
-		memcpy(&ltpHeaderControlWe.sequenceNumber, packet + offset,
-				sizeof(ltpHeaderControlWe.sequenceNumber));
-		LOG4CXX_TRACE(logger, "LTP CTRL-WE (enigma "
+		uint16_t sequenceNumber;
+		memcpy(&sequenceNumber, packet + offset, sizeof(sequenceNumber));
+		offset += sizeof(sequenceNumber);
+		ltpHeaderControlWe.sequenceNumber = sequenceNumber;
+
+		// [6] v2: version and 32-bit sequence number
+		if (packetSize >= LTP_CTRL_WE_LENGTH
+				+ sizeof(ltpHeaderControlWe.version)
+				+ sizeof(ltpHeaderControlWe.sequenceNumber))
+		{
+			memcpy(&ltpHeaderControlWe.version, packet + offset,
+					sizeof(ltpHeaderControlWe.version));
+			offset += sizeof(ltpHeaderControlWe.version);
+			memcpy(&ltpHeaderControlWe.sequenceNumber, packet + offset,
+					sizeof(ltpHeaderControlWe.sequenceNumber));
+		}
+
+		_ltpVersion(nodeId, ltpHeaderControlWe.version);
+		LOG4CXX_TRACE(logger, "LTP CTRL-WE v"
+				<< (int)ltpHeaderControlWe.version << " (enigma "
 				<< ltpHeaderControlWe.enigma << ", SK "
 				<< ltpHeaderControlWe.sessionKey << ", Seq "
 				<< ltpHeaderControlWe.sequenceNumber << ") received for CID "
@@ -3077,11 +2838,12 @@ tp_states_t Lightweight::_handleControl(IcnId &cId, IcnId &rCId, NodeId &nodeId,
 		/* Check in ICN packet buffer that all sequences starting from one up to
 		 * the one received here have been received
 		 */
+		icn_packet_buffer_t::iterator icnPacketBufferIt;
 		_icnPacketBufferMutex.lock();
 		// Find rCID
-		_icnPacketBufferIt = _icnPacketBuffer.find(rCId.uint());
+		icnPacketBufferIt = _icnPacketBuffer.find(rCId.uint());
 
-		if (_icnPacketBufferIt == _icnPacketBuffer.end())
+		if (icnPacketBufferIt == _icnPacketBuffer.end())
 		{
 			LOG4CXX_DEBUG(logger, "rCID " << rCId.print() << " unknown. "
 					"Cannot check if CTRL-WED should be sent (START_PUBLISH_iSU"
@@ -3091,9 +2853,9 @@ tp_states_t Lightweight::_handleControl(IcnId &cId, IcnId &rCId, NodeId &nodeId,
 		}
 
 		// Find enigma
-		enigmaMapIt = _icnPacketBufferIt->second.find(ltpHeaderControlWe.enigma);
+		enigmaMapIt = icnPacketBufferIt->second.find(ltpHeaderControlWe.enigma);
 
-		if (enigmaMapIt == _icnPacketBufferIt->second.end())
+		if (enigmaMapIt == icnPacketBufferIt->second.end())
 		{
 			LOG4CXX_TRACE(logger, "Enigma " << ltpHeaderControlWe.enigma
 					<< " unknown. Cannot check if CTRL-WED should be sent "
@@ -3134,56 +2896,9 @@ tp_states_t Lightweight::_handleControl(IcnId &cId, IcnId &rCId, NodeId &nodeId,
 		}
 
 		// Check that consecutive sequence numbers exist
-		bool allFragmentsReceived = true;
-		seq_t firstMissingSequence = 0;
-		seq_t lastMissingSequence = 0;
-		seq_t previousSequence = 0;
-
-		for (sequenceMapIt = sessionKeyMapIt->second.begin();
-				sequenceMapIt != sessionKeyMapIt->second.end(); sequenceMapIt++)
-		{
-			// First fragment is missing
-			if (previousSequence == 0 && sequenceMapIt->first != 1)
-			{
-				firstMissingSequence = 1;
-				lastMissingSequence = 1;
-				cout << "both set to 1\n";
-				allFragmentsReceived = false;
-			}
-			// Not first, but any other sequence is missing
-			else if ((previousSequence + 1) < sequenceMapIt->first)
-			{
-				if (firstMissingSequence == 0)
-				{
-					firstMissingSequence = previousSequence + 1;
-					cout << "firstMissingSequence set to "
-							<< firstMissingSequence << endl;
-				}
-
-				lastMissingSequence = sequenceMapIt->first - 1;
-				cout << "lastMissingSequence set to " << lastMissingSequence
-						<< endl;
-				allFragmentsReceived = false;
-			}
-
-			previousSequence = sequenceMapIt->first;
-
-		}
-		// check if sequence indicated in CTRL-WE was actually received
-		map<seq_t, pair<uint8_t*, uint16_t>>::reverse_iterator sequenceMapRIt;
-		sequenceMapRIt = sessionKeyMapIt->second.rbegin();
-
-		if (sequenceMapRIt->first < ltpHeaderControlWe.sequenceNumber)
-		{
-			if (firstMissingSequence == 0)
-			{
-				firstMissingSequence = ltpHeaderControlWe.sequenceNumber;
-			}
-
-			lastMissingSequence = ltpHeaderControlWe.sequenceNumber;
-			allFragmentsReceived = false;
-		}
-
+		ltp_sequences_t missingSequences;
+		bool allFragmentsReceived = _missingSequences(sessionKeyMapIt->second,
+				ltpHeaderControlWe.sequenceNumber, missingSequences);
 		_icnPacketBufferMutex.unlock();
 
 		// send WED if all segments have been received
@@ -3199,16 +2914,18 @@ tp_states_t Lightweight::_handleControl(IcnId &cId, IcnId &rCId, NodeId &nodeId,
 		// Sequence was missing. Send off NACK message
 		else
 		{
-			LOG4CXX_TRACE(logger, "Missing packets for CID " << cId.print()
-					<< " rCID " << rCId.print()	<< " > enigma "
-					<< ltpHeaderControlWe.enigma << " > SK "
+			LOG4CXX_TRACE(logger, missingSequences.size() << " missing packets "
+					"for CID " << cId.print() << " rCID " << rCId.print()
+					<< " > enigma " << ltpHeaderControlWe.enigma << " > SK "
 					<< ltpHeaderControlWe.sessionKey << ". First: "
-					<< firstMissingSequence << ", Last: "
-					<< lastMissingSequence);
+					<< *missingSequences.begin() << ", Last: "
+					<< *missingSequences.rbegin());
+			list<NodeId> nodeIds;
+			nodeIds.push_back(nodeId);
 			_publishNegativeAcknowledgement(rCId, nodeId,
 					ltpHeaderControlWe.enigma,
-					ltpHeaderControlWe.sessionKey, firstMissingSequence,
-					lastMissingSequence);
+					ltpHeaderControlWe.sessionKey, missingSequences,
+					_ltpVersion(nodeIds));
 		}
 		break;
 	}
@@ -3226,14 +2943,27 @@ tp_states_t Lightweight::_handleControl(IcnId &cId, IcnId &rCId, NodeId &nodeId,
 		// [4] Session key
 		memcpy(&ltpHeaderControlWed.sessionKey, packet + offset,
 				sizeof(ltpHeaderControlWed.sessionKey));
-		LOG4CXX_TRACE(logger, "LTP CTRL-WED received for rCID " << rCId.print()
+		offset += sizeof(ltpHeaderControlWed.sessionKey);
+
+		// [5] v2: version (after two octets of padding)
+		if (packetSize > LTP_CTRL_WED_LENGTH)
+		{
+			memcpy(&ltpHeaderControlWed.version, packet + offset + 2,
+					sizeof(ltpHeaderControlWed.version));
+		}
+
+		_ltpVersion(nodeId, ltpHeaderControlWed.version);
+		LOG4CXX_TRACE(logger, "LTP CTRL-WED v"
+				<< (int)ltpHeaderControlWed.version << " received for rCID "
+				<< rCId.print()
 				<< " > enigma " << ltpHeaderControlWed.enigma << " > NID "
 				<< nodeId.uint() << " > SK "
 				<< ltpHeaderControlWed.sessionKey);
+		window_ended_responses_t::iterator windowEndedResponsesIt;
 		_windowEndedResponsesMutex.lock();
-		_windowEndedResponsesIt = _windowEndedResponses.find(rCId.uint());
+		windowEndedResponsesIt = _windowEndedResponses.find(rCId.uint());
 
-		if (_windowEndedResponsesIt == _windowEndedResponses.end())
+		if (windowEndedResponsesIt == _windowEndedResponses.end())
 		{
 			LOG4CXX_TRACE(logger, "rCID " << rCId.print() << " does not exist "
 					"in sent CTRL-WEs map");
@@ -3241,10 +2971,10 @@ tp_states_t Lightweight::_handleControl(IcnId &cId, IcnId &rCId, NodeId &nodeId,
 			return TP_STATE_NO_ACTION_REQUIRED;
 		}
 
-		enigmaMapIt = _windowEndedResponsesIt->second.find(
+		enigmaMapIt = windowEndedResponsesIt->second.find(
 				ltpHeaderControlWed.enigma);
 
-		if (enigmaMapIt == _windowEndedResponsesIt->second.end())
+		if (enigmaMapIt == windowEndedResponsesIt->second.end())
 		{
 			LOG4CXX_TRACE(logger, "enigma " << ltpHeaderControlWed.enigma
 					<< " could not be found in sent CTRL-WEs map");
@@ -3351,6 +3081,11 @@ tp_states_t Lightweight::_handleControl(IcnId &cId, IcnId &rCId, NodeId &nodeId,
 		LOG4CXX_TRACE(logger, "LTP CTRL-WU for enigma "
 				<< ltpHeaderControlWu.enigma << " received for CID "
 				<< cId.print() << " with rCID " << rCId.print());
+		// confirm it, so that the cNAP can grow its window
+		ltp_hdr_ctrl_wud_t ltpHeaderControlWud;
+		ltpHeaderControlWud.enigma = ltpHeaderControlWu.enigma;
+		ltpHeaderControlWud.sessionKey = ltpHeaderControlWu.sessionKey;
+		_publishWindowUpdated(rCId, nodeId, ltpHeaderControlWud);
 		break;
 	}
 	case LTP_CONTROL_WINDOW_UPDATED:
@@ -3370,10 +3105,11 @@ tp_states_t Lightweight::_handleControl(IcnId &cId, IcnId &rCId, NodeId &nodeId,
 		LOG4CXX_TRACE(logger, "LTP CTRL-WUD received for rCID " << rCId.print()
 				<< " > enigma " << ltpHeaderControlWud.enigma << " > NID "
 				<< nodeId.uint() << " > SK " << ltpHeaderControlWud.sessionKey);
+		window_update_t::iterator windowUpdateIt;
 		_windowUpdateMutex.lock();
-		_windowUpdateIt = _windowUpdate.find(rCId.uint());
+		windowUpdateIt = _windowUpdate.find(rCId.uint());
 
-		if (_windowUpdateIt == _windowUpdate.end())
+		if (windowUpdateIt == _windowUpdate.end())
 		{
 			LOG4CXX_DEBUG(logger, "rCID " << rCId.print() << " does not exist "
 					"in WU map");
@@ -3381,9 +3117,9 @@ tp_states_t Lightweight::_handleControl(IcnId &cId, IcnId &rCId, NodeId &nodeId,
 			return TP_STATE_NO_ACTION_REQUIRED;
 		}
 
-		enigmaIt = _windowUpdateIt->second.find(ltpHeaderControlWud.enigma);
+		enigmaIt = windowUpdateIt->second.find(ltpHeaderControlWud.enigma);
 
-		if (enigmaIt == _windowUpdateIt->second.end())
+		if (enigmaIt == windowUpdateIt->second.end())
 		{
 			LOG4CXX_DEBUG(logger, "rCID " << rCId.print() << " > enigma "
 					<< ltpHeaderControlWud.enigma << " does not exist in "
@@ -3435,26 +3171,7 @@ tp_states_t Lightweight::_handleControl(IcnId &cId, IcnId &rCId, NodeId &nodeId,
 void Lightweight::_handleData(IcnId &rCid, uint8_t *packet)
 {
 	ltp_hdr_data_t ltpHeader;
-	uint8_t offset = 0;
-	// [1] Message type
-	offset += sizeof(ltpHeader.messageType);
-	// [2] enigma
-	memcpy(&ltpHeader.enigma, packet + offset,
-			sizeof(ltpHeader.enigma));
-	offset += sizeof(ltpHeader.enigma);
-	// [3] Session key
-	memcpy(&ltpHeader.sessionKey, packet + offset,
-			sizeof(ltpHeader.sessionKey));
-	offset += sizeof(ltpHeader.sessionKey);
-	// [4] Sequence num
-	memcpy(&ltpHeader.sequenceNumber, packet + offset,
-			sizeof(ltpHeader.sequenceNumber));
-	offset += sizeof(ltpHeader.sequenceNumber);
-	// [5] Payload length
-	memcpy(&ltpHeader.payloadLength, packet + offset,
-			sizeof(ltpHeader.payloadLength));
-	offset += sizeof(ltpHeader.payloadLength);
-	packet += offset;
+	packet += _deserialiseDataHeader(packet, ltpHeader);
 	//add packet to LTP buffer
 	_bufferIcnPacket(rCid, _configuration.nodeId(), ltpHeader, packet);
 }
@@ -3463,26 +3180,7 @@ void Lightweight::_handleData(IcnId cId, IcnId &rCId, NodeId &nodeId,
 		uint8_t *packet)
 {
 	ltp_hdr_data_t ltpHeader;
-	uint8_t offset = 0;
-	// [1] Message type
-	offset += sizeof(ltpHeader.messageType);
-	// [2] enigma
-	memcpy(&ltpHeader.enigma, packet + offset,
-			sizeof(ltpHeader.enigma));
-	offset += sizeof(ltpHeader.enigma);
-	// [3] Session key
-	memcpy(&ltpHeader.sessionKey, packet + offset,
-			sizeof(ltpHeader.sessionKey));
-	offset += sizeof(ltpHeader.sessionKey);
-	// [4] Sequence num
-	memcpy(&ltpHeader.sequenceNumber, packet + offset,
-			sizeof(ltpHeader.sequenceNumber));
-	offset += sizeof(ltpHeader.sequenceNumber);
-	// [5] Payload length
-	memcpy(&ltpHeader.payloadLength, packet + offset,
-			sizeof(ltpHeader.payloadLength));
-	offset += sizeof(ltpHeader.payloadLength);
-	packet += offset;
+	packet += _deserialiseDataHeader(packet, ltpHeader);
 	// add packet to LTP ICN buffer
 	_bufferIcnPacket(rCId, nodeId, ltpHeader, packet);
 	// Note, the _potentialCmcGroups* map and mutex are only pointers. They have
@@ -3586,6 +3284,7 @@ bool Lightweight::_ltpCtrlSedReceived(IcnId &rCid, sk_t &sessionKey)
 bool Lightweight::_ltpCtrlSedReceived(IcnId rCid, list<NodeId> nodeIds,
 		enigma_t enigma,  sk_t sessionKey)
 {
+	session_ended_responses_t::iterator sessionEndedResponsesIt;
 	ltp_hdr_ctrl_se_t ltpHeaderCtrlSe;
 	ltpHeaderCtrlSe.enigma = enigma;
 	ltpHeaderCtrlSe.sessionKey = sessionKey;
@@ -3614,9 +3313,10 @@ bool Lightweight::_ltpCtrlSedReceived(IcnId rCid, list<NodeId> nodeIds,
 			currentTime = boost::posix_time::microsec_clock::local_time();
 			timeWaited = currentTime - startTime;
 			_sessionEndedResponsesMutex.lock();
-			_sessionEndedResponsesIt = _sessionEndedResponses.find(rCid.uint());
+			sessionEndedResponsesIt = _sessionEndedResponses.find(
+					rCid.uint());
 
-			if (_sessionEndedResponsesIt == _sessionEndedResponses.end())
+			if (sessionEndedResponsesIt == _sessionEndedResponses.end())
 			{
 				LOG4CXX_WARN(logger, "rCID " << rCid.print() << " does not "
 						"exist in CTRL-SED map");
@@ -3624,7 +3324,7 @@ bool Lightweight::_ltpCtrlSedReceived(IcnId rCid, list<NodeId> nodeIds,
 				return false;
 			}
 
-			enigmaIt = _sessionEndedResponsesIt->second.find(enigma);
+			enigmaIt = sessionEndedResponsesIt->second.find(enigma);
 			uint16_t numberOfConfirmedSeds = 0;
 
 			for (auto nodeIdsIt = nodeIds.begin(); nodeIdsIt != nodeIds.end();
@@ -3680,6 +3380,125 @@ bool Lightweight::_ltpCtrlSedReceived(IcnId rCid, list<NodeId> nodeIds,
 	return false;
 }
 
+void Lightweight::_ltpSenderLoop()
+{
+	list<ltp_sender_action_t> actions;
+	list<ltp_sender_action_t>::iterator it;
+	ltp_hdr_data_t ltpHeaderData;
+	// one serialised header per fragment of a round. Grows to the largest round
+	// seen. The payload is published straight from the message
+	vector<uint8_t> headers;
+	vector<uint8_t> headerSizes;
+	struct iovec iov[2];
+
+	while (_ltpSender.next(actions))
+	{
+		uint32_t fragments = 0;
+
+		for (it = actions.begin(); it != actions.end(); it++)
+		{
+			if (it->action == LTP_SENDER_ACTION_DATA)
+			{
+				fragments++;
+			}
+		}
+
+		if (headerSizes.size() < fragments)
+		{
+			headers.resize(fragments * LTP_DATA_HEADER_LENGTH_V2);
+			headerSizes.resize(fragments);
+		}
+
+		// Make the headers and keep a reference for NACKs
+		fragments = 0;
+
+		for (it = actions.begin(); it != actions.end(); it++)
+		{
+			if (it->action != LTP_SENDER_ACTION_DATA)
+			{
+				continue;
+			}
+
+			// 32-bit sequences once the sNAP(s) announced LTP v2
+			ltpHeaderData.messageType = (_ltpVersion(it->cId) >= 2) ?
+					LTP_DATA_V2 : LTP_DATA;
+			ltpHeaderData.enigma = it->enigma;
+			ltpHeaderData.sessionKey = it->sessionKey;
+			ltpHeaderData.sequenceNumber = it->sequence;
+			ltpHeaderData.payloadLength = it->payloadLength;
+			headerSizes[fragments] = _serialiseDataHeader(ltpHeaderData,
+					&headers[fragments * LTP_DATA_HEADER_LENGTH_V2]);
+			_bufferProxyPacket(it->cId, it->rCId, ltpHeaderData, it->message,
+					it->payload, it->fragmentSize);
+			fragments++;
+		}
+
+		// Publish all fragments of this round under a single lock
+		if (fragments > 0)
+		{
+			fragments = 0;
+			_icnCoreMutex.lock();
+
+			for (it = actions.begin(); it != actions.end(); it++)
+			{
+				if (it->action != LTP_SENDER_ACTION_DATA)
+				{
+					continue;
+				}
+
+				iov[0].iov_base =
+						&headers[fragments * LTP_DATA_HEADER_LENGTH_V2];
+				iov[0].iov_len = headerSizes[fragments];
+				iov[1].iov_base = it->payload;
+				iov[1].iov_len = it->fragmentSize;
+#ifdef TRAFFIC_CONTROL
+				// Check if TC drop rate should be applied
+				if (!TrafficControl::handle())
+				{
+#endif
+					_icnCore->publish_data_isub(it->cId.binIcnId(),
+							DOMAIN_LOCAL, NULL, 0, it->rCId.binIcnId(), iov, 2);
+#ifdef TRAFFIC_CONTROL
+				}
+#endif
+				fragments++;
+			}
+
+			_icnCoreMutex.unlock();
+		}
+
+		// CTRL messages go out after the fragments of this round
+		for (it = actions.begin(); it != actions.end(); it++)
+		{
+			switch (it->action)
+			{
+			case LTP_SENDER_ACTION_DATA:
+				LOG4CXX_TRACE(logger, "Fragment of length " << it->fragmentSize
+						<< " published under CID " << it->cId.print()
+						<< ", rCID " << it->rCId.print() << ", enigma "
+						<< it->enigma << ", SK " << it->sessionKey
+						<< ", Sequence " << it->sequence << ", Window "
+						<< it->window);
+				// the proxy buffer holds its own reference
+				it->message->release();
+				break;
+			case LTP_SENDER_ACTION_WINDOW_UPDATE:
+				_publishWindowUpdate(it->cId, it->rCId, it->enigma,
+						it->sessionKey);
+				break;
+			case LTP_SENDER_ACTION_WINDOW_END:
+				_publishWindowEnd(it->cId, it->rCId, it->enigma,
+						it->sessionKey, it->sequence);
+				break;
+			}
+		}
+
+		actions.clear();
+	}
+
+	LOG4CXX_DEBUG(logger, "LTP sender stopped");
+}
+
 bool Lightweight::_ltpSessionActivityCheck(IcnId &rCid, enigma_t &enigma,
 			sk_t &sessionKey)
 {
@@ -3784,37 +3603,154 @@ void Lightweight::_ltpSessionActivitySet(IcnId &rCid, enigma_t &enigma,
 			<< sessionKey << " change from " << statusOld << " to " << status);
 }
 
-nack_group_t Lightweight::_nackGroup(IcnId &rCid,
-		ltp_hdr_ctrl_nack_t &ltpHeaderNack)
+uint8_t Lightweight::_ltpVersion(IcnId &cid)
 {
-	nack_group_t nackGroup;
-	_nackGroupsIt = _nackGroups.find(rCid.uint());
+	uint8_t version = 1;
+	unordered_map<cid_t, uint8_t>::iterator it;
+	_ltpVersionsMutex.lock();
+	it = _ltpVersionsCid.find(cid.uint());
 
-	// rCID not found
-	if (_nackGroupsIt == _nackGroups.end())
+	if (it != _ltpVersionsCid.end())
 	{
-		LOG4CXX_WARN(logger, "rCID " << rCid.print() << " does not exist in "
-				"NACK group");
-		return nackGroup;
+		version = it->second;
 	}
 
-	map<enigma_t, map<sk_t, nack_group_t>>::iterator enigmaIt;
-	enigmaIt = _nackGroupsIt->second.find(ltpHeaderNack.enigma);
+	_ltpVersionsMutex.unlock();
 
-	// enigma not found
-	if (enigmaIt == _nackGroupsIt->second.end())
+	if (version > _configuration.ltpVersion())
 	{
-		LOG4CXX_WARN(logger, "rCID " << rCid.print() << " > enigma "
-				<< ltpHeaderNack.enigma << " does not exist in NACK "
-						"group");
-		return nackGroup;
+		version = _configuration.ltpVersion();
 	}
 
-	map<sk_t, nack_group_t>::iterator skIt;
-	skIt = enigmaIt->second.find(ltpHeaderNack.sessionKey);
+	return version;
+}
 
-	// SK not found
-	if (skIt == enigmaIt->second.end())
+uint8_t Lightweight::_ltpVersion(list<NodeId> &nodeIds)
+{
+	uint8_t version = _configuration.ltpVersion();
+	list<NodeId>::iterator nodeIdsIt;
+	unordered_map<nid_t, uint8_t>::iterator it;
+	_ltpVersionsMutex.lock();
+
+	for (nodeIdsIt = nodeIds.begin(); nodeIdsIt != nodeIds.end(); nodeIdsIt++)
+	{
+		it = _ltpVersionsNid.find(nodeIdsIt->uint());
+
+		// NID has not announced any version yet
+		if (it == _ltpVersionsNid.end())
+		{
+			version = 1;
+			break;
+		}
+
+		if (it->second < version)
+		{
+			version = it->second;
+		}
+	}
+
+	_ltpVersionsMutex.unlock();
+	return version;
+}
+
+void Lightweight::_ltpVersion(IcnId &cid, uint8_t version)
+{
+	_ltpVersionsMutex.lock();
+	pair<unordered_map<cid_t, uint8_t>::iterator, bool> it =
+			_ltpVersionsCid.insert(pair<cid_t, uint8_t>(cid.uint(), version));
+
+	if (!it.second && it.first->second != version)
+	{
+		it.first->second = version;
+		LOG4CXX_DEBUG(logger, "LTP version of sNAP(s) serving CID "
+				<< cid.print() << " changed to " << (int)version);
+	}
+
+	_ltpVersionsMutex.unlock();
+}
+
+void Lightweight::_ltpVersion(NodeId &nodeId, uint8_t version)
+{
+	_ltpVersionsMutex.lock();
+	pair<unordered_map<nid_t, uint8_t>::iterator, bool> it =
+			_ltpVersionsNid.insert(pair<nid_t, uint8_t>(nodeId.uint(),
+					version));
+
+	if (!it.second && it.first->second != version)
+	{
+		it.first->second = version;
+		LOG4CXX_DEBUG(logger, "LTP version of NID " << nodeId.uint()
+				<< " changed to " << (int)version);
+	}
+
+	_ltpVersionsMutex.unlock();
+}
+
+bool Lightweight::_missingSequences(
+		map<seq_t, pair<uint8_t*, uint16_t>> &fragments, seq_t lastSequence,
+		ltp_sequences_t &missingSequences)
+{
+	map<seq_t, pair<uint8_t*, uint16_t>>::iterator it = fragments.begin();
+
+	// sequence numbers start at 1
+	for (seq_t sequence = 1; sequence <= lastSequence; sequence++)
+	{
+		while (it != fragments.end() && it->first < sequence)
+		{
+			it++;
+		}
+
+		// received
+		if (it != fragments.end() && it->first == sequence)
+		{
+			continue;
+		}
+
+		// the first hole decides the range a single SACK can cover
+		if (!missingSequences.empty() && (sequence - *missingSequences.begin())
+				>= LTP_SACK_MAX_BITMAP * 8)
+		{
+			break;
+		}
+
+		missingSequences.insert(missingSequences.end(), sequence);
+	}
+
+	return missingSequences.empty();
+}
+
+nack_group_t Lightweight::_nackGroup(IcnId &rCid,
+		ltp_hdr_ctrl_nack_t &ltpHeaderNack)
+{
+	nack_groups_t::iterator nackGroupsIt;
+	nack_group_t nackGroup;
+	nackGroupsIt = _nackGroups.find(rCid.uint());
+
+	// rCID not found
+	if (nackGroupsIt == _nackGroups.end())
+	{
+		LOG4CXX_WARN(logger, "rCID " << rCid.print() << " does not exist in "
+				"NACK group");
+		return nackGroup;
+	}
+
+	map<enigma_t, map<sk_t, nack_group_t>>::iterator enigmaIt;
+	enigmaIt = nackGroupsIt->second.find(ltpHeaderNack.enigma);
+
+	// enigma not found
+	if (enigmaIt == nackGroupsIt->second.end())
+	{
+		LOG4CXX_WARN(logger, "rCID " << rCid.print() << " > enigma "
+				<< ltpHeaderNack.enigma << " does not exist in NACK "
+						"group");
+		return nackGroup;
+	}
+
+	map<sk_t, nack_group_t>::iterator skIt;
+	skIt = enigmaIt->second.find(ltpHeaderNack.sessionKey);
+
+	// SK not found
+	if (skIt == enigmaIt->second.end())
 	{
 		LOG4CXX_WARN(logger, "rCID " << rCid.print() << " > enigma "
 				<< ltpHeaderNack.enigma << " > SK "
@@ -3832,8 +3768,8 @@ void Lightweight::_publishData(IcnId &rCId, ltp_hdr_ctrl_we_t &ltpHeaderCtrlWe,
 	ltp_hdr_data_t ltpHeaderData;
 	uint32_t sentBytes = 0;
 	uint16_t fragmentSize = 0;
-	uint8_t *packet;
-	uint16_t packetSize;
+	uint8_t header[LTP_DATA_HEADER_LENGTH_V2];
+	struct iovec iov[2];
 	uint8_t pad = 0;
 	list<string> nodeIdsStr;
 	list<NodeId>::iterator nodeIdsIt;
@@ -3844,9 +3780,14 @@ void Lightweight::_publishData(IcnId &rCId, ltp_hdr_ctrl_we_t &ltpHeaderCtrlWe,
 	map<enigma_t, map<sk_t, map<nid_t, bool>>>::iterator enigmaIt;
 	// calculate the payload the LTP packet can carry
 	uint32_t mitu = _configuration.mitu() - rCId.length() -
-			_configuration.icnHeaderLength() - sizeof(ltp_hdr_data_t) - 20;
+			_configuration.icnHeaderLength() - LTP_DATA_HEADER_LENGTH_V2 - 20;
 	mitu = mitu - (mitu % 8);//make it a multiple of 8
-	ltpHeaderData.messageType = LTP_DATA;
+	// a single copy of the response. Fragments are published straight from it
+	// and the LTP buffer references it for NACKs
+	LtpMessage *message = new LtpMessage(data, dataSize);
+	// 32-bit sequences only if all cNAPs announced LTP v2
+	ltpHeaderData.messageType = (_ltpVersion(nodeIds) >= 2) ? LTP_DATA_V2 :
+			LTP_DATA;
 	ltpHeaderData.enigma = ltpHeaderCtrlWe.enigma;
 	ltpHeaderData.sessionKey = ltpHeaderCtrlWe.sessionKey;
 	ltpHeaderData.sequenceNumber = 0;
@@ -3972,34 +3913,13 @@ void Lightweight::_publishData(IcnId &rCId, ltp_hdr_ctrl_we_t &ltpHeaderCtrlWe,
 			}
 		}
 
-		packetSize = sizeof(ltp_hdr_data_t) + fragmentSize;
-		uint8_t offsetPacket = 0;
-		// Make the packet
-		packet = (uint8_t *)malloc(packetSize);
-		// [1] messageType;
-		memcpy(packet, &ltpHeaderData.messageType,
-				sizeof(ltpHeaderData.messageType));
-		offsetPacket += sizeof(ltpHeaderData.messageType);
-		// [2] enigma
-		memcpy(packet + offsetPacket, &ltpHeaderData.enigma,
-				sizeof(ltpHeaderData.enigma));
-		offsetPacket += sizeof(ltpHeaderData.enigma);
-		// [3] Session key
-		memcpy(packet + offsetPacket,	&ltpHeaderData.sessionKey,
-				sizeof(ltpHeaderData.sessionKey));
-		offsetPacket += sizeof(ltpHeaderData.sessionKey);
-		// [4] Sequence number
-		memcpy(packet + offsetPacket, &ltpHeaderData.sequenceNumber,
-				sizeof(ltpHeaderData.sequenceNumber));
-		offsetPacket += sizeof(ltpHeaderData.sequenceNumber);
-		// [5] Payload length;
-		memcpy(packet + offsetPacket, &ltpHeaderData.payloadLength,
-				sizeof(ltpHeaderData.payloadLength));
-		offsetPacket += sizeof(ltpHeaderData.payloadLength);
-		// now the actual packet
-		memcpy(packet + offsetPacket, data + sentBytes, fragmentSize);
-		// This blocks until the buffer for rCID > enigma > SK is empty again
-		_bufferLtpPacket(rCId, ltpHeaderData, packet, packetSize);
+		// Make the packet: the header plus a slice of the response
+		iov[0].iov_base = header;
+		iov[0].iov_len = _serialiseDataHeader(ltpHeaderData, header);
+		iov[1].iov_base = message->data() + sentBytes;
+		iov[1].iov_len = fragmentSize;
+		_bufferLtpPacket(rCId, ltpHeaderData, message,
+				message->data() + sentBytes, fragmentSize);
 #ifdef TRAFFIC_CONTROL
 		// Check if TC drop rate should be applied
 		if (!TrafficControl::handle())
@@ -4007,142 +3927,31 @@ void Lightweight::_publishData(IcnId &rCId, ltp_hdr_ctrl_we_t &ltpHeaderCtrlWe,
 #endif
 			_icnCoreMutex.lock();
 			_icnCore->publish_data(rCId.binIcnId(), DOMAIN_LOCAL, NULL, 0,
-					nodeIdsStr, packet, packetSize);
+					nodeIdsStr, iov, 2);
 			_icnCoreMutex.unlock();
 #ifdef TRAFFIC_CONTROL
 		}
 #endif
 
 		sentBytes += (fragmentSize - pad);// remove padding bits
-		LOG4CXX_TRACE(logger, packetSize << " bytes published to "
-				<< nodeIdsStr.size() << " cNAP(s) under rCID " << rCId.print()
+		LOG4CXX_TRACE(logger, iov[0].iov_len + fragmentSize << " bytes "
+				"published to " << nodeIdsStr.size() << " cNAP(s) under rCID "
+				<< rCId.print()
 				<< ", enigma " << ltpHeaderData.enigma << ", SK "
 				<< ltpHeaderData.sessionKey << ", Sequence "
 				<< ltpHeaderData.sequenceNumber << ", Credit " << credit << " ("
 				<< sentBytes << "/" << dataSize << " sent)");
 		credit--;// decrement credit by one
-		free(packet);
 	}
 
+	message->release();
 	ltpHeaderCtrlWe.sessionKey = ltpHeaderData.sessionKey;
 	ltpHeaderCtrlWe.sequenceNumber = ltpHeaderData.sequenceNumber;
 }
 
-uint16_t Lightweight::_publishData(IcnId &cId, IcnId &rCId, enigma_t &enigma,
-		sk_t &sessionKey, uint8_t *data, uint16_t &dataSize)
-{
-	seq_t sequenceNumber = 0;
-	uint32_t sentBytes = 0;
-	uint16_t fragmentSize = 0;
-	uint8_t *packet;
-	uint16_t packetSize;
-	uint8_t pad = 0;
-	uint16_t credit = _configuration.ltpInitialCredit();
-	// calculate the payload the LTP packet can carry
-	uint32_t mtu = _configuration.mtu() - cId.length() - rCId.length() -
-			_configuration.icnHeaderLength() - sizeof(ltp_hdr_data_t) - 20;
-	mtu = mtu - (mtu % 8);//make it a multiple of 8
-	ltp_hdr_data_t ltpHeaderData;
-	ltpHeaderData.messageType = LTP_DATA;
-	ltpHeaderData.enigma = enigma;
-	ltpHeaderData.sessionKey = sessionKey;// socket FD
-
-	while (sentBytes < dataSize)
-	{
-		if (credit == 0)
-		{
-			LOG4CXX_INFO(logger, "WU + WUD has not been implemented for HTTP"
-					"POST messages as this would block the code. Simply "
-					"sleeping " << _rtt() << "ms");
-			credit = _configuration.ltpInitialCredit();
-//FIXME initialise credit properly (WU+WUD) before continue: blocking code!
-			std::this_thread::sleep_for(std::chrono::milliseconds(_rtt()));
-		}
-
-		sequenceNumber++;
-
-		// another fragment needed
-		if ((dataSize - sentBytes) > mtu)
-		{
-			fragmentSize = mtu;
-			ltpHeaderData.payloadLength = fragmentSize;
-		}
-		// last (or single) fragment
-		else
-		{
-			fragmentSize = dataSize - sentBytes;
-			ltpHeaderData.payloadLength = fragmentSize;
-			// add padding bits, if necessary
-			pad = (fragmentSize % 8);
-
-			if (pad != 0)
-			{
-				pad = 8 - (fragmentSize % 8);
-				fragmentSize += pad;
-				LOG4CXX_TRACE(logger, (int)pad << " padding bits added to make "
-						"fragment a multiple of 8 (" << fragmentSize << ")");
-			}
-		}
-
-		ltpHeaderData.sequenceNumber = sequenceNumber;
-		packetSize = sizeof(ltp_hdr_data_t) + fragmentSize;
-		uint8_t offsetPacket = 0;
-		// Make the packet
-		packet = (uint8_t *)malloc(packetSize);
-		// [1] messageType;
-		memcpy(packet, &ltpHeaderData.messageType,
-				sizeof(ltpHeaderData.messageType));
-		offsetPacket += sizeof(ltpHeaderData.messageType);
-		// [2] enigma
-		memcpy(packet + offsetPacket, &ltpHeaderData.enigma,
-				sizeof(ltpHeaderData.enigma));
-		offsetPacket += sizeof(ltpHeaderData.enigma);
-		// [3] Session key
-		memcpy(packet + offsetPacket,	&ltpHeaderData.sessionKey,
-				sizeof(ltpHeaderData.sessionKey));
-		offsetPacket += sizeof(ltpHeaderData.sessionKey);
-		// [4] Sequence number
-		memcpy(packet + offsetPacket, &ltpHeaderData.sequenceNumber,
-				sizeof(ltpHeaderData.sequenceNumber));
-		offsetPacket += sizeof(ltpHeaderData.sequenceNumber);
-		// [5] Payload length;
-		memcpy(packet + offsetPacket, &ltpHeaderData.payloadLength,
-				sizeof(ltpHeaderData.payloadLength));
-		offsetPacket += sizeof(ltpHeaderData.payloadLength);
-		// now the actual packet
-		memcpy(packet + offsetPacket, data + sentBytes, fragmentSize);
-#ifdef TRAFFIC_CONTROL
-		// Check if TC drop rate should be applied
-		if (!TrafficControl::handle())
-		{
-#endif
-			_icnCoreMutex.lock();
-			_icnCore->publish_data_isub(cId.binIcnId(), DOMAIN_LOCAL, NULL, 0,
-					rCId.binIcnId(), packet, packetSize);
-			_icnCoreMutex.unlock();
-#ifdef TRAFFIC_CONTROL
-		}
-#endif
-
-		sentBytes += (fragmentSize - pad);// remove padding bits
-		credit--;// decrement credit by one
-		LOG4CXX_TRACE(logger, packetSize << " bytes published under CID "
-				<< cId.print() << ", rCID " << rCId.print() << ", enigma "
-				<< ltpHeaderData.enigma << ", SK "
-				<< ltpHeaderData.sessionKey << ", Sequence "
-				<< ltpHeaderData.sequenceNumber << ", Credit " << credit
-				<< " ("	<< sentBytes << "/" << dataSize << " sent)");
-		_bufferProxyPacket(cId, rCId, ltpHeaderData, packet,
-				packetSize);
-		free(packet);
-	}
-
-	_publishWindowEnd(cId, rCId, enigma, sessionKey, sequenceNumber);
-	return sequenceNumber;
-}
-
 void Lightweight::_publishDataRange(IcnId &rCid,
-		ltp_hdr_ctrl_nack_t &ltpCtrlNack)
+		ltp_hdr_ctrl_nack_t &ltpCtrlNack, ltp_sequences_t &sequences,
+		uint8_t version)
 {
 	// First get the CID for the given rCID
 	IcnId cid;
@@ -4159,74 +3968,67 @@ void Lightweight::_publishDataRange(IcnId &rCid,
 
 	cid = _cIdReverseLookUpIt->second;
 	_cIdReverseLookUpMutex.unlock();
+	// an sNAP sending v1 NACKs cannot read LTP_DATA_V2
+	_ltpVersion(cid, version);
 	_proxyPacketBufferMutex.lock();
-	_proxyPacketBufferIt = _proxyPacketBuffer.find(rCid.uint());
-
-	//rCID not found
-	if (_proxyPacketBufferIt == _proxyPacketBuffer.end())
-	{
-		LOG4CXX_WARN(logger, "rCID " << rCid.print() << " does not exist in LTP"
-				" proxy buffer");
-		_proxyPacketBufferMutex.unlock();
-		return;
-	}
-
-	map<enigma_t, map<sk_t, map<seq_t, pair<uint8_t *, uint16_t>>>>::iterator
-			enigmaIt;
-	enigmaIt = _proxyPacketBufferIt->second.find(ltpCtrlNack.enigma);
-
-	// enigma not found
-	if (enigmaIt == _proxyPacketBufferIt->second.end())
-	{
-		LOG4CXX_WARN(logger, "enigma " << ltpCtrlNack.enigma << " does not "
-				"exist in LTP proxy buffer for rCID " << rCid.print());
-		_proxyPacketBufferMutex.unlock();
-		return;
-	}
-
-	map<sk_t, map<seq_t, pair<uint8_t *, uint16_t>>>::iterator skIt;
-	skIt = enigmaIt->second.find(ltpCtrlNack.sessionKey);
+	ltp_session_buffer_t *session = _proxyPacketBuffer.find(rCid.uint(),
+			ltpCtrlNack.enigma, ltpCtrlNack.sessionKey);
 
-	if (skIt == enigmaIt->second.end())
+	// rCID > enigma > SK not found
+	if (session == NULL)
 	{
-		LOG4CXX_WARN(logger, "SK " << ltpCtrlNack.sessionKey << " does not "
-				"exist in LTP proxy buffer for rCID " << rCid.print()
-				<< " > enigma " << ltpCtrlNack.enigma);
+		LOG4CXX_WARN(logger, "rCID " << rCid.print() << " > enigma "
+				<< ltpCtrlNack.enigma << " > SK " << ltpCtrlNack.sessionKey
+				<< " does not exist in LTP proxy buffer");
 		_proxyPacketBufferMutex.unlock();
 		return;
 	}
 
-	seq_t sequence = 0;
+	ltp_sequences_t::iterator it;
 	list<string> nodeIds;
 	nodeIds.push_back(_configuration.nodeId().str());
-	map<seq_t, pair<uint8_t *, uint16_t>>::iterator snIt;
+	ltp_packet_slot_t *slot;
+	ltp_hdr_data_t ltpHeaderData;
+	uint8_t header[LTP_DATA_HEADER_LENGTH_V2];
+	struct iovec iov[2];
+	ltpHeaderData.messageType = (_ltpVersion(cid) >= 2) ? LTP_DATA_V2 :
+			LTP_DATA;
+	ltpHeaderData.enigma = ltpCtrlNack.enigma;
+	ltpHeaderData.sessionKey = ltpCtrlNack.sessionKey;
 
-	// iterate over the LTP buffer and re-publish the range of fragments
-	for (sequence = ltpCtrlNack.start; sequence <= ltpCtrlNack.end; sequence++)
+	// re-publish the missing fragments only
+	for (it = sequences.begin(); it != sequences.end(); it++)
 	{
-		snIt = skIt->second.find(sequence);
+		slot = _proxyPacketBuffer.slot(session, *it);
 
-		if (snIt == skIt->second.end())
+		if (slot == NULL)
 		{
-			LOG4CXX_ERROR(logger, "Sequence number " << sequence << " is "
+			LOG4CXX_ERROR(logger, "Sequence number " << *it << " is "
 					"missing in LTP buffer for rCID " << rCid.print()
 					<< " > enigma " << ltpCtrlNack.enigma << " > SK "
 					<< ltpCtrlNack.sessionKey);
-			break;
+			continue;
 		}
+
+		ltpHeaderData.sequenceNumber = *it;
+		ltpHeaderData.payloadLength = slot->payloadLength;
+		iov[0].iov_base = header;
+		iov[0].iov_len = _serialiseDataHeader(ltpHeaderData, header);
+		iov[1].iov_base = slot->payload;
+		iov[1].iov_len = slot->fragmentSize;
 #ifdef TRAFFIC_CONTROL
 		if (!TrafficControl::handle())
 		{
 #endif
 			_icnCoreMutex.lock();
 			_icnCore->publish_data(rCid.binIcnId(), DOMAIN_LOCAL, NULL, 0,
-					nodeIds, snIt->second.first, snIt->second.second);
+					nodeIds, iov, 2);
 			_icnCoreMutex.unlock();
 #ifdef TRAFFIC_CONTROL
 		}
 #endif
-		LOG4CXX_TRACE(logger, "Packet of total length " << snIt->second.second
-				<< " with Sequence " << sequence << " re-published under rCID "
+		LOG4CXX_TRACE(logger, "Fragment of length " << slot->fragmentSize
+				<< " with Sequence " << *it << " re-published under rCID "
 				<< rCid.print() << " > enigma " << ltpCtrlNack.enigma
 				<< " > SK " << ltpCtrlNack.sessionKey);
 	}
@@ -4237,37 +4039,21 @@ void Lightweight::_publishDataRange(IcnId &rCid,
 void Lightweight::_publishDataRange(IcnId &rCid, enigma_t &enigma,
 			sk_t &sessionKey, nack_group_t &nackGroup)
 {
-	map<cid_t, map<enigma_t, map<sk_t, map<seq_t, packet_t>>>>::iterator rCidIt;
-	map<enigma_t, map<sk_t, map<seq_t, packet_t>>>::iterator enigmaIt;
-	map<sk_t, map<seq_t, packet_t>>::iterator skIt;
-	map<seq_t, packet_t>::iterator snIt;
+	ltp_packet_slot_t *slot;
+	ltp_sequences_t::iterator it;
+	ltp_hdr_data_t ltpHeaderData;
+	uint8_t header[LTP_DATA_HEADER_LENGTH_V2];
+	struct iovec iov[2];
+	ltpHeaderData.messageType = (_ltpVersion(nackGroup.nodeIds) >= 2) ?
+			LTP_DATA_V2 : LTP_DATA;
+	ltpHeaderData.enigma = enigma;
+	ltpHeaderData.sessionKey = sessionKey;
 	_ltpPacketBufferMutex.lock();
-	rCidIt = _ltpPacketBuffer.find(rCid.uint());
-
-	// rCID not found
-	if (rCidIt == _ltpPacketBuffer.end())
-	{
-		LOG4CXX_ERROR(logger, "rCID " << rCid.print() << " not found in LTP "
-				"packet buffer");
-		_ltpPacketBufferMutex.unlock();
-		return;
-	}
-
-	enigmaIt = rCidIt->second.find(enigma);
-
-	// enigma not found
-	if (enigmaIt == rCidIt->second.end())
-	{
-		LOG4CXX_ERROR(logger, "rCID " << rCid.print() << " > enigma "
-				<< enigma << " not found in LTP packet buffer");
-		_ltpPacketBufferMutex.unlock();
-		return;
-	}
-
-	skIt = enigmaIt->second.find(sessionKey);
+	ltp_session_buffer_t *session = _ltpPacketBuffer.find(rCid.uint(),
+			enigma, sessionKey);
 
-	// SK not found
-	if (skIt == enigmaIt->second.end())
+	// rCID > enigma > SK not found
+	if (session == NULL)
 	{
 		LOG4CXX_ERROR(logger, "rCID " << rCid.print() << " > enigma "
 				<< enigma << " > SK " << sessionKey << " not found in LTP "
@@ -4287,36 +4073,42 @@ void Lightweight::_publishDataRange(IcnId &rCid, enigma_t &enigma,
 		nodeIdsOss << it->uint() << " ";
 	}
 
-	// Iterate over the range of sequence number for rCID > enigma > SK and
-	// re-publish the packets
-	for (seq_t sequence = nackGroup.startSequence;
-			sequence <= nackGroup.endSequence; sequence++)
+	// Iterate over the sequence numbers any NID of the NACK group is missing
+	// for rCID > enigma > SK and re-publish the packets
+	for (it = nackGroup.sequences.begin(); it != nackGroup.sequences.end();
+			it++)
 	{
-		snIt = skIt->second.find(sequence);
+		slot = _ltpPacketBuffer.slot(session, *it);
 
-		if (snIt == skIt->second.end())
+		if (slot == NULL)
 		{
-			LOG4CXX_ERROR(logger, "Sequence number " << sequence << " is "
+			LOG4CXX_ERROR(logger, "Sequence number " << *it << " is "
 					"missing in LTP buffer for rCID " << rCid.print()
 					<< " > enigma " << enigma << " > SK " << sessionKey
-					<< ". Total number of packets: " << skIt->second.size());
-			break;
+					<< ". Total number of packets: " << session->packets);
+			continue;
 		}
 
+		ltpHeaderData.sequenceNumber = *it;
+		ltpHeaderData.payloadLength = slot->payloadLength;
+		iov[0].iov_base = header;
+		iov[0].iov_len = _serialiseDataHeader(ltpHeaderData, header);
+		iov[1].iov_base = slot->payload;
+		iov[1].iov_len = slot->fragmentSize;
 #ifdef TRAFFIC_CONTROL
 		if (!TrafficControl::handle())
 		{
 #endif
 			_icnCoreMutex.lock();
 			_icnCore->publish_data(rCid.binIcnId(), DOMAIN_LOCAL, NULL, 0,
-					nodeIds, snIt->second.packet, snIt->second.packetSize);
+					nodeIds, iov, 2);
 			_icnCoreMutex.unlock();
 #ifdef TRAFFIC_CONTROL
 		}
 #endif
 
-		LOG4CXX_TRACE(logger, "Packet of total length "
-				<< snIt->second.packetSize << " with Sequence " << sequence
+		LOG4CXX_TRACE(logger, "Fragment of length "
+				<< slot->fragmentSize << " with Sequence " << *it
 				<< " re-published under rCID " << rCid.print() << " > enigma "
 				<< enigma << " > SK " << sessionKey << " to "
 				<< nodeIds.size() << " NIDs: " << nodeIdsOss.str());
@@ -4326,41 +4118,12 @@ void Lightweight::_publishDataRange(IcnId &rCid, enigma_t &enigma,
 }
 
 void Lightweight::_publishNegativeAcknowledgement(IcnId &rCid, NodeId &nodeId,
-		enigma_t &enigma, sk_t &sessionKey, seq_t &firstMissingSequence,
-		seq_t &lastMissingSequence)
+		enigma_t &enigma, sk_t &sessionKey, ltp_sequences_t &sequences,
+		uint8_t version)
 {
-	ltp_hdr_ctrl_nack_t ltpHeaderControlNack;
-	ltpHeaderControlNack.messageType = LTP_CONTROL;
-	ltpHeaderControlNack.controlType = LTP_CONTROL_NACK;
-	ltpHeaderControlNack.enigma = enigma;
-	ltpHeaderControlNack.sessionKey = sessionKey;
-	ltpHeaderControlNack.start = firstMissingSequence;
-	ltpHeaderControlNack.end = lastMissingSequence;
-	uint8_t *packet = (uint8_t *)malloc(sizeof(ltp_hdr_ctrl_nack_t));
-	uint8_t offset = 0;
-	// [1] Message type
-	memcpy(packet, &ltpHeaderControlNack.messageType,
-			sizeof(ltpHeaderControlNack.messageType));
-	offset += sizeof(ltpHeaderControlNack.messageType);
-	// [2] Control type
-	memcpy(packet + offset, &ltpHeaderControlNack.controlType,
-			sizeof(ltpHeaderControlNack.controlType));
-	offset += sizeof(ltpHeaderControlNack.controlType);
-	// [3] enigma
-	memcpy(packet + offset, &ltpHeaderControlNack.enigma,
-			sizeof(ltpHeaderControlNack.enigma));
-	offset += sizeof(ltpHeaderControlNack.enigma);
-	// [4] SK
-	memcpy(packet + offset, &ltpHeaderControlNack.sessionKey,
-			sizeof(ltpHeaderControlNack.sessionKey));
-	offset += sizeof(ltpHeaderControlNack.sessionKey);
-	// [5] Start sequence number
-	memcpy(packet + offset, &ltpHeaderControlNack.start,
-			sizeof(ltpHeaderControlNack.start));
-	offset += sizeof(ltpHeaderControlNack.start);
-	// [6] End sequence number
-	memcpy(packet + offset, &ltpHeaderControlNack.end,
-			sizeof(ltpHeaderControlNack.end));
+	uint8_t packet[LTP_CTRL_SACK_LENGTH + LTP_SACK_MAX_BITMAP];
+	uint16_t packetSize = _serialiseNegativeAcknowledgement(enigma,
+			sessionKey, sequences, version, packet);
 	list<string> nodeIds;
 	nodeIds.push_back(nodeId.str());
 
@@ -4370,56 +4133,26 @@ void Lightweight::_publishNegativeAcknowledgement(IcnId &rCid, NodeId &nodeId,
 #endif
 		_icnCoreMutex.lock();
 		_icnCore->publish_data(rCid.binIcnId(), DOMAIN_LOCAL, NULL, 0, nodeIds,
-				packet, sizeof(ltp_hdr_ctrl_nack_t));
+				packet, packetSize);
 		_icnCoreMutex.unlock();
 #ifdef TRAFFIC_CONTROL
 	}
 #endif
 
-	LOG4CXX_TRACE(logger, "CTRL-NACK for Sequence range "
-			<< firstMissingSequence << " - " << lastMissingSequence
-			<< " published to rCID " << rCid.print() << " > NID "
-			<< nodeId.uint() << " > enigma " << enigma << " > SK "
-			<< sessionKey);
-	free(packet);
+	LOG4CXX_TRACE(logger, "CTRL-" << ((version >= 2) ? "SACK" : "NACK")
+			<< " for Sequence range " << *sequences.begin() << " - "
+			<< *sequences.rbegin() << " published to rCID " << rCid.print()
+			<< " > NID " << nodeId.uint() << " > enigma " << enigma
+			<< " > SK " << sessionKey);
 }
 
 void Lightweight::_publishNegativeAcknowledgement(IcnId &cid, IcnId &rCid,
-		enigma_t &enigma, sk_t &sessionKey, seq_t &firstMissingSequence,
-		seq_t &lastMissingSequence)
+		enigma_t &enigma, sk_t &sessionKey, ltp_sequences_t &sequences,
+		uint8_t version)
 {
-	ltp_hdr_ctrl_nack_t ltpHeaderControlNack;
-	ltpHeaderControlNack.messageType = LTP_CONTROL;
-	ltpHeaderControlNack.controlType = LTP_CONTROL_NACK;
-	ltpHeaderControlNack.enigma = enigma;
-	ltpHeaderControlNack.sessionKey = sessionKey;
-	ltpHeaderControlNack.start = firstMissingSequence;
-	ltpHeaderControlNack.end = lastMissingSequence;
-	uint8_t *packet = (uint8_t *)malloc(sizeof(ltp_hdr_ctrl_nack_t));
-	uint8_t offset = 0;
-	// [1] Message type
-	memcpy(packet, &ltpHeaderControlNack.messageType,
-			sizeof(ltpHeaderControlNack.messageType));
-	offset += sizeof(ltpHeaderControlNack.messageType);
-	// [2] Control type
-	memcpy(packet + offset, &ltpHeaderControlNack.controlType,
-			sizeof(ltpHeaderControlNack.controlType));
-	offset += sizeof(ltpHeaderControlNack.controlType);
-	// [3] enigma
-	memcpy(packet + offset, &ltpHeaderControlNack.enigma,
-			sizeof(ltpHeaderControlNack.enigma));
-	offset += sizeof(ltpHeaderControlNack.enigma);
-	// [4] SK
-	memcpy(packet + offset, &ltpHeaderControlNack.sessionKey,
-			sizeof(ltpHeaderControlNack.sessionKey));
-	offset += sizeof(ltpHeaderControlNack.sessionKey);
-	// [5] Start sequence number
-	memcpy(packet + offset, &ltpHeaderControlNack.start,
-			sizeof(ltpHeaderControlNack.start));
-	offset += sizeof(ltpHeaderControlNack.start);
-	// [6] End sequence number
-	memcpy(packet + offset, &ltpHeaderControlNack.end,
-			sizeof(ltpHeaderControlNack.end));
+	uint8_t packet[LTP_CTRL_SACK_LENGTH + LTP_SACK_MAX_BITMAP];
+	uint16_t packetSize = _serialiseNegativeAcknowledgement(enigma,
+			sessionKey, sequences, version, packet);
 
 #ifdef TRAFFIC_CONTROL
 	if (!TrafficControl::handle())
@@ -4427,18 +4160,17 @@ void Lightweight::_publishNegativeAcknowledgement(IcnId &cid, IcnId &rCid,
 #endif
 		_icnCoreMutex.lock();
 		_icnCore->publish_data_isub(cid.binIcnId(), DOMAIN_LOCAL, NULL, 0,
-					rCid.binIcnId(), packet, sizeof(ltp_hdr_ctrl_nack_t));
+					rCid.binIcnId(), packet, packetSize);
 		_icnCoreMutex.unlock();
 #ifdef TRAFFIC_CONTROL
 	}
 #endif
 
-	LOG4CXX_TRACE(logger, "CTRL-NACK for Sequence range "
-			<< firstMissingSequence << " - " << lastMissingSequence
-			<< " published to CID " << cid.print() << " for rCID "
-			<< rCid.print() << " > enigma " << enigma << " > SK "
-			<< sessionKey);
-	free(packet);
+	LOG4CXX_TRACE(logger, "CTRL-" << ((version >= 2) ? "SACK" : "NACK")
+			<< " for Sequence range " << *sequences.begin() << " - "
+			<< *sequences.rbegin() << " published to CID " << cid.print()
+			<< " for rCID " << rCid.print() << " > enigma " << enigma
+			<< " > SK " << sessionKey);
 }
 
 void Lightweight::_publishReset(IcnId &cid, IcnId &rCid)
@@ -4697,7 +4429,9 @@ void Lightweight::_publishWindowEnd(IcnId &rCId, list<NodeId> &nodeIds,
 	list<string> nodeIdsStr;
 	list<NodeId>::iterator nodeIdsIt;
 	uint8_t *packet;
-	uint16_t packetSize = sizeof(ltp_hdr_ctrl_we_t);
+	uint16_t packetSize = LTP_CTRL_WE_LENGTH;
+	uint16_t offset = 0;
+	uint16_t sequenceNumber;
 	for (nodeIdsIt = nodeIds.begin(); nodeIdsIt != nodeIds.end(); nodeIdsIt++)
 	{
 		nodeIdsStr.push_back(nodeIdsIt->str());
@@ -4707,26 +4441,45 @@ void Lightweight::_publishWindowEnd(IcnId &rCId, list<NodeId> &nodeIds,
 	ltpHeader.controlType = LTP_CONTROL_WINDOW_END;
 	// first create WED boolean so that there's no potential raise condition
 	_addWindowEnd(rCId, nodeIds, ltpHeader);
+	ltpHeader.version = _configuration.ltpVersion();
+
+	// v2 appends the version and the 32-bit sequence number
+	if (ltpHeader.version >= 2)
+	{
+		packetSize += sizeof(ltpHeader.version)
+				+ sizeof(ltpHeader.sequenceNumber);
+	}
+
 	// make packet
 	packet = (uint8_t *)malloc(packetSize);
 	// [1] messageType
 	memcpy(packet, &ltpHeader.messageType, sizeof(ltpHeader.messageType));
+	offset += sizeof(ltpHeader.messageType);
 	// [2] controlType
-	memcpy(packet + sizeof(ltpHeader.messageType), &ltpHeader.controlType,
+	memcpy(packet + offset, &ltpHeader.controlType,
 			sizeof(ltpHeader.controlType));
+	offset += sizeof(ltpHeader.controlType);
 	// [3] enigma
-	memcpy(packet + sizeof(ltpHeader.messageType)
-			+ sizeof(ltpHeader.controlType), &ltpHeader.enigma,
-			sizeof(ltpHeader.enigma));
+	memcpy(packet + offset, &ltpHeader.enigma, sizeof(ltpHeader.enigma));
+	offset += sizeof(ltpHeader.enigma);
 	// [4] session key
-	memcpy(packet + sizeof(ltpHeader.messageType)
-			+ sizeof(ltpHeader.controlType) + sizeof(ltpHeader.enigma),
-			&ltpHeader.sessionKey,	sizeof(ltpHeader.sessionKey));
-	// [5] sequenceNumber
-	memcpy(packet + sizeof(ltpHeader.messageType)
-				+ sizeof(ltpHeader.controlType) + sizeof(ltpHeader.enigma)
-				+ sizeof(ltpHeader.sessionKey), &ltpHeader.sequenceNumber,
+	memcpy(packet + offset, &ltpHeader.sessionKey,
+			sizeof(ltpHeader.sessionKey));
+	offset += sizeof(ltpHeader.sessionKey);
+	// [5] sequenceNumber (16 bit)
+	sequenceNumber = ltpHeader.sequenceNumber;
+	memcpy(packet + offset, &sequenceNumber, sizeof(sequenceNumber));
+	offset += sizeof(sequenceNumber);
+
+	// [6] v2: version and sequenceNumber (32 bit)
+	if (ltpHeader.version >= 2)
+	{
+		memcpy(packet + offset, &ltpHeader.version,
+				sizeof(ltpHeader.version));
+		offset += sizeof(ltpHeader.version);
+		memcpy(packet + offset, &ltpHeader.sequenceNumber,
 				sizeof(ltpHeader.sequenceNumber));
+	}
 
 #ifdef TRAFFIC_CONTROL
 	if (!TrafficControl::handle())
@@ -4753,33 +4506,54 @@ void Lightweight::_publishWindowEnd(IcnId &cId, IcnId &rCId,
 {
 	ltp_hdr_ctrl_we_t ltpHeader;
 	uint8_t *packet;
-	uint16_t packetSize = sizeof(ltp_hdr_ctrl_we_t);
+	uint16_t packetSize = LTP_CTRL_WE_LENGTH;
+	uint16_t offset = 0;
+	uint16_t sequenceNumber16;
 	// Fill up the LTP CTRL header
 	ltpHeader.messageType = LTP_CONTROL;
 	ltpHeader.controlType = LTP_CONTROL_WINDOW_END;
 	ltpHeader.enigma = enigma;
 	ltpHeader.sessionKey = sessionKey;
 	ltpHeader.sequenceNumber = sequenceNumber;
+	ltpHeader.version = _configuration.ltpVersion();
+
+	// v2 appends the version and the 32-bit sequence number
+	if (ltpHeader.version >= 2)
+	{
+		packetSize += sizeof(ltpHeader.version)
+				+ sizeof(ltpHeader.sequenceNumber);
+	}
+
 	// make packet
 	packet = (uint8_t *)malloc(packetSize);
 	// [1] messageType
 	memcpy(packet, &ltpHeader.messageType, sizeof(ltpHeader.messageType));
+	offset += sizeof(ltpHeader.messageType);
 	// [2] controlType
-	memcpy(packet + sizeof(ltpHeader.messageType), &ltpHeader.controlType,
+	memcpy(packet + offset, &ltpHeader.controlType,
 			sizeof(ltpHeader.controlType));
+	offset += sizeof(ltpHeader.controlType);
 	// [3] enigma
-	memcpy(packet + sizeof(ltpHeader.messageType)
-			+ sizeof(ltpHeader.controlType), &ltpHeader.enigma,
-			sizeof(ltpHeader.enigma));
+	memcpy(packet + offset, &ltpHeader.enigma, sizeof(ltpHeader.enigma));
+	offset += sizeof(ltpHeader.enigma);
 	// [4] session key
-	memcpy(packet + sizeof(ltpHeader.messageType)
-			+ sizeof(ltpHeader.controlType) + sizeof(ltpHeader.enigma),
-			&ltpHeader.sessionKey,	sizeof(ltpHeader.sessionKey));
-	// [5] sequenceNumber
-	memcpy(packet + sizeof(ltpHeader.messageType)
-				+ sizeof(ltpHeader.controlType) + sizeof(ltpHeader.enigma)
-				+ sizeof(ltpHeader.sessionKey), &ltpHeader.sequenceNumber,
+	memcpy(packet + offset, &ltpHeader.sessionKey,
+			sizeof(ltpHeader.sessionKey));
+	offset += sizeof(ltpHeader.sessionKey);
+	// [5] sequenceNumber (16 bit)
+	sequenceNumber16 = ltpHeader.sequenceNumber;
+	memcpy(packet + offset, &sequenceNumber16, sizeof(sequenceNumber16));
+	offset += sizeof(sequenceNumber16);
+
+	// [6] v2: version and sequenceNumber (32 bit)
+	if (ltpHeader.version >= 2)
+	{
+		memcpy(packet + offset, &ltpHeader.version,
+				sizeof(ltpHeader.version));
+		offset += sizeof(ltpHeader.version);
+		memcpy(packet + offset, &ltpHeader.sequenceNumber,
 				sizeof(ltpHeader.sequenceNumber));
+	}
 
 #ifdef TRAFFIC_CONTROL
 	if (!TrafficControl::handle())
@@ -4803,7 +4577,16 @@ void Lightweight::_publishWindowEnd(IcnId &cId, IcnId &rCId,
 void Lightweight::_publishWindowEnded(IcnId &cid, IcnId &rCid,
 			ltp_hdr_ctrl_wed_t &ltpHeaderCtrlWed)
 {
-	uint8_t *packet = (uint8_t *)malloc(sizeof(ltp_hdr_ctrl_wed_t));
+	uint16_t packetSize = LTP_CTRL_WED_LENGTH;
+	ltpHeaderCtrlWed.version = _configuration.ltpVersion();
+
+	// v2 appends the version
+	if (ltpHeaderCtrlWed.version >= 2)
+	{
+		packetSize += sizeof(ltpHeaderCtrlWed.version);
+	}
+
+	uint8_t *packet = (uint8_t *)calloc(1, packetSize);
 	uint8_t offset = 0;
 	ltpHeaderCtrlWed.messageType = LTP_CONTROL;
 	ltpHeaderCtrlWed.controlType = LTP_CONTROL_WINDOW_ENDED;
@@ -4823,13 +4606,20 @@ void Lightweight::_publishWindowEnded(IcnId &cid, IcnId &rCid,
 	memcpy(packet + offset, &ltpHeaderCtrlWed.sessionKey,
 			sizeof(ltpHeaderCtrlWed.sessionKey));
 
+	// [5] v2: version (after two octets of padding)
+	if (ltpHeaderCtrlWed.version >= 2)
+	{
+		memcpy(packet + LTP_CTRL_WED_LENGTH, &ltpHeaderCtrlWed.version,
+				sizeof(ltpHeaderCtrlWed.version));
+	}
+
 #ifdef TRAFFIC_CONTROL
 	if (!TrafficControl::handle())
 	{
 #endif
 		_icnCoreMutex.lock();
 		_icnCore->publish_data_isub(cid.binIcnId(), DOMAIN_LOCAL, NULL, 0,
-				rCid.binIcnId(), packet, sizeof(ltp_hdr_ctrl_wed_t));
+				rCid.binIcnId(), packet, packetSize);
 		_icnCoreMutex.unlock();
 #ifdef TRAFFIC_CONTROL
 	}
@@ -4854,7 +4644,16 @@ void Lightweight::_publishWindowEnded(IcnId &rCId, NodeId &nodeId,
 
 	ltp_hdr_ctrl_wed_t ltpHeader;
 	list<string> nodeIdList;
-	uint8_t *packet = (uint8_t *)malloc(sizeof(ltp_hdr_ctrl_wed_t));
+	uint16_t packetSize = LTP_CTRL_WED_LENGTH;
+	ltpHeader.version = _configuration.ltpVersion();
+
+	// v2 appends the version
+	if (ltpHeader.version >= 2)
+	{
+		packetSize += sizeof(ltpHeader.version);
+	}
+
+	uint8_t *packet = (uint8_t *)calloc(1, packetSize);
 	ltpHeader.messageType = LTP_CONTROL;
 	ltpHeader.controlType = LTP_CONTROL_WINDOW_ENDED;
 	ltpHeader.enigma = enigma;
@@ -4872,6 +4671,14 @@ void Lightweight::_publishWindowEnded(IcnId &rCId, NodeId &nodeId,
 	memcpy(packet + sizeof(ltpHeader.messageType)
 			+ sizeof(ltpHeader.controlType) + sizeof(ltpHeader.enigma),
 			&ltpHeader.sessionKey, sizeof(ltpHeader.sessionKey));
+
+	// [5] v2: version (after two octets of padding)
+	if (ltpHeader.version >= 2)
+	{
+		memcpy(packet + LTP_CTRL_WED_LENGTH, &ltpHeader.version,
+				sizeof(ltpHeader.version));
+	}
+
 	nodeIdList.push_back(nodeId.str());
 
 #ifdef TRAFFIC_CONTROL
@@ -4880,7 +4687,7 @@ void Lightweight::_publishWindowEnded(IcnId &rCId, NodeId &nodeId,
 #endif
 		_icnCoreMutex.lock();
 		_icnCore->publish_data(rCId.binIcnId(), DOMAIN_LOCAL, NULL, 0,
-				nodeIdList, packet, sizeof(ltp_hdr_ctrl_wed_t));
+				nodeIdList, packet, packetSize);
 		_icnCoreMutex.unlock();
 #ifdef TRAFFIC_CONTROL
 	}
@@ -4958,6 +4765,47 @@ void Lightweight::_publishWindowUpdate(IcnId &rCid, enigma_t &enigma,
 	free(packet);
 }
 
+void Lightweight::_publishWindowUpdate(IcnId &cId, IcnId &rCId,
+		enigma_t &enigma, sk_t &sessionKey)
+{
+	ltp_hdr_ctrl_wu_t ltpHeader;
+	uint8_t *packet = (uint8_t *)malloc(sizeof(ltp_hdr_ctrl_wu_t));
+	ltpHeader.messageType = LTP_CONTROL;
+	ltpHeader.controlType = LTP_CONTROL_WINDOW_UPDATE;
+	ltpHeader.enigma = enigma;
+	ltpHeader.sessionKey = sessionKey;
+	// [1] message type
+	memcpy(packet, &ltpHeader.messageType, sizeof(ltpHeader.messageType));
+	// [2] control type
+	memcpy(packet + sizeof(ltpHeader.messageType), &ltpHeader.controlType,
+			sizeof(ltpHeader.controlType));
+	// [3] enigma
+	memcpy(packet + sizeof(ltpHeader.messageType)
+			+ sizeof(ltpHeader.controlType), &ltpHeader.enigma,
+			sizeof(ltpHeader.enigma));
+	// [4] Session key
+	memcpy(packet + sizeof(ltpHeader.messageType)
+			+ sizeof(ltpHeader.controlType) + sizeof(ltpHeader.enigma),
+			&ltpHeader.sessionKey, sizeof(ltpHeader.sessionKey));
+
+#ifdef TRAFFIC_CONTROL
+	if (!TrafficControl::handle())
+	{
+#endif
+		_icnCoreMutex.lock();
+		_icnCore->publish_data_isub(cId.binIcnId(), DOMAIN_LOCAL, NULL, 0,
+				rCId.binIcnId(), packet, sizeof(ltp_hdr_ctrl_wu_t));
+		_icnCoreMutex.unlock();
+#ifdef TRAFFIC_CONTROL
+	}
+#endif
+
+	LOG4CXX_TRACE(logger, "LTP CTRL-WU published under CID " << cId.print()
+			<< " with rCID " << rCId.print() << " > enigma " << enigma
+			<< " > SK " << sessionKey);
+	free(packet);
+}
+
 void Lightweight::_publishWindowUpdated(IcnId &cid, IcnId &rCid,
 		ltp_hdr_ctrl_wud_t &ltpHeaderControlWud)
 {
@@ -4997,6 +4845,160 @@ void Lightweight::_publishWindowUpdated(IcnId &cid, IcnId &rCid,
 	free(packet);
 }
 
+void Lightweight::_publishWindowUpdated(IcnId &rCId, NodeId &nodeId,
+		ltp_hdr_ctrl_wud_t &ltpHeaderControlWud)
+{
+	if (!_forwardingEnabled(nodeId))
+	{
+		LOG4CXX_DEBUG(logger, "WUD message could not be published. Forwarding "
+				"state for NID " << nodeId.uint() << " is still disabled");
+		return;
+	}
+
+	list<string> nodeIdList;
+	uint8_t *packet = (uint8_t *)malloc(sizeof(ltp_hdr_ctrl_wud_t));
+	uint8_t offset = 0;
+	// [1] message type
+	memcpy(packet, &ltpHeaderControlWud.messageType,
+			sizeof(ltpHeaderControlWud.messageType));
+	offset += sizeof(ltpHeaderControlWud.messageType);
+	// [2] control type
+	memcpy(packet + offset, &ltpHeaderControlWud.controlType,
+			sizeof(ltpHeaderControlWud.controlType));
+	offset += sizeof(ltpHeaderControlWud.controlType);
+	// [3] enigma
+	memcpy(packet + offset, &ltpHeaderControlWud.enigma,
+			sizeof(ltpHeaderControlWud.enigma));
+	offset += sizeof(ltpHeaderControlWud.enigma);
+	// [4] Session key
+	memcpy(packet + offset, &ltpHeaderControlWud.sessionKey,
+			sizeof(ltpHeaderControlWud.sessionKey));
+	nodeIdList.push_back(nodeId.str());
+#ifdef TRAFFIC_CONTROL
+	if (!TrafficControl::handle())
+	{
+#endif
+		_icnCoreMutex.lock();
+		_icnCore->publish_data(rCId.binIcnId(), DOMAIN_LOCAL, NULL, 0,
+				nodeIdList, packet, sizeof(ltp_hdr_ctrl_wud_t));
+		_icnCoreMutex.unlock();
+#ifdef TRAFFIC_CONTROL
+	}
+#endif
+
+	LOG4CXX_TRACE(logger, "LTP CTRL-WUD published to NID " << nodeId.uint()
+			<< " under rCID " << rCId.print() << " > enigma "
+			<< ltpHeaderControlWud.enigma << " > SK "
+			<< ltpHeaderControlWud.sessionKey);
+	free(packet);
+}
+
+uint8_t Lightweight::_serialiseDataHeader(ltp_hdr_data_t &ltpHeaderData,
+		uint8_t *header)
+{
+	uint8_t offset = 0;
+	// [1] messageType;
+	memcpy(header, &ltpHeaderData.messageType,
+			sizeof(ltpHeaderData.messageType));
+	offset += sizeof(ltpHeaderData.messageType);
+	// [2] enigma
+	memcpy(header + offset, &ltpHeaderData.enigma,
+			sizeof(ltpHeaderData.enigma));
+	offset += sizeof(ltpHeaderData.enigma);
+	// [3] Session key
+	memcpy(header + offset, &ltpHeaderData.sessionKey,
+			sizeof(ltpHeaderData.sessionKey));
+	offset += sizeof(ltpHeaderData.sessionKey);
+	// [4] Sequence number (32 bit in v2)
+	if (ltpHeaderData.messageType == LTP_DATA_V2)
+	{
+		memcpy(header + offset, &ltpHeaderData.sequenceNumber,
+				sizeof(ltpHeaderData.sequenceNumber));
+		offset += sizeof(ltpHeaderData.sequenceNumber);
+	}
+	else
+	{
+		uint16_t sequenceNumber = ltpHeaderData.sequenceNumber;
+		memcpy(header + offset, &sequenceNumber, sizeof(sequenceNumber));
+		offset += sizeof(sequenceNumber);
+	}
+
+	// [5] Payload length;
+	memcpy(header + offset, &ltpHeaderData.payloadLength,
+			sizeof(ltpHeaderData.payloadLength));
+	offset += sizeof(ltpHeaderData.payloadLength);
+	return offset;
+}
+
+uint16_t Lightweight::_serialiseNegativeAcknowledgement(enigma_t enigma,
+		sk_t sessionKey, ltp_sequences_t &sequences, uint8_t version,
+		uint8_t *packet)
+{
+	uint16_t offset = 0;
+	ltp_hdr_ctrl_nack_t ltpHeaderControlNack;
+	ltpHeaderControlNack.controlType = (version >= 2) ? LTP_CONTROL_SACK :
+			LTP_CONTROL_NACK;
+	// [1] Message type
+	memcpy(packet, &ltpHeaderControlNack.messageType,
+			sizeof(ltpHeaderControlNack.messageType));
+	offset += sizeof(ltpHeaderControlNack.messageType);
+	// [2] Control type
+	memcpy(packet + offset, &ltpHeaderControlNack.controlType,
+			sizeof(ltpHeaderControlNack.controlType));
+	offset += sizeof(ltpHeaderControlNack.controlType);
+	// [3] enigma
+	memcpy(packet + offset, &enigma, sizeof(enigma));
+	offset += sizeof(enigma);
+	// [4] SK
+	memcpy(packet + offset, &sessionKey, sizeof(sessionKey));
+	offset += sizeof(sessionKey);
+
+	// CTRL-NACK: [5] start [6] end sequence number (16 bit each). The NACK
+	// covers all fragments between the first and the last missing one
+	if (version < 2)
+	{
+		uint16_t start = *sequences.begin();
+		uint16_t end = *sequences.rbegin();
+		memcpy(packet + offset, &start, sizeof(start));
+		offset += sizeof(start);
+		memcpy(packet + offset, &end, sizeof(end));
+		return LTP_CTRL_NACK_LENGTH;
+	}
+
+	// CTRL-SACK: [5] start [6] bitmap length [7] bitmap
+	ltp_hdr_ctrl_sack_t ltpHeaderSack;
+	ltp_sequences_t::iterator it;
+	ltpHeaderSack.start = *sequences.begin();
+	ltpHeaderSack.bitmapLength = (*sequences.rbegin() - ltpHeaderSack.start)
+			/ 8 + 1;
+
+	if (ltpHeaderSack.bitmapLength > LTP_SACK_MAX_BITMAP)
+	{
+		ltpHeaderSack.bitmapLength = LTP_SACK_MAX_BITMAP;
+	}
+
+	memcpy(packet + offset, &ltpHeaderSack.start, sizeof(ltpHeaderSack.start));
+	offset += sizeof(ltpHeaderSack.start);
+	memcpy(packet + offset, &ltpHeaderSack.bitmapLength,
+			sizeof(ltpHeaderSack.bitmapLength));
+	offset += sizeof(ltpHeaderSack.bitmapLength);
+	memset(packet + offset, 0, ltpHeaderSack.bitmapLength);
+
+	for (it = sequences.begin(); it != sequences.end(); it++)
+	{
+		seq_t bit = *it - ltpHeaderSack.start;
+
+		if (bit >= (seq_t)ltpHeaderSack.bitmapLength * 8)
+		{
+			break;
+		}
+
+		packet[offset + bit / 8] |= (1 << (bit % 8));
+	}
+
+	return offset + ltpHeaderSack.bitmapLength;
+}
+
 void Lightweight::_setSessionEnded(IcnId &rCid, sk_t &sessionKey, bool state)
 {
 	unordered_map<sk_t, bool>::iterator skIt;
@@ -5227,15 +5229,16 @@ void Lightweight::_removeNidsFromCmcGroup(IcnId &rCid, enigma_t &enigma,
 void Lightweight::_removeNidsFromWindowUpdate(IcnId &rCid,
 		enigma_t &enigma, sk_t &sessionKey, list<NodeId> &nodeIds)
 {
+	window_update_t::iterator windowUpdateIt;
 	list<NodeId>::iterator nidsIt;
 	map<nid_t, bool>::iterator nidIt;
 	map<sk_t, map<nid_t, bool>>::iterator skIt;
 	map<enigma_t, map<sk_t, map<nid_t, bool>>>::iterator enigmaIt;
 	_windowUpdateMutex.lock();
-	_windowUpdateIt = _windowUpdate.find(rCid.uint());
+	windowUpdateIt = _windowUpdate.find(rCid.uint());
 
 	// rCID does not exist
-	if (_windowUpdateIt == _windowUpdate.end())
+	if (windowUpdateIt == _windowUpdate.end())
 	{
 		LOG4CXX_WARN(logger, "rCID " << rCid.print() << " does not exist in "
 				"list of awaited CTRL-WEDs");
@@ -5243,10 +5246,10 @@ void Lightweight::_removeNidsFromWindowUpdate(IcnId &rCid,
 		return;
 	}
 
-	enigmaIt = _windowUpdateIt->second.find(enigma);
+	enigmaIt = windowUpdateIt->second.find(enigma);
 
 	// enigma does not exist
-	if (enigmaIt == _windowUpdateIt->second.end())
+	if (enigmaIt == windowUpdateIt->second.end())
 	{
 		LOG4CXX_WARN(logger, "rCID " << rCid.print() << " > enigma "
 				<< enigma << " does not exist in list of awaited "
@@ -5289,21 +5292,22 @@ void Lightweight::_removeNidsFromWindowUpdate(IcnId &rCid,
 list<NodeId> Lightweight::_wudsNotReceived(IcnId &rCid, enigma_t &enigma,
 			sk_t &sessionKey)
 {
+	window_update_t::iterator windowUpdateIt;
 	list<NodeId> unconfirmedNids;
 	map<nid_t, bool>::iterator nidIt;
 	map<sk_t, map<nid_t, bool>>::iterator skIt;
 	map<enigma_t, map<sk_t, map<nid_t, bool>>>::iterator enigmaIt;
-	_windowUpdateIt = _windowUpdate.find(rCid.uint());
+	windowUpdateIt = _windowUpdate.find(rCid.uint());
 
-	if (_windowUpdateIt == _windowUpdate.end())
+	if (windowUpdateIt == _windowUpdate.end())
 	{
 		LOG4CXX_WARN(logger, "rCID " << rCid.print() << " not found in WU map");
 		return unconfirmedNids;
 	}
 
-	enigmaIt = _windowUpdateIt->second.find(enigma);
+	enigmaIt = windowUpdateIt->second.find(enigma);
 
-	if (enigmaIt == _windowUpdateIt->second.end())
+	if (enigmaIt == windowUpdateIt->second.end())
 	{
 		LOG4CXX_WARN(logger, "rCID " << rCid.print() << " > enigma "
 				<< enigma << " not found in WU map");
@@ -5365,4 +5369,6 @@ void Lightweight::_rtt(uint16_t rtt)
 	_rtts.resize(_configuration.ltpRttListSize());
 	_rtts.push_front(rtt);
 	_rttsMutex.unlock();
+	// pacing and timeouts of the LTP sender follow the mean
+	_ltpSender.rtt(_rtt());
 }
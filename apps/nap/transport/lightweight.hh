@@ -37,6 +37,7 @@
 #include <transport/buffercleaners/ltpreversecidcleaner.hh>
 #include <transport/lightweighttimeout.hh>
 #include <transport/lightweighttypedef.hh>
+#include <transport/ltpsender.hh>
 #include <types/nodeid.hh>
 #include <monitoring/statistics.hh>
 #include <trafficcontrol/trafficcontrol.hh>
@@ -146,19 +147,16 @@ public:
 	void publish(IcnId &rCid, enigma_t &enigma, sk_t &sessionKey,
 			list<NodeId> &nodeIds, uint8_t *data, uint16_t &dataSize);
 	/*!
-	 * \brief Publish HTTP responses (co-incidental multicast)
+	 * \brief Publish HTTP requests
 	 *
-	 * Blocking method. This method is called when packet from TCP server can be
-	 * immediately published to sNAP (
+	 * Non-blocking method. The packet is copied into the send queue of the LTP
+	 * sender which publishes it as the congestion window allows
 	 *
 	 * \param cId Reference to the content identifier
 	 * \param iSubIcnId Reference to the iSub content identifier
 	 * \param enigma https://en.wikipedia.org/wiki/23_enigma
 	 * \param packet Pointer to the data
 	 * \param dataSize Pointer to the length of the packet
-	 *
-	 * \return Boolean indicating if packet has been successfully
-	 * published
 	 */
 	void publish(IcnId &cId, IcnId &iSubIcnId, enigma_t &enigma,
 			sk_t &sessionKey, uint8_t *data, uint16_t &dataSize);
@@ -183,7 +181,7 @@ public:
 	/*!
 	 * \brief Publish HTTP requests
 	 *
-	 * Non-blocking method. It calls a thread to check for successful delivery
+	 * Non-blocking method. Same as publish() for HTTP requests
 	 *
 	 * \param cId Reference to the content identifier
 	 * \param rCId Reference to the iSub content identifier (rCID)
@@ -224,9 +222,10 @@ protected:
 	 *
 	 * \param cId The CID under which the packet has been published
 	 * \param packet Pointer to the ICN payload
+	 * \param packetSize The length of the ICN payload
 	 */
-	tp_states_t handle(IcnId &cId, uint8_t *packet, enigma_t &enigma,
-			sk_t &sessionKey);
+	tp_states_t handle(IcnId &cId, uint8_t *packet, uint16_t packetSize,
+			enigma_t &enigma, sk_t &sessionKey);
 	/*!
 	 * \brief Handle an incoming ICN message (iSub) which is using LTP
 	 *
@@ -239,6 +238,7 @@ protected:
 	 * \param nodeIdStr The NID which must be used when publishing the
 	 * response
 	 * \param packet Pointer to the ICN payload
+	 * \param packetSize The length of the ICN payload
 	 * \param enigma https://en.wikipedia.org/wiki/23_enigma
 	 * \param sessionKey If WE has been received and all fragments were
 	 * received this variable holds the corresponding session key
@@ -246,7 +246,8 @@ protected:
 	 * \return The TP state indicating if packet can be sent to IP endpoint
 	 */
 	tp_states_t handle(IcnId &cId, IcnId &rCId, string &nodeIdStr,
-			uint8_t *packet, enigma_t &enigma, sk_t &sessionKey);
+			uint8_t *packet, uint16_t packetSize, enigma_t &enigma,
+			sk_t &sessionKey);
 	/*!
 	 * \brief Retrieve a packet from _icnPacketBuffer map
 	 *
@@ -285,59 +286,26 @@ private:
 	operations */
 	icn_packet_buffer_t _icnPacketBuffer; /*!< Packet buffer for incoming ICN
 	packets */
-	icn_packet_buffer_t::iterator _icnPacketBufferIt; /*!< Iterator
-	for _icnPacketBuffer map*/
 	std::mutex _icnPacketBufferMutex; /*!< Mutex for _icnPacketBuffer map*/
 	proxy_packet_buffer_t _proxyPacketBuffer; /*!< Packet buffer for incoming
-	HTTP packets from the HTTP proxy (both req+resp with rCID as the map key */
-	proxy_packet_buffer_t::iterator _proxyPacketBufferIt;/*!< Iterator for
-	packetBuffer map */
+	HTTP packets from the HTTP proxy (both req+resp with rCID as the session
+	key */
 	std::mutex _proxyPacketBufferMutex;/*!< mutex for _packetBuffer map*/
-	ltp_packet_buffer_t _ltpPacketBuffer;/*!< map<rCID, map<enigma, map<SK,
-	map<Sequence, Packet>>>> Packet buffer for sent datagrams over LTP (in case
-	NACK comes back)*/
+	ltp_packet_buffer_t _ltpPacketBuffer;/*!< rCID > enigma > SK > Sequence
+	Packet buffer for sent datagrams over LTP (in case NACK comes back)*/
 	std::mutex _ltpPacketBufferMutex;/*!< mutex for transaction-safe
 	operations on _ltpPacketBuffer */
 	ltp_session_activity_t _ltpSessionActivity;/*!< Keep knowledge if LTP packet
 	buffer is currently used for a particular LTP session*/
 	std::mutex _ltpSessionActivityMutex; /*!< Mutex for _ltpSessionActivity*/
-	/*
-	 * (Potential) CMC Group
-	 */
-	cmc_groups_t *_cmcGroups;/*!< Pointer to Http::_cmcGroups map */
-	cmc_groups_t::iterator _cmcGroupsIt; /*!< Iterator for _cmcGroups */
-	std::mutex *_cmcGroupsMutex; /*!< Pointer to Http::_cmcGroupsMutex mutex*/
-	potential_cmc_groups_t * _potentialCmcGroups; /*!< Pointer to
-	Http::_potentialCmcGroups */
-	potential_cmc_groups_t::iterator _potentialCmcGroupsIt; /*!< Iterator for
-	_potentialCmcGroups map*/
-	std::mutex *_potentialCmcGroupsMutex; /*!< Pointer to
-	Http::_potentialCmcGroups mutex*/
-	map<nid_t, bool> *_knownNIds; /*!< map<NID, startPublishReceived> This
-	boolean is used to indicate that the FID for this particular NID has been
-	received.*/
-	map<nid_t, bool>::iterator _knownNIdsIt; /*!<Iterator for _fidKnown map*/
-	std::mutex *_knownNIdsMutex; /*!< Mutex for _knownNIds */
-	/*
-	 * LTP Reset
-	 */
-	resetted_t _resetted;/*!< LTP RST received */
-	resetted_t::iterator _resettedIt; /*!< Iterator for _resetted */
-	std::mutex _resettedMutex;/*!< Mutex for _resetted map */
-	vector<std::thread> _resettedThreads;
-	forward_list<uint16_t> _rtts;/*!< Round trip time list*/
-	std::mutex _rttsMutex;/*!< Mutex for writing _rtt*/
-	uint16_t _rttMultiplier;/*!< Multiplier for LTP-CTRL timeout using RTT */
 	/*
 	 * LTP Session Ended
 	 */
 	session_ended_responses_t _sessionEndedResponses;
 	/*!< map<rCID, map<enigma, map<NID, map<SK, SED received>>>>*/
-	session_ended_responses_t::iterator _sessionEndedResponsesIt;
-	/*!< Iterator for _sessionEndedResponses map*/
 	std::mutex _sessionEndedResponsesMutex;/*!< Mutex for operations on
 	_sessionEndedResponses map*/
-	unordered_map<cid_t, unordered_map<sk_t, bool>>
+	session_ended_responses_unicast_t
 	_sessionEndedResponsesUnicast;/*!< To keep track about sent LTP CTRL SEs */
 	std::mutex _sessionEndedResponsesUnicastMutex;/*!< Mutex for
 	_sessionEndedResponsesUnicast map*/
@@ -346,38 +314,66 @@ private:
 	 */
 	window_ended_requests_t _windowEndedRequests;
 	/*!<map<rCID, map<enigma, map<Session Key, WED received>>> */
-	window_ended_requests_t::iterator
-	_windowEndedRequestsIt;/*!<Iterator for _windowEndedRequests map*/
 	std::mutex _windowEndedRequestsMutex;/*!< Mutex for _windowEndedRequests
 	maps */
-	map<cid_t, map<enigma_t, map<nid_t, map<sk_t, bool>>>> _windowEndedResponses;
+	window_ended_responses_t _windowEndedResponses;
 	/*!<map<rCID, map<enigma, map<NID, map<Session Key, WED received>>> */
-	map<cid_t, map<enigma_t, map<nid_t, map<sk_t, bool>>>>::iterator
-	_windowEndedResponsesIt;/*!<Iterator for _windowEndedResponses map*/
 	std::mutex _windowEndedResponsesMutex;/*!< Mutex for _windowEndedResponses
 	maps */
-	map<cid_t, map<enigma_t, map<sk_t, map<nid_t, bool>>>> _windowUpdate;
+	window_update_t _windowUpdate;
 	/*!< map to check if WUD has been received */
-	map<cid_t, map<enigma_t, map<sk_t, map<nid_t, bool>>>>::iterator
-	_windowUpdateIt; /*!< Iterator for operations on _windowUpdate map*/
 	std::mutex _windowUpdateMutex; /*!< Mutex for transaction-safe operations
 	on _windowUpdate map */
-	map<cid_t, map<enigma_t, map<sk_t, nack_group_t>>> _nackGroups;/*!<
+	nack_groups_t _nackGroups;/*!<
 	map<rCID, map<enigma, map<SK, nackGroup>>> Store the NIDs which sent a NACK so
 	that if all NIDs have responded to the WE message (either WED or NACK) the
 	NAP can eventually re-submit the range of missing segments */
-	map<cid_t, map<enigma_t, map<sk_t, nack_group_t>>>::iterator
-	_nackGroupsIt; /*!< Iterator for _nackGroups mak */
 	std::mutex _nackGroupsMutex;/*!< mutex for _nackGroups map */
+	/*
+	 * (Potential) CMC Group
+	 */
+	cmc_groups_t *_cmcGroups;/*!< Pointer to Http::_cmcGroups map */
+	cmc_groups_t::iterator _cmcGroupsIt; /*!< Iterator for _cmcGroups */
+	std::mutex *_cmcGroupsMutex; /*!< Pointer to Http::_cmcGroupsMutex mutex*/
+	potential_cmc_groups_t * _potentialCmcGroups; /*!< Pointer to
+	Http::_potentialCmcGroups */
+	potential_cmc_groups_t::iterator _potentialCmcGroupsIt; /*!< Iterator for
+	_potentialCmcGroups map*/
+	std::mutex *_potentialCmcGroupsMutex; /*!< Pointer to
+	Http::_potentialCmcGroups mutex*/
+	map<nid_t, bool> *_knownNIds; /*!< map<NID, startPublishReceived> This
+	boolean is used to indicate that the FID for this particular NID has been
+	received.*/
+	map<nid_t, bool>::iterator _knownNIdsIt; /*!<Iterator for _fidKnown map*/
+	std::mutex *_knownNIdsMutex; /*!< Mutex for _knownNIds */
+	/*
+	 * LTP Reset
+	 */
+	resetted_t _resetted;/*!< LTP RST received */
+	resetted_t::iterator _resettedIt; /*!< Iterator for _resetted */
+	std::mutex _resettedMutex;/*!< Mutex for _resetted map */
+	vector<std::thread> _resettedThreads;
+	forward_list<uint16_t> _rtts;/*!< Round trip time list*/
+	std::mutex _rttsMutex;/*!< Mutex for writing _rtt*/
+	uint16_t _rttMultiplier;/*!< Multiplier for LTP-CTRL timeout using RTT */
+	LtpSender _ltpSender;/*!< Send queues and congestion windows for HTTP
+	requests (cNAP > sNAP) */
+	unordered_map<cid_t, uint8_t> _ltpVersionsCid;/*!< map<CID, LTP version>
+	Version announced by the sNAP(s) serving an FQDN */
+	unordered_map<nid_t, uint8_t> _ltpVersionsNid;/*!< map<NID, LTP version>
+	Version announced by a cNAP */
+	std::mutex _ltpVersionsMutex;/*!< Mutex for _ltpVersionsCid and
+	_ltpVersionsNid */
 	/*!
 	 * \brief Add a NACK to _nackGroups
 	 *
 	 * \param rCid The rCID under which the NACK message has been received
-	 * \param ltpHeaderNack The LTP NACK header received
+	 * \param ltpHeaderNack The LTP NACK header received (enigma and SK)
+	 * \param sequences The sequence numbers reported missing
 	 * \param nodeId The NID from which the NACK message has been received
 	 */
 	void _addNackNodeId(IcnId &rCid, ltp_hdr_ctrl_nack_t &ltpHeaderNack,
-			NodeId &nodeId);
+			ltp_sequences_t &sequences, NodeId &nodeId);
 	/*!
 	 * \brief Add NID to list of known NIDs and their forwarding states
 	 *
@@ -471,33 +467,36 @@ private:
 	/*!
 	 * \brief Buffer a sent LTP packet for NACK scenarios
 	 *
-	 * Uses _ltpPacketBuffer map
+	 * Adds a reference to the fragment to the ring of the rCID > enigma > SK
+	 * session in _ltpPacketBuffer
 	 *
 	 * \param rCid The rCid for which the packet should be buffered
-	 * \param ltpHeaderData The LTP information required to create rCID > enigma >
-	 * SK > Sequence relational map
-	 * \param packet Pointer to the packet
-	 * \param packetSize Total size of the packet (must be multiple of 8)
+	 * \param ltpHeaderData The LTP information identifying the session and the
+	 * sequence
+	 * \param message The message the fragment was cut from
+	 * \param payload Start of the fragment within the message
+	 * \param fragmentSize Length of the fragment (must be multiple of 8)
 	 */
 	void _bufferLtpPacket(IcnId &rCid,
-			ltp_hdr_data_t &ltpHeaderData, uint8_t *packet,
-			uint16_t packetSize);
+			ltp_hdr_data_t &ltpHeaderData, LtpMessage *message,
+			uint8_t *payload, uint16_t fragmentSize);
 	/*!
 	 * \brief Add packet received from proxy (via HTTP handler) to LTP buffer
 	 *
-	 * This method adds the actual packet to the LTP buffer (_proxyPacketBuffer
-	 * map) and also stores the iSub CID <> CID mapping for reverse look-ups to
+	 * This method adds the actual packet to the LTP buffer (_proxyPacketBuffer)
+	 * and also stores the iSub CID <> CID mapping for reverse look-ups to
 	 * the _cIdReverseLookUp map
 	 *
 	 * \param cId Content ID (FQDN) - only used for better loggin output
 	 * \param rCId iSub CID (URL) - key in proxy buffer map
 	 * \param ltpHeaderData LTP header for data
-	 * \param packet Pointer to packet
-	 * \param packetSize Size of the allocated packet memory
+	 * \param message The message the fragment was cut from
+	 * \param payload Start of the fragment within the message
+	 * \param fragmentSize Length of the fragment (must be multiple of 8)
 	 */
 	void _bufferProxyPacket(IcnId &cId, IcnId &rCId,
-			ltp_hdr_data_t &ltpHeaderData, uint8_t *packet,
-			uint16_t &packetSize);
+			ltp_hdr_data_t &ltpHeaderData, LtpMessage *message,
+			uint8_t *payload, uint16_t fragmentSize);
 	/*!
 	 * \brief Check if locked CMC group does not exist anymore or has no members
 	 *
@@ -516,7 +515,8 @@ private:
 	/*!
 	 * \brief Delete an entire HTTP packet from the LTP packet storage (sNAP)
 	 *
-	 * Uses _ltpPacketBuffer map
+	 * Releases the packets of the session in _ltpPacketBuffer but keeps the
+	 * session ring for the next window
 	 *
 	 * \param rCid The rCID under which the packet has been buffered
 	 * \param enigma https://en.wikipedia.org/wiki/23_enigma
@@ -540,7 +540,7 @@ private:
 	 *
 	 * After the completion of an LTP session the actual entry stays in the LTP
 	 * buffer for further packets to be stored and deleted. Only once the socket
-	 * towards the server is closed the actual map keys are deleted
+	 * towards the server is closed the session is removed from the buffer
 	 *
 	 * \param rCid The rCID which should be looked up in _ltpPacketBuffer
 	 * \param enigma https://en.wikipedia.org/wiki/23_enigma
@@ -581,6 +581,32 @@ private:
 	 */
 	void _deleteSessionEnd(IcnId &rCid, ltp_hdr_ctrl_se_t &ltpHdrCtrlSe,
 			list<NodeId> &nodeIds);
+	/*!
+	 * \brief Read an LTP data header (LTP_DATA or LTP_DATA_V2)
+	 *
+	 * \param packet Pointer to the beginning of the LTP packet
+	 * \param ltpHeaderData The header is written to this reference
+	 *
+	 * \return The length of the header, i.e., the offset of the payload
+	 */
+	uint8_t _deserialiseDataHeader(uint8_t *packet,
+			ltp_hdr_data_t &ltpHeaderData);
+	/*!
+	 * \brief Read a CTRL-NACK or CTRL-SACK message
+	 *
+	 * \param controlType LTP_CONTROL_NACK or LTP_CONTROL_SACK
+	 * \param packet Pointer to the enigma field of the CTRL message
+	 * \param length Number of octets from the enigma field onwards
+	 * \param ltpHeaderNack Enigma and SK are written to this reference
+	 * \param sequences The sequence numbers reported missing are written to
+	 * this reference
+	 *
+	 * \return False if the message is malformed
+	 */
+	bool _deserialiseNegativeAcknowledgement(
+			ltp_ctrl_control_types_t controlType, uint8_t *packet,
+			uint16_t length, ltp_hdr_ctrl_nack_t &ltpHeaderNack,
+			ltp_sequences_t &sequences);
 
 	/*!
 	 * \brief Enable a NID to be ready to receive an HTTP response
@@ -626,12 +652,13 @@ private:
 	 *
 	 * \param rCId The rCID under which the packet had been published
 	 * \param packet Pointer to the entire CTRL message
+	 * \param packetSize The length of the CTRL message
 	 * \param enigma https://en.wikipedia.org/wiki/23_enigma
 	 * \param sessionKey When returning TP_STATE_ALL_FRAGMENTS_RECEIVED this
 	 * argument contains the session key the LTP CTRL header carried
 	 */
 	tp_states_t _handleControl(IcnId &rCId, uint8_t *packet,
-			enigma_t &enigma, sk_t &sessionKey);
+			uint16_t packetSize, enigma_t &enigma, sk_t &sessionKey);
 	/*!
 	 * \brief Handle an incoming LTP control message (iSub)
 	 *
@@ -639,12 +666,14 @@ private:
 	 * \param rCId The iSub CID under which the response must be published
 	 * \param nodeId The NID which must be used when publishing the response
 	 * \param packet Pointer to the CTRL message
+	 * \param packetSize The length of the CTRL message
 	 * \param enigma https://en.wikipedia.org/wiki/23_enigma
 	 * \param sessionKey This field is filled out if WE has been received and
 	 * all fragment were received
 	 */
 	tp_states_t _handleControl(IcnId &cId, IcnId &rCId, NodeId &nodeId,
-			uint8_t *packet, enigma_t &enigma, sk_t &sessionKey);
+			uint8_t *packet, uint16_t packetSize, enigma_t &enigma,
+			sk_t &sessionKey);
 	/*!
 	 * \brief Handling an incoming HTTP response
 	 *
@@ -690,6 +719,14 @@ private:
 	 */
 	bool _ltpCtrlSedReceived(IcnId rCid, list<NodeId> nodeIds,
 			enigma_t enigma, sk_t sessionKey);
+	/*!
+	 * \brief Publishing thread of the LTP sender
+	 *
+	 * Obtains all due fragments and CTRL messages from _ltpSender, buffers the
+	 * fragments in _proxyPacketBuffer and publishes all fragments of a round
+	 * under a single lock of the ICN core mutex
+	 */
+	void _ltpSenderLoop();
 	/*!
 	 * \brief Check if a previous LTP session for the same rCID > enigma > SK is
 	 * still active and the new packet from a server must wait
@@ -712,6 +749,52 @@ private:
 	 */
 	void _ltpSessionActivitySet(IcnId &rCid, enigma_t &enigma,
 			sk_t &sessionKey, bool status);
+	/*!
+	 * \brief Obtain the LTP version to be used towards the sNAP(s) serving a
+	 * CID
+	 *
+	 * \param cid The CID (FQDN)
+	 *
+	 * \return The lower of the configured version and the one the sNAP has
+	 * announced. 1 if the sNAP has not announced any yet
+	 */
+	uint8_t _ltpVersion(IcnId &cid);
+	/*!
+	 * \brief Obtain the LTP version to be used towards a group of cNAPs
+	 *
+	 * \param nodeIds The NIDs of the cNAPs
+	 *
+	 * \return The lowest version among the configured one and the ones the
+	 * cNAPs have announced
+	 */
+	uint8_t _ltpVersion(list<NodeId> &nodeIds);
+	/*!
+	 * \brief Remember the LTP version an sNAP serving a CID has announced
+	 *
+	 * \param cid The CID (FQDN)
+	 * \param version The announced LTP version
+	 */
+	void _ltpVersion(IcnId &cid, uint8_t version);
+	/*!
+	 * \brief Remember the LTP version a cNAP has announced
+	 *
+	 * \param nodeId The NID of the cNAP
+	 * \param version The announced LTP version
+	 */
+	void _ltpVersion(NodeId &nodeId, uint8_t version);
+	/*!
+	 * \brief Obtain the fragments missing in a window
+	 *
+	 * \param fragments The received fragments of an LTP session
+	 * \param lastSequence The last sequence number announced in the CTRL-WE
+	 * \param missingSequences The missing sequence numbers are written to this
+	 * reference. Sequences more than LTP_SACK_MAX_BITMAP * 8 after the first
+	 * missing one are left for the next CTRL-WE
+	 *
+	 * \return True if all fragments up to lastSequence have been received
+	 */
+	bool _missingSequences(map<seq_t, pair<uint8_t*, uint16_t>> &fragments,
+			seq_t lastSequence, ltp_sequences_t &missingSequences);
 	/*!
 	 * \brief Obtain the group of NIDs that have sent a NACK in response to
 	 * a WE CTRL message
@@ -748,33 +831,19 @@ private:
 	void _publishData(IcnId &rCId, ltp_hdr_ctrl_we_t &ltpHeaderCtrlWe,
 			list<NodeId> &nodeIds, uint8_t *data, uint16_t &dataSize);
 	/*!
-	 * \brief Publish HTTP requests
-	 *
-	 * Called by public publish*() methods
-	 *
-	 * \param cId Reference to the content identifier
-	 * \param rCId Reference to the iSub content identifier
-	 * \param enigma https://en.wikipedia.org/wiki/23_enigma
-	 * \param sessionKey Reference to the session key provided by the caller
-	 * \param packet Pointer to the data
-	 * \param dataSize Pointer to the length of the packet
-	 *
-	 * \return This method returns the sequence number of the last fragment to
-	 * create LTP CTRL messages based on this important piece of information
-	 */
-	uint16_t _publishData(IcnId &cId, IcnId &rCId, enigma_t &enigma,
-			sk_t &sessionKey, uint8_t *data, uint16_t &dataSize);
-	/*!
-	 * \brief Publish a range of segments from an HTTP request in response to
-	 * previously received NACKs
+	 * \brief Publish segments from an HTTP request in response to a
+	 * previously received NACK or SACK
 	 *
 	 * This method looks up the CID for the provided rCID and publishes the
-	 * range of LTP fragments provided in the LTP header
+	 * LTP fragments reported missing
 	 *
 	 * \param rCid The rCID under which the packet(s) shall be published
-	 * \param ltpCtrlNack The LTP CTRL NACK message received from an sNAP
+	 * \param ltpCtrlNack The enigma and SK of the NACK received from an sNAP
+	 * \param sequences The sequence numbers which need to be re-sent
+	 * \param version The LTP version of the NACK (1: CTRL-NACK, 2: CTRL-SACK)
 	 */
-	void _publishDataRange(IcnId &rCid, ltp_hdr_ctrl_nack_t &ltpCtrlNack);
+	void _publishDataRange(IcnId &rCid, ltp_hdr_ctrl_nack_t &ltpCtrlNack,
+			ltp_sequences_t &sequences, uint8_t version);
 	/*!
 	 * \brief Publish a range of segments from an HTTP response in response to
 	 * previously received NACKs
@@ -782,7 +851,7 @@ private:
 	 * \param rCid The rCID under which the packet(s) shall be published
 	 * \param enigma The enigma used in the LTP header to publish the packets
 	 * \param sessionKey The SK used in the LTP header to publish the packets
-	 * \param nackGroup The NIDs to which the range of segments shall be sent
+	 * \param nackGroup The NIDs to which the missing segments shall be sent
 	 */
 	void _publishDataRange(IcnId &rCid, enigma_t &enigma,
 			sk_t &sessionKey, nack_group_t &nackGroup);
@@ -794,14 +863,13 @@ private:
 	 * \param nodeId The NID to which the NACK should be sent
 	 * \param enigma The enigma to the sequence range belongs
 	 * \param sessionKey The SK to which teh sequence range belongs
-	 * \param firstMissingSequence The start of the range of sequence numbers
-	 * which need to be re-send
-	 * \param lastMissingSequence The end of the range of sequence numbers
-	 * which need to be re-send
+	 * \param sequences The sequence numbers which need to be re-sent
+	 * \param version The LTP version of the cNAP. A SACK is sent for v2 and a
+	 * NACK covering the first to the last missing sequence otherwise
 	 */
 	void _publishNegativeAcknowledgement(IcnId &rCid, NodeId &nodeId,
-			enigma_t &enigma, sk_t &sessionKey, seq_t &firstMissingSequence,
-			seq_t &lastMissingSequence);
+			enigma_t &enigma, sk_t &sessionKey, ltp_sequences_t &sequences,
+			uint8_t version);
 	/*!
 	 * \brief Publish NACK in response to missing segments from an HTTP response
 	 * session
@@ -810,14 +878,13 @@ private:
 	 * \param rCid The rCID which will be included in the publication
 	 * \param enigma The enigma to the sequence range belongs
 	 * \param sessionKey The SK to which teh sequence range belongs
-	 * \param firstMissingSequence The start of the range of sequence numbers
-	 * which need to be re-send
-	 * \param lastMissingSequence The end of the range of sequence numbers
-	 * which need to be re-senduint8_t attempts
+	 * \param sequences The sequence numbers which need to be re-sent
+	 * \param version The LTP version of the sNAP. A SACK is sent for v2 and a
+	 * NACK covering the first to the last missing sequence otherwise
 	 */
 	void _publishNegativeAcknowledgement(IcnId &cid, IcnId &rCid,
-			enigma_t &enigma, sk_t &sessionKey, seq_t &firstMissingSequence,
-			seq_t &lastMissingSequence);
+			enigma_t &enigma, sk_t &sessionKey, ltp_sequences_t &sequences,
+			uint8_t version);
 	/*!
 	 * \brief Publish reset
 	 *
@@ -932,6 +999,16 @@ private:
 	 */
 	void _publishWindowUpdate(IcnId &rCid, enigma_t &enigma,
 			sk_t &sessionKey, list<NodeId> &nodeIds);
+	/*!
+	 * \brief Send CTRL WU message to the sNAP (HTTP requests)
+	 *
+	 * \param cId The CID under which the packet is going to be published
+	 * \param rCId The rCID used to use implicit subscription
+	 * \param enigma The enigma used in the LTP header
+	 * \param sessionKey The sesion key used in the LTP header
+	 */
+	void _publishWindowUpdate(IcnId &cId, IcnId &rCId, enigma_t &enigma,
+			sk_t &sessionKey);
 	/*!
 	 * \brief Publish CTRL-WUD message to the sNAP in response to a received
 	 * CTRL-WU message
@@ -943,6 +1020,46 @@ private:
 	 */
 	void _publishWindowUpdated(IcnId &cid, IcnId &rCid,
 			ltp_hdr_ctrl_wud_t &ltpHeaderControlWud);
+	/*!
+	 * \brief Publish CTRL-WUD message to a cNAP in response to a received
+	 * CTRL-WU message
+	 *
+	 * \param rCId The rCID under which the packet should be published
+	 * \param nodeId The NID of the cNAP which sent the CTRL-WU
+	 * \param ltpHeaderControlWud The enigma and SK used for the LTP CTRL-WUD
+	 * header
+	 */
+	void _publishWindowUpdated(IcnId &rCId, NodeId &nodeId,
+			ltp_hdr_ctrl_wud_t &ltpHeaderControlWud);
+	/*!
+	 * \brief Serialise the header of an LTP data packet
+	 *
+	 * The payload follows the serialised header on the wire, i.e., header and
+	 * payload can be handed to Blackadder as two separate iovecs. The message
+	 * type determines the width of the sequence number on the wire.
+	 *
+	 * \param ltpHeaderData The header to be serialised
+	 * \param header Buffer of at least LTP_DATA_HEADER_LENGTH_V2 octets
+	 *
+	 * \return The length of the serialised header
+	 */
+	uint8_t _serialiseDataHeader(ltp_hdr_data_t &ltpHeaderData,
+			uint8_t *header);
+	/*!
+	 * \brief Serialise a CTRL-NACK (v1) or CTRL-SACK (v2)
+	 *
+	 * \param enigma The enigma of the LTP session
+	 * \param sessionKey The SK of the LTP session
+	 * \param sequences The missing sequence numbers (must not be empty)
+	 * \param version The LTP version of the receiver
+	 * \param packet Buffer of at least LTP_CTRL_SACK_LENGTH +
+	 * LTP_SACK_MAX_BITMAP octets
+	 *
+	 * \return The length of the serialised message
+	 */
+	uint16_t _serialiseNegativeAcknowledgement(enigma_t enigma,
+			sk_t sessionKey, ltp_sequences_t &sequences, uint8_t version,
+			uint8_t *packet);
 	/*!
 	 * \brief Set LTP CTRL-SED in _sessionEndedResponseUnicast map
 	 *
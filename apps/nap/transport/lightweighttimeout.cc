@@ -26,7 +26,7 @@ using namespace transport::lightweight;
 LoggerPtr LightweightTimeout::logger(Logger::getLogger("transport.lightweight"));
 
 LightweightTimeout::LightweightTimeout(IcnId cId, IcnId rCId,
-		enigma_t enigma, uint16_t sessionKey, uint16_t sequenceNumber,
+		enigma_t enigma, uint16_t sessionKey, seq_t sequenceNumber,
 		Blackadder *icnCore, std::mutex &icnCoreMutex, uint16_t rtt,
 		proxy_packet_buffer_t *proxyPacketBuffer, std::mutex *proxyPacketBufferMutex,
 		window_ended_requests_t *windowEnded, std::mutex *windowEndedMutex)
@@ -247,60 +247,19 @@ void LightweightTimeout::_deleteObjects()
 void LightweightTimeout::_deleteProxyPacket(IcnId &rCId,
 		ltp_hdr_ctrl_wed_t &ltpHeader)
 {//TODO delete ... legacy code for when surrogacy had not been implemented
-	//map<Sequence, Packet
-	map<uint16_t, pair<uint8_t *, uint16_t>>::iterator	sequenceKeyMapIt;
-	//map<SK,     map<Sequence, Packet
-	map<uint16_t, map<uint16_t, pair<uint8_t *, uint16_t>>>::iterator
-			sessionKeyMapIt;
-	//map<Enigma,   map<SK,       map<Sequence, Packet
-	map<uint32_t, map<uint16_t, map<uint16_t, pair<uint8_t *,
-			uint16_t>>>>::iterator enigmaMapIt;
 	_proxyPacketBufferMutex->lock();
-	_proxyPacketBufferIt = _proxyPacketBuffer->find(rCId.uint());
 
-	// rCID does not exist
-	if (_proxyPacketBufferIt == _proxyPacketBuffer->end())
+	// rCID > Enigma > SK does not exist
+	if (!_proxyPacketBuffer->erase(rCId.uint(), ltpHeader.enigma,
+			ltpHeader.sessionKey))
 	{
-		LOG4CXX_WARN(logger, "rCID " << rCId.print() << " cannot be found "
-				"in proxy packet buffer map");
+		LOG4CXX_WARN(logger, "rCID " << rCId.print() << " > Enigma "
+				<< ltpHeader.enigma << " > SK " << ltpHeader.sessionKey
+				<< " cannot be found in proxy packet buffer");
 		_proxyPacketBufferMutex->unlock();
 		return;
 	}
 
-	enigmaMapIt = _proxyPacketBufferIt->second.find(ltpHeader.enigma);
-
-	// Enigma does not exist
-	if (enigmaMapIt == _proxyPacketBufferIt->second.end())
-	{
-		LOG4CXX_WARN(logger, "Enigma " << ltpHeader.enigma << " could "
-				"not be found in proxy packet buffer map for rCID "
-				<< rCId.print());
-		_proxyPacketBufferMutex->unlock();
-		return;
-	}
-
-	sessionKeyMapIt = enigmaMapIt->second.find(ltpHeader.sessionKey);
-
-	// SK does not exist
-	if (sessionKeyMapIt == enigmaMapIt->second.end())
-	{
-		LOG4CXX_WARN(logger, "SK " << ltpHeader.sessionKey << " could "
-				"not be found in proxy packet buffer map for rCID "
-				<< rCId.print() << " > Enigma " << ltpHeader.enigma);
-		_proxyPacketBufferMutex->unlock();
-		return;
-	}
-
-	// deleting packets
-	for (sequenceKeyMapIt = sessionKeyMapIt->second.begin();
-			sequenceKeyMapIt != sessionKeyMapIt->second.end();
-			sequenceKeyMapIt++)
-	{
-		free(sequenceKeyMapIt->second.first);
-	}
-
-	// deleting entire session key
-	enigmaMapIt->second.erase(sessionKeyMapIt);
 	_proxyPacketBufferMutex->unlock();
 	LOG4CXX_TRACE(logger, "Packet deleted from proxy packet buffer for rCID "
 			<< rCId.print() << " > Enigma " << ltpHeader.enigma
@@ -312,7 +271,8 @@ void LightweightTimeout::_rePublishWindowEnd()
 	ltp_hdr_ctrl_we_t ltpHeader;
 	uint8_t *packet;
 	uint8_t offset = 0;
-	uint16_t packetSize = sizeof(ltp_hdr_ctrl_we_t);
+	uint16_t packetSize = LTP_CTRL_WE_LENGTH;
+	uint16_t sequenceNumber;
 	// Fill up the LTP CTRL header
 	ltpHeader.messageType = LTP_CONTROL;
 	ltpHeader.controlType = LTP_CONTROL_WINDOW_END;
@@ -336,9 +296,9 @@ void LightweightTimeout::_rePublishWindowEnd()
 	memcpy(packet + offset, &ltpHeader.sessionKey,
 			sizeof(ltpHeader.sessionKey));
 	offset += sizeof(ltpHeader.sessionKey);
-	// [5] Sequence number
-	memcpy(packet + offset, &ltpHeader.sequenceNumber,
-			sizeof(ltpHeader.sequenceNumber));
+	// [5] Sequence number (v1 CTRL-WE)
+	sequenceNumber = ltpHeader.sequenceNumber;
+	memcpy(packet + offset, &sequenceNumber, sizeof(sequenceNumber));
 	_icnCoreMutex.lock();
 	_icnCore->publish_data_isub(_cId.binIcnId(), DOMAIN_LOCAL, NULL, 0,
 			_rCId.binIcnId(), packet, packetSize);
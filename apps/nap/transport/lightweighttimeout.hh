@@ -66,7 +66,7 @@ public:
 	 * \param icnCore
 	 */
 	LightweightTimeout(IcnId cId, IcnId rCId, enigma_t enigma,
-			uint16_t sessionKey, uint16_t sequenceNumber, Blackadder *icnCore,
+			uint16_t sessionKey, seq_t sequenceNumber, Blackadder *icnCore,
 			std::mutex &icnCoreMutex, uint16_t rtt, proxy_packet_buffer_t *proxyPacketBuffer,
 			std::mutex *proxyPacketBufferMutex, window_ended_requests_t *windowEnded,
 			std::mutex *windowEndedMutex);
@@ -108,8 +108,6 @@ private:
 	uint16_t _rtt;
 	proxy_packet_buffer_t *_proxyPacketBuffer; /*!< Pointer to proxy packet
 	buffer */
-	proxy_packet_buffer_t::iterator _proxyPacketBufferIt;/*!< Iterator for
-	packetBuffer map */
 	std::mutex *_proxyPacketBufferMutex;/*!< mutex for _packetBuffer map*/
 	resetted_t *_resetted;/*!< map<cid, map<Enigma, map<NID, map<RST received */
 	std::mutex *_resettedMutex;/*!< mutex for _resetted map*/
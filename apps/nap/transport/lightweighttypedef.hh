@@ -24,19 +24,31 @@
 
 #include <list>
 #include <map>
+#include <set>
 
 #include <types/enumerations.hh>
 #include <namespaces/httptypedef.hh>
 #include <types/typedef.hh>
+#include <transport/ltppacketstore.hh>
 #include <unordered_map>
 
+#define LTP_CTRL_NACK_LENGTH 20/*!< Octets of a CTRL-NACK (v1) */
+#define LTP_CTRL_SACK_LENGTH 20/*!< Octets of a CTRL-SACK without bitmap */
+#define LTP_CTRL_WE_LENGTH 16/*!< Octets of a v1 CTRL-WE. A v2 CTRL-WE appends
+the version and the 32-bit sequence number */
+#define LTP_CTRL_WED_LENGTH 16/*!< Octets of a v1 CTRL-WED. A v2 CTRL-WED
+appends the version */
+#define LTP_DATA_HEADER_LENGTH_V1 14/*!< Octets of an LTP_DATA header */
+#define LTP_DATA_HEADER_LENGTH_V2 16/*!< Octets of an LTP_DATA_V2 header */
+#define LTP_SACK_MAX_BITMAP 128/*!< Maximal length of the bitmap in a CTRL-SACK
+in octets, i.e., a single SACK covers up to 1024 sequence numbers */
+
 typedef map<cid_t, map<enigma_t, map<nid_t, map<sk_t, map<seq_t,
 		pair<uint8_t*, uint16_t>>>>>> icn_packet_buffer_t ; /*!< map<rCId,
 		map<Enigma, map<NID, map<Session, map<Sequence, PACKET>>>>>> */
 
-typedef map<cid_t, map<enigma_t, map<sk_t, map<seq_t, pair<uint8_t *,
-		uint16_t>>>>> proxy_packet_buffer_t ; /*!< map<CID/rCID, map<Enigma,
-		map<SessionKey, map<Sequence number, pair<PACKET>>>>> */
+typedef transport::lightweight::LtpPacketStore proxy_packet_buffer_t;/*!<
+		rCID > Enigma > SessionKey > Sequence number > PACKET */
 
 typedef unordered_map<cid_t, bool> resetted_t;/*!< rCID > RST received (y/n) */
 
@@ -46,13 +58,27 @@ typedef unordered_map<cid_t, unordered_map<enigma_t, unordered_map<nid_t,
 
 typedef map<cid_t, map<enigma_t, map<sk_t, bool>>> window_ended_requests_t;
 
-typedef map<cid_t, map<enigma_t, map<sk_t, map<seq_t, packet_t>>>>
-		ltp_packet_buffer_t;/*!< Packet buffer for LTP sessions */
+typedef transport::lightweight::LtpPacketStore ltp_packet_buffer_t;/*!<
+		Packet buffer for LTP sessions */
 
 typedef unordered_map<cid_t, unordered_map<enigma_t, unordered_map<sk_t, bool>>>
 		ltp_session_activity_t;/*!< Keep knowledge if LTP packet buffer is
 		currently used for a particular LTP session*/
 
+typedef map<cid_t, map<enigma_t, map<nid_t, map<sk_t, bool>>>>
+		window_ended_responses_t;/*!< map<rCID, map<enigma, map<NID, map<SK,
+		WED received>>>> */
+
+typedef set<seq_t> ltp_sequences_t;/*!< Sequence numbers of LTP fragments, e.g.
+		the ones reported missing in a CTRL-NACK or CTRL-SACK */
+
+typedef map<cid_t, map<enigma_t, map<sk_t, map<nid_t, bool>>>>
+		window_update_t;/*!< map<rCID, map<enigma, map<SK, map<NID, WUD
+		received>>>> */
+
+typedef unordered_map<cid_t, unordered_map<sk_t, bool>>
+		session_ended_responses_unicast_t;/*!< rCID > SK > SED received */
+
 typedef map<cid_t, IcnId> reverse_cid_lookup_t;
 /*!
  * \brief LTP CTRL control header
@@ -147,8 +173,10 @@ struct ltp_hdr_ctrl_we_t
 	statistically unique key is required to allow the sNAP to add the packet
 	to the correct ICN packet buffer and all LTP CTRL messages are for a
 	particular session key */
-	uint16_t sequenceNumber;/*!< The sequence number of the last
+	seq_t sequenceNumber;/*!< The sequence number of the last
 	data packet published to subscriber */
+	uint8_t version = 1;/*!< The LTP version of the publisher. Only v2
+	CTRL-WEs carry it */
 };
 /*!
  * \brief LTP control header for window ended CTRL messages
@@ -162,6 +190,8 @@ struct ltp_hdr_ctrl_wed_t
 	statistically unique key is required to allow the sNAP to add the packet
 	to the correct ICN packet buffer and all LTP CTRL messages are for a
 	particular session key */
+	uint8_t version = 1;/*!< The LTP version of the publisher. Only v2
+	CTRL-WEDs carry it */
 };
 /*!
  * \brief LTP control header (NACKs)
@@ -175,8 +205,23 @@ struct ltp_hdr_ctrl_nack_t
 	statistically unique key is required to allow the sNAP to add the packet
 	to the correct ICN packet buffer and all LTP CTRL messages are for a
 	particular session key */
-	uint16_t start;
-	uint16_t end;
+	seq_t start;/*!< First missing sequence (16 bit on the wire) */
+	seq_t end;/*!< Last missing sequence (16 bit on the wire) */
+};
+/*!
+ * \brief LTP control header for selective NACKs (LTP v2)
+ *
+ * The header is followed by a bitmap of bitmapLength octets. Bit i (LSB first)
+ * set means that fragment start + i is missing
+ */
+struct ltp_hdr_ctrl_sack_t
+{
+	ltp_message_types_t messageType = LTP_CONTROL;/*!< LTP message type (CTRL)*/
+	ltp_ctrl_control_types_t controlType = LTP_CONTROL_SACK;
+	enigma_t enigma = 23;/*!< https://en.wikipedia.org/wiki/23_enigma */
+	sk_t sessionKey;/*!< The session key of the LTP session */
+	seq_t start;/*!< First missing sequence number */
+	uint16_t bitmapLength;/*!< Length of the bitmap in octets */
 };
 /*!
  * \brief LTP data header
@@ -192,8 +237,9 @@ struct ltp_hdr_data_t
 	statistically unique key is required to allow the sNAP to add the packet
 	to the correct ICN packet buffer and all LTP CTRL messages are for a
 	particular session key */
-	uint16_t sequenceNumber;/*!< Sequentially generated sequence number for
-	a particular LTP session */
+	seq_t sequenceNumber;/*!< Sequentially generated sequence number for
+	a particular LTP session. 16 bit on the wire for LTP_DATA and 32 bit for
+	LTP_DATA_V2 */
 	uint16_t payloadLength;
 };
 /*!
@@ -202,8 +248,11 @@ struct ltp_hdr_data_t
 struct nack_group_t
 {
 	list<NodeId> nodeIds;/*!< List of NIDs in a particular NACK group*/
-	uint16_t startSequence;/*!< Start sequence number for this NACK group*/
-	uint16_t endSequence;/*!< End sequence number for this NACK group*/
+	ltp_sequences_t sequences;/*!< Sequence numbers missing at any of the
+	NIDs */
 };
 
+typedef map<cid_t, map<enigma_t, map<sk_t, nack_group_t>>> nack_groups_t;/*!<
+		map<rCID, map<enigma, map<SK, nackGroup>>> */
+
 #endif /* NAP_TRANSPORT_LIGHTWEIGHTTYPEDEF_HH_ */
@@ -0,0 +1,65 @@
+/*
+ * ltpmessage.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ltpmessage.hh"
+
+using namespace transport::lightweight;
+
+LtpMessage::LtpMessage(uint8_t *data, uint32_t dataSize)
+	: _dataSize(dataSize),
+	  _references(1)
+{
+	uint32_t paddedSize = dataSize + ((8 - (dataSize % 8)) % 8);
+	_data = (uint8_t *)malloc(paddedSize);
+	memcpy(_data, data, dataSize);
+	memset(_data + dataSize, 0, paddedSize - dataSize);
+}
+
+LtpMessage::~LtpMessage()
+{
+	free(_data);
+}
+
+void LtpMessage::acquire()
+{
+	_references.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint8_t *LtpMessage::data()
+{
+	return _data;
+}
+
+uint32_t LtpMessage::dataSize()
+{
+	return _dataSize;
+}
+
+void LtpMessage::release()
+{
+	if (_references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		delete this;
+	}
+}
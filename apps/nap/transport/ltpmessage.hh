@@ -0,0 +1,91 @@
+/*
+ * ltpmessage.hh
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAP_TRANSPORT_LTPMESSAGE_HH_
+#define NAP_TRANSPORT_LTPMESSAGE_HH_
+
+#include <atomic>
+#include <stdint.h>
+
+#ifdef DMALLOC
+#include "dmalloc.h"
+#endif
+
+namespace transport
+{
+
+namespace lightweight
+{
+
+/*!
+ * \brief Reference counted copy of an HTTP message sent over LTP
+ *
+ * The message is copied once and padded to a multiple of 8 so that the last
+ * fragment can be published straight from the copy. Fragments on the wire and
+ * in the retransmission buffers are slices of this copy and each holder keeps
+ * a reference. The message deletes itself when the last reference has been
+ * released.
+ */
+class LtpMessage
+{
+public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * The caller holds the first reference.
+	 *
+	 * \param data Pointer to the message
+	 * \param dataSize Length of the message
+	 */
+	LtpMessage(uint8_t *data, uint32_t dataSize);
+	/*!
+	 * \brief Obtain another reference
+	 */
+	void acquire();
+	/*!
+	 * \brief Pointer to the copy of the message (incl. padding)
+	 */
+	uint8_t *data();
+	/*!
+	 * \brief Length of the message without padding
+	 */
+	uint32_t dataSize();
+	/*!
+	 * \brief Give up a reference
+	 *
+	 * The message must not be used by the caller afterwards.
+	 */
+	void release();
+private:
+	/*!
+	 * \brief Destructor (only called via release())
+	 */
+	~LtpMessage();
+	uint8_t *_data;/*!< Copy of the message, padded to a multiple of 8 */
+	uint32_t _dataSize;/*!< Length of the message without padding */
+	std::atomic<uint32_t> _references;/*!< Number of holders */
+};
+
+} /* namespace lightweight */
+
+} /* namespace transport */
+
+#endif /* NAP_TRANSPORT_LTPMESSAGE_HH_ */
@@ -0,0 +1,284 @@
+/*
+ * ltppacketstore.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ltppacketstore.hh"
+
+using namespace transport::lightweight;
+
+LtpPacketStore::LtpPacketStore(uint32_t window, uint32_t timeout)
+	: _packets(0),
+	  _window(1),
+	  _timeout(timeout),
+	  _expiryWheel(NULL)
+{
+	while (_window < window)
+	{
+		_window <<= 1;
+	}
+
+	if (_timeout > 0)
+	{
+		_expiryWheel = new ltp_expiry_wheel_t(_timeout);
+	}
+}
+
+LtpPacketStore::~LtpPacketStore()
+{
+	for (ltp_sessions_t::iterator it = _sessions.begin(); it != _sessions.end();
+			it++)
+	{
+		_release(it->second);
+	}
+
+	delete _expiryWheel;
+}
+
+bool LtpPacketStore::add(cid_t rCid, enigma_t enigma, sk_t sessionKey,
+		seq_t sequence, LtpMessage *message, uint8_t *payload,
+		uint16_t payloadLength, uint16_t fragmentSize, bool overwrite)
+{
+	ltp_sessions_t::iterator sessionIt =
+			_sessions.find(key(rCid, enigma, sessionKey));
+
+	if (sessionIt == _sessions.end())
+	{
+		ltp_session_buffer_t session;
+		session.rCid = rCid;
+		session.enigma = enigma;
+		session.sessionKey = sessionKey;
+		session.ring.resize(_window);
+		session.packets = 0;
+		session.expiry = 0;
+		sessionIt = _sessions.insert(pair<ltp_session_key_t,
+				ltp_session_buffer_t>(key(rCid, enigma, sessionKey),
+						session)).first;
+	}
+	// enigmas which only differ in their upper 16 bits
+	else if (sessionIt->second.enigma != enigma)
+	{
+		return false;
+	}
+
+	ltp_session_buffer_t &session = sessionIt->second;
+
+	if (sequence >= session.ring.size())
+	{
+		_grow(session, sequence);
+	}
+
+	ltp_packet_slot_t &slot = session.ring[sequence & (session.ring.size() - 1)];
+
+	if (slot.message != NULL)
+	{
+		if (!overwrite)
+		{
+			return false;
+		}
+
+		slot.message->release();
+	}
+	else
+	{
+		if (session.packets == 0 && _expiryWheel != NULL)
+		{
+			session.expiry = _expiryWheel->schedule(sessionIt->first, _timeout);
+		}
+
+		session.packets++;
+		_packets++;
+	}
+
+	message->acquire();
+	slot.message = message;
+	slot.payload = payload;
+	slot.payloadLength = payloadLength;
+	slot.fragmentSize = fragmentSize;
+	slot.sequence = sequence;
+	return true;
+}
+
+ltp_sessions_t::iterator LtpPacketStore::begin()
+{
+	return _sessions.begin();
+}
+
+void LtpPacketStore::clear(cid_t rCid, enigma_t enigma, sk_t sessionKey)
+{
+	ltp_session_buffer_t *session = find(rCid, enigma, sessionKey);
+
+	if (session != NULL)
+	{
+		_release(*session);
+	}
+}
+
+ltp_sessions_t::iterator LtpPacketStore::end()
+{
+	return _sessions.end();
+}
+
+bool LtpPacketStore::erase(cid_t rCid, enigma_t enigma, sk_t sessionKey)
+{
+	ltp_sessions_t::iterator sessionIt =
+			_sessions.find(key(rCid, enigma, sessionKey));
+
+	if (sessionIt == _sessions.end() || sessionIt->second.enigma != enigma)
+	{
+		return false;
+	}
+
+	erase(sessionIt);
+	return true;
+}
+
+ltp_sessions_t::iterator LtpPacketStore::erase(
+		ltp_sessions_t::iterator sessionIt)
+{
+	_release(sessionIt->second);
+	return _sessions.erase(sessionIt);
+}
+
+uint32_t LtpPacketStore::expire(vector<ltp_session_key_t> &sessions)
+{
+	uint32_t packets = 0;
+
+	if (_expiryWheel == NULL)
+	{
+		return packets;
+	}
+
+	vector<ltp_expiry_wheel_t::expired_t> expired;
+	_expiryWheel->expire(expired);
+
+	for (vector<ltp_expiry_wheel_t::expired_t>::iterator it = expired.begin();
+			it != expired.end(); it++)
+	{
+		ltp_sessions_t::iterator sessionIt = _sessions.find(it->first);
+
+		// session has been erased, emptied or re-stamped in the meantime
+		if (sessionIt == _sessions.end() || sessionIt->second.packets == 0 ||
+				sessionIt->second.expiry != it->second)
+		{
+			continue;
+		}
+
+		packets += sessionIt->second.packets;
+		sessions.push_back(it->first);
+		erase(sessionIt);
+	}
+
+	return packets;
+}
+
+ltp_session_buffer_t *LtpPacketStore::find(cid_t rCid, enigma_t enigma,
+		sk_t sessionKey)
+{
+	ltp_sessions_t::iterator sessionIt =
+			_sessions.find(key(rCid, enigma, sessionKey));
+
+	if (sessionIt == _sessions.end() || sessionIt->second.enigma != enigma)
+	{
+		return NULL;
+	}
+
+	return &sessionIt->second;
+}
+
+ltp_session_key_t LtpPacketStore::key(cid_t rCid, enigma_t enigma,
+		sk_t sessionKey)
+{
+	return ((ltp_session_key_t)rCid << 32) |
+			((ltp_session_key_t)(enigma & 0xffff) << 16) | sessionKey;
+}
+
+uint32_t LtpPacketStore::packets()
+{
+	return _packets;
+}
+
+ltp_packet_slot_t *LtpPacketStore::slot(ltp_session_buffer_t *session,
+		seq_t sequence)
+{
+	if (session == NULL || session->ring.empty())
+	{
+		return NULL;
+	}
+
+	ltp_packet_slot_t &slot =
+			session->ring[sequence & (session->ring.size() - 1)];
+
+	if (slot.message == NULL || slot.sequence != sequence)
+	{
+		return NULL;
+	}
+
+	return &slot;
+}
+
+void LtpPacketStore::_grow(ltp_session_buffer_t &session, seq_t sequence)
+{
+	size_t size = session.ring.size();
+
+	while (size <= sequence)
+	{
+		size <<= 1;
+	}
+
+	vector<ltp_packet_slot_t> ring(size);
+
+	for (vector<ltp_packet_slot_t>::iterator it = session.ring.begin();
+			it != session.ring.end(); it++)
+	{
+		if (it->message != NULL)
+		{
+			ring[it->sequence & (size - 1)] = *it;
+		}
+	}
+
+	session.ring.swap(ring);
+}
+
+void LtpPacketStore::_release(ltp_session_buffer_t &session)
+{
+	if (session.packets == 0)
+	{
+		return;
+	}
+
+	for (vector<ltp_packet_slot_t>::iterator it = session.ring.begin();
+			it != session.ring.end(); it++)
+	{
+		if (it->message != NULL)
+		{
+			it->message->release();
+			it->message = NULL;
+			it->payload = NULL;
+			it->payloadLength = 0;
+			it->fragmentSize = 0;
+		}
+	}
+
+	_packets -= session.packets;
+	session.packets = 0;
+}
@@ -0,0 +1,217 @@
+/*
+ * ltppacketstore.hh
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAP_TRANSPORT_LTPPACKETSTORE_HH_
+#define NAP_TRANSPORT_LTPPACKETSTORE_HH_
+
+#include <unordered_map>
+#include <vector>
+
+#include <types/expirywheel.hh>
+#include <types/typedef.hh>
+#include <transport/ltpmessage.hh>
+
+#ifdef DMALLOC
+#include "dmalloc.h"
+#endif
+
+using namespace std;
+
+namespace transport
+{
+
+namespace lightweight
+{
+
+typedef uint64_t ltp_session_key_t;/*!< Packed rCID > enigma > SK */
+
+/*!
+ * \brief A buffered LTP packet
+ *
+ * The slot does not hold a copy of the fragment but a reference to the message
+ * it was cut from. The LTP header is rebuilt from the session, the sequence and
+ * the payload length whenever the fragment is re-published.
+ */
+struct ltp_packet_slot_t
+{
+	LtpMessage *message = NULL;/*!< Referenced message, NULL if empty */
+	uint8_t *payload = NULL;/*!< Start of the fragment within the message */
+	uint16_t payloadLength = 0;/*!< Fragment length without padding */
+	uint16_t fragmentSize = 0;/*!< Fragment length including padding */
+	seq_t sequence = 0;/*!< Sequence number of the packet */
+};
+
+/*!
+ * \brief The packets buffered for a single rCID > enigma > SK session
+ *
+ * The ring is indexed by sequence & (ring.size() - 1). Its size is a power of
+ * two and starts with the LTP credit window. It is not a fixed-capacity ring
+ * though: a cNAP may NACK any fragment of a message until it has confirmed the
+ * end of the session (CTRL-WEDC), whereas CTRL-WUD only grants new credit
+ * without confirming the reception of the previous windows. The ring therefore
+ * doubles until it holds all fragments of the longest message of the session,
+ * so that a slot is never recycled while it may still be NACKed.
+ */
+struct ltp_session_buffer_t
+{
+	cid_t rCid;/*!< rCID of the session */
+	enigma_t enigma;/*!< https://en.wikipedia.org/wiki/23_enigma */
+	sk_t sessionKey;/*!< SK of the session */
+	vector<ltp_packet_slot_t> ring;/*!< Buffered packets */
+	uint32_t packets;/*!< Number of occupied slots in the ring */
+	uint32_t expiry;/*!< Expiry wheel deadline of the oldest packet currently
+	in the ring */
+};
+
+typedef unordered_map<ltp_session_key_t, ltp_session_buffer_t>
+		ltp_sessions_t;/*!< Packed session key > session buffer */
+
+typedef ExpiryWheel<ltp_session_key_t> ltp_expiry_wheel_t;/*!< Expiry index
+		of the sessions */
+
+/*!
+ * \brief Packet storage of the LTP for NACK retransmissions
+ *
+ * Replaces the former map<rCID, map<enigma, map<SK, map<Sequence, Packet>>>>
+ * trees with a single hash table of sessions, each owning a ring of packet
+ * slots. Slots reference the sent message instead of copying the fragment, so
+ * buffering a packet neither allocates memory nor walks four levels of maps.
+ *
+ * If the store is given a timeout, sessions are put onto an expiry wheel when
+ * their first packet is buffered so that expire() only visits timed out
+ * sessions.
+ *
+ * Like the maps it replaces, this class is not thread-safe. All operations
+ * must be performed while holding the mutex that guards the store.
+ */
+class LtpPacketStore
+{
+public:
+	/*!
+	 * \brief Constructor
+	 * \param window The initial ring size of a session, rounded up to a power
+	 * of two. Rings grow beyond it for messages with more fragments
+	 * \param timeout The time in seconds after which the packets of a session
+	 * are released by expire(). 0 disables the expiry of sessions
+	 */
+	LtpPacketStore(uint32_t window, uint32_t timeout = 0);
+	/*!
+	 * \brief Destructor
+	 */
+	~LtpPacketStore();
+	/*!
+	 * \brief Buffer a fragment of a message
+	 *
+	 * The store acquires a reference to the message which is released again
+	 * together with the slot.
+	 *
+	 * \param rCid The rCID of the session
+	 * \param enigma https://en.wikipedia.org/wiki/23_enigma
+	 * \param sessionKey The SK of the session
+	 * \param sequence The sequence number of the packet
+	 * \param message The message the fragment was cut from
+	 * \param payload Start of the fragment within the message
+	 * \param payloadLength The length of the fragment without padding
+	 * \param fragmentSize The length of the fragment including padding
+	 * \param overwrite Replace an already buffered packet with the same
+	 * sequence number
+	 * \return False if the packet has not been buffered, i.e. the sequence
+	 * exists and overwrite was false or the session key collides
+	 */
+	bool add(cid_t rCid, enigma_t enigma, sk_t sessionKey, seq_t sequence,
+			LtpMessage *message, uint8_t *payload, uint16_t payloadLength,
+			uint16_t fragmentSize, bool overwrite);
+	/*!
+	 * \brief Release all packets of a session but keep its ring for the next
+	 * window
+	 */
+	void clear(cid_t rCid, enigma_t enigma, sk_t sessionKey);
+	/*!
+	 * \brief Release all packets of a session and forget about the session
+	 * \return False if the session does not exist
+	 */
+	bool erase(cid_t rCid, enigma_t enigma, sk_t sessionKey);
+	/*!
+	 * \brief Release all packets of a session and forget about the session
+	 * \return Iterator to the following session
+	 */
+	ltp_sessions_t::iterator erase(ltp_sessions_t::iterator sessionIt);
+	/*!
+	 * \brief Erase all sessions whose oldest packet is older than the timeout
+	 *
+	 * \param sessions The keys of the erased sessions are appended to this
+	 * vector
+	 *
+	 * \return The number of released packets
+	 */
+	uint32_t expire(vector<ltp_session_key_t> &sessions);
+	/*!
+	 * \brief Look up a session
+	 * \return Pointer to the session or NULL if it does not exist
+	 */
+	ltp_session_buffer_t *find(cid_t rCid, enigma_t enigma, sk_t sessionKey);
+	/*!
+	 * \brief Look up a buffered packet of a session
+	 * \return Pointer to the slot or NULL if the sequence is not buffered
+	 */
+	ltp_packet_slot_t *slot(ltp_session_buffer_t *session, seq_t sequence);
+	/*!
+	 * \brief Pack rCID, enigma and SK into the key of the session table
+	 *
+	 * Only the lower 16 bits of the enigma make it into the key. The enigma
+	 * stored in the session tells colliding sessions apart.
+	 */
+	static ltp_session_key_t key(cid_t rCid, enigma_t enigma,
+			sk_t sessionKey);
+	/*!
+	 * \brief Begin of the session table
+	 */
+	ltp_sessions_t::iterator begin();
+	/*!
+	 * \brief End of the session table
+	 */
+	ltp_sessions_t::iterator end();
+	/*!
+	 * \brief The number of buffered packets
+	 */
+	uint32_t packets();
+private:
+	ltp_sessions_t _sessions;/*!< The session table */
+	uint32_t _packets;/*!< Number of occupied slots over all sessions */
+	uint32_t _window;/*!< Initial ring size */
+	uint32_t _timeout;/*!< Session timeout in seconds, 0 if disabled */
+	ltp_expiry_wheel_t *_expiryWheel;/*!< Expiry index, NULL if disabled */
+	/*!
+	 * \brief Release all packets in the ring of a session and the references
+	 * they hold
+	 */
+	void _release(ltp_session_buffer_t &session);
+	/*!
+	 * \brief Grow the ring of a session so that sequence has its own slot
+	 */
+	void _grow(ltp_session_buffer_t &session, seq_t sequence);
+};
+
+} /* namespace lightweight */
+
+} /* namespace transport */
+
+#endif /* NAP_TRANSPORT_LTPPACKETSTORE_HH_ */
@@ -0,0 +1,437 @@
+/*
+ * ltpsender.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ltpsender.hh"
+
+using namespace transport::lightweight;
+
+LoggerPtr LtpSender::logger(Logger::getLogger("transport.ltpsender"));
+
+LtpSender::LtpSender(uint32_t initialWindow, uint16_t rttMultiplier, bool *run)
+	: _initialWindow(initialWindow),
+	  _rttMultiplier(rttMultiplier),
+	  _rtt(200),// milli seconds, same as the initial RTT list of LTP
+	  _run(run),
+	  _queuedBytes(0)
+{
+	if (_initialWindow == 0)
+	{
+		_initialWindow = 1;
+	}
+
+	if (_rttMultiplier == 0)
+	{
+		_rttMultiplier = 1;
+	}
+}
+
+LtpSender::~LtpSender()
+{
+	unordered_map<ltp_session_key_t, ltp_sender_session_t>::iterator it;
+
+	for (it = _sessions.begin(); it != _sessions.end(); it++)
+	{
+		for (list<ltp_sender_message_t>::iterator msgIt =
+				it->second.messages.begin();
+				msgIt != it->second.messages.end(); msgIt++)
+		{
+			msgIt->message->release();
+		}
+	}
+}
+
+void LtpSender::enqueue(IcnId &cId, IcnId &rCId, enigma_t enigma,
+		sk_t sessionKey, uint8_t *data, uint16_t dataSize, uint16_t mtu)
+{
+	ltp_sender_message_t message;
+	// the last fragment is padded to a multiple of 8 straight from the copy
+	message.message = new LtpMessage(data, dataSize);
+	message.dataSize = dataSize;
+	message.sentBytes = 0;
+	message.mtu = mtu - (mtu % 8);
+
+	if (message.mtu == 0)
+	{
+		message.mtu = 8;
+	}
+
+	ltp_session_key_t key = LtpPacketStore::key(rCId.uint(), enigma,
+			sessionKey);
+	_mutex.lock();
+	unordered_map<ltp_session_key_t, ltp_sender_session_t>::iterator it =
+			_sessions.find(key);
+
+	if (it == _sessions.end())
+	{
+		ltp_sender_session_t session;
+		session.cId = cId;
+		session.rCId = rCId;
+		session.enigma = enigma;
+		session.sessionKey = sessionKey;
+		session.state = LTP_SENDER_STATE_SENDING;
+		session.sequence = 0;
+		session.credit = _path(cId).window;
+		session.windowUpdatePending = false;
+		session.attempts = ENIGMA;
+		session.deadline = ltp_clock_t::now();
+		it = _sessions.insert(pair<ltp_session_key_t, ltp_sender_session_t>(
+				key, session)).first;
+	}
+	else if (it->second.enigma != enigma)
+	{
+		_mutex.unlock();
+		LOG4CXX_WARN(logger, "Session key of rCID " << rCId.print()
+				<< " > enigma " << enigma << " > SK " << sessionKey
+				<< " collides with enigma " << it->second.enigma << ". "
+				"Message of length " << dataSize << " dropped");
+		message.message->release();
+		return;
+	}
+
+	it->second.messages.push_back(message);
+	_queuedBytes += dataSize;
+	LOG4CXX_TRACE(logger, "Message of length " << dataSize << " queued for "
+			"rCID " << rCId.print() << " > enigma " << enigma << " > SK "
+			<< sessionKey << " (" << it->second.messages.size() << " in "
+			"session queue, " << _queuedBytes << " bytes in all queues)");
+	_mutex.unlock();
+	_condition.notify_one();
+}
+
+bool LtpSender::next(list<ltp_sender_action_t> &actions)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	while (*_run)
+	{
+		ltp_clock_t::time_point now = ltp_clock_t::now();
+		// check the run flag at least once a second
+		ltp_clock_t::time_point wakeUp = now + std::chrono::seconds(1);
+		unordered_map<ltp_session_key_t, ltp_sender_session_t>::iterator it =
+				_sessions.begin();
+
+		while (it != _sessions.end())
+		{
+			if (!_schedule(it->second, now, actions, wakeUp))
+			{
+				it = _sessions.erase(it);
+			}
+			else
+			{
+				it++;
+			}
+		}
+
+		if (!actions.empty())
+		{
+			return true;
+		}
+
+		_condition.wait_until(lock, wakeUp);
+	}
+
+	return false;
+}
+
+void LtpSender::rtt(uint16_t rtt)
+{
+	_mutex.lock();
+	_rtt = (rtt == 0) ? 1 : rtt;
+	_mutex.unlock();
+}
+
+bool LtpSender::windowEnded(IcnId &rCId, enigma_t enigma, sk_t sessionKey,
+		IcnId &cId, uint16_t &rtt)
+{
+	ltp_clock_t::time_point now = ltp_clock_t::now();
+	_mutex.lock();
+	unordered_map<ltp_session_key_t, ltp_sender_session_t>::iterator it =
+			_sessions.find(LtpPacketStore::key(rCId.uint(), enigma,
+					sessionKey));
+
+	if (it == _sessions.end() || it->second.enigma != enigma
+			|| it->second.state != LTP_SENDER_STATE_AWAITING_WED)
+	{
+		_mutex.unlock();
+		return false;
+	}
+
+	ltp_sender_session_t &session = it->second;
+	ltp_sender_path_t &path = _path(session.cId);
+	cId = session.cId;
+	rtt = std::min<int64_t>(65535,
+			std::chrono::duration_cast<std::chrono::milliseconds>(
+					now - session.windowEndSent).count());
+
+	// additive increase
+	if (path.window < LTP_SENDER_MAX_WINDOW)
+	{
+		path.window++;
+	}
+
+	LOG4CXX_TRACE(logger, "CTRL-WED for rCID " << rCId.print() << " > enigma "
+			<< enigma << " > SK " << sessionKey << " received after " << rtt
+			<< "ms. Window for CID " << session.cId.print() << " now "
+			<< path.window);
+
+	if (!_nextMessage(session, now))
+	{
+		_sessions.erase(it);
+	}
+
+	_mutex.unlock();
+	_condition.notify_one();
+	return true;
+}
+
+bool LtpSender::windowUpdated(IcnId &rCId, enigma_t enigma, sk_t sessionKey,
+		uint16_t &rtt)
+{
+	ltp_clock_t::time_point now = ltp_clock_t::now();
+	_mutex.lock();
+	unordered_map<ltp_session_key_t, ltp_sender_session_t>::iterator it =
+			_sessions.find(LtpPacketStore::key(rCId.uint(), enigma,
+					sessionKey));
+
+	if (it == _sessions.end() || it->second.enigma != enigma
+			|| !it->second.windowUpdatePending)
+	{
+		_mutex.unlock();
+		return false;
+	}
+
+	ltp_sender_session_t &session = it->second;
+	ltp_sender_path_t &path = _path(session.cId);
+	rtt = std::min<int64_t>(65535,
+			std::chrono::duration_cast<std::chrono::milliseconds>(
+					now - session.windowUpdateSent).count());
+	path.windowUpdates = true;
+
+	// additive increase
+	if (path.window < LTP_SENDER_MAX_WINDOW)
+	{
+		path.window++;
+	}
+
+	session.windowUpdatePending = false;
+	session.credit = std::min(session.credit + path.window, 2 * path.window);
+
+	if (session.state == LTP_SENDER_STATE_AWAITING_WUD)
+	{
+		session.state = LTP_SENDER_STATE_SENDING;
+		session.deadline = now;
+	}
+
+	LOG4CXX_TRACE(logger, "CTRL-WUD for rCID " << rCId.print() << " > enigma "
+			<< enigma << " > SK " << sessionKey << " received after " << rtt
+			<< "ms. Credit " << session.credit << ", window for CID "
+			<< session.cId.print() << " now " << path.window);
+	_mutex.unlock();
+	_condition.notify_one();
+	return true;
+}
+
+ltp_sender_path_t &LtpSender::_path(IcnId &cId)
+{
+	unordered_map<cid_t, ltp_sender_path_t>::iterator it =
+			_paths.find(cId.uint());
+
+	if (it == _paths.end())
+	{
+		ltp_sender_path_t path;
+		path.window = _initialWindow;
+		path.windowUpdates = false;
+		it = _paths.insert(pair<cid_t, ltp_sender_path_t>(cId.uint(),
+				path)).first;
+	}
+
+	return it->second;
+}
+
+bool LtpSender::_nextMessage(ltp_sender_session_t &session,
+		ltp_clock_t::time_point now)
+{
+	_queuedBytes -= session.messages.front().dataSize;
+	session.messages.front().message->release();
+	session.messages.pop_front();
+
+	if (session.messages.empty())
+	{
+		return false;
+	}
+
+	session.state = LTP_SENDER_STATE_SENDING;
+	session.sequence = 0;
+	session.credit = _path(session.cId).window;
+	session.windowUpdatePending = false;
+	session.attempts = ENIGMA;
+	session.deadline = now;
+	return true;
+}
+
+bool LtpSender::_schedule(ltp_sender_session_t &session,
+		ltp_clock_t::time_point now, list<ltp_sender_action_t> &actions,
+		ltp_clock_t::time_point &wakeUp)
+{
+	ltp_sender_path_t &path = _path(session.cId);
+	ltp_sender_action_t action;
+	action.cId = session.cId;
+	action.rCId = session.rCId;
+	action.enigma = session.enigma;
+	action.sessionKey = session.sessionKey;
+	action.message = NULL;
+	action.payload = NULL;
+	action.payloadLength = 0;
+	action.fragmentSize = 0;
+
+	if (session.state == LTP_SENDER_STATE_AWAITING_WED)
+	{
+		if (now < session.deadline)
+		{
+			wakeUp = std::min(wakeUp, session.deadline);
+			return true;
+		}
+
+		session.attempts--;
+
+		if (session.attempts == 0)
+		{
+			LOG4CXX_DEBUG(logger, "Subscriber to CID " << session.cId.print()
+					<< " has not responded to WE CTRL message after "
+					<< (int)ENIGMA << " attempts. Stopping here");
+
+			if (!_nextMessage(session, now))
+			{
+				return false;
+			}
+
+			wakeUp = now;
+			return true;
+		}
+
+		action.action = LTP_SENDER_ACTION_WINDOW_END;
+		action.sequence = session.sequence;
+		action.window = path.window;
+		actions.push_back(action);
+		session.deadline = now + _timeout();
+		wakeUp = std::min(wakeUp, session.deadline);
+		return true;
+	}
+
+	if (session.state == LTP_SENDER_STATE_AWAITING_WUD)
+	{
+		if (now < session.deadline)
+		{
+			wakeUp = std::min(wakeUp, session.deadline);
+			return true;
+		}
+
+		// multiplicative decrease, unless the sNAP never sends CTRL-WUDs
+		if (path.windowUpdates)
+		{
+			path.window = (path.window > 1) ? path.window / 2 : 1;
+			LOG4CXX_DEBUG(logger, "CTRL-WUD not received for rCID "
+					<< session.rCId.print() << " > enigma " << session.enigma
+					<< " > SK " << session.sessionKey << ". Window for CID "
+					<< session.cId.print() << " reduced to " << path.window);
+		}
+
+		session.credit = path.window;
+		session.windowUpdatePending = false;
+		session.state = LTP_SENDER_STATE_SENDING;
+		session.deadline = now;
+	}
+
+	ltp_sender_message_t &message = session.messages.front();
+	// spread a window of fragments over one RTT
+	ltp_clock_t::duration interval = std::chrono::microseconds(
+			(uint64_t)_rtt * 1000 / path.window);
+
+	// keep a CTRL-WU in flight while there is data left, so that its CTRL-WUD
+	// refills the credit before it runs out
+	if (!session.windowUpdatePending && message.sentBytes < message.dataSize)
+	{
+		action.action = LTP_SENDER_ACTION_WINDOW_UPDATE;
+		action.sequence = session.sequence;
+		action.window = path.window;
+		actions.push_back(action);
+		session.windowUpdatePending = true;
+		session.windowUpdateSent = now;
+	}
+
+	while (session.credit > 0 && message.sentBytes < message.dataSize
+			&& session.deadline <= now)
+	{
+		action.action = LTP_SENDER_ACTION_DATA;
+		action.message = message.message;
+		action.message->acquire();
+		action.payload = message.message->data() + message.sentBytes;
+		action.payloadLength = message.dataSize - message.sentBytes;
+
+		if (action.payloadLength > message.mtu)
+		{
+			action.payloadLength = message.mtu;
+		}
+
+		action.fragmentSize = action.payloadLength
+				+ ((8 - (action.payloadLength % 8)) % 8);
+		session.sequence++;
+		action.sequence = session.sequence;
+		action.window = path.window;
+		actions.push_back(action);
+		message.sentBytes += action.payloadLength;
+		session.credit--;
+		session.deadline += interval;
+	}
+
+	// all fragments out. CTRL-WE
+	if (message.sentBytes == message.dataSize)
+	{
+		action.action = LTP_SENDER_ACTION_WINDOW_END;
+		action.message = NULL;
+		action.payload = NULL;
+		action.payloadLength = 0;
+		action.fragmentSize = 0;
+		action.sequence = session.sequence;
+		action.window = path.window;
+		actions.push_back(action);
+		session.state = LTP_SENDER_STATE_AWAITING_WED;
+		session.attempts = ENIGMA;
+		session.windowEndSent = now;
+		session.deadline = now + _timeout();
+	}
+	// out of credit. Wait for the CTRL-WUD, but not longer than the previous
+	// implementation slept if the sNAP does not support them
+	else if (session.credit == 0)
+	{
+		session.state = LTP_SENDER_STATE_AWAITING_WUD;
+		session.deadline = session.windowUpdateSent + (path.windowUpdates ?
+				_timeout() : std::chrono::milliseconds(_rtt));
+	}
+
+	wakeUp = std::min(wakeUp, session.deadline);
+	return true;
+}
+
+ltp_clock_t::duration LtpSender::_timeout()
+{
+	return std::chrono::milliseconds((uint32_t)_rttMultiplier * _rtt);
+}
@@ -0,0 +1,255 @@
+/*
+ * ltpsender.hh
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAP_TRANSPORT_LTPSENDER_HH_
+#define NAP_TRANSPORT_LTPSENDER_HH_
+
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <log4cxx/logger.h>
+#include <mutex>
+#include <unordered_map>
+
+#include <types/enumerations.hh>
+#include <types/icnid.hh>
+#include <types/typedef.hh>
+#include <transport/ltpmessage.hh>
+#include <transport/ltppacketstore.hh>
+
+#ifdef DMALLOC
+#include "dmalloc.h"
+#endif
+
+#define LTP_SENDER_MAX_WINDOW 512 // fragments
+
+using namespace log4cxx;
+using namespace std;
+
+namespace transport
+{
+
+namespace lightweight
+{
+
+typedef std::chrono::steady_clock ltp_clock_t;
+
+/*!
+ * \brief A message (HTTP request) waiting in the send queue of a session
+ */
+struct ltp_sender_message_t
+{
+	LtpMessage *message;/*!< Reference counted copy of the message */
+	uint16_t dataSize;/*!< Length of the message without padding */
+	uint16_t sentBytes;/*!< Number of bytes already fragmented */
+	uint16_t mtu;/*!< Maximal fragment payload for this message */
+};
+
+/*!
+ * \brief Something the publishing thread has to put onto the wire
+ *
+ * Data actions point into the message copy held by the sender and carry their
+ * own reference to it, which the publishing thread releases once the fragment
+ * has been published and buffered for NACKs.
+ */
+struct ltp_sender_action_t
+{
+	ltp_sender_actions_t action;/*!< What to publish */
+	IcnId cId;/*!< The CID (FQDN) */
+	IcnId rCId;/*!< The rCID (URL) */
+	enigma_t enigma;/*!< https://en.wikipedia.org/wiki/23_enigma */
+	sk_t sessionKey;/*!< The SK */
+	seq_t sequence;/*!< Sequence of the fragment or the last sequence (WE) */
+	LtpMessage *message;/*!< Referenced message (data only) */
+	uint8_t *payload;/*!< Start of the fragment payload (data only) */
+	uint16_t payloadLength;/*!< Fragment length without padding */
+	uint16_t fragmentSize;/*!< Fragment length including padding */
+	uint32_t window;/*!< Congestion window at the time (for logging) */
+};
+
+/*!
+ * \brief Congestion state towards an FQDN, kept across sessions
+ */
+struct ltp_sender_path_t
+{
+	uint32_t window;/*!< Congestion window in fragments */
+	bool windowUpdates;/*!< The sNAP has answered a CTRL-WU at least once */
+};
+
+/*!
+ * \brief Send state of a single rCID > enigma > SK session
+ */
+struct ltp_sender_session_t
+{
+	IcnId cId;/*!< The CID (FQDN) */
+	IcnId rCId;/*!< The rCID (URL) */
+	enigma_t enigma;/*!< https://en.wikipedia.org/wiki/23_enigma */
+	sk_t sessionKey;/*!< The SK */
+	list<ltp_sender_message_t> messages;/*!< Send queue. Front is in flight */
+	ltp_sender_states_t state;/*!< Where the front message is */
+	seq_t sequence;/*!< Last sequence number sent for the front message */
+	uint32_t credit;/*!< Fragments which may be sent without a CTRL-WUD */
+	bool windowUpdatePending;/*!< A CTRL-WU is outstanding */
+	uint8_t attempts;/*!< CTRL-WE attempts left */
+	ltp_clock_t::time_point deadline;/*!< Next fragment is due (SENDING) or
+	the timeout of the CTRL-WE or CTRL-WU expires */
+	ltp_clock_t::time_point windowUpdateSent;/*!< When the CTRL-WU was sent */
+	ltp_clock_t::time_point windowEndSent;/*!< When the first CTRL-WE for the
+	front message was sent */
+};
+
+/*!
+ * \brief Non-blocking scheduler for LTP data sent from the cNAP to the sNAP
+ *
+ * Messages are copied into a per-session send queue and the calling thread
+ * returns immediately. A single publishing thread obtains what is due via
+ * next() and performs the actual publications.
+ *
+ * Each FQDN has a congestion window which is grown by one fragment for every
+ * CTRL-WUD and CTRL-WED received (additive increase) and halved whenever a
+ * CTRL-WU times out (multiplicative decrease). The fragments of a window are
+ * paced over the mean RTT. Half way through the credit a CTRL-WU is sent so
+ * that the CTRL-WUD usually arrives before the credit runs out.
+ *
+ * sNAPs which never answer a CTRL-WU (older versions) do not shrink the window;
+ * the sender continues after the timeout as the previous implementation did
+ * after sleeping for one RTT.
+ */
+class LtpSender
+{
+	static LoggerPtr logger;
+public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param initialWindow The congestion window of a new FQDN (LTP credit)
+	 * \param rttMultiplier Multiplier for CTRL-WU and CTRL-WE timeouts
+	 * \param run Pointer to the run boolean of the main thread
+	 */
+	LtpSender(uint32_t initialWindow, uint16_t rttMultiplier, bool *run);
+	/*!
+	 * \brief Destructor
+	 */
+	~LtpSender();
+	/*!
+	 * \brief Queue a message for transmission
+	 *
+	 * The data is copied and the method never blocks on the network.
+	 *
+	 * \param cId The CID (FQDN)
+	 * \param rCId The rCID (URL)
+	 * \param enigma https://en.wikipedia.org/wiki/23_enigma
+	 * \param sessionKey The SK
+	 * \param data Pointer to the message
+	 * \param dataSize Length of the message
+	 * \param mtu Maximal fragment payload, a multiple of 8
+	 */
+	void enqueue(IcnId &cId, IcnId &rCId, enigma_t enigma, sk_t sessionKey,
+			uint8_t *data, uint16_t dataSize, uint16_t mtu);
+	/*!
+	 * \brief Obtain everything which is due for publication
+	 *
+	 * Blocks until at least one action is due.
+	 *
+	 * \param actions List the due actions are appended to
+	 *
+	 * \return False if the NAP is shutting down
+	 */
+	bool next(list<ltp_sender_action_t> &actions);
+	/*!
+	 * \brief Set the RTT used for pacing and timeouts
+	 *
+	 * \param rtt The mean RTT in milliseconds
+	 */
+	void rtt(uint16_t rtt);
+	/*!
+	 * \brief CTRL-WED received
+	 *
+	 * Completes the message in flight and moves on to the next one in the
+	 * session's queue.
+	 *
+	 * \param rCId The rCID of the session
+	 * \param enigma https://en.wikipedia.org/wiki/23_enigma
+	 * \param sessionKey The SK of the session
+	 * \param cId The CID of the session is written to this reference
+	 * \param rtt The time between the first CTRL-WE and the CTRL-WED in ms
+	 *
+	 * \return True if the session was waiting for this CTRL-WED
+	 */
+	bool windowEnded(IcnId &rCId, enigma_t enigma, sk_t sessionKey,
+			IcnId &cId, uint16_t &rtt);
+	/*!
+	 * \brief CTRL-WUD received
+	 *
+	 * \param rCId The rCID of the session
+	 * \param enigma https://en.wikipedia.org/wiki/23_enigma
+	 * \param sessionKey The SK of the session
+	 * \param rtt The time between the CTRL-WU and the CTRL-WUD in ms
+	 *
+	 * \return True if the session was waiting for this CTRL-WUD
+	 */
+	bool windowUpdated(IcnId &rCId, enigma_t enigma, sk_t sessionKey,
+			uint16_t &rtt);
+private:
+	uint32_t _initialWindow;/*!< Window of an unknown FQDN */
+	uint16_t _rttMultiplier;/*!< Multiplier for timeouts */
+	uint16_t _rtt;/*!< Mean RTT [ms] */
+	bool *_run;/*!< Pointer to run boolean from main thread */
+	std::mutex _mutex;/*!< Mutex for all members below */
+	std::condition_variable _condition;/*!< Wakes up the publishing thread */
+	unordered_map<ltp_session_key_t, ltp_sender_session_t> _sessions;/*!<
+	Sessions with queued messages */
+	unordered_map<cid_t, ltp_sender_path_t> _paths;/*!< Congestion state per
+	FQDN */
+	uint32_t _queuedBytes;/*!< Bytes waiting in all send queues */
+	/*!
+	 * \brief Obtain the congestion state for an FQDN
+	 */
+	ltp_sender_path_t &_path(IcnId &cId);
+	/*!
+	 * \brief Release the front message and prepare the next one
+	 *
+	 * \return False if the session's queue is empty now
+	 */
+	bool _nextMessage(ltp_sender_session_t &session,
+			ltp_clock_t::time_point now);
+	/*!
+	 * \brief Collect the due actions of a session
+	 *
+	 * \param wakeUp Lowered to the next point in time this session needs
+	 * attention
+	 *
+	 * \return False if the session has nothing left to do
+	 */
+	bool _schedule(ltp_sender_session_t &session, ltp_clock_t::time_point now,
+			list<ltp_sender_action_t> &actions,
+			ltp_clock_t::time_point &wakeUp);
+	/*!
+	 * \brief The CTRL-WE and CTRL-WU timeout
+	 */
+	ltp_clock_t::duration _timeout();
+};
+
+} /* namespace lightweight */
+
+} /* namespace transport */
+
+#endif /* NAP_TRANSPORT_LTPSENDER_HH_ */
@@ -40,8 +40,8 @@ tp_states_t Transport::handle(IcnId &cId, void *packet, uint16_t &packetSize,
 		_tpState = TP_STATE_NO_ACTION_REQUIRED;
 		break;
 	case NAMESPACE_HTTP:
-		_tpState = Lightweight::handle(cId, (uint8_t *)packet, enigma,
-				sessionKey);
+		_tpState = Lightweight::handle(cId, (uint8_t *)packet, packetSize,
+				enigma, sessionKey);
 		break;
 	case NAMESPACE_MANAGEMENT:
 		_tpState = TP_STATE_NO_TRANSPORT_PROTOCOL_USED;
@@ -60,7 +60,7 @@ tp_states_t Transport::handle(IcnId &cId, IcnId &rCId, string &nodeId,
 	{
 	case NAMESPACE_HTTP:
 		_tpState = Lightweight::handle(cId, rCId, nodeId, (uint8_t *)packet,
-				enigma, sessionKey);
+				packetSize, enigma, sessionKey);
 		break;
 	default:
 		_tpState = TP_STATE_NO_ACTION_REQUIRED;
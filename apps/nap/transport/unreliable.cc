@@ -107,6 +107,11 @@ void Unreliable::publish(IcnId &icnId, uint8_t *data, uint16_t &dataSize)
 	}
 }
 
+void Unreliable::flush()
+{
+	_ipSocket.flushPackets();
+}
+
 void Unreliable::handle(IcnId &icnId, uint8_t *data, uint16_t &dataSize)
 {
 	pair<utp_header_t, uint8_t *> packet;
@@ -215,7 +220,7 @@ void Unreliable::handle(IcnId &icnId, uint8_t *data, uint16_t &dataSize)
 			free(_packetIt->second.second);
 		}
 
-		_ipSocket.sendPacket(reassembledPacket, reassembledPacketLength);
+		_ipSocket.queuePacket(reassembledPacket, reassembledPacketLength);
 		free(reassembledPacket);
 		_reassemblyBuffer.erase(_reassemblyBufferIt);
 		_reassemblyBufferMutex.unlock();
@@ -226,7 +231,7 @@ void Unreliable::handle(IcnId &icnId, uint8_t *data, uint16_t &dataSize)
 		LOG4CXX_TRACE(logger, "Single packet received for unique UTP key "
 				<< packet.first.key << ", Sequence: "
 				<< (uint16_t)packet.first.sequence << ", Length " << dataSize);
-		_ipSocket.sendPacket(data, dataSize);
+		_ipSocket.queuePacket(data, dataSize);
 		break;
 	}
 	default:
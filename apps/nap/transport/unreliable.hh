@@ -65,6 +65,14 @@ namespace transport
 			 * \brief Destructor
 			 */
 			~Unreliable();
+			/*!
+			 * \brief Send the IP packets the calling thread has reassembled
+			 *
+			 * Reassembled packets are queued in the IP socket batch of the
+			 * calling thread. The ICN worker threads call this method once
+			 * they have no further events queued.
+			 */
+			void flush();
 			/*!
 			 * \brief Publish data to the ICN core
 			 *
@@ -91,6 +91,32 @@ enum Log4cxxLevels {
 	LOG4CXX_LEVELS_TRACE=5000	/*!< trace logging and above */
 };
 
+/*!
+ * \brief Backend the demux uses to capture IP packets from endpoints
+ */
+enum capture_backend_t
+{
+	CAPTURE_BACKEND_PCAP,/*!< libpcap, one demux thread */
+	CAPTURE_BACKEND_TPACKET_V3/*!< AF_PACKET TPACKET_V3 ring per demux thread*/
+};
+/*!
+ * \brief Groups a cNAP keeps receiving from the sNAP after their last IP
+ * client has left
+ */
+enum igmp_warm_groups_policy_t
+{
+	IGMP_WARM_GROUPS_RECENT,/*!< The most recently left groups */
+	IGMP_WARM_GROUPS_POPULAR/*!< The most often joined groups */
+};
+/*!
+ * \brief Which packet the IP handler drops when the buffer of a CID is full
+ */
+enum ip_buffer_drop_policy_t
+{
+	IP_BUFFER_DROP_OLDEST,/*!< The oldest packets buffered for the CID */
+	IP_BUFFER_DROP_TAIL/*!< The packet which does not fit anymore */
+};
+
 enum local_surrogacy_method_t
 {
 	LOCAL_SURROGACY_METHOD_KERNEL,/*!< use iptables to forward any TCP packet */
@@ -103,7 +129,8 @@ enum local_surrogacy_method_t
 enum ltp_message_types_t
 {
 	LTP_DATA,
-	LTP_CONTROL
+	LTP_CONTROL,
+	LTP_DATA_V2/*!< LTP v2 data fragment with a 32-bit sequence number */
 };
 /*!
  * \brief LTP control message types
@@ -118,7 +145,27 @@ enum ltp_ctrl_control_types_t
 	LTP_CONTROL_WINDOW_END,
 	LTP_CONTROL_WINDOW_ENDED,
 	LTP_CONTROL_WINDOW_UPDATE,
-	LTP_CONTROL_WINDOW_UPDATED
+	LTP_CONTROL_WINDOW_UPDATED,
+	LTP_CONTROL_SACK/*!< LTP v2 selective NACK carrying a bitmap of missing
+	fragments */
+};
+/*!
+ * \brief States of a session in the LTP sender
+ */
+enum ltp_sender_states_t
+{
+	LTP_SENDER_STATE_SENDING,/*!< Fragments are published as credit allows */
+	LTP_SENDER_STATE_AWAITING_WUD,/*!< Credit exhausted, waiting for CTRL-WUD */
+	LTP_SENDER_STATE_AWAITING_WED/*!< All fragments sent, waiting for CTRL-WED*/
+};
+/*!
+ * \brief Actions the LTP sender hands over to the publishing thread
+ */
+enum ltp_sender_actions_t
+{
+	LTP_SENDER_ACTION_DATA,/*!< Publish a data fragment */
+	LTP_SENDER_ACTION_WINDOW_UPDATE,/*!< Publish a CTRL-WU */
+	LTP_SENDER_ACTION_WINDOW_END/*!< Publish a CTRL-WE */
 };
 /*!
  * \brief Transport protocol states
@@ -173,6 +220,56 @@ enum http_methods_t
 	HTTP_METHOD_RESPONSE_SERVICEUNAVAILABLE,/*503*/
 	HTTP_METHOD_RESPONSE_GATEWAYTIMEOUT/*504*/
 };
+/*!
+ * \brief Outcome of looking up an HTTP request in the cNAP's response cache
+ */
+enum http_cache_lookup_t
+{
+	HTTP_CACHE_LOOKUP_MISS,// request must be published over ICN
+	HTTP_CACHE_LOOKUP_HIT,// response served from the cache
+	HTTP_CACHE_LOOKUP_COALESCED// awaits the response of an identical request
+};
+/*!
+ * \brief Position of the TCP client within an HTTP response
+ *
+ * Used by the sNAP to determine when a response has been entirely received and
+ * the connection to the server can be returned to the pool
+ */
+enum http_response_framing_t
+{
+	HTTP_RESPONSE_FRAMING_HEADER,// expecting the status line
+	HTTP_RESPONSE_FRAMING_LENGTH,// body with Content-Length
+	HTTP_RESPONSE_FRAMING_CHUNK_SIZE,// chunk size line
+	HTTP_RESPONSE_FRAMING_CHUNK_DATA,// chunk data
+	HTTP_RESPONSE_FRAMING_CHUNK_DATA_END,// CRLF after chunk data
+	HTTP_RESPONSE_FRAMING_CHUNK_TRAILER,// trailer after the last chunk
+	HTTP_RESPONSE_FRAMING_CLOSE,// body ends when the server closes
+	HTTP_RESPONSE_FRAMING_COMPLETE// response entirely received
+};
+/*!
+ * \brief Counters each thread updates in its own statistics shard
+ */
+enum statistics_counters_t
+{
+	STATISTICS_COUNTER_CMC_GROUPS,// number of CMC groups reported
+	STATISTICS_COUNTER_CMC_GROUP_SIZES,// sum of their sizes
+	STATISTICS_COUNTER_HTTP_CACHE_BYTES_SAVED,
+	STATISTICS_COUNTER_HTTP_CACHE_COALESCED,
+	STATISTICS_COUNTER_HTTP_CACHE_HITS,
+	STATISTICS_COUNTER_HTTP_CACHE_REQUESTS,
+	STATISTICS_COUNTER_IP_BUFFER_DROPPED_BYTES,
+	STATISTICS_COUNTER_IP_BUFFER_DROPPED_PACKETS,
+	STATISTICS_COUNTER_RX_HTTP_BYTES,
+	STATISTICS_COUNTER_RX_IGMP_BYTES,
+	STATISTICS_COUNTER_RX_IP_BYTES,
+	STATISTICS_COUNTER_TCP_CLIENT_POOL_HITS,
+	STATISTICS_COUNTER_TCP_CLIENT_POOL_REQUESTS,
+	STATISTICS_COUNTER_TCP_SOCKETS,// sockets opened minus sockets closed
+	STATISTICS_COUNTER_TX_HTTP_BYTES,
+	STATISTICS_COUNTER_TX_IGMP_BYTES,
+	STATISTICS_COUNTER_TX_IP_BYTES,
+	STATISTICS_COUNTERS// number of counters, must be last
+};
 /*!
  * Preferred socket type to communicate with IP endpoints when using the IP
  * handler
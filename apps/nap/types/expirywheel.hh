@@ -0,0 +1,156 @@
+/*
+ * expirywheel.hh
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAP_TYPES_EXPIRYWHEEL_HH_
+#define NAP_TYPES_EXPIRYWHEEL_HH_
+
+#include <chrono>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#ifdef DMALLOC
+#include "dmalloc.h"
+#endif
+
+using namespace std;
+
+/*!
+ * \brief Timer wheel with a granularity of one second for buffer expiry
+ *
+ * Buffers schedule a key when an entry is (re-)stamped and remember the
+ * returned deadline in the entry. Entries are never removed from the wheel;
+ * when the deadline of a key comes up the owner compares it against the
+ * deadline stored in the entry and ignores keys whose entry has meanwhile been
+ * deleted or re-stamped. Expiring entries therefore costs O(expired + stale)
+ * instead of a walk over the entire buffer.
+ *
+ * Like the buffers it indexes, the wheel is not thread-safe and must be used
+ * while holding the buffer's mutex.
+ */
+template<typename key_t>
+class ExpiryWheel
+{
+public:
+	typedef pair<key_t, uint32_t> expired_t;/*!< Key > deadline */
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param horizon The longest timeout in seconds keys are scheduled with.
+	 * Longer timeouts still work but keys are visited once per wheel turn.
+	 */
+	ExpiryWheel(uint32_t horizon)
+		: _tick(now())
+	{
+		uint32_t buckets = 1;
+
+		while (buckets <= horizon)
+		{
+			buckets <<= 1;
+		}
+
+		_buckets.resize(buckets);
+		_size = 0;
+	}
+	/*!
+	 * \brief Schedule a key
+	 *
+	 * \param key The key of the buffer entry
+	 * \param timeout The entry expires once it is older than timeout seconds
+	 *
+	 * \return The deadline the owner stores in its entry
+	 */
+	uint32_t schedule(key_t key, uint32_t timeout)
+	{
+		uint32_t deadline = now() + timeout + 1;
+		_buckets[deadline & (_buckets.size() - 1)].push_back(
+				expired_t(key, deadline));
+		_size++;
+		return deadline;
+	}
+	/*!
+	 * \brief Take all keys whose deadline has passed off the wheel
+	 *
+	 * \param expired The keys and the deadlines they were scheduled with are
+	 * appended to this vector
+	 */
+	void expire(vector<expired_t> &expired)
+	{
+		uint32_t currentTick = now();
+		uint32_t ticks = currentTick - _tick + 1;
+
+		// the thread did not run for more than a wheel turn
+		if (ticks > _buckets.size())
+		{
+			ticks = _buckets.size();
+		}
+
+		for (uint32_t i = 0; i < ticks; i++)
+		{
+			vector<expired_t> &bucket =
+					_buckets[(_tick + i) & (_buckets.size() - 1)];
+			size_t kept = 0;
+
+			for (size_t j = 0; j < bucket.size(); j++)
+			{
+				// signed difference survives the wrap of the tick counter
+				if ((int32_t)(currentTick - bucket[j].second) >= 0)
+				{
+					expired.push_back(bucket[j]);
+				}
+				// deadline is more than a wheel turn ahead
+				else
+				{
+					bucket[kept++] = bucket[j];
+				}
+			}
+
+			_size -= bucket.size() - kept;
+			bucket.resize(kept);
+		}
+
+		_tick = currentTick + 1;
+	}
+	/*!
+	 * \brief The current tick of the wheel in seconds
+	 *
+	 * A monotonic clock is used so that changes of the wall clock neither
+	 * expire entries early nor keep them forever.
+	 */
+	static uint32_t now()
+	{
+		return chrono::duration_cast<chrono::seconds>(
+				chrono::steady_clock::now().time_since_epoch()).count();
+	}
+	/*!
+	 * \brief The number of scheduled keys, including stale ones
+	 */
+	size_t size()
+	{
+		return _size;
+	}
+private:
+	vector<vector<expired_t>> _buckets;/*!< One bucket per second */
+	uint32_t _tick;/*!< Next tick to be expired */
+	size_t _size;/*!< Number of keys on the wheel */
+};
+
+#endif /* NAP_TYPES_EXPIRYWHEEL_HH_ */
@@ -22,82 +22,65 @@
  * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <blackadder.hpp>
-
 #include "icnid.hh"
 
 IcnId::IcnId()
 {
 	_rootNamespace = 0;
 	_icnIdHashed = 0;
-	_icnIdString = string();
+	_scopeLevelsUint = 0;
 	_initialise();
 }
 
 IcnId::IcnId(RoutingPrefix routingPrefix)
 {
-	ostringstream oss;
-	oss << setw(16) << setfill('0') << NAMESPACE_IP;
-	oss << setw(16) << setfill('0') << routingPrefix.uint();
-	_icnIdString = oss.str();
+	_scopeLevelsUint = 0;
+	_appendDecimal(NAMESPACE_IP);
+	_appendDecimal(routingPrefix.uint());
 	_initialise();
 }
 
 IcnId::IcnId(uint32_t hashedFqdn)
 {
-	ostringstream oss;
-	oss << setw(16) << setfill('0') << NAMESPACE_HTTP;
-	oss << setw(16) << setfill('0') << hashedFqdn;
-	_icnIdString = oss.str();
+	_scopeLevelsUint = 0;
+	_appendDecimal(NAMESPACE_HTTP);
+	_appendDecimal(hashedFqdn);
 	_initialise();
 }
 
 IcnId::IcnId(RoutingPrefix routingPrefix, IpAddress ipAddress)
 {
-	ostringstream oss;
-	oss << setw(16) << setfill('0') << NAMESPACE_IP;
-	oss << setw(16) << setfill('0') << routingPrefix.uint();
-	oss << setw(16) << setfill('0') << ipAddress.uint();
-	_icnIdString = oss.str();
+	_scopeLevelsUint = 0;
+	_appendDecimal(NAMESPACE_IP);
+	_appendDecimal(routingPrefix.uint());
+	_appendDecimal(ipAddress.uint());
 	_initialise();
 }
 
 IcnId::IcnId(string fqdn)
 {
-	ostringstream hashedFqdnOss;
-	ostringstream oss;
+	_scopeLevelsUint = 0;
+	_appendDecimal(NAMESPACE_HTTP);
 
 	// wildcard... make CID /http/0
 	if (fqdn.compare("*") == 0)
 	{
-		hashedFqdnOss << DEFAULT_HTTP_IID;
+		_appendDecimal(DEFAULT_HTTP_IID);
 	}
 	else
 	{
-		hashedFqdnOss << _hashString(fqdn);
+		_appendDecimal(_hashString(fqdn));
 	}
 
-	uint8_t scopeLevels = _scopeLevels(hashedFqdnOss.str());
-	// Now create ICN ID
-	oss << setw(16) << setfill('0') << NAMESPACE_HTTP;
-	oss << setw(scopeLevels * 16) << setfill('0') << hashedFqdnOss.str();
-	_icnIdString = oss.str();
 	_initialise();
 	_fqdn = fqdn;
 }
 
 IcnId::IcnId(string fqdn, string resource)
 {
-	ostringstream hashedUrlOss;
-	ostringstream oss;
-	ostringstream urlOss;
-	urlOss << fqdn << resource;
-	hashedUrlOss << _hashString(urlOss.str());
-	uint8_t scopeLevels = _scopeLevels(hashedUrlOss.str());
-	// Now create ICN ID
-	oss << setw(16) << setfill('0') << NAMESPACE_HTTP;
-	oss << setw(scopeLevels * 16) << setfill('0') << hashedUrlOss.str();
-	_icnIdString = oss.str();
+	_scopeLevelsUint = 0;
+	_appendDecimal(NAMESPACE_HTTP);
+	_appendDecimal(_hashString(fqdn + resource));
 	_initialise();
 	_fqdn = fqdn;
 	_resource = resource;
@@ -106,10 +89,9 @@ IcnId::IcnId(string fqdn, string resource)
 IcnId::IcnId(root_namespaces_t rootNamespace,
 		information_items_t informationItem)
 {
-	ostringstream oss;
-	oss << setw(16) << setfill('0') << rootNamespace;
-	oss << setw(16) << setfill('0') << informationItem;
-	_icnIdString = oss.str();
+	_scopeLevelsUint = 0;
+	_appendDecimal(rootNamespace);
+	_appendDecimal(informationItem);
 	_initialise();
 }
 
@@ -122,13 +104,11 @@ void IcnId::access()
 IcnId* IcnId::createIGMPDataScopeId(IpAddress* ipAddress) {
     IcnId* tmp = new IcnId();
 
-    ostringstream oss;
-    //oss << setw(16) << setfill('0') << NAMESPACE_IGMP_ROOT;
-    oss << setw(16) << setfill('0') << NAMESPACE_IGMP_DATA;
+    //tmp->_appendDecimal(NAMESPACE_IGMP_ROOT);
+    tmp->_appendDecimal(NAMESPACE_IGMP_DATA);
     if (ipAddress != NULL) {
-        oss << setw(16) << setfill('0') << ipAddress->uint();
+        tmp->_appendDecimal(ipAddress->uint());
     }
-    tmp->_icnIdString = string(oss.str());
 
     tmp->_hashIcnId();
     tmp->_setRootNamespace();
@@ -143,13 +123,11 @@ IcnId* IcnId::createIGMPDataScopeId(IpAddress* ipAddress) {
 IcnId* IcnId::createIGMPCtrlScopeId(IpAddress* ipAddress) {
     IcnId* tmp = new IcnId();
 
-    ostringstream oss;
-    //oss << setw(16) << setfill('0') << NAMESPACE_IGMP_ROOT;
-    oss << setw(16) << setfill('0') << NAMESPACE_IGMP_CTRL;
+    //tmp->_appendDecimal(NAMESPACE_IGMP_ROOT);
+    tmp->_appendDecimal(NAMESPACE_IGMP_CTRL);
     if (ipAddress != NULL) {
-        oss << setw(16) << setfill('0') << ipAddress->uint();
+        tmp->_appendDecimal(ipAddress->uint());
     }
-    tmp->_icnIdString = string(oss.str());
 
     tmp->_hashIcnId();
     tmp->_setRootNamespace();
@@ -164,12 +142,9 @@ IcnId* IcnId::createIGMPCtrlScopeId(IpAddress* ipAddress) {
 IcnId* IcnId::createIGMPCtrlFromDataScopeId(IcnId dataId) {
     IcnId* tmp = new IcnId();
 
-    ostringstream oss;
-    //oss << setw(16) << setfill('0') << NAMESPACE_IGMP_ROOT;
-    oss << setw(16) << setfill('0') << NAMESPACE_IGMP_CTRL;
-    oss << setw(16) << setfill('0') << dataId._icnIdString.substr(16, 16);
-
-    tmp->_icnIdString = string(oss.str());
+    //tmp->_appendDecimal(NAMESPACE_IGMP_ROOT);
+    tmp->_appendDecimal(NAMESPACE_IGMP_CTRL);
+    tmp->_scopeIds[tmp->_scopeLevelsUint++] = dataId._scopeIds[1];
 
     tmp->_hashIcnId();
     tmp->_setRootNamespace();
@@ -182,7 +157,7 @@ IcnId* IcnId::createIGMPCtrlFromDataScopeId(IcnId dataId) {
 }
 
 IpAddress IcnId::extractIPAddrFromCId(IcnId cId) {
-    uint32_t addr = atoi(cId._icnIdString.substr(16, 16).c_str());
+    uint32_t addr = _decimal(cId._scopeIds[1]);
     IpAddress  tmp = IpAddress(addr);
     return tmp;
 }
@@ -190,12 +165,9 @@ IpAddress IcnId::extractIPAddrFromCId(IcnId cId) {
 IcnId* IcnId::createIGMPDataFromCtrlScopeId(IcnId ctrlId) {
     IcnId* tmp = new IcnId();
 
-    ostringstream oss;
-    //oss << setw(16) << setfill('0') << NAMESPACE_IGMP_ROOT;
-    oss << setw(16) << setfill('0') << NAMESPACE_IGMP_DATA;
-    oss << setw(16) << setfill('0') << ctrlId._icnIdString.substr(16, 16);
-
-    tmp->_icnIdString = string(oss.str());
+    //tmp->_appendDecimal(NAMESPACE_IGMP_ROOT);
+    tmp->_appendDecimal(NAMESPACE_IGMP_DATA);
+    tmp->_scopeIds[tmp->_scopeLevelsUint++] = ctrlId._scopeIds[1];
 
     tmp->_hashIcnId();
     tmp->_setRootNamespace();
@@ -210,43 +182,66 @@ IcnId* IcnId::createIGMPDataFromCtrlScopeId(IcnId ctrlId) {
 
 const string IcnId::binEmpty()
 {
-	return hex_to_chararray("");
+	return string();
 }
 
 const string IcnId::binIcnId()
 {
-	return hex_to_chararray(_icnIdString);
+	return _bin(0, _scopeLevelsUint);
+}
+
+void IcnId::binIcnId(const string &binIcnId)
+{
+	const uint8_t *octets = (const uint8_t *)binIcnId.data();
+	size_t length = binIcnId.length();
+	_scopeLevelsUint = 0;
+
+	for (size_t i = 0; i < length && _scopeLevelsUint < ICN_ID_SCOPE_LEVELS;
+			i += ICN_ID_SCOPE_LENGTH)
+	{
+		uint64_t scopeId = 0;
+
+		for (size_t j = i; j < i + ICN_ID_SCOPE_LENGTH && j < length; j++)
+		{
+			scopeId = (scopeId << 8) | octets[j];
+		}
+
+		_scopeIds[_scopeLevelsUint++] = scopeId;
+	}
+
+	_hashIcnId();
+	_setRootNamespace();
+	forwarding(false);
 }
 
 const string IcnId::binId()
 {
-	return hex_to_chararray(id());
+	return _bin(_scopeLevelsUint - 1, _scopeLevelsUint);
 }
 
 const string IcnId::binPrefixId()
 {
-	return hex_to_chararray(prefixId());
+	return _bin(0, _scopeLevelsUint - 1);
 }
 
 const string IcnId::binRootScopeId()
 {
-	return hex_to_chararray(rootScopeId());
+	return _bin(0, 1);
 }
 
 const string IcnId::binScopeId(unsigned int scopeLevel)
 {
-	return hex_to_chararray(_icnIdString.substr(((scopeLevel - 1) * 16),
-			16));
+	return _bin(scopeLevel - 1, scopeLevel);
 }
 
 const string IcnId::binScopePath(unsigned int scopeLevel)
 {
-	return hex_to_chararray(_icnIdString.substr(0, scopeLevel * 16));
+	return _bin(0, scopeLevel);
 }
 
 bool IcnId::empty()
 {
-	if (_icnIdHashed == 0)
+	if (_scopeLevelsUint == 0)
 	{
 		return true;
 	}
@@ -256,7 +251,7 @@ bool IcnId::empty()
 
 const string IcnId::id()
 {
-	return _icnIdString.substr(_icnIdString.length() - 16, 16);
+	return _hex(_scopeLevelsUint - 1, _scopeLevelsUint, false);
 }
 
 bool IcnId::fidRequested()
@@ -288,7 +283,7 @@ const boost::posix_time::ptime IcnId::lastAccessed()
 
 uint32_t IcnId::length()
 {
-	return binIcnId().length();
+	return _scopeLevelsUint * ICN_ID_SCOPE_LENGTH;
 }
 
 uint16_t IcnId::rootNamespace()
@@ -298,7 +293,15 @@ uint16_t IcnId::rootNamespace()
 
 void IcnId::operator=(string &str)
 {
-	_icnIdString = str;
+	_scopeLevelsUint = 0;
+
+	for (size_t i = 0; i < str.length() && _scopeLevelsUint < ICN_ID_SCOPE_LEVELS;
+			i += 2 * ICN_ID_SCOPE_LENGTH)
+	{
+		_scopeIds[_scopeLevelsUint++] = strtoull(
+				str.substr(i, 2 * ICN_ID_SCOPE_LENGTH).c_str(), NULL, 16);
+	}
+
 	_hashIcnId();
 	_setRootNamespace();
 	forwarding(false);
@@ -316,25 +319,12 @@ void IcnId::pausing(bool state)
 
 const string IcnId::prefixId()
 {
-	return _icnIdString.substr(0, _icnIdString.length() - 16);
+	return _hex(0, _scopeLevelsUint - 1, false);
 }
 
 const string IcnId::print()
 {
-	ostringstream oss;
-	size_t i = 0;
-
-	while (i < _icnIdString.length())
-	{
-		if ((i % 16) == 0)
-		{
-			oss << "/";
-		}
-		oss << _icnIdString[i];
-		i++;
-	}
-
-	return oss.str();
+	return _hex(0, _scopeLevelsUint, true);
 }
 
 const string IcnId::printFqdn()
@@ -344,65 +334,37 @@ const string IcnId::printFqdn()
 
 const string IcnId::printPrefixId()
 {
-	ostringstream oss;
-	size_t i = 0;
-	string prefix = prefixId();
-
-	while (i < prefix.length())
-	{
-		if ((i % 16) == 0)
-		{
-			oss << "/";
-		}
-		oss << prefix[i];
-		i++;
-	}
-
-	return oss.str();
+	return _hex(0, _scopeLevelsUint - 1, true);
 }
 
 const string IcnId::printScopePath(size_t scopeLevel)
 {
-	ostringstream oss;
-	size_t i = 0;
-	string path = scopePath(scopeLevel);
-
-	while (i < path.length())
-	{
-		if ((i % 16) == 0)
-		{
-			oss << "/";
-		}
-		oss << path[i];
-		i++;
-	}
-
-	return oss.str();
+	return _hex(0, scopeLevel, true);
 }
 
 const string IcnId::rootScopeId()
 {
-	return _icnIdString.substr(0, 16);
+	return _hex(0, 1, false);
 }
 
 const string IcnId::scopeId(unsigned int scopeLevel)
 {
-	return _icnIdString.substr(((scopeLevel - 1) * 16), 16);
+	return _hex(scopeLevel - 1, scopeLevel, false);
 }
 
 size_t IcnId::scopeLevels()
 {
-	return _icnIdString.length() / 16;
+	return _scopeLevelsUint;
 }
 
 const string IcnId::scopePath(unsigned int scopeLevel)
 {
-	return _icnIdString.substr(0, scopeLevel * 16);
+	return _hex(0, scopeLevel, false);
 }
 
 string IcnId::str()
 {
-	return _icnIdString;
+	return _hex(0, _scopeLevelsUint, false);
 }
 
 uint32_t IcnId::uint()
@@ -412,23 +374,124 @@ uint32_t IcnId::uint()
 
 uint32_t IcnId::uintId()
 {
-	return atoi(id().c_str());
+	if (_scopeLevelsUint == 0)
+	{
+		return 0;
+	}
+
+	return _decimal(_scopeIds[_scopeLevelsUint - 1]);
 }
 
 void IcnId::_access()
 {
-	_lastAccessed = boost::posix_time::microsec_clock::local_time();
+	_lastAccessed = boost::posix_time::microsec_clock::universal_time();
+}
+
+void IcnId::_appendDecimal(uint64_t number)
+{
+	uint64_t scopeId = 0;
+
+	for (uint8_t shift = 0; number > 0; shift += 4)
+	{
+		scopeId |= (number % 10) << shift;
+		number /= 10;
+	}
+
+	_scopeIds[_scopeLevelsUint++] = scopeId;
+}
+
+const string IcnId::_bin(size_t first, size_t last)
+{
+	string bin;
+
+	if (last > _scopeLevelsUint)
+	{
+		last = _scopeLevelsUint;
+	}
+
+	if (first >= last)
+	{
+		return bin;
+	}
+
+	bin.resize((last - first) * ICN_ID_SCOPE_LENGTH);
+
+	for (size_t i = first; i < last; i++)
+	{
+		for (size_t j = 0; j < ICN_ID_SCOPE_LENGTH; j++)
+		{
+			bin[(i - first) * ICN_ID_SCOPE_LENGTH + j] =
+					(char)(_scopeIds[i] >> (8 * (ICN_ID_SCOPE_LENGTH - 1 - j)));
+		}
+	}
+
+	return bin;
+}
+
+uint64_t IcnId::_decimal(uint64_t scopeId)
+{
+	uint64_t number = 0;
+
+	for (int shift = 60; shift >= 0; shift -= 4)
+	{
+		uint8_t digit = (scopeId >> shift) & 0xf;
+
+		if (digit > 9)
+		{
+			break;
+		}
+
+		number = number * 10 + digit;
+	}
+
+	return number;
 }
 
 void IcnId::_hashIcnId()
 {
-	_icnIdHashed = 0;
-	const char *string = _icnIdString.c_str();
+	uint64_t hash = _scopeLevelsUint;
 
-	while( *string != 0 )
+	for (uint8_t i = 0; i < _scopeLevelsUint; i++)
+	{
+		hash = (hash ^ _scopeIds[i]) * 0x9e3779b97f4a7c15ULL;
+		hash ^= hash >> 29;
+	}
+
+	_icnIdHashed = hash ^ (hash >> 32);
+}
+
+const string IcnId::_hex(size_t first, size_t last, bool separator)
+{
+	static const char digits[] = "0123456789abcdef";
+	string hex;
+	size_t position = 0;
+
+	if (last > _scopeLevelsUint)
+	{
+		last = _scopeLevelsUint;
+	}
+
+	if (first >= last)
 	{
-		_icnIdHashed = _icnIdHashed * 31 + *string++;
+		return hex;
 	}
+
+	hex.resize((last - first) * (2 * ICN_ID_SCOPE_LENGTH + separator));
+
+	for (size_t i = first; i < last; i++)
+	{
+		if (separator)
+		{
+			hex[position++] = '/';
+		}
+
+		for (int shift = 60; shift >= 0; shift -= 4)
+		{
+			hex[position++] = digits[(_scopeIds[i] >> shift) & 0xf];
+		}
+	}
+
+	return hex;
 }
 
 uint32_t IcnId::_hashString(string str)
@@ -455,25 +518,7 @@ void IcnId::_initialise()
 	_hashIcnId();
 }
 
-uint8_t IcnId::_scopeLevels(string str)
-{
-	uint8_t scopeLevels = 0;
-
-	// not a multiple of 16
-	if ((str.length() % 16) != 0)
-	{
-		scopeLevels = str.length() / 16;
-		scopeLevels++;
-	}
-	else
-	{
-		scopeLevels = str.length() / 16;
-	}
-
-	return scopeLevels;
-}
-
 void IcnId::_setRootNamespace()
 {
-	_rootNamespace = atoi(_icnIdString.substr(0, 16).c_str());
+	_rootNamespace = (_scopeLevelsUint == 0) ? 0 : _decimal(_scopeIds[0]);
 }
@@ -29,6 +29,8 @@
 #include <boost/date_time.hpp>
 #include <iomanip>
 #include <iostream>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string>
 
 #include "ipaddress.hh"
@@ -38,10 +40,21 @@
 #include "dmalloc.h"
 #endif
 
+#define ICN_ID_SCOPE_LEVELS 8 // scope levels an ICN ID can hold at most
+#define ICN_ID_SCOPE_LENGTH 8 // octets per scope ID on the wire
+
 using namespace std;
 
 /*!
- * \brief
+ * \brief Content identifier of all namespaces
+ *
+ * A CID is held as one 64-bit integer per scope level which corresponds to
+ * the 8 octets of the scope ID on the wire (big endian). The NAP fills its
+ * scope IDs with numbers in decimal notation padded to 16 digits, i.e. the
+ * number is encoded in BCD, and the 16 hex digits of a scope ID are its human
+ * readable format. Strings are only produced for logging and for the
+ * Blackadder API; the hash used as a key throughout the NAP is computed once
+ * when the CID is set.
  */
 class IcnId {
 public:
@@ -146,11 +159,20 @@ public:
      */
     const string binEmpty();
     /*!
-     * \brief
+     * \brief Obtain the CID in binary format as used by Blackadder
      *
-     * \return
+     * \return The CID in binary format
      */
     const string binIcnId();
+    /*!
+     * \brief Set the CID from its binary format, e.g. the ID of an event
+     * received from Blackadder
+     *
+     * Same as operator=(string &) without converting the CID to hex first.
+     *
+     * \param binIcnId The CID in binary format
+     */
+    void binIcnId(const string &binIcnId);
     /*!
      * \brief
      *
@@ -373,8 +395,10 @@ private:
     bool _forwarding; /*!< Forwarding policy (START_PUBLISH received yes/no)*/
     bool _pausing; /*!< Pausing policy for this particular ICN ID (DNSlocal use
 	cases)*/
-    string _icnIdString; /*!< */
-    uint32_t _icnIdHashed; /*!< */
+    uint64_t _scopeIds[ICN_ID_SCOPE_LEVELS]; /*!< Scope IDs from the root
+	scope onwards */
+    uint8_t _scopeLevelsUint; /*!< Number of scope levels held */
+    uint32_t _icnIdHashed; /*!< Hash over all scope IDs */
     uint16_t _rootNamespace; /*!< The root namespace identifier */
     string _fqdn;
     string _resource;
@@ -397,9 +421,37 @@ private:
      */
     void _initialise();
     /*!
-     * \brief
+     * \brief Append a scope ID holding a number in decimal notation
+     *
+     * \param number The number which must not exceed 16 decimal digits
+     */
+    void _appendDecimal(uint64_t number);
+    /*!
+     * \brief Obtain the number a scope ID holds in decimal notation
+     *
+     * Like atoi() the conversion stops at the first hex digit which is not a
+     * decimal one.
+     *
+     * \param scopeId The scope ID
+     *
+     * \return The number
+     */
+    static uint64_t _decimal(uint64_t scopeId);
+    /*!
+     * \brief Convert scope levels to binary format
+     *
+     * \param first The first scope level (starting at 0)
+     * \param last The scope level after the last one to be converted
+     */
+    const string _bin(size_t first, size_t last);
+    /*!
+     * \brief Convert scope levels to hex format
+     *
+     * \param first The first scope level (starting at 0)
+     * \param last The scope level after the last one to be converted
+     * \param separator Whether a forward slash is put before each scope ID
      */
-    uint8_t _scopeLevels(string str);
+    const string _hex(size_t first, size_t last, bool separator);
     /*!
      * \brief
      */
@@ -0,0 +1,110 @@
+/*
+ * routingprefixtable.cc
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "routingprefixtable.hh"
+
+RoutingPrefixTable::RoutingPrefixTable(
+		map<uint32_t, RoutingPrefix> &routingPrefixes)
+	: _entries(1 << 16, 0)
+{
+	map<uint32_t, RoutingPrefix>::iterator it;
+	vector<pair<uint8_t, size_t>> order;
+
+	for (it = routingPrefixes.begin(); it != routingPrefixes.end(); it++)
+	{
+		_prefixes.push_back(it->second);
+		order.push_back(pair<uint8_t, size_t>(it->second.netmask().cidr(),
+				_prefixes.size() - 1));
+	}
+
+	// shorter prefixes first so that longer ones overwrite them
+	stable_sort(order.begin(), order.end());
+
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		RoutingPrefix &prefix = _prefixes[order[i].second];
+		_add(0, 0, ntohl(prefix.uint()), order[i].first,
+				order[i].second + 1);
+	}
+}
+
+size_t RoutingPrefixTable::size()
+{
+	return _prefixes.size();
+}
+
+void RoutingPrefixTable::_add(uint32_t offset, uint8_t level,
+		uint32_t address, uint8_t length, uint32_t entry)
+{
+	// number of address bits resolved once this level has been indexed
+	uint8_t depth = 16 + 8 * level;
+	uint32_t index;
+
+	if (level == 0)
+	{
+		index = address >> 16;
+	}
+	else
+	{
+		index = (address >> (32 - depth)) & 0xff;
+	}
+
+	if (length <= depth)
+	{
+		uint32_t entries = 1 << (depth - length);
+
+		for (uint32_t i = 0; i < entries; i++)
+		{
+			_fill(offset + index + i, entry);
+		}
+
+		return;
+	}
+
+	if (!(_entries[offset + index] & ROUTING_PREFIX_TABLE_GROUP))
+	{
+		uint32_t group = _entries.size();
+		// the group inherits the prefix covering it so far
+		_entries.resize(group + 256, _entries[offset + index]);
+		_entries[offset + index] = group | ROUTING_PREFIX_TABLE_GROUP;
+	}
+
+	_add(_entries[offset + index] & ~ROUTING_PREFIX_TABLE_GROUP, level + 1,
+			address, length, entry);
+}
+
+void RoutingPrefixTable::_fill(uint32_t position, uint32_t entry)
+{
+	if (!(_entries[position] & ROUTING_PREFIX_TABLE_GROUP))
+	{
+		_entries[position] = entry;
+		return;
+	}
+
+	uint32_t group = _entries[position] & ~ROUTING_PREFIX_TABLE_GROUP;
+
+	for (uint32_t i = 0; i < 256; i++)
+	{
+		_fill(group + i, entry);
+	}
+}
@@ -0,0 +1,124 @@
+/*
+ * routingprefixtable.hh
+ *
+ *  Created on: 19 Oct 2026
+ *      Author: user
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef APPS_NAP_TYPES_ROUTINGPREFIXTABLE_HH_
+#define APPS_NAP_TYPES_ROUTINGPREFIXTABLE_HH_
+
+#include <map>
+#include <stdint.h>
+#include <vector>
+
+#include "routingprefix.hh"
+
+#ifdef DMALLOC
+#include "dmalloc.h"
+#endif
+
+using namespace std;
+
+/*!
+ * \brief Longest prefix match table over a set of routing prefixes
+ *
+ * Multibit trie with strides of 16, 8 and 8 bits (DIR-16-8-8). The first 16
+ * bits of an IP address index a table of 65536 entries. An entry either holds
+ * the longest prefix covering all addresses below it or points to a group of
+ * 256 entries for the next 8 bits, which is only created for prefixes longer
+ * than /16 (respectively /24). A lookup therefore costs at most three memory
+ * reads, independent of the number of prefixes.
+ *
+ * The table is immutable once built. Readers never lock; a new set of prefixes
+ * is published by building a new table and swapping the pointer readers load
+ * it from.
+ */
+class RoutingPrefixTable
+{
+public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param routingPrefixes The routing prefixes keyed by their network
+	 * address as read from nap.cfg
+	 */
+	RoutingPrefixTable(map<uint32_t, RoutingPrefix> &routingPrefixes);
+	/*!
+	 * \brief Find the longest routing prefix covering an IP address
+	 *
+	 * \param ipAddress The IP address in network byte order
+	 *
+	 * \return Pointer to the routing prefix or NULL if no prefix covers the
+	 * IP address
+	 */
+	RoutingPrefix *lookup(uint32_t ipAddress)
+	{
+		uint32_t address = ntohl(ipAddress);
+		uint32_t entry = _entries[address >> 16];
+
+		if (entry & ROUTING_PREFIX_TABLE_GROUP)
+		{
+			entry = _entries[(entry & ~ROUTING_PREFIX_TABLE_GROUP)
+					+ ((address >> 8) & 0xff)];
+
+			if (entry & ROUTING_PREFIX_TABLE_GROUP)
+			{
+				entry = _entries[(entry & ~ROUTING_PREFIX_TABLE_GROUP)
+						+ (address & 0xff)];
+			}
+		}
+
+		if (entry == 0)
+		{
+			return NULL;
+		}
+
+		return &_prefixes[entry - 1];
+	}
+	/*!
+	 * \brief The number of routing prefixes in the table
+	 */
+	size_t size();
+private:
+	static const uint32_t ROUTING_PREFIX_TABLE_GROUP = 0x80000000;/*!< Entry
+	points to a group of the next level */
+	vector<RoutingPrefix> _prefixes;/*!< The prefixes entries refer to */
+	vector<uint32_t> _entries;/*!< The 65536 entries of the first level
+	followed by all groups of 256 entries. An entry is 0 (no prefix), the
+	index of a prefix + 1 or the offset of a group with the group flag set*/
+	/*!
+	 * \brief Add a prefix to the entries of one level
+	 *
+	 * Prefixes must be added in order of ascending length, so that a longer
+	 * prefix overwrites the shorter ones it is covered by.
+	 *
+	 * \param offset The offset of the first entry of the level (group)
+	 * \param level 0 for the first level (16 bits), 1 and 2 for the groups
+	 * \param address The prefix in host byte order
+	 * \param length The length of the prefix in bits
+	 * \param entry The entry referring to the prefix
+	 */
+	void _add(uint32_t offset, uint8_t level, uint32_t address,
+			uint8_t length, uint32_t entry);
+	/*!
+	 * \brief Set an entry and all entries of the groups below it
+	 */
+	void _fill(uint32_t position, uint32_t entry);
+};
+
+#endif /* APPS_NAP_TYPES_ROUTINGPREFIXTABLE_HH_ */
@@ -11,12 +11,13 @@
 #include <boost/date_time.hpp>
 
 #define ENIGMA 23 // https://en.wikipedia.org/wiki/23_enigma
+#define LTP_VERSION 2 // Highest LTP version this NAP speaks
 
 typedef uint32_t cid_t;/*!< Content Identifier */
 typedef uint32_t enigma_t; /*!< Proxy rule identifier */
 typedef uint16_t sk_t; /*!< Session key */
 typedef uint32_t nid_t;/*!< Node Identifier */
-typedef uint16_t seq_t;/*!< Sequence number in LTP*/
+typedef uint32_t seq_t;/*!< Sequence number in LTP*/
 typedef int socket_fd_t;/*!< Socket file descriptor*/
 
 struct packet_t
@@ -25,6 +26,7 @@ struct packet_t
 	uint16_t packetSize;/*!< Length of IP packet */
 	boost::posix_time::ptime timestamp;/*!< Timestamp of when this packet
 	was added to buffer*/
+	uint32_t expiry;/*!< Expiry wheel deadline of this packet */
 };
 
 #endif /* NAP_TYPEDEF_HH_ */
@@ -272,7 +272,10 @@ int main(int argc, char **argv) {
     GraphRepresentation graph = GraphRepresentation(&dm, autogenerate);
     /**assign Link Identifiers and internal link identifiers using a randomly generated set of LIDs.
      */
-    dm.assignLIDs();
+    if (!dm.assignLIDs()) {
+        cout << "Assign LIDs: not enough LIDs for the network domain" << endl;
+        return EXIT_FAILURE;
+    }
     /** assign the same LIDs to both directions of a link and the same LID to iLID of leaf nodes.
      * commented because does not work with SDN, modified solution that give unique directional LIDs to SDN links only is required
      */
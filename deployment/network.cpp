@@ -25,6 +25,7 @@ Domain::Domain() {
     number_of_connections = 0;
     number_of_pl_nodes = 0;
     number_of_p_connections = 0;
+    lid_max_overlap = -1;
 }
 
 void Domain::printDomainData() {
@@ -79,16 +80,6 @@ void Domain::printDomainData() {
     }
 }
 
-bool exists(vector<Bitvector> &LIDs, Bitvector &LID) {
-    for (size_t i = 0; i < LIDs.size(); i++) {
-        if (LIDs[i] == LID) {
-            //cout << "duplicate LID" << endl;
-            return true;
-        }
-    }
-    return false;
-}
-
 NetworkNode *Domain::findNode(string label) {
     for (size_t i = 0; i < network_nodes.size(); i++) {
         NetworkNode *nn = network_nodes[i];
@@ -124,99 +115,97 @@ string Domain::lid2ipv6(string lid) {
     return (os.str());
 }
 
-void Domain::calculateLID(vector<Bitvector> &LIDs, int index) {
-    int bit_position;
-    int number_of_bits = (index / (fid_len * 8)) + 1;
-    Bitvector LID;
-    do {
-        LID = Bitvector(fid_len * 8);
-        for (int i = 0; i < number_of_bits; i++) {
-            /*assign a bit in a random position*/
-            bit_position = rand() % (fid_len * 8);
-            LID[bit_position] = true;
-        }
-    } while (exists(LIDs, LID));
-    LIDs[index] = LID;
+Bitvector Domain::lidBitvector(const LidAllocator::lid_bits &bits) {
+    Bitvector LID = Bitvector(fid_len * 8);
+    for (size_t i = 0; i < bits.size(); i++) {
+        LID[bits[i]] = true;
+    }
+    return LID;
 }
 
 /** Required method for dynamic deployment tool.
  * It calculates and returns random LID.
  */
 Bitvector Domain::calculateLID() {
-    int bit_position;
-    Bitvector LID;
-    do {
-        LID = Bitvector(fid_len * 8);
-        /**assign a bit in a random position
-         */
-        bit_position = rand() % (fid_len * 8);
-        LID[bit_position] = true;
-    } while (exists(lids, LID));
+    if (lid_allocator.length() != (unsigned int) fid_len * 8) {
+        /*first call in a dynamic deployment, index the LIDs of the existing domain*/
+        lid_allocator.reset(fid_len * 8);
+        for (size_t i = 0; i < lids.size(); i++) {
+            LidAllocator::lid_bits bits;
+            for (int j = 0; j < lids[i].size(); j++) {
+                if (lids[i][j]) {
+                    bits.push_back(j);
+                }
+            }
+            lid_allocator.reserve(bits);
+        }
+    }
+    LidAllocator::lid_bits bits = lid_allocator.allocate();
+    if (bits.empty()) {
+        cout << "No free LID left" << endl;
+        return Bitvector(fid_len * 8, 0);
+    }
+    Bitvector LID = lidBitvector(bits);
     lids.push_back(LID);
     return LID;
 }
 
-void Domain::assignLIDs() {
+bool Domain::assignLIDs() {
     int LIDCounter = 0;
     srand(0);
     //srand(66000);
-    /*first calculated how many LIDs should I calculate*/
-    int totalLIDs;
     bool mac_ml = (overlay_mode.compare("mac_ml") == 0);
     if (mac_ml) {
         cout << "Number of iLIDs is: " << number_of_pl_nodes
         << ", Number of LIDs is: " << number_of_p_connections
         << ", Number of Total connections is: " << number_of_connections
         << endl;
-        totalLIDs = number_of_pl_nodes/*the iLIDs*/+ number_of_p_connections;
         // here to add pn node and pp connection count to eleminate the assignment of Lids for the oo links and oe-links
-    } else {
-        totalLIDs = number_of_nodes/*the iLIDs*/+ number_of_connections;
-    }
-    vector<Bitvector> LIDs(totalLIDs);
-    vector<string> LIDs_IPv6(totalLIDs);
-    for (int i = 0; i < totalLIDs; i++) {
-        calculateLID(LIDs, i);
     }
-#if 0
-    for (int i = 0; i < totalLIDs; i++) {
-        cout << "LID " << i << " : " << LIDs.at(i).to_string() << endl;
-        LIDs_IPv6[i] = lid2ipv6(LIDs.at(i).to_string());
-        cout << "IPv6 " << i << " : " << LIDs_IPv6[i] << endl;
-    }
-#endif
+    lid_allocator.reset(fid_len * 8);
+    lids.clear();
     for (size_t i = 0; i < network_nodes.size(); i++) {
         NetworkNode *nn = network_nodes[i];
-        if (mac_ml) {
-            if (nn->type == "PN") { /* packet layer node */
-                nn->iLid = LIDs[LIDCounter];
-                LIDCounter++;
+        /*the iLID and the LIDs of all the links of a node are allocated in one call, so that they can be kept apart*/
+        bool node_ilid = !mac_ml || (nn->type == "PN"); /* packet layer node */
+        unsigned int node_lids = node_ilid ? 1 : 0;
+        for (size_t j = 0; j < nn->connections.size(); j++) {
+            if (!mac_ml || (nn->connections[j]->lnk_type == "pp")) { /* packet-to-packet connection */
+                node_lids++;
             }
-        } else {
-            nn->iLid = LIDs[LIDCounter];
-            LIDCounter++;
+        }
+        vector<LidAllocator::lid_bits> node_bits;
+        if (!lid_allocator.allocate(node_lids, node_bits, 0, lid_max_overlap)) {
+            /*without an overlap limit, the first call already failed for lack of free LIDs*/
+            if (lid_max_overlap >= 0) {
+                cout << "LIDs of node " << nn->label << " share more than "
+                << lid_max_overlap << " bits" << endl;
+            }
+            if (lid_max_overlap < 0 || !lid_allocator.allocate(node_lids, node_bits)) {
+                cout << "LIDs of node " << nn->label << " could not be allocated"
+                << endl;
+                return false;
+            }
+        }
+        unsigned int k = 0;
+        if (node_ilid) {
+            nn->iLid = lidBitvector(node_bits[k++]);
+            lids.push_back(nn->iLid);
         }
         for (size_t j = 0; j < nn->connections.size(); j++) {
             NetworkConnection *nc = nn->connections[j];
-            if (mac_ml) {
-                if ((nc->lnk_type == "pp")) { /* packet-to-packet connection */
-                    nc->LID = LIDs[LIDCounter];
-                    LIDCounter++;
-                } else {
-                    nc->LID = Bitvector(fid_len * 8, 0);
-                }
+            if (!mac_ml || (nc->lnk_type == "pp")) {
+                nc->LID = lidBitvector(node_bits[k++]);
+                lids.push_back(nc->LID);
             } else {
-                nc->LID = LIDs[LIDCounter];
-                nc->LID_IPv6 = LIDs_IPv6[LIDCounter];
-                LIDCounter++;
+                nc->LID = Bitvector(fid_len * 8, 0);
             }
         }
     }
-    lids = LIDs;
-    for (int i = 0; i < LIDCounter; i++) {
-        cout << "LID " << i << " : " << LIDs.at(i).to_string() << endl;
-        cout << "IPv6 " << i << " : " << LIDs_IPv6.at(i) << endl;
+    for (size_t i = 0; i < lids.size(); i++, LIDCounter++) {
+        cout << "LID " << LIDCounter << " : " << lids.at(i).to_string() << endl;
     }
+    return true;
 }
 /*This method is used for assigning sparce LIDs in large scale newtworks
  * it assings the same LID to both directions of link, plus iLID is the same for nodes with single connections (i.e. leaf nodes)
@@ -2023,6 +2012,13 @@ MergingResult Domain::mergeDomains(Domain &new_dm) {
         /** generate random label
          */
         new_dm.network_nodes[0]->label = generateLabel();
+        /** the iLID first, so that the domain is left untouched if the LIDs are exhausted
+         */
+        new_dm.network_nodes[0]->iLid = calculateLID();
+        if (new_dm.network_nodes[0]->iLid.zero()) {
+            std::cout << "No iLID left for the new node." << std::endl;
+            return ERROR;
+        }
         for (std::vector<NetworkConnection*>::iterator it =
              new_dm.network_nodes[0]->connections.begin();
              it != new_dm.network_nodes[0]->connections.end();) {
@@ -2030,6 +2026,11 @@ MergingResult Domain::mergeDomains(Domain &new_dm) {
             /** calculate new LID
              */
             nc->LID = calculateLID();
+            if (nc->LID.zero()) {
+                std::cout << "No LID left, removing connection." << std::endl;
+                it = new_dm.network_nodes[0]->connections.erase(it);
+                continue;
+            }
             string dst_ip_address = nc->dst_label;
             nc->src_label = new_dm.network_nodes[0]->label;
             nc->proto_type = "0x080a";
@@ -2041,6 +2042,12 @@ MergingResult Domain::mergeDomains(Domain &new_dm) {
                 if (nn->testbed_ip.compare(dst_ip_address) == 0) {
                     std::cout << "Found attachment node, creating connection."
                     << std::endl;
+                    Bitvector LID = calculateLID();
+                    if (LID.zero()) {
+                        std::cout << "No LID left for the connection of the "
+                        "attachment node." << std::endl;
+                        break;
+                    }
                     /** create new connection and add it to attachment node's connections
                      */
                     NetworkConnection* new_nc = new NetworkConnection();
@@ -2049,7 +2056,7 @@ MergingResult Domain::mergeDomains(Domain &new_dm) {
                     new_nc->proto_type = "0x080a";
                     new_nc->dst_label = new_dm.network_nodes[0]->label;
                     new_nc->src_label = nn->label;
-                    new_nc->LID = calculateLID();
+                    new_nc->LID = LID;
                     nn->connections.push_back(new_nc);
                     /** add attachment node to the domain that needs to be updated
                      */
@@ -2076,7 +2083,6 @@ MergingResult Domain::mergeDomains(Domain &new_dm) {
             std::cout
             << "New node has active connections, hence will be added to topology."
             << std::endl;
-            new_dm.network_nodes[0]->iLid = calculateLID();
             network_nodes.push_back(new_dm.network_nodes[0]);
             number_of_nodes++;
             return NODE_ADDED;
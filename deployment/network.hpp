@@ -38,6 +38,7 @@
 #include <algorithm>
 #include <bitset>
 #include "bitvector.hpp"
+#include "../lib/lid_allocator.hpp"
 #include <math.h>
 #include <boost/math/special_functions/factorials.hpp>
 
@@ -124,6 +125,12 @@ public:
     /**@brief whether sudo will be used when executing remote commands.
      */
     bool sudo;
+    /**@brief the maximum number of bits the iLID and the LIDs of the same node may have in common, -1 for no limit (optional LID_MAX_OVERLAP).
+     */
+    int lid_max_overlap;
+    /**@brief the hashed index of all assigned LIDs and iLIDs, used to allocate new ones.
+     */
+    LidAllocator lid_allocator;
     /**@brief the overlay mode. mac or ip
      */
     string overlay_mode;
@@ -141,20 +148,21 @@ public:
     /**@brief It prints an ugly representation of the Domain.
      */
     void printDomainData();
-    /**@brief -
-     * 
+    /**@brief assign the iLID and the LIDs of all nodes.
+     *
+     * @return false if the LIDs of a node could not be allocated.
      */
-    void assignLIDs();
+    bool assignLIDs();
 	/**@brief assign LIDs following basic resource management whereby a single LID is assigned to both directions of a link. since Ethernet prevents output interface to be the same as input one, false positive should not occur.
 	 *
 	 */
 	void assignLIDs_rm();
-    /**@brief -
-     * 
-     * @param LIDs
-     * @param index
+    /**@brief It converts the bit positions of an allocated LID to a Bitvector of fid_len bytes.
+     *
+     * @param bits the bit positions returned by lid_allocator.
+     * @return the LID in the form of Bitvector.
      */
-    void calculateLID(vector<Bitvector> &LIDs, int index);
+    Bitvector lidBitvector(const LidAllocator::lid_bits &bits);
     /**@brief  transform an LID to the equivelent IPv6
      *@param lid: string the LID in string form
      *@return ipv6: string of the IPv6
@@ -264,7 +272,7 @@ public:
     MergingResult mergeDomains(Domain &new_dm);
     /**@brief It calculates a random LID
      *
-     * @return The generated LID in the form of Bitvector.
+     * @return The generated LID in the form of Bitvector, or an all-zero Bitvector if no free LID is left.
      */
     Bitvector calculateLID();
     /**@brief It generates a random label, based on the number of existing network nodes.
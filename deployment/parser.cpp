@@ -105,6 +105,10 @@ int Parser::getGlobalDomainParameters() {
         cerr << "mandatory option OVERLAY_MODE is missing" << endl;
         return -1;
     }
+    /*optional*/
+    if (cfg.lookupValue("LID_MAX_OVERLAP", dm->lid_max_overlap)) {
+        cout << "LID_MAX_OVERLAP: " << dm->lid_max_overlap << endl;
+    }
     try {
         cfg.lookupValue("ODL_ADDRESS", dm->odl_address);
         cout << "ODL_ADDRESS: " << dm->odl_address << endl;
@@ -426,13 +426,29 @@ bool Blackadder::publish_data(const string&id,
                               void * data,
                               unsigned int data_len
                               ) {
-    int ret;
+    struct iovec iov;
+    iov.iov_base = data;
+    iov.iov_len = data_len;
+    return publish_data(id, strategy, str_opt, str_opt_len, nodeIds, &iov, 1);
+}
+bool Blackadder::publish_data(const string&id,
+                              unsigned char strategy,
+                              void *str_opt,
+                              unsigned int str_opt_len,
+                              std::list <string> &nodeIds,
+                              const struct iovec *data,
+                              unsigned int data_iovcnt
+                              ) {
+    int ret = -1;
     struct msghdr msg;
-    struct iovec iov[9];
+    struct iovec iov[8 + BA_MAX_DATA_IOV];
+    unsigned int iovcnt;
     memset(&msg, 0, sizeof(msg));
     memset(iov, 0, sizeof(iov));
     if (id.length() % PURSUIT_ID_LEN != 0) {
         cout << "Blackadder Library: Could not send  - wrong ID size" << endl;
+    } else if (data_iovcnt > BA_MAX_DATA_IOV) {
+        cout << "Blackadder Library: Could not send  - too many data buffers" << endl;
     } else {
         unsigned char type = PUBLISH_DATA_iMULTICAST;
         unsigned char id_len = id.length() / PURSUIT_ID_LEN;
@@ -448,7 +464,9 @@ bool Blackadder::publish_data(const string&id,
         for (std::list<string>::iterator it = nodeIds.begin(); it != nodeIds.end(); ++it) {
             nodeIdsStream += (*it);
         }
-        nlh->nlmsg_len += data_len;
+        for (unsigned int i = 0; i < data_iovcnt; i++) {
+            nlh->nlmsg_len += data[i].iov_len;
+        }
         nlh->nlmsg_pid = getpid();
         nlh->nlmsg_flags = 1;
         nlh->nlmsg_type = 0;
@@ -462,29 +480,25 @@ bool Blackadder::publish_data(const string&id,
         iov[3].iov_len = id.length();
         iov[4].iov_base = (void *) &strategy;
         iov[4].iov_len = sizeof (strategy);
-        if (str_opt == NULL) {
-            iov[5].iov_base = &nodeIdListSize;
-            iov[5].iov_len = sizeof (nodeIdListSize);
-            iov[6].iov_base = (void *) nodeIdsStream.c_str();
-            iov[6].iov_len = nodeIdListSize * NODEID_LEN;
-            iov[7].iov_base = (void *) data;
-            iov[7].iov_len = data_len;
-            iov[8].iov_base = NULL;
-            iov[8].iov_len = 0;
-        } else {
-            iov[5].iov_base = (void *) str_opt;
-            iov[5].iov_len = str_opt_len;
-            iov[6].iov_base = &nodeIdListSize;
-            iov[6].iov_len = sizeof (nodeIdListSize);
-            iov[7].iov_base = (void *) nodeIdsStream.c_str();
-            iov[7].iov_len = nodeIdListSize * NODEID_LEN;
-            iov[8].iov_base = (void *) data;
-            iov[8].iov_len = data_len;
+        iovcnt = 5;
+        if (str_opt != NULL) {
+            iov[iovcnt].iov_base = (void *) str_opt;
+            iov[iovcnt].iov_len = str_opt_len;
+            iovcnt++;
+        }
+        iov[iovcnt].iov_base = &nodeIdListSize;
+        iov[iovcnt].iov_len = sizeof (nodeIdListSize);
+        iovcnt++;
+        iov[iovcnt].iov_base = (void *) nodeIdsStream.c_str();
+        iov[iovcnt].iov_len = nodeIdListSize * NODEID_LEN;
+        iovcnt++;
+        for (unsigned int i = 0; i < data_iovcnt; i++) {
+            iov[iovcnt++] = data[i];
         }
         msg.msg_name = (void *) &d_nladdr;
         msg.msg_namelen = sizeof (d_nladdr);
         msg.msg_iov = iov;
-        msg.msg_iovlen = (str_opt == NULL) ? 8 : 9;
+        msg.msg_iovlen = iovcnt;
         ret = sendmsg(sock_fd, &msg, 0);
     }
     if (ret < 0) {
@@ -500,13 +514,29 @@ bool Blackadder::publish_data_isub(const string&id,
                                    void * data,
                                    unsigned int data_len
                                    ) {
-    int ret;
+    struct iovec iov;
+    iov.iov_base = data;
+    iov.iov_len = data_len;
+    return publish_data_isub(id, strategy, str_opt, str_opt_len, isubID, &iov, 1);
+}
+bool Blackadder::publish_data_isub(const string&id,
+                                   unsigned char strategy,
+                                   void *str_opt,
+                                   unsigned int str_opt_len,
+                                   const string &isubID,
+                                   const struct iovec *data,
+                                   unsigned int data_iovcnt
+                                   ) {
+    int ret = -1;
     struct msghdr msg;
-    struct iovec iov[9];
+    struct iovec iov[8 + BA_MAX_DATA_IOV];
+    unsigned int iovcnt;
     memset(&msg, 0, sizeof(msg));
     memset(iov, 0, sizeof(iov));
     if (id.length() % PURSUIT_ID_LEN != 0) {
         cout << "Blackadder Library: Could not send  - wrong ID size" << endl;
+    } else if (data_iovcnt > BA_MAX_DATA_IOV) {
+        cout << "Blackadder Library: Could not send  - too many data buffers" << endl;
     } else {
         unsigned char type = PUBLISH_DATA_iSUB;
         unsigned char id_len = id.length() / PURSUIT_ID_LEN;
@@ -518,7 +548,9 @@ bool Blackadder::publish_data_isub(const string&id,
         if (str_opt != NULL) {
             nlh->nlmsg_len += str_opt_len;
         }
-        nlh->nlmsg_len += data_len;
+        for (unsigned int i = 0; i < data_iovcnt; i++) {
+            nlh->nlmsg_len += data[i].iov_len;
+        }
         nlh->nlmsg_pid = getpid();
         nlh->nlmsg_flags = 1;
         nlh->nlmsg_type = 0;
@@ -532,31 +564,26 @@ bool Blackadder::publish_data_isub(const string&id,
         iov[3].iov_len = id.length();
         iov[4].iov_base = (void *) &strategy;
         iov[4].iov_len = sizeof (strategy);
-        if (str_opt == NULL) {
-            /*hash(URL) coming with iSUB*/
-            iov[5].iov_base = &isubID_len;
-            iov[5].iov_len = sizeof (isubID_len);
-            iov[6].iov_base = (void *) isubID.c_str();
-            iov[6].iov_len = isubID_len * PURSUIT_ID_LEN;
-            iov[7].iov_base = (void *) data;
-            iov[7].iov_len = data_len;
-            iov[8].iov_base = NULL;
-            iov[8].iov_len = 0;
-        } else {
-            iov[5].iov_base = (void *) str_opt;
-            iov[5].iov_len = str_opt_len;
-            /*hash(URL) coming with iSUB*/
-            iov[6].iov_base = &isubID_len;
-            iov[6].iov_len = sizeof (isubID_len);
-            iov[7].iov_base = (void *) isubID.c_str();
-            iov[7].iov_len = isubID_len * PURSUIT_ID_LEN;
-            iov[8].iov_base = (void *) data;
-            iov[8].iov_len = data_len;
+        iovcnt = 5;
+        if (str_opt != NULL) {
+            iov[iovcnt].iov_base = (void *) str_opt;
+            iov[iovcnt].iov_len = str_opt_len;
+            iovcnt++;
+        }
+        /*hash(URL) coming with iSUB*/
+        iov[iovcnt].iov_base = &isubID_len;
+        iov[iovcnt].iov_len = sizeof (isubID_len);
+        iovcnt++;
+        iov[iovcnt].iov_base = (void *) isubID.c_str();
+        iov[iovcnt].iov_len = isubID_len * PURSUIT_ID_LEN;
+        iovcnt++;
+        for (unsigned int i = 0; i < data_iovcnt; i++) {
+            iov[iovcnt++] = data[i];
         }
         msg.msg_name = (void *) &d_nladdr;
         msg.msg_namelen = sizeof (d_nladdr);
         msg.msg_iov = iov;
-        msg.msg_iovlen = (str_opt == NULL) ? 8 : 9;
+        msg.msg_iovlen = iovcnt;
         ret = sendmsg(sock_fd, &msg, 0);
     }
     if (ret < 0) {
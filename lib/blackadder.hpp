@@ -53,6 +53,9 @@
 #include "blackadder_enums.hpp"
 #include "ba_fnv.hpp"
 
+/* maximum number of data iovecs accepted by the vectored publish methods */
+#define BA_MAX_DATA_IOV 8
+
 
 using namespace std;
 
@@ -272,6 +275,34 @@ public:
      * @return: boolean indicating whether the message has been passed to core Blackadder succesffuly or not
      */
     bool publish_data_isub(const string&id, unsigned char strategy, void *str_opt, unsigned int str_opt_len, const string &isubID, void * data, unsigned int);
+    /**@brief this is a vectored version of the PUBLISH_DATA_iMULTICAST method above.
+     *
+     * The data is gathered from data_iovcnt buffers, e.g. a protocol header and a slice of a larger message, without copying them into a single buffer first.
+     *
+     * @param id the full identifier of the information item for which data is published.
+     * @param strategy the dissemination strategy assigned to the request.
+     * @param str_opt a bucket of bytes that are strategy specific. When the IMPLICIT_RENDEZVOUS strategy is used this bucket contains a LIPSIN identifier.
+     * @param str_opt_len the size of the provided bucket of bytes. When the IMPLICIT_RENDEZVOUS strategy is used str_opt_len should be FID_LEN.
+     * @param nodeIds list of nodeIDs of implicit subscripers for which blackadder should create a multicast FID
+     * @param data the buffers which are published in this order.
+     * @param data_iovcnt the number of buffers in data (at most BA_MAX_DATA_IOV).
+     * @return: boolean indicating whether the message has been passed to core Blackadder succesffuly or not
+     */
+    bool publish_data(const string&id, unsigned char strategy, void *str_opt, unsigned int str_opt_len, std::list<string> &nodeIds, const struct iovec *data, unsigned int data_iovcnt);
+    /**@brief this is a vectored version of the PUBLISH_DATA_iSUB method above.
+     *
+     * The data is gathered from data_iovcnt buffers, e.g. a protocol header and a slice of a larger message, without copying them into a single buffer first.
+     *
+     * @param id the full identifier of the information item for which data is published.
+     * @param strategy the dissemination strategy assigned to the request.
+     * @param str_opt a bucket of bytes that are strategy specific. When the IMPLICIT_RENDEZVOUS strategy is used this bucket contains a LIPSIN identifier.
+     * @param str_opt_len the size of the provided bucket of bytes. When the IMPLICIT_RENDEZVOUS strategy is used str_opt_len should be FID_LEN.
+     * @param the information identifier for which an implicit subscription is being made
+     * @param data the buffers which are published in this order.
+     * @param data_iovcnt the number of buffers in data (at most BA_MAX_DATA_IOV).
+     * @return: boolean indicating whether the message has been passed to core Blackadder succesffuly or not
+     */
+    bool publish_data_isub(const string&id, unsigned char strategy, void *str_opt, unsigned int str_opt_len, const string &isubID, const struct iovec *data, unsigned int data_iovcnt);
     /**@brief This method blocks until an event is received from Blackadder.
      *
      * @param ev a reference to an Event which will be updated accordingly. An application can read the Event (and the data when the event is PUBLISHED_DATA) when the method unblocks.
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2010-2011  George Parisis and Dirk Trossen
+ * Copyright (C) 2015-2018  Mays AL-Naday
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+#include <stdlib.h>
+#include <algorithm>
+#include "lid_allocator.hpp"
+#include "ba_fnv.hpp"
+
+/*random candidates tried per LID before giving up (or adding a bit)*/
+#define LID_ALLOCATOR_TRIES 1024
+
+LidAllocator::LidAllocator(unsigned int lid_len) : _lid_len(lid_len) {
+}
+
+void LidAllocator::reset(unsigned int lid_len) {
+    _lid_len = lid_len;
+    _used.clear();
+}
+
+unsigned int LidAllocator::length() const {
+    return _lid_len;
+}
+
+size_t LidAllocator::size() const {
+    return _used.size();
+}
+
+bool LidAllocator::reserve(const lid_bits &lid) {
+    return _used.insert(key(lid)).second;
+}
+
+bool LidAllocator::release(const lid_bits &lid) {
+    return _used.erase(key(lid)) > 0;
+}
+
+bool LidAllocator::used(const lid_bits &lid) const {
+    return _used.find(key(lid)) != _used.end();
+}
+
+LidAllocator::lid_bits LidAllocator::allocate(unsigned int bits) {
+    std::vector<lid_bits> result;
+    if (!allocate(1, result, bits)) {
+        return lid_bits();
+    }
+    return result[0];
+}
+
+bool LidAllocator::allocate(unsigned int count, std::vector<lid_bits> &result,
+        unsigned int bits, int max_overlap,
+        const std::vector<lid_bits> &neighbours) {
+    size_t first = result.size();
+    if (_lid_len == 0) {
+        return false;
+    }
+    for (unsigned int i = 0; i < count; i++) {
+        /*like the deployment tool always did: one more bit for every lid_len assigned LIDs*/
+        unsigned int number_of_bits = (bits > 0) ? bits : _used.size() / _lid_len + 1;
+        bool found = false;
+        while (!found && number_of_bits <= _lid_len) {
+            for (int tries = 0; tries < LID_ALLOCATOR_TRIES && !found; tries++) {
+                lid_bits lid = candidate(number_of_bits);
+                if (used(lid)) {
+                    continue;
+                }
+                found = true;
+                if (max_overlap >= 0) {
+                    for (size_t j = first; j < result.size() && found; j++) {
+                        found = (overlap(lid, result[j]) <= (unsigned int) max_overlap);
+                    }
+                    for (size_t j = 0; j < neighbours.size() && found; j++) {
+                        found = (overlap(lid, neighbours[j]) <= (unsigned int) max_overlap);
+                    }
+                }
+                if (found) {
+                    reserve(lid);
+                    result.push_back(lid);
+                }
+            }
+            /*a fixed number of bits is a hard constraint*/
+            if (bits > 0) {
+                break;
+            }
+            number_of_bits++;
+        }
+        if (!found) {
+            for (size_t j = first; j < result.size(); j++) {
+                release(result[j]);
+            }
+            result.resize(first);
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string LidAllocator::key(const lid_bits &lid) const {
+    std::string words(((_lid_len + 31) / 32) * 4, '\0');
+    for (size_t i = 0; i < lid.size(); i++) {
+        words[lid[i] / 8] |= (char) (1 << (lid[i] % 8));
+    }
+    return words;
+}
+
+LidAllocator::lid_bits LidAllocator::candidate(unsigned int bits) const {
+    lid_bits lid;
+    for (unsigned int i = 0; i < bits; i++) {
+        /*assign a bit in a random position*/
+        lid.push_back(rand() % _lid_len);
+    }
+    std::sort(lid.begin(), lid.end());
+    lid.erase(std::unique(lid.begin(), lid.end()), lid.end());
+    return lid;
+}
+
+unsigned int LidAllocator::overlap(const lid_bits &a, const lid_bits &b) {
+    unsigned int common = 0;
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+        if (a[i] < b[j]) {
+            i++;
+        } else if (b[j] < a[i]) {
+            j++;
+        } else {
+            common++;
+            i++;
+            j++;
+        }
+    }
+    return common;
+}
+
+size_t LidAllocator::KeyHash::operator()(const std::string &key) const {
+    return (size_t) fnv1a_64((const unsigned char *) key.data(), key.size());
+}
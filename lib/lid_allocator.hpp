@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2010-2011  George Parisis and Dirk Trossen
+ * Copyright (C) 2015-2018  Mays AL-Naday
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+/**
+ * @file lid_allocator.hpp
+ * @brief Bulk allocator of unique random link identifiers.
+ */
+
+#ifndef LID_ALLOCATOR_HPP
+#define LID_ALLOCATOR_HPP
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+/**@brief (User Library) Allocates random, unique link identifiers (LIDs and iLIDs) in bulk.
+ *
+ * A LID is handled as the list of the bit positions that are set in it, i.e. the positions passed to Bitvector::operator[].
+ * This keeps the allocator independent of the Bitvector copy of its user, so that it can be shared by the Topology Manager and the deployment tool.
+ *
+ * All used LIDs are kept in a hashed index, so checking a candidate for collisions does not depend on the number of assigned LIDs.
+ * Candidates are generated like before: a number of random bit positions, where the number of bits grows by one every time lid_len LIDs have been assigned.
+ *
+ * Optionally, the LIDs assigned to the links of the same node can be constrained to share at most a given number of bits with each other.
+ * This lowers the false positive rate of the LIPSIN forwarding decision on that node.
+ */
+class LidAllocator {
+public:
+    /**@brief the set bit positions of a LID, in ascending order.
+     */
+    typedef std::vector<unsigned int> lid_bits;
+    /**@brief Constructor: an empty allocator for LIDs of lid_len bits.
+     *
+     * @param lid_len the length of a LID in bits (FID_LEN * 8). 0 leaves the allocator unusable until reset() is called.
+     */
+    LidAllocator(unsigned int lid_len = 0);
+    /**@brief empty the index and set the LID length.
+     *
+     * @param lid_len the length of a LID in bits.
+     */
+    void reset(unsigned int lid_len);
+    /**@brief the length of the LIDs in bits.
+     */
+    unsigned int length() const;
+    /**@brief the number of used LIDs.
+     */
+    size_t size() const;
+    /**@brief mark an existing LID (e.g. read from a topology file) as used.
+     *
+     * @return false if the LID was already used.
+     */
+    bool reserve(const lid_bits &lid);
+    /**@brief return a LID to the pool of free LIDs.
+     *
+     * @return false if the LID was not used.
+     */
+    bool release(const lid_bits &lid);
+    /**@brief whether a LID is used.
+     */
+    bool used(const lid_bits &lid) const;
+    /**@brief allocate a single LID.
+     *
+     * @param bits the number of bits to set, 0 to let the number grow with the number of used LIDs.
+     * @return the new LID or an empty list if no free LID with the requested number of bits could be found.
+     */
+    lid_bits allocate(unsigned int bits = 0);
+    /**@brief allocate count LIDs in one call, e.g. the iLID and the LIDs of all the links of a node.
+     *
+     * The new LIDs are appended to result. If the call fails, the LIDs it has allocated are released again.
+     *
+     * @param count the number of LIDs to allocate.
+     * @param result the vector where the new LIDs are appended.
+     * @param bits the number of bits to set, 0 to let the number grow with the number of used LIDs.
+     * @param max_overlap the maximum number of bits a new LID may share with any other LID of this call or of neighbours, -1 for no limit.
+     * @param neighbours LIDs that are already assigned on the same node and are subject to the max_overlap constraint too.
+     * @return false if the constraints could not be met.
+     */
+    bool allocate(unsigned int count, std::vector<lid_bits> &result,
+            unsigned int bits = 0, int max_overlap = -1,
+            const std::vector<lid_bits> &neighbours = std::vector<lid_bits>());
+private:
+    /**@brief the LID as packed 32bit words in a string, the key of the hashed index.
+     */
+    std::string key(const lid_bits &lid) const;
+    /**@brief a random candidate with (up to) bits set bits.
+     */
+    lid_bits candidate(unsigned int bits) const;
+    /**@brief the number of bits two LIDs have in common.
+     */
+    static unsigned int overlap(const lid_bits &a, const lid_bits &b);
+    /**@brief FNV-1a hash of the index keys.
+     */
+    struct KeyHash {
+        size_t operator()(const std::string &key) const;
+    };
+    unsigned int _lid_len;
+    std::unordered_set<std::string, KeyHash> _used;
+};
+
+#endif
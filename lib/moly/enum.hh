@@ -50,7 +50,16 @@ enum buffers_t
 	BUFFER_NAP_HTTP_HANDLER_REQUESTS,
 	BUFFER_NAP_HTTP_HANDLER_RESPONSES,
 	BUFFER_NAP_LTP,
-	BUFFER_MOOSE_MESSAGE_STACK
+	BUFFER_MOOSE_MESSAGE_STACK,
+	BUFFER_TM_QOS_PARKED_REQUESTS,
+	BUFFER_NAP_TCP_CLIENT_POOL_HIT_RATE,/*!< Percentage of HTTP requests sent
+	over a pooled TCP connection */
+	BUFFER_NAP_HTTP_CACHE_HIT_RATE,/*!< Percentage of cacheable HTTP requests
+	served from the cache or with the response to an identical request */
+	BUFFER_NAP_ICN_EVENT_QUEUES,/*!< ICN events queued in front of all ICN
+	worker threads on average */
+	BUFFER_NAP_IP_HANDLER_BYTES/*!< Bytes held in the IP handler's buffer.
+	BUFFER_NAP_IP_HANDLER counts its packets */
 };
 
 /*!
@@ -46,6 +46,21 @@ string MolyHelper::bufferNameToString(buffer_name_t buffer)
 	case BUFFER_MOOSE_MESSAGE_STACK:
 		oss << "BUFFER_MOOSE_MESSAGE_STACK";
 		break;
+	case BUFFER_TM_QOS_PARKED_REQUESTS:
+		oss << "BUFFER_TM_QOS_PARKED_REQUESTS";
+		break;
+	case BUFFER_NAP_TCP_CLIENT_POOL_HIT_RATE:
+		oss << "BUFFER_NAP_TCP_CLIENT_POOL_HIT_RATE";
+		break;
+	case BUFFER_NAP_HTTP_CACHE_HIT_RATE:
+		oss << "BUFFER_NAP_HTTP_CACHE_HIT_RATE";
+		break;
+	case BUFFER_NAP_ICN_EVENT_QUEUES:
+		oss << "BUFFER_NAP_ICN_EVENT_QUEUES";
+		break;
+	case BUFFER_NAP_IP_HANDLER_BYTES:
+		oss << "BUFFER_NAP_IP_HANDLER_BYTES";
+		break;
 	default:
 		oss << "UNKNOWN";
 	}